@@ -100,3 +100,47 @@ function(quic_add_test)
   target_compile_definitions(${QUIC_TEST_TARGET} PRIVATE ${LIBGMOCK_DEFINES})
   set_tests_properties(${QUIC_TEST_CASES} PROPERTIES TIMEOUT 120)
 endfunction()
+
+# Microbenchmarks are built with the tests but are not registered with ctest,
+# they are meant to be run by hand, e.g. ./QuicPacketSchedulerBenchmark.
+function(quic_add_benchmark)
+  if(NOT BUILD_TESTS)
+    return()
+  endif()
+
+  set(options)
+  set(one_value_args TARGET)
+  set(multi_value_args SOURCES DEPENDS INCLUDES)
+  cmake_parse_arguments(PARSE_ARGV 0 QUIC_BENCHMARK "${options}" "${one_value_args}" "${multi_value_args}")
+
+  if(NOT QUIC_BENCHMARK_TARGET)
+    message(FATAL_ERROR "The TARGET parameter is mandatory.")
+  endif()
+
+  if(NOT QUIC_BENCHMARK_SOURCES)
+    set(QUIC_BENCHMARK_SOURCES "${QUIC_BENCHMARK_TARGET}.cpp")
+  endif()
+
+  add_executable(${QUIC_BENCHMARK_TARGET} "${QUIC_BENCHMARK_SOURCES}")
+  # The test utilities pulled in by benchmarks depend on gmock.
+  add_dependencies(${QUIC_BENCHMARK_TARGET} googletest)
+
+  target_compile_options(
+    ${QUIC_BENCHMARK_TARGET} PRIVATE
+    ${_QUIC_BASE_COMPILE_OPTIONS}
+    -Wno-sign-compare
+    -Wno-inconsistent-missing-override
+  )
+  target_link_libraries(${QUIC_BENCHMARK_TARGET} PRIVATE
+    "${QUIC_BENCHMARK_DEPENDS}"
+    Folly::follybenchmark
+    ${LIBGMOCK_LIBRARIES}
+    ${LIBGTEST_LIBRARIES}
+  )
+  target_include_directories(${QUIC_BENCHMARK_TARGET} PRIVATE
+    "${QUIC_BENCHMARK_INCLUDES}"
+    ${LIBGMOCK_INCLUDE_DIR}
+    ${LIBGTEST_INCLUDE_DIR}
+    ${QUIC_EXTRA_INCLUDE_DIRECTORIES}
+  )
+endfunction()
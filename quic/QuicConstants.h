@@ -106,6 +106,12 @@ enum class FrameType : uint64_t {
   // CONNECTION_CLOSE_APP_ERR frametype is use to indicate application errors
   CONNECTION_CLOSE_APP_ERR = 0x1D,
   HANDSHAKE_DONE = 0x1E,
+  // Unreliable datagrams (RFC 9221), without and with a length field.
+  DATAGRAM = 0x30,
+  DATAGRAM_LEN = 0x31,
+  // Ack frequency extension (draft-ietf-quic-ack-frequency).
+  IMMEDIATE_ACK = 0xAC,
+  ACK_FREQUENCY = 0xAF,
   MIN_STREAM_DATA = 0xFE, // subject to change
   EXPIRED_STREAM_DATA = 0xFF, // subject to change
 };
@@ -208,6 +214,17 @@ constexpr uint16_t kPartialReliabilityParameterId = 0xFF00; // subject to change
 
 constexpr uint32_t kDrainFactor = 3;
 
+// The max_datagram_frame_size advertised when datagrams are enabled.
+constexpr uint16_t kDefaultMaxDatagramFrameSize = 65535;
+
+// Datagrams buffered in each direction before the oldest are dropped.
+constexpr uint32_t kDefaultMaxDatagramsBuffered = 75;
+
+// The most a short header packet and the header of a DATAGRAM frame add to a
+// datagram: 1 byte of flags, a 20 byte connection id, a 4 byte packet number,
+// a 16 byte AEAD tag, the frame type and a 2 byte length.
+constexpr uint16_t kMaxDatagramPacketOverhead = 44;
+
 // batching mode
 enum class QuicBatchingMode : uint32_t {
   BATCHING_MODE_NONE = 0,
@@ -225,6 +242,9 @@ constexpr uint32_t kDefaultQuicMaxBatchSize = 16;
 // thread local delay
 constexpr std::chrono::microseconds kDefaultThreadLocalDelay = 1ms;
 
+// Smallest GSO batch written with MSG_ZEROCOPY, smaller ones are copied.
+constexpr uint32_t kDefaultZeroCopyWriteThreshold = 16 * 1024;
+
 // rfc6298:
 constexpr int kRttAlpha = 8;
 constexpr int kRttBeta = 4;
@@ -255,6 +275,9 @@ constexpr uint64_t kDefaultMinBurstPackets = 5;
 // but the notifications can get delayed if the event loop is busy
 // this is subject to testing but I would suggest a value >= 200usec
 constexpr std::chrono::microseconds kDefaultPacingTimerTickInterval{1000};
+// How far ahead of time the packets are written when their departure times are
+// left to the kernel.
+constexpr std::chrono::microseconds kDefaultTxTimePacingHorizon{10000};
 // Fraction of RTT that is used to limit how long a write function can loop
 constexpr DurationRep kDefaultWriteLimitRttFraction = 25;
 
@@ -294,6 +317,17 @@ constexpr uint64_t kDefaultMaxCwndInMss = 2000;
 // Max cwnd limit for perf test purpose
 constexpr uint64_t kLargeMaxCwndInMss = 860000;
 
+// Congestion states of closed connections a server worker keeps, one per peer
+// address prefix.
+constexpr size_t kDefaultCongestionStateCacheSize = 10000;
+// A congestion state cached longer ago than this is not used.
+constexpr std::chrono::seconds kDefaultCongestionStateMaxAge{600};
+constexpr uint8_t kCongestionStateCacheV4PrefixLen = 24;
+constexpr uint8_t kCongestionStateCacheV6PrefixLen = 56;
+// A connection starts with this fraction of the congestion window that a
+// cached connection ended with.
+constexpr float kCachedCwndFraction = 0.5f;
+
 // When server receives early data attempt without valid source address token,
 // server will limit bytes in flight to avoid amplification attack until CFIN
 // is received which proves sender owns the address.
@@ -329,6 +363,14 @@ constexpr float kCubicTCPFriendlyEstimateIncreaseFactor =
 // Default flow control window for HTTP/2 + 1K for headers
 constexpr uint64_t kDefaultStreamWindowSize = (64 + 1) * 1024;
 constexpr uint64_t kDefaultConnectionWindowSize = 1024 * 1024;
+// Upper bounds of the receive windows grown by auto-tuning.
+constexpr uint64_t kDefaultMaxAutoTunedStreamWindowSize = 16 * 1024 * 1024;
+constexpr uint64_t kDefaultMaxAutoTunedConnectionWindowSize = 24 * 1024 * 1024;
+// Receive window growth allowed to all the connections of a server worker.
+constexpr uint64_t kDefaultAutoTunedWindowBudgetPerWorker = 1024 * 1024 * 1024;
+// An auto-tuned connection window is kept at least this many times as large as
+// the largest auto-tuned stream window, so one stream cannot use all of it.
+constexpr float kAutoTunedConnectionToStreamWindowRatio = 1.5f;
 
 /* Stream Limits */
 constexpr uint64_t kDefaultMaxStreamsBidirectional = 2048;
@@ -367,8 +409,19 @@ constexpr double kAckTimerFactor = 0.25;
 // max ack timeout: 25ms
 constexpr std::chrono::microseconds kMaxAckTimeout = 25000us;
 
+// The min_ack_delay advertised when ACK_FREQUENCY is enabled.
+constexpr std::chrono::microseconds kDefaultMinAckDelay = 1000us;
+// Bounds of the packet tolerance requested with ACK_FREQUENCY.
+constexpr uint64_t kMinAckFrequencyPacketTolerance = 2;
+constexpr uint64_t kMaxAckFrequencyPacketTolerance = 256;
+
 constexpr uint64_t kAckPurgingThresh = 10;
 
+// Max number of ack blocks tracked per packet number space. Past it the
+// smallest blocks are forgotten, they are the first to be left out of an ACK
+// frame anyway.
+constexpr size_t kMaxAckBlocks = 256;
+
 // Default number of packets to buffer if keys are not present.
 constexpr uint32_t kDefaultMaxBufferedPackets = 20;
 
@@ -420,6 +473,19 @@ constexpr auto kExpectedNumOfParamsInTheTicket = 8;
 
 constexpr auto kStatelessResetTokenSecretLength = 32;
 
+constexpr auto kAddressTokenSecretLength = 32;
+
+// Each address validation token is sealed under a key derived from a random
+// salt of this length, carried in the token.
+constexpr auto kAddressTokenSaltLength = 16;
+
+// How long the token of a Retry packet stays valid, the client echoes it
+// within a round trip.
+constexpr std::chrono::seconds kRetryTokenLifetime = 10s;
+
+// How long a token sent in a NEW_TOKEN frame stays valid.
+constexpr std::chrono::seconds kNewTokenLifetime = 24h;
+
 constexpr uint64_t kDefaultActiveConnectionIdLimit = 2;
 
 // default capability of QUIC partial reliability
@@ -473,6 +539,7 @@ enum class WriteDataReason {
   RESET,
   PATHCHALLENGE,
   PING,
+  DATAGRAM,
 };
 
 enum class NoWriteReason {
@@ -502,6 +569,25 @@ folly::StringPiece readNoReadReasonString(NoReadReason reason);
 std::vector<QuicVersion> filterSupportedVersions(
     const std::vector<QuicVersion>&);
 
+/**
+ * The ECN codepoints, carried in the two low bits of the IP TOS or traffic
+ * class.
+ */
+enum class EcnCodepoint : uint8_t {
+  NotEct = 0,
+  Ect1 = 1,
+  Ect0 = 2,
+  Ce = 3,
+};
+constexpr uint8_t kEcnCodepointMask = 0x03;
+
+// Number of ECN marked packets that test whether the path supports ECN. The
+// marking stops if they are all lost, or until an ACK validates them.
+constexpr uint64_t kEcnTestingPackets = 10;
+// Gain of the moving average of the fraction of CE marked bytes per round
+// that sets the scalable (L4S) congestion response.
+constexpr double kL4sAlphaGain = 1.0 / 16;
+
 /**
  * Represent the different encryption levels used by QUIC.
  */
@@ -8,8 +8,10 @@
 
 #include <quic/api/IoBufQuicBatch.h>
 
+#include <quic/codec/Decode.h>
 #include <quic/common/SocketUtil.h>
 #include <quic/happyeyeballs/QuicHappyEyeballsFunctions.h>
+#include <quic/state/QuicStateFunctions.h>
 
 namespace quic {
 IOBufQuicBatch::IOBufQuicBatch(
@@ -26,11 +28,81 @@ IOBufQuicBatch::IOBufQuicBatch(
       conn_(conn),
       happyEyeballsState_(happyEyeballsState) {}
 
+void IOBufQuicBatch::addHeaderProtection(
+    HeaderForm headerForm,
+    uint8_t* header,
+    size_t headerLen,
+    const uint8_t* encryptedBody,
+    size_t bodyLen,
+    const PacketNumberCipher& headerCipher) {
+  if (numPendingHeaders_ == kMaxPendingHeaders ||
+      (headerCipher_ && headerCipher_ != &headerCipher)) {
+    applyHeaderProtection();
+  }
+  auto packetNumberLength = parsePacketNumberLength(*header);
+  auto& sample = samples_[numPendingHeaders_];
+  size_t sampleBytesToUse = kMaxPacketNumEncodingSize - packetNumberLength;
+  // If there were less than 4 bytes in the packet number, some of the payload
+  // bytes will also be skipped during sampling.
+  CHECK_GE(bodyLen, sampleBytesToUse + sample.size());
+  memcpy(sample.data(), encryptedBody + sampleBytesToUse, sample.size());
+  pendingHeaders_[numPendingHeaders_++] = {headerForm, header, headerLen};
+  headerCipher_ = &headerCipher;
+}
+
+void IOBufQuicBatch::applyHeaderProtection() {
+  if (numPendingHeaders_ == 0) {
+    return;
+  }
+  headerCipher_->masks(samples_.data(), masks_.data(), numPendingHeaders_);
+  for (size_t i = 0; i < numPendingHeaders_; ++i) {
+    auto& pending = pendingHeaders_[i];
+    auto packetNumberLength = parsePacketNumberLength(*pending.header);
+    folly::MutableByteRange initialByteRange(pending.header, 1);
+    folly::MutableByteRange packetNumByteRange(
+        pending.header + pending.headerLen - packetNumberLength,
+        packetNumberLength);
+    if (pending.headerForm == HeaderForm::Short) {
+      headerCipher_->encryptShortHeaderWithMask(
+          masks_[i], initialByteRange, packetNumByteRange);
+    } else {
+      headerCipher_->encryptLongHeaderWithMask(
+          masks_[i], initialByteRange, packetNumByteRange);
+    }
+  }
+  numPendingHeaders_ = 0;
+  headerCipher_ = nullptr;
+}
+
 bool IOBufQuicBatch::write(
     std::unique_ptr<folly::IOBuf>&& buf,
     size_t encodedSize) {
   pktSent_++;
 
+  // The packets of a batch leave together, a new departure time starts a new
+  // batch. The thread local batches mix the packets of many connections, so
+  // they are not stamped.
+  if (conn_.transportSettings.txTimePacing && !threadLocal_ &&
+      isConnectionPaced(conn_)) {
+    auto txTime = conn_.pacer->getTxTime(Clock::now());
+    if (txTime != batchWriter_->getTxTime()) {
+      if (!batchWriter_->empty()) {
+        flush(FlushType::FLUSH_TYPE_ALWAYS);
+      }
+      batchWriter_->setTxTime(txTime);
+    }
+  }
+  // Likewise for the ECN codepoint, which changes as the path is validated.
+  if (conn_.transportSettings.enableEcn && !threadLocal_) {
+    auto ecn = getEcnCodepointToSend(conn_);
+    if (ecn != batchWriter_->getEcn()) {
+      if (!batchWriter_->empty()) {
+        flush(FlushType::FLUSH_TYPE_ALWAYS);
+      }
+      batchWriter_->setEcn(ecn);
+    }
+  }
+
   // see if we need to flush the prev buffer(s)
   if (batchWriter_->needsFlush(encodedSize)) {
     // continue even if we get an error here
@@ -51,6 +123,9 @@ bool IOBufQuicBatch::write(
 }
 
 bool IOBufQuicBatch::flush(FlushType flushType) {
+  // The packets must be complete before they leave the batch, even when the
+  // write is delayed.
+  applyHeaderProtection();
   if (threadLocal_ &&
       (flushType == FlushType::FLUSH_TYPE_ALLOW_THREAD_LOCAL_DELAY)) {
     return true;
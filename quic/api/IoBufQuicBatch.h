@@ -9,8 +9,11 @@
 #pragma once
 #include <quic/QuicException.h>
 #include <quic/api/QuicBatchWriter.h>
+#include <quic/codec/PacketNumberCipher.h>
 #include <quic/state/StateData.h>
 
+#include <array>
+
 namespace quic {
 class IOBufQuicBatch {
  public:
@@ -29,6 +32,20 @@ class IOBufQuicBatch {
 
   ~IOBufQuicBatch() = default;
 
+  /**
+   * Defers the header protection of a packet until the batch is flushed, so
+   * that the masks of the whole batch are computed with a single
+   * PacketNumberCipher::masks() call. Takes the same arguments as
+   * encryptPacketHeader(). header must stay valid until the next flush.
+   */
+  void addHeaderProtection(
+      HeaderForm headerForm,
+      uint8_t* header,
+      size_t headerLen,
+      const uint8_t* encryptedBody,
+      size_t bodyLen,
+      const PacketNumberCipher& headerCipher);
+
   // returns true if it succeeds and false if the loop should end
   bool write(std::unique_ptr<folly::IOBuf>&& buf, size_t encodedSize);
 
@@ -40,6 +57,17 @@ class IOBufQuicBatch {
   }
 
  private:
+  // Packets whose header protection is computed in one go.
+  static constexpr size_t kMaxPendingHeaders = 16;
+
+  struct PendingHeader {
+    HeaderForm headerForm;
+    uint8_t* header;
+    size_t headerLen;
+  };
+
+  void applyHeaderProtection();
+
   void reset();
 
   // flushes the internal buffers
@@ -57,6 +85,11 @@ class IOBufQuicBatch {
   QuicConnectionStateBase& conn_;
   QuicConnectionStateBase::HappyEyeballsState& happyEyeballsState_;
   uint64_t pktSent_{0};
+  const PacketNumberCipher* headerCipher_{nullptr};
+  size_t numPendingHeaders_{0};
+  std::array<PendingHeader, kMaxPendingHeaders> pendingHeaders_;
+  std::array<Sample, kMaxPendingHeaders> samples_;
+  std::array<HeaderProtectionMask, kMaxPendingHeaders> masks_;
 };
 
 } // namespace quic
@@ -8,6 +8,10 @@
 
 #include <quic/api/QuicBatchWriter.h>
 
+#include <quic/common/SocketUtil.h>
+
+#include <climits>
+
 #if !FOLLY_MOBILE
 #define USE_THREAD_LOCAL_BATCH_WRITER 1
 #else
@@ -21,7 +25,11 @@ namespace {
 constexpr size_t kPacketSizeViolationTolerance = 10;
 
 #if USE_THREAD_LOCAL_BATCH_WRITER
-class ThreadLocalBatchWriterCache : public folly::AsyncTimeout {
+// Packets written by all the connections of a thread are batched together.
+// The batch is flushed after threadLocalDelay, or at the end of the event loop
+// iteration in which they were written if threadLocalDelay is zero.
+class ThreadLocalBatchWriterCache : public folly::AsyncTimeout,
+                                    public folly::EventBase::LoopCallback {
  private:
   ThreadLocalBatchWriterCache() = default;
 
@@ -48,6 +56,16 @@ class ThreadLocalBatchWriterCache : public folly::AsyncTimeout {
     }
   }
 
+  void flush() {
+    auto& instance = getThreadLocalInstance();
+    if (instance.socket_ && instance.batchWriter_ &&
+        !instance.batchWriter_->empty()) {
+      // pass a default address - it is not being used by the writer
+      instance.batchWriter_->write(*socket_.get(), folly::SocketAddress());
+      instance.batchWriter_->reset();
+    }
+  }
+
  public:
   static ThreadLocalBatchWriterCache& getThreadLocalInstance() {
     static thread_local Holder sCache;
@@ -60,13 +78,13 @@ class ThreadLocalBatchWriterCache : public folly::AsyncTimeout {
 
   void timeoutExpired() noexcept override {
     timerActive_ = false;
-    auto& instance = getThreadLocalInstance();
-    if (instance.socket_ && instance.batchWriter_ &&
-        !instance.batchWriter_->empty()) {
-      // pass a default address - it is not being used by the writer
-      instance.batchWriter_->write(*socket_.get(), folly::SocketAddress());
-      instance.batchWriter_->reset();
-    }
+    flush();
+    decRef();
+  }
+
+  void runLoopCallback() noexcept override {
+    loopCallbackActive_ = false;
+    flush();
     decRef();
   }
 
@@ -75,6 +93,12 @@ class ThreadLocalBatchWriterCache : public folly::AsyncTimeout {
       enabled_ = val;
       batchingMode_ = quic::QuicBatchingMode::BATCHING_MODE_NONE;
       batchWriter_.reset();
+      // Without a pending flush, the socket is released so that it does not
+      // outlive its EventBase.
+      if (!val && socket_ && !timerActive_ && !loopCallbackActive_) {
+        detachTimeoutManager();
+        socket_.reset();
+      }
     }
   }
 
@@ -111,9 +135,16 @@ class ThreadLocalBatchWriterCache : public folly::AsyncTimeout {
 
       batchWriter_.reset(writer);
 
-      // start the timer if not active
-      if (evb && socket_ && !timerActive_) {
-        addRef();
+      if (!evb || !socket_ || timerActive_ || loopCallbackActive_) {
+        return;
+      }
+      addRef();
+      if (threadLocalDelay_.count() == 0) {
+        // Runs after the write loopers already scheduled in this iteration.
+        loopCallbackActive_ = true;
+        evb->runInLoop(this, true /* thisIteration */);
+      } else {
+        // start the timer
         timerActive_ = true;
         evb->scheduleTimeoutHighRes(this, threadLocalDelay_);
       }
@@ -126,6 +157,7 @@ class ThreadLocalBatchWriterCache : public folly::AsyncTimeout {
   std::atomic<uint32_t> count_{1};
   bool enabled_{false};
   bool timerActive_{false};
+  bool loopCallbackActive_{false};
   std::chrono::microseconds threadLocalDelay_{1000};
   quic::QuicBatchingMode batchingMode_{
       quic::QuicBatchingMode::BATCHING_MODE_NONE};
@@ -142,6 +174,31 @@ bool BatchWriter::needsFlush(size_t /*unused*/) {
   return false;
 }
 
+UdpWriteOptions BatchWriter::writeOptions(int gso) const {
+  UdpWriteOptions options;
+  options.gso = gso;
+  options.txTime = txTime_;
+  options.tos = static_cast<uint8_t>(ecn_);
+  return options;
+}
+
+ssize_t BatchWriter::writeBuf(
+    folly::AsyncUDPSocket& sock,
+    const folly::SocketAddress& address,
+    const std::unique_ptr<folly::IOBuf>& buf,
+    int gso) {
+  if (txTime_ || ecn_ != EcnCodepoint::NotEct) {
+    iovecs_.clear();
+    buf->appendToIov(&iovecs_);
+    // A chain too long for one sendmsg() leaves right away.
+    if (iovecs_.size() <= IOV_MAX) {
+      return sendUdpMessage(
+          sock, address, iovecs_.data(), iovecs_.size(), writeOptions(gso), 0);
+    }
+  }
+  return gso > 0 ? sock.writeGSO(address, buf, gso) : sock.write(address, buf);
+}
+
 // SinglePacketBatchWriter
 void SinglePacketBatchWriter::reset() {
   buf_.reset();
@@ -161,12 +218,14 @@ bool SinglePacketBatchWriter::append(
 ssize_t SinglePacketBatchWriter::write(
     folly::AsyncUDPSocket& sock,
     const folly::SocketAddress& address) {
-  return sock.write(address, buf_);
+  return writeBuf(sock, address, buf_, 0);
 }
 
 // GSOPacketBatchWriter
-GSOPacketBatchWriter::GSOPacketBatchWriter(size_t maxBufs)
-    : maxBufs_(maxBufs) {}
+GSOPacketBatchWriter::GSOPacketBatchWriter(
+    size_t maxBufs,
+    ZeroCopyTracker* zeroCopyTracker)
+    : maxBufs_(maxBufs), zeroCopyTracker_(zeroCopyTracker) {}
 
 void GSOPacketBatchWriter::reset() {
   buf_.reset(nullptr);
@@ -218,9 +277,15 @@ bool GSOPacketBatchWriter::append(
 ssize_t GSOPacketBatchWriter::write(
     folly::AsyncUDPSocket& sock,
     const folly::SocketAddress& address) {
-  return (currBufs_ > 1)
-      ? sock.writeGSO(address, buf_, static_cast<int>(prevSize_))
-      : sock.write(address, buf_);
+  if (currBufs_ > 1 && zeroCopyTracker_ &&
+      zeroCopyTracker_->shouldUse(sock, buf_->computeChainDataLength())) {
+    // buf_ stays with the tracker until the kernel is done with it, reset()
+    // copes with it being gone.
+    return zeroCopyTracker_->write(
+        sock, address, buf_, writeOptions(static_cast<int>(prevSize_)));
+  }
+  return writeBuf(
+      sock, address, buf_, currBufs_ > 1 ? static_cast<int>(prevSize_) : 0);
 }
 
 GSOInplacePacketBatchWriter::GSOInplacePacketBatchWriter(
@@ -272,7 +337,8 @@ bool GSOInplacePacketBatchWriter::append(
  * Write the buffer owned by conn_.bufAccessor to the sock, until
  * lastPacketEnd_. After write, everything in the buffer after lastPacketEnd_
  * will be moved to the beginning of the buffer, and buffer will be returned to
- * conn_.bufAccessor.
+ * conn_.bufAccessor. A zero copy write keeps the buffer until the kernel is
+ * done with it, so conn_.bufAccessor gets a new one with the remaining bytes.
  */
 ssize_t GSOInplacePacketBatchWriter::write(
     folly::AsyncUDPSocket& sock,
@@ -296,9 +362,26 @@ ssize_t GSOInplacePacketBatchWriter::write(
   }
   uint64_t diffToStart = lastPacketEnd_ - buf->data();
   buf->trimEnd(diffToEnd);
-  auto bytesWritten = (numPackets_ > 1)
-      ? sock.writeGSO(address, buf, static_cast<int>(prevSize_))
-      : sock.write(address, buf);
+  auto zeroCopyTracker = conn_.zeroCopyTracker;
+  ssize_t bytesWritten;
+  if (numPackets_ > 1 && zeroCopyTracker &&
+      zeroCopyTracker->shouldUse(sock, buf->length())) {
+    auto capacity = buf->capacity();
+    auto residue = lastPacketEnd_;
+    bytesWritten = zeroCopyTracker->write(
+        sock, address, buf, writeOptions(static_cast<int>(prevSize_)));
+    if (!buf) {
+      // The tracker keeps the old buffer, and the residue in it, alive.
+      buf = zeroCopyTracker->getBuffer(capacity);
+      memcpy(buf->writableTail(), residue, diffToEnd);
+      buf->append(diffToEnd);
+      reset();
+      return bytesWritten;
+    }
+  } else {
+    bytesWritten = writeBuf(
+        sock, address, buf, numPackets_ > 1 ? static_cast<int>(prevSize_) : 0);
+  }
   /**
    * If there is one more bytes after lastPacketEnd_, that means there is a
    * packet we choose not to write in this batch (e.g., it has a size larger
@@ -547,7 +630,8 @@ BatchWriterPtr BatchWriterFactory::makeBatchWriter(
     case quic::QuicBatchingMode::BATCHING_MODE_GSO: {
       if (sock.getGSO() >= 0) {
         if (dataPathType == DataPathType::ChainedMemory) {
-          return BatchWriterPtr(new GSOPacketBatchWriter(batchSize));
+          return BatchWriterPtr(
+              new GSOPacketBatchWriter(batchSize, conn.zeroCopyTracker));
         }
         return BatchWriterPtr(new GSOInplacePacketBatchWriter(conn, batchSize));
       }
@@ -569,4 +653,16 @@ BatchWriterPtr BatchWriterFactory::makeBatchWriter(
   folly::assume_unreachable();
 }
 
+bool BatchWriterFactory::canMarkEcn(QuicBatchingMode batchingMode) {
+  switch (batchingMode) {
+    case quic::QuicBatchingMode::BATCHING_MODE_NONE:
+    case quic::QuicBatchingMode::BATCHING_MODE_GSO:
+      return true;
+    case quic::QuicBatchingMode::BATCHING_MODE_SENDMMSG:
+    case quic::QuicBatchingMode::BATCHING_MODE_SENDMMSG_GSO:
+      return false;
+  }
+  folly::assume_unreachable();
+}
+
 } // namespace quic
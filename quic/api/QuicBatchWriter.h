@@ -12,6 +12,7 @@
 #include <folly/io/IOBuf.h>
 #include <folly/io/async/AsyncUDPSocket.h>
 #include <quic/QuicConstants.h>
+#include <quic/api/ZeroCopyTracker.h>
 #include <quic/state/StateData.h>
 
 namespace quic {
@@ -66,9 +67,46 @@ class BatchWriter {
       folly::AsyncUDPSocket& sock,
       const folly::SocketAddress& address) = 0;
 
+  /**
+   * Departure time of the packets of the batch, see enableTxTime(). Only the
+   * single packet and the GSO writers stamp their writes with it.
+   */
+  void setTxTime(const folly::Optional<TimePoint>& txTime) {
+    txTime_ = txTime;
+  }
+
+  const folly::Optional<TimePoint>& getTxTime() const {
+    return txTime_;
+  }
+
+  /**
+   * ECN codepoint of the packets of the batch, which the same writers as for
+   * setTxTime() set.
+   */
+  void setEcn(EcnCodepoint ecn) {
+    ecn_ = ecn;
+  }
+
+  EcnCodepoint getEcn() const {
+    return ecn_;
+  }
+
  protected:
+  UdpWriteOptions writeOptions(int gso) const;
+
+  // Writes buf like AsyncUDPSocket::writeGSO(), or write() if gso is zero,
+  // with the departure time and the ECN codepoint of the batch.
+  ssize_t writeBuf(
+      folly::AsyncUDPSocket& sock,
+      const folly::SocketAddress& address,
+      const std::unique_ptr<folly::IOBuf>& buf,
+      int gso);
+
   folly::EventBase* evb_{nullptr};
   int fd_{-1};
+  folly::Optional<TimePoint> txTime_;
+  EcnCodepoint ecn_{EcnCodepoint::NotEct};
+  folly::fbvector<struct iovec> iovecs_;
 };
 
 class IOBufBatchWriter : public BatchWriter {
@@ -106,7 +144,10 @@ class SinglePacketBatchWriter : public IOBufBatchWriter {
 
 class GSOPacketBatchWriter : public IOBufBatchWriter {
  public:
-  explicit GSOPacketBatchWriter(size_t maxBufs);
+  // Large batches are written with zeroCopyTracker when it is set.
+  explicit GSOPacketBatchWriter(
+      size_t maxBufs,
+      ZeroCopyTracker* zeroCopyTracker = nullptr);
   ~GSOPacketBatchWriter() override = default;
 
   void reset() override;
@@ -127,6 +168,7 @@ class GSOPacketBatchWriter : public IOBufBatchWriter {
   size_t currBufs_{0};
   // size of the previous buffer chain appended to the buf_
   size_t prevSize_{0};
+  ZeroCopyTracker* zeroCopyTracker_{nullptr};
 };
 
 class GSOInplacePacketBatchWriter : public BatchWriter {
@@ -261,6 +303,12 @@ class BatchWriterFactory {
       const std::chrono::microseconds& threadLocalDelay,
       DataPathType dataPathType,
       QuicConnectionStateBase& conn);
+
+  /**
+   * Whether the writers of batchingMode can mark the packets with an ECN
+   * codepoint. The sendmmsg() writers cannot.
+   */
+  static bool canMarkEcn(QuicBatchingMode batchingMode);
 };
 
 } // namespace quic
@@ -35,6 +35,12 @@ inline folly::Optional<PacketNum> AckScheduler::writeNextAcks(
                  ackingTime - receivedTime)
            : 0us);
   AckFrameMetaData meta(ackState_.acks, ackDelay, ackDelayExponentToUse);
+  meta.encodedAckBlocks = &ackState_.encodedAcks;
+  // Echo the ECN codepoints once the peer marks its packets.
+  const auto& ecnCounts = ackState_.ecnCounts;
+  if (ecnCounts.ect0 || ecnCounts.ect1 || ecnCounts.ce) {
+    meta.ecnCounts = ecnCounts;
+  }
   auto ackWriteResult = writeAckFrame(meta, builder);
   if (!ackWriteResult) {
     return folly::none;
@@ -86,6 +86,11 @@ FrameScheduler::Builder& FrameScheduler::Builder::pingFrames() {
   return *this;
 }
 
+FrameScheduler::Builder& FrameScheduler::Builder::datagramFrames() {
+  datagramFrameScheduler_ = true;
+  return *this;
+}
+
 FrameScheduler FrameScheduler::Builder::build() && {
   FrameScheduler scheduler(std::move(name_));
   if (retransmissionScheduler_) {
@@ -117,6 +122,9 @@ FrameScheduler FrameScheduler::Builder::build() && {
   if (pingFrameScheduler_) {
     scheduler.pingFrameScheduler_.emplace(PingFrameScheduler(conn_));
   }
+  if (datagramFrameScheduler_) {
+    scheduler.datagramFrameScheduler_.emplace(DatagramFrameScheduler(conn_));
+  }
   return scheduler;
 }
 
@@ -175,6 +183,10 @@ SchedulingResult FrameScheduler::scheduleFramesForPacket(
   if (pingFrameScheduler_ && pingFrameScheduler_->hasPingFrame()) {
     pingFrameScheduler_->writePing(wrapper);
   }
+  if (datagramFrameScheduler_ &&
+      datagramFrameScheduler_->hasPendingDatagramFrames()) {
+    datagramFrameScheduler_->writeDatagramFrames(wrapper);
+  }
   if (retransmissionScheduler_ && retransmissionScheduler_->hasPendingData()) {
     retransmissionScheduler_->writeRetransmissionStreams(wrapper);
   }
@@ -213,7 +225,9 @@ bool FrameScheduler::hasImmediateData() const {
       (blockedScheduler_ && blockedScheduler_->hasPendingBlockedFrames()) ||
       (simpleFrameScheduler_ &&
        simpleFrameScheduler_->hasPendingSimpleFrames()) ||
-      (pingFrameScheduler_ && pingFrameScheduler_->hasPingFrame());
+      (pingFrameScheduler_ && pingFrameScheduler_->hasPingFrame()) ||
+      (datagramFrameScheduler_ &&
+       datagramFrameScheduler_->hasPendingDatagramFrames());
 }
 
 std::string FrameScheduler::name() const {
@@ -261,30 +275,27 @@ bool RetransmissionScheduler::hasPendingData() const {
 StreamFrameScheduler::StreamFrameScheduler(QuicConnectionStateBase& conn)
     : conn_(conn) {}
 
-StreamId StreamFrameScheduler::writeStreamsHelper(
+void StreamFrameScheduler::writeStreamsHelper(
     PacketBuilderInterface& builder,
-    const std::set<StreamId>& writableStreams,
-    StreamId nextScheduledStream,
+    PriorityQueue& writableStreams,
     uint64_t& connWritableBytes,
     bool streamPerPacket) {
-  MiddleStartingIterationWrapper wrapper(writableStreams, nextScheduledStream);
-  auto writableStreamItr = wrapper.cbegin();
-  // This will write the stream frames in a round robin fashion ordered by
-  // stream id. The iterator will wrap around the collection at the end, and we
-  // keep track of the value at the next iteration. This allows us to start
-  // writing at the next stream when building the next packet.
-  // TODO experiment with writing streams with an actual prioritization scheme.
-  while (writableStreamItr != wrapper.cend() && connWritableBytes > 0) {
-    if (writeNextStreamFrame(builder, *writableStreamItr, connWritableBytes)) {
-      writableStreamItr++;
-      if (streamPerPacket) {
-        break;
-      }
-    } else {
-      break;
+  // This will write the stream frames starting at the most urgent priority
+  // level. Incremental streams of a level are written round robin, the queue
+  // moves every stream we wrote to the back of its level so that the next
+  // packet starts with the stream after it. Non-incremental streams are written
+  // one after the other in stream id order.
+  bool wroteStream = false;
+  writableStreams.schedule([&](StreamId streamId) {
+    if (connWritableBytes == 0 || (streamPerPacket && wroteStream)) {
+      return false;
     }
-  }
-  return *writableStreamItr;
+    if (!writeNextStreamFrame(builder, streamId, connWritableBytes)) {
+      return false;
+    }
+    wroteStream = true;
+    return true;
+  });
 }
 
 void StreamFrameScheduler::writeStreams(PacketBuilderInterface& builder) {
@@ -294,29 +305,26 @@ void StreamFrameScheduler::writeStreams(PacketBuilderInterface& builder) {
     return;
   }
   // Write the control streams first as a naive binary priority mechanism.
-  const auto& writableControlStreams =
-      conn_.streamManager->writableControlStreams();
+  auto& writableControlStreams = conn_.streamManager->writableControlStreams();
   if (!writableControlStreams.empty()) {
-    conn_.schedulingState.nextScheduledControlStream = writeStreamsHelper(
+    writeStreamsHelper(
         builder,
         writableControlStreams,
-        conn_.schedulingState.nextScheduledControlStream,
         connWritableBytes,
         conn_.transportSettings.streamFramePerPacket);
   }
   if (connWritableBytes == 0) {
     return;
   }
-  const auto& writableStreams = conn_.streamManager->writableStreams();
+  auto& writableStreams = conn_.streamManager->writableStreams();
   if (!writableStreams.empty()) {
-    conn_.schedulingState.nextScheduledStream = writeStreamsHelper(
+    writeStreamsHelper(
         builder,
         writableStreams,
-        conn_.schedulingState.nextScheduledStream,
         connWritableBytes,
         conn_.transportSettings.streamFramePerPacket);
   }
-} // namespace quic
+}
 
 bool StreamFrameScheduler::hasPendingData() const {
   return conn_.streamManager->hasWritable() &&
@@ -429,6 +437,34 @@ bool PingFrameScheduler::writePing(PacketBuilderInterface& builder) {
   return 0 != writeFrame(PingFrame(), builder);
 }
 
+DatagramFrameScheduler::DatagramFrameScheduler(QuicConnectionStateBase& conn)
+    : conn_(conn) {}
+
+bool DatagramFrameScheduler::hasPendingDatagramFrames() const {
+  return !conn_.datagramState.writeBuffer.empty();
+}
+
+bool DatagramFrameScheduler::writeDatagramFrames(
+    PacketBuilderInterface& builder) {
+  bool framesWritten = false;
+  auto& writeBuffer = conn_.datagramState.writeBuffer;
+  while (!writeBuffer.empty()) {
+    auto& data = writeBuffer.front();
+    auto length = data ? data->computeChainDataLength() : 0;
+    // writeFrame() inserts the data into the packet, so it takes a clone that
+    // shares the buffer.
+    auto bytesWritten = writeFrame(
+        DatagramFrame(length, data ? data->clone() : nullptr), builder);
+    if (!bytesWritten) {
+      break;
+    }
+    QUIC_STATS(conn_.statsCallback, onDatagramWrite, length);
+    writeBuffer.pop_front();
+    framesWritten = true;
+  }
+  return framesWritten;
+}
+
 WindowUpdateScheduler::WindowUpdateScheduler(
     const QuicConnectionStateBase& conn)
     : conn_(conn) {}
@@ -552,18 +588,19 @@ SchedulingResult CloningScheduler::scheduleFramesForPacket(
   // independent header builder.
   auto header = builder.getPacketHeader();
   std::move(builder).releaseOutputBuffer();
-  // Look for an outstanding packet that's no larger than the writableBytes
-  for (auto& outstandingPacket : conn_.outstandings.packets) {
-    auto opPnSpace = outstandingPacket.packet.header.getPacketNumberSpace();
-    // Reusing the RegularQuicPacketBuilder throughout loop bodies will lead to
-    // frames belong to different original packets being written into the same
-    // clone packet. So re-create a RegularQuicPacketBuilder every time.
-    // TODO: We can avoid the copy & rebuild of the header by creating an
-    // independent header builder.
-    auto builderPnSpace = builder.getPacketHeader().getPacketNumberSpace();
-    if (opPnSpace != builderPnSpace) {
+  // Look for an outstanding packet that's no larger than the writableBytes.
+  // Only the packets in the same packet number space as the builder can be
+  // cloned.
+  auto builderPnSpace = header.getPacketNumberSpace();
+  auto& packets = conn_.outstandings.packets.packetsIn(builderPnSpace);
+  for (auto packetNum = packets.firstPacketNum();
+       packetNum < packets.endPacketNum();
+       ++packetNum) {
+    auto outstandingPacketPtr = packets.find(packetNum);
+    if (!outstandingPacketPtr) {
       continue;
     }
+    auto& outstandingPacket = *outstandingPacketPtr;
     size_t prevSize = 0;
     if (conn_.transportSettings.dataPathType ==
         DataPathType::ContinuousMemory) {
@@ -8,7 +8,6 @@
 
 #pragma once
 
-#include <boost/iterator/iterator_facade.hpp>
 #include <folly/Overload.h>
 #include <quic/QuicConstants.h>
 #include <quic/QuicException.h>
@@ -85,94 +84,12 @@ class StreamFrameScheduler {
   bool hasPendingData() const;
 
  private:
-  /**
-   * A helper iterator adaptor class that starts iteration of streams from a
-   * specific stream id.
-   */
-  class MiddleStartingIterationWrapper {
-   public:
-    using MapType = std::set<StreamId>;
-
-    class MiddleStartingIterator
-        : public boost::iterator_facade<
-              MiddleStartingIterator,
-              const MiddleStartingIterationWrapper::MapType::value_type,
-              boost::forward_traversal_tag> {
-      friend class boost::iterator_core_access;
-
-     public:
-      using MapType = MiddleStartingIterationWrapper::MapType;
-
-      MiddleStartingIterator() = default;
-
-      MiddleStartingIterator(
-          const MapType* streams,
-          const MapType::key_type& start)
-          : streams_(streams) {
-        itr_ = streams_->lower_bound(start);
-        checkForWrapAround();
-        // We don't want to mark it as wrapped around initially, instead just
-        // act as if start was the first element.
-        wrappedAround_ = false;
-      }
-
-      const MapType::value_type& dereference() const {
-        return *itr_;
-      }
-
-      bool equal(const MiddleStartingIterator& other) const {
-        return wrappedAround_ == other.wrappedAround_ && itr_ == other.itr_;
-      }
-
-      void increment() {
-        ++itr_;
-        checkForWrapAround();
-      }
-
-      void checkForWrapAround() {
-        if (itr_ == streams_->cend()) {
-          wrappedAround_ = true;
-          itr_ = streams_->cbegin();
-        }
-      }
-
-     private:
-      friend class MiddleStartingIterationWrapper;
-      bool wrappedAround_{false};
-      const MapType* streams_{nullptr};
-      MapType::const_iterator itr_;
-    };
-
-    MiddleStartingIterationWrapper(
-        const MapType& streams,
-        const MapType::key_type& start)
-        : streams_(streams), start_(start) {}
-
-    MiddleStartingIterator cbegin() const {
-      return MiddleStartingIterator(&streams_, start_);
-    }
-
-    MiddleStartingIterator cend() const {
-      MiddleStartingIterator itr(&streams_, start_);
-      itr.wrappedAround_ = true;
-      return itr;
-    }
-
-   private:
-    const MapType& streams_;
-    const MapType::key_type& start_;
-  };
-
-  StreamId writeStreamsHelper(
+  void writeStreamsHelper(
       PacketBuilderInterface& builder,
-      const std::set<StreamId>& writableStreams,
-      StreamId nextScheduledStream,
+      PriorityQueue& writableStreams,
       uint64_t& connWritableBytes,
       bool streamPerPacket);
 
-  using WritableStreamItr =
-      MiddleStartingIterationWrapper::MiddleStartingIterator;
-
   /**
    * Helper function to write either stream data if stream is not flow
    * controlled or a blocked frame otherwise.
@@ -254,6 +171,22 @@ class PingFrameScheduler {
   const QuicConnectionStateBase& conn_;
 };
 
+/**
+ * Writes the datagrams the application queued with writeDatagram(). A datagram
+ * is never split, the scheduler stops at the first one that does not fit.
+ */
+class DatagramFrameScheduler {
+ public:
+  explicit DatagramFrameScheduler(QuicConnectionStateBase& conn);
+
+  bool hasPendingDatagramFrames() const;
+
+  bool writeDatagramFrames(PacketBuilderInterface& builder);
+
+ private:
+  QuicConnectionStateBase& conn_;
+};
+
 class WindowUpdateScheduler {
  public:
   explicit WindowUpdateScheduler(const QuicConnectionStateBase& conn);
@@ -321,6 +254,7 @@ class FrameScheduler : public QuicPacketScheduler {
     Builder& cryptoFrames();
     Builder& simpleFrames();
     Builder& pingFrames();
+    Builder& datagramFrames();
 
     FrameScheduler build() &&;
 
@@ -340,6 +274,7 @@ class FrameScheduler : public QuicPacketScheduler {
     bool cryptoStreamScheduler_{false};
     bool simpleFrameScheduler_{false};
     bool pingFrameScheduler_{false};
+    bool datagramFrameScheduler_{false};
   };
 
   explicit FrameScheduler(std::string name);
@@ -366,6 +301,7 @@ class FrameScheduler : public QuicPacketScheduler {
   folly::Optional<CryptoStreamScheduler> cryptoStreamScheduler_;
   folly::Optional<SimpleFrameScheduler> simpleFrameScheduler_;
   folly::Optional<PingFrameScheduler> pingFrameScheduler_;
+  folly::Optional<DatagramFrameScheduler> datagramFrameScheduler_;
   std::string name_;
 };
 
@@ -131,6 +131,8 @@ class QuicSocket {
     uint64_t totalBytesRetransmitted{0};
     uint32_t ptoCount{0};
     uint32_t totalPTOCount{0};
+    uint64_t acksSent{0};
+    uint64_t acksRecvd{0};
     folly::Optional<PacketNum> largestPacketAckedByPeer;
     folly::Optional<PacketNum> largestPacketSent;
   };
@@ -335,6 +337,13 @@ class QuicSocket {
    */
   virtual uint64_t getConnectionBufferAvailable() const = 0;
 
+  /**
+   * Return the memory the transport holds for the connection, its streams
+   * and the data buffered in them. This walks every stream, so it is meant
+   * for audits rather than for the data path.
+   */
+  virtual ConnectionMemoryUsage getMemoryUsage() const = 0;
+
   /**
    * Application can invoke this function to signal the transport to
    * initiate migration.
@@ -532,7 +541,7 @@ class QuicSocket {
    * };
    */
 
-  using PeekIterator = std::deque<StreamBuffer>::const_iterator;
+  using PeekIterator = CircularDeque<StreamBuffer>::const_iterator;
   class PeekCallback {
    public:
     virtual ~PeekCallback() = default;
@@ -1011,6 +1020,49 @@ class QuicSocket {
       PingCallback* callback,
       std::chrono::milliseconds pingTimeout) = 0;
 
+  /**
+   * Callback class for datagrams
+   */
+  class DatagramCallback {
+   public:
+    virtual ~DatagramCallback() = default;
+
+    /**
+     * Invoked after a read from the network queued datagrams. They can be
+     * read with readDatagrams().
+     */
+    virtual void onDatagramsAvailable() noexcept = 0;
+  };
+
+  /**
+   * Set the callback for received datagrams, or nullptr to stop the
+   * notifications. Datagrams are queued whether there is a callback or not.
+   */
+  virtual folly::Expected<folly::Unit, LocalErrorCode> setDatagramCallback(
+      DatagramCallback* cb) = 0;
+
+  /**
+   * The largest datagram that writeDatagram() accepts. 0 if the peer does not
+   * support datagrams, or if they are not enabled in the transport settings.
+   */
+  virtual uint16_t getDatagramSizeLimit() const = 0;
+
+  /**
+   * Queue an unreliable datagram. It is sent in a DATAGRAM frame, it is
+   * congestion controlled but never retransmitted, and the peer can drop it.
+   * The buffer is inserted into the packet without a copy. When the write
+   * buffer is full the oldest queued datagram is dropped.
+   */
+  virtual folly::Expected<folly::Unit, LocalErrorCode> writeDatagram(
+      Buf buf) = 0;
+
+  /**
+   * Returns the received datagrams in the order they arrived, at most atMost
+   * of them, or all of them when atMost is 0.
+   */
+  virtual folly::Expected<std::vector<Buf>, LocalErrorCode> readDatagrams(
+      size_t atMost = 0) = 0;
+
   /**
    * Get information on the state of the quic connection. Should only be used
    * for logging.
@@ -1052,6 +1104,23 @@ class QuicSocket {
    */
   virtual folly::Optional<LocalErrorCode> setControlStream(StreamId id) = 0;
 
+  /**
+   * Set the scheduling priority of a stream. Streams with a lower level are
+   * written before streams with a higher level; level must be in
+   * [0, kDefaultMaxPriority]. Incremental streams of the same level share the
+   * connection round robin, while non-incremental streams of the same level
+   * are sent one after the other in stream id order. Control streams are
+   * always written before all other streams.
+   */
+  virtual folly::Expected<folly::Unit, LocalErrorCode>
+  setStreamPriority(StreamId id, PriorityLevel level, bool incremental) = 0;
+
+  /**
+   * Get the scheduling priority of a stream.
+   */
+  virtual folly::Expected<Priority, LocalErrorCode> getStreamPriority(
+      StreamId id) = 0;
+
   /**
    * Set congestion control type.
    */
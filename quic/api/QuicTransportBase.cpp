@@ -8,6 +8,7 @@
 
 #include <quic/api/QuicTransportBase.h>
 
+#include <folly/Chrono.h>
 #include <folly/ScopeGuard.h>
 #include <quic/api/LoopDetectorCallback.h>
 #include <quic/api/QuicTransportFunctions.h>
@@ -375,11 +376,9 @@ void QuicTransportBase::closeImpl(
 
   // Clear out all the streams, we don't need them any more. When the peer
   // receives the conn close they will implicitly reset all the streams.
-  QUIC_STATS_FOR_EACH(
-      conn_->streamManager->streams().cbegin(),
-      conn_->streamManager->streams().cend(),
-      conn_->statsCallback,
-      onQuicStreamClosed);
+  conn_->streamManager->streams().forEach([&](const QuicStreamState&) {
+    QUIC_STATS(conn_->statsCallback, onQuicStreamClosed);
+  });
   conn_->streamManager->clearOpenStreams();
 
   // Clear out all the pending events.
@@ -559,6 +558,8 @@ QuicSocket::TransportInfo QuicTransportBase::getTransportInfo() const {
   transportInfo.bytesRecvd = conn_->lossState.totalBytesRecvd;
   transportInfo.ptoCount = conn_->lossState.ptoCount;
   transportInfo.totalPTOCount = conn_->lossState.totalPTOCount;
+  transportInfo.acksSent = conn_->lossState.totalAcksSent;
+  transportInfo.acksRecvd = conn_->lossState.totalAcksRecvd;
   transportInfo.largestPacketAckedByPeer =
       conn_->ackStates.appDataAckState.largestAckedByPeer;
   transportInfo.largestPacketSent = conn_->lossState.largestSent;
@@ -582,6 +583,27 @@ uint64_t QuicTransportBase::getConnectionBufferAvailable() const {
   return bufferSpaceAvailable();
 }
 
+ConnectionMemoryUsage QuicTransportBase::getMemoryUsage() const {
+  auto usage = getConnectionMemoryUsage(*conn_, getStateSize());
+  usage.stateBytes += readCallbacks_.getAllocatedMemorySize() +
+      peekCallbacks_.getAllocatedMemorySize() +
+      dataExpiredCallbacks_.getAllocatedMemorySize() +
+      dataRejectedCallbacks_.getAllocatedMemorySize();
+  invokeForEachByteEventTypeConst([&](const ByteEvent::Type type) {
+    const auto& byteEventMap = getByteEventMapConst(type);
+    usage.stateBytes += byteEventMap.getAllocatedMemorySize();
+    for (const auto& streamByteEvents : byteEventMap) {
+      usage.stateBytes += streamByteEvents.second.capacity() *
+          sizeof(std::pair<uint64_t, ByteEventCallback*>);
+    }
+  });
+  return usage;
+}
+
+size_t QuicTransportBase::getStateSize() const {
+  return sizeof(QuicTransportBase) + sizeof(QuicConnectionStateBase);
+}
+
 uint64_t QuicTransportBase::bufferSpaceAvailable() const {
   auto bytesBuffered = conn_->flowControlState.sumCurStreamBufferLen;
   auto totalBufferSpaceAvailable =
@@ -1528,6 +1550,12 @@ void QuicTransportBase::handlePingCallback() {
   conn_->pendingEvents.cancelPingTimeout = false;
 }
 
+void QuicTransportBase::handleDatagramCallback() {
+  if (datagramCallback_ && !conn_->datagramState.readBuffer.empty()) {
+    datagramCallback_->onDatagramsAvailable();
+  }
+}
+
 void QuicTransportBase::processCallbacksAfterWriteData() {
   if (closeState_ != CloseState::OPEN) {
     return;
@@ -1614,6 +1642,11 @@ void QuicTransportBase::processCallbacksAfterNetworkData() {
     return;
   }
 
+  handleDatagramCallback();
+  if (closeState_ != CloseState::OPEN) {
+    return;
+  }
+
   // TODO: we're currently assuming that canceling write callbacks will not
   // cause reset of random streams. Maybe get rid of that assumption later.
   for (auto pendingResetIt = conn_->pendingEvents.resets.begin();
@@ -1763,10 +1796,16 @@ void QuicTransportBase::onNetworkData(
   try {
     conn_->lossState.totalBytesRecvd += networkData.totalData;
     auto originalAckVersion = currentAckStateVersion(*conn_);
-    for (auto& packet : networkData.packets) {
+    if (networkData.packets.size() > 1 && conn_->readCodec) {
+      conn_->readCodec->precomputeShortHeaderMasks(networkData.packets);
+    }
+    for (size_t i = 0; i < networkData.packets.size(); ++i) {
       onReadData(
           peer,
-          NetworkDataSingle(std::move(packet), networkData.receiveTimePoint));
+          NetworkDataSingle(
+              std::move(networkData.packets[i]),
+              networkData.receiveTimePoint,
+              networkData.getEcnCodepoint(i)));
     }
     processCallbacksAfterNetworkData();
     if (closeState_ != CloseState::CLOSED) {
@@ -1825,18 +1864,42 @@ void QuicTransportBase::setIdleTimer() {
   if (closeState_ == CloseState::CLOSED) {
     return;
   }
-  if (idleTimeout_.isScheduled()) {
-    idleTimeout_.cancelTimeout();
-  }
   auto localIdleTimeout = conn_->transportSettings.idleTimeout;
   // The local idle timeout being zero means it is disabled.
   if (localIdleTimeout == 0ms) {
+    if (idleTimeout_.isScheduled()) {
+      idleTimeout_.cancelTimeout();
+    }
     return;
   }
   auto peerIdleTimeout =
       conn_->peerIdleTimeout > 0ms ? conn_->peerIdleTimeout : localIdleTimeout;
   auto idleTimeout = timeMin(localIdleTimeout, peerIdleTimeout);
+  idleTimeout_.setDeadline(Clock::now() + idleTimeout);
+  // This runs for nearly every packet and mostly pushes the deadline later,
+  // which the timer picks up when it fires.
+  if (idleTimeout_.isScheduled() &&
+      idleTimeout_.getTimeRemaining() <= idleTimeout) {
+    return;
+  }
   getEventBase()->timer().scheduleTimeout(&idleTimeout_, idleTimeout);
+  QUIC_STATS(conn_->statsCallback, onTimerRescheduled);
+}
+
+void QuicTransportBase::idleTimeoutFired() noexcept {
+  auto& wheelTimer = getEventBase()->timer();
+  auto now = Clock::now();
+  auto deadline = idleTimeout_.getDeadline();
+  // Within a tick of the deadline is as close as the wheel gets.
+  if (deadline > now + wheelTimer.getTickInterval()) {
+    VLOG(10) << __func__ << " deadline moved " << *this;
+    wheelTimer.scheduleTimeout(
+        &idleTimeout_,
+        folly::chrono::ceil<std::chrono::milliseconds>(deadline - now));
+    QUIC_STATS(conn_->statsCallback, onTimerRescheduled);
+    return;
+  }
+  idleTimeoutExpired(true /* drain */);
 }
 
 uint64_t QuicTransportBase::getNumOpenableBidirectionalStreams() const {
@@ -2300,6 +2363,68 @@ void QuicTransportBase::sendPing(
   }
 }
 
+folly::Expected<folly::Unit, LocalErrorCode>
+QuicTransportBase::setDatagramCallback(DatagramCallback* cb) {
+  if (closeState_ != CloseState::OPEN) {
+    return folly::makeUnexpected(LocalErrorCode::CONNECTION_CLOSED);
+  }
+  datagramCallback_ = cb;
+  return folly::unit;
+}
+
+uint16_t QuicTransportBase::getDatagramSizeLimit() const {
+  // Room for the packet header, the frame header and the AEAD tag.
+  auto maxPacketPayload = conn_->udpSendPacketLen > kMaxDatagramPacketOverhead
+      ? conn_->udpSendPacketLen - kMaxDatagramPacketOverhead
+      : 0;
+  return std::min<uint64_t>(
+      conn_->datagramState.maxWriteFrameSize, maxPacketPayload);
+}
+
+folly::Expected<folly::Unit, LocalErrorCode> QuicTransportBase::writeDatagram(
+    Buf buf) {
+  if (closeState_ != CloseState::OPEN) {
+    return folly::makeUnexpected(LocalErrorCode::CONNECTION_CLOSED);
+  }
+  if (conn_->datagramState.maxWriteFrameSize == 0) {
+    return folly::makeUnexpected(LocalErrorCode::INVALID_OPERATION);
+  }
+  if (buf && buf->computeChainDataLength() > getDatagramSizeLimit()) {
+    return folly::makeUnexpected(LocalErrorCode::INVALID_WRITE_DATA);
+  }
+  auto& writeBuffer = conn_->datagramState.writeBuffer;
+  if (writeBuffer.size() >=
+      conn_->transportSettings.datagramConfig.writeBufSize) {
+    // Stale datagrams are worth less than fresh ones, drop the oldest.
+    QUIC_STATS(conn_->statsCallback, onDatagramDroppedOnWrite);
+    if (writeBuffer.empty()) {
+      return folly::unit;
+    }
+    writeBuffer.pop_front();
+  }
+  writeBuffer.push_back(std::move(buf));
+  updateWriteLooper(true);
+  return folly::unit;
+}
+
+folly::Expected<std::vector<Buf>, LocalErrorCode>
+QuicTransportBase::readDatagrams(size_t atMost) {
+  if (closeState_ != CloseState::OPEN) {
+    return folly::makeUnexpected(LocalErrorCode::CONNECTION_CLOSED);
+  }
+  auto& readBuffer = conn_->datagramState.readBuffer;
+  if (atMost == 0 || atMost > readBuffer.size()) {
+    atMost = readBuffer.size();
+  }
+  std::vector<Buf> datagrams;
+  datagrams.reserve(atMost);
+  for (size_t i = 0; i < atMost; ++i) {
+    datagrams.push_back(std::move(readBuffer.front()));
+    readBuffer.pop_front();
+  }
+  return datagrams;
+}
+
 void QuicTransportBase::lossTimeoutExpired() noexcept {
   CHECK_NE(closeState_, CloseState::CLOSED);
   // onLossDetectionAlarm will set packetToSend in pending events
@@ -2385,8 +2510,18 @@ void QuicTransportBase::scheduleLossTimeout(std::chrono::milliseconds timeout) {
     return;
   }
   auto& wheelTimer = getEventBase()->timer();
-  timeout = timeMax(timeout, wheelTimer.getTickInterval());
+  auto tickInterval = wheelTimer.getTickInterval();
+  timeout = timeMax(timeout, tickInterval);
+  // The wheel fires on ticks, moving the timer by less than one gains nothing.
+  if (lossTimeout_.isScheduled()) {
+    auto remaining = lossTimeout_.getTimeRemaining();
+    if (remaining < timeout + tickInterval &&
+        timeout < remaining + tickInterval) {
+      return;
+    }
+  }
   wheelTimer.scheduleTimeout(&lossTimeout_, timeout);
+  QUIC_STATS(conn_->statsCallback, onTimerRescheduled);
 }
 
 void QuicTransportBase::scheduleAckTimeout() {
@@ -2397,11 +2532,16 @@ void QuicTransportBase::scheduleAckTimeout() {
     if (!ackTimeout_.isScheduled()) {
       auto factoredRtt = std::chrono::duration_cast<std::chrono::microseconds>(
           kAckTimerFactor * conn_->lossState.srtt);
+      const auto& peerRequest = conn_->ackFrequencyState.peerRequest;
+      // The peer asked for a max ack delay with ACK_FREQUENCY.
+      auto maxAckTimeout = peerRequest
+          ? std::chrono::microseconds(peerRequest->updateMaxAckDelay)
+          : timeMin(kMaxAckTimeout, factoredRtt);
       auto& wheelTimer = getEventBase()->timer();
       auto timeout = timeMax(
           std::chrono::duration_cast<std::chrono::microseconds>(
               wheelTimer.getTickInterval()),
-          timeMin(kMaxAckTimeout, factoredRtt));
+          maxAckTimeout);
       auto timeoutMs =
           std::chrono::duration_cast<std::chrono::milliseconds>(timeout);
       VLOG(10) << __func__ << " timeout=" << timeoutMs.count() << "ms"
@@ -2785,6 +2925,36 @@ folly::Optional<LocalErrorCode> QuicTransportBase::setControlStream(
   return folly::none;
 }
 
+folly::Expected<folly::Unit, LocalErrorCode>
+QuicTransportBase::setStreamPriority(
+    StreamId id,
+    PriorityLevel level,
+    bool incremental) {
+  if (closeState_ != CloseState::OPEN) {
+    return folly::makeUnexpected(LocalErrorCode::CONNECTION_CLOSED);
+  }
+  if (level > kDefaultMaxPriority) {
+    return folly::makeUnexpected(LocalErrorCode::INVALID_OPERATION);
+  }
+  if (!conn_->streamManager->streamExists(id)) {
+    return folly::makeUnexpected(LocalErrorCode::STREAM_NOT_EXISTS);
+  }
+  conn_->streamManager->setStreamPriority(id, level, incremental);
+  return folly::unit;
+}
+
+folly::Expected<Priority, LocalErrorCode> QuicTransportBase::getStreamPriority(
+    StreamId id) {
+  if (closeState_ != CloseState::OPEN) {
+    return folly::makeUnexpected(LocalErrorCode::CONNECTION_CLOSED);
+  }
+  if (!conn_->streamManager->streamExists(id)) {
+    return folly::makeUnexpected(LocalErrorCode::STREAM_NOT_EXISTS);
+  }
+  auto stream = conn_->streamManager->getStream(id);
+  return stream->priority;
+}
+
 void QuicTransportBase::runOnEvbAsync(
     folly::Function<void(std::shared_ptr<QuicTransportBase>)> func) {
   auto evb = getEventBase();
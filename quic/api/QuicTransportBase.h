@@ -11,6 +11,7 @@
 #include <quic/QuicConstants.h>
 #include <quic/QuicException.h>
 #include <quic/api/QuicSocket.h>
+#include <quic/common/CircularDeque.h>
 #include <quic/common/FunctionLooper.h>
 #include <quic/common/Timers.h>
 #include <quic/congestion_control/CongestionControllerFactory.h>
@@ -97,6 +98,8 @@ class QuicTransportBase : public QuicSocket {
 
   uint64_t getConnectionBufferAvailable() const override;
 
+  ConnectionMemoryUsage getMemoryUsage() const override;
+
   uint64_t bufferSpaceAvailable() const;
 
   folly::Expected<QuicSocket::FlowControlState, LocalErrorCode>
@@ -211,6 +214,16 @@ class QuicTransportBase : public QuicSocket {
   void sendPing(PingCallback* callback, std::chrono::milliseconds pingTimeout)
       override;
 
+  folly::Expected<folly::Unit, LocalErrorCode> setDatagramCallback(
+      DatagramCallback* cb) override;
+
+  uint16_t getDatagramSizeLimit() const override;
+
+  folly::Expected<folly::Unit, LocalErrorCode> writeDatagram(Buf buf) override;
+
+  folly::Expected<std::vector<Buf>, LocalErrorCode> readDatagrams(
+      size_t atMost = 0) override;
+
   const QuicConnectionStateBase* getState() const override {
     return conn_.get();
   }
@@ -238,6 +251,14 @@ class QuicTransportBase : public QuicSocket {
 
   folly::Optional<LocalErrorCode> setControlStream(StreamId id) override;
 
+  folly::Expected<folly::Unit, LocalErrorCode> setStreamPriority(
+      StreamId id,
+      PriorityLevel level,
+      bool incremental) override;
+
+  folly::Expected<Priority, LocalErrorCode> getStreamPriority(
+      StreamId id) override;
+
   /**
    * Set the initial flow control window for the connection.
    */
@@ -300,6 +321,12 @@ class QuicTransportBase : public QuicSocket {
    */
   virtual std::shared_ptr<QuicTransportBase> sharedGuard() = 0;
 
+  /**
+   * Size of the concrete transport and connection state objects, which
+   * getMemoryUsage() can't see from here.
+   */
+  virtual size_t getStateSize() const;
+
   bool isPartiallyReliableTransport() const override;
 
   /**
@@ -471,7 +498,7 @@ class QuicTransportBase : public QuicSocket {
         : transport_(transport) {}
 
     void timeoutExpired() noexcept override {
-      transport_->idleTimeoutExpired(true /* drain */);
+      transport_->idleTimeoutFired();
     }
 
     void callbackCanceled() noexcept override {
@@ -480,8 +507,21 @@ class QuicTransportBase : public QuicSocket {
       transport_->idleTimeoutExpired(false /* drain */);
     }
 
+    /**
+     * When the connection goes idle. Activity moves the deadline without
+     * rescheduling the timer, which checks it when it fires.
+     */
+    TimePoint getDeadline() const {
+      return deadline_;
+    }
+
+    void setDeadline(TimePoint deadline) {
+      deadline_ = deadline;
+    }
+
    private:
     QuicTransportBase* transport_;
+    TimePoint deadline_;
   };
 
   // DrainTimeout is a bit different from other timeouts. It needs to hold a
@@ -593,6 +633,7 @@ class QuicTransportBase : public QuicSocket {
   void updatePeekLooper();
   void updateWriteLooper(bool thisIteration);
   void handlePingCallback();
+  void handleDatagramCallback();
 
   void runOnEvbAsync(
       folly::Function<void(std::shared_ptr<QuicTransportBase>)> func);
@@ -653,6 +694,7 @@ class QuicTransportBase : public QuicSocket {
   void ackTimeoutExpired() noexcept;
   void pathValidationTimeoutExpired() noexcept;
   void idleTimeoutExpired(bool drain) noexcept;
+  void idleTimeoutFired() noexcept;
   void drainTimeoutExpired() noexcept;
   void pingTimeoutExpired() noexcept;
 
@@ -663,8 +705,9 @@ class QuicTransportBase : public QuicSocket {
       PingCallback* callback,
       std::chrono::milliseconds pingTimeout);
 
-  using ByteEventMap = folly::
-      F14FastMap<StreamId, std::deque<std::pair<uint64_t, ByteEventCallback*>>>;
+  using ByteEventMap = folly::F14FastMap<
+      StreamId,
+      CircularDeque<std::pair<uint64_t, ByteEventCallback*>>>;
   ByteEventMap& getByteEventMap(const ByteEvent::Type type);
   [[nodiscard]] const ByteEventMap& getByteEventMapConst(
       const ByteEvent::Type type) const;
@@ -734,6 +777,7 @@ class QuicTransportBase : public QuicSocket {
   folly::F14FastMap<StreamId, DataExpiredCallbackData> dataExpiredCallbacks_;
   folly::F14FastMap<StreamId, DataRejectedCallbackData> dataRejectedCallbacks_;
   PingCallback* pingCallback_;
+  DatagramCallback* datagramCallback_{nullptr};
 
   WriteCallback* connWriteCallback_{nullptr};
   std::map<StreamId, WriteCallback*> pendingWriteCallbacks_;
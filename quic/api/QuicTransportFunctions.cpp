@@ -158,7 +158,8 @@ uint64_t writeQuicDataToSocketImpl(
           .windowUpdateFrames()
           .blockedFrames()
           .simpleFrames()
-          .pingFrames();
+          .pingFrames()
+          .datagramFrames();
   if (!exceptCryptoStream) {
     schedulerBuilder.cryptoFrames();
   }
@@ -168,10 +169,10 @@ uint64_t writeQuicDataToSocketImpl(
       connection,
       srcConnId,
       dstConnId,
-      std::move(builder),
+      builder,
       PacketNumberSpace::AppData,
       scheduler,
-      congestionControlWritableBytes,
+      CongestionControlWritableBytes(),
       packetLimit - written,
       aead,
       headerCipher,
@@ -185,7 +186,26 @@ uint64_t writeQuicDataToSocketImpl(
   return written;
 }
 
-DataPathResult continuousMemoryBuildScheduleEncrypt(
+/**
+ * Builds a packet with the scheduler, encrypts it and adds it to the batch.
+ * Specialized for building the packet in place in the buffer of
+ * connection.bufAccessor and for building it as an IOBuf chain.
+ */
+template <DataPathType dataPathType>
+DataPathResult buildScheduleEncrypt(
+    QuicConnectionStateBase& connection,
+    PacketHeader header,
+    PacketNumberSpace pnSpace,
+    PacketNum packetNum,
+    uint64_t cipherOverhead,
+    QuicPacketScheduler& scheduler,
+    uint64_t writableBytes,
+    IOBufQuicBatch& ioBufBatch,
+    const Aead& aead,
+    const PacketNumberCipher& headerCipher);
+
+template <>
+DataPathResult buildScheduleEncrypt<DataPathType::ContinuousMemory>(
     QuicConnectionStateBase& connection,
     PacketHeader header,
     PacketNumberSpace pnSpace,
@@ -255,7 +275,7 @@ DataPathResult continuousMemoryBuildScheduleEncrypt(
   packetBuf->prepend(headerLen);
 
   HeaderForm headerForm = packet->packet.header.getHeaderForm();
-  encryptPacketHeader(
+  ioBufBatch.addHeaderProtection(
       headerForm,
       packetBuf->writableData(),
       headerLen,
@@ -283,7 +303,8 @@ DataPathResult continuousMemoryBuildScheduleEncrypt(
   return DataPathResult::makeWriteResult(ret, std::move(result), encodedSize);
 }
 
-DataPathResult iobufChainBasedBuildScheduleEncrypt(
+template <>
+DataPathResult buildScheduleEncrypt<DataPathType::ChainedMemory>(
     QuicConnectionStateBase& connection,
     PacketHeader header,
     PacketNumberSpace pnSpace,
@@ -336,7 +357,7 @@ DataPathResult iobufChainBasedBuildScheduleEncrypt(
   packetBuf->append(headerLen + bodyLen + aead.getCipherOverhead());
 
   HeaderForm headerForm = packet->packet.header.getHeaderForm();
-  encryptPacketHeader(
+  ioBufBatch.addHeaderProtection(
       headerForm,
       packetBuf->writableData(),
       headerLen,
@@ -359,6 +380,101 @@ DataPathResult iobufChainBasedBuildScheduleEncrypt(
   return DataPathResult::makeWriteResult(ret, std::move(result), encodedSize);
 }
 
+template <
+    DataPathType dataPathType,
+    typename HeaderBuilderT,
+    typename WritableBytesPolicy>
+uint64_t writeConnectionDataToSocketImpl(
+    IOBufQuicBatch& ioBufBatch,
+    QuicConnectionStateBase& connection,
+    const ConnectionId& srcConnId,
+    const ConnectionId& dstConnId,
+    const HeaderBuilderT& builder,
+    PacketNumberSpace pnSpace,
+    QuicPacketScheduler& scheduler,
+    const WritableBytesPolicy& writableBytes,
+    uint64_t packetLimit,
+    const Aead& aead,
+    const PacketNumberCipher& headerCipher,
+    QuicVersion version,
+    const std::string& token) {
+  auto writeLoopBeginTime = Clock::now();
+  // helper functor to check if we have been write in a loop for longer than the
+  // RTT fraction that we are allowed to write. Only kicks in if we have write
+  // one batch in batching write mode.
+  auto timeLimitHelper = [&]() -> bool {
+    auto batchSize = connection.transportSettings.batchingMode ==
+            quic::QuicBatchingMode::BATCHING_MODE_NONE
+        ? connection.transportSettings.writeConnectionDataPacketsLimit
+        : connection.transportSettings.maxBatchSize;
+    return ioBufBatch.getPktSent() < batchSize ||
+        connection.lossState.srtt == 0us ||
+        Clock::now() - writeLoopBeginTime < connection.lossState.srtt /
+            connection.transportSettings.writeLimitRttFraction;
+  };
+  while (scheduler.hasData() && ioBufBatch.getPktSent() < packetLimit &&
+         timeLimitHelper()) {
+    auto packetNum = getNextPacketNum(connection, pnSpace);
+    auto header = builder(srcConnId, dstConnId, packetNum, version, token);
+    uint32_t packetWritableBytes = folly::to<uint32_t>(std::min<uint64_t>(
+        connection.udpSendPacketLen, writableBytes(connection)));
+    uint64_t cipherOverhead = aead.getCipherOverhead();
+    if (packetWritableBytes < cipherOverhead) {
+      packetWritableBytes = 0;
+    } else {
+      packetWritableBytes -= cipherOverhead;
+    }
+
+    auto ret = buildScheduleEncrypt<dataPathType>(
+        connection,
+        std::move(header),
+        pnSpace,
+        packetNum,
+        cipherOverhead,
+        scheduler,
+        packetWritableBytes,
+        ioBufBatch,
+        aead,
+        headerCipher);
+
+    if (!ret.buildSuccess) {
+      return ioBufBatch.getPktSent();
+    }
+
+    // If we build a packet, we updateConnection(), even if write might have
+    // been failed. Because if it builds, a lot of states need to be updated no
+    // matter the write result. We are basically treating this case as if we
+    // pretend write was also successful but packet is lost somewhere in the
+    // network.
+    auto& result = ret.result;
+    updateConnection(
+        connection,
+        std::move(result->packetEvent),
+        std::move(result->packet->packet),
+        Clock::now(),
+        folly::to<uint32_t>(ret.encodedSize));
+
+    // if ioBufBatch.write returns false
+    // it is because a flush() call failed
+    if (!ret.writeSuccess) {
+      if (connection.loopDetectorCallback) {
+        connection.writeDebugState.noWriteReason =
+            NoWriteReason::SOCKET_FAILURE;
+      }
+      return ioBufBatch.getPktSent();
+    }
+  }
+
+  ioBufBatch.flush();
+  if (dataPathType == DataPathType::ContinuousMemory) {
+    CHECK(connection.bufAccessor->ownsBuffer());
+    auto buf = connection.bufAccessor->obtain();
+    CHECK(buf->length() == 0 && buf->headroom() == 0);
+    connection.bufAccessor->release(std::move(buf));
+  }
+  return ioBufBatch.getPktSent();
+}
+
 } // namespace
 
 namespace quic {
@@ -380,13 +496,9 @@ void handleNewStreamDataWritten(
   auto bufWritten = stream.writeBuffer.splitAtMost(folly::to<size_t>(frameLen));
   DCHECK_EQ(bufWritten->computeChainDataLength(), frameLen);
   stream.currentWriteOffset += frameFin ? 1 : 0;
-  CHECK(stream.retransmissionBuffer
-            .emplace(
-                std::piecewise_construct,
-                std::forward_as_tuple(originalOffset),
-                std::forward_as_tuple(std::make_unique<StreamBuffer>(
-                    std::move(bufWritten), originalOffset, frameFin)))
-            .second);
+  CHECK(stream.retransmissionBuffer.emplace(
+      originalOffset,
+      StreamBuffer(std::move(bufWritten), originalOffset, frameFin)));
 }
 
 void handleRetransmissionWritten(
@@ -396,7 +508,7 @@ void handleRetransmissionWritten(
     uint64_t frameLen,
     bool frameFin,
     PacketNum packetNum,
-    std::deque<StreamBuffer>::iterator lossBufferIter) {
+    CircularDeque<StreamBuffer>::iterator lossBufferIter) {
   conn.lossState.totalBytesRetransmitted += frameLen;
   VLOG(10) << nodeToString(conn.nodeType) << " sent retransmission"
            << " packetNum=" << packetNum << " " << conn;
@@ -410,13 +522,8 @@ void handleRetransmissionWritten(
     lossBufferIter->offset += frameLen;
     bufWritten = lossBufferIter->data.splitAtMost(frameLen);
   }
-  CHECK(stream.retransmissionBuffer
-            .emplace(
-                std::piecewise_construct,
-                std::forward_as_tuple(frameOffset),
-                std::forward_as_tuple(std::make_unique<StreamBuffer>(
-                    std::move(bufWritten), frameOffset, frameFin)))
-            .second);
+  CHECK(stream.retransmissionBuffer.emplace(
+      frameOffset, StreamBuffer(std::move(bufWritten), frameOffset, frameFin)));
 }
 
 /**
@@ -439,12 +546,17 @@ bool handleStreamWritten(
     return true;
   }
 
-  // If the data is in the loss buffer, it is a retransmission.
-  auto lossBufferIter = std::lower_bound(
-      stream.lossBuffer.begin(),
-      stream.lossBuffer.end(),
-      frameOffset,
-      [](const auto& buf, auto off) { return buf.offset < off; });
+  // If the data is in the loss buffer, it is a retransmission. The scheduler
+  // writes the loss buffer from the front.
+  auto lossBufferIter = stream.lossBuffer.begin();
+  if (lossBufferIter != stream.lossBuffer.end() &&
+      lossBufferIter->offset != frameOffset) {
+    lossBufferIter = std::lower_bound(
+        stream.lossBuffer.begin(),
+        stream.lossBuffer.end(),
+        frameOffset,
+        [](const auto& buf, auto off) { return buf.offset < off; });
+  }
   if (lossBufferIter != stream.lossBuffer.end() &&
       lossBufferIter->offset == frameOffset) {
     handleRetransmissionWritten(
@@ -531,6 +643,7 @@ void updateConnection(
         const WriteAckFrame& writeAckFrame = *frame.asWriteAckFrame();
         DCHECK(!ackFrameCounter++)
             << "Send more than one WriteAckFrame " << conn;
+        ++conn.lossState.totalAcksSent;
         auto largestAckedPacketWritten = writeAckFrame.ackBlocks.front().end;
         VLOG(10) << nodeToString(conn.nodeType)
                  << " sent packet with largestAcked="
@@ -641,25 +754,21 @@ void updateConnection(
     DCHECK(!packetEvent);
     return;
   }
-  auto packetIt =
-      std::find_if(
-          conn.outstandings.packets.rbegin(),
-          conn.outstandings.packets.rend(),
-          [packetNum](const auto& packetWithTime) {
-            return packetWithTime.packet.header.getPacketSequenceNum() <
-                packetNum;
-          })
-          .base();
-  auto& pkt = *conn.outstandings.packets.emplace(
-      packetIt,
+  auto& packets = conn.outstandings.packets.packetsIn(packetNumberSpace);
+  auto& pkt = packets.insert(OutstandingPacket(
       std::move(packet),
       std::move(sentTime),
       encodedSize,
       isHandshake,
-      conn.lossState.totalBytesSent);
+      conn.lossState.totalBytesSent));
   pkt.isAppLimited = conn.congestionController
       ? conn.congestionController->isAppLimited()
       : false;
+  // The packet was written with the codepoint of the connection.
+  if (getEcnCodepointToSend(conn) != EcnCodepoint::NotEct) {
+    pkt.isEcnMarked = true;
+    onEcnMarkedPacketSent(conn);
+  }
   if (conn.lossState.lastAckedTime.has_value() &&
       conn.lossState.lastAckedPacketSentTime.has_value()) {
     pkt.lastAckedPacketInfo.emplace(
@@ -758,28 +867,6 @@ uint64_t unlimitedWritableBytes(const QuicConnectionStateBase&) {
   return std::numeric_limits<uint64_t>::max();
 }
 
-HeaderBuilder LongHeaderBuilder(LongHeader::Types packetType) {
-  return [packetType](
-             const ConnectionId& srcConnId,
-             const ConnectionId& dstConnId,
-             PacketNum packetNum,
-             QuicVersion version,
-             const std::string& token) {
-    return LongHeader(
-        packetType, srcConnId, dstConnId, packetNum, version, token);
-  };
-}
-
-HeaderBuilder ShortHeaderBuilder() {
-  return [](const ConnectionId& /* srcConnId */,
-            const ConnectionId& dstConnId,
-            PacketNum packetNum,
-            QuicVersion,
-            const std::string&) {
-    return ShortHeader(ProtectionType::KeyPhaseZero, dstConnId, packetNum);
-  };
-}
-
 uint64_t writeCryptoAndAckDataToSocket(
     folly::AsyncUDPSocket& sock,
     QuicConnectionStateBase& connection,
@@ -833,10 +920,10 @@ uint64_t writeCryptoAndAckDataToSocket(
       connection,
       srcConnId,
       dstConnId,
-      std::move(builder),
+      builder,
       LongHeader::typeToPacketNumberSpace(packetType),
       scheduler,
-      congestionControlWritableBytes,
+      CongestionControlWritableBytes(),
       packetLimit - written,
       cleartextCipher,
       headerCipher,
@@ -925,10 +1012,10 @@ uint64_t writeZeroRttDataToSocket(
       connection,
       srcConnId,
       dstConnId,
-      std::move(builder),
+      builder,
       LongHeader::typeToPacketNumberSpace(type),
       scheduler,
-      congestionControlWritableBytes,
+      CongestionControlWritableBytes(),
       packetLimit,
       aead,
       headerCipher,
@@ -1121,15 +1208,16 @@ void encryptPacketHeader(
   }
 }
 
+template <typename HeaderBuilderT, typename WritableBytesPolicy>
 uint64_t writeConnectionDataToSocket(
     folly::AsyncUDPSocket& sock,
     QuicConnectionStateBase& connection,
     const ConnectionId& srcConnId,
     const ConnectionId& dstConnId,
-    HeaderBuilder builder,
+    const HeaderBuilderT& builder,
     PacketNumberSpace pnSpace,
     QuicPacketScheduler& scheduler,
-    const WritableBytesFunc& writableBytesFunc,
+    const WritableBytesPolicy& writableBytes,
     uint64_t packetLimit,
     const Aead& aead,
     const PacketNumberCipher& headerCipher,
@@ -1163,95 +1251,48 @@ uint64_t writeConnectionDataToSocket(
       connection.writeDebugState.noWriteReason = NoWriteReason::EMPTY_SCHEDULER;
     }
   }
-  auto writeLoopBeginTime = Clock::now();
-  // helper functor to check if we have been write in a loop for longer than the
-  // RTT fraction that we are allowed to write. Only kicks in if we have write
-  // one batch in batching write mode.
-  auto timeLimitHelper = [&]() -> bool {
-    auto batchSize = connection.transportSettings.batchingMode ==
-            quic::QuicBatchingMode::BATCHING_MODE_NONE
-        ? connection.transportSettings.writeConnectionDataPacketsLimit
-        : connection.transportSettings.maxBatchSize;
-    return ioBufBatch.getPktSent() < batchSize ||
-        connection.lossState.srtt == 0us ||
-        Clock::now() - writeLoopBeginTime < connection.lossState.srtt /
-            connection.transportSettings.writeLimitRttFraction;
-  };
-  while (scheduler.hasData() && ioBufBatch.getPktSent() < packetLimit &&
-         timeLimitHelper()) {
-    auto packetNum = getNextPacketNum(connection, pnSpace);
-    auto header = builder(srcConnId, dstConnId, packetNum, version, token);
-    uint32_t writableBytes = folly::to<uint32_t>(std::min<uint64_t>(
-        connection.udpSendPacketLen, writableBytesFunc(connection)));
-    uint64_t cipherOverhead = aead.getCipherOverhead();
-    if (writableBytes < cipherOverhead) {
-      writableBytes = 0;
-    } else {
-      writableBytes -= cipherOverhead;
-    }
-
-    // TODO: Select a different DataPathFunc based on TransportSettings
-    const auto& dataPlainFunc =
-        connection.transportSettings.dataPathType == DataPathType::ChainedMemory
-        ? iobufChainBasedBuildScheduleEncrypt
-        : continuousMemoryBuildScheduleEncrypt;
-    auto ret = dataPlainFunc(
+  // The data path of a connection does not change, so it is picked here
+  // rather than for every packet.
+  if (connection.transportSettings.dataPathType ==
+      DataPathType::ChainedMemory) {
+    return writeConnectionDataToSocketImpl<DataPathType::ChainedMemory>(
+        ioBufBatch,
         connection,
-        std::move(header),
+        srcConnId,
+        dstConnId,
+        builder,
         pnSpace,
-        packetNum,
-        cipherOverhead,
         scheduler,
         writableBytes,
-        ioBufBatch,
+        packetLimit,
         aead,
-        headerCipher);
-
-    if (!ret.buildSuccess) {
-      return ioBufBatch.getPktSent();
-    }
-
-    // If we build a packet, we updateConnection(), even if write might have
-    // been failed. Because if it builds, a lot of states need to be updated no
-    // matter the write result. We are basically treating this case as if we
-    // pretend write was also successful but packet is lost somewhere in the
-    // network.
-    auto& result = ret.result;
-    updateConnection(
-        connection,
-        std::move(result->packetEvent),
-        std::move(result->packet->packet),
-        Clock::now(),
-        folly::to<uint32_t>(ret.encodedSize));
-
-    // if ioBufBatch.write returns false
-    // it is because a flush() call failed
-    if (!ret.writeSuccess) {
-      if (connection.loopDetectorCallback) {
-        connection.writeDebugState.noWriteReason =
-            NoWriteReason::SOCKET_FAILURE;
-      }
-      return ioBufBatch.getPktSent();
-    }
-  }
-
-  ioBufBatch.flush();
-  if (connection.transportSettings.dataPathType ==
-      DataPathType::ContinuousMemory) {
-    CHECK(connection.bufAccessor->ownsBuffer());
-    auto buf = connection.bufAccessor->obtain();
-    CHECK(buf->length() == 0 && buf->headroom() == 0);
-    connection.bufAccessor->release(std::move(buf));
+        headerCipher,
+        version,
+        token);
   }
-  return ioBufBatch.getPktSent();
+  return writeConnectionDataToSocketImpl<DataPathType::ContinuousMemory>(
+      ioBufBatch,
+      connection,
+      srcConnId,
+      dstConnId,
+      builder,
+      pnSpace,
+      scheduler,
+      writableBytes,
+      packetLimit,
+      aead,
+      headerCipher,
+      version,
+      token);
 }
 
+template <typename HeaderBuilderT>
 uint64_t writeProbingDataToSocket(
     folly::AsyncUDPSocket& sock,
     QuicConnectionStateBase& connection,
     const ConnectionId& srcConnId,
     const ConnectionId& dstConnId,
-    const HeaderBuilder& builder,
+    const HeaderBuilderT& builder,
     EncryptionLevel encryptionLevel,
     PacketNumberSpace pnSpace,
     FrameScheduler scheduler,
@@ -1272,7 +1313,7 @@ uint64_t writeProbingDataToSocket(
       builder,
       pnSpace,
       cloningScheduler,
-      unlimitedWritableBytes,
+      UnlimitedWritableBytes(),
       probesToSend,
       aead,
       headerCipher,
@@ -1294,7 +1335,7 @@ uint64_t writeProbingDataToSocket(
         builder,
         pnSpace,
         pingScheduler,
-        unlimitedWritableBytes,
+        UnlimitedWritableBytes(),
         probesToSend - written,
         aead,
         headerCipher,
@@ -1306,6 +1347,96 @@ uint64_t writeProbingDataToSocket(
   return written;
 }
 
+template uint64_t writeConnectionDataToSocket(
+    folly::AsyncUDPSocket& sock,
+    QuicConnectionStateBase& connection,
+    const ConnectionId& srcConnId,
+    const ConnectionId& dstConnId,
+    const ShortHeaderBuilder& builder,
+    PacketNumberSpace pnSpace,
+    QuicPacketScheduler& scheduler,
+    const CongestionControlWritableBytes& writableBytes,
+    uint64_t packetLimit,
+    const Aead& aead,
+    const PacketNumberCipher& headerCipher,
+    QuicVersion version,
+    const std::string& token);
+
+template uint64_t writeConnectionDataToSocket(
+    folly::AsyncUDPSocket& sock,
+    QuicConnectionStateBase& connection,
+    const ConnectionId& srcConnId,
+    const ConnectionId& dstConnId,
+    const ShortHeaderBuilder& builder,
+    PacketNumberSpace pnSpace,
+    QuicPacketScheduler& scheduler,
+    const UnlimitedWritableBytes& writableBytes,
+    uint64_t packetLimit,
+    const Aead& aead,
+    const PacketNumberCipher& headerCipher,
+    QuicVersion version,
+    const std::string& token);
+
+template uint64_t writeConnectionDataToSocket(
+    folly::AsyncUDPSocket& sock,
+    QuicConnectionStateBase& connection,
+    const ConnectionId& srcConnId,
+    const ConnectionId& dstConnId,
+    const LongHeaderBuilder& builder,
+    PacketNumberSpace pnSpace,
+    QuicPacketScheduler& scheduler,
+    const CongestionControlWritableBytes& writableBytes,
+    uint64_t packetLimit,
+    const Aead& aead,
+    const PacketNumberCipher& headerCipher,
+    QuicVersion version,
+    const std::string& token);
+
+template uint64_t writeConnectionDataToSocket(
+    folly::AsyncUDPSocket& sock,
+    QuicConnectionStateBase& connection,
+    const ConnectionId& srcConnId,
+    const ConnectionId& dstConnId,
+    const LongHeaderBuilder& builder,
+    PacketNumberSpace pnSpace,
+    QuicPacketScheduler& scheduler,
+    const UnlimitedWritableBytes& writableBytes,
+    uint64_t packetLimit,
+    const Aead& aead,
+    const PacketNumberCipher& headerCipher,
+    QuicVersion version,
+    const std::string& token);
+
+template uint64_t writeProbingDataToSocket(
+    folly::AsyncUDPSocket& sock,
+    QuicConnectionStateBase& connection,
+    const ConnectionId& srcConnId,
+    const ConnectionId& dstConnId,
+    const ShortHeaderBuilder& builder,
+    EncryptionLevel encryptionLevel,
+    PacketNumberSpace pnSpace,
+    FrameScheduler scheduler,
+    uint8_t probesToSend,
+    const Aead& aead,
+    const PacketNumberCipher& headerCipher,
+    QuicVersion version,
+    const std::string& token);
+
+template uint64_t writeProbingDataToSocket(
+    folly::AsyncUDPSocket& sock,
+    QuicConnectionStateBase& connection,
+    const ConnectionId& srcConnId,
+    const ConnectionId& dstConnId,
+    const LongHeaderBuilder& builder,
+    EncryptionLevel encryptionLevel,
+    PacketNumberSpace pnSpace,
+    FrameScheduler scheduler,
+    uint8_t probesToSend,
+    const Aead& aead,
+    const PacketNumberCipher& headerCipher,
+    QuicVersion version,
+    const std::string& token);
+
 WriteDataReason shouldWriteData(const QuicConnectionStateBase& conn) {
   if (conn.pendingEvents.numProbePackets) {
     VLOG(10) << nodeToString(conn.nodeType) << " needs write because of PTO"
@@ -1384,6 +1515,9 @@ WriteDataReason hasNonAckDataToWrite(const QuicConnectionStateBase& conn) {
   if (conn.pendingEvents.sendPing) {
     return WriteDataReason::PING;
   }
+  if (!conn.datagramState.writeBuffer.empty()) {
+    return WriteDataReason::DATAGRAM;
+  }
   return WriteDataReason::NO_WRITE;
 }
 
@@ -1406,23 +1540,18 @@ void implicitAckCryptoStream(
       ? PacketNumberSpace::Handshake
       : PacketNumberSpace::Initial;
   auto& ackState = getAckState(conn, packetNumSpace);
-  AckBlocks ackBlocks;
   ReadAckFrame implicitAck;
   implicitAck.ackDelay = 0ms;
-  for (const auto& op : conn.outstandings.packets) {
-    if (op.packet.header.getPacketNumberSpace() == packetNumSpace) {
-      ackBlocks.insert(op.packet.header.getPacketSequenceNum());
-    }
-  }
-  if (ackBlocks.empty()) {
+  const auto& packets = conn.outstandings.packets.packetsIn(packetNumSpace);
+  if (packets.empty()) {
     return;
   }
   // Construct an implicit ack covering the entire range of packets.
   // If some of these have already been ACK'd then processAckFrame
   // should simply ignore them.
-  implicitAck.largestAcked = ackBlocks.back().end;
+  implicitAck.largestAcked = packets.endPacketNum() - 1;
   implicitAck.ackBlocks.emplace_back(
-      ackBlocks.front().start, implicitAck.largestAcked);
+      packets.firstPacketNum(), implicitAck.largestAcked);
   processAckFrame(
       conn,
       packetNumSpace,
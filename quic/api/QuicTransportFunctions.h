@@ -51,28 +51,6 @@ struct DataPathResult {
         encodedSize(encodedSizeIn) {}
 };
 
-using DataPathFunc = std::function<DataPathResult(
-    QuicConnectionStateBase&,
-    PacketHeader,
-    PacketNumberSpace,
-    PacketNum,
-    uint64_t,
-    QuicPacketScheduler&,
-    uint64_t,
-    IOBufQuicBatch&,
-    const Aead&,
-    const PacketNumberCipher&)>;
-
-using HeaderBuilder = std::function<PacketHeader(
-    const ConnectionId& srcConnId,
-    const ConnectionId& dstConnId,
-    PacketNum packetNum,
-    QuicVersion version,
-    const std::string& token)>;
-
-using WritableBytesFunc =
-    std::function<uint64_t(const QuicConnectionStateBase& conn)>;
-
 /**
  * Attempts to write data from all frames in the QUIC connection into the UDP
  * socket supplied with the aead and the headerCipher.
@@ -163,7 +141,7 @@ void handleRetransmissionWritten(
     uint64_t frameLen,
     bool frameFin,
     PacketNum packetNum,
-    std::deque<StreamBuffer>::iterator lossBufferIter);
+    CircularDeque<StreamBuffer>::iterator lossBufferIter);
 
 /**
  * Update the connection and stream state after stream data is written and deal
@@ -197,6 +175,55 @@ uint64_t congestionControlWritableBytes(const QuicConnectionStateBase& conn);
 
 uint64_t unlimitedWritableBytes(const QuicConnectionStateBase&);
 
+/**
+ * Header builders and writable bytes policies for
+ * writeConnectionDataToSocket(). The write loop is a template on them, so
+ * that building the header of each packet and checking how much of it can be
+ * written are inlined into the loop.
+ */
+class ShortHeaderBuilder {
+ public:
+  PacketHeader operator()(
+      const ConnectionId& /* srcConnId */,
+      const ConnectionId& dstConnId,
+      PacketNum packetNum,
+      QuicVersion,
+      const std::string&) const {
+    return ShortHeader(ProtectionType::KeyPhaseZero, dstConnId, packetNum);
+  }
+};
+
+class LongHeaderBuilder {
+ public:
+  explicit LongHeaderBuilder(LongHeader::Types packetType)
+      : packetType_(packetType) {}
+
+  PacketHeader operator()(
+      const ConnectionId& srcConnId,
+      const ConnectionId& dstConnId,
+      PacketNum packetNum,
+      QuicVersion version,
+      const std::string& token) const {
+    return LongHeader(
+        packetType_, srcConnId, dstConnId, packetNum, version, token);
+  }
+
+ private:
+  LongHeader::Types packetType_;
+};
+
+struct CongestionControlWritableBytes {
+  uint64_t operator()(const QuicConnectionStateBase& conn) const {
+    return congestionControlWritableBytes(conn);
+  }
+};
+
+struct UnlimitedWritableBytes {
+  uint64_t operator()(const QuicConnectionStateBase& conn) const {
+    return unlimitedWritableBytes(conn);
+  }
+};
+
 void writeCloseCommon(
     folly::AsyncUDPSocket& sock,
     QuicConnectionStateBase& connection,
@@ -249,30 +276,38 @@ void encryptPacketHeader(
 /**
  * Writes the connections data to the socket using the header
  * builder as well as the scheduler. This will write the amount of
- * data allowed by the writableBytesFunc and will only write a maximum
+ * data allowed by the writableBytes policy and will only write a maximum
  * number of packetLimit packets at each invocation.
+ *
+ * Instantiated for ShortHeaderBuilder and LongHeaderBuilder with both
+ * writable bytes policies.
  */
+template <typename HeaderBuilderT, typename WritableBytesPolicy>
 uint64_t writeConnectionDataToSocket(
     folly::AsyncUDPSocket& sock,
     QuicConnectionStateBase& connection,
     const ConnectionId& srcConnId,
     const ConnectionId& dstConnId,
-    HeaderBuilder builder,
+    const HeaderBuilderT& builder,
     PacketNumberSpace pnSpace,
     QuicPacketScheduler& scheduler,
-    const WritableBytesFunc& writableBytesFunc,
+    const WritableBytesPolicy& writableBytes,
     uint64_t packetLimit,
     const Aead& aead,
     const PacketNumberCipher& headerCipher,
     QuicVersion version,
     const std::string& token = std::string());
 
+/**
+ * Instantiated for ShortHeaderBuilder and LongHeaderBuilder.
+ */
+template <typename HeaderBuilderT>
 uint64_t writeProbingDataToSocket(
     folly::AsyncUDPSocket& sock,
     QuicConnectionStateBase& connection,
     const ConnectionId& srcConnId,
     const ConnectionId& dstConnId,
-    const HeaderBuilder& builder,
+    const HeaderBuilderT& builder,
     EncryptionLevel encryptionLevel,
     PacketNumberSpace pnSpace,
     FrameScheduler scheduler,
@@ -282,9 +317,6 @@ uint64_t writeProbingDataToSocket(
     QuicVersion version,
     const std::string& token = std::string());
 
-HeaderBuilder LongHeaderBuilder(LongHeader::Types packetType);
-HeaderBuilder ShortHeaderBuilder();
-
 void maybeSendStreamLimitUpdates(QuicConnectionStateBase& conn);
 
 void implicitAckCryptoStream(
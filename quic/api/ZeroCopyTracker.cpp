@@ -0,0 +1,151 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ *
+ */
+
+#include <quic/api/ZeroCopyTracker.h>
+
+#include <climits>
+#include <cstring>
+
+#include <folly/net/NetOps.h>
+
+#if defined(FOLLY_HAVE_MSG_ERRQUEUE) && defined(SO_ZEROCOPY) && \
+    defined(MSG_ZEROCOPY)
+#define QUIC_ZERO_COPY_SUPPORTED 1
+#else
+#define QUIC_ZERO_COPY_SUPPORTED 0
+#endif
+
+namespace quic {
+
+ZeroCopyTracker::ZeroCopyTracker(
+    FOLLY_MAYBE_UNUSED folly::AsyncUDPSocket& sock,
+    size_t minWriteSize,
+    QuicTransportStatsCallback* statsCallback)
+    : minWriteSize_(minWriteSize), statsCallback_(statsCallback) {
+#if QUIC_ZERO_COPY_SUPPORTED
+  fd_ = sock.getNetworkSocket().toFd();
+  int val = 1;
+  auto ret = folly::netops::setsockopt(
+      sock.getNetworkSocket(), SOL_SOCKET, SO_ZEROCOPY, &val, sizeof(val));
+  enabled_ = (fd_ >= 0 && ret == 0);
+  if (!enabled_) {
+    VLOG(4) << "Zero copy writes are not supported by the socket, errno="
+            << errno;
+  }
+#endif
+}
+
+bool ZeroCopyTracker::shouldUse(
+    const folly::AsyncUDPSocket& sock,
+    size_t size) const {
+  // The happy eyeballs second socket of a client has no tracker.
+  return enabled_ && size >= minWriteSize_ &&
+      sock.getNetworkSocket().toFd() == fd_;
+}
+
+ssize_t ZeroCopyTracker::writeWithCopy(
+    folly::AsyncUDPSocket& sock,
+    const folly::SocketAddress& address,
+    const std::unique_ptr<folly::IOBuf>& buf,
+    const UdpWriteOptions& options) {
+  if ((options.txTime || options.tos) && iovecs_.size() <= IOV_MAX) {
+    return sendUdpMessage(
+        sock, address, iovecs_.data(), iovecs_.size(), options, 0);
+  }
+  return options.gso > 0 ? sock.writeGSO(address, buf, options.gso)
+                         : sock.write(address, buf);
+}
+
+ssize_t ZeroCopyTracker::write(
+    folly::AsyncUDPSocket& sock,
+    const folly::SocketAddress& address,
+    std::unique_ptr<folly::IOBuf>& buf,
+    const UdpWriteOptions& options) {
+  iovecs_.clear();
+  buf->appendToIov(&iovecs_);
+#if QUIC_ZERO_COPY_SUPPORTED
+  DCHECK(shouldUse(sock, buf->computeChainDataLength()));
+  if (iovecs_.size() > IOV_MAX) {
+    QUIC_STATS(statsCallback_, onZeroCopyFallback, 1);
+    return writeWithCopy(sock, address, buf, options);
+  }
+
+  auto ret = sendUdpMessage(
+      sock, address, iovecs_.data(), iovecs_.size(), options, MSG_ZEROCOPY);
+  if (ret < 0 && errno == ENOBUFS) {
+    // Out of optmem for the notifications, the next write may do better.
+    QUIC_STATS(statsCallback_, onZeroCopyFallback, 1);
+    return writeWithCopy(sock, address, buf, options);
+  }
+  if (ret >= 0) {
+    pendingBufs_.emplace(nextId_++, std::move(buf));
+  }
+  return ret;
+#else
+  return writeWithCopy(sock, address, buf, options);
+#endif
+}
+
+bool ZeroCopyTracker::onErrMessage(FOLLY_MAYBE_UNUSED const cmsghdr& cmsg) {
+#if QUIC_ZERO_COPY_SUPPORTED
+  if (!(cmsg.cmsg_level == SOL_IP && cmsg.cmsg_type == IP_RECVERR) &&
+      !(cmsg.cmsg_level == SOL_IPV6 && cmsg.cmsg_type == IPV6_RECVERR)) {
+    return false;
+  }
+  const struct sock_extended_err* serr =
+      reinterpret_cast<const struct sock_extended_err*>(CMSG_DATA(&cmsg));
+  if (serr->ee_errno != 0 || serr->ee_origin != SO_EE_ORIGIN_ZEROCOPY) {
+    return false;
+  }
+  // The notification covers the ids in [ee_info, ee_data], which can wrap.
+  uint32_t first = serr->ee_info;
+  uint32_t last = serr->ee_data;
+  for (uint32_t id = first;; ++id) {
+    auto it = pendingBufs_.find(id);
+    if (it != pendingBufs_.end()) {
+      releaseBuffer(std::move(it->second));
+      pendingBufs_.erase(it);
+    }
+    if (id == last) {
+      break;
+    }
+  }
+  size_t numWrites = static_cast<uint32_t>(last - first) + 1;
+  if (serr->ee_code & SO_EE_CODE_ZEROCOPY_COPIED) {
+    // The kernel could not send from our pages, e.g. over loopback.
+    QUIC_STATS(statsCallback_, onZeroCopyFallback, numWrites);
+  } else {
+    QUIC_STATS(statsCallback_, onZeroCopyCompletion, numWrites);
+  }
+  return true;
+#else
+  return false;
+#endif
+}
+
+std::unique_ptr<folly::IOBuf> ZeroCopyTracker::getBuffer(size_t capacity) {
+  while (!freeBufs_.empty()) {
+    auto buf = std::move(freeBufs_.back());
+    freeBufs_.pop_back();
+    if (buf->capacity() >= capacity) {
+      buf->clear();
+      return buf;
+    }
+  }
+  return folly::IOBuf::create(capacity);
+}
+
+void ZeroCopyTracker::releaseBuffer(std::unique_ptr<folly::IOBuf> buf) {
+  // A chained or shared buffer may still be read by someone else.
+  if (freeBufs_.size() < kMaxZeroCopyFreeBufs && !buf->isChained() &&
+      !buf->isSharedOne()) {
+    freeBufs_.push_back(std::move(buf));
+  }
+}
+
+} // namespace quic
@@ -0,0 +1,112 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ *
+ */
+
+#pragma once
+
+#include <folly/container/F14Map.h>
+#include <folly/io/IOBuf.h>
+#include <folly/io/async/AsyncUDPSocket.h>
+#include <quic/common/SocketUtil.h>
+#include <quic/state/QuicTransportStatsCallback.h>
+
+namespace quic {
+
+// Buffers of completed zero copy writes kept for the next batches.
+constexpr size_t kMaxZeroCopyFreeBufs = 4;
+
+/**
+ * Writes GSO batches to a UDP socket with MSG_ZEROCOPY. The kernel sends
+ * straight from the buffers of a zero copy write, so the tracker holds them
+ * until the kernel reports on the error queue of the socket that it is done
+ * with them.
+ *
+ * The kernel numbers the zero copy writes of each socket. All the transports
+ * that share a socket, like the ones of a server worker, must share its
+ * tracker too.
+ */
+class ZeroCopyTracker {
+ public:
+  /**
+   * Enables SO_ZEROCOPY on sock. Writes smaller than minWriteSize bytes are
+   * not worth the page pinning and the notification, they are copied.
+   */
+  ZeroCopyTracker(
+      folly::AsyncUDPSocket& sock,
+      size_t minWriteSize,
+      QuicTransportStatsCallback* statsCallback);
+
+  ZeroCopyTracker(const ZeroCopyTracker&) = delete;
+  ZeroCopyTracker& operator=(const ZeroCopyTracker&) = delete;
+
+  /**
+   * False if the platform or the socket does not support zero copy writes.
+   */
+  bool enabled() const {
+    return enabled_;
+  }
+
+  /**
+   * Whether a write of size bytes to sock should go through write().
+   */
+  bool shouldUse(const folly::AsyncUDPSocket& sock, size_t size) const;
+
+  /**
+   * Writes buf to address with the control messages of options, see
+   * sendUdpMessage(). Returns the result of the socket write like
+   * AsyncUDPSocket::writeGSO(). buf is moved into the tracker when it is
+   * written without a copy. When the kernel is out of memory for zero copy
+   * writes, it is written with a copy and left to the caller.
+   */
+  ssize_t write(
+      folly::AsyncUDPSocket& sock,
+      const folly::SocketAddress& address,
+      std::unique_ptr<folly::IOBuf>& buf,
+      const UdpWriteOptions& options);
+
+  /**
+   * Releases the buffers of the writes the kernel completed. Returns false if
+   * cmsg is not a zero copy notification.
+   */
+  bool onErrMessage(const cmsghdr& cmsg);
+
+  /**
+   * Returns an empty buffer of at least capacity bytes for the next batch.
+   * The buffers of completed writes are reused, only when there is none of
+   * the right size is one allocated.
+   */
+  std::unique_ptr<folly::IOBuf> getBuffer(size_t capacity);
+
+  size_t numPendingWrites() const {
+    return pendingBufs_.size();
+  }
+
+  size_t numFreeBufs() const {
+    return freeBufs_.size();
+  }
+
+ private:
+  ssize_t writeWithCopy(
+      folly::AsyncUDPSocket& sock,
+      const folly::SocketAddress& address,
+      const std::unique_ptr<folly::IOBuf>& buf,
+      const UdpWriteOptions& options);
+
+  void releaseBuffer(std::unique_ptr<folly::IOBuf> buf);
+
+  int fd_{-1};
+  bool enabled_{false};
+  size_t minWriteSize_;
+  QuicTransportStatsCallback* statsCallback_;
+  // Id the kernel gives to the next successful zero copy write.
+  uint32_t nextId_{0};
+  folly::F14FastMap<uint32_t, std::unique_ptr<folly::IOBuf>> pendingBufs_;
+  std::vector<std::unique_ptr<folly::IOBuf>> freeBufs_;
+  folly::fbvector<struct iovec> iovecs_;
+};
+
+} // namespace quic
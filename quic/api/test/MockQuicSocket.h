@@ -63,6 +63,7 @@ class MockQuicSocket : public QuicSocket {
   MOCK_METHOD2(setReceiveWindow, void(StreamId, size_t));
   MOCK_METHOD3(setSendBuffer, void(StreamId, size_t, size_t));
   MOCK_CONST_METHOD0(getConnectionBufferAvailable, uint64_t());
+  MOCK_CONST_METHOD0(getMemoryUsage, ConnectionMemoryUsage());
   MOCK_CONST_METHOD0(
       getConnectionFlowControl,
       folly::Expected<FlowControlState, LocalErrorCode>());
@@ -199,11 +200,47 @@ class MockQuicSocket : public QuicSocket {
       maybeResetStreamFromReadError,
       folly::Expected<folly::Unit, LocalErrorCode>(StreamId, QuicErrorCode));
   MOCK_METHOD2(sendPing, void(PingCallback*, std::chrono::milliseconds));
+  MOCK_METHOD1(
+      setDatagramCallback,
+      folly::Expected<folly::Unit, LocalErrorCode>(DatagramCallback*));
+  MOCK_CONST_METHOD0(getDatagramSizeLimit, uint16_t());
+  folly::Expected<folly::Unit, LocalErrorCode> writeDatagram(
+      Buf data) override {
+    SharedBuf sharedData(data.release());
+    return writeDatagram(sharedData);
+  }
+  MOCK_METHOD1(
+      writeDatagram,
+      folly::Expected<folly::Unit, LocalErrorCode>(SharedBuf));
+  folly::Expected<std::vector<Buf>, LocalErrorCode> readDatagrams(
+      size_t atMost) override {
+    auto res = readDatagramsNaked(atMost);
+    if (res.hasError()) {
+      return folly::makeUnexpected(res.error());
+    }
+    std::vector<Buf> datagrams;
+    for (auto datagram : res.value()) {
+      datagrams.emplace_back(datagram);
+    }
+    return datagrams;
+  }
+  using ReadDatagramsResult =
+      folly::Expected<std::vector<folly::IOBuf*>, LocalErrorCode>;
+  MOCK_METHOD1(readDatagramsNaked, ReadDatagramsResult(size_t));
   MOCK_CONST_METHOD0(getState, const QuicConnectionStateBase*());
   MOCK_METHOD0(isDetachable, bool());
   MOCK_METHOD1(attachEventBase, void(folly::EventBase*));
   MOCK_METHOD0(detachEventBase, void());
   MOCK_METHOD1(setControlStream, folly::Optional<LocalErrorCode>(StreamId));
+  MOCK_METHOD3(
+      setStreamPriority,
+      folly::Expected<folly::Unit, LocalErrorCode>(
+          StreamId,
+          PriorityLevel,
+          bool));
+  MOCK_METHOD1(
+      getStreamPriority,
+      folly::Expected<Priority, LocalErrorCode>(StreamId));
 
   MOCK_METHOD2(
       setPeekCallback,
@@ -296,6 +296,13 @@ class MockQuicTransport : public QuicServerTransport {
   GMOCK_METHOD1_(, noexcept, , setConnectionIdAlgo, void(ConnectionIdAlgo*));
 
   MOCK_METHOD1(setBufAccessor, void(BufAccessor*));
+  MOCK_METHOD1(setZeroCopyTracker, void(ZeroCopyTracker*));
+  MOCK_METHOD1(
+      setReceiveWindowBudget,
+      void(std::shared_ptr<ReceiveWindowBudget>));
+  MOCK_METHOD1(
+      setCongestionStateCache,
+      void(std::shared_ptr<CongestionStateCache>));
 };
 
 class MockLoopDetectorCallback : public LoopDetectorCallback {
@@ -11,6 +11,7 @@
 #include <folly/io/async/test/MockAsyncUDPSocket.h>
 #include <gtest/gtest.h>
 #include <quic/server/state/ServerStateMachine.h>
+#include <quic/state/test/MockQuicStats.h>
 
 using namespace testing;
 
@@ -624,6 +625,155 @@ TEST_P(QuicBatchWriterTest, InplaceWriterBufResidueCheck) {
   EXPECT_EQ(0, rawBuf->headroom());
 }
 
+TEST(QuicThreadLocalBatchWriterTest, FlushAtLoopEnd) {
+  folly::EventBase evb;
+  folly::AsyncUDPSocket sock(&evb);
+  sock.setReuseAddr(false);
+  sock.bind(folly::SocketAddress("127.0.0.1", 0));
+  // thread local batching is only used with GSO
+  if (sock.getGSO() < 0) {
+    return;
+  }
+  folly::AsyncUDPSocket peer1(&evb);
+  peer1.bind(folly::SocketAddress("127.0.0.1", 0));
+  folly::AsyncUDPSocket peer2(&evb);
+  peer2.bind(folly::SocketAddress("127.0.0.1", 0));
+
+  // Two connections write in the same loop iteration.
+  QuicServerConnectionState conn;
+  std::string strTest(kStrLen, 'A');
+  for (auto peer : {&peer1, &peer2}) {
+    auto batchWriter = quic::BatchWriterFactory::makeBatchWriter(
+        sock,
+        quic::QuicBatchingMode::BATCHING_MODE_SENDMMSG_GSO,
+        kBatchNum,
+        true /* useThreadLocal */,
+        std::chrono::microseconds::zero(),
+        DataPathType::ChainedMemory,
+        conn);
+    EXPECT_FALSE(batchWriter->append(
+        folly::IOBuf::copyBuffer(strTest), kStrLen, peer->address(), &sock));
+  }
+
+  char buf[kStrLenGT];
+  for (auto peer : {&peer1, &peer2}) {
+    EXPECT_LT(
+        ::recv(peer->getNetworkSocket().toFd(), buf, sizeof(buf), MSG_DONTWAIT),
+        0);
+  }
+  evb.loopOnce(EVLOOP_NONBLOCK);
+  for (auto peer : {&peer1, &peer2}) {
+    EXPECT_EQ(
+        ::recv(peer->getNetworkSocket().toFd(), buf, sizeof(buf), MSG_DONTWAIT),
+        kStrLen);
+  }
+
+  // Disabling the thread local batching releases the socket of the cache
+  // before the EventBase is gone.
+  quic::BatchWriterFactory::makeBatchWriter(
+      sock,
+      quic::QuicBatchingMode::BATCHING_MODE_NONE,
+      1,
+      false /* useThreadLocal */,
+      quic::kDefaultThreadLocalDelay,
+      DataPathType::ChainedMemory,
+      conn);
+}
+
+#ifdef FOLLY_HAVE_MSG_ERRQUEUE
+TEST(QuicZeroCopyWriteTest, GSOWriterHandsBatchToTracker) {
+  folly::EventBase evb;
+  folly::AsyncUDPSocket sock(&evb);
+  sock.setReuseAddr(false);
+  sock.bind(folly::SocketAddress("127.0.0.1", 0));
+  if (sock.getGSO() < 0) {
+    return;
+  }
+  MockQuicStats stats;
+  ZeroCopyTracker tracker(sock, kStrLen * kBatchNum, &stats);
+  if (!tracker.enabled()) {
+    return;
+  }
+  folly::AsyncUDPSocket peer(&evb);
+  peer.bind(folly::SocketAddress("127.0.0.1", 0));
+
+  QuicServerConnectionState conn;
+  conn.zeroCopyTracker = &tracker;
+  auto batchWriter = quic::BatchWriterFactory::makeBatchWriter(
+      sock,
+      quic::QuicBatchingMode::BATCHING_MODE_GSO,
+      kBatchNum,
+      false /* useThreadLocal */,
+      quic::kDefaultThreadLocalDelay,
+      DataPathType::ChainedMemory,
+      conn);
+  std::string strTest(kStrLen, 'A');
+  for (size_t i = 0; i < kBatchNum; ++i) {
+    batchWriter->append(
+        folly::IOBuf::copyBuffer(strTest), kStrLen, peer.address(), &sock);
+  }
+  EXPECT_EQ(kStrLen * kBatchNum, batchWriter->write(sock, peer.address()));
+  batchWriter->reset();
+  EXPECT_EQ(1, tracker.numPendingWrites());
+
+  // The kernel copies loopback writes and says so in the notification.
+  alignas(cmsghdr) char control[CMSG_SPACE(sizeof(sock_extended_err))] = {};
+  auto cmsg = reinterpret_cast<cmsghdr*>(control);
+  cmsg->cmsg_level = SOL_IP;
+  cmsg->cmsg_type = IP_RECVERR;
+  cmsg->cmsg_len = CMSG_LEN(sizeof(sock_extended_err));
+  auto serr = reinterpret_cast<sock_extended_err*>(CMSG_DATA(cmsg));
+  serr->ee_origin = SO_EE_ORIGIN_ZEROCOPY;
+  serr->ee_code = SO_EE_CODE_ZEROCOPY_COPIED;
+  serr->ee_info = 0;
+  serr->ee_data = 0;
+  EXPECT_CALL(stats, onZeroCopyFallback(1));
+  EXPECT_TRUE(tracker.onErrMessage(*cmsg));
+  EXPECT_EQ(0, tracker.numPendingWrites());
+}
+
+TEST(QuicZeroCopyWriteTest, CompletedBuffersAreReused) {
+  folly::EventBase evb;
+  folly::AsyncUDPSocket sock(&evb);
+  sock.setReuseAddr(false);
+  sock.bind(folly::SocketAddress("127.0.0.1", 0));
+  MockQuicStats stats;
+  ZeroCopyTracker tracker(sock, kStrLen, &stats);
+  if (!tracker.enabled()) {
+    return;
+  }
+  folly::AsyncUDPSocket peer(&evb);
+  peer.bind(folly::SocketAddress("127.0.0.1", 0));
+
+  auto buf = tracker.getBuffer(kStrLen * kBatchNum);
+  auto data = buf->data();
+  memset(buf->writableTail(), 'A', kStrLen);
+  buf->append(kStrLen);
+  EXPECT_EQ(
+      kStrLen, tracker.write(sock, peer.address(), buf, UdpWriteOptions()));
+  EXPECT_EQ(nullptr, buf);
+  EXPECT_EQ(0, tracker.numFreeBufs());
+
+  alignas(cmsghdr) char control[CMSG_SPACE(sizeof(sock_extended_err))] = {};
+  auto cmsg = reinterpret_cast<cmsghdr*>(control);
+  cmsg->cmsg_level = SOL_IP;
+  cmsg->cmsg_type = IP_RECVERR;
+  cmsg->cmsg_len = CMSG_LEN(sizeof(sock_extended_err));
+  auto serr = reinterpret_cast<sock_extended_err*>(CMSG_DATA(cmsg));
+  serr->ee_origin = SO_EE_ORIGIN_ZEROCOPY;
+  serr->ee_code = SO_EE_CODE_ZEROCOPY_COPIED;
+  EXPECT_CALL(stats, onZeroCopyFallback(1));
+  EXPECT_TRUE(tracker.onErrMessage(*cmsg));
+  EXPECT_EQ(1, tracker.numFreeBufs());
+
+  // The next batch goes to the completed buffer, emptied.
+  auto reused = tracker.getBuffer(kStrLen * kBatchNum);
+  EXPECT_EQ(data, reused->data());
+  EXPECT_EQ(0, reused->length());
+  EXPECT_EQ(0, tracker.numFreeBufs());
+}
+#endif
+
 INSTANTIATE_TEST_CASE_P(
     QuicBatchWriterTest,
     QuicBatchWriterTest,
@@ -0,0 +1,115 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ *
+ */
+
+#include <folly/Benchmark.h>
+#include <folly/init/Init.h>
+
+#include <quic/api/QuicPacketScheduler.h>
+#include <quic/common/test/TestUtils.h>
+#include <quic/server/state/ServerStateMachine.h>
+#include <quic/state/QuicStreamFunctions.h>
+
+#include <set>
+
+using namespace quic;
+
+namespace {
+
+constexpr size_t kNumStreams = 10000;
+
+std::unique_ptr<QuicServerConnectionState> createConnWithWritableStreams(
+    size_t numStreams,
+    bool mixedPriority) {
+  auto conn = std::make_unique<QuicServerConnectionState>();
+  conn->streamManager->setMaxLocalBidirectionalStreams(numStreams);
+  conn->flowControlState.peerAdvertisedMaxOffset =
+      kDefaultConnectionWindowSize * kNumStreams;
+  conn->flowControlState.peerAdvertisedInitialMaxStreamOffsetBidiLocal =
+      kDefaultStreamWindowSize;
+  conn->flowControlState.peerAdvertisedInitialMaxStreamOffsetBidiRemote =
+      kDefaultStreamWindowSize;
+  for (size_t i = 0; i < numStreams; i++) {
+    auto stream = conn->streamManager->createNextBidirectionalStream().value();
+    if (mixedPriority) {
+      conn->streamManager->setStreamPriority(
+          stream->id, i % kDefaultPriorityLevels, i % 2 == 0);
+    }
+    // Small writes so that a packet carries frames of several streams.
+    writeDataToQuicStream(
+        *stream, folly::IOBuf::copyBuffer(std::string(100, 'a')), false);
+  }
+  return conn;
+}
+
+void scheduleStreams(
+    QuicServerConnectionState& conn,
+    size_t iters,
+    folly::BenchmarkSuspender& suspender) {
+  StreamFrameScheduler scheduler(conn);
+  auto connId = test::getTestConnectionId();
+  suspender.dismiss();
+  for (size_t i = 0; i < iters; i++) {
+    ShortHeader shortHeader(ProtectionType::KeyPhaseZero, connId, i);
+    RegularQuicPacketBuilder builder(
+        conn.udpSendPacketLen, std::move(shortHeader), 0);
+    builder.encodePacketHeader();
+    scheduler.writeStreams(builder);
+    folly::doNotOptimizeAway(builder.remainingSpaceInPkt());
+  }
+  suspender.rehire();
+}
+
+} // namespace
+
+BENCHMARK(ScheduleStreams10kDefaultPriority, iters) {
+  folly::BenchmarkSuspender suspender;
+  auto conn = createConnWithWritableStreams(kNumStreams, false);
+  scheduleStreams(*conn, iters, suspender);
+}
+
+BENCHMARK_RELATIVE(ScheduleStreams10kMixedPriority, iters) {
+  folly::BenchmarkSuspender suspender;
+  auto conn = createConnWithWritableStreams(kNumStreams, true);
+  scheduleStreams(*conn, iters, suspender);
+}
+
+BENCHMARK_DRAW_LINE();
+
+// The writable streams used to be kept in a std::set, this is the baseline for
+// the insert/erase churn of streams becoming writable and drained.
+BENCHMARK(StdSetWritableChurn10k, iters) {
+  std::set<StreamId> writable;
+  for (size_t i = 0; i < iters; i++) {
+    for (StreamId id = 0; id < kNumStreams * 4; id += 4) {
+      writable.insert(id);
+    }
+    for (StreamId id = 0; id < kNumStreams * 4; id += 4) {
+      writable.erase(id);
+    }
+  }
+  folly::doNotOptimizeAway(writable.size());
+}
+
+BENCHMARK_RELATIVE(PriorityQueueWritableChurn10k, iters) {
+  PriorityQueue writable;
+  for (size_t i = 0; i < iters; i++) {
+    for (StreamId id = 0; id < kNumStreams * 4; id += 4) {
+      writable.insertOrUpdate(id, kDefaultPriority);
+    }
+    for (StreamId id = 0; id < kNumStreams * 4; id += 4) {
+      writable.erase(id);
+    }
+  }
+  folly::doNotOptimizeAway(writable.size());
+}
+
+int main(int argc, char** argv) {
+  folly::init(&argc, &argv);
+  folly::runBenchmarks();
+  return 0;
+}
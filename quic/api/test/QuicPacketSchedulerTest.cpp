@@ -73,6 +73,16 @@ PacketNum addOutstandingPacket(QuicConnectionStateBase& conn) {
   return nextPacketNum;
 }
 
+StreamId nextScheduledStream(QuicConnectionStateBase& conn) {
+  return conn.streamManager->writableStreams().getNextScheduledStream().value();
+}
+
+StreamId nextScheduledControlStream(QuicConnectionStateBase& conn) {
+  return conn.streamManager->writableControlStreams()
+      .getNextScheduledStream()
+      .value();
+}
+
 } // namespace
 
 namespace quic {
@@ -406,6 +416,33 @@ TEST_F(QuicPacketSchedulerTest, StreamFrameNoSpace) {
   EXPECT_EQ(builder.remainingSpaceInPkt(), originalSpace);
 }
 
+TEST_F(QuicPacketSchedulerTest, DatagramFrameSchedulerStopsWhenFull) {
+  QuicClientConnectionState conn(
+      FizzClientQuicHandshakeContext::Builder().build());
+  for (int i = 0; i < 3; ++i) {
+    conn.datagramState.writeBuffer.push_back(folly::IOBuf::create(500));
+    conn.datagramState.writeBuffer.back()->append(500);
+  }
+  DatagramFrameScheduler scheduler(conn);
+  EXPECT_TRUE(scheduler.hasPendingDatagramFrames());
+  ShortHeader shortHeader(
+      ProtectionType::KeyPhaseZero,
+      getTestConnectionId(),
+      getNextPacketNum(conn, PacketNumberSpace::AppData));
+  RegularQuicPacketBuilder builder(
+      conn.udpSendPacketLen,
+      std::move(shortHeader),
+      conn.ackStates.appDataAckState.largestAckedByPeer.value_or(0));
+  builder.encodePacketHeader();
+  EXPECT_TRUE(scheduler.writeDatagramFrames(builder));
+  // Only two datagrams fit, the third one waits for the next packet.
+  EXPECT_EQ(conn.datagramState.writeBuffer.size(), 1);
+  auto packet = std::move(builder).buildPacket().packet;
+  ASSERT_EQ(packet.frames.size(), 2);
+  EXPECT_EQ(packet.frames[0].asDatagramFrame()->length, 500);
+  EXPECT_EQ(packet.frames[1].asDatagramFrame()->length, 500);
+}
+
 TEST_F(QuicPacketSchedulerTest, StreamFrameSchedulerStreamNotExists) {
   QuicServerConnectionState conn;
   auto connId = getTestConnectionId();
@@ -1013,7 +1050,7 @@ TEST_F(QuicPacketSchedulerTest, StreamFrameSchedulerAllFit) {
       folly::IOBuf::copyBuffer("some data"),
       false);
   scheduler.writeStreams(builder);
-  EXPECT_EQ(conn.schedulingState.nextScheduledStream, 0);
+  EXPECT_EQ(nextScheduledStream(conn), 0);
 }
 
 TEST_F(QuicPacketSchedulerTest, StreamFrameSchedulerRoundRobin) {
@@ -1056,10 +1093,8 @@ TEST_F(QuicPacketSchedulerTest, StreamFrameSchedulerRoundRobin) {
       *conn.streamManager->findStream(stream3),
       folly::IOBuf::copyBuffer("some data"),
       false);
-  // Force the wraparound initially.
-  conn.schedulingState.nextScheduledStream = stream3 + 8;
   scheduler.writeStreams(builder);
-  EXPECT_EQ(conn.schedulingState.nextScheduledStream, 4);
+  EXPECT_EQ(nextScheduledStream(conn), stream2);
 
   // Should write frames for stream2, stream3, followed by stream1 again.
   NiceMock<MockQuicPacketBuilder> builder2;
@@ -1121,10 +1156,8 @@ TEST_F(QuicPacketSchedulerTest, StreamFrameSchedulerRoundRobinStreamPerPacket) {
       *conn.streamManager->findStream(stream3),
       folly::IOBuf::copyBuffer("some data"),
       false);
-  // Force the wraparound initially.
-  conn.schedulingState.nextScheduledStream = stream3 + 8;
   scheduler.writeStreams(builder1);
-  EXPECT_EQ(conn.schedulingState.nextScheduledStream, 4);
+  EXPECT_EQ(nextScheduledStream(conn), stream2);
 
   // Should write frames for stream2, stream3, followed by stream1 again.
   NiceMock<MockQuicPacketBuilder> builder2;
@@ -1200,11 +1233,9 @@ TEST_F(QuicPacketSchedulerTest, StreamFrameSchedulerRoundRobinControl) {
       *conn.streamManager->findStream(stream4),
       folly::IOBuf::copyBuffer("some data"),
       false);
-  // Force the wraparound initially.
-  conn.schedulingState.nextScheduledStream = stream4 + 8;
   scheduler.writeStreams(builder);
-  EXPECT_EQ(conn.schedulingState.nextScheduledStream, stream3);
-  EXPECT_EQ(conn.schedulingState.nextScheduledControlStream, stream2);
+  EXPECT_EQ(nextScheduledStream(conn), stream3);
+  EXPECT_EQ(nextScheduledControlStream(conn), stream2);
 
   // Should write frames for stream2, stream4, followed by stream 3 then 1.
   NiceMock<MockQuicPacketBuilder> builder2;
@@ -1228,8 +1259,8 @@ TEST_F(QuicPacketSchedulerTest, StreamFrameSchedulerRoundRobinControl) {
   ASSERT_TRUE(frames[3].asWriteStreamFrame());
   EXPECT_EQ(*frames[3].asWriteStreamFrame(), f4);
 
-  EXPECT_EQ(conn.schedulingState.nextScheduledStream, stream3);
-  EXPECT_EQ(conn.schedulingState.nextScheduledControlStream, stream2);
+  EXPECT_EQ(nextScheduledStream(conn), stream3);
+  EXPECT_EQ(nextScheduledControlStream(conn), stream2);
 }
 
 TEST_F(QuicPacketSchedulerTest, StreamFrameSchedulerOneStream) {
@@ -1252,7 +1283,7 @@ TEST_F(QuicPacketSchedulerTest, StreamFrameSchedulerOneStream) {
   auto stream1 = conn.streamManager->createNextBidirectionalStream().value();
   writeDataToQuicStream(*stream1, folly::IOBuf::copyBuffer("some data"), false);
   scheduler.writeStreams(builder);
-  EXPECT_EQ(conn.schedulingState.nextScheduledStream, 0);
+  EXPECT_EQ(nextScheduledStream(conn), 0);
 }
 
 TEST_F(QuicPacketSchedulerTest, StreamFrameSchedulerRemoveOne) {
@@ -1287,16 +1318,103 @@ TEST_F(QuicPacketSchedulerTest, StreamFrameSchedulerRemoveOne) {
   ASSERT_TRUE(builder.frames_[1].asWriteStreamFrame());
   EXPECT_EQ(*builder.frames_[1].asWriteStreamFrame(), f2);
 
-  // Manually remove a stream and set the next scheduled to that stream.
+  // Manually remove a stream, the scheduler should wrap around to the
+  // remaining one.
   builder.frames_.clear();
   conn.streamManager->removeWritable(*conn.streamManager->findStream(stream2));
-  conn.schedulingState.nextScheduledStream = stream2;
   scheduler.writeStreams(builder);
   ASSERT_EQ(builder.frames_.size(), 1);
   ASSERT_TRUE(builder.frames_[0].asWriteStreamFrame());
   EXPECT_EQ(*builder.frames_[0].asWriteStreamFrame(), f1);
 }
 
+TEST_F(QuicPacketSchedulerTest, StreamFrameSchedulerPriority) {
+  QuicClientConnectionState conn(
+      FizzClientQuicHandshakeContext::Builder().build());
+  conn.streamManager->setMaxLocalBidirectionalStreams(10);
+  conn.flowControlState.peerAdvertisedMaxOffset = 100000;
+  conn.flowControlState.peerAdvertisedInitialMaxStreamOffsetBidiRemote = 100000;
+  StreamFrameScheduler scheduler(conn);
+  NiceMock<MockQuicPacketBuilder> builder;
+  auto stream1 =
+      conn.streamManager->createNextBidirectionalStream().value()->id;
+  auto stream2 =
+      conn.streamManager->createNextBidirectionalStream().value()->id;
+  auto stream3 =
+      conn.streamManager->createNextBidirectionalStream().value()->id;
+  conn.streamManager->setStreamPriority(stream1, 5, true);
+  conn.streamManager->setStreamPriority(stream2, 1, true);
+  for (auto id : {stream1, stream2, stream3}) {
+    writeDataToQuicStream(
+        *conn.streamManager->findStream(id),
+        folly::IOBuf::copyBuffer("some data"),
+        false);
+  }
+  // Raising the priority of a stream which is already writable moves it.
+  conn.streamManager->setStreamPriority(stream3, 0, false);
+  EXPECT_CALL(builder, remainingSpaceInPkt()).WillRepeatedly(Return(4096));
+  EXPECT_CALL(builder, appendFrame(_)).WillRepeatedly(Invoke([&](auto f) {
+    builder.frames_.push_back(f);
+  }));
+  scheduler.writeStreams(builder);
+  auto& frames = builder.frames_;
+  ASSERT_EQ(frames.size(), 3);
+  ASSERT_TRUE(frames[0].asWriteStreamFrame());
+  EXPECT_EQ(frames[0].asWriteStreamFrame()->streamId, stream3);
+  ASSERT_TRUE(frames[1].asWriteStreamFrame());
+  EXPECT_EQ(frames[1].asWriteStreamFrame()->streamId, stream2);
+  ASSERT_TRUE(frames[2].asWriteStreamFrame());
+  EXPECT_EQ(frames[2].asWriteStreamFrame()->streamId, stream1);
+}
+
+TEST_F(QuicPacketSchedulerTest, StreamFrameSchedulerSequential) {
+  QuicClientConnectionState conn(
+      FizzClientQuicHandshakeContext::Builder().build());
+  conn.streamManager->setMaxLocalBidirectionalStreams(10);
+  conn.flowControlState.peerAdvertisedMaxOffset = 100000;
+  conn.flowControlState.peerAdvertisedInitialMaxStreamOffsetBidiRemote = 100000;
+  auto connId = getTestConnectionId();
+  StreamFrameScheduler scheduler(conn);
+  auto stream1 =
+      conn.streamManager->createNextBidirectionalStream().value()->id;
+  auto stream2 =
+      conn.streamManager->createNextBidirectionalStream().value()->id;
+  conn.streamManager->setStreamPriority(stream1, 3, false);
+  conn.streamManager->setStreamPriority(stream2, 3, false);
+  auto largeBuf = folly::IOBuf::createChain(conn.udpSendPacketLen * 2, 4096);
+  auto curBuf = largeBuf.get();
+  do {
+    curBuf->append(curBuf->capacity());
+    curBuf = curBuf->next();
+  } while (curBuf != largeBuf.get());
+  // Make stream2 writable first, non-incremental streams are still served in
+  // stream id order.
+  writeDataToQuicStream(
+      *conn.streamManager->findStream(stream2),
+      folly::IOBuf::copyBuffer("some data"),
+      false);
+  writeDataToQuicStream(
+      *conn.streamManager->findStream(stream1), std::move(largeBuf), false);
+  for (int i = 0; i < 2; i++) {
+    ShortHeader shortHeader(
+        ProtectionType::KeyPhaseZero,
+        connId,
+        getNextPacketNum(conn, PacketNumberSpace::AppData));
+    RegularQuicPacketBuilder builder(
+        conn.udpSendPacketLen,
+        std::move(shortHeader),
+        conn.ackStates.appDataAckState.largestAckedByPeer.value_or(0));
+    builder.encodePacketHeader();
+    scheduler.writeStreams(builder);
+    auto packet = std::move(builder).buildPacket();
+    // stream1 doesn't get rotated away even though it was served.
+    ASSERT_EQ(packet.packet.frames.size(), 1);
+    ASSERT_TRUE(packet.packet.frames[0].asWriteStreamFrame());
+    EXPECT_EQ(packet.packet.frames[0].asWriteStreamFrame()->streamId, stream1);
+    EXPECT_EQ(nextScheduledStream(conn), stream1);
+  }
+}
+
 TEST_F(
     QuicPacketSchedulerTest,
     CloningSchedulerWithInplaceBuilderDoNotEncodeHeaderWithoutBuild) {
@@ -2470,6 +2470,25 @@ TEST_F(QuicTransportImplTest, IsUnidirectionalStream) {
   EXPECT_TRUE(transport->isUnidirectionalStream(stream));
 }
 
+TEST_F(QuicTransportImplTest, SetStreamPriority) {
+  auto stream = transport->createBidirectionalStream().value();
+  EXPECT_EQ(transport->getStreamPriority(stream).value(), kDefaultPriority);
+
+  EXPECT_TRUE(transport->setStreamPriority(stream, 0, false).hasValue());
+  EXPECT_EQ(transport->getStreamPriority(stream).value(), Priority(0, false));
+
+  auto result =
+      transport->setStreamPriority(stream, kDefaultMaxPriority + 1, true);
+  ASSERT_TRUE(result.hasError());
+  EXPECT_EQ(result.error(), LocalErrorCode::INVALID_OPERATION);
+
+  StreamId nonExistStream = stream + 4;
+  result = transport->setStreamPriority(nonExistStream, 1, true);
+  ASSERT_TRUE(result.hasError());
+  EXPECT_EQ(result.error(), LocalErrorCode::STREAM_NOT_EXISTS);
+  EXPECT_TRUE(transport->getStreamPriority(nonExistStream).hasError());
+}
+
 TEST_F(QuicTransportImplTest, IsBidirectionalStream) {
   auto stream = transport->createBidirectionalStream().value();
   EXPECT_TRUE(transport->isBidirectionalStream(stream));
@@ -0,0 +1,146 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ *
+ */
+
+#include <folly/Benchmark.h>
+#include <folly/init/Init.h>
+#include <folly/io/async/test/MockAsyncUDPSocket.h>
+
+#include <quic/api/QuicTransportFunctions.h>
+#include <quic/common/BufAccessor.h>
+#include <quic/common/test/TestUtils.h>
+#include <quic/fizz/handshake/FizzCryptoFactory.h>
+#include <quic/server/state/ServerStateMachine.h>
+#include <quic/state/QuicStreamFunctions.h>
+
+using namespace quic;
+using namespace testing;
+
+namespace {
+
+// Packets written per connection, the connection is recreated outside of the
+// measurement once it has sent them so its state does not keep growing.
+constexpr size_t kPacketsPerConn = 1000;
+
+struct WritePathFixture {
+  WritePathFixture(QuicBatchingMode batchingMode, DataPathType dataPathType)
+      : sock(&evb) {
+    ON_CALL(sock, getGSO()).WillByDefault(Return(1));
+    ON_CALL(sock, write(_, _))
+        .WillByDefault(Invoke([](const folly::SocketAddress&,
+                                 const std::unique_ptr<folly::IOBuf>& buf) {
+          return buf->computeChainDataLength();
+        }));
+    ON_CALL(sock, writeGSO(_, _, _))
+        .WillByDefault(Invoke([](const folly::SocketAddress&,
+                                 const std::unique_ptr<folly::IOBuf>& buf,
+                                 int) {
+          return buf->computeChainDataLength();
+        }));
+    connId = test::getTestConnectionId();
+    FizzCryptoFactory cryptoFactory;
+    aead = cryptoFactory.getClientInitialCipher(connId, QuicVersion::MVFST);
+    headerCipher =
+        cryptoFactory.makeClientInitialHeaderCipher(connId, QuicVersion::MVFST);
+    resetConn(batchingMode, dataPathType);
+  }
+
+  void resetConn(QuicBatchingMode batchingMode, DataPathType dataPathType) {
+    conn = std::make_unique<QuicServerConnectionState>();
+    conn->serverConnectionId = connId;
+    conn->clientConnectionId = connId;
+    conn->version = QuicVersion::MVFST;
+    conn->peerAddress = folly::SocketAddress("::1", 1234);
+    conn->udpSendPacketLen = 1200;
+    conn->congestionController = nullptr;
+    conn->transportSettings.batchingMode = batchingMode;
+    conn->transportSettings.dataPathType = dataPathType;
+    conn->transportSettings.writeConnectionDataPacketsLimit =
+        conn->transportSettings.maxBatchSize;
+    if (dataPathType == DataPathType::ContinuousMemory) {
+      bufAccessor = std::make_unique<SimpleBufAccessor>(
+          conn->udpSendPacketLen * conn->transportSettings.maxBatchSize);
+      conn->bufAccessor = bufAccessor.get();
+    }
+    uint64_t window = conn->udpSendPacketLen * kPacketsPerConn * 2;
+    conn->flowControlState.peerAdvertisedMaxOffset = window;
+    conn->flowControlState.peerAdvertisedInitialMaxStreamOffsetBidiLocal =
+        window;
+    auto stream = conn->streamManager->createNextBidirectionalStream().value();
+    writeDataToQuicStream(
+        *stream,
+        folly::IOBuf::copyBuffer(
+            std::string(conn->udpSendPacketLen * kPacketsPerConn, 'a')),
+        false);
+  }
+
+  folly::EventBase evb;
+  NiceMock<folly::test::MockAsyncUDPSocket> sock;
+  ConnectionId connId;
+  std::unique_ptr<Aead> aead;
+  std::unique_ptr<PacketNumberCipher> headerCipher;
+  std::unique_ptr<SimpleBufAccessor> bufAccessor;
+  std::unique_ptr<QuicServerConnectionState> conn;
+};
+
+// Builds, encrypts and batches iters 1200 byte packets of stream data.
+void writePackets(
+    size_t iters,
+    QuicBatchingMode batchingMode,
+    DataPathType dataPathType) {
+  folly::BenchmarkSuspender suspender;
+  WritePathFixture fixture(batchingMode, dataPathType);
+  size_t written = 0;
+  size_t writtenOnConn = 0;
+  while (written < iters) {
+    if (writtenOnConn >= kPacketsPerConn) {
+      fixture.resetConn(batchingMode, dataPathType);
+      writtenOnConn = 0;
+    }
+    suspender.dismiss();
+    auto packets = writeQuicDataToSocket(
+        fixture.sock,
+        *fixture.conn,
+        fixture.connId,
+        fixture.connId,
+        *fixture.aead,
+        *fixture.headerCipher,
+        QuicVersion::MVFST,
+        std::min(
+            iters - written,
+            static_cast<size_t>(fixture.conn->transportSettings.maxBatchSize)));
+    suspender.rehire();
+    CHECK_GT(packets, 0);
+    written += packets;
+    writtenOnConn += packets;
+  }
+}
+
+} // namespace
+
+BENCHMARK(WriteChainedMemoryNoBatching, iters) {
+  writePackets(
+      iters, QuicBatchingMode::BATCHING_MODE_NONE, DataPathType::ChainedMemory);
+}
+
+BENCHMARK_RELATIVE(WriteChainedMemoryGSO, iters) {
+  writePackets(
+      iters, QuicBatchingMode::BATCHING_MODE_GSO, DataPathType::ChainedMemory);
+}
+
+BENCHMARK_RELATIVE(WriteContinuousMemoryGSO, iters) {
+  writePackets(
+      iters,
+      QuicBatchingMode::BATCHING_MODE_GSO,
+      DataPathType::ContinuousMemory);
+}
+
+int main(int argc, char** argv) {
+  folly::init(&argc, &argv);
+  folly::runBenchmarks();
+  return 0;
+}
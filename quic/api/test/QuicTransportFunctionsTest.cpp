@@ -243,7 +243,7 @@ TEST_F(QuicTransportFunctionsTest, TestUpdateConnection) {
   EXPECT_TRUE(conn->outstandings.packets.back().isAppLimited);
 
   EXPECT_EQ(stream1->retransmissionBuffer.size(), 1);
-  auto& rt1 = *stream1->retransmissionBuffer.at(0);
+  auto& rt1 = stream1->retransmissionBuffer.at(0);
 
   EXPECT_EQ(stream1->currentWriteOffset, 5);
   EXPECT_EQ(stream2->currentWriteOffset, 13);
@@ -253,7 +253,7 @@ TEST_F(QuicTransportFunctionsTest, TestUpdateConnection) {
   EXPECT_TRUE(eq(*IOBuf::copyBuffer("hey w"), *rt1.data.front()));
 
   EXPECT_EQ(stream2->retransmissionBuffer.size(), 1);
-  auto& rt2 = *stream2->retransmissionBuffer.at(0);
+  auto& rt2 = stream2->retransmissionBuffer.at(0);
 
   EXPECT_EQ(rt2.offset, 0);
   EXPECT_TRUE(eq(*buf, *rt2.data.front()));
@@ -304,17 +304,17 @@ TEST_F(QuicTransportFunctionsTest, TestUpdateConnection) {
 
   EXPECT_EQ(stream1->lossBuffer.size(), 0);
   EXPECT_EQ(stream1->retransmissionBuffer.size(), 2);
-  auto& rt3 = *stream1->retransmissionBuffer.at(5);
+  auto& rt3 = stream1->retransmissionBuffer.at(5);
   EXPECT_TRUE(eq(IOBuf::copyBuffer("hats up"), rt3.data.move()));
 
-  auto& rt4 = *stream1->retransmissionBuffer.at(0);
+  auto& rt4 = stream1->retransmissionBuffer.at(0);
   EXPECT_TRUE(eq(*IOBuf::copyBuffer("hey w"), *rt4.data.front()));
 
   // loss buffer should be split into 2. Part in retransmission buffer and
   // part remains in loss buffer.
   EXPECT_EQ(stream2->lossBuffer.size(), 1);
   EXPECT_EQ(stream2->retransmissionBuffer.size(), 1);
-  auto& rt5 = *stream2->retransmissionBuffer.at(0);
+  auto& rt5 = stream2->retransmissionBuffer.at(0);
   EXPECT_TRUE(eq(*IOBuf::copyBuffer("hey wh"), *rt5.data.front()));
   EXPECT_EQ(rt5.offset, 0);
   EXPECT_EQ(rt5.eof, 0);
@@ -463,7 +463,7 @@ TEST_F(QuicTransportFunctionsTest, TestUpdateConnectionFinOnly) {
   EXPECT_TRUE(frame->fin);
 
   EXPECT_EQ(stream1->retransmissionBuffer.size(), 1);
-  auto& rt1 = *stream1->retransmissionBuffer.at(0);
+  auto& rt1 = stream1->retransmissionBuffer.at(0);
 
   EXPECT_EQ(stream1->currentWriteOffset, 1);
   EXPECT_EQ(rt1.offset, 0);
@@ -510,7 +510,7 @@ TEST_F(QuicTransportFunctionsTest, TestUpdateConnectionAllBytesExceptFin) {
   EXPECT_EQ(stream1->currentWriteOffset, buf->computeChainDataLength());
 
   EXPECT_EQ(stream1->retransmissionBuffer.size(), 1);
-  auto& rt1 = *stream1->retransmissionBuffer.at(0);
+  auto& rt1 = stream1->retransmissionBuffer.at(0);
   EXPECT_EQ(rt1.offset, 0);
   EXPECT_EQ(
       rt1.data.front()->computeChainDataLength(),
@@ -664,8 +664,7 @@ TEST_F(QuicTransportFunctionsTest, TestImplicitAck) {
   EXPECT_TRUE(initialStream->lossBuffer.empty());
 
   // Fake loss.
-  Buf firstBuf =
-      initialStream->retransmissionBuffer.find(0)->second->data.move();
+  Buf firstBuf = initialStream->retransmissionBuffer.find(0)->data.move();
   initialStream->retransmissionBuffer.erase(0);
   initialStream->lossBuffer.emplace_back(std::move(firstBuf), 0, false);
   conn->outstandings.packets.pop_front();
@@ -700,7 +699,7 @@ TEST_F(QuicTransportFunctionsTest, TestImplicitAck) {
   EXPECT_TRUE(handshakeStream->lossBuffer.empty());
 
   // Fake loss.
-  firstBuf = handshakeStream->retransmissionBuffer.find(0)->second->data.move();
+  firstBuf = handshakeStream->retransmissionBuffer.find(0)->data.move();
   handshakeStream->retransmissionBuffer.erase(0);
   handshakeStream->lossBuffer.emplace_back(std::move(firstBuf), 0, false);
   auto& op = conn->outstandings.packets.front();
@@ -1399,7 +1398,7 @@ TEST_F(QuicTransportFunctionsTest, NothingWritten) {
 }
 
 const QuicWriteFrame& getFirstFrameInOutstandingPackets(
-    const std::deque<OutstandingPacket>& outstandingPackets,
+    const OutstandingPacketStore& outstandingPackets,
     QuicWriteFrame::Type frameType) {
   for (const auto& packet : outstandingPackets) {
     for (const auto& frame : packet.packet.frames) {
@@ -2192,12 +2191,12 @@ TEST_F(QuicTransportFunctionsTest, HandshakeConfirmedDropCipher) {
       LongHeader::Types::Handshake);
   ASSERT_FALSE(initialStream->retransmissionBuffer.empty());
   ASSERT_FALSE(handshakeStream->retransmissionBuffer.empty());
-  initialStream->insertIntoLossBuffer(std::make_unique<StreamBuffer>(
+  initialStream->insertIntoLossBuffer(StreamBuffer(
       folly::IOBuf::copyBuffer(
           "I don't see the dialup info in the meeting invite"),
       0,
       false));
-  handshakeStream->insertIntoLossBuffer(std::make_unique<StreamBuffer>(
+  handshakeStream->insertIntoLossBuffer(StreamBuffer(
       folly::IOBuf::copyBuffer("Traffic Protocol Weekly Sync"), 0, false));
 
   handshakeConfirmed(*conn);
@@ -135,18 +135,18 @@ void dropPackets(QuicServerConnectionState& conn) {
       }
       auto stream = conn.streamManager->findStream(streamFrame->streamId);
       ASSERT_TRUE(stream);
-      auto itr = stream->retransmissionBuffer.find(streamFrame->offset);
-      ASSERT_TRUE(itr != stream->retransmissionBuffer.end());
+      auto rtxBuffer = stream->retransmissionBuffer.find(streamFrame->offset);
+      ASSERT_TRUE(rtxBuffer);
       stream->lossBuffer.insert(
           std::upper_bound(
               stream->lossBuffer.begin(),
               stream->lossBuffer.end(),
-              itr->second->offset,
+              rtxBuffer->offset,
               [](const auto& offset, const auto& buffer) {
                 return offset < buffer.offset;
               }),
-          std::move(*itr->second));
-      stream->retransmissionBuffer.erase(itr);
+          std::move(*rtxBuffer));
+      stream->retransmissionBuffer.erase(streamFrame->offset);
       if (std::find(
               conn.streamManager->lossStreams().begin(),
               conn.streamManager->lossStreams().end(),
@@ -202,11 +202,9 @@ void verifyCorrectness(
   EXPECT_FALSE(stream->retransmissionBuffer.empty());
   BufQueue retxBufCombined;
   std::vector<StreamBuffer> rtxCopy;
-  for (auto& itr : stream->retransmissionBuffer) {
+  for (auto& buffer : stream->retransmissionBuffer) {
     rtxCopy.push_back(StreamBuffer(
-        itr.second->data.front()->clone(),
-        itr.second->offset,
-        itr.second->eof));
+        buffer.data.front()->clone(), buffer.offset, buffer.eof));
   }
   std::sort(rtxCopy.begin(), rtxCopy.end(), [](auto& s1, auto& s2) {
     return s1.offset < s2.offset;
@@ -215,10 +213,10 @@ void verifyCorrectness(
     retxBufCombined.append(s.data.move());
   }
   EXPECT_TRUE(IOBufEqualTo()(expected, *retxBufCombined.move()));
-  EXPECT_EQ(finExpected, stream->retransmissionBuffer.at(offsets.back())->eof);
+  EXPECT_EQ(finExpected, stream->retransmissionBuffer.at(offsets.back()).eof);
   std::vector<uint64_t> retxBufOffsets;
   for (const auto& b : stream->retransmissionBuffer) {
-    retxBufOffsets.push_back(b.second->offset);
+    retxBufOffsets.push_back(b.offset);
   }
   std::sort(retxBufOffsets.begin(), retxBufOffsets.end());
   EXPECT_EQ(offsets, retxBufOffsets);
@@ -1150,8 +1148,8 @@ TEST_F(QuicTransportTest, CloneAfterRecvReset) {
   EXPECT_EQ(1, conn.outstandings.packets.size());
   auto stream = conn.streamManager->getStream(streamId);
   EXPECT_EQ(1, stream->retransmissionBuffer.size());
-  EXPECT_EQ(0, stream->retransmissionBuffer.at(0)->data.chainLength());
-  EXPECT_TRUE(stream->retransmissionBuffer.at(0)->eof);
+  EXPECT_EQ(0, stream->retransmissionBuffer.at(0).data.chainLength());
+  EXPECT_TRUE(stream->retransmissionBuffer.at(0).eof);
   EXPECT_TRUE(stream->lossBuffer.empty());
   EXPECT_EQ(0, stream->writeBuffer.chainLength());
   EXPECT_EQ(1, stream->currentWriteOffset);
@@ -1890,10 +1888,9 @@ TEST_F(QuicTransportTest, InvokeDeliveryCallbacksRetxBuffer) {
   auto streamState = conn.streamManager->getStream(stream);
   streamState->retransmissionBuffer.clear();
   streamState->retransmissionBuffer.emplace(
-      std::piecewise_construct,
-      std::forward_as_tuple(51),
-      std::forward_as_tuple(std::make_unique<StreamBuffer>(
-          folly::IOBuf::copyBuffer("But i'm not delivered yet"), 51, false)));
+      51,
+      StreamBuffer(
+          folly::IOBuf::copyBuffer("But i'm not delivered yet"), 51, false));
 
   folly::SocketAddress addr;
   NetworkData emptyData;
@@ -1938,10 +1935,9 @@ TEST_F(QuicTransportTest, InvokeDeliveryCallbacksLossAndRetxBuffer) {
   streamState->retransmissionBuffer.clear();
   streamState->lossBuffer.clear();
   streamState->retransmissionBuffer.emplace(
-      std::piecewise_construct,
-      std::forward_as_tuple(51),
-      std::forward_as_tuple(std::make_unique<StreamBuffer>(
-          folly::IOBuf::copyBuffer("But i'm not delivered yet"), 51, false)));
+      51,
+      StreamBuffer(
+          folly::IOBuf::copyBuffer("But i'm not delivered yet"), 51, false));
   streamState->lossBuffer.emplace_back(
       folly::IOBuf::copyBuffer("And I'm lost"), 31, false);
   streamState->ackedIntervals.insert(0, 30);
@@ -2733,8 +2729,7 @@ TEST_F(QuicTransportTest, WriteStreamFromMiddleOfMap) {
   EXPECT_EQ(streamFrame->streamId, s1);
   conn.outstandings.packets.clear();
 
-  // Start from stream2 instead of stream1
-  conn.schedulingState.nextScheduledStream = s2;
+  // stream1 was served, the round robin continues from stream2.
   writableBytes = kDefaultUDPSendPacketLen - 100;
 
   EXPECT_CALL(*socket_, write(_, _)).WillOnce(Invoke(bufLength));
@@ -2756,8 +2751,8 @@ TEST_F(QuicTransportTest, WriteStreamFromMiddleOfMap) {
   EXPECT_EQ(streamFrame2->streamId, s2);
   conn.outstandings.packets.clear();
 
-  // Test wrap around
-  conn.schedulingState.nextScheduledStream = s2;
+  // Test wrap around: stream2 was served last, so the round robin starts over
+  // with stream1 and then stream2 again.
   writableBytes = kDefaultUDPSendPacketLen;
   EXPECT_CALL(*socket_, write(_, _)).WillOnce(Invoke(bufLength));
   writeQuicDataToSocket(
@@ -2776,10 +2771,10 @@ TEST_F(QuicTransportTest, WriteStreamFromMiddleOfMap) {
   auto& frame4 = packet3.packet.frames.back();
   const WriteStreamFrame* streamFrame3 = frame3.asWriteStreamFrame();
   EXPECT_TRUE(streamFrame3);
-  EXPECT_EQ(streamFrame3->streamId, s2);
+  EXPECT_EQ(streamFrame3->streamId, s1);
   const WriteStreamFrame* streamFrame4 = frame4.asWriteStreamFrame();
   EXPECT_TRUE(streamFrame4);
-  EXPECT_EQ(streamFrame4->streamId, s1);
+  EXPECT_EQ(streamFrame4->streamId, s2);
   transport_->close(folly::none);
 }
 
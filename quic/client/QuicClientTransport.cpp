@@ -15,6 +15,7 @@
 #include <quic/client/handshake/ClientHandshakeFactory.h>
 #include <quic/client/handshake/ClientTransportParametersExtension.h>
 #include <quic/client/state/ClientStateMachine.h>
+#include <quic/common/SocketUtil.h>
 #include <quic/flowcontrol/QuicFlowController.h>
 #include <quic/handshake/CryptoFactory.h>
 #include <quic/happyeyeballs/QuicHappyEyeballsFunctions.h>
@@ -110,7 +111,8 @@ void QuicClientTransport::processUDPData(
   for (uint16_t processedPackets = 0;
        !udpData.empty() && processedPackets < kMaxNumCoalescedPackets;
        processedPackets++) {
-    processPacketData(peer, networkData.receiveTimePoint, udpData);
+    processPacketData(
+        peer, networkData.receiveTimePoint, networkData.ecnCodepoint, udpData);
   }
   VLOG_IF(4, !udpData.empty())
       << "Leaving " << udpData.chainLength()
@@ -121,6 +123,7 @@ void QuicClientTransport::processUDPData(
 void QuicClientTransport::processPacketData(
     const folly::SocketAddress& peer,
     TimePoint receiveTimePoint,
+    EcnCodepoint ecn,
     BufQueue& packetQueue) {
   auto packetSize = packetQueue.chainLength();
   if (packetSize == 0) {
@@ -163,7 +166,10 @@ void QuicClientTransport::processPacketData(
     }
 
     // Set the destination connection ID to be the value from the source
-    // connection id of the retry packet
+    // connection id of the retry packet, the server echoes both in its
+    // transport parameters.
+    clientConn_->originalDestinationConnectionId =
+        clientConn_->initialDestinationConnectionId;
     clientConn_->initialDestinationConnectionId =
         retryPacket->header.getSourceConnId();
 
@@ -177,13 +183,16 @@ void QuicClientTransport::processPacketData(
     clientConn_->retryToken = retryPacket->header.getToken();
 
     // TODO (amsharma): add a "RetryPacket" QLog event, and log it here.
-    // TODO (amsharma): verify the "original_connection_id" parameter
-    // upon receiving a subsequent initial from the server.
 
     startCryptoHandshake();
     return;
   }
 
+  CodecError* codecError = parsedPacket.codecError();
+  if (codecError) {
+    throwFrameDecodeError(codecError->error);
+  }
+
   RegularQuicPacket* regularOptional = parsedPacket.regularPacket();
   if (!regularOptional) {
     QUIC_STATS(statsCallback_, onPacketDropped, PacketDropReason::PARSE_ERROR);
@@ -488,6 +497,21 @@ void QuicClientTransport::processPacketData(
             *conn_, simpleFrame, packetNum, false);
         break;
       }
+      case QuicFrame::Type::DatagramFrame_E: {
+        // Datagrams are not retransmittable, but they are acked like data.
+        pktHasRetransmittableData = true;
+        handleDatagram(*conn_, *quicFrame.asDatagramFrame());
+        break;
+      }
+      case QuicFrame::Type::ReadNewTokenFrame_E: {
+        ReadNewTokenFrame& newTokenFrame = *quicFrame.asReadNewTokenFrame();
+        pktHasRetransmittableData = true;
+        if (newTokenFrame.token) {
+          clientConn_->newToken =
+              newTokenFrame.token->moveToFbString().toStdString();
+        }
+        break;
+      }
       default:
         break;
     }
@@ -618,7 +642,8 @@ void QuicClientTransport::processPacketData(
       ackState,
       outOfOrder,
       pktHasRetransmittableData,
-      pktHasCryptoData);
+      pktHasCryptoData,
+      ecn);
 }
 
 void QuicClientTransport::onReadData(
@@ -652,8 +677,11 @@ void QuicClientTransport::onReadData(
   if (connCallback_ && !replaySafeNotified_ && conn_->oneRttWriteCipher) {
     replaySafeNotified_ = true;
     // We don't need this any more. Also unset it so that we don't allow random
-    // middleboxes to shutdown our connection once we have crypto keys.
-    socket_->setErrMessageCallback(nullptr);
+    // middleboxes to shutdown our connection once we have crypto keys. Zero
+    // copy writes still need it for their notifications.
+    if (!zeroCopyTracker_) {
+      socket_->setErrMessageCallback(nullptr);
+    }
     connCallback_->onReplaySafe();
   }
 }
@@ -746,7 +774,8 @@ void QuicClientTransport::writeData() {
           *conn_->initialHeaderCipher,
           version,
           packetLimit,
-          clientConn_->retryToken);
+          clientConn_->retryToken.empty() ? clientConn_->newToken
+                                          : clientConn_->retryToken);
     }
     if (!packetLimit && !conn_->pendingEvents.numProbePackets) {
       return;
@@ -850,7 +879,13 @@ void QuicClientTransport::startCryptoHandshake() {
       conn_->transportSettings.maxRecvPacketSize,
       conn_->transportSettings.selfActiveConnectionIdLimit,
       conn_->clientConnectionId.value(),
-      customTransportParameters_);
+      customTransportParameters_,
+      conn_->transportSettings.datagramConfig.enabled
+          ? kDefaultMaxDatagramFrameSize
+          : 0,
+      conn_->transportSettings.ackFrequencyConfig.enabled
+          ? conn_->transportSettings.ackFrequencyConfig.minAckDelay.count()
+          : 0);
   conn_->transportParametersEncoded = true;
   handshakeLayer->connect(hostname_, std::move(paramsExtension));
 
@@ -870,10 +905,62 @@ bool QuicClientTransport::hasWriteCipher() const {
   return clientConn_->oneRttWriteCipher || clientConn_->zeroRttWriteCipher;
 }
 
+size_t QuicClientTransport::getStateSize() const {
+  return sizeof(QuicClientTransport) + sizeof(QuicClientConnectionState);
+}
+
 std::shared_ptr<QuicTransportBase> QuicClientTransport::sharedGuard() {
   return shared_from_this();
 }
 
+void QuicClientTransport::setUpZeroCopyWrites() {
+  const auto& settings = conn_->transportSettings;
+  // The notifications come through the error message callback.
+  if (!settings.enableZeroCopyWrites || !settings.enableSocketErrMsgCallback ||
+      settings.batchingMode != QuicBatchingMode::BATCHING_MODE_GSO ||
+      zeroCopyTracker_) {
+    return;
+  }
+  zeroCopyTracker_ = std::make_unique<ZeroCopyTracker>(
+      *socket_, settings.zeroCopyWriteThreshold, conn_->statsCallback);
+  if (zeroCopyTracker_->enabled()) {
+    conn_->zeroCopyTracker = zeroCopyTracker_.get();
+  } else {
+    zeroCopyTracker_.reset();
+  }
+}
+
+void QuicClientTransport::setUpTxTimePacing() {
+  auto& settings = conn_->transportSettings;
+  if (!settings.txTimePacing) {
+    return;
+  }
+  // The packets to either happy eyeballs socket are stamped.
+  const auto& happyEyeballsState = conn_->happyEyeballsState;
+  if (!enableTxTime(*socket_) ||
+      (happyEyeballsState.secondSocket && !happyEyeballsState.finished &&
+       !enableTxTime(*happyEyeballsState.secondSocket))) {
+    // The pacer falls back to the pacing timer.
+    settings.txTimePacing = false;
+  }
+}
+
+void QuicClientTransport::setUpEcn() {
+  auto& settings = conn_->transportSettings;
+  if (!settings.enableEcn) {
+    return;
+  }
+  // Both happy eyeballs sockets read the ECN codepoints.
+  const auto& happyEyeballsState = conn_->happyEyeballsState;
+  if (!BatchWriterFactory::canMarkEcn(settings.batchingMode) ||
+      !enableRecvTos(*socket_) ||
+      (happyEyeballsState.secondSocket && !happyEyeballsState.finished &&
+       !enableRecvTos(*happyEyeballsState.secondSocket))) {
+    // Neither mark nor echo ECN.
+    settings.enableEcn = false;
+  }
+}
+
 bool QuicClientTransport::isTLSResumed() const {
   return clientConn_->clientHandshakeLayer->isTLSResumed();
 }
@@ -881,6 +968,12 @@ bool QuicClientTransport::isTLSResumed() const {
 void QuicClientTransport::errMessage(
     FOLLY_MAYBE_UNUSED const cmsghdr& cmsg) noexcept {
 #ifdef FOLLY_HAVE_MSG_ERRQUEUE
+  if (zeroCopyTracker_ && zeroCopyTracker_->onErrMessage(cmsg)) {
+    return;
+  }
+  if (replaySafeNotified_) {
+    return;
+  }
   if ((cmsg.cmsg_level == SOL_IP && cmsg.cmsg_type == IP_RECVERR) ||
       (cmsg.cmsg_level == SOL_IPV6 && cmsg.cmsg_type == IPV6_RECVERR)) {
     const struct sock_extended_err* serr =
@@ -1043,13 +1136,16 @@ void QuicClientTransport::recvMsg(
     msg.msg_iov = &vec;
     msg.msg_iovlen = 1;
 #ifdef FOLLY_HAVE_MSG_ERRQUEUE
-    char control[CMSG_SPACE(sizeof(uint16_t))] = {};
+    // Room for UDP_GRO and for IP_TOS or IPV6_TCLASS.
+    char control[CMSG_SPACE(sizeof(uint16_t)) + CMSG_SPACE(sizeof(int))] = {};
     bool useGRO = sock.getGRO() > 0;
+    bool readTos = conn_->transportSettings.enableEcn;
 
-    if (useGRO) {
+    if (useGRO || readTos) {
       msg.msg_control = control;
       msg.msg_controllen = sizeof(control);
-
+    }
+    if (useGRO) {
       // we need to consider MSG_TRUNC too
       flags |= MSG_TRUNC;
     }
@@ -1077,16 +1173,19 @@ void QuicClientTransport::recvMsg(
     } else if (ret == 0) {
       break;
     }
+    auto ecn = EcnCodepoint::NotEct;
 #ifdef FOLLY_HAVE_MSG_ERRQUEUE
-    if (useGRO) {
+    if (useGRO || readTos) {
       for (struct cmsghdr* cmsg = CMSG_FIRSTHDR(&msg); cmsg != nullptr;
            cmsg = CMSG_NXTHDR(&msg, cmsg)) {
         if (cmsg->cmsg_level == SOL_UDP && cmsg->cmsg_type == UDP_GRO) {
           gro = *((uint16_t*)CMSG_DATA(cmsg));
-          break;
+        } else if (auto tos = getRecvTos(*cmsg)) {
+          ecn = static_cast<EcnCodepoint>(*tos & kEcnCodepointMask);
         }
       }
-
+    }
+    if (useGRO) {
       // truncated
       if ((size_t)ret > readBufferSize) {
         ret = readBufferSize;
@@ -1104,6 +1203,7 @@ void QuicClientTransport::recvMsg(
     }
     VLOG(10) << "Got data from socket peer=" << *server << " len=" << bytesRead;
     readBuffer->append(bytesRead);
+    auto firstPacket = networkData.packets.size();
     if (gro > 0) {
       size_t len = bytesRead;
       size_t remaining = len;
@@ -1136,6 +1236,7 @@ void QuicClientTransport::recvMsg(
     } else {
       networkData.packets.emplace_back(std::move(readBuffer));
     }
+    networkData.setEcnCodepoint(firstPacket, ecn);
     if (conn_->qLogger) {
       conn_->qLogger->addDatagramReceived(bytesRead);
     }
@@ -1159,8 +1260,12 @@ void QuicClientTransport::recvMmsg(
   int flags = 0;
 #ifdef FOLLY_HAVE_MSG_ERRQUEUE
   bool useGRO = sock.getGRO() > 0;
-  std::vector<std::array<char, CMSG_SPACE(sizeof(uint16_t))>> controlVec(
-      useGRO ? numPackets : 0);
+  bool readTos = conn_->transportSettings.enableEcn;
+  // Room for UDP_GRO and for IP_TOS or IPV6_TCLASS.
+  std::vector<std::array<
+      char,
+      CMSG_SPACE(sizeof(uint16_t)) + CMSG_SPACE(sizeof(int))>>
+      controlVec(useGRO || readTos ? numPackets : 0);
 
   // we need to consider MSG_TRUNC too
   if (useGRO) {
@@ -1190,7 +1295,7 @@ void QuicClientTransport::recvMmsg(
     msg->msg_iov = &iovecs[i];
     msg->msg_iovlen = 1;
 #ifdef FOLLY_HAVE_MSG_ERRQUEUE
-    if (useGRO) {
+    if (!controlVec.empty()) {
       msg->msg_control = controlVec[i].data();
       msg->msg_controllen = controlVec[i].size();
     }
@@ -1230,17 +1335,20 @@ void QuicClientTransport::recvMmsg(
       continue;
     }
     int gro = -1;
+    auto ecn = EcnCodepoint::NotEct;
 #ifdef FOLLY_HAVE_MSG_ERRQUEUE
-    if (useGRO) {
+    if (!controlVec.empty()) {
       for (struct cmsghdr* cmsg = CMSG_FIRSTHDR(&msgs[i].msg_hdr);
            cmsg != nullptr;
            cmsg = CMSG_NXTHDR(&msgs[i].msg_hdr, cmsg)) {
         if (cmsg->cmsg_level == SOL_UDP && cmsg->cmsg_type == UDP_GRO) {
           gro = *((uint16_t*)CMSG_DATA(cmsg));
-          break;
+        } else if (auto tos = getRecvTos(*cmsg)) {
+          ecn = static_cast<EcnCodepoint>(*tos & kEcnCodepointMask);
         }
       }
-
+    }
+    if (useGRO) {
       // truncated
       if (bytesRead > readBufferSize) {
         bytesRead = readBufferSize;
@@ -1260,6 +1368,7 @@ void QuicClientTransport::recvMmsg(
 
     VLOG(10) << "Got data from socket peer=" << *server << " len=" << bytesRead;
     readBuffers[i]->append(bytesRead);
+    auto firstPacket = networkData.packets.size();
     if (gro > 0) {
       size_t len = bytesRead;
       size_t remaining = len;
@@ -1292,6 +1401,7 @@ void QuicClientTransport::recvMmsg(
     } else {
       networkData.packets.emplace_back(std::move(readBuffers[i]));
     }
+    networkData.setEcnCodepoint(firstPacket, ecn);
 
     QUIC_TRACE(udp_recvd, *conn_, bytesRead);
     trackDatagramReceived(bytesRead);
@@ -1387,6 +1497,9 @@ void QuicClientTransport::start(ConnectionCallback* cb) {
         socketOptions_);
     // adjust the GRO buffers
     adjustGROBuffers();
+    setUpZeroCopyWrites();
+    setUpTxTimePacing();
+    setUpEcn();
     startCryptoHandshake();
   } catch (const QuicTransportException& ex) {
     runOnEvbAsync([ex](auto self) {
@@ -1453,6 +1566,14 @@ void QuicClientTransport::setHostname(const std::string& hostname) {
   hostname_ = hostname;
 }
 
+void QuicClientTransport::setNewToken(std::string newToken) {
+  clientConn_->newToken = std::move(newToken);
+}
+
+const std::string& QuicClientTransport::getNewToken() const {
+  return clientConn_->newToken;
+}
+
 void QuicClientTransport::setSelfOwning() {
   selfOwning_ = shared_from_this();
 }
@@ -1516,6 +1637,14 @@ void QuicClientTransport::adjustGROBuffers() {
 
 void QuicClientTransport::closeTransport() {
   happyEyeballsConnAttemptDelayTimeout_.cancelTimeout();
+  if (conn_->transportSettings.congestionStateCacheConfig.enabled &&
+      clientConn_->clientHandshakeLayer) {
+    auto state = getCachedCongestionState(*conn_);
+    if (state) {
+      clientConn_->clientHandshakeLayer->updatePskCongestionState(
+          hostname_, *state);
+    }
+  }
 }
 
 void QuicClientTransport::unbindConnection() {
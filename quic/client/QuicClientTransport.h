@@ -14,6 +14,7 @@
 #include <folly/io/async/AsyncUDPSocket.h>
 #include <folly/net/NetOps.h>
 #include <quic/api/QuicTransportBase.h>
+#include <quic/api/ZeroCopyTracker.h>
 #include <quic/client/state/ClientStateMachine.h>
 #include <quic/common/BufUtil.h>
 
@@ -63,6 +64,19 @@ class QuicClientTransport
    */
   void setHostname(const std::string& hostname);
 
+  /**
+   * Supply the token of a NEW_TOKEN frame from a previous connection to the
+   * server, the server skips the Retry when it validates it. Must be set
+   * before start().
+   */
+  void setNewToken(std::string newToken);
+
+  /**
+   * The token of the last NEW_TOKEN frame of the server, to supply to the next
+   * connection. Empty if the server sent none.
+   */
+  const std::string& getNewToken() const;
+
   /**
    * Supplies a new peer address to use for the connection. This must be called
    * at least once before start().
@@ -96,6 +110,7 @@ class QuicClientTransport
   void unbindConnection() override;
   bool hasWriteCipher() const override;
   std::shared_ptr<QuicTransportBase> sharedGuard() override;
+  size_t getStateSize() const override;
 
   // folly::AsyncUDPSocket::ReadCallback
   void onReadClosed() noexcept override {}
@@ -190,6 +205,7 @@ class QuicClientTransport
   void processPacketData(
       const folly::SocketAddress& peer,
       TimePoint receiveTimePoint,
+      EcnCodepoint ecn,
       BufQueue& packetQueue);
 
   void startCryptoHandshake();
@@ -208,6 +224,9 @@ class QuicClientTransport
  private:
   void setPartialReliabilityTransportParameter();
   void adjustGROBuffers();
+  void setUpZeroCopyWrites();
+  void setUpTxTimePacing();
+  void setUpEcn();
   void trackDatagramReceived(size_t len);
 
   bool replaySafeNotified_{false};
@@ -224,5 +243,7 @@ class QuicClientTransport
   // supports GRO. otherwise kDefaultNumGROBuffers
   uint32_t numGROBuffers_{kDefaultNumGROBuffers};
   RecvmmsgStorage recvmmsgStorage_;
+  // Only tracks the writes to the socket the connection started with.
+  std::unique_ptr<ZeroCopyTracker> zeroCopyTracker_;
 };
 } // namespace quic
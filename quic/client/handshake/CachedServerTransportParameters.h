@@ -8,7 +8,9 @@
 
 #pragma once
 
+#include <folly/Optional.h>
 #include <quic/QuicConstants.h>
+#include <quic/state/CongestionStateCache.h>
 
 #include <cstdint>
 
@@ -23,6 +25,9 @@ struct CachedServerTransportParameters {
   uint64_t initialMaxStreamDataUni;
   uint64_t initialMaxStreamsBidi;
   uint64_t initialMaxStreamsUni;
+  // What the last connection to the server measured, when the congestion
+  // state cache is enabled.
+  folly::Optional<CachedCongestionState> congestionState;
 };
 
 } // namespace quic
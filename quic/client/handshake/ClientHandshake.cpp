@@ -28,6 +28,17 @@ void ClientHandshake::connect(
 
   throwOnError();
 
+  if (conn_->transportSettings.congestionStateCacheConfig.enabled) {
+    if (cachedServerTransportParams &&
+        cachedServerTransportParams->congestionState &&
+        applyCachedCongestionState(
+            *conn_, *cachedServerTransportParams->congestionState)) {
+      QUIC_STATS(conn_->statsCallback, onCongestionStateCacheHit);
+    } else {
+      QUIC_STATS(conn_->statsCallback, onCongestionStateCacheMiss);
+    }
+  }
+
   if (conn_->zeroRttWriteCipher) {
     if (conn_->qLogger) {
       conn_->qLogger->addTransportStateUpdate(kZeroRttAttempted);
@@ -20,6 +20,7 @@
 namespace quic {
 
 class CryptoFactory;
+struct CachedCongestionState;
 struct CachedServerTransportParameters;
 struct ClientTransportParametersExtension;
 struct QuicClientConnectionState;
@@ -59,6 +60,14 @@ class ClientHandshake : public Handshake {
    */
   virtual void removePsk(const folly::Optional<std::string>& /* hostname */) {}
 
+  /**
+   * Keeps the congestion state with the cached PSK of the server, if there is
+   * one, for the next connection to start from.
+   */
+  virtual void updatePskCongestionState(
+      const folly::Optional<std::string>& /* hostname */,
+      const CachedCongestionState& /* state */) {}
+
   /**
    * Returns a reference to the CryptoFactory used internaly.
    */
@@ -27,7 +27,9 @@ struct ClientTransportParametersExtension {
       uint64_t activeConnectionIdLimit,
       ConnectionId initialSourceCid,
       std::vector<TransportParameter> customTransportParameters =
-          std::vector<TransportParameter>())
+          std::vector<TransportParameter>(),
+      uint64_t maxDatagramFrameSize = 0,
+      uint64_t minAckDelay = 0)
       : encodingVersion_(encodingVersion),
         initialMaxData_(initialMaxData),
         initialMaxStreamDataBidiLocal_(initialMaxStreamDataBidiLocal),
@@ -40,7 +42,9 @@ struct ClientTransportParametersExtension {
         maxRecvPacketSize_(maxRecvPacketSize),
         activeConnectionLimit_(activeConnectionIdLimit),
         initialSourceCid_(initialSourceCid),
-        customTransportParameters_(customTransportParameters) {}
+        customTransportParameters_(customTransportParameters),
+        maxDatagramFrameSize_(maxDatagramFrameSize),
+        minAckDelay_(minAckDelay) {}
 
   folly::Optional<ServerTransportParameters> getServerTransportParams() {
     return std::move(serverTransportParameters_);
@@ -60,5 +64,9 @@ struct ClientTransportParametersExtension {
   ConnectionId initialSourceCid_;
   folly::Optional<ServerTransportParameters> serverTransportParameters_;
   std::vector<TransportParameter> customTransportParameters_;
+  // Zero if datagrams are not supported.
+  uint64_t maxDatagramFrameSize_;
+  // In microseconds, zero if ACK_FREQUENCY is not supported.
+  uint64_t minAckDelay_;
 };
 } // namespace quic
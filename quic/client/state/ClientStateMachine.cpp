@@ -30,6 +30,9 @@ std::unique_ptr<QuicClientConnectionState> undoAllClientStateForRetry(
   newConn->clientConnectionId = conn->clientConnectionId;
   newConn->initialDestinationConnectionId =
       conn->initialDestinationConnectionId;
+  newConn->originalDestinationConnectionId =
+      conn->originalDestinationConnectionId;
+  newConn->newToken = std::move(conn->newToken);
   // TODO: don't carry server connection id over to the new connection.
   newConn->serverConnectionId = conn->serverConnectionId;
   newConn->ackStates.initialAckState.nextPacketNum =
@@ -89,6 +92,10 @@ void processServerInitialParams(
   auto activeConnectionIdLimit = getIntegerParameter(
       TransportParameterId::active_connection_id_limit,
       serverParams.parameters);
+  auto maxDatagramFrameSize = getIntegerParameter(
+      TransportParameterId::max_datagram_frame_size, serverParams.parameters);
+  auto minAckDelay = getIntegerParameter(
+      TransportParameterId::min_ack_delay, serverParams.parameters);
   if (conn.version == QuicVersion::QUIC_DRAFT) {
     auto initialSourceConnId = getConnIdParameter(
         TransportParameterId::initial_source_connection_id,
@@ -96,15 +103,30 @@ void processServerInitialParams(
     auto originalDestinationConnId = getConnIdParameter(
         TransportParameterId::original_destination_connection_id,
         serverParams.parameters);
+    auto retrySourceConnId = getConnIdParameter(
+        TransportParameterId::retry_source_connection_id,
+        serverParams.parameters);
+    const auto& expectedOriginalDestinationConnId =
+        conn.originalDestinationConnectionId
+        ? conn.originalDestinationConnectionId
+        : conn.initialDestinationConnectionId;
     if (!initialSourceConnId || !originalDestinationConnId ||
         initialSourceConnId.value() !=
             conn.readCodec->getServerConnectionId() ||
         originalDestinationConnId.value() !=
-            conn.initialDestinationConnectionId) {
+            expectedOriginalDestinationConnId) {
       throw QuicTransportException(
           "Initial CID does not match.",
           TransportErrorCode::TRANSPORT_PARAMETER_ERROR);
     }
+    // After a Retry the server names the connection id it chose in it.
+    if (conn.originalDestinationConnectionId
+            ? retrySourceConnId != conn.initialDestinationConnectionId
+            : retrySourceConnId.has_value()) {
+      throw QuicTransportException(
+          "Retry CID does not match.",
+          TransportErrorCode::TRANSPORT_PARAMETER_ERROR);
+    }
   }
 
   // TODO Validate active_connection_id_limit
@@ -171,6 +193,14 @@ void processServerInitialParams(
   VLOG(10) << "conn.partialReliabilityEnabled="
            << conn.partialReliabilityEnabled;
 
+  if (conn.transportSettings.datagramConfig.enabled) {
+    conn.datagramState.maxWriteFrameSize = maxDatagramFrameSize.value_or(0);
+  }
+  if (conn.transportSettings.ackFrequencyConfig.enabled && minAckDelay) {
+    conn.ackFrequencyState.peerMinAckDelay =
+        std::chrono::microseconds(*minAckDelay);
+  }
+
   conn.statelessResetToken = std::move(statelessResetToken);
   // Update the existing streams, because we allow streams to be created before
   // the connection is established.
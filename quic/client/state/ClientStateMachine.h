@@ -33,6 +33,13 @@ struct QuicClientConnectionState : public QuicConnectionStateBase {
   // Initial destination connection id.
   folly::Optional<ConnectionId> initialDestinationConnectionId;
 
+  // The initial destination connection id before the Retry, if there was one.
+  folly::Optional<ConnectionId> originalDestinationConnectionId;
+
+  // The token of a NEW_TOKEN frame, sent in the Initial when there was no
+  // Retry.
+  std::string newToken;
+
   std::shared_ptr<ClientHandshakeFactory> handshakeFactory;
   ClientHandshake* clientHandshakeLayer;
 
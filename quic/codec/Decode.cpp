@@ -12,44 +12,202 @@
 #include <quic/codec/PacketNumber.h>
 #include <quic/codec/QuicInteger.h>
 
+#include <array>
+
+namespace quic {
+
 namespace {
 
-quic::PacketNum nextAckedPacketGap(quic::PacketNum packetNum, uint64_t gap) {
+folly::Unexpected<FrameDecodeError> frameError(
+    const char* reason,
+    FrameType frameType) {
+  return folly::makeUnexpected(FrameDecodeError{reason, frameType});
+}
+
+/**
+ * Reads frames through a cursor, across the buffers of a chain.
+ */
+class CursorFrameReader {
+ public:
+  explicit CursorFrameReader(folly::io::Cursor& cursor) : cursor_(cursor) {}
+
+  folly::Optional<std::pair<uint64_t, size_t>> readQuicInteger() {
+    return decodeQuicInteger(cursor_);
+  }
+
+  // Batch decodes within each buffer, one at a time across buffers.
+  size_t readQuicIntegers(uint64_t* values, size_t count) {
+    size_t decoded = 0;
+    while (decoded < count) {
+      auto bytes = cursor_.peekBytes();
+      auto bufferLen = bytes.size();
+      decoded += decodeQuicIntegers(bytes, values + decoded, count - decoded);
+      cursor_.skip(bufferLen - bytes.size());
+      if (decoded == count) {
+        break;
+      }
+      auto value = decodeQuicInteger(cursor_);
+      if (!value) {
+        break;
+      }
+      values[decoded++] = value->first;
+    }
+    return decoded;
+  }
+
+  bool canRead(size_t len) const {
+    return cursor_.canAdvance(len);
+  }
+
+  size_t remaining() const {
+    return cursor_.totalLength();
+  }
+
+  // The caller checks that there are enough bytes with canRead().
+  template <typename T>
+  T read() {
+    return cursor_.readBE<T>();
+  }
+
+  void pull(void* buf, size_t len) {
+    cursor_.pull(buf, len);
+  }
+
+  std::string readString(size_t len) {
+    return cursor_.readFixedString(len);
+  }
+
+  Buf clone(size_t len) {
+    Buf data;
+    cursor_.clone(data, len);
+    return data;
+  }
+
+  ConnectionId readConnectionId(size_t len) {
+    return ConnectionId(cursor_, len);
+  }
+
+  folly::ByteRange peekBytes() {
+    return cursor_.peekBytes();
+  }
+
+  void skip(size_t len) {
+    cursor_.skip(len);
+  }
+
+ private:
+  folly::io::Cursor& cursor_;
+};
+
+/**
+ * Reads frames straight out of the memory of a single buffer, without the
+ * checks for crossing into the next buffer of a chain.
+ */
+class RangeFrameReader {
+ public:
+  explicit RangeFrameReader(const folly::IOBuf& buf)
+      : buf_(buf), range_(buf.data(), buf.length()) {
+    DCHECK(!buf.isChained());
+  }
+
+  folly::Optional<std::pair<uint64_t, size_t>> readQuicInteger() {
+    return decodeQuicInteger(range_);
+  }
+
+  size_t readQuicIntegers(uint64_t* values, size_t count) {
+    return decodeQuicIntegers(range_, values, count);
+  }
+
+  bool canRead(size_t len) const {
+    return range_.size() >= len;
+  }
+
+  size_t remaining() const {
+    return range_.size();
+  }
+
+  template <typename T>
+  T read() {
+    DCHECK(canRead(sizeof(T)));
+    auto value = folly::Endian::big(folly::loadUnaligned<T>(range_.data()));
+    range_.advance(sizeof(T));
+    return value;
+  }
+
+  void pull(void* buf, size_t len) {
+    DCHECK(canRead(len));
+    memcpy(buf, range_.data(), len);
+    range_.advance(len);
+  }
+
+  std::string readString(size_t len) {
+    DCHECK(canRead(len));
+    std::string str(reinterpret_cast<const char*>(range_.data()), len);
+    range_.advance(len);
+    return str;
+  }
+
+  // Shares the memory of the buffer like Cursor::clone().
+  Buf clone(size_t len) {
+    DCHECK(canRead(len));
+    auto data = buf_.cloneOne();
+    data->trimStart(range_.data() - buf_.data());
+    data->trimEnd(data->length() - len);
+    range_.advance(len);
+    return data;
+  }
+
+  ConnectionId readConnectionId(size_t len) {
+    DCHECK(canRead(len));
+    auto connIdBuf = folly::IOBuf::wrapBufferAsValue(range_.data(), len);
+    folly::io::Cursor cursor(&connIdBuf);
+    range_.advance(len);
+    return ConnectionId(cursor, len);
+  }
+
+  folly::ByteRange peekBytes() {
+    return range_;
+  }
+
+  void skip(size_t len) {
+    DCHECK(canRead(len));
+    range_.advance(len);
+  }
+
+ private:
+  const folly::IOBuf& buf_;
+  folly::ByteRange range_;
+};
+
+folly::Optional<quic::PacketNum> nextAckedPacketGap(
+    quic::PacketNum packetNum,
+    uint64_t gap) {
   // Gap cannot overflow because of the definition of quic integer encoding, so
   // we can just add to gap.
   uint64_t adjustedGap = gap + 2;
   if (packetNum < adjustedGap) {
-    throw quic::QuicTransportException(
-        "Bad gap",
-        quic::TransportErrorCode::FRAME_ENCODING_ERROR,
-        quic::FrameType::ACK);
+    return folly::none;
   }
   return packetNum - adjustedGap;
 }
 
-quic::PacketNum nextAckedPacketLen(
+folly::Optional<quic::PacketNum> nextAckedPacketLen(
     quic::PacketNum packetNum,
     uint64_t ackBlockLen) {
   // Going to allow 0 as a valid value.
   if (packetNum < ackBlockLen) {
-    throw quic::QuicTransportException(
-        "Bad block len",
-        quic::TransportErrorCode::FRAME_ENCODING_ERROR,
-        quic::FrameType::ACK);
+    return folly::none;
   }
   return packetNum - ackBlockLen;
 }
 
-} // namespace
-
-namespace quic {
-
-PaddingFrame decodePaddingFrame(folly::io::Cursor& cursor) {
+template <typename Reader>
+PaddingFrame readPaddingFrame(Reader& reader) {
   // we might have multiple padding frames in sequence in the common case.
   // Let's consume all the padding and return 1 padding frame for everything.
   static_assert(
       static_cast<int>(FrameType::PADDING) == 0, "Padding value is 0");
-  folly::ByteRange paddingBytes = cursor.peekBytes();
+  folly::ByteRange paddingBytes = reader.peekBytes();
   if (paddingBytes.size() == 0) {
     return PaddingFrame();
   }
@@ -62,49 +220,35 @@ PaddingFrame decodePaddingFrame(folly::io::Cursor& cursor) {
   int ret = memcmp(
       paddingBytes.data(), paddingBytes.data() + 1, paddingBytes.size() - 1);
   if (ret == 0) {
-    cursor.skip(paddingBytes.size());
+    reader.skip(paddingBytes.size());
   }
   return PaddingFrame();
 }
 
-PingFrame decodePingFrame(folly::io::Cursor&) {
-  return PingFrame();
-}
+// Gaps and lengths of the ack blocks decoded in one batch.
+constexpr size_t kAckBlocksPerBatch = 16;
 
-ReadAckFrame decodeAckFrame(
-    folly::io::Cursor& cursor,
+template <typename Reader>
+folly::Expected<ReadAckFrame, FrameDecodeError> readAckFrame(
+    Reader& reader,
     const PacketHeader& header,
     const CodecParameters& params) {
   ReadAckFrame frame;
-  auto largestAckedInt = decodeQuicInteger(cursor);
-  if (!largestAckedInt) {
-    throw QuicTransportException(
-        "Bad largest acked",
-        quic::TransportErrorCode::FRAME_ENCODING_ERROR,
-        quic::FrameType::ACK);
-  }
-  auto largestAcked = folly::to<PacketNum>(largestAckedInt->first);
-  auto ackDelay = decodeQuicInteger(cursor);
-  if (!ackDelay) {
-    throw QuicTransportException(
-        "Bad ack delay",
-        quic::TransportErrorCode::FRAME_ENCODING_ERROR,
-        quic::FrameType::ACK);
-  }
-  auto additionalAckBlocks = decodeQuicInteger(cursor);
-  if (!additionalAckBlocks) {
-    throw QuicTransportException(
-        "Bad ack block count",
-        quic::TransportErrorCode::FRAME_ENCODING_ERROR,
-        quic::FrameType::ACK);
-  }
-  auto firstAckBlockLen = decodeQuicInteger(cursor);
-  if (!firstAckBlockLen) {
-    throw QuicTransportException(
-        "Bad first block",
-        quic::TransportErrorCode::FRAME_ENCODING_ERROR,
-        quic::FrameType::ACK);
-  }
+  // Largest acked, ack delay, ack block count and first ack block length.
+  static constexpr std::array<const char*, 4> kFieldErrors = {
+      {"Bad largest acked",
+       "Bad ack delay",
+       "Bad ack block count",
+       "Bad first block"}};
+  std::array<uint64_t, kFieldErrors.size()> fields;
+  auto numFields = reader.readQuicIntegers(fields.data(), fields.size());
+  if (numFields < fields.size()) {
+    return frameError(kFieldErrors[numFields], FrameType::ACK);
+  }
+  auto largestAcked = folly::to<PacketNum>(fields[0]);
+  uint64_t ackDelay = fields[1];
+  uint64_t additionalAckBlocks = fields[2];
+  uint64_t firstAckBlockLen = fields[3];
   // Using default ack delay for long header packets. Before negotiating
   // and ack delay, the sender has to use something, so they use the default
   // ack delay. To keep it consistent the protocol specifies using the same
@@ -112,385 +256,338 @@ ReadAckFrame decodeAckFrame(
   uint8_t ackDelayExponentToUse = (header.getHeaderForm() == HeaderForm::Long)
       ? kDefaultAckDelayExponent
       : params.peerAckDelayExponent;
-  DCHECK_LT(ackDelayExponentToUse, sizeof(ackDelay->first) * 8);
+  DCHECK_LT(ackDelayExponentToUse, sizeof(ackDelay) * 8);
   // ackDelayExponentToUse is guaranteed to be less than the size of uint64_t
   uint64_t delayOverflowMask = 0xFFFFFFFFFFFFFFFF;
-  uint8_t leftShift = (sizeof(ackDelay->first) * 8 - ackDelayExponentToUse);
+  uint8_t leftShift = (sizeof(ackDelay) * 8 - ackDelayExponentToUse);
   DCHECK_LT(leftShift, sizeof(delayOverflowMask) * 8);
   delayOverflowMask = delayOverflowMask << leftShift;
-  if ((ackDelay->first & delayOverflowMask) != 0) {
-    throw QuicTransportException(
-        "Decoded ack delay overflows",
-        quic::TransportErrorCode::FRAME_ENCODING_ERROR,
-        quic::FrameType::ACK);
+  if ((ackDelay & delayOverflowMask) != 0) {
+    return frameError("Decoded ack delay overflows", FrameType::ACK);
   }
-  uint64_t adjustedAckDelay = ackDelay->first << ackDelayExponentToUse;
+  uint64_t adjustedAckDelay = ackDelay << ackDelayExponentToUse;
   if (adjustedAckDelay >
       static_cast<uint64_t>(
           std::numeric_limits<std::chrono::microseconds::rep>::max())) {
-    throw QuicTransportException(
-        "Bad ack delay",
-        quic::TransportErrorCode::FRAME_ENCODING_ERROR,
-        quic::FrameType::ACK);
+    return frameError("Bad ack delay", FrameType::ACK);
+  }
+  auto currentPacketNum = nextAckedPacketLen(largestAcked, firstAckBlockLen);
+  if (!currentPacketNum) {
+    return frameError("Bad block len", FrameType::ACK);
   }
-  PacketNum currentPacketNum =
-      nextAckedPacketLen(largestAcked, firstAckBlockLen->first);
   frame.largestAcked = largestAcked;
   frame.ackDelay = std::chrono::microseconds(adjustedAckDelay);
-  frame.ackBlocks.emplace_back(currentPacketNum, largestAcked);
-  for (uint64_t numBlocks = 0; numBlocks < additionalAckBlocks->first;
-       ++numBlocks) {
-    auto currentGap = decodeQuicInteger(cursor);
-    if (!currentGap) {
-      throw QuicTransportException(
-          "Bad gap",
-          quic::TransportErrorCode::FRAME_ENCODING_ERROR,
-          quic::FrameType::ACK);
+  frame.ackBlocks.emplace_back(*currentPacketNum, largestAcked);
+  std::array<uint64_t, 2 * kAckBlocksPerBatch> gapsAndLens;
+  uint64_t numBlocks = 0;
+  while (numBlocks < additionalAckBlocks) {
+    size_t batchLen = 2 *
+        std::min<uint64_t>(kAckBlocksPerBatch, additionalAckBlocks - numBlocks);
+    auto numDecoded = reader.readQuicIntegers(gapsAndLens.data(), batchLen);
+    for (size_t i = 0; i + 1 < numDecoded; i += 2) {
+      auto nextEndPacket =
+          nextAckedPacketGap(*currentPacketNum, gapsAndLens[i]);
+      if (!nextEndPacket) {
+        return frameError("Bad gap", FrameType::ACK);
+      }
+      currentPacketNum =
+          nextAckedPacketLen(*nextEndPacket, gapsAndLens[i + 1]);
+      if (!currentPacketNum) {
+        return frameError("Bad block len", FrameType::ACK);
+      }
+      // We don't need to add the entry when the block length is zero since we
+      // already would have processed it in the previous iteration.
+      frame.ackBlocks.emplace_back(*currentPacketNum, *nextEndPacket);
     }
-    auto blockLen = decodeQuicInteger(cursor);
-    if (!blockLen) {
-      throw QuicTransportException(
-          "Bad block len",
-          quic::TransportErrorCode::FRAME_ENCODING_ERROR,
-          quic::FrameType::ACK);
+    if (numDecoded < batchLen) {
+      return frameError(
+          numDecoded % 2 == 0 ? "Bad gap" : "Bad block len", FrameType::ACK);
     }
-    PacketNum nextEndPacket =
-        nextAckedPacketGap(currentPacketNum, currentGap->first);
-    currentPacketNum = nextAckedPacketLen(nextEndPacket, blockLen->first);
-    // We don't need to add the entry when the block length is zero since we
-    // already would have processed it in the previous iteration.
-    frame.ackBlocks.emplace_back(currentPacketNum, nextEndPacket);
+    numBlocks += batchLen / 2;
   }
   return frame;
 }
 
-ReadAckFrame decodeAckFrameWithECN(
-    folly::io::Cursor& cursor,
+template <typename Reader>
+folly::Expected<ReadAckFrame, FrameDecodeError> readAckFrameWithECN(
+    Reader& reader,
     const PacketHeader& header,
     const CodecParameters& params) {
-  // TODO this is incomplete
-  auto readAckFrame = decodeAckFrame(cursor, header, params);
-  // TODO we simply ignore ECN blocks in ACK-ECN frames for now.
-  auto ect_0 = decodeQuicInteger(cursor);
+  auto readAck = readAckFrame(reader, header, params);
+  if (!readAck) {
+    return readAck;
+  }
+  auto ect_0 = reader.readQuicInteger();
   if (!ect_0) {
-    throw QuicTransportException(
-        "Bad ECT(0) value",
-        quic::TransportErrorCode::FRAME_ENCODING_ERROR,
-        quic::FrameType::ACK_ECN);
+    return frameError("Bad ECT(0) value", FrameType::ACK_ECN);
   }
-  auto ect_1 = decodeQuicInteger(cursor);
+  auto ect_1 = reader.readQuicInteger();
   if (!ect_1) {
-    throw QuicTransportException(
-        "Bad ECT(1) value",
-        quic::TransportErrorCode::FRAME_ENCODING_ERROR,
-        quic::FrameType::ACK_ECN);
+    return frameError("Bad ECT(1) value", FrameType::ACK_ECN);
   }
-  auto ect_ce = decodeQuicInteger(cursor);
+  auto ect_ce = reader.readQuicInteger();
   if (!ect_ce) {
-    throw QuicTransportException(
-        "Bad ECT-CE value",
-        quic::TransportErrorCode::FRAME_ENCODING_ERROR,
-        quic::FrameType::ACK_ECN);
+    return frameError("Bad ECT-CE value", FrameType::ACK_ECN);
   }
-  return readAckFrame;
+  readAck->ecnCounts.emplace();
+  readAck->ecnCounts->ect0 = ect_0->first;
+  readAck->ecnCounts->ect1 = ect_1->first;
+  readAck->ecnCounts->ce = ect_ce->first;
+  return readAck;
 }
 
-RstStreamFrame decodeRstStreamFrame(folly::io::Cursor& cursor) {
-  auto streamId = decodeQuicInteger(cursor);
+template <typename Reader>
+folly::Expected<RstStreamFrame, FrameDecodeError> readRstStreamFrame(
+    Reader& reader) {
+  auto streamId = reader.readQuicInteger();
   if (!streamId) {
-    throw QuicTransportException(
-        "Bad streamId",
-        quic::TransportErrorCode::FRAME_ENCODING_ERROR,
-        quic::FrameType::RST_STREAM);
-  }
-  ApplicationErrorCode errorCode;
-  auto varCode = decodeQuicInteger(cursor);
-  if (varCode) {
-    errorCode = static_cast<ApplicationErrorCode>(varCode->first);
-  } else {
-    throw QuicTransportException(
-        "Cannot decode error code",
-        quic::TransportErrorCode::FRAME_ENCODING_ERROR,
-        quic::FrameType::RST_STREAM);
+    return frameError("Bad streamId", FrameType::RST_STREAM);
   }
-  auto offset = decodeQuicInteger(cursor);
+  auto varCode = reader.readQuicInteger();
+  if (!varCode) {
+    return frameError("Cannot decode error code", FrameType::RST_STREAM);
+  }
+  auto errorCode = static_cast<ApplicationErrorCode>(varCode->first);
+  auto offset = reader.readQuicInteger();
   if (!offset) {
-    throw QuicTransportException(
-        "Bad offset",
-        quic::TransportErrorCode::FRAME_ENCODING_ERROR,
-        quic::FrameType::RST_STREAM);
+    return frameError("Bad offset", FrameType::RST_STREAM);
   }
   return RstStreamFrame(
       folly::to<StreamId>(streamId->first), errorCode, offset->first);
 }
 
-StopSendingFrame decodeStopSendingFrame(folly::io::Cursor& cursor) {
-  auto streamId = decodeQuicInteger(cursor);
+template <typename Reader>
+folly::Expected<StopSendingFrame, FrameDecodeError> readStopSendingFrame(
+    Reader& reader) {
+  auto streamId = reader.readQuicInteger();
   if (!streamId) {
-    throw QuicTransportException(
-        "Bad streamId",
-        quic::TransportErrorCode::FRAME_ENCODING_ERROR,
-        quic::FrameType::STOP_SENDING);
-  }
-  ApplicationErrorCode errorCode;
-  auto varCode = decodeQuicInteger(cursor);
-  if (varCode) {
-    errorCode = static_cast<ApplicationErrorCode>(varCode->first);
-  } else {
-    throw QuicTransportException(
-        "Cannot decode error code",
-        quic::TransportErrorCode::FRAME_ENCODING_ERROR,
-        quic::FrameType::STOP_SENDING);
+    return frameError("Bad streamId", FrameType::STOP_SENDING);
+  }
+  auto varCode = reader.readQuicInteger();
+  if (!varCode) {
+    return frameError("Cannot decode error code", FrameType::STOP_SENDING);
   }
+  auto errorCode = static_cast<ApplicationErrorCode>(varCode->first);
   return StopSendingFrame(folly::to<StreamId>(streamId->first), errorCode);
 }
 
-ReadCryptoFrame decodeCryptoFrame(folly::io::Cursor& cursor) {
-  auto optionalOffset = decodeQuicInteger(cursor);
+template <typename Reader>
+folly::Expected<ReadCryptoFrame, FrameDecodeError> readCryptoFrame(
+    Reader& reader) {
+  auto optionalOffset = reader.readQuicInteger();
   if (!optionalOffset) {
-    throw QuicTransportException(
-        "Invalid offset",
-        quic::TransportErrorCode::FRAME_ENCODING_ERROR,
-        quic::FrameType::CRYPTO_FRAME);
+    return frameError("Invalid offset", FrameType::CRYPTO_FRAME);
   }
   uint64_t offset = optionalOffset->first;
 
-  auto dataLength = decodeQuicInteger(cursor);
+  auto dataLength = reader.readQuicInteger();
   if (!dataLength) {
-    throw QuicTransportException(
-        "Invalid length",
-        quic::TransportErrorCode::FRAME_ENCODING_ERROR,
-        quic::FrameType::CRYPTO_FRAME);
+    return frameError("Invalid length", FrameType::CRYPTO_FRAME);
   }
-  Buf data;
-  if (cursor.totalLength() < dataLength->first) {
-    throw QuicTransportException(
-        "Length mismatch",
-        quic::TransportErrorCode::FRAME_ENCODING_ERROR,
-        quic::FrameType::CRYPTO_FRAME);
+  if (!reader.canRead(dataLength->first)) {
+    return frameError("Length mismatch", FrameType::CRYPTO_FRAME);
   }
-  // If dataLength > data's actual length then the cursor will throw.
-  cursor.clone(data, dataLength->first);
-  return ReadCryptoFrame(offset, std::move(data));
+  return ReadCryptoFrame(offset, reader.clone(dataLength->first));
 }
 
-ReadNewTokenFrame decodeNewTokenFrame(folly::io::Cursor& cursor) {
-  auto tokenLength = decodeQuicInteger(cursor);
+template <typename Reader>
+folly::Expected<ReadNewTokenFrame, FrameDecodeError> readNewTokenFrame(
+    Reader& reader) {
+  auto tokenLength = reader.readQuicInteger();
   if (!tokenLength) {
-    throw QuicTransportException(
-        "Invalid length",
-        quic::TransportErrorCode::FRAME_ENCODING_ERROR,
-        quic::FrameType::NEW_TOKEN);
+    return frameError("Invalid length", FrameType::NEW_TOKEN);
   }
-  Buf token;
-  if (cursor.totalLength() < tokenLength->first) {
-    throw QuicTransportException(
-        "Length mismatch",
-        quic::TransportErrorCode::FRAME_ENCODING_ERROR,
-        quic::FrameType::NEW_TOKEN);
+  if (!reader.canRead(tokenLength->first)) {
+    return frameError("Length mismatch", FrameType::NEW_TOKEN);
   }
-  // If tokenLength > token's actual length then the cursor will throw.
-  cursor.clone(token, tokenLength->first);
-  return ReadNewTokenFrame(std::move(token));
+  return ReadNewTokenFrame(reader.clone(tokenLength->first));
 }
 
-ReadStreamFrame decodeStreamFrame(
-    BufQueue& queue,
+template <typename Reader>
+folly::Expected<ReadStreamFrame, FrameDecodeError> readStreamFrame(
+    Reader& reader,
     StreamTypeField frameTypeField) {
-  folly::io::Cursor cursor(queue.front());
-  auto streamId = decodeQuicInteger(cursor);
-  if (!streamId) {
-    throw QuicTransportException(
-        "Invalid stream id",
-        quic::TransportErrorCode::FRAME_ENCODING_ERROR,
-        quic::FrameType::STREAM);
-  }
-  uint64_t offset = 0;
+  // Stream id, then the offset and the data length when present.
+  std::array<uint64_t, 3> fields;
+  std::array<const char*, 3> fieldErrors;
+  size_t numFields = 0;
+  fieldErrors[numFields++] = "Invalid stream id";
   if (frameTypeField.hasOffset()) {
-    auto optionalOffset = decodeQuicInteger(cursor);
-    if (!optionalOffset) {
-      throw QuicTransportException(
-          "Invalid offset",
-          quic::TransportErrorCode::FRAME_ENCODING_ERROR,
-          quic::FrameType::STREAM);
-    }
-    offset = optionalOffset->first;
+    fieldErrors[numFields++] = "Invalid offset";
+  }
+  if (frameTypeField.hasDataLength()) {
+    fieldErrors[numFields++] = "Invalid length";
+  }
+  auto numDecoded = reader.readQuicIntegers(fields.data(), numFields);
+  if (numDecoded < numFields) {
+    return frameError(fieldErrors[numDecoded], FrameType::STREAM);
   }
+  auto streamId = fields[0];
+  uint64_t offset = frameTypeField.hasOffset() ? fields[1] : 0;
   auto fin = frameTypeField.hasFin();
-  folly::Optional<std::pair<uint64_t, size_t>> dataLength;
+  // Missing Data Length field doesn't mean no data. It means the rest of the
+  // frame are all data.
+  uint64_t dataLength = 0;
   if (frameTypeField.hasDataLength()) {
-    dataLength = decodeQuicInteger(cursor);
-    if (!dataLength) {
-      throw QuicTransportException(
-          "Invalid length",
-          quic::TransportErrorCode::FRAME_ENCODING_ERROR,
-          quic::FrameType::STREAM);
+    dataLength = fields[numFields - 1];
+    if (!reader.canRead(dataLength)) {
+      return frameError("Length mismatch", FrameType::STREAM);
     }
+  } else {
+    dataLength = reader.remaining();
   }
-  Buf data;
-  if (dataLength.has_value()) {
-    if (cursor.totalLength() < dataLength->first) {
-      throw QuicTransportException(
-          "Length mismatch",
-          quic::TransportErrorCode::FRAME_ENCODING_ERROR,
-          quic::FrameType::STREAM);
+  return ReadStreamFrame(
+      folly::to<StreamId>(streamId), offset, reader.clone(dataLength), fin);
+}
+
+template <typename Reader>
+folly::Expected<DatagramFrame, FrameDecodeError> readDatagramFrame(
+    Reader& reader,
+    bool hasLen) {
+  size_t length = 0;
+  if (hasLen) {
+    auto decodedLength = reader.readQuicInteger();
+    if (!decodedLength) {
+      return frameError("Invalid datagram len", FrameType::DATAGRAM_LEN);
+    }
+    if (!reader.canRead(decodedLength->first)) {
+      return frameError("Invalid datagram frame", FrameType::DATAGRAM_LEN);
     }
-    // If dataLength > data's actual length then the cursor will throw.
-    queue.trimStart(cursor - queue.front());
-    data = queue.splitAtMost(dataLength->first);
+    length = decodedLength->first;
   } else {
-    // Missing Data Length field doesn't mean no data. It means the rest of the
-    // frame are all data.
-    queue.trimStart(cursor - queue.front());
-    data = queue.move();
+    length = reader.remaining();
   }
-  return ReadStreamFrame(
-      folly::to<StreamId>(streamId->first), offset, std::move(data), fin);
+  return DatagramFrame(length, reader.clone(length));
 }
 
-MaxDataFrame decodeMaxDataFrame(folly::io::Cursor& cursor) {
-  auto maximumData = decodeQuicInteger(cursor);
+template <typename Reader>
+folly::Expected<MaxDataFrame, FrameDecodeError> readMaxDataFrame(
+    Reader& reader) {
+  auto maximumData = reader.readQuicInteger();
   if (!maximumData) {
-    throw QuicTransportException(
-        "Bad Max Data",
-        quic::TransportErrorCode::FRAME_ENCODING_ERROR,
-        quic::FrameType::MAX_DATA);
+    return frameError("Bad Max Data", FrameType::MAX_DATA);
   }
   return MaxDataFrame(maximumData->first);
 }
 
-MaxStreamDataFrame decodeMaxStreamDataFrame(folly::io::Cursor& cursor) {
-  auto streamId = decodeQuicInteger(cursor);
+template <typename Reader>
+folly::Expected<MaxStreamDataFrame, FrameDecodeError> readMaxStreamDataFrame(
+    Reader& reader) {
+  auto streamId = reader.readQuicInteger();
   if (!streamId) {
-    throw QuicTransportException(
-        "Invalid streamId",
-        quic::TransportErrorCode::FRAME_ENCODING_ERROR,
-        quic::FrameType::MAX_STREAM_DATA);
+    return frameError("Invalid streamId", FrameType::MAX_STREAM_DATA);
   }
-  auto offset = decodeQuicInteger(cursor);
+  auto offset = reader.readQuicInteger();
   if (!offset) {
-    throw QuicTransportException(
-        "Invalid offset",
-        quic::TransportErrorCode::FRAME_ENCODING_ERROR,
-        quic::FrameType::MAX_STREAM_DATA);
+    return frameError("Invalid offset", FrameType::MAX_STREAM_DATA);
   }
   return MaxStreamDataFrame(
       folly::to<StreamId>(streamId->first), offset->first);
 }
 
-MaxStreamsFrame decodeBiDiMaxStreamsFrame(folly::io::Cursor& cursor) {
-  auto streamCount = decodeQuicInteger(cursor);
+template <typename Reader>
+folly::Expected<MaxStreamsFrame, FrameDecodeError> readBiDiMaxStreamsFrame(
+    Reader& reader) {
+  auto streamCount = reader.readQuicInteger();
   if (!streamCount) {
-    throw QuicTransportException(
-        "Invalid Bi-directional streamId",
-        quic::TransportErrorCode::FRAME_ENCODING_ERROR,
-        quic::FrameType::MAX_STREAMS_BIDI);
+    return frameError(
+        "Invalid Bi-directional streamId", FrameType::MAX_STREAMS_BIDI);
   }
   return MaxStreamsFrame(streamCount->first, true /* isBidirectional*/);
 }
 
-MaxStreamsFrame decodeUniMaxStreamsFrame(folly::io::Cursor& cursor) {
-  auto streamCount = decodeQuicInteger(cursor);
+template <typename Reader>
+folly::Expected<MaxStreamsFrame, FrameDecodeError> readUniMaxStreamsFrame(
+    Reader& reader) {
+  auto streamCount = reader.readQuicInteger();
   if (!streamCount) {
-    throw QuicTransportException(
-        "Invalid Uni-directional streamId",
-        quic::TransportErrorCode::FRAME_ENCODING_ERROR,
-        quic::FrameType::MAX_STREAMS_UNI);
+    return frameError(
+        "Invalid Uni-directional streamId", FrameType::MAX_STREAMS_UNI);
   }
   return MaxStreamsFrame(streamCount->first, false /* isUnidirectional */);
 }
 
-DataBlockedFrame decodeDataBlockedFrame(folly::io::Cursor& cursor) {
-  auto dataLimit = decodeQuicInteger(cursor);
+template <typename Reader>
+folly::Expected<DataBlockedFrame, FrameDecodeError> readDataBlockedFrame(
+    Reader& reader) {
+  auto dataLimit = reader.readQuicInteger();
   if (!dataLimit) {
-    throw QuicTransportException(
-        "Bad offset",
-        quic::TransportErrorCode::FRAME_ENCODING_ERROR,
-        quic::FrameType::DATA_BLOCKED);
+    return frameError("Bad offset", FrameType::DATA_BLOCKED);
   }
   return DataBlockedFrame(dataLimit->first);
 }
 
-StreamDataBlockedFrame decodeStreamDataBlockedFrame(folly::io::Cursor& cursor) {
-  auto streamId = decodeQuicInteger(cursor);
+template <typename Reader>
+folly::Expected<StreamDataBlockedFrame, FrameDecodeError>
+readStreamDataBlockedFrame(Reader& reader) {
+  auto streamId = reader.readQuicInteger();
   if (!streamId) {
-    throw QuicTransportException(
-        "Bad streamId",
-        quic::TransportErrorCode::FRAME_ENCODING_ERROR,
-        quic::FrameType::STREAM_DATA_BLOCKED);
+    return frameError("Bad streamId", FrameType::STREAM_DATA_BLOCKED);
   }
-  auto dataLimit = decodeQuicInteger(cursor);
+  auto dataLimit = reader.readQuicInteger();
   if (!dataLimit) {
-    throw QuicTransportException(
-        "Bad offset",
-        quic::TransportErrorCode::FRAME_ENCODING_ERROR,
-        quic::FrameType::STREAM_DATA_BLOCKED);
+    return frameError("Bad offset", FrameType::STREAM_DATA_BLOCKED);
   }
   return StreamDataBlockedFrame(
       folly::to<StreamId>(streamId->first), dataLimit->first);
 }
 
-StreamsBlockedFrame decodeBiDiStreamsBlockedFrame(folly::io::Cursor& cursor) {
-  auto streamId = decodeQuicInteger(cursor);
+template <typename Reader>
+folly::Expected<StreamsBlockedFrame, FrameDecodeError>
+readBiDiStreamsBlockedFrame(Reader& reader) {
+  auto streamId = reader.readQuicInteger();
   if (!streamId) {
-    throw QuicTransportException(
-        "Bad Bi-Directional streamId",
-        quic::TransportErrorCode::FRAME_ENCODING_ERROR,
-        quic::FrameType::STREAMS_BLOCKED_BIDI);
+    return frameError(
+        "Bad Bi-Directional streamId", FrameType::STREAMS_BLOCKED_BIDI);
   }
   return StreamsBlockedFrame(
       folly::to<StreamId>(streamId->first), true /* isBidirectional */);
 }
 
-StreamsBlockedFrame decodeUniStreamsBlockedFrame(folly::io::Cursor& cursor) {
-  auto streamId = decodeQuicInteger(cursor);
+template <typename Reader>
+folly::Expected<StreamsBlockedFrame, FrameDecodeError>
+readUniStreamsBlockedFrame(Reader& reader) {
+  auto streamId = reader.readQuicInteger();
   if (!streamId) {
-    throw QuicTransportException(
-        "Bad Uni-direcitonal streamId",
-        quic::TransportErrorCode::FRAME_ENCODING_ERROR,
-        quic::FrameType::STREAMS_BLOCKED_UNI);
+    return frameError(
+        "Bad Uni-direcitonal streamId", FrameType::STREAMS_BLOCKED_UNI);
   }
   return StreamsBlockedFrame(
       folly::to<StreamId>(streamId->first), false /* isBidirectional */);
 }
 
-NewConnectionIdFrame decodeNewConnectionIdFrame(folly::io::Cursor& cursor) {
-  auto sequenceNumber = decodeQuicInteger(cursor);
+template <typename Reader>
+folly::Expected<NewConnectionIdFrame, FrameDecodeError>
+readNewConnectionIdFrame(Reader& reader) {
+  auto sequenceNumber = reader.readQuicInteger();
   if (!sequenceNumber) {
-    throw QuicTransportException(
-        "Bad sequence",
-        quic::TransportErrorCode::FRAME_ENCODING_ERROR,
-        quic::FrameType::NEW_CONNECTION_ID);
+    return frameError("Bad sequence", FrameType::NEW_CONNECTION_ID);
   }
-  auto retirePriorTo = decodeQuicInteger(cursor);
+  auto retirePriorTo = reader.readQuicInteger();
   if (!retirePriorTo) {
-    throw QuicTransportException(
-        "Bad retire prior to",
-        quic::TransportErrorCode::FRAME_ENCODING_ERROR,
-        quic::FrameType::NEW_CONNECTION_ID);
+    return frameError("Bad retire prior to", FrameType::NEW_CONNECTION_ID);
   }
-  if (!cursor.canAdvance(sizeof(uint8_t))) {
-    throw QuicTransportException(
+  if (!reader.canRead(sizeof(uint8_t))) {
+    return frameError(
         "Not enough input bytes to read Dest. ConnectionId",
-        quic::TransportErrorCode::FRAME_ENCODING_ERROR,
-        quic::FrameType::NEW_CONNECTION_ID);
+        FrameType::NEW_CONNECTION_ID);
   }
-  auto connIdLen = cursor.readBE<uint8_t>();
-  if (cursor.totalLength() < connIdLen) {
-    throw QuicTransportException(
-        "Bad connid",
-        quic::TransportErrorCode::FRAME_ENCODING_ERROR,
-        quic::FrameType::NEW_CONNECTION_ID);
+  auto connIdLen = reader.template read<uint8_t>();
+  if (!reader.canRead(connIdLen)) {
+    return frameError("Bad connid", FrameType::NEW_CONNECTION_ID);
   }
   if (connIdLen > kMaxConnectionIdSize) {
-    throw QuicTransportException(
-        "ConnectionId invalid length",
-        quic::TransportErrorCode::FRAME_ENCODING_ERROR,
-        quic::FrameType::NEW_CONNECTION_ID);
+    return frameError(
+        "ConnectionId invalid length", FrameType::NEW_CONNECTION_ID);
   }
-  ConnectionId connId(cursor, connIdLen);
+  ConnectionId connId = reader.readConnectionId(connIdLen);
   StatelessResetToken statelessResetToken;
-  cursor.pull(statelessResetToken.data(), statelessResetToken.size());
+  if (!reader.canRead(statelessResetToken.size())) {
+    return frameError(
+        "Not enough input bytes to read stateless reset token",
+        FrameType::NEW_CONNECTION_ID);
+  }
+  reader.pull(statelessResetToken.data(), statelessResetToken.size());
   return NewConnectionIdFrame(
       sequenceNumber->first,
       retirePriorTo->first,
@@ -498,127 +595,114 @@ NewConnectionIdFrame decodeNewConnectionIdFrame(folly::io::Cursor& cursor) {
       std::move(statelessResetToken));
 }
 
-RetireConnectionIdFrame decodeRetireConnectionIdFrame(
-    folly::io::Cursor& cursor) {
+template <typename Reader>
+folly::Expected<RetireConnectionIdFrame, FrameDecodeError>
+readRetireConnectionIdFrame(Reader& reader) {
   // TODO we parse this frame, but return NoopFrame. Add proper support for it!
-  auto sequenceNum = decodeQuicInteger(cursor);
+  auto sequenceNum = reader.readQuicInteger();
   if (!sequenceNum) {
-    throw QuicTransportException(
-        // TODO change the error code
-        "Bad sequence num",
-        quic::TransportErrorCode::FRAME_ENCODING_ERROR,
-        quic::FrameType::RETIRE_CONNECTION_ID);
+    // TODO change the error code
+    return frameError("Bad sequence num", FrameType::RETIRE_CONNECTION_ID);
   }
   return RetireConnectionIdFrame(sequenceNum->first);
 }
 
-PathChallengeFrame decodePathChallengeFrame(folly::io::Cursor& cursor) {
+template <typename Reader>
+folly::Expected<PathChallengeFrame, FrameDecodeError> readPathChallengeFrame(
+    Reader& reader) {
   // just parse and ignore expected data
   // A PATH_CHALLENGE frame contains 8 bytes
-  if (!cursor.canAdvance(sizeof(uint64_t))) {
-    throw QuicTransportException(
+  if (!reader.canRead(sizeof(uint64_t))) {
+    return frameError(
         "Not enough input bytes to read path challenge frame.",
-        quic::TransportErrorCode::FRAME_ENCODING_ERROR,
-        quic::FrameType::PATH_CHALLENGE);
+        FrameType::PATH_CHALLENGE);
   }
-  auto pathData = cursor.readBE<uint64_t>();
+  auto pathData = reader.template read<uint64_t>();
   return PathChallengeFrame(pathData);
 }
 
-PathResponseFrame decodePathResponseFrame(folly::io::Cursor& cursor) {
+template <typename Reader>
+folly::Expected<PathResponseFrame, FrameDecodeError> readPathResponseFrame(
+    Reader& reader) {
   // just parse and ignore expected data
   // Its format is identical to the PATH_CHALLENGE frame
-  if (!cursor.canAdvance(sizeof(uint64_t))) {
-    throw QuicTransportException(
+  if (!reader.canRead(sizeof(uint64_t))) {
+    return frameError(
         "Not enough input bytes to read path response frame.",
-        quic::TransportErrorCode::FRAME_ENCODING_ERROR,
-        quic::FrameType::PATH_RESPONSE);
+        FrameType::PATH_RESPONSE);
   }
-  auto pathData = cursor.readBE<uint64_t>();
+  auto pathData = reader.template read<uint64_t>();
   return PathResponseFrame(pathData);
 }
 
-ConnectionCloseFrame decodeConnectionCloseFrame(folly::io::Cursor& cursor) {
-  TransportErrorCode errorCode{};
-  auto varCode = decodeQuicInteger(cursor);
-  if (varCode) {
-    errorCode = static_cast<TransportErrorCode>(varCode->first);
-  } else {
-    throw QuicTransportException(
-        "Failed to parse error code.",
-        quic::TransportErrorCode::FRAME_ENCODING_ERROR,
-        quic::FrameType::CONNECTION_CLOSE);
+template <typename Reader>
+folly::Expected<ConnectionCloseFrame, FrameDecodeError>
+readConnectionCloseFrame(Reader& reader) {
+  auto varCode = reader.readQuicInteger();
+  if (!varCode) {
+    return frameError(
+        "Failed to parse error code.", FrameType::CONNECTION_CLOSE);
   }
-  auto frameTypeField = decodeQuicInteger(cursor);
+  auto errorCode = static_cast<TransportErrorCode>(varCode->first);
+  auto frameTypeField = reader.readQuicInteger();
   if (!frameTypeField || frameTypeField->second != sizeof(uint8_t)) {
-    throw QuicTransportException(
+    return frameError(
         "Bad connection close triggering frame type value",
-        quic::TransportErrorCode::FRAME_ENCODING_ERROR,
-        quic::FrameType::CONNECTION_CLOSE);
+        FrameType::CONNECTION_CLOSE);
   }
   FrameType triggeringFrameType = static_cast<FrameType>(frameTypeField->first);
-  auto reasonPhraseLength = decodeQuicInteger(cursor);
+  auto reasonPhraseLength = reader.readQuicInteger();
   if (!reasonPhraseLength ||
-      reasonPhraseLength->first > kMaxReasonPhraseLength) {
-    throw QuicTransportException(
-        "Bad reason phrase length",
-        quic::TransportErrorCode::FRAME_ENCODING_ERROR,
-        quic::FrameType::CONNECTION_CLOSE);
+      reasonPhraseLength->first > kMaxReasonPhraseLength ||
+      !reader.canRead(reasonPhraseLength->first)) {
+    return frameError(
+        "Bad reason phrase length", FrameType::CONNECTION_CLOSE);
   }
   auto reasonPhrase =
-      cursor.readFixedString(folly::to<size_t>(reasonPhraseLength->first));
+      reader.readString(folly::to<size_t>(reasonPhraseLength->first));
   return ConnectionCloseFrame(
       QuicErrorCode(errorCode), std::move(reasonPhrase), triggeringFrameType);
 }
 
-ConnectionCloseFrame decodeApplicationClose(folly::io::Cursor& cursor) {
-  ApplicationErrorCode errorCode{};
-  auto varCode = decodeQuicInteger(cursor);
-  if (varCode) {
-    errorCode = static_cast<ApplicationErrorCode>(varCode->first);
-  } else {
-    throw QuicTransportException(
-        "Failed to parse error code.",
-        quic::TransportErrorCode::FRAME_ENCODING_ERROR,
-        quic::FrameType::CONNECTION_CLOSE_APP_ERR);
+template <typename Reader>
+folly::Expected<ConnectionCloseFrame, FrameDecodeError> readApplicationClose(
+    Reader& reader) {
+  auto varCode = reader.readQuicInteger();
+  if (!varCode) {
+    return frameError(
+        "Failed to parse error code.", FrameType::CONNECTION_CLOSE_APP_ERR);
   }
+  auto errorCode = static_cast<ApplicationErrorCode>(varCode->first);
 
-  auto reasonPhraseLength = decodeQuicInteger(cursor);
+  auto reasonPhraseLength = reader.readQuicInteger();
   if (!reasonPhraseLength ||
-      reasonPhraseLength->first > kMaxReasonPhraseLength) {
-    throw QuicTransportException(
-        "Bad reason phrase length",
-        quic::TransportErrorCode::FRAME_ENCODING_ERROR,
-        quic::FrameType::CONNECTION_CLOSE_APP_ERR);
+      reasonPhraseLength->first > kMaxReasonPhraseLength ||
+      !reader.canRead(reasonPhraseLength->first)) {
+    return frameError(
+        "Bad reason phrase length", FrameType::CONNECTION_CLOSE_APP_ERR);
   }
 
   auto reasonPhrase =
-      cursor.readFixedString(folly::to<size_t>(reasonPhraseLength->first));
+      reader.readString(folly::to<size_t>(reasonPhraseLength->first));
   return ConnectionCloseFrame(
       QuicErrorCode(errorCode), std::move(reasonPhrase));
 }
 
-MinStreamDataFrame decodeMinStreamDataFrame(folly::io::Cursor& cursor) {
-  auto streamId = decodeQuicInteger(cursor);
+template <typename Reader>
+folly::Expected<MinStreamDataFrame, FrameDecodeError> readMinStreamDataFrame(
+    Reader& reader) {
+  auto streamId = reader.readQuicInteger();
   if (!streamId) {
-    throw QuicTransportException(
-        "Invalid streamId",
-        quic::TransportErrorCode::FRAME_ENCODING_ERROR,
-        quic::FrameType::MIN_STREAM_DATA);
+    return frameError("Invalid streamId", FrameType::MIN_STREAM_DATA);
   }
-  auto maximumData = decodeQuicInteger(cursor);
+  auto maximumData = reader.readQuicInteger();
   if (!maximumData) {
-    throw QuicTransportException(
-        "Invalid maximumData",
-        quic::TransportErrorCode::FRAME_ENCODING_ERROR,
-        quic::FrameType::MIN_STREAM_DATA);
+    return frameError("Invalid maximumData", FrameType::MIN_STREAM_DATA);
   }
-  auto minimumStreamOffset = decodeQuicInteger(cursor);
+  auto minimumStreamOffset = reader.readQuicInteger();
   if (!minimumStreamOffset) {
-    throw QuicTransportException(
-        "Invalid minimumStreamOffset",
-        quic::TransportErrorCode::FRAME_ENCODING_ERROR,
-        quic::FrameType::MIN_STREAM_DATA);
+    return frameError(
+        "Invalid minimumStreamOffset", FrameType::MIN_STREAM_DATA);
   }
   return MinStreamDataFrame(
       folly::to<StreamId>(streamId->first),
@@ -626,29 +710,467 @@ MinStreamDataFrame decodeMinStreamDataFrame(folly::io::Cursor& cursor) {
       minimumStreamOffset->first);
 }
 
-ExpiredStreamDataFrame decodeExpiredStreamDataFrame(folly::io::Cursor& cursor) {
-  auto streamId = decodeQuicInteger(cursor);
+template <typename Reader>
+folly::Expected<ExpiredStreamDataFrame, FrameDecodeError>
+readExpiredStreamDataFrame(Reader& reader) {
+  auto streamId = reader.readQuicInteger();
   if (!streamId) {
-    throw QuicTransportException(
-        "Invalid streamId",
-        quic::TransportErrorCode::FRAME_ENCODING_ERROR,
-        quic::FrameType::EXPIRED_STREAM_DATA);
+    return frameError("Invalid streamId", FrameType::EXPIRED_STREAM_DATA);
   }
-  auto minimumStreamOffset = decodeQuicInteger(cursor);
+  auto minimumStreamOffset = reader.readQuicInteger();
   if (!minimumStreamOffset) {
-    throw QuicTransportException(
-        "Invalid minimumStreamOffset",
-        quic::TransportErrorCode::FRAME_ENCODING_ERROR,
-        quic::FrameType::EXPIRED_STREAM_DATA);
+    return frameError(
+        "Invalid minimumStreamOffset", FrameType::EXPIRED_STREAM_DATA);
   }
   return ExpiredStreamDataFrame(
       folly::to<StreamId>(streamId->first), minimumStreamOffset->first);
 }
 
+template <typename Reader>
+folly::Expected<AckFrequencyFrame, FrameDecodeError> readAckFrequencyFrame(
+    Reader& reader) {
+  auto sequenceNumber = reader.readQuicInteger();
+  if (!sequenceNumber) {
+    return frameError("Invalid sequence number", FrameType::ACK_FREQUENCY);
+  }
+  auto packetTolerance = reader.readQuicInteger();
+  if (!packetTolerance) {
+    return frameError("Invalid packet tolerance", FrameType::ACK_FREQUENCY);
+  }
+  auto updateMaxAckDelay = reader.readQuicInteger();
+  if (!updateMaxAckDelay) {
+    return frameError(
+        "Invalid update max ack delay", FrameType::ACK_FREQUENCY);
+  }
+  if (!reader.canRead(sizeof(uint8_t))) {
+    return frameError("Invalid ignore order", FrameType::ACK_FREQUENCY);
+  }
+  auto ignoreOrder = reader.template read<uint8_t>();
+  if (ignoreOrder > 1) {
+    return frameError("Invalid ignore order", FrameType::ACK_FREQUENCY);
+  }
+  return AckFrequencyFrame(
+      sequenceNumber->first,
+      packetTolerance->first,
+      updateMaxAckDelay->first,
+      ignoreOrder == 1);
+}
+
+// Frame decoders of the dispatch table, they all take the same arguments.
+template <typename Reader>
+using FrameDecoder = folly::Expected<QuicFrame, FrameDecodeError> (*)(
+    Reader& reader,
+    uint8_t frameType,
+    const PacketHeader& header,
+    const CodecParameters& params);
+
+template <typename Frame>
+folly::Expected<QuicFrame, FrameDecodeError> toQuicFrame(
+    folly::Expected<Frame, FrameDecodeError>&& frame) {
+  if (UNLIKELY(frame.hasError())) {
+    return folly::makeUnexpected(frame.error());
+  }
+  return QuicFrame(std::move(frame.value()));
+}
+
+// Adapts a decoder that only needs the reader to a FrameDecoder.
+template <
+    typename Reader,
+    typename Frame,
+    folly::Expected<Frame, FrameDecodeError> (*decode)(Reader&)>
+folly::Expected<QuicFrame, FrameDecodeError> decodeWith(
+    Reader& reader,
+    uint8_t /* frameType */,
+    const PacketHeader& /* header */,
+    const CodecParameters& /* params */) {
+  return toQuicFrame(decode(reader));
+}
+
+template <typename Reader>
+folly::Expected<QuicFrame, FrameDecodeError> decodePadding(
+    Reader& reader,
+    uint8_t,
+    const PacketHeader&,
+    const CodecParameters&) {
+  return QuicFrame(readPaddingFrame(reader));
+}
+
+template <typename Reader>
+folly::Expected<QuicFrame, FrameDecodeError>
+decodePing(Reader&, uint8_t, const PacketHeader&, const CodecParameters&) {
+  return QuicFrame(PingFrame());
+}
+
+template <typename Reader>
+folly::Expected<QuicFrame, FrameDecodeError> decodeHandshakeDone(
+    Reader&,
+    uint8_t,
+    const PacketHeader&,
+    const CodecParameters&) {
+  return QuicFrame(HandshakeDoneFrame());
+}
+
+template <typename Reader>
+folly::Expected<QuicFrame, FrameDecodeError> decodeAck(
+    Reader& reader,
+    uint8_t,
+    const PacketHeader& header,
+    const CodecParameters& params) {
+  return toQuicFrame(readAckFrame(reader, header, params));
+}
+
+template <typename Reader>
+folly::Expected<QuicFrame, FrameDecodeError> decodeAckWithECN(
+    Reader& reader,
+    uint8_t,
+    const PacketHeader& header,
+    const CodecParameters& params) {
+  return toQuicFrame(readAckFrameWithECN(reader, header, params));
+}
+
+template <typename Reader>
+folly::Expected<QuicFrame, FrameDecodeError> decodeStream(
+    Reader& reader,
+    uint8_t frameType,
+    const PacketHeader&,
+    const CodecParameters&) {
+  return toQuicFrame(readStreamFrame(reader, StreamTypeField(frameType)));
+}
+
+template <typename Reader>
+folly::Expected<QuicFrame, FrameDecodeError> decodeDatagram(
+    Reader& reader,
+    uint8_t frameType,
+    const PacketHeader&,
+    const CodecParameters&) {
+  return toQuicFrame(readDatagramFrame(
+      reader, static_cast<FrameType>(frameType) == FrameType::DATAGRAM_LEN));
+}
+
+// Frame types below 0x40 are encoded in a single byte and index the table.
+constexpr size_t kFrameDecoderTableSize = 0x40;
+
+template <typename Reader>
+using FrameDecoderTable =
+    std::array<FrameDecoder<Reader>, kFrameDecoderTableSize>;
+
+template <typename Reader>
+FrameDecoderTable<Reader> makeFrameDecoderTable() {
+  FrameDecoderTable<Reader> table{};
+  auto set = [&](FrameType frameType, FrameDecoder<Reader> decoder) {
+    table[static_cast<size_t>(frameType)] = decoder;
+  };
+  set(FrameType::PADDING, &decodePadding<Reader>);
+  set(FrameType::PING, &decodePing<Reader>);
+  set(FrameType::ACK, &decodeAck<Reader>);
+  set(FrameType::ACK_ECN, &decodeAckWithECN<Reader>);
+  set(FrameType::RST_STREAM,
+      &decodeWith<Reader, RstStreamFrame, &readRstStreamFrame<Reader>>);
+  set(FrameType::STOP_SENDING,
+      &decodeWith<Reader, StopSendingFrame, &readStopSendingFrame<Reader>>);
+  set(FrameType::CRYPTO_FRAME,
+      &decodeWith<Reader, ReadCryptoFrame, &readCryptoFrame<Reader>>);
+  set(FrameType::NEW_TOKEN,
+      &decodeWith<Reader, ReadNewTokenFrame, &readNewTokenFrame<Reader>>);
+  for (auto frameType = static_cast<size_t>(FrameType::STREAM);
+       frameType <= static_cast<size_t>(FrameType::STREAM_OFF_LEN_FIN);
+       ++frameType) {
+    table[frameType] = &decodeStream<Reader>;
+  }
+  set(FrameType::MAX_DATA,
+      &decodeWith<Reader, MaxDataFrame, &readMaxDataFrame<Reader>>);
+  set(FrameType::MAX_STREAM_DATA,
+      &decodeWith<Reader, MaxStreamDataFrame, &readMaxStreamDataFrame<Reader>>);
+  set(FrameType::MAX_STREAMS_BIDI,
+      &decodeWith<Reader, MaxStreamsFrame, &readBiDiMaxStreamsFrame<Reader>>);
+  set(FrameType::MAX_STREAMS_UNI,
+      &decodeWith<Reader, MaxStreamsFrame, &readUniMaxStreamsFrame<Reader>>);
+  set(FrameType::DATA_BLOCKED,
+      &decodeWith<Reader, DataBlockedFrame, &readDataBlockedFrame<Reader>>);
+  set(FrameType::STREAM_DATA_BLOCKED,
+      &decodeWith<
+          Reader,
+          StreamDataBlockedFrame,
+          &readStreamDataBlockedFrame<Reader>>);
+  set(FrameType::STREAMS_BLOCKED_BIDI,
+      &decodeWith<
+          Reader,
+          StreamsBlockedFrame,
+          &readBiDiStreamsBlockedFrame<Reader>>);
+  set(FrameType::STREAMS_BLOCKED_UNI,
+      &decodeWith<
+          Reader,
+          StreamsBlockedFrame,
+          &readUniStreamsBlockedFrame<Reader>>);
+  set(FrameType::NEW_CONNECTION_ID,
+      &decodeWith<
+          Reader,
+          NewConnectionIdFrame,
+          &readNewConnectionIdFrame<Reader>>);
+  set(FrameType::RETIRE_CONNECTION_ID,
+      &decodeWith<
+          Reader,
+          RetireConnectionIdFrame,
+          &readRetireConnectionIdFrame<Reader>>);
+  set(FrameType::PATH_CHALLENGE,
+      &decodeWith<Reader, PathChallengeFrame, &readPathChallengeFrame<Reader>>);
+  set(FrameType::PATH_RESPONSE,
+      &decodeWith<Reader, PathResponseFrame, &readPathResponseFrame<Reader>>);
+  set(FrameType::CONNECTION_CLOSE,
+      &decodeWith<
+          Reader,
+          ConnectionCloseFrame,
+          &readConnectionCloseFrame<Reader>>);
+  set(FrameType::CONNECTION_CLOSE_APP_ERR,
+      &decodeWith<Reader, ConnectionCloseFrame, &readApplicationClose<Reader>>);
+  set(FrameType::HANDSHAKE_DONE, &decodeHandshakeDone<Reader>);
+  set(FrameType::DATAGRAM, &decodeDatagram<Reader>);
+  set(FrameType::DATAGRAM_LEN, &decodeDatagram<Reader>);
+  return table;
+}
+
+template <typename Reader>
+const FrameDecoderTable<Reader>& frameDecoderTable() {
+  static const FrameDecoderTable<Reader> table =
+      makeFrameDecoderTable<Reader>();
+  return table;
+}
+
+template <typename Reader>
+folly::Expected<QuicFrame, FrameDecodeError> readFrame(
+    Reader& reader,
+    const PacketHeader& header,
+    const CodecParameters& params) {
+  auto frameTypeInt = reader.readQuicInteger();
+  // TODO add an new api to determine whether the frametype is encoded minimally
+  if (!frameTypeInt) {
+    return folly::makeUnexpected(
+        FrameDecodeError{"Invalid frame-type field", folly::none});
+  }
+  FrameType frameType = static_cast<FrameType>(frameTypeInt->first);
+  folly::Expected<QuicFrame, FrameDecodeError> frame =
+      frameError("Unknown frame", frameType);
+  if (frameTypeInt->first < kFrameDecoderTableSize) {
+    auto decoder = frameDecoderTable<Reader>()[frameTypeInt->first];
+    if (UNLIKELY(!decoder)) {
+      return frame;
+    }
+    frame = decoder(
+        reader, static_cast<uint8_t>(frameTypeInt->first), header, params);
+  } else {
+    // The extension frame types past the table.
+    switch (frameType) {
+      case FrameType::MIN_STREAM_DATA:
+        frame = toQuicFrame(readMinStreamDataFrame(reader));
+        break;
+      case FrameType::EXPIRED_STREAM_DATA:
+        frame = toQuicFrame(readExpiredStreamDataFrame(reader));
+        break;
+      case FrameType::ACK_FREQUENCY:
+        frame = toQuicFrame(readAckFrequencyFrame(reader));
+        break;
+      case FrameType::IMMEDIATE_ACK:
+        frame = QuicFrame(ImmediateAckFrame());
+        break;
+      default:
+        return frame;
+    }
+  }
+  if (UNLIKELY(frame.hasError())) {
+    VLOG(4) << "Frame format invalid, type=" << frameTypeInt->first << " "
+            << frame.error().reason;
+    return frameError("Frame format invalid", frameType);
+  }
+  return frame;
+}
+
+// The decode functions of the public API throw like they always did.
+template <typename Frame>
+Frame throwOnError(folly::Expected<Frame, FrameDecodeError>&& frame) {
+  if (frame.hasError()) {
+    DCHECK(frame.error().frameType);
+    throw QuicTransportException(
+        frame.error().reason,
+        TransportErrorCode::FRAME_ENCODING_ERROR,
+        *frame.error().frameType);
+  }
+  return std::move(frame.value());
+}
+
+} // namespace
+
+void throwFrameDecodeError(const FrameDecodeError& error) {
+  if (!error.frameType) {
+    throw QuicTransportException(
+        error.reason, TransportErrorCode::FRAME_ENCODING_ERROR);
+  }
+  throw QuicTransportException(
+      folly::to<std::string>(
+          error.reason,
+          ", type=",
+          static_cast<std::underlying_type<FrameType>::type>(
+              *error.frameType)),
+      TransportErrorCode::FRAME_ENCODING_ERROR,
+      *error.frameType);
+}
+
+PaddingFrame decodePaddingFrame(folly::io::Cursor& cursor) {
+  CursorFrameReader reader(cursor);
+  return readPaddingFrame(reader);
+}
+
+PingFrame decodePingFrame(folly::io::Cursor&) {
+  return PingFrame();
+}
+
+ReadAckFrame decodeAckFrame(
+    folly::io::Cursor& cursor,
+    const PacketHeader& header,
+    const CodecParameters& params) {
+  CursorFrameReader reader(cursor);
+  return throwOnError(readAckFrame(reader, header, params));
+}
+
+ReadAckFrame decodeAckFrameWithECN(
+    folly::io::Cursor& cursor,
+    const PacketHeader& header,
+    const CodecParameters& params) {
+  CursorFrameReader reader(cursor);
+  return throwOnError(readAckFrameWithECN(reader, header, params));
+}
+
+RstStreamFrame decodeRstStreamFrame(folly::io::Cursor& cursor) {
+  CursorFrameReader reader(cursor);
+  return throwOnError(readRstStreamFrame(reader));
+}
+
+StopSendingFrame decodeStopSendingFrame(folly::io::Cursor& cursor) {
+  CursorFrameReader reader(cursor);
+  return throwOnError(readStopSendingFrame(reader));
+}
+
+ReadCryptoFrame decodeCryptoFrame(folly::io::Cursor& cursor) {
+  CursorFrameReader reader(cursor);
+  return throwOnError(readCryptoFrame(reader));
+}
+
+ReadNewTokenFrame decodeNewTokenFrame(folly::io::Cursor& cursor) {
+  CursorFrameReader reader(cursor);
+  return throwOnError(readNewTokenFrame(reader));
+}
+
+ReadStreamFrame decodeStreamFrame(
+    BufQueue& queue,
+    StreamTypeField frameTypeField) {
+  folly::io::Cursor cursor(queue.front());
+  CursorFrameReader reader(cursor);
+  auto frame = throwOnError(readStreamFrame(reader, frameTypeField));
+  queue.trimStart(cursor - queue.front());
+  return frame;
+}
+
+DatagramFrame decodeDatagramFrame(BufQueue& queue, bool hasLen) {
+  folly::io::Cursor cursor(queue.front());
+  CursorFrameReader reader(cursor);
+  auto frame = throwOnError(readDatagramFrame(reader, hasLen));
+  queue.trimStart(cursor - queue.front());
+  return frame;
+}
+
+MaxDataFrame decodeMaxDataFrame(folly::io::Cursor& cursor) {
+  CursorFrameReader reader(cursor);
+  return throwOnError(readMaxDataFrame(reader));
+}
+
+MaxStreamDataFrame decodeMaxStreamDataFrame(folly::io::Cursor& cursor) {
+  CursorFrameReader reader(cursor);
+  return throwOnError(readMaxStreamDataFrame(reader));
+}
+
+MaxStreamsFrame decodeBiDiMaxStreamsFrame(folly::io::Cursor& cursor) {
+  CursorFrameReader reader(cursor);
+  return throwOnError(readBiDiMaxStreamsFrame(reader));
+}
+
+MaxStreamsFrame decodeUniMaxStreamsFrame(folly::io::Cursor& cursor) {
+  CursorFrameReader reader(cursor);
+  return throwOnError(readUniMaxStreamsFrame(reader));
+}
+
+DataBlockedFrame decodeDataBlockedFrame(folly::io::Cursor& cursor) {
+  CursorFrameReader reader(cursor);
+  return throwOnError(readDataBlockedFrame(reader));
+}
+
+StreamDataBlockedFrame decodeStreamDataBlockedFrame(folly::io::Cursor& cursor) {
+  CursorFrameReader reader(cursor);
+  return throwOnError(readStreamDataBlockedFrame(reader));
+}
+
+StreamsBlockedFrame decodeBiDiStreamsBlockedFrame(folly::io::Cursor& cursor) {
+  CursorFrameReader reader(cursor);
+  return throwOnError(readBiDiStreamsBlockedFrame(reader));
+}
+
+StreamsBlockedFrame decodeUniStreamsBlockedFrame(folly::io::Cursor& cursor) {
+  CursorFrameReader reader(cursor);
+  return throwOnError(readUniStreamsBlockedFrame(reader));
+}
+
+NewConnectionIdFrame decodeNewConnectionIdFrame(folly::io::Cursor& cursor) {
+  CursorFrameReader reader(cursor);
+  return throwOnError(readNewConnectionIdFrame(reader));
+}
+
+RetireConnectionIdFrame decodeRetireConnectionIdFrame(
+    folly::io::Cursor& cursor) {
+  CursorFrameReader reader(cursor);
+  return throwOnError(readRetireConnectionIdFrame(reader));
+}
+
+PathChallengeFrame decodePathChallengeFrame(folly::io::Cursor& cursor) {
+  CursorFrameReader reader(cursor);
+  return throwOnError(readPathChallengeFrame(reader));
+}
+
+PathResponseFrame decodePathResponseFrame(folly::io::Cursor& cursor) {
+  CursorFrameReader reader(cursor);
+  return throwOnError(readPathResponseFrame(reader));
+}
+
+ConnectionCloseFrame decodeConnectionCloseFrame(folly::io::Cursor& cursor) {
+  CursorFrameReader reader(cursor);
+  return throwOnError(readConnectionCloseFrame(reader));
+}
+
+ConnectionCloseFrame decodeApplicationClose(folly::io::Cursor& cursor) {
+  CursorFrameReader reader(cursor);
+  return throwOnError(readApplicationClose(reader));
+}
+
+MinStreamDataFrame decodeMinStreamDataFrame(folly::io::Cursor& cursor) {
+  CursorFrameReader reader(cursor);
+  return throwOnError(readMinStreamDataFrame(reader));
+}
+
+ExpiredStreamDataFrame decodeExpiredStreamDataFrame(folly::io::Cursor& cursor) {
+  CursorFrameReader reader(cursor);
+  return throwOnError(readExpiredStreamDataFrame(reader));
+}
+
 HandshakeDoneFrame decodeHandshakeDoneFrame(folly::io::Cursor& /*cursor*/) {
   return HandshakeDoneFrame();
 }
 
+AckFrequencyFrame decodeAckFrequencyFrame(folly::io::Cursor& cursor) {
+  CursorFrameReader reader(cursor);
+  return throwOnError(readAckFrequencyFrame(reader));
+}
+
+ImmediateAckFrame decodeImmediateAckFrame(folly::io::Cursor& /*cursor*/) {
+  return ImmediateAckFrame();
+}
+
 folly::Expected<RetryToken, TransportErrorCode> parsePlaintextRetryToken(
     folly::io::Cursor& cursor) {
   // Read in the length of the odcid.
@@ -694,117 +1216,63 @@ QuicFrame parseFrame(
     const PacketHeader& header,
     const CodecParameters& params) {
   folly::io::Cursor cursor(queue.front());
-  auto frameTypeInt = decodeQuicInteger(cursor);
-  // TODO add an new api to determine whether the frametype is encoded minimally
-  if (!frameTypeInt) {
-    throw QuicTransportException(
-        "Invalid frame-type field", TransportErrorCode::FRAME_ENCODING_ERROR);
+  CursorFrameReader reader(cursor);
+  auto frame = readFrame(reader, header, params);
+  if (frame.hasError()) {
+    throwFrameDecodeError(frame.error());
   }
   queue.trimStart(cursor - queue.front());
-  bool isStream = false;
-  bool error = false;
-  SCOPE_EXIT {
-    if (isStream || error) {
-      return;
-    }
-    queue.trimStart(cursor - queue.front());
-  };
-  cursor.reset(queue.front());
-  FrameType frameType = static_cast<FrameType>(frameTypeInt->first);
-  try {
-    switch (frameType) {
-      case FrameType::PADDING:
-        return QuicFrame(decodePaddingFrame(cursor));
-      case FrameType::PING:
-        return QuicFrame(decodePingFrame(cursor));
-      case FrameType::ACK:
-        return QuicFrame(decodeAckFrame(cursor, header, params));
-      case FrameType::ACK_ECN:
-        return QuicFrame(decodeAckFrameWithECN(cursor, header, params));
-      case FrameType::RST_STREAM:
-        return QuicFrame(decodeRstStreamFrame(cursor));
-      case FrameType::STOP_SENDING:
-        return QuicFrame(decodeStopSendingFrame(cursor));
-      case FrameType::CRYPTO_FRAME:
-        return QuicFrame(decodeCryptoFrame(cursor));
-      case FrameType::NEW_TOKEN:
-        return QuicFrame(decodeNewTokenFrame(cursor));
-      case FrameType::STREAM:
-      case FrameType::STREAM_FIN:
-      case FrameType::STREAM_LEN:
-      case FrameType::STREAM_LEN_FIN:
-      case FrameType::STREAM_OFF:
-      case FrameType::STREAM_OFF_FIN:
-      case FrameType::STREAM_OFF_LEN:
-      case FrameType::STREAM_OFF_LEN_FIN:
-        isStream = true;
-        return QuicFrame(
-            decodeStreamFrame(queue, StreamTypeField(frameTypeInt->first)));
-      case FrameType::MAX_DATA:
-        return QuicFrame(decodeMaxDataFrame(cursor));
-      case FrameType::MAX_STREAM_DATA:
-        return QuicFrame(decodeMaxStreamDataFrame(cursor));
-      case FrameType::MAX_STREAMS_BIDI:
-        return QuicFrame(decodeBiDiMaxStreamsFrame(cursor));
-      case FrameType::MAX_STREAMS_UNI:
-        return QuicFrame(decodeUniMaxStreamsFrame(cursor));
-      case FrameType::DATA_BLOCKED:
-        return QuicFrame(decodeDataBlockedFrame(cursor));
-      case FrameType::STREAM_DATA_BLOCKED:
-        return QuicFrame(decodeStreamDataBlockedFrame(cursor));
-      case FrameType::STREAMS_BLOCKED_BIDI:
-        return QuicFrame(decodeBiDiStreamsBlockedFrame(cursor));
-      case FrameType::STREAMS_BLOCKED_UNI:
-        return QuicFrame(decodeUniStreamsBlockedFrame(cursor));
-      case FrameType::NEW_CONNECTION_ID:
-        return QuicFrame(decodeNewConnectionIdFrame(cursor));
-      case FrameType::RETIRE_CONNECTION_ID:
-        return QuicFrame(decodeRetireConnectionIdFrame(cursor));
-      case FrameType::PATH_CHALLENGE:
-        return QuicFrame(decodePathChallengeFrame(cursor));
-      case FrameType::PATH_RESPONSE:
-        return QuicFrame(decodePathResponseFrame(cursor));
-      case FrameType::CONNECTION_CLOSE:
-        return QuicFrame(decodeConnectionCloseFrame(cursor));
-      case FrameType::CONNECTION_CLOSE_APP_ERR:
-        return QuicFrame(decodeApplicationClose(cursor));
-      case FrameType::MIN_STREAM_DATA:
-        return QuicFrame(decodeMinStreamDataFrame(cursor));
-      case FrameType::EXPIRED_STREAM_DATA:
-        return QuicFrame(decodeExpiredStreamDataFrame(cursor));
-      case FrameType::HANDSHAKE_DONE:
-        return QuicFrame(decodeHandshakeDoneFrame(cursor));
-    }
-  } catch (const std::exception&) {
-    error = true;
-    throw QuicTransportException(
-        folly::to<std::string>(
-            "Frame format invalid, type=", frameTypeInt->first),
-        TransportErrorCode::FRAME_ENCODING_ERROR,
-        frameType);
-  }
-  error = true;
-  throw QuicTransportException(
-      folly::to<std::string>("Unknown frame, type=", frameTypeInt->first),
-      TransportErrorCode::FRAME_ENCODING_ERROR,
-      frameType);
+  return std::move(frame.value());
 }
 
 // Parse packet
 
-RegularQuicPacket decodeRegularPacket(
+folly::Expected<RegularQuicPacket, FrameDecodeError> tryDecodeRegularPacket(
     PacketHeader&& header,
     const CodecParameters& params,
     std::unique_ptr<folly::IOBuf> packetData) {
   RegularQuicPacket packet(std::move(header));
-  BufQueue queue;
-  queue.append(std::move(packetData));
-  while (queue.chainLength() > 0) {
-    packet.frames.push_back(parseFrame(queue, packet.header, params));
+  if (!packetData) {
+    return packet;
+  }
+  auto decodeFrames = [&](auto& reader)
+      -> folly::Expected<folly::Unit, FrameDecodeError> {
+    while (reader.remaining() > 0) {
+      auto frame = readFrame(reader, packet.header, params);
+      if (frame.hasError()) {
+        return folly::makeUnexpected(frame.error());
+      }
+      packet.frames.push_back(std::move(frame.value()));
+    }
+    return folly::unit;
+  };
+  folly::Expected<folly::Unit, FrameDecodeError> decoded;
+  if (!packetData->isChained()) {
+    RangeFrameReader reader(*packetData);
+    decoded = decodeFrames(reader);
+  } else {
+    folly::io::Cursor cursor(packetData.get());
+    CursorFrameReader reader(cursor);
+    decoded = decodeFrames(reader);
+  }
+  if (decoded.hasError()) {
+    return folly::makeUnexpected(decoded.error());
   }
   return packet;
 }
 
+RegularQuicPacket decodeRegularPacket(
+    PacketHeader&& header,
+    const CodecParameters& params,
+    std::unique_ptr<folly::IOBuf> packetData) {
+  auto packet =
+      tryDecodeRegularPacket(std::move(header), params, std::move(packetData));
+  if (packet.hasError()) {
+    throwFrameDecodeError(packet.error());
+  }
+  return std::move(packet.value());
+}
+
 folly::Optional<VersionNegotiationPacket> decodeVersionNegotiation(
     const ParsedLongHeaderInvariant& longHeaderInvariant,
     folly::io::Cursor& cursor) {
@@ -8,6 +8,7 @@
 
 #pragma once
 
+#include <folly/Expected.h>
 #include <folly/io/Cursor.h>
 #include <quic/codec/PacketNumber.h>
 #include <quic/codec/Types.h>
@@ -48,6 +49,32 @@ folly::Optional<VersionNegotiationPacket> decodeVersionNegotiation(
     const ParsedLongHeaderInvariant& longHeaderInvariant,
     folly::io::Cursor& cursor);
 
+/**
+ * Why a frame could not be decoded.
+ */
+struct FrameDecodeError {
+  // Points to a string literal.
+  const char* reason;
+  // Not set when the frame type itself could not be decoded.
+  folly::Optional<FrameType> frameType;
+};
+
+/**
+ * Throws the QuicTransportException decodeRegularPacket() would have thrown
+ * for error.
+ */
+[[noreturn]] void throwFrameDecodeError(const FrameDecodeError& error);
+
+/**
+ * Decodes a single regular QUIC packet like decodeRegularPacket(), but
+ * returns the error instead of throwing it. Frames of a packet in a single
+ * buffer are decoded straight out of its memory.
+ */
+folly::Expected<RegularQuicPacket, FrameDecodeError> tryDecodeRegularPacket(
+    PacketHeader&& header,
+    const CodecParameters& params,
+    std::unique_ptr<folly::IOBuf> packetData);
+
 /**
  * Decodes a single regular QUIC packet from the cursor.
  * PacketData represents data from 1 QUIC packet.
@@ -133,6 +160,16 @@ ReadNewTokenFrame decodeNewTokenFrame(folly::io::Cursor& cursor);
 
 HandshakeDoneFrame decodeHandshakeDoneFrame(folly::io::Cursor& cursor);
 
+AckFrequencyFrame decodeAckFrequencyFrame(folly::io::Cursor& cursor);
+
+ImmediateAckFrame decodeImmediateAckFrame(folly::io::Cursor& cursor);
+
+/**
+ * Splits the datagram off the queue without copying it. Without a length
+ * field the datagram takes the rest of the packet.
+ */
+DatagramFrame decodeDatagramFrame(BufQueue& queue, bool hasLen);
+
 folly::Expected<RetryToken, TransportErrorCode> parsePlaintextRetryToken(
     folly::io::Cursor& cursor);
 
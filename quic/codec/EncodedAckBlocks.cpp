@@ -0,0 +1,88 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ *
+ */
+
+#include <quic/codec/EncodedAckBlocks.h>
+
+#include <glog/logging.h>
+
+namespace quic {
+
+void EncodedAckBlocks::sync(const AckBlocks& ackBlocks) {
+  DCHECK(!ackBlocks.empty());
+  if (isSyncedWith(ackBlocks)) {
+    return;
+  }
+  blocks_.clear();
+  baseOffset_ = 0;
+  for (auto itr = ackBlocks.cbegin(); itr + 1 != ackBlocks.cend(); ++itr) {
+    push(*itr, (itr + 1)->start);
+  }
+  largest_ = ackBlocks.back();
+  version_ = ackBlocks.version();
+}
+
+void EncodedAckBlocks::insert(AckBlocks& ackBlocks, PacketNum packetNum) {
+  if (ackBlocks.empty()) {
+    ackBlocks.insert(packetNum);
+    // Nothing to encode for the only block.
+    sync(ackBlocks);
+    return;
+  }
+  bool synced = isSyncedWith(ackBlocks);
+  ackBlocks.insert(packetNum);
+  if (!synced || isSyncedWith(ackBlocks)) {
+    // Stale already, or packetNum was a duplicate.
+    return;
+  }
+  if (packetNum == largest_->end + 1) {
+    largest_->end = packetNum;
+  } else if (packetNum > largest_->end + 1) {
+    push(*largest_, packetNum);
+    largest_.emplace(packetNum, packetNum);
+  } else {
+    // Filled a hole, leave the rebuild to sync().
+    return;
+  }
+  version_ = ackBlocks.version();
+}
+
+void EncodedAckBlocks::withdrawSmallest(AckBlocks& ackBlocks) {
+  DCHECK(!ackBlocks.empty());
+  bool synced = isSyncedWith(ackBlocks);
+  auto smallest = ackBlocks.front();
+  ackBlocks.withdraw(smallest);
+  if (!synced || blocks_.empty()) {
+    return;
+  }
+  baseOffset_ = blocks_.front().endOffset;
+  blocks_.pop_front();
+  version_ = ackBlocks.version();
+}
+
+uint64_t EncodedAckBlocks::sizeFromTop(size_t numBlocks) const {
+  DCHECK_LE(numBlocks, blocks_.size());
+  if (numBlocks == 0) {
+    return 0;
+  }
+  size_t lowest = blocks_.size() - numBlocks;
+  auto below = lowest == 0 ? baseOffset_ : blocks_[lowest - 1].endOffset;
+  return blocks_.back().endOffset - below;
+}
+
+void EncodedAckBlocks::push(
+    const Interval<PacketNum>& block,
+    PacketNum nextBlockStart) {
+  // This must be true because of the properties of the interval set.
+  CHECK_GE(nextBlockStart, block.end + 2);
+  auto offset = blocks_.empty() ? baseOffset_ : blocks_.back().endOffset;
+  blocks_.emplace_back(block, nextBlockStart);
+  blocks_.back().endOffset =
+      offset + blocks_.back().gap.getSize() + blocks_.back().length.getSize();
+}
+
+} // namespace quic
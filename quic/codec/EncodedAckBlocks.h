@@ -0,0 +1,96 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ *
+ */
+
+#pragma once
+
+#include <quic/codec/QuicInteger.h>
+#include <quic/codec/Types.h>
+#include <quic/common/CircularDeque.h>
+
+#include <folly/Optional.h>
+
+namespace quic {
+
+/**
+ * The gap and length fields of the ack blocks after the largest one, as they
+ * are written in an ACK frame. An AckState keeps one next to its AckBlocks so
+ * that writing an ACK does not walk and encode every block again.
+ *
+ * Packets that arrive in order only extend the largest block or start a new
+ * one on top of it, insert() patches the encoding for them. Any other change
+ * to the AckBlocks makes the encoding stale until the next sync() rebuilds
+ * it.
+ */
+class EncodedAckBlocks {
+ public:
+  struct Block {
+    Block(const Interval<PacketNum>& blockIn, PacketNum nextBlockStart)
+        : block(blockIn),
+          gap(nextBlockStart - blockIn.end - 2),
+          length(blockIn.end - blockIn.start) {}
+
+    Interval<PacketNum> block;
+    QuicInteger gap;
+    QuicInteger length;
+    // Encoded size of this block and the ones below it, see sizeFromTop().
+    uint64_t endOffset{0};
+  };
+
+  /**
+   * Rebuilds the encoding if ackBlocks changed in a way it was not patched
+   * for. ackBlocks must not be empty.
+   */
+  void sync(const AckBlocks& ackBlocks);
+
+  /**
+   * Inserts packetNum into ackBlocks and patches the encoding.
+   */
+  void insert(AckBlocks& ackBlocks, PacketNum packetNum);
+
+  /**
+   * Withdraws the smallest block of ackBlocks and patches the encoding.
+   */
+  void withdrawSmallest(AckBlocks& ackBlocks);
+
+  bool isSyncedWith(const AckBlocks& ackBlocks) const {
+    return version_ && *version_ == ackBlocks.version();
+  }
+
+  /**
+   * Number of blocks after the largest one.
+   */
+  size_t size() const {
+    return blocks_.size();
+  }
+
+  /**
+   * The index-th block after the largest one, counting from the largest.
+   */
+  const Block& fromTop(size_t index) const {
+    return blocks_[blocks_.size() - 1 - index];
+  }
+
+  /**
+   * Encoded size of the numBlocks blocks after the largest one.
+   */
+  uint64_t sizeFromTop(size_t numBlocks) const;
+
+ private:
+  void push(const Interval<PacketNum>& block, PacketNum nextBlockStart);
+
+  // Smallest block first, so that new blocks are appended.
+  CircularDeque<Block> blocks_;
+  // Offset the endOffset of the smallest block starts from.
+  uint64_t baseOffset_{0};
+  // The largest block.
+  folly::Optional<Interval<PacketNum>> largest_;
+  // Version of the AckBlocks the encoding matches.
+  folly::Optional<uint64_t> version_;
+};
+
+} // namespace quic
@@ -13,14 +13,21 @@
 
 namespace quic {
 
-void PacketNumberCipher::decipherHeader(
-    folly::ByteRange sample,
+void PacketNumberCipher::masks(
+    const Sample* samples,
+    HeaderProtectionMask* masksOut,
+    size_t numSamples) const {
+  for (size_t i = 0; i < numSamples; ++i) {
+    masksOut[i] = mask(folly::range(samples[i]));
+  }
+}
+
+void PacketNumberCipher::applyDecipherMask(
+    const HeaderProtectionMask& headerMask,
     folly::MutableByteRange initialByte,
     folly::MutableByteRange packetNumberBytes,
-    uint8_t initialByteMask,
-    uint8_t /* packetNumLengthMask */) const {
+    uint8_t initialByteMask) {
   CHECK_EQ(packetNumberBytes.size(), kMaxPacketNumEncodingSize);
-  HeaderProtectionMask headerMask = mask(sample);
   // Mask size should be > packet number length + 1.
   DCHECK_GE(headerMask.size(), 5);
   initialByte.data()[0] ^= headerMask.data()[0] & initialByteMask;
@@ -30,13 +37,11 @@ void PacketNumberCipher::decipherHeader(
   }
 }
 
-void PacketNumberCipher::cipherHeader(
-    folly::ByteRange sample,
+void PacketNumberCipher::applyCipherMask(
+    const HeaderProtectionMask& headerMask,
     folly::MutableByteRange initialByte,
     folly::MutableByteRange packetNumberBytes,
-    uint8_t initialByteMask,
-    uint8_t /* packetNumLengthMask */) const {
-  HeaderProtectionMask headerMask = mask(sample);
+    uint8_t initialByteMask) {
   // Mask size should be > packet number length + 1.
   DCHECK_GE(headerMask.size(), kMaxPacketNumEncodingSize + 1);
   size_t packetNumLength = parsePacketNumberLength(*initialByte.data());
@@ -46,6 +51,26 @@ void PacketNumberCipher::cipherHeader(
   }
 }
 
+void PacketNumberCipher::decipherHeader(
+    folly::ByteRange sample,
+    folly::MutableByteRange initialByte,
+    folly::MutableByteRange packetNumberBytes,
+    uint8_t initialByteMask,
+    uint8_t /* packetNumLengthMask */) const {
+  applyDecipherMask(
+      mask(sample), initialByte, packetNumberBytes, initialByteMask);
+}
+
+void PacketNumberCipher::cipherHeader(
+    folly::ByteRange sample,
+    folly::MutableByteRange initialByte,
+    folly::MutableByteRange packetNumberBytes,
+    uint8_t initialByteMask,
+    uint8_t /* packetNumLengthMask */) const {
+  applyCipherMask(
+      mask(sample), initialByte, packetNumberBytes, initialByteMask);
+}
+
 void PacketNumberCipher::decryptLongHeader(
     folly::ByteRange sample,
     folly::MutableByteRange initialByte,
@@ -94,4 +119,28 @@ void PacketNumberCipher::encryptShortHeader(
       ShortHeader::kPacketNumLenMask);
 }
 
+void PacketNumberCipher::decryptShortHeaderWithMask(
+    const HeaderProtectionMask& headerMask,
+    folly::MutableByteRange initialByte,
+    folly::MutableByteRange packetNumberBytes) const {
+  applyDecipherMask(
+      headerMask, initialByte, packetNumberBytes, ShortHeader::kTypeBitsMask);
+}
+
+void PacketNumberCipher::encryptLongHeaderWithMask(
+    const HeaderProtectionMask& headerMask,
+    folly::MutableByteRange initialByte,
+    folly::MutableByteRange packetNumberBytes) const {
+  applyCipherMask(
+      headerMask, initialByte, packetNumberBytes, LongHeader::kTypeBitsMask);
+}
+
+void PacketNumberCipher::encryptShortHeaderWithMask(
+    const HeaderProtectionMask& headerMask,
+    folly::MutableByteRange initialByte,
+    folly::MutableByteRange packetNumberBytes) const {
+  applyCipherMask(
+      headerMask, initialByte, packetNumberBytes, ShortHeader::kTypeBitsMask);
+}
+
 } // namespace quic
@@ -24,6 +24,16 @@ class PacketNumberCipher {
 
   virtual HeaderProtectionMask mask(folly::ByteRange sample) const = 0;
 
+  /**
+   * Computes the masks of numSamples samples at once, which lets an
+   * implementation pipeline them. masksOut must have room for numSamples
+   * masks. The default computes them one by one with mask().
+   */
+  virtual void masks(
+      const Sample* samples,
+      HeaderProtectionMask* masksOut,
+      size_t numSamples) const;
+
   /**
    * Decrypts a long header from a sample.
    * sample should be 16 bytes long.
@@ -66,6 +76,30 @@ class PacketNumberCipher {
       folly::MutableByteRange initialByte,
       folly::MutableByteRange packetNumberBytes) const;
 
+  /**
+   * Like decryptShortHeader(), with a mask precomputed by masks().
+   */
+  void decryptShortHeaderWithMask(
+      const HeaderProtectionMask& headerMask,
+      folly::MutableByteRange initialByte,
+      folly::MutableByteRange packetNumberBytes) const;
+
+  /**
+   * Like encryptLongHeader(), with a mask precomputed by masks().
+   */
+  void encryptLongHeaderWithMask(
+      const HeaderProtectionMask& headerMask,
+      folly::MutableByteRange initialByte,
+      folly::MutableByteRange packetNumberBytes) const;
+
+  /**
+   * Like encryptShortHeader(), with a mask precomputed by masks().
+   */
+  void encryptShortHeaderWithMask(
+      const HeaderProtectionMask& headerMask,
+      folly::MutableByteRange initialByte,
+      folly::MutableByteRange packetNumberBytes) const;
+
   /**
    * Returns the length of key needed for the pn cipher.
    */
@@ -85,6 +119,18 @@ class PacketNumberCipher {
       folly::MutableByteRange packetNumberBytes,
       uint8_t initialByteMask,
       uint8_t packetNumLengthMask) const;
+
+  static void applyCipherMask(
+      const HeaderProtectionMask& headerMask,
+      folly::MutableByteRange initialByte,
+      folly::MutableByteRange packetNumberBytes,
+      uint8_t initialByteMask);
+
+  static void applyDecipherMask(
+      const HeaderProtectionMask& headerMask,
+      folly::MutableByteRange initialByte,
+      folly::MutableByteRange packetNumberBytes,
+      uint8_t initialByteMask);
 };
 
 } // namespace quic
@@ -9,6 +9,12 @@
 #include <quic/codec/QuicInteger.h>
 #include <folly/Conv.h>
 
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
 namespace quic {
 
 folly::Expected<size_t, TransportErrorCode> getQuicIntegerSize(uint64_t value) {
@@ -93,6 +99,143 @@ folly::Optional<std::pair<uint64_t, size_t>> decodeQuicInteger(
       numBytes + 1);
 }
 
+folly::Optional<std::pair<uint64_t, size_t>> decodeQuicInteger(
+    folly::ByteRange& range) {
+  if (range.empty()) {
+    return folly::none;
+  }
+  const uint8_t* data = range.data();
+  size_t numBytes = decodeQuicIntegerLength(*data);
+  if (range.size() < numBytes) {
+    VLOG(10) << "Could not decode integer numBytes=" << numBytes
+             << " firstByte=" << std::hex << static_cast<int>(*data);
+    return folly::none;
+  }
+  uint64_t result = 0;
+  switch (numBytes) {
+    case 1:
+      result = *data & 0x3F;
+      break;
+    case 2:
+      result = folly::Endian::big(folly::loadUnaligned<uint16_t>(data)) &
+          0x3FFF;
+      break;
+    case 4:
+      result = folly::Endian::big(folly::loadUnaligned<uint32_t>(data)) &
+          0x3FFFFFFF;
+      break;
+    default:
+      result = folly::Endian::big(folly::loadUnaligned<uint64_t>(data)) &
+          0x3FFFFFFFFFFFFFFF;
+      break;
+  }
+  range.advance(numBytes);
+  return std::make_pair(result, numBytes);
+}
+
+namespace {
+
+#if defined(__AVX2__) || defined(__SSE2__)
+#if defined(__AVX2__)
+constexpr size_t kSimdBlockLen = 32;
+#else
+constexpr size_t kSimdBlockLen = 16;
+#endif
+
+/*
+ * Number of one byte integers at the start of the kSimdBlockLen bytes at data.
+ * A byte is a one byte integer when both bits of its length prefix are zero:
+ * movemask gathers bit 7 of every byte, and bit 6 once shifted into its place.
+ */
+size_t oneByteIntegerRun(const uint8_t* data) {
+#if defined(__AVX2__)
+  auto block = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data));
+  auto mask = static_cast<uint32_t>(_mm256_movemask_epi8(block)) |
+      static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_slli_epi16(block, 1)));
+#else
+  auto block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data));
+  auto mask = static_cast<uint32_t>(_mm_movemask_epi8(block)) |
+      static_cast<uint32_t>(_mm_movemask_epi8(_mm_slli_epi16(block, 1)));
+#endif
+  return mask == 0 ? kSimdBlockLen : folly::findFirstSet(mask) - 1;
+}
+#endif
+
+// Number of leading bytes of the len at data that are whole one byte integers,
+// looking at no more blocks than needed to find limit of them.
+size_t oneByteIntegers(
+    FOLLY_MAYBE_UNUSED const uint8_t* data,
+    FOLLY_MAYBE_UNUSED size_t len,
+    FOLLY_MAYBE_UNUSED size_t limit) {
+#if defined(__AVX2__) || defined(__SSE2__)
+  size_t run = 0;
+  while (run < limit && len - run >= kSimdBlockLen) {
+    auto blockRun = oneByteIntegerRun(data + run);
+    run += blockRun;
+    if (blockRun < kSimdBlockLen) {
+      break;
+    }
+  }
+  return std::min(run, limit);
+#else
+  return 0;
+#endif
+}
+
+} // namespace
+
+size_t
+decodeQuicIntegers(folly::ByteRange& range, uint64_t* values, size_t count) {
+  const uint8_t* data = range.data();
+  const uint8_t* end = range.end();
+  size_t decoded = 0;
+  while (decoded < count) {
+    size_t run = oneByteIntegers(data, end - data, count - decoded);
+    for (size_t i = 0; i < run; ++i) {
+      values[decoded + i] = data[i];
+    }
+    data += run;
+    decoded += run;
+    if (decoded == count || data == end) {
+      break;
+    }
+    size_t len = decodeQuicIntegerLength(*data);
+    if (static_cast<size_t>(end - data) < len) {
+      break;
+    }
+    if (end - data >= static_cast<ptrdiff_t>(sizeof(uint64_t))) {
+      // A single load, the bytes past the integer are shifted out.
+      auto word = folly::Endian::big(folly::loadUnaligned<uint64_t>(data));
+      values[decoded] =
+          (word >> (64 - 8 * len)) & (kEightByteLimit >> (64 - 8 * len));
+    } else {
+      folly::ByteRange tail(data, end);
+      values[decoded] = decodeQuicInteger(tail)->first;
+    }
+    data += len;
+    ++decoded;
+  }
+  range.advance(data - range.data());
+  return decoded;
+}
+
+size_t encodeQuicIntegers(const uint64_t* values, size_t count, uint8_t* out) {
+  uint8_t* begin = out;
+  for (size_t i = 0; i < count; ++i) {
+    uint64_t value = values[i];
+    DCHECK_LE(value, kEightByteLimit);
+    // 0, 1, 2 or 3 for 1, 2, 4 or 8 bytes, which is also the length prefix.
+    uint64_t lenCode = (value > kOneByteLimit) + (value > kTwoByteLimit) +
+        (value > kFourByteLimit);
+    size_t len = size_t(1) << lenCode;
+    uint64_t encoded = value | (lenCode << (8 * len - 2));
+    folly::storeUnaligned<uint64_t>(
+        out, folly::Endian::big(encoded << (64 - 8 * len)));
+    out += len;
+  }
+  return out - begin;
+}
+
 QuicInteger::QuicInteger(uint64_t value) : value_(value) {}
 
 size_t QuicInteger::getSize() const {
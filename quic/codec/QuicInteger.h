@@ -103,6 +103,31 @@ folly::Optional<std::pair<uint64_t, size_t>> decodeQuicInteger(
     folly::io::Cursor& cursor,
     uint64_t atMost = sizeof(uint64_t));
 
+/**
+ * Reads an integer out of the front of the range like the cursor version, and
+ * advances the range past it only in case of success.
+ */
+folly::Optional<std::pair<uint64_t, size_t>> decodeQuicInteger(
+    folly::ByteRange& range);
+
+/**
+ * Reads up to count integers out of the front of the range into values, and
+ * advances the range past the ones read. Returns how many were read, fewer
+ * than count if the range ends or cuts the next integer short. Runs of one
+ * byte integers, the bulk of the gaps and lengths of ACK frames, are picked
+ * out with SIMD where available.
+ */
+size_t
+decodeQuicIntegers(folly::ByteRange& range, uint64_t* values, size_t count);
+
+/**
+ * Encodes count integers back to back into out and returns the number of bytes
+ * written. Every value must fit a QUIC integer, and out must have room for
+ * count * sizeof(uint64_t) bytes since each integer is stored with a single
+ * eight byte write.
+ */
+size_t encodeQuicIntegers(const uint64_t* values, size_t count, uint8_t* out);
+
 /**
  * Returns the length of a quic integer given the first byte
  */
@@ -285,6 +285,50 @@ Buf StatelessResetPacketBuilder::buildPacket() && {
   return std::move(data_);
 }
 
+RetryPacketBuilder::RetryPacketBuilder(
+    const ConnectionId& sourceConnectionId,
+    const ConnectionId& destinationConnectionId,
+    QuicVersion quicVersion,
+    const std::string& retryToken,
+    const ConnectionId& originalDestinationConnectionId,
+    const Aead& integrityAead) {
+  size_t pseudoPrefixLen =
+      sizeof(uint8_t) + originalDestinationConnectionId.size();
+  size_t packetLen = sizeof(uint8_t) + sizeof(QuicVersionType) +
+      sizeof(uint8_t) + destinationConnectionId.size() + sizeof(uint8_t) +
+      sourceConnectionId.size() + retryToken.size() + kRetryIntegrityTagLen;
+  // A single buffer for the pseudo packet and then the packet, the prefix of
+  // the pseudo packet is trimmed once the tag is computed.
+  data_ = folly::IOBuf::create(pseudoPrefixLen + packetLen);
+  BufWriter writer(*data_, pseudoPrefixLen + packetLen);
+  writer.writeBE<uint8_t>(originalDestinationConnectionId.size());
+  writer.push(
+      originalDestinationConnectionId.data(),
+      originalDestinationConnectionId.size());
+  // The low four bits of the first byte are unused.
+  uint8_t initialByte = kHeaderFormMask | LongHeader::kFixedBitMask |
+      (static_cast<uint8_t>(LongHeader::Types::Retry)
+       << LongHeader::kTypeShift);
+  writer.writeBE<uint8_t>(initialByte);
+  writer.writeBE<QuicVersionType>(static_cast<QuicVersionType>(quicVersion));
+  writer.writeBE<uint8_t>(destinationConnectionId.size());
+  writer.push(destinationConnectionId.data(), destinationConnectionId.size());
+  writer.writeBE<uint8_t>(sourceConnectionId.size());
+  writer.push(sourceConnectionId.data(), sourceConnectionId.size());
+  writer.push((const uint8_t*)retryToken.data(), retryToken.size());
+
+  auto integrityTag = integrityAead.inplaceEncrypt(
+      folly::IOBuf::create(integrityAead.getCipherOverhead()), data_.get(), 0);
+  integrityTag->coalesce();
+  CHECK_EQ(integrityTag->length(), kRetryIntegrityTagLen);
+  writer.push(integrityTag->data(), integrityTag->length());
+  data_->trimStart(pseudoPrefixLen);
+}
+
+Buf RetryPacketBuilder::buildPacket() && {
+  return std::move(data_);
+}
+
 VersionNegotiationPacketBuilder::VersionNegotiationPacketBuilder(
     ConnectionId sourceConnectionId,
     ConnectionId destinationConnectionId,
@@ -14,6 +14,7 @@
 #include <quic/codec/Types.h>
 #include <quic/common/BufAccessor.h>
 #include <quic/common/BufUtil.h>
+#include <quic/handshake/Aead.h>
 #include <quic/handshake/HandshakeLayer.h>
 
 namespace quic {
@@ -295,6 +296,27 @@ class StatelessResetPacketBuilder {
   std::unique_ptr<folly::IOBuf> data_;
 };
 
+/**
+ * Builds a Retry packet: the connection ids and the token, followed by the
+ * integrity tag. The tag is computed over the pseudo packet, which is the
+ * packet prefixed with the destination connection id of the client Initial.
+ */
+class RetryPacketBuilder {
+ public:
+  RetryPacketBuilder(
+      const ConnectionId& sourceConnectionId,
+      const ConnectionId& destinationConnectionId,
+      QuicVersion quicVersion,
+      const std::string& retryToken,
+      const ConnectionId& originalDestinationConnectionId,
+      const Aead& integrityAead);
+
+  Buf buildPacket() &&;
+
+ private:
+  std::unique_ptr<folly::IOBuf> data_;
+};
+
 /**
  * A PacketBuilder that wraps in another PacketBuilder that may have a different
  * writableBytes limit. The minimum between the limit will be used to limit the
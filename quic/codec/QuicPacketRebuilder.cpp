@@ -70,6 +70,7 @@ folly::Optional<PacketEvent> PacketRebuilder::rebuildFromPacket(
           ackBlocks.insert(block.start, block.end);
         }
         AckFrameMetaData meta(ackBlocks, ackFrame.ackDelay, ackDelayExponent);
+        meta.ecnCounts = ackFrame.ecnCounts;
         auto ackWriteResult = writeAckFrame(meta, builder_);
         writeSuccess = ackWriteResult.has_value();
         break;
@@ -178,6 +179,11 @@ folly::Optional<PacketEvent> PacketRebuilder::rebuildFromPacket(
         writeSuccess = ret;
         break;
       }
+      case QuicWriteFrame::Type::DatagramFrame_E: {
+        // Datagrams are unreliable, the clone goes without them.
+        writeSuccess = true;
+        break;
+      }
       default: {
         bool ret = writeFrame(QuicWriteFrame(frame), builder_) != 0;
         notPureAck |= ret;
@@ -210,17 +216,17 @@ const BufQueue* PacketRebuilder::cloneCryptoRetransmissionBuffer(
    * lost packet.
    */
   DCHECK(frame.len) << "WriteCryptoFrame cloning: frame is empty. " << conn_;
-  auto iter = stream.retransmissionBuffer.find(frame.offset);
+  auto buffer = stream.retransmissionBuffer.find(frame.offset);
 
   // If the crypto stream is canceled somehow, just skip cloning this frame
-  if (iter == stream.retransmissionBuffer.end()) {
+  if (!buffer) {
     return nullptr;
   }
-  DCHECK(iter->second->offset == frame.offset)
+  DCHECK(buffer->offset == frame.offset)
       << "WriteCryptoFrame cloning: offset mismatch. " << conn_;
-  DCHECK(iter->second->data.chainLength() == frame.len)
+  DCHECK(buffer->data.chainLength() == frame.len)
       << "WriteCryptoFrame cloning: Len mismatch. " << conn_;
-  return &(iter->second->data);
+  return &(buffer->data);
 }
 
 const BufQueue* PacketRebuilder::cloneRetransmissionBuffer(
@@ -240,13 +246,13 @@ const BufQueue* PacketRebuilder::cloneRetransmissionBuffer(
    */
   DCHECK(stream);
   DCHECK(retransmittable(*stream));
-  auto iter = stream->retransmissionBuffer.find(frame.offset);
-  if (iter != stream->retransmissionBuffer.end()) {
-    if (streamFrameMatchesRetransmitBuffer(*stream, frame, *iter->second)) {
-      DCHECK(!frame.len || !iter->second->data.empty())
+  auto buffer = stream->retransmissionBuffer.find(frame.offset);
+  if (buffer) {
+    if (streamFrameMatchesRetransmitBuffer(*stream, frame, *buffer)) {
+      DCHECK(!frame.len || !buffer->data.empty())
           << "WriteStreamFrame cloning: frame is not empty but StreamBuffer has"
           << " empty data. " << conn_;
-      return frame.len ? &(iter->second->data) : nullptr;
+      return frame.len ? &(buffer->data) : nullptr;
     }
   }
   return nullptr;
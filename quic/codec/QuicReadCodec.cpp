@@ -230,8 +230,64 @@ CodecResult QuicReadCodec::parseLongHeaderPacket(
     decrypted = folly::IOBuf::create(0);
   }
 
-  return decodeRegularPacket(
+  auto packet = tryDecodeRegularPacket(
       std::move(longHeader), params_, std::move(decrypted));
+  if (packet.hasError()) {
+    VLOG(4) << "Unable to decode packet: " << packet.error().reason << " "
+            << connIdToHex();
+    return CodecError(std::move(packet.error()));
+  }
+  return std::move(packet.value());
+}
+
+void QuicReadCodec::precomputeShortHeaderMasks(
+    const std::vector<Buf>& packets) {
+  precomputedSamplePtrs_.clear();
+  precomputedSamples_.clear();
+  nextPrecomputedMask_ = 0;
+  const auto& dstConnId = nodeType_ == QuicNodeType::Server
+      ? serverConnectionId_
+      : clientConnectionId_;
+  if (!oneRttHeaderCipher_ || !dstConnId) {
+    return;
+  }
+  // Same layout as in tryParseShortHeaderPacket().
+  size_t sampleOffset = 1 + dstConnId->size() + kMaxPacketNumEncodingSize;
+  for (const auto& packet : packets) {
+    if (!packet || packet->isChained() ||
+        packet->length() < sampleOffset + sizeof(Sample) ||
+        getHeaderForm(*packet->data()) != HeaderForm::Short) {
+      continue;
+    }
+    const uint8_t* sample = packet->data() + sampleOffset;
+    precomputedSamplePtrs_.push_back(sample);
+    precomputedSamples_.emplace_back();
+    memcpy(precomputedSamples_.back().data(), sample, sizeof(Sample));
+  }
+  precomputedMasks_.resize(precomputedSamples_.size());
+  oneRttHeaderCipher_->masks(
+      precomputedSamples_.data(),
+      precomputedMasks_.data(),
+      precomputedSamples_.size());
+}
+
+const HeaderProtectionMask* QuicReadCodec::findPrecomputedMask(
+    const uint8_t* sample) {
+  // Packets are parsed in the order they were precomputed in, minus the ones
+  // that were dropped before reaching here.
+  for (size_t i = nextPrecomputedMask_; i < precomputedSamplePtrs_.size();
+       ++i) {
+    if (precomputedSamplePtrs_[i] != sample) {
+      continue;
+    }
+    nextPrecomputedMask_ = i + 1;
+    // Guards against the buffer having been reused since.
+    if (memcmp(precomputedSamples_[i].data(), sample, sizeof(Sample)) != 0) {
+      return nullptr;
+    }
+    return &precomputedMasks_[i];
+  }
+  return nullptr;
 }
 
 CodecResult QuicReadCodec::tryParseShortHeaderPacket(
@@ -259,8 +315,14 @@ CodecResult QuicReadCodec::tryParseShortHeaderPacket(
   folly::ByteRange sampleByteRange(
       data->writableData() + sampleOffset, sample.size());
 
-  oneRttHeaderCipher_->decryptShortHeader(
-      sampleByteRange, initialByteRange, packetNumberByteRange);
+  auto precomputedMask = findPrecomputedMask(sampleByteRange.data());
+  if (precomputedMask) {
+    oneRttHeaderCipher_->decryptShortHeaderWithMask(
+        *precomputedMask, initialByteRange, packetNumberByteRange);
+  } else {
+    oneRttHeaderCipher_->decryptShortHeader(
+        sampleByteRange, initialByteRange, packetNumberByteRange);
+  }
   std::pair<PacketNum, size_t> packetNum = parsePacketNumber(
       initialByteRange.data()[0], packetNumberByteRange, expectedNextPacketNum);
   auto shortHeader =
@@ -301,8 +363,14 @@ CodecResult QuicReadCodec::tryParseShortHeaderPacket(
     decrypted = folly::IOBuf::create(0);
   }
 
-  return decodeRegularPacket(
+  auto packet = tryDecodeRegularPacket(
       std::move(*shortHeader), params_, std::move(decrypted));
+  if (packet.hasError()) {
+    VLOG(4) << "Unable to decode packet: " << packet.error().reason << " "
+            << connIdToHex();
+    return CodecError(std::move(packet.error()));
+  }
+  return std::move(packet.value());
 }
 
 CodecResult QuicReadCodec::parsePacket(
@@ -414,6 +482,9 @@ void QuicReadCodec::setInitialHeaderCipher(
 void QuicReadCodec::setOneRttHeaderCipher(
     std::unique_ptr<PacketNumberCipher> oneRttHeaderCipher) {
   oneRttHeaderCipher_ = std::move(oneRttHeaderCipher);
+  precomputedSamplePtrs_.clear();
+  precomputedSamples_.clear();
+  nextPrecomputedMask_ = 0;
 }
 
 void QuicReadCodec::setZeroRttHeaderCipher(
@@ -509,6 +580,11 @@ CodecResult::CodecResult(RetryPacket&& retryPacketIn)
   new (&retry) RetryPacket(std::move(retryPacketIn));
 }
 
+CodecResult::CodecResult(CodecError&& codecErrorIn)
+    : type_(CodecResult::Type::CODEC_ERROR) {
+  new (&error) CodecError(std::move(codecErrorIn));
+}
+
 CodecResult::CodecResult(Nothing&&) : type_(CodecResult::Type::NOTHING) {
   new (&none) Nothing();
 }
@@ -527,6 +603,9 @@ void CodecResult::destroyCodecResult() {
     case CodecResult::Type::STATELESS_RESET:
       reset.~StatelessReset();
       break;
+    case CodecResult::Type::CODEC_ERROR:
+      error.~CodecError();
+      break;
     case CodecResult::Type::NOTHING:
       none.~Nothing();
       break;
@@ -551,6 +630,9 @@ CodecResult::CodecResult(CodecResult&& other) noexcept {
     case CodecResult::Type::STATELESS_RESET:
       new (&reset) StatelessReset(std::move(other.reset));
       break;
+    case CodecResult::Type::CODEC_ERROR:
+      new (&error) CodecError(std::move(other.error));
+      break;
     case CodecResult::Type::NOTHING:
       new (&none) Nothing(std::move(other.none));
       break;
@@ -573,6 +655,9 @@ CodecResult& CodecResult::operator=(CodecResult&& other) noexcept {
     case CodecResult::Type::STATELESS_RESET:
       new (&reset) StatelessReset(std::move(other.reset));
       break;
+    case CodecResult::Type::CODEC_ERROR:
+      new (&error) CodecError(std::move(other.error));
+      break;
     case CodecResult::Type::NOTHING:
       new (&none) Nothing(std::move(other.none));
       break;
@@ -613,6 +698,13 @@ RetryPacket* CodecResult::retryPacket() {
   return nullptr;
 }
 
+CodecError* CodecResult::codecError() {
+  if (type_ == CodecResult::Type::CODEC_ERROR) {
+    return &error;
+  }
+  return nullptr;
+}
+
 Nothing* CodecResult::nothing() {
   if (type_ == CodecResult::Type::NOTHING) {
     return &none;
@@ -43,12 +43,23 @@ struct CipherUnavailable {
  */
 struct Nothing {};
 
+/**
+ * A packet that was decrypted but whose frames could not be decoded. The
+ * connection is expected to be closed with the FRAME_ENCODING_ERROR of error.
+ */
+struct CodecError {
+  FrameDecodeError error;
+
+  explicit CodecError(FrameDecodeError errorIn) : error(std::move(errorIn)) {}
+};
+
 struct CodecResult {
   enum class Type {
     REGULAR_PACKET,
     RETRY,
     CIPHER_UNAVAILABLE,
     STATELESS_RESET,
+    CODEC_ERROR,
     NOTHING
   };
 
@@ -61,6 +72,7 @@ struct CodecResult {
   /* implicit */ CodecResult(CipherUnavailable&& cipherUnavailableIn);
   /* implicit */ CodecResult(StatelessReset&& statelessReset);
   /* implicit */ CodecResult(RetryPacket&& retryPacket);
+  /* implicit */ CodecResult(CodecError&& codecError);
   /* implicit */ CodecResult(Nothing&& nothing);
 
   Type type();
@@ -68,6 +80,7 @@ struct CodecResult {
   CipherUnavailable* cipherUnavailable();
   StatelessReset* statelessReset();
   RetryPacket* retryPacket();
+  CodecError* codecError();
   Nothing* nothing();
 
  private:
@@ -78,6 +91,7 @@ struct CodecResult {
     RetryPacket retry;
     CipherUnavailable cipher;
     StatelessReset reset;
+    CodecError error;
     Nothing none;
   };
 
@@ -109,6 +123,14 @@ class QuicReadCodec {
       size_t dstConnIdSize,
       folly::io::Cursor& cursor);
 
+  /**
+   * Computes the header protection masks of the short header packets among
+   * packets with a single PacketNumberCipher::masks() call, before they are
+   * parsed one by one. A packet parsed later uses its precomputed mask when
+   * its sample is unchanged.
+   */
+  void precomputeShortHeaderMasks(const std::vector<Buf>& packets);
+
   /**
    * Tries to parse the packet and returns whether or not
    * it is a version negotiation packet.
@@ -169,6 +191,8 @@ class QuicReadCodec {
 
   std::string connIdToHex();
 
+  const HeaderProtectionMask* findPrecomputedMask(const uint8_t* sample);
+
   QuicNodeType nodeType_;
 
   CodecParameters params_;
@@ -189,6 +213,13 @@ class QuicReadCodec {
 
   folly::Optional<StatelessResetToken> statelessResetToken_;
   folly::Optional<TimePoint> handshakeDoneTime_;
+
+  // Masks of the last precomputeShortHeaderMasks() call, the samples they are
+  // for and where these samples are in the packets.
+  std::vector<const uint8_t*> precomputedSamplePtrs_;
+  std::vector<Sample> precomputedSamples_;
+  std::vector<HeaderProtectionMask> precomputedMasks_;
+  size_t nextPrecomputedMask_{0};
 };
 
 } // namespace quic
@@ -9,6 +9,7 @@
 #include <quic/codec/QuicWriteCodec.h>
 
 #include <algorithm>
+#include <array>
 
 #include <quic/QuicConstants.h>
 #include <quic/QuicException.h>
@@ -197,53 +198,34 @@ folly::Optional<WriteCryptoFrame> writeCryptoFrame(
   return WriteCryptoFrame(offsetIn, lengthVarInt.getValue());
 }
 
+// Ack blocks encoded in one batch by writeAckFrame.
+constexpr size_t kAckBlocksPerWriteBatch = 16;
+
 /*
- * This function will fill the parameter ack frame with ack blocks from the
- * parameter ackBlocks until it runs out of space (bytesLimit). The largest
- * ack block should have been inserted by the caller.
+ * Returns how many of the blocks after the largest one fit in bytesLimit,
+ * along with the growth of the block count field.
  */
-static size_t fillFrameWithAckBlocks(
-    const AckBlocks& ackBlocks,
-    WriteAckFrame& ackFrame,
+static size_t numAckBlocksFitting(
+    const EncodedAckBlocks& encodedAckBlocks,
     uint64_t bytesLimit) {
-  PacketNum currentSeqNum = ackBlocks.crbegin()->start;
-
-  // starts off with 0 which is what we assumed the initial ack block to be for
-  // the largest acked.
-  size_t numAdditionalAckBlocks = 0;
-  size_t previousNumAckBlocks = 0;
-
-  // Skip the largest, as it has already been emplaced.
-  for (auto blockItr = ackBlocks.crbegin() + 1; blockItr != ackBlocks.crend();
-       ++blockItr) {
-    const auto& currBlock = *blockItr;
-    // These must be true because of the properties of the interval set.
-    CHECK_GE(currentSeqNum, currBlock.end + 2);
-    PacketNum gap = currentSeqNum - currBlock.end - 2;
-    PacketNum currBlockLen = currBlock.end - currBlock.start;
-
-    // TODO this is still extra work, as we end up duplicating these
-    // calculations in the caller, we could store the results so they
-    // can be reused by the caller when writing the frame.
-    size_t gapSize = getQuicIntegerSizeThrows(gap);
-    size_t currBlockLenSize = getQuicIntegerSizeThrows(currBlockLen);
-    size_t numAdditionalAckBlocksSize =
-        getQuicIntegerSizeThrows(numAdditionalAckBlocks + 1);
-    size_t previousNumAckBlocksSize =
-        getQuicIntegerSizeThrows(previousNumAckBlocks);
-
-    size_t additionalSize = gapSize + currBlockLenSize +
-        (numAdditionalAckBlocksSize - previousNumAckBlocksSize);
-    if (bytesLimit < additionalSize + 40) {
-      break;
+  auto fits = [&](size_t numBlocks) {
+    // The header already has room for a one byte block count.
+    return encodedAckBlocks.sizeFromTop(numBlocks) +
+        getQuicIntegerSizeThrows(numBlocks) - 1 <=
+        bytesLimit;
+  };
+  // Both sizes only grow with the number of blocks.
+  size_t low = 0;
+  size_t high = encodedAckBlocks.size();
+  while (low < high) {
+    size_t mid = low + (high - low + 1) / 2;
+    if (fits(mid)) {
+      low = mid;
+    } else {
+      high = mid - 1;
     }
-    numAdditionalAckBlocks++;
-    bytesLimit -= additionalSize;
-    previousNumAckBlocks = numAdditionalAckBlocks;
-    currentSeqNum = currBlock.start;
-    ackFrame.ackBlocks.emplace_back(currBlock.start, currBlock.end);
   }
-  return numAdditionalAckBlocks;
+  return low;
 }
 
 folly::Optional<AckFrameWriteResult> writeAckFrame(
@@ -262,9 +244,6 @@ folly::Optional<AckFrameWriteResult> writeAckFrame(
   WriteAckFrame ackFrame;
   uint64_t spaceLeft = builder.remainingSpaceInPkt();
   uint64_t beginningSpace = spaceLeft;
-  // Reserve enough space a full packet of ACKs with 2 byte varints.
-  // TODO is this a good heuristic?
-  ackFrame.ackBlocks.reserve(spaceLeft / 4);
 
   // We could technically split the range if the size of the representation of
   // the integer is too large, but that gets super tricky and is of dubious
@@ -280,18 +259,35 @@ folly::Optional<AckFrameWriteResult> writeAckFrame(
 
   // Required fields are Type, LargestAcked, AckDelay, AckBlockCount,
   // firstAckBlockLength
-  QuicInteger encodedintFrameType(static_cast<uint8_t>(FrameType::ACK));
+  const auto& ecnCounts = ackFrameMetaData.ecnCounts;
+  QuicInteger encodedintFrameType(static_cast<uint8_t>(
+      ecnCounts ? FrameType::ACK_ECN : FrameType::ACK));
   auto headerSize = encodedintFrameType.getSize() +
       largestAckedPacketInt.getSize() + ackDelayInt.getSize() +
       minAdditionalAckBlockCount.getSize() + firstAckBlockLengthInt.getSize();
+  // The ECN counts follow the ack blocks, keep room for them.
+  folly::Optional<QuicInteger> ect0Int, ect1Int, ceInt;
+  if (ecnCounts) {
+    ect0Int.emplace(ecnCounts->ect0);
+    ect1Int.emplace(ecnCounts->ect1);
+    ceInt.emplace(ecnCounts->ce);
+    headerSize += ect0Int->getSize() + ect1Int->getSize() + ceInt->getSize();
+  }
   if (spaceLeft < headerSize) {
     return folly::none;
   }
   spaceLeft -= headerSize;
 
-  ackFrame.ackBlocks.push_back(ackFrameMetaData.ackBlocks.back());
+  // Without the encoding of an AckState, e.g. when rebuilding a packet, the
+  // blocks are encoded just for this frame.
+  folly::Optional<EncodedAckBlocks> frameEncodedAckBlocks;
+  auto encodedAckBlocks = ackFrameMetaData.encodedAckBlocks;
+  if (!encodedAckBlocks) {
+    encodedAckBlocks = &frameEncodedAckBlocks.emplace();
+  }
+  encodedAckBlocks->sync(ackFrameMetaData.ackBlocks);
   auto numAdditionalAckBlocks =
-      fillFrameWithAckBlocks(ackFrameMetaData.ackBlocks, ackFrame, spaceLeft);
+      numAckBlocksFitting(*encodedAckBlocks, spaceLeft);
 
   QuicInteger numAdditionalAckBlocksInt(numAdditionalAckBlocks);
   builder.write(encodedintFrameType);
@@ -300,24 +296,29 @@ folly::Optional<AckFrameWriteResult> writeAckFrame(
   builder.write(numAdditionalAckBlocksInt);
   builder.write(firstAckBlockLengthInt);
 
-  PacketNum currentSeqNum = ackFrameMetaData.ackBlocks.back().start;
-  for (auto it = ackFrame.ackBlocks.cbegin() + 1;
-       it != ackFrame.ackBlocks.cend();
-       ++it) {
-    CHECK_GE(currentSeqNum, it->end + 2);
-    PacketNum gap = currentSeqNum - it->end - 2;
-    PacketNum currBlockLen = it->end - it->start;
-    QuicInteger gapInt(gap);
-    QuicInteger currentBlockLenInt(currBlockLen);
-    builder.write(gapInt);
-    if (builder.remainingSpaceInPkt() <= currentBlockLenInt.getSize()) {
-      LOG(INFO) << "LARGE ACK PACKET " << builder.remainingSpaceInPkt() << " " << currentBlockLenInt.getSize();
-    }
-    builder.write(currentBlockLenInt);
-    if (!builder.remainingSpaceInPkt()) {
-      LOG(INFO) << "LARGE ACK PACKET ";
+  ackFrame.ackBlocks.reserve(1 + numAdditionalAckBlocks);
+  ackFrame.ackBlocks.push_back(ackFrameMetaData.ackBlocks.back());
+  // The gaps and lengths are encoded in batches, each pushed with one write.
+  std::array<uint64_t, 2 * kAckBlocksPerWriteBatch> gapsAndLens;
+  std::array<uint8_t, sizeof(gapsAndLens)> encoded;
+  for (size_t i = 0; i < numAdditionalAckBlocks; i += kAckBlocksPerWriteBatch) {
+    size_t batchLen =
+        std::min(kAckBlocksPerWriteBatch, numAdditionalAckBlocks - i);
+    for (size_t j = 0; j < batchLen; ++j) {
+      const auto& block = encodedAckBlocks->fromTop(i + j);
+      gapsAndLens[2 * j] = block.gap.getValue();
+      gapsAndLens[2 * j + 1] = block.length.getValue();
+      ackFrame.ackBlocks.push_back(block.block);
     }
-    currentSeqNum = it->start;
+    auto encodedLen =
+        encodeQuicIntegers(gapsAndLens.data(), 2 * batchLen, encoded.data());
+    builder.push(encoded.data(), encodedLen);
+  }
+  if (ecnCounts) {
+    builder.write(*ect0Int);
+    builder.write(*ect1Int);
+    builder.write(*ceInt);
+    ackFrame.ecnCounts = ecnCounts;
   }
   ackFrame.ackDelay = ackFrameMetaData.ackDelay;
   builder.appendFrame(std::move(ackFrame));
@@ -496,6 +497,58 @@ size_t writeSimpleFrame(
       // no space left in packet
       return size_t(0);
     }
+    case QuicSimpleFrame::Type::AckFrequencyFrame_E: {
+      const AckFrequencyFrame& ackFrequencyFrame =
+          *frame.asAckFrequencyFrame();
+      QuicInteger intFrameType(static_cast<uint8_t>(FrameType::ACK_FREQUENCY));
+      QuicInteger sequenceNumber(ackFrequencyFrame.sequenceNumber);
+      QuicInteger packetTolerance(ackFrequencyFrame.packetTolerance);
+      QuicInteger updateMaxAckDelay(ackFrequencyFrame.updateMaxAckDelay);
+      auto ackFrequencyFrameSize = intFrameType.getSize() +
+          sequenceNumber.getSize() + packetTolerance.getSize() +
+          updateMaxAckDelay.getSize() + sizeof(uint8_t);
+      if (packetSpaceCheck(spaceLeft, ackFrequencyFrameSize)) {
+        builder.write(intFrameType);
+        builder.write(sequenceNumber);
+        builder.write(packetTolerance);
+        builder.write(updateMaxAckDelay);
+        builder.writeBE(static_cast<uint8_t>(ackFrequencyFrame.ignoreOrder));
+        builder.appendFrame(QuicSimpleFrame(ackFrequencyFrame));
+        return ackFrequencyFrameSize;
+      }
+      // no space left in packet
+      return size_t(0);
+    }
+    case QuicSimpleFrame::Type::ImmediateAckFrame_E: {
+      const ImmediateAckFrame& immediateAckFrame =
+          *frame.asImmediateAckFrame();
+      QuicInteger intFrameType(static_cast<uint8_t>(FrameType::IMMEDIATE_ACK));
+      if (packetSpaceCheck(spaceLeft, intFrameType.getSize())) {
+        builder.write(intFrameType);
+        builder.appendFrame(QuicSimpleFrame(immediateAckFrame));
+        return intFrameType.getSize();
+      }
+      // no space left in packet
+      return size_t(0);
+    }
+    case QuicSimpleFrame::Type::NewTokenFrame_E: {
+      NewTokenFrame& newTokenFrame = *frame.asNewTokenFrame();
+      QuicInteger intFrameType(static_cast<uint8_t>(FrameType::NEW_TOKEN));
+      QuicInteger tokenLength(newTokenFrame.token.size());
+      auto newTokenFrameSize = intFrameType.getSize() +
+          tokenLength.getSize() + newTokenFrame.token.size();
+      if (packetSpaceCheck(spaceLeft, newTokenFrameSize)) {
+        builder.write(intFrameType);
+        builder.write(tokenLength);
+        builder.push(
+            (const uint8_t*)newTokenFrame.token.data(),
+            newTokenFrame.token.size());
+        builder.appendFrame(QuicSimpleFrame(std::move(newTokenFrame)));
+        return newTokenFrameSize;
+      }
+      // no space left in packet
+      return size_t(0);
+    }
   }
   folly::assume_unreachable();
 }
@@ -677,8 +730,25 @@ size_t writeFrame(QuicWriteFrame&& frame, PacketBuilderInterface& builder) {
     case QuicWriteFrame::Type::QuicSimpleFrame_E: {
       return writeSimpleFrame(std::move(*frame.asQuicSimpleFrame()), builder);
     }
+    case QuicWriteFrame::Type::DatagramFrame_E: {
+      DatagramFrame& datagramFrame = *frame.asDatagramFrame();
+      QuicInteger intFrameType(static_cast<uint8_t>(FrameType::DATAGRAM_LEN));
+      QuicInteger length(datagramFrame.length);
+      auto datagramFrameSize =
+          intFrameType.getSize() + length.getSize() + datagramFrame.length;
+      if (packetSpaceCheck(spaceLeft, datagramFrameSize)) {
+        builder.write(intFrameType);
+        builder.write(length);
+        if (datagramFrame.data) {
+          builder.insert(std::move(datagramFrame.data));
+        }
+        builder.appendFrame(DatagramFrame(datagramFrame.length, nullptr));
+        return datagramFrameSize;
+      }
+      // no space left in packet
+      return size_t(0);
+    }
     default: {
-      // TODO add support for: RETIRE_CONNECTION_ID and NEW_TOKEN frames
       auto errorStr = folly::to<std::string>(
           "Unknown / unsupported frame type received at ", __func__);
       VLOG(2) << errorStr;
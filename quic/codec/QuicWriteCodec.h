@@ -8,6 +8,7 @@
 
 #pragma once
 
+#include <quic/codec/EncodedAckBlocks.h>
 #include <quic/codec/QuicPacketBuilder.h>
 #include <quic/codec/Types.h>
 #include <quic/common/IntervalSet.h>
@@ -22,6 +23,10 @@ struct AckFrameMetaData {
   std::chrono::microseconds ackDelay;
   // The ack delay exponent to use.
   uint8_t ackDelayExponent;
+  // Writes an ACK_ECN frame with these counts if set.
+  folly::Optional<EcnCounts> ecnCounts;
+  // Encoding of ackBlocks kept across frames, synced before it is used.
+  EncodedAckBlocks* encodedAckBlocks{nullptr};
 
   AckFrameMetaData(
       const AckBlocks& acksIn,
@@ -425,6 +425,13 @@ std::string toString(FrameType frame) {
       return "EXPIRED_STREAM_DATA";
     case FrameType::HANDSHAKE_DONE:
       return "HANDSHAKE_DONE";
+    case FrameType::DATAGRAM:
+    case FrameType::DATAGRAM_LEN:
+      return "DATAGRAM";
+    case FrameType::IMMEDIATE_ACK:
+      return "IMMEDIATE_ACK";
+    case FrameType::ACK_FREQUENCY:
+      return "ACK_FREQUENCY";
   }
   LOG(WARNING) << "toString has unhandled frame type";
   return "UNKNOWN";
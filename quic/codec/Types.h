@@ -42,9 +42,12 @@ enum class PacketNumberSpace : uint8_t {
 constexpr uint8_t kHeaderFormMask = 0x80;
 constexpr auto kMaxPacketNumEncodingSize = 4;
 constexpr auto kNumInitialAckBlocksPerFrame = 32;
+// Every connection keeps an AckBlocks per packet number space, and packets
+// rarely arrive with more than a few holes.
+constexpr auto kNumInlineAckBlocks = 8;
 
 template <class T>
-using IntervalSetVec = SmallVec<T, kNumInitialAckBlocksPerFrame, uint16_t>;
+using IntervalSetVec = SmallVec<T, kNumInlineAckBlocks, uint16_t>;
 using AckBlocks = IntervalSet<PacketNum, 1, IntervalSetVec>;
 
 struct PaddingFrame {
@@ -93,6 +96,14 @@ struct AckBlock {
  |                    Additional ACK Block (i)                 ...
  +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
  */
+// The ECN counts of an ACK_ECN frame: the number of packets received in a
+// packet number space with each codepoint.
+struct EcnCounts {
+  uint64_t ect0{0};
+  uint64_t ect1{0};
+  uint64_t ce{0};
+};
+
 struct ReadAckFrame {
   PacketNum largestAcked;
   std::chrono::microseconds ackDelay{0us};
@@ -100,6 +111,8 @@ struct ReadAckFrame {
   // These are ordered in descending order by start packet.
   using Vec = SmallVec<AckBlock, kNumInitialAckBlocksPerFrame, uint16_t>;
   Vec ackBlocks;
+  // Set for an ACK_ECN frame.
+  folly::Optional<EcnCounts> ecnCounts;
 
   bool operator==(const ReadAckFrame& /*rhs*/) const {
     // Can't compare ackBlocks, function is just here to appease compiler.
@@ -115,6 +128,8 @@ struct WriteAckFrame {
   AckBlockVec ackBlocks;
   // Delay in sending ack from time that packet was received.
   std::chrono::microseconds ackDelay{0us};
+  // Set for an ACK_ECN frame.
+  folly::Optional<EcnCounts> ecnCounts;
 
   bool operator==(const WriteAckFrame& /*rhs*/) const {
     // Can't compare ackBlocks, function is just here to appease compiler.
@@ -235,6 +250,40 @@ struct ReadNewTokenFrame {
   }
 };
 
+/**
+ * An unreliable datagram (RFC 9221). The data of a written frame is moved into
+ * the packet, the frame kept with the packet only has its length, since lost
+ * datagrams are not retransmitted.
+ */
+struct DatagramFrame {
+  size_t length;
+  Buf data;
+
+  DatagramFrame(size_t lengthIn, Buf dataIn)
+      : length(lengthIn), data(std::move(dataIn)) {}
+
+  // Stuff stored in a variant type needs to be copyable.
+  DatagramFrame(const DatagramFrame& other) : length(other.length) {
+    if (other.data) {
+      data = other.data->clone();
+    }
+  }
+
+  DatagramFrame& operator=(const DatagramFrame& other) {
+    length = other.length;
+    data = other.data ? other.data->clone() : nullptr;
+    return *this;
+  }
+
+  DatagramFrame(DatagramFrame&& other) = default;
+  DatagramFrame& operator=(DatagramFrame&& other) = default;
+
+  bool operator==(const DatagramFrame& other) const {
+    folly::IOBufEqualTo eq;
+    return length == other.length && eq(data, other.data);
+  }
+};
+
 /**
  The structure of the stream frame used for writes.
  0                   1                   2                   3
@@ -548,6 +597,57 @@ struct HandshakeDoneFrame {
   }
 };
 
+/**
+ * Written by the server, the client sends the token in the Initial of its next
+ * connection to skip the Retry. NEW_TOKEN frames are read as
+ * ReadNewTokenFrame.
+ */
+struct NewTokenFrame {
+  std::string token;
+
+  explicit NewTokenFrame(std::string tokenIn) : token(std::move(tokenIn)) {}
+
+  bool operator==(const NewTokenFrame& rhs) const {
+    return token == rhs.token;
+  }
+};
+
+/**
+ * Asks the peer to ack every packetTolerance ack-eliciting packets, and to
+ * delay acks by at most updateMaxAckDelay microseconds. Only the frame with
+ * the largest sequenceNumber counts.
+ */
+struct AckFrequencyFrame {
+  uint64_t sequenceNumber;
+  uint64_t packetTolerance;
+  uint64_t updateMaxAckDelay;
+  // Don't ack out of order packets immediately.
+  bool ignoreOrder;
+
+  AckFrequencyFrame(
+      uint64_t sequenceNumberIn,
+      uint64_t packetToleranceIn,
+      uint64_t updateMaxAckDelayIn,
+      bool ignoreOrderIn)
+      : sequenceNumber(sequenceNumberIn),
+        packetTolerance(packetToleranceIn),
+        updateMaxAckDelay(updateMaxAckDelayIn),
+        ignoreOrder(ignoreOrderIn) {}
+
+  bool operator==(const AckFrequencyFrame& rhs) const {
+    return sequenceNumber == rhs.sequenceNumber &&
+        packetTolerance == rhs.packetTolerance &&
+        updateMaxAckDelay == rhs.updateMaxAckDelay &&
+        ignoreOrder == rhs.ignoreOrder;
+  }
+};
+
+struct ImmediateAckFrame {
+  bool operator==(const ImmediateAckFrame& /*rhs*/) const {
+    return true;
+  }
+};
+
 // Frame to represent ones we skip
 struct NoopFrame {
   bool operator==(const NoopFrame&) const {
@@ -590,7 +690,10 @@ struct RetryToken {
   F(NewConnectionIdFrame, __VA_ARGS__)    \
   F(MaxStreamsFrame, __VA_ARGS__)         \
   F(RetireConnectionIdFrame, __VA_ARGS__) \
-  F(HandshakeDoneFrame, __VA_ARGS__)
+  F(HandshakeDoneFrame, __VA_ARGS__)      \
+  F(AckFrequencyFrame, __VA_ARGS__)       \
+  F(ImmediateAckFrame, __VA_ARGS__)       \
+  F(NewTokenFrame, __VA_ARGS__)
 
 DECLARE_VARIANT_TYPE(QuicSimpleFrame, QUIC_SIMPLE_FRAME)
 
@@ -609,7 +712,8 @@ DECLARE_VARIANT_TYPE(QuicSimpleFrame, QUIC_SIMPLE_FRAME)
   F(ReadNewTokenFrame, __VA_ARGS__)      \
   F(QuicSimpleFrame, __VA_ARGS__)        \
   F(PingFrame, __VA_ARGS__)              \
-  F(NoopFrame, __VA_ARGS__)
+  F(NoopFrame, __VA_ARGS__)              \
+  F(DatagramFrame, __VA_ARGS__)
 
 DECLARE_VARIANT_TYPE(QuicFrame, QUIC_FRAME)
 
@@ -627,7 +731,8 @@ DECLARE_VARIANT_TYPE(QuicFrame, QUIC_FRAME)
   F(WriteCryptoFrame, __VA_ARGS__)       \
   F(QuicSimpleFrame, __VA_ARGS__)        \
   F(PingFrame, __VA_ARGS__)              \
-  F(NoopFrame, __VA_ARGS__)
+  F(NoopFrame, __VA_ARGS__)              \
+  F(DatagramFrame, __VA_ARGS__)
 
 // Types of frames which are written.
 DECLARE_VARIANT_TYPE(QuicWriteFrame, QUIC_WRITE_FRAME)
@@ -0,0 +1,121 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ *
+ */
+
+#include <folly/Benchmark.h>
+#include <folly/init/Init.h>
+
+#include <quic/QuicException.h>
+#include <quic/codec/Decode.h>
+#include <quic/codec/QuicWriteCodec.h>
+#include <quic/common/test/TestUtils.h>
+
+using namespace quic;
+
+namespace {
+
+constexpr size_t kStreamDataLen = 1000;
+// Size of the buffers of a chained packet, like the segments of a GRO read.
+constexpr size_t kChainedSegmentLen = 200;
+
+/*
+ * Frames of a typical packet of a bulk transfer: an ACK with a few blocks and
+ * a STREAM frame with a length.
+ */
+Buf makePacketBody() {
+  auto connId = test::getTestConnectionId();
+  ShortHeader shortHeader(ProtectionType::KeyPhaseZero, connId, 1);
+  RegularQuicPacketBuilder builder(
+      kDefaultUDPSendPacketLen, std::move(shortHeader), 0);
+  builder.encodePacketHeader();
+  AckBlocks ackBlocks;
+  for (PacketNum packetNum = 0; packetNum < 40; packetNum += 10) {
+    ackBlocks.insert(packetNum, packetNum + 5);
+  }
+  AckFrameMetaData meta(ackBlocks, 100us, kDefaultAckDelayExponent);
+  CHECK(writeAckFrame(meta, builder));
+  auto data = folly::IOBuf::copyBuffer(std::string(kStreamDataLen, 'a'));
+  auto dataLen = writeStreamFrameHeader(
+      builder, 0, 0, kStreamDataLen, kStreamDataLen, false, folly::none);
+  CHECK(dataLen && *dataLen == kStreamDataLen);
+  writeStreamFrameData(builder, std::move(data), *dataLen);
+  auto body = std::move(builder).buildPacket().body;
+  body->coalesce();
+  return body;
+}
+
+Buf makeChain(const folly::IOBuf& body) {
+  Buf chain;
+  for (size_t offset = 0; offset < body.length();
+       offset += kChainedSegmentLen) {
+    auto segment = folly::IOBuf::copyBuffer(
+        body.data() + offset,
+        std::min(kChainedSegmentLen, body.length() - offset));
+    if (chain) {
+      chain->prependChain(std::move(segment));
+    } else {
+      chain = std::move(segment);
+    }
+  }
+  return chain;
+}
+
+/*
+ * Decodes iters packets, out of a single buffer or out of a chain. A malformed
+ * packet has its STREAM frame cut short, so it fails after the ACK decoded.
+ */
+void decodePackets(size_t iters, bool chained, bool malformed, bool expected) {
+  folly::BenchmarkSuspender suspender;
+  auto body = makePacketBody();
+  if (malformed) {
+    body->trimEnd(1);
+  }
+  if (chained) {
+    body = makeChain(*body);
+  }
+  auto connId = test::getTestConnectionId();
+  CodecParameters params;
+  for (size_t i = 0; i < iters; ++i) {
+    ShortHeader shortHeader(ProtectionType::KeyPhaseZero, connId, i);
+    auto packetData = body->clone();
+    suspender.dismiss();
+    if (expected) {
+      auto packet = tryDecodeRegularPacket(
+          std::move(shortHeader), params, std::move(packetData));
+      CHECK_EQ(packet.hasError(), malformed);
+      folly::doNotOptimizeAway(packet);
+    } else {
+      try {
+        auto packet = decodeRegularPacket(
+            std::move(shortHeader), params, std::move(packetData));
+        CHECK(!malformed);
+        folly::doNotOptimizeAway(packet);
+      } catch (const QuicTransportException&) {
+        CHECK(malformed);
+      }
+    }
+    suspender.rehire();
+  }
+}
+
+} // namespace
+
+BENCHMARK_NAMED_PARAM(decodePackets, Chained, true, false, false)
+BENCHMARK_RELATIVE_NAMED_PARAM(decodePackets, SingleBuffer, false, false, false)
+BENCHMARK_NAMED_PARAM(decodePackets, MalformedThrown, false, true, false)
+BENCHMARK_RELATIVE_NAMED_PARAM(
+    decodePackets,
+    MalformedExpected,
+    false,
+    true,
+    true)
+
+int main(int argc, char** argv) {
+  folly::init(&argc, &argv);
+  folly::runBenchmarks();
+  return 0;
+}
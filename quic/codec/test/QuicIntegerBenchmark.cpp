@@ -0,0 +1,119 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ *
+ */
+
+#include <folly/Benchmark.h>
+#include <folly/init/Init.h>
+
+#include <quic/codec/QuicInteger.h>
+
+#include <random>
+#include <vector>
+
+using namespace quic;
+
+namespace {
+
+constexpr size_t kNumAckBlocks = 128;
+
+/*
+ * Gaps and lengths of the blocks of an ACK frame under reordering and loss:
+ * mostly one byte, with the odd long block taking two.
+ */
+const std::vector<uint64_t>& ackBlockIntegers() {
+  static const std::vector<uint64_t> values = [] {
+    std::mt19937 rng(0);
+    std::vector<uint64_t> result;
+    for (size_t i = 0; i < kNumAckBlocks; ++i) {
+      result.push_back(rng() % 4);
+      result.push_back(rng() % 16 == 0 ? 64 + rng() % 1000 : rng() % 40);
+    }
+    return result;
+  }();
+  return values;
+}
+
+const std::vector<uint8_t>& encodedAckBlockIntegers() {
+  static const std::vector<uint8_t> encoded = [] {
+    const auto& values = ackBlockIntegers();
+    std::vector<uint8_t> result(values.size() * sizeof(uint64_t));
+    result.resize(
+        encodeQuicIntegers(values.data(), values.size(), result.data()));
+    return result;
+  }();
+  return encoded;
+}
+
+} // namespace
+
+BENCHMARK(DecodeAckBlocksCursor, iters) {
+  folly::BenchmarkSuspender suspender;
+  const auto& encoded = encodedAckBlockIntegers();
+  auto buf = folly::IOBuf::wrapBuffer(encoded.data(), encoded.size());
+  suspender.dismiss();
+  for (size_t i = 0; i < iters; ++i) {
+    folly::io::Cursor cursor(buf.get());
+    uint64_t sum = 0;
+    while (auto value = decodeQuicInteger(cursor)) {
+      sum += value->first;
+    }
+    folly::doNotOptimizeAway(sum);
+  }
+}
+
+BENCHMARK_RELATIVE(DecodeAckBlocksRange, iters) {
+  const auto& encoded = encodedAckBlockIntegers();
+  for (size_t i = 0; i < iters; ++i) {
+    folly::ByteRange range(encoded.data(), encoded.size());
+    uint64_t sum = 0;
+    while (auto value = decodeQuicInteger(range)) {
+      sum += value->first;
+    }
+    folly::doNotOptimizeAway(sum);
+  }
+}
+
+BENCHMARK_RELATIVE(DecodeAckBlocksBatch, iters) {
+  const auto& encoded = encodedAckBlockIntegers();
+  std::vector<uint64_t> values(ackBlockIntegers().size());
+  for (size_t i = 0; i < iters; ++i) {
+    folly::ByteRange range(encoded.data(), encoded.size());
+    auto decoded = decodeQuicIntegers(range, values.data(), values.size());
+    CHECK_EQ(decoded, values.size());
+    folly::doNotOptimizeAway(values.data());
+  }
+}
+
+BENCHMARK_DRAW_LINE();
+
+BENCHMARK(EncodeAckBlocksOneByOne, iters) {
+  const auto& values = ackBlockIntegers();
+  auto buf = folly::IOBuf::create(values.size() * sizeof(uint64_t));
+  for (size_t i = 0; i < iters; ++i) {
+    BufWriter writer(*buf, buf->capacity());
+    for (auto value : values) {
+      encodeQuicInteger(value, [&](auto val) { writer.writeBE(val); });
+    }
+    folly::doNotOptimizeAway(buf->tail());
+    buf->clear();
+  }
+}
+
+BENCHMARK_RELATIVE(EncodeAckBlocksBatch, iters) {
+  const auto& values = ackBlockIntegers();
+  std::vector<uint8_t> encoded(values.size() * sizeof(uint64_t));
+  for (size_t i = 0; i < iters; ++i) {
+    auto len = encodeQuicIntegers(values.data(), values.size(), encoded.data());
+    folly::doNotOptimizeAway(len);
+  }
+}
+
+int main(int argc, char** argv) {
+  folly::init(&argc, &argv);
+  folly::runBenchmarks();
+  return 0;
+}
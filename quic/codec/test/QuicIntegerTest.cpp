@@ -15,6 +15,8 @@
 #include <quic/QuicException.h>
 #include <quic/codec/QuicInteger.h>
 
+#include <vector>
+
 using namespace testing;
 using namespace folly;
 
@@ -72,6 +74,26 @@ TEST_P(QuicIntegerDecodeTest, DecodeAtMost) {
   }
 }
 
+TEST_P(QuicIntegerDecodeTest, DecodeRange) {
+  std::string encodedBytes = folly::unhexlify(GetParam().hexEncoded);
+
+  for (size_t trimmed = 0; trimmed <= encodedBytes.size(); trimmed++) {
+    folly::ByteRange range(
+        reinterpret_cast<const uint8_t*>(encodedBytes.data()),
+        encodedBytes.size() - trimmed);
+    auto originalLength = range.size();
+    auto decodedValue = decodeQuicInteger(range);
+    if (GetParam().error || trimmed != 0) {
+      EXPECT_FALSE(decodedValue.has_value());
+      EXPECT_EQ(range.size(), originalLength);
+    } else {
+      EXPECT_EQ(decodedValue->first, GetParam().decoded);
+      EXPECT_EQ(decodedValue->second, GetParam().encodedLength);
+      EXPECT_EQ(range.size(), originalLength - GetParam().encodedLength);
+    }
+  }
+}
+
 TEST_P(QuicIntegerEncodeTest, Encode) {
   auto queue = folly::IOBuf::create(0);
   BufAppender appender(queue.get(), 10);
@@ -126,6 +148,60 @@ TEST_F(QuicIntegerEncodeTest, ForceWrongBytes) {
   EXPECT_DEATH(encodeQuicInteger(15293, appendOp, 1), "");
 }
 
+TEST(QuicIntegerBatchTest, EncodeDecode) {
+  // Long runs of one byte integers, like the gaps and lengths of ACK blocks,
+  // broken up by larger ones.
+  std::vector<uint64_t> values;
+  for (uint64_t i = 0; i < 200; ++i) {
+    values.push_back(i % 7 == 6 ? i * 1000 : i % 64);
+  }
+  values.push_back(kOneByteLimit);
+  values.push_back(kTwoByteLimit);
+  values.push_back(kFourByteLimit);
+  values.push_back(kEightByteLimit);
+  std::vector<uint8_t> encoded(values.size() * sizeof(uint64_t));
+  auto encodedLen =
+      encodeQuicIntegers(values.data(), values.size(), encoded.data());
+
+  auto buf = IOBuf::create(0);
+  BufAppender appender(buf.get(), 100);
+  for (auto value : values) {
+    encodeQuicInteger(value, [&](auto val) { appender.writeBE(val); });
+  }
+  ASSERT_EQ(encodedLen, buf->computeChainDataLength());
+  EXPECT_EQ(0, memcmp(encoded.data(), buf->coalesce().data(), encodedLen));
+
+  std::vector<uint64_t> decoded(values.size() + 1);
+  ByteRange range(encoded.data(), encodedLen);
+  EXPECT_EQ(
+      decodeQuicIntegers(range, decoded.data(), decoded.size()),
+      values.size());
+  EXPECT_TRUE(range.empty());
+  decoded.pop_back();
+  EXPECT_EQ(decoded, values);
+}
+
+TEST(QuicIntegerBatchTest, DecodeTruncated) {
+  std::vector<uint64_t> values(40, 1);
+  values.push_back(kFourByteLimit);
+  std::vector<uint8_t> encoded(values.size() * sizeof(uint64_t));
+  auto encodedLen =
+      encodeQuicIntegers(values.data(), values.size(), encoded.data());
+  std::vector<uint64_t> decoded(values.size());
+
+  // The integer cut short is left in the range.
+  ByteRange range(encoded.data(), encodedLen - 1);
+  EXPECT_EQ(
+      decodeQuicIntegers(range, decoded.data(), decoded.size()),
+      values.size() - 1);
+  EXPECT_EQ(range.size(), 3);
+
+  // No more than count integers are read.
+  range = ByteRange(encoded.data(), encodedLen);
+  EXPECT_EQ(decodeQuicIntegers(range, decoded.data(), 17), 17);
+  EXPECT_EQ(range.size(), encodedLen - 17);
+}
+
 INSTANTIATE_TEST_CASE_P(
     QuicIntegerTests,
     QuicIntegerDecodeTest,
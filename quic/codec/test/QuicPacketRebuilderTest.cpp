@@ -96,16 +96,9 @@ TEST_F(QuicPacketRebuilderTest, RebuildPacket) {
   writeCryptoFrame(cryptoOffset, cryptoBuf->clone(), regularBuilder1);
   auto packet1 = std::move(regularBuilder1).buildPacket();
   ASSERT_EQ(8, packet1.packet.frames.size());
-  stream->retransmissionBuffer.emplace(
-      std::piecewise_construct,
-      std::forward_as_tuple(0),
-      std::forward_as_tuple(
-          std::make_unique<StreamBuffer>(buf->clone(), 0, true)));
+  stream->retransmissionBuffer.emplace(0, StreamBuffer(buf->clone(), 0, true));
   conn.cryptoState->oneRttStream.retransmissionBuffer.emplace(
-      std::piecewise_construct,
-      std::forward_as_tuple(0),
-      std::forward_as_tuple(
-          std::make_unique<StreamBuffer>(cryptoBuf->clone(), 0, true)));
+      0, StreamBuffer(cryptoBuf->clone(), 0, true));
 
   // rebuild a packet from the built out packet
   ShortHeader shortHeader2(
@@ -246,10 +239,7 @@ TEST_F(QuicPacketRebuilderTest, FinOnlyStreamRebuild) {
   writeStreamFrameHeader(
       regularBuilder1, streamId, 0, 0, 0, true, folly::none /* skipLenHint */);
   auto packet1 = std::move(regularBuilder1).buildPacket();
-  stream->retransmissionBuffer.emplace(
-      std::piecewise_construct,
-      std::forward_as_tuple(0),
-      std::forward_as_tuple(std::make_unique<StreamBuffer>(nullptr, 0, true)));
+  stream->retransmissionBuffer.emplace(0, StreamBuffer(nullptr, 0, true));
 
   // rebuild a packet from the built out packet
   ShortHeader shortHeader2(
@@ -304,11 +294,7 @@ TEST_F(QuicPacketRebuilderTest, RebuildDataStreamAndEmptyCryptoStream) {
   writeCryptoFrame(cryptoOffset, cryptoBuf->clone(), regularBuilder1);
   auto packet1 = std::move(regularBuilder1).buildPacket();
   ASSERT_EQ(2, packet1.packet.frames.size());
-  stream->retransmissionBuffer.emplace(
-      std::piecewise_construct,
-      std::forward_as_tuple(0),
-      std::forward_as_tuple(
-          std::make_unique<StreamBuffer>(buf->clone(), 0, true)));
+  stream->retransmissionBuffer.emplace(0, StreamBuffer(buf->clone(), 0, true));
   // Do not add the buf to crypto stream's retransmission buffer,
   // imagine it was cleared
 
@@ -406,11 +392,7 @@ TEST_F(QuicPacketRebuilderTest, CannotRebuild) {
       regularBuilder1, buf->clone(), buf->computeChainDataLength());
   auto packet1 = std::move(regularBuilder1).buildPacket();
   ASSERT_EQ(5, packet1.packet.frames.size());
-  stream->retransmissionBuffer.emplace(
-      std::piecewise_construct,
-      std::forward_as_tuple(0),
-      std::forward_as_tuple(
-          std::make_unique<StreamBuffer>(buf->clone(), 0, true)));
+  stream->retransmissionBuffer.emplace(0, StreamBuffer(buf->clone(), 0, true));
 
   // new builder has a much smaller writable bytes limit
   ShortHeader shortHeader2(
@@ -509,15 +491,10 @@ TEST_F(QuicPacketRebuilderTest, LastStreamFrameSkipLen) {
   auto packet = std::move(regularBuilder).buildPacket();
   auto outstandingPacket = makeDummyOutstandingPacket(packet.packet, 1200);
   stream->retransmissionBuffer.emplace(
-      std::piecewise_construct,
-      std::forward_as_tuple(0),
-      std::forward_as_tuple(
-          std::make_unique<StreamBuffer>(buf1->clone(), 0, false)));
+      0, StreamBuffer(buf1->clone(), 0, false));
   stream->retransmissionBuffer.emplace(
-      std::piecewise_construct,
-      std::forward_as_tuple(buf1->computeChainDataLength()),
-      std::forward_as_tuple(std::make_unique<StreamBuffer>(
-          buf2->clone(), buf1->computeChainDataLength(), true)));
+      buf1->computeChainDataLength(),
+      StreamBuffer(buf2->clone(), buf1->computeChainDataLength(), true));
 
   MockQuicPacketBuilder mockBuilder;
   size_t packetLimit = 1200;
@@ -581,15 +558,10 @@ TEST_F(QuicPacketRebuilderTest, LastStreamFrameFinOnlyNotSkipLen) {
   auto packet = std::move(regularBuilder).buildPacket();
   auto outstandingPacket = makeDummyOutstandingPacket(packet.packet, 1200);
   stream->retransmissionBuffer.emplace(
-      std::piecewise_construct,
-      std::forward_as_tuple(0),
-      std::forward_as_tuple(
-          std::make_unique<StreamBuffer>(buf1->clone(), 0, false)));
+      0, StreamBuffer(buf1->clone(), 0, false));
   stream->retransmissionBuffer.emplace(
-      std::piecewise_construct,
-      std::forward_as_tuple(buf1->computeChainDataLength()),
-      std::forward_as_tuple(std::make_unique<StreamBuffer>(
-          nullptr, buf1->computeChainDataLength(), true)));
+      buf1->computeChainDataLength(),
+      StreamBuffer(nullptr, buf1->computeChainDataLength(), true));
 
   MockQuicPacketBuilder mockBuilder;
   size_t packetLimit = 1200;
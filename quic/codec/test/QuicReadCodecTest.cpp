@@ -219,6 +219,55 @@ TEST_F(QuicReadCodecTest, StreamWithShortHeader) {
   EXPECT_TRUE(parseSuccess(std::move(packet)));
 }
 
+TEST_F(QuicReadCodecTest, ShortHeadersWithPrecomputedMasks) {
+  auto connId = getTestConnectionId();
+  FizzCryptoFactory cryptoFactory;
+  auto aead = cryptoFactory.getClientInitialCipher(connId, QuicVersion::MVFST);
+  auto headerCipher =
+      cryptoFactory.makeClientInitialHeaderCipher(connId, QuicVersion::MVFST);
+  auto codec = makeEncryptedCodec(
+      connId,
+      cryptoFactory.getClientInitialCipher(connId, QuicVersion::MVFST));
+  codec->setServerConnectionId(connId);
+  codec->setOneRttHeaderCipher(
+      cryptoFactory.makeClientInitialHeaderCipher(connId, QuicVersion::MVFST));
+
+  constexpr PacketNum kFirstPacketNum = 100;
+  constexpr size_t kNumPackets = 5;
+  auto data = folly::IOBuf::copyBuffer(std::string(100, 'a'));
+  std::vector<Buf> packets;
+  for (PacketNum packetNum = kFirstPacketNum;
+       packetNum < kFirstPacketNum + kNumPackets;
+       ++packetNum) {
+    auto packet = createStreamPacket(
+        connId,
+        connId,
+        packetNum,
+        2 /* streamId */,
+        *data,
+        aead->getCipherOverhead(),
+        0 /* largestAcked */);
+    auto buf = packetToBufCleartext(packet, *aead, *headerCipher, packetNum);
+    buf->coalesce();
+    packets.push_back(std::move(buf));
+  }
+  codec->precomputeShortHeaderMasks(packets);
+
+  AckStates ackStates;
+  for (size_t i = 0; i < kNumPackets; ++i) {
+    if (i == 1) {
+      // Dropped before it reaches the codec.
+      continue;
+    }
+    auto packetQueue = bufToQueue(std::move(packets[i]));
+    auto result = codec->parsePacket(packetQueue, ackStates);
+    auto regularPacket = result.regularPacket();
+    ASSERT_NE(regularPacket, nullptr);
+    EXPECT_EQ(
+        regularPacket->header.getPacketSequenceNum(), kFirstPacketNum + i);
+  }
+}
+
 TEST_F(QuicReadCodecTest, StreamWithShortHeaderOnlyHeader) {
   auto connId = getTestConnectionId();
   PacketNum packetNum = 12321;
@@ -239,6 +288,43 @@ TEST_F(QuicReadCodecTest, StreamWithShortHeaderOnlyHeader) {
   EXPECT_FALSE(parseSuccess(std::move(packet)));
 }
 
+TEST_F(QuicReadCodecTest, MalformedFrameIsCodecError) {
+  auto connId = getTestConnectionId();
+  PacketNum packetNum = 12321;
+  StreamId streamId = 2;
+
+  auto data = folly::IOBuf::create(30);
+  data->append(30);
+  auto streamPacket = createStreamPacket(
+      connId,
+      connId,
+      packetNum,
+      streamId,
+      *data,
+      0 /* cipherOverhead */,
+      0 /* largestAcked */);
+  auto aead = std::make_unique<MockAead>();
+  // A STREAM frame type with nothing after it.
+  EXPECT_CALL(*aead, _tryDecrypt(_, _, _))
+      .WillOnce(Invoke([](auto&, const auto, auto) {
+        const uint8_t truncatedStreamFrame = 0x08;
+        return folly::IOBuf::copyBuffer(&truncatedStreamFrame, 1);
+      }));
+  AckStates ackStates;
+  auto packetQueue = bufToQueue(packetToBuf(streamPacket));
+  auto codec = makeEncryptedCodec(connId, std::move(aead));
+  folly::Optional<CodecResult> packet;
+  EXPECT_NO_THROW(packet.emplace(codec->parsePacket(packetQueue, ackStates)));
+  ASSERT_TRUE(packet.hasValue());
+  EXPECT_EQ(packet->type(), CodecResult::Type::CODEC_ERROR);
+  auto codecError = packet->codecError();
+  ASSERT_NE(codecError, nullptr);
+  ASSERT_TRUE(codecError->error.frameType.hasValue());
+  EXPECT_EQ(*codecError->error.frameType, FrameType::STREAM);
+  EXPECT_THROW(
+      throwFrameDecodeError(codecError->error), QuicTransportException);
+}
+
 TEST_F(QuicReadCodecTest, PacketDecryptFail) {
   auto connId = getTestConnectionId();
   PacketNum packetNum = 12321;
@@ -0,0 +1,67 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ *
+ */
+
+#include <folly/Benchmark.h>
+#include <folly/init/Init.h>
+
+#include <quic/codec/QuicWriteCodec.h>
+#include <quic/common/test/TestUtils.h>
+
+using namespace quic;
+
+namespace {
+
+/*
+ * Acks every other packet, so the ACK frame carries numBlocks blocks, more
+ * than a packet fits for the larger sizes. Every iteration another packet
+ * arrives in order on top of the blocks, the smallest block is forgotten and
+ * an ACK is written, with the encoding kept across frames or not.
+ */
+void writeAckFrames(size_t iters, size_t numBlocks, bool keepEncoding) {
+  folly::BenchmarkSuspender suspender;
+  AckBlocks ackBlocks;
+  EncodedAckBlocks encodedAckBlocks;
+  PacketNum nextPacketNum = 0;
+  for (size_t i = 0; i < numBlocks; ++i) {
+    encodedAckBlocks.insert(ackBlocks, nextPacketNum);
+    nextPacketNum += 2;
+  }
+  auto connId = test::getTestConnectionId();
+  for (size_t i = 0; i < iters; ++i) {
+    ShortHeader shortHeader(ProtectionType::KeyPhaseZero, connId, i);
+    RegularQuicPacketBuilder builder(
+        kDefaultUDPSendPacketLen, std::move(shortHeader), 0);
+    builder.encodePacketHeader();
+    suspender.dismiss();
+    encodedAckBlocks.insert(ackBlocks, nextPacketNum);
+    encodedAckBlocks.withdrawSmallest(ackBlocks);
+    nextPacketNum += 2;
+    AckFrameMetaData meta(ackBlocks, 0us, kDefaultAckDelayExponent);
+    if (keepEncoding) {
+      meta.encodedAckBlocks = &encodedAckBlocks;
+    }
+    auto result = writeAckFrame(meta, builder);
+    folly::doNotOptimizeAway(result);
+    suspender.rehire();
+  }
+}
+
+} // namespace
+
+BENCHMARK_NAMED_PARAM(writeAckFrames, 16BlocksRebuilt, 16, false)
+BENCHMARK_RELATIVE_NAMED_PARAM(writeAckFrames, 16BlocksKept, 16, true)
+BENCHMARK_NAMED_PARAM(writeAckFrames, 256BlocksRebuilt, 256, false)
+BENCHMARK_RELATIVE_NAMED_PARAM(writeAckFrames, 256BlocksKept, 256, true)
+BENCHMARK_NAMED_PARAM(writeAckFrames, 2048BlocksRebuilt, 2048, false)
+BENCHMARK_RELATIVE_NAMED_PARAM(writeAckFrames, 2048BlocksKept, 2048, true)
+
+int main(int argc, char** argv) {
+  folly::init(&argc, &argv);
+  folly::runBenchmarks();
+  return 0;
+}
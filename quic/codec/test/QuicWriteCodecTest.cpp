@@ -822,6 +822,43 @@ TEST_F(QuicWriteCodecTest, WriteSimpleAckFrame) {
   EXPECT_EQ(decodedAckFrame.ackBlocks[1].endPacket, 400);
 }
 
+TEST_F(QuicWriteCodecTest, WriteAckEcnFrame) {
+  MockQuicPacketBuilder pktBuilder;
+  setupCommonExpects(pktBuilder);
+  auto ackDelay = 111us;
+  AckBlocks ackBlocks = {{501, 1000}, {101, 400}};
+  AckFrameMetaData meta(ackBlocks, ackDelay, kDefaultAckDelayExponent);
+  EcnCounts ecnCounts;
+  ecnCounts.ect0 = 1000;
+  ecnCounts.ect1 = 0;
+  ecnCounts.ce = 5;
+  meta.ecnCounts = ecnCounts;
+
+  // The 11 bytes of the simple ack frame, plus 2 bytes for ECT(0), 1 byte for
+  // ECT(1) and 1 byte for CE => 15 bytes
+  auto result = *writeAckFrame(meta, pktBuilder);
+
+  EXPECT_EQ(15, result.bytesWritten);
+  EXPECT_EQ(kDefaultUDPSendPacketLen - 15, pktBuilder.remainingSpaceInPkt());
+  auto builtOut = std::move(pktBuilder).buildTestPacket();
+  auto regularPacket = builtOut.first;
+  WriteAckFrame& ackFrame = *regularPacket.frames.back().asWriteAckFrame();
+  ASSERT_TRUE(ackFrame.ecnCounts.has_value());
+  EXPECT_EQ(ackFrame.ecnCounts->ce, 5);
+
+  auto wireBuf = std::move(builtOut.second);
+  BufQueue queue;
+  queue.append(wireBuf->clone());
+  QuicFrame decodedFrame = parseQuicFrame(queue);
+  auto& decodedAckFrame = *decodedFrame.asReadAckFrame();
+  EXPECT_EQ(decodedAckFrame.largestAcked, 1000);
+  EXPECT_EQ(decodedAckFrame.ackBlocks.size(), 2);
+  ASSERT_TRUE(decodedAckFrame.ecnCounts.has_value());
+  EXPECT_EQ(decodedAckFrame.ecnCounts->ect0, 1000);
+  EXPECT_EQ(decodedAckFrame.ecnCounts->ect1, 0);
+  EXPECT_EQ(decodedAckFrame.ecnCounts->ce, 5);
+}
+
 TEST_F(QuicWriteCodecTest, WriteAckFrameWillSaveAckDelay) {
   MockQuicPacketBuilder pktBuilder;
   setupCommonExpects(pktBuilder);
@@ -1063,6 +1100,83 @@ TEST_F(QuicWriteCodecTest, OnlyHasSpaceForFirstAckBlock) {
   EXPECT_EQ(decodedAckFrame.ackBlocks[0].endPacket, 1000);
 }
 
+TEST_F(QuicWriteCodecTest, WriteAckFrameWithEncodedAckBlocks) {
+  AckBlocks ackBlocks;
+  EncodedAckBlocks encodedAckBlocks;
+  auto writeAndDecode = [&]() {
+    MockQuicPacketBuilder pktBuilder;
+    setupCommonExpects(pktBuilder);
+    AckFrameMetaData meta(ackBlocks, 0us, kDefaultAckDelayExponent);
+    meta.encodedAckBlocks = &encodedAckBlocks;
+    auto result = writeAckFrame(meta, pktBuilder);
+    EXPECT_TRUE(result.has_value());
+    EXPECT_EQ(result->ackBlocksWritten, ackBlocks.size());
+    auto builtOut = std::move(pktBuilder).buildTestPacket();
+    BufQueue queue;
+    queue.append(builtOut.second->clone());
+    auto decodedFrame = parseQuicFrame(queue);
+    return *decodedFrame.asReadAckFrame();
+  };
+  auto expectAcked = [&](const ReadAckFrame& ackFrame) {
+    ASSERT_EQ(ackFrame.ackBlocks.size(), ackBlocks.size());
+    auto block = ackBlocks.crbegin();
+    for (const auto& decodedBlock : ackFrame.ackBlocks) {
+      EXPECT_EQ(decodedBlock.startPacket, block->start);
+      EXPECT_EQ(decodedBlock.endPacket, block->end);
+      ++block;
+    }
+  };
+
+  for (PacketNum packetNum : {1, 2, 3, 5, 9, 10, 200}) {
+    encodedAckBlocks.insert(ackBlocks, packetNum);
+  }
+  expectAcked(writeAndDecode());
+  EXPECT_TRUE(encodedAckBlocks.isSyncedWith(ackBlocks));
+
+  // In order packets are patched in.
+  encodedAckBlocks.insert(ackBlocks, 201);
+  encodedAckBlocks.insert(ackBlocks, 300);
+  EXPECT_TRUE(encodedAckBlocks.isSyncedWith(ackBlocks));
+  EXPECT_EQ(encodedAckBlocks.size(), 4);
+  expectAcked(writeAndDecode());
+
+  // So is the removal of the smallest block.
+  encodedAckBlocks.withdrawSmallest(ackBlocks);
+  EXPECT_TRUE(encodedAckBlocks.isSyncedWith(ackBlocks));
+  EXPECT_EQ(encodedAckBlocks.size(), 3);
+  expectAcked(writeAndDecode());
+
+  // Filling a hole needs a rebuild.
+  encodedAckBlocks.insert(ackBlocks, 4);
+  EXPECT_FALSE(encodedAckBlocks.isSyncedWith(ackBlocks));
+  expectAcked(writeAndDecode());
+  EXPECT_TRUE(encodedAckBlocks.isSyncedWith(ackBlocks));
+
+  // Like any change behind its back.
+  ackBlocks.withdraw({9, 9});
+  EXPECT_FALSE(encodedAckBlocks.isSyncedWith(ackBlocks));
+  expectAcked(writeAndDecode());
+}
+
+TEST_F(QuicWriteCodecTest, EncodedAckBlocksSizeFromTop) {
+  AckBlocks ackBlocks;
+  EncodedAckBlocks encodedAckBlocks;
+  for (PacketNum packetNum : {0, 100, 102, 10000}) {
+    encodedAckBlocks.insert(ackBlocks, packetNum);
+  }
+  encodedAckBlocks.sync(ackBlocks);
+  ASSERT_EQ(encodedAckBlocks.size(), 3);
+  // Gap 9896 and length 0.
+  EXPECT_EQ(encodedAckBlocks.sizeFromTop(1), 3);
+  // Gap 0 and length 0.
+  EXPECT_EQ(encodedAckBlocks.sizeFromTop(2), 5);
+  // Gap 98 and length 0.
+  EXPECT_EQ(encodedAckBlocks.sizeFromTop(3), 8);
+  encodedAckBlocks.withdrawSmallest(ackBlocks);
+  EXPECT_EQ(encodedAckBlocks.sizeFromTop(2), 5);
+  EXPECT_EQ(encodedAckBlocks.fromTop(1).block.start, 100);
+}
+
 TEST_F(QuicWriteCodecTest, WriteMaxStreamData) {
   MockQuicPacketBuilder pktBuilder;
   setupCommonExpects(pktBuilder);
@@ -1689,5 +1803,66 @@ TEST_F(QuicWriteCodecTest, WritePathResponse) {
   EXPECT_EQ(wirePathResponseFrame.pathData, pathData);
   EXPECT_EQ(queue.chainLength(), 0);
 }
+
+TEST_F(QuicWriteCodecTest, WriteAckFrequency) {
+  MockQuicPacketBuilder pktBuilder;
+  setupCommonExpects(pktBuilder);
+
+  AckFrequencyFrame ackFrequency(1, 64, 10000, true);
+  auto bytesWritten = writeSimpleFrame(ackFrequency, pktBuilder);
+  // 2 bytes for the type, 1 byte for the sequence number, 2 bytes for the
+  // packet tolerance, 2 bytes for the max ack delay, 1 byte for ignore order.
+  EXPECT_EQ(bytesWritten, 8);
+
+  auto builtOut = std::move(pktBuilder).buildTestPacket();
+  auto regularPacket = builtOut.first;
+  AckFrequencyFrame result =
+      *regularPacket.frames[0].asQuicSimpleFrame()->asAckFrequencyFrame();
+  EXPECT_EQ(result, ackFrequency);
+
+  auto wireBuf = std::move(builtOut.second);
+  BufQueue queue;
+  queue.append(wireBuf->clone());
+  QuicFrame decodedFrame = parseQuicFrame(queue);
+  QuicSimpleFrame& simpleFrame = *decodedFrame.asQuicSimpleFrame();
+  EXPECT_EQ(*simpleFrame.asAckFrequencyFrame(), ackFrequency);
+  EXPECT_EQ(queue.chainLength(), 0);
+}
+
+TEST_F(QuicWriteCodecTest, WriteDatagramFrame) {
+  MockQuicPacketBuilder pktBuilder;
+  setupCommonExpects(pktBuilder);
+
+  auto inputBuf = buildRandomInputData(10);
+  auto bytesWritten =
+      writeFrame(DatagramFrame(10, inputBuf->clone()), pktBuilder);
+  // 1 byte for the type, 1 byte for the length and 10 bytes of data.
+  EXPECT_EQ(bytesWritten, 12);
+
+  auto builtOut = std::move(pktBuilder).buildTestPacket();
+  auto regularPacket = builtOut.first;
+  DatagramFrame& datagramFrame = *regularPacket.frames[0].asDatagramFrame();
+  EXPECT_EQ(datagramFrame.length, 10);
+  // The outstanding packet does not hold on to the data.
+  EXPECT_EQ(datagramFrame.data, nullptr);
+
+  auto wireBuf = std::move(builtOut.second);
+  BufQueue queue;
+  queue.append(wireBuf->clone());
+  QuicFrame decodedFrame = parseQuicFrame(queue);
+  DatagramFrame& wireDatagramFrame = *decodedFrame.asDatagramFrame();
+  EXPECT_EQ(wireDatagramFrame.length, 10);
+  EXPECT_TRUE(folly::IOBufEqualTo()(inputBuf, wireDatagramFrame.data));
+  EXPECT_EQ(queue.chainLength(), 0);
+}
+
+TEST_F(QuicWriteCodecTest, NoSpaceForDatagramFrame) {
+  MockQuicPacketBuilder pktBuilder;
+  pktBuilder.remaining_ = 11;
+  setupCommonExpects(pktBuilder);
+
+  auto inputBuf = buildRandomInputData(10);
+  EXPECT_EQ(0, writeFrame(DatagramFrame(10, std::move(inputBuf)), pktBuilder));
+}
 } // namespace test
 } // namespace quic
@@ -0,0 +1,524 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ *
+ */
+
+#pragma once
+
+#include <glog/logging.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <initializer_list>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+namespace quic {
+
+/**
+ * A double ended queue stored in one ring buffer that doubles when it is
+ * full. Unlike std::deque, which allocates its map and a first block as soon
+ * as it is constructed, an empty CircularDeque allocates nothing, which
+ * matters for the buffers of the many streams that never use them.
+ *
+ * Pushing to either end is amortized O(1), inserting or erasing in the middle
+ * moves the elements on the shorter side. Any insertion or erasure
+ * invalidates iterators, references to elements are invalidated when the
+ * ring buffer grows as well.
+ */
+template <typename T>
+class CircularDeque {
+ public:
+  using value_type = T;
+  using size_type = std::size_t;
+  using difference_type = std::ptrdiff_t;
+  using reference = T&;
+  using const_reference = const T&;
+  using pointer = T*;
+  using const_pointer = const T*;
+
+  // Points at a position of the deque rather than at a slot of the buffer.
+  template <bool IsConst>
+  class Iterator {
+   public:
+    using iterator_category = std::random_access_iterator_tag;
+    using value_type = T;
+    using difference_type = std::ptrdiff_t;
+    using pointer = std::conditional_t<IsConst, const T*, T*>;
+    using reference = std::conditional_t<IsConst, const T&, T&>;
+    using Container =
+        std::conditional_t<IsConst, const CircularDeque, CircularDeque>;
+
+    Iterator() = default;
+
+    Iterator(Container* deque, size_type index)
+        : deque_(deque), index_(index) {}
+
+    // iterator converts to const_iterator.
+    template <
+        bool OtherConst,
+        bool C = IsConst,
+        typename = std::enable_if_t<C && !OtherConst>>
+    /* implicit */ Iterator(const Iterator<OtherConst>& other)
+        : deque_(other.deque_), index_(other.index_) {}
+
+    reference operator*() const {
+      return (*deque_)[index_];
+    }
+
+    pointer operator->() const {
+      return &(*deque_)[index_];
+    }
+
+    reference operator[](difference_type n) const {
+      return (*deque_)[index_ + n];
+    }
+
+    Iterator& operator++() {
+      ++index_;
+      return *this;
+    }
+
+    Iterator operator++(int) {
+      auto copy = *this;
+      ++index_;
+      return copy;
+    }
+
+    Iterator& operator--() {
+      --index_;
+      return *this;
+    }
+
+    Iterator operator--(int) {
+      auto copy = *this;
+      --index_;
+      return copy;
+    }
+
+    Iterator& operator+=(difference_type n) {
+      index_ += n;
+      return *this;
+    }
+
+    Iterator& operator-=(difference_type n) {
+      index_ -= n;
+      return *this;
+    }
+
+    friend Iterator operator+(Iterator itr, difference_type n) {
+      return itr += n;
+    }
+
+    friend Iterator operator+(difference_type n, Iterator itr) {
+      return itr += n;
+    }
+
+    friend Iterator operator-(Iterator itr, difference_type n) {
+      return itr -= n;
+    }
+
+    friend difference_type operator-(const Iterator& a, const Iterator& b) {
+      return static_cast<difference_type>(a.index_) -
+          static_cast<difference_type>(b.index_);
+    }
+
+    friend bool operator==(const Iterator& a, const Iterator& b) {
+      return a.index_ == b.index_;
+    }
+
+    friend bool operator!=(const Iterator& a, const Iterator& b) {
+      return a.index_ != b.index_;
+    }
+
+    friend bool operator<(const Iterator& a, const Iterator& b) {
+      return a.index_ < b.index_;
+    }
+
+    friend bool operator>(const Iterator& a, const Iterator& b) {
+      return a.index_ > b.index_;
+    }
+
+    friend bool operator<=(const Iterator& a, const Iterator& b) {
+      return a.index_ <= b.index_;
+    }
+
+    friend bool operator>=(const Iterator& a, const Iterator& b) {
+      return a.index_ >= b.index_;
+    }
+
+   private:
+    friend class CircularDeque;
+    friend class Iterator<!IsConst>;
+
+    Container* deque_{nullptr};
+    size_type index_{0};
+  };
+
+  using iterator = Iterator<false>;
+  using const_iterator = Iterator<true>;
+  using reverse_iterator = std::reverse_iterator<iterator>;
+  using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+
+  CircularDeque() = default;
+
+  CircularDeque(std::initializer_list<T> init) {
+    reserve(init.size());
+    for (const auto& value : init) {
+      emplace_back(value);
+    }
+  }
+
+  CircularDeque(const CircularDeque& other) {
+    reserve(other.size());
+    for (const auto& value : other) {
+      emplace_back(value);
+    }
+  }
+
+  CircularDeque(CircularDeque&& other) noexcept
+      : storage_(std::exchange(other.storage_, nullptr)),
+        capacity_(std::exchange(other.capacity_, 0)),
+        head_(std::exchange(other.head_, 0)),
+        size_(std::exchange(other.size_, 0)) {}
+
+  CircularDeque& operator=(const CircularDeque& other) {
+    if (this != &other) {
+      CircularDeque copy(other);
+      swap(copy);
+    }
+    return *this;
+  }
+
+  CircularDeque& operator=(CircularDeque&& other) noexcept {
+    if (this != &other) {
+      CircularDeque moved(std::move(other));
+      swap(moved);
+    }
+    return *this;
+  }
+
+  ~CircularDeque() {
+    clear();
+    deallocate();
+  }
+
+  void swap(CircularDeque& other) noexcept {
+    std::swap(storage_, other.storage_);
+    std::swap(capacity_, other.capacity_);
+    std::swap(head_, other.head_);
+    std::swap(size_, other.size_);
+  }
+
+  size_type size() const {
+    return size_;
+  }
+
+  bool empty() const {
+    return size_ == 0;
+  }
+
+  size_type capacity() const {
+    return capacity_;
+  }
+
+  T& operator[](size_type index) {
+    DCHECK_LT(index, size_);
+    return storage_[slot(index)];
+  }
+
+  const T& operator[](size_type index) const {
+    DCHECK_LT(index, size_);
+    return storage_[slot(index)];
+  }
+
+  T& at(size_type index) {
+    if (index >= size_) {
+      throw std::out_of_range("CircularDeque index out of range");
+    }
+    return (*this)[index];
+  }
+
+  const T& at(size_type index) const {
+    return const_cast<CircularDeque*>(this)->at(index);
+  }
+
+  T& front() {
+    return (*this)[0];
+  }
+
+  const T& front() const {
+    return (*this)[0];
+  }
+
+  T& back() {
+    return (*this)[size_ - 1];
+  }
+
+  const T& back() const {
+    return (*this)[size_ - 1];
+  }
+
+  iterator begin() {
+    return iterator(this, 0);
+  }
+
+  const_iterator begin() const {
+    return cbegin();
+  }
+
+  const_iterator cbegin() const {
+    return const_iterator(this, 0);
+  }
+
+  iterator end() {
+    return iterator(this, size_);
+  }
+
+  const_iterator end() const {
+    return cend();
+  }
+
+  const_iterator cend() const {
+    return const_iterator(this, size_);
+  }
+
+  reverse_iterator rbegin() {
+    return reverse_iterator(end());
+  }
+
+  const_reverse_iterator rbegin() const {
+    return crbegin();
+  }
+
+  const_reverse_iterator crbegin() const {
+    return const_reverse_iterator(cend());
+  }
+
+  reverse_iterator rend() {
+    return reverse_iterator(begin());
+  }
+
+  const_reverse_iterator rend() const {
+    return crend();
+  }
+
+  const_reverse_iterator crend() const {
+    return const_reverse_iterator(cbegin());
+  }
+
+  /**
+   * Grows the ring buffer to hold at least n elements. The capacity is
+   * always a power of two.
+   */
+  void reserve(size_type n) {
+    if (n <= capacity_) {
+      return;
+    }
+    size_type newCapacity = std::max<size_type>(capacity_, kMinCapacity);
+    while (newCapacity < n) {
+      newCapacity *= 2;
+    }
+    T* newStorage = std::allocator<T>().allocate(newCapacity);
+    for (size_type i = 0; i < size_; ++i) {
+      auto& value = (*this)[i];
+      new (newStorage + i) T(std::move(value));
+      value.~T();
+    }
+    deallocate();
+    storage_ = newStorage;
+    capacity_ = newCapacity;
+    head_ = 0;
+  }
+
+  /**
+   * Frees the ring buffer when the deque is empty, so a buffer that was only
+   * used in a burst goes back to costing nothing.
+   */
+  void shrink_to_fit() {
+    if (empty()) {
+      deallocate();
+    }
+  }
+
+  template <typename... Args>
+  T& emplace_back(Args&&... args) {
+    if (size_ == capacity_) {
+      // args may refer to an element, build the value before moving them.
+      T value(std::forward<Args>(args)...);
+      reserve(size_ + 1);
+      new (storage_ + slot(size_)) T(std::move(value));
+    } else {
+      new (storage_ + slot(size_)) T(std::forward<Args>(args)...);
+    }
+    ++size_;
+    return back();
+  }
+
+  template <typename... Args>
+  T& emplace_front(Args&&... args) {
+    if (size_ == capacity_) {
+      T value(std::forward<Args>(args)...);
+      reserve(size_ + 1);
+      head_ = (head_ + capacity_ - 1) & (capacity_ - 1);
+      new (storage_ + head_) T(std::move(value));
+    } else {
+      head_ = (head_ + capacity_ - 1) & (capacity_ - 1);
+      new (storage_ + head_) T(std::forward<Args>(args)...);
+    }
+    ++size_;
+    return front();
+  }
+
+  void push_back(const T& value) {
+    emplace_back(value);
+  }
+
+  void push_back(T&& value) {
+    emplace_back(std::move(value));
+  }
+
+  void push_front(const T& value) {
+    emplace_front(value);
+  }
+
+  void push_front(T&& value) {
+    emplace_front(std::move(value));
+  }
+
+  void pop_front() {
+    DCHECK(!empty());
+    front().~T();
+    head_ = (head_ + 1) & (capacity_ - 1);
+    --size_;
+  }
+
+  void pop_back() {
+    DCHECK(!empty());
+    back().~T();
+    --size_;
+  }
+
+  template <typename... Args>
+  iterator emplace(const_iterator pos, Args&&... args) {
+    auto index = pos.index_;
+    DCHECK_LE(index, size_);
+    if (index == size_) {
+      emplace_back(std::forward<Args>(args)...);
+      return iterator(this, index);
+    }
+    if (index == 0) {
+      emplace_front(std::forward<Args>(args)...);
+      return begin();
+    }
+    T value(std::forward<Args>(args)...);
+    reserve(size_ + 1);
+    if (index < size_ / 2) {
+      // Open a hole at index by moving the front part down by one.
+      emplace_front(std::move(front()));
+      for (size_type i = 1; i < index; ++i) {
+        (*this)[i] = std::move((*this)[i + 1]);
+      }
+    } else {
+      emplace_back(std::move(back()));
+      for (size_type i = size_ - 2; i > index; --i) {
+        (*this)[i] = std::move((*this)[i - 1]);
+      }
+    }
+    (*this)[index] = std::move(value);
+    return iterator(this, index);
+  }
+
+  iterator insert(const_iterator pos, const T& value) {
+    return emplace(pos, value);
+  }
+
+  iterator insert(const_iterator pos, T&& value) {
+    return emplace(pos, std::move(value));
+  }
+
+  iterator erase(const_iterator pos) {
+    return erase(pos, pos + 1);
+  }
+
+  iterator erase(const_iterator first, const_iterator last) {
+    auto begin = first.index_;
+    auto end = last.index_;
+    DCHECK_LE(begin, end);
+    DCHECK_LE(end, size_);
+    auto count = end - begin;
+    if (count == 0) {
+      return iterator(this, begin);
+    }
+    if (begin < size_ - end) {
+      // Fewer elements before the range, move them up over it.
+      for (size_type i = begin; i > 0; --i) {
+        (*this)[i - 1 + count] = std::move((*this)[i - 1]);
+      }
+      for (size_type i = 0; i < count; ++i) {
+        pop_front();
+      }
+    } else {
+      for (size_type i = end; i < size_; ++i) {
+        (*this)[i - count] = std::move((*this)[i]);
+      }
+      for (size_type i = 0; i < count; ++i) {
+        pop_back();
+      }
+    }
+    return iterator(this, begin);
+  }
+
+  /**
+   * Destroys the elements and keeps the ring buffer, like std::vector.
+   */
+  void clear() {
+    while (!empty()) {
+      pop_back();
+    }
+    head_ = 0;
+  }
+
+ private:
+  static constexpr size_type kMinCapacity = 4;
+
+  size_type slot(size_type index) const {
+    return (head_ + index) & (capacity_ - 1);
+  }
+
+  void deallocate() {
+    if (storage_) {
+      std::allocator<T>().deallocate(storage_, capacity_);
+      storage_ = nullptr;
+      capacity_ = 0;
+      head_ = 0;
+    }
+  }
+
+  T* storage_{nullptr};
+  size_type capacity_{0};
+  size_type head_{0};
+  size_type size_{0};
+};
+
+template <typename T>
+bool operator==(const CircularDeque<T>& a, const CircularDeque<T>& b) {
+  return a.size() == b.size() && std::equal(a.begin(), a.end(), b.begin());
+}
+
+template <typename T>
+bool operator!=(const CircularDeque<T>& a, const CircularDeque<T>& b) {
+  return !(a == b);
+}
+
+template <typename T>
+constexpr typename CircularDeque<T>::size_type CircularDeque<T>::kMinCapacity;
+
+} // namespace quic
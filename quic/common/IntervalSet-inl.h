@@ -26,6 +26,7 @@ void IntervalSet<T, Unit, Container>::insert(
   auto endIt = intersectionRange.second;
   if (firstIt == endIt) {
     insertVersion_++;
+    version_++;
     container_type::insert(firstIt, std::move(interval));
     return;
   }
@@ -37,6 +38,7 @@ void IntervalSet<T, Unit, Container>::insert(
   auto newDifference = firstIt->end - firstIt->start;
   if (newDifference > originalDifference) {
     insertVersion_++;
+    version_++;
   }
   container_type::erase(std::next(firstIt), endIt);
 }
@@ -51,6 +53,7 @@ void IntervalSet<T, Unit, Container>::withdraw(
     // No intersection, doesn't need to do anything
     return;
   }
+  version_++;
   auto erasureStart = first;
   auto erasureEnd = end;
   auto last = std::prev(end);
@@ -114,4 +117,23 @@ template <typename T, T Unit, template <typename... I> class Container>
 uint64_t IntervalSet<T, Unit, Container>::insertVersion() const {
   return insertVersion_;
 }
+
+template <typename T, T Unit, template <typename... I> class Container>
+uint64_t IntervalSet<T, Unit, Container>::version() const {
+  return version_;
+}
+
+template <typename T, T Unit, template <typename... I> class Container>
+void IntervalSet<T, Unit, Container>::clear() {
+  if (!container_type::empty()) {
+    version_++;
+  }
+  container_type::clear();
+}
+
+template <typename T, T Unit, template <typename... I> class Container>
+void IntervalSet<T, Unit, Container>::pop_back() {
+  version_++;
+  container_type::pop_back();
+}
 } // namespace quic
@@ -8,10 +8,37 @@
 
 #include "quic/common/SocketUtil.h"
 
+#include <glog/logging.h>
+
+#include <cstring>
+
+#if defined(__linux__) && !FOLLY_MOBILE
+#define QUIC_TXTIME_SUPPORTED 1
+#else
+#define QUIC_TXTIME_SUPPORTED 0
+#endif
+
+#if QUIC_TXTIME_SUPPORTED && !defined(SO_TXTIME)
+#define SO_TXTIME 61
+#define SCM_TXTIME SO_TXTIME
+#endif
+
+#if defined(__linux__) && !defined(UDP_SEGMENT)
+#define UDP_SEGMENT 103
+#endif
+
 using folly::AsyncUDPSocket;
 
 namespace quic {
 
+#if QUIC_TXTIME_SUPPORTED
+static_assert(
+    CMSG_SPACE(sizeof(uint16_t)) + CMSG_SPACE(sizeof(uint64_t)) +
+            CMSG_SPACE(sizeof(int)) <=
+        kUdpControlMessagesSize,
+    "kUdpControlMessagesSize is too small");
+#endif
+
 bool isNetworkUnreachable(int err) {
   return err == EHOSTUNREACH || err == ENETUNREACH;
 }
@@ -37,4 +64,139 @@ void applySocketOptions(
   sock.applyOptions(validOptions, pos);
 }
 
+bool enableTxTime(FOLLY_MAYBE_UNUSED AsyncUDPSocket& sock) {
+#if QUIC_TXTIME_SUPPORTED
+  // struct sock_txtime, which older headers lack. steady_clock is
+  // CLOCK_MONOTONIC, the clock of the fq qdisc.
+  struct {
+    clockid_t clockid;
+    uint32_t flags;
+  } txTimeConfig = {CLOCK_MONOTONIC, 0};
+  auto ret = folly::netops::setsockopt(
+      sock.getNetworkSocket(),
+      SOL_SOCKET,
+      SO_TXTIME,
+      &txTimeConfig,
+      sizeof(txTimeConfig));
+  if (ret != 0) {
+    VLOG(4) << "SO_TXTIME is not supported by the socket, errno=" << errno;
+  }
+  return ret == 0;
+#else
+  return false;
+#endif
+}
+
+bool enableRecvTos(FOLLY_MAYBE_UNUSED AsyncUDPSocket& sock) {
+#ifdef __linux__
+  int val = 1;
+  // The IPv4 packets a dual stack socket reads come with IP_TOS.
+  auto ret = folly::netops::setsockopt(
+      sock.getNetworkSocket(), IPPROTO_IP, IP_RECVTOS, &val, sizeof(val));
+  if (sock.address().getFamily() == AF_INET6) {
+    ret = folly::netops::setsockopt(
+        sock.getNetworkSocket(),
+        IPPROTO_IPV6,
+        IPV6_RECVTCLASS,
+        &val,
+        sizeof(val));
+  }
+  if (ret != 0) {
+    VLOG(4) << "Reading the TOS is not supported by the socket, errno="
+            << errno;
+  }
+  return ret == 0;
+#else
+  return false;
+#endif
+}
+
+folly::Optional<uint8_t> getRecvTos(FOLLY_MAYBE_UNUSED const cmsghdr& cmsg) {
+#ifdef __linux__
+  if (cmsg.cmsg_level == IPPROTO_IP && cmsg.cmsg_type == IP_TOS &&
+      cmsg.cmsg_len >= CMSG_LEN(sizeof(uint8_t))) {
+    return *CMSG_DATA(&cmsg);
+  }
+  if (cmsg.cmsg_level == IPPROTO_IPV6 && cmsg.cmsg_type == IPV6_TCLASS &&
+      cmsg.cmsg_len >= CMSG_LEN(sizeof(int))) {
+    int tclass;
+    memcpy(&tclass, CMSG_DATA(&cmsg), sizeof(tclass));
+    return static_cast<uint8_t>(tclass);
+  }
+#endif
+  return folly::none;
+}
+
+void setUdpControlMessages(
+    struct msghdr& msg,
+    FOLLY_MAYBE_UNUSED char* control,
+    FOLLY_MAYBE_UNUSED const folly::SocketAddress& address,
+    FOLLY_MAYBE_UNUSED const UdpWriteOptions& options) {
+  msg.msg_control = nullptr;
+  msg.msg_controllen = 0;
+#ifdef __linux__
+  memset(control, 0, kUdpControlMessagesSize);
+  msg.msg_control = control;
+  msg.msg_controllen = kUdpControlMessagesSize;
+  size_t controlLen = 0;
+  struct cmsghdr* cm = CMSG_FIRSTHDR(&msg);
+  if (options.gso > 0) {
+    cm->cmsg_level = SOL_UDP;
+    cm->cmsg_type = UDP_SEGMENT;
+    cm->cmsg_len = CMSG_LEN(sizeof(uint16_t));
+    auto gsoSize = static_cast<uint16_t>(options.gso);
+    memcpy(CMSG_DATA(cm), &gsoSize, sizeof(gsoSize));
+    controlLen += CMSG_SPACE(sizeof(uint16_t));
+    cm = CMSG_NXTHDR(&msg, cm);
+  }
+#if QUIC_TXTIME_SUPPORTED
+  if (options.txTime) {
+    cm->cmsg_level = SOL_SOCKET;
+    cm->cmsg_type = SCM_TXTIME;
+    cm->cmsg_len = CMSG_LEN(sizeof(uint64_t));
+    uint64_t txTimeNs = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                            options.txTime->time_since_epoch())
+                            .count();
+    memcpy(CMSG_DATA(cm), &txTimeNs, sizeof(txTimeNs));
+    controlLen += CMSG_SPACE(sizeof(uint64_t));
+    cm = CMSG_NXTHDR(&msg, cm);
+  }
+#endif
+  if (options.tos) {
+    // IPv4 mapped addresses take the IPv4 option, even on an IPv6 socket.
+    bool ipv6 = address.getFamily() == AF_INET6 &&
+        !address.getIPAddress().isIPv4Mapped();
+    cm->cmsg_level = ipv6 ? IPPROTO_IPV6 : IPPROTO_IP;
+    cm->cmsg_type = ipv6 ? IPV6_TCLASS : IP_TOS;
+    cm->cmsg_len = CMSG_LEN(sizeof(int));
+    int tos = options.tos;
+    memcpy(CMSG_DATA(cm), &tos, sizeof(tos));
+    controlLen += CMSG_SPACE(sizeof(int));
+  }
+  msg.msg_controllen = controlLen;
+  if (controlLen == 0) {
+    msg.msg_control = nullptr;
+  }
+#endif
+}
+
+ssize_t sendUdpMessage(
+    AsyncUDPSocket& sock,
+    const folly::SocketAddress& address,
+    const struct iovec* iov,
+    size_t iovlen,
+    const UdpWriteOptions& options,
+    int flags) {
+  sockaddr_storage addrStorage;
+  auto addrLen = address.getAddress(&addrStorage);
+  struct msghdr msg {};
+  msg.msg_name = reinterpret_cast<void*>(&addrStorage);
+  msg.msg_namelen = addrLen;
+  msg.msg_iov = const_cast<struct iovec*>(iov);
+  msg.msg_iovlen = iovlen;
+  char control[kUdpControlMessagesSize];
+  setUdpControlMessages(msg, control, address, options);
+  return folly::netops::sendmsg(sock.getNetworkSocket(), &msg, flags);
+}
+
 } // namespace quic
@@ -8,12 +8,30 @@
 
 #pragma once
 
+#include <folly/Optional.h>
 #include <folly/io/SocketOptionMap.h>
 #include <folly/io/async/AsyncUDPSocket.h>
 #include <folly/net/NetOps.h>
 
+#include <chrono>
+
 namespace quic {
 
+// Room for the control messages of sendUdpMessage().
+constexpr size_t kUdpControlMessagesSize = 96;
+
+/**
+ * The options of a UDP write that go into its control messages.
+ */
+struct UdpWriteOptions {
+  // Segment size of a GSO write if positive.
+  int gso{0};
+  // Departure time, see enableTxTime().
+  folly::Optional<std::chrono::steady_clock::time_point> txTime;
+  // TOS byte, or IPv6 traffic class, of the packets if not zero.
+  uint8_t tos{0};
+};
+
 bool isNetworkUnreachable(int err);
 
 void applySocketOptions(
@@ -22,4 +40,48 @@ void applySocketOptions(
     sa_family_t family,
     folly::SocketOptionKey::ApplyPos pos) noexcept;
 
+/**
+ * Lets the writes to sock carry an SCM_TXTIME departure time on the clock of
+ * std::chrono::steady_clock, which the fq qdisc holds the packets until.
+ * Returns false if the platform or the socket does not support it.
+ */
+bool enableTxTime(folly::AsyncUDPSocket& sock);
+
+/**
+ * Asks for the TOS byte, or the IPv6 traffic class, of the packets read from
+ * sock in their control messages, see getRecvTos(). Returns false if the
+ * platform or the socket does not support it.
+ */
+bool enableRecvTos(folly::AsyncUDPSocket& sock);
+
+/**
+ * The TOS byte, or the IPv6 traffic class, cmsg carries, none if it is another
+ * control message.
+ */
+folly::Optional<uint8_t> getRecvTos(const struct cmsghdr& cmsg);
+
+/**
+ * Points msg at the control messages of a UDP write to address, written to
+ * control, which must hold kUdpControlMessagesSize bytes: UDP_SEGMENT if gso
+ * is positive, SCM_TXTIME if txTime is set and IP_TOS or IPV6_TCLASS if tos is
+ * not zero.
+ */
+void setUdpControlMessages(
+    struct msghdr& msg,
+    char* control,
+    const folly::SocketAddress& address,
+    const UdpWriteOptions& options);
+
+/**
+ * Writes iov to address with sendmsg() and the control messages of options.
+ * Returns the result of the sendmsg() call.
+ */
+ssize_t sendUdpMessage(
+    folly::AsyncUDPSocket& sock,
+    const folly::SocketAddress& address,
+    const struct iovec* iov,
+    size_t iovlen,
+    const UdpWriteOptions& options,
+    int flags);
+
 } // namespace quic
@@ -0,0 +1,147 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ *
+ */
+
+#include <quic/common/CircularDeque.h>
+
+#include <gtest/gtest.h>
+
+#include <deque>
+#include <memory>
+#include <random>
+#include <vector>
+
+using namespace quic;
+
+TEST(CircularDequeTest, EmptyDoesNotAllocate) {
+  CircularDeque<int> deque;
+  EXPECT_TRUE(deque.empty());
+  EXPECT_EQ(deque.capacity(), 0);
+  EXPECT_EQ(deque.begin(), deque.end());
+  deque.push_back(1);
+  EXPECT_GT(deque.capacity(), 0);
+  deque.pop_back();
+  deque.shrink_to_fit();
+  EXPECT_EQ(deque.capacity(), 0);
+}
+
+TEST(CircularDequeTest, PushAndPopBothEnds) {
+  CircularDeque<int> deque;
+  for (int i = 0; i < 10; ++i) {
+    deque.push_back(i);
+    deque.push_front(-i - 1);
+  }
+  EXPECT_EQ(deque.size(), 20);
+  for (int i = 0; i < 20; ++i) {
+    EXPECT_EQ(deque[i], i - 10);
+  }
+  EXPECT_EQ(deque.front(), -10);
+  EXPECT_EQ(deque.back(), 9);
+  deque.pop_front();
+  deque.pop_back();
+  EXPECT_EQ(deque.front(), -9);
+  EXPECT_EQ(deque.back(), 8);
+  EXPECT_THROW(deque.at(18), std::out_of_range);
+}
+
+TEST(CircularDequeTest, GrowWithWrappedElements) {
+  CircularDeque<std::unique_ptr<int>> deque;
+  // Wrap the ring buffer around before it grows.
+  deque.emplace_back(std::make_unique<int>(0));
+  deque.emplace_back(std::make_unique<int>(1));
+  deque.pop_front();
+  for (int i = 2; i < 100; ++i) {
+    deque.emplace_back(std::make_unique<int>(i));
+  }
+  int expected = 1;
+  for (const auto& value : deque) {
+    EXPECT_EQ(*value, expected++);
+  }
+}
+
+TEST(CircularDequeTest, EmplaceAndEraseInTheMiddle) {
+  CircularDeque<int> deque{0, 1, 2, 4, 5};
+  auto itr = deque.insert(deque.cbegin() + 3, 3);
+  EXPECT_EQ(*itr, 3);
+  itr = deque.emplace(deque.cbegin() + 1, 10);
+  EXPECT_EQ(*itr, 10);
+  EXPECT_EQ(deque, (CircularDeque<int>{0, 10, 1, 2, 3, 4, 5}));
+  itr = deque.erase(deque.cbegin() + 1);
+  EXPECT_EQ(*itr, 1);
+  itr = deque.erase(deque.cbegin() + 4, deque.cend());
+  EXPECT_EQ(itr, deque.end());
+  EXPECT_EQ(deque, (CircularDeque<int>{0, 1, 2, 3}));
+  itr = deque.erase(deque.cbegin(), deque.cbegin() + 2);
+  EXPECT_EQ(*itr, 2);
+  EXPECT_EQ(deque, (CircularDeque<int>{2, 3}));
+}
+
+TEST(CircularDequeTest, CopyAndMove) {
+  CircularDeque<int> deque{1, 2, 3};
+  CircularDeque<int> copy = deque;
+  copy.push_back(4);
+  EXPECT_EQ(deque.size(), 3);
+  CircularDeque<int> moved = std::move(copy);
+  EXPECT_TRUE(copy.empty());
+  EXPECT_EQ(moved, (CircularDeque<int>{1, 2, 3, 4}));
+  deque = moved;
+  EXPECT_EQ(deque, moved);
+}
+
+TEST(CircularDequeTest, ReverseIteration) {
+  CircularDeque<int> deque{1, 2, 3};
+  std::vector<int> reversed(deque.crbegin(), deque.crend());
+  EXPECT_EQ(reversed, (std::vector<int>{3, 2, 1}));
+}
+
+TEST(CircularDequeTest, MatchesStdDeque) {
+  std::mt19937 rng(0);
+  CircularDeque<int> deque;
+  std::deque<int> expected;
+  for (int i = 0; i < 10000; ++i) {
+    int value = rng();
+    switch (rng() % 6) {
+      case 0:
+        deque.push_back(value);
+        expected.push_back(value);
+        break;
+      case 1:
+        deque.push_front(value);
+        expected.push_front(value);
+        break;
+      case 2: {
+        auto index = rng() % (expected.size() + 1);
+        deque.insert(deque.cbegin() + index, value);
+        expected.insert(expected.begin() + index, value);
+        break;
+      }
+      case 3:
+        if (!expected.empty()) {
+          auto index = rng() % expected.size();
+          auto count = rng() % (expected.size() - index + 1);
+          deque.erase(deque.cbegin() + index, deque.cbegin() + index + count);
+          expected.erase(
+              expected.begin() + index, expected.begin() + index + count);
+        }
+        break;
+      case 4:
+        if (!expected.empty()) {
+          deque.pop_front();
+          expected.pop_front();
+        }
+        break;
+      case 5:
+        if (!expected.empty()) {
+          deque.pop_back();
+          expected.pop_back();
+        }
+        break;
+    }
+    ASSERT_EQ(deque.size(), expected.size());
+    ASSERT_TRUE(std::equal(deque.begin(), deque.end(), expected.begin()));
+  }
+}
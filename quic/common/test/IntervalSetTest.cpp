@@ -21,6 +21,27 @@ TEST(IntervalSet, empty) {
   EXPECT_GT(set.insertVersion(), originalVersion);
 }
 
+TEST(IntervalSet, versionCountsAllChanges) {
+  IntervalSet<int> set;
+  auto version1 = set.version();
+  set.insert(1, 5);
+  auto version2 = set.version();
+  EXPECT_GT(version2, version1);
+  // Nothing changes.
+  set.insert(2, 3);
+  set.withdraw({10, 12});
+  EXPECT_EQ(set.version(), version2);
+  set.withdraw({2, 3});
+  auto version3 = set.version();
+  EXPECT_GT(version3, version2);
+  EXPECT_EQ(set.insertVersion(), 1);
+  set.pop_back();
+  auto version4 = set.version();
+  EXPECT_GT(version4, version3);
+  set.clear();
+  EXPECT_GT(set.version(), version4);
+}
+
 TEST(IntervalSet, insertAtFront) {
   IntervalSet<int> set;
   auto version1 = set.insertVersion();
@@ -194,7 +194,7 @@ OutstandingPacket* findOutstandingPacket(
     QuicConnectionStateBase& conn,
     Match match) {
   auto helper =
-      [&](std::deque<OutstandingPacket>& packets) -> OutstandingPacket* {
+      [&](OutstandingPacketStore& packets) -> OutstandingPacket* {
     for (auto& packet : packets) {
       if (match(packet)) {
         return &packet;
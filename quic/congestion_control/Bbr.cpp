@@ -15,6 +15,7 @@
 #include <quic/congestion_control/CongestionControlFunctions.h>
 #include <quic/logging/QLoggerConstants.h>
 #include <quic/logging/QuicLogger.h>
+#include <quic/state/QuicStateFunctions.h>
 
 using namespace std::chrono_literals;
 
@@ -24,6 +25,8 @@ quic::Bandwidth kHighPacingRateForSendQuantum{24, 1us};
 // See BBRInflight(gain) function in
 // https://tools.ietf.org/html/draft-cardwell-iccrg-bbr-congestion-control-00#section-4.2.3.2
 uint64_t kQuantaFactor = 3;
+// Acks per congestion window asked of the peer with ACK_FREQUENCY.
+uint64_t kAcksPerCwnd = 4;
 } // namespace
 
 namespace quic {
@@ -206,12 +209,18 @@ void BbrCongestionController::onPacketAcked(
 
   auto excessiveBytes = updateAckAggregation(ack);
 
+  // CE marks mean the bottleneck queue is building up, like a loss does.
+  bool ecnCe = conn_.transportSettings.enableEcn && ack.ecnCeCount > 0;
+  if (ecnCe && state_ == BbrState::Startup) {
+    btlbwFound_ = true;
+  }
+
   // handleAckInProbeBw() needs to happen before we check exiting Startup and
   // Drain and transitToProbeBw(). Otherwise, we may transitToProbeBw() first
   // then immediately invoke a handleAckInProbeBw() to also transit to next
   // ProbwBw pacing cycle.
   if (state_ == BbrState::ProbeBw) {
-    handleAckInProbeBw(ack.ackTime, prevInflightBytes, hasLoss);
+    handleAckInProbeBw(ack.ackTime, prevInflightBytes, hasLoss || ecnCe);
   }
 
   if (newRoundTrip && !lastAckedPacketAppLimited) {
@@ -237,6 +246,7 @@ void BbrCongestionController::onPacketAcked(
 
   updateCwnd(ack.ackedBytes, excessiveBytes);
   updatePacing();
+  updateAckFrequency();
   if (conn_.qLogger) {
     conn_.qLogger->addCongestionMetricUpdate(
         conn_.lossState.inflightBytes,
@@ -256,6 +266,17 @@ void BbrCongestionController::onPacketAcked(
       conn_.lossState.inflightBytes);
 }
 
+void BbrCongestionController::updateAckFrequency() {
+  if (state_ == BbrState::Startup) {
+    return;
+  }
+  auto packetTolerance =
+      getCongestionWindow() / conn_.udpSendPacketLen / kAcksPerCwnd;
+  auto maxAckDelay = std::chrono::duration_cast<std::chrono::microseconds>(
+      kAckTimerFactor * conn_.lossState.srtt);
+  requestPeerAckFrequency(conn_, packetTolerance, maxAckDelay);
+}
+
 // TODO: We used to check if there is available bandwidth and rtt samples in
 // canBePaced function. Now this function is gone, maybe we need to change this
 // updatePacing function.
@@ -562,6 +583,20 @@ uint64_t BbrCongestionController::getCongestionWindow() const noexcept {
   return cwnd_;
 }
 
+void BbrCongestionController::onCachedCongestionState(
+    const CachedCongestionState& state) noexcept {
+  // Startup aims for a multiple of the initial window until there is a
+  // bandwidth sample, so raising it takes the connection there quicker.
+  initialCwnd_ = cachedStateCwnd(conn_, state, initialCwnd_);
+  cwnd_ = std::max(cwnd_, initialCwnd_);
+  pacingWindow_ = std::max(pacingWindow_, initialCwnd_);
+  QUIC_TRACE(initcwnd, conn_, initialCwnd_);
+}
+
+uint64_t BbrCongestionController::getBandwidthEstimate() const noexcept {
+  return bandwidth().normalize();
+}
+
 void BbrCongestionController::detectBottleneckBandwidth(bool appLimitedSample) {
   if (btlbwFound_) {
     return;
@@ -126,6 +126,10 @@ class BbrCongestionController : public CongestionController {
 
   bool isAppLimited() const noexcept override;
 
+  void onCachedCongestionState(
+      const CachedCongestionState& state) noexcept override;
+  uint64_t getBandwidthEstimate() const noexcept override;
+
   // TODO: some of these do not have to be in public API.
   bool inRecovery() const noexcept;
   BbrState state() const noexcept;
@@ -139,6 +143,12 @@ class BbrCongestionController : public CongestionController {
   onPacketAcked(const AckEvent& ack, uint64_t prevInflightBytes, bool hasLoss);
   void onPacketLoss(const LossEvent&, uint64_t ackedBytes);
   void updatePacing() noexcept;
+  /**
+   * Ask the peer for a few acks per congestion window with ACK_FREQUENCY once
+   * the bottleneck bandwidth is found. Startup keeps the ack rate the peer
+   * defaults to, so that bandwidth samples come quickly.
+   */
+  void updateAckFrequency();
 
   /**
    * Update the ack aggregation states
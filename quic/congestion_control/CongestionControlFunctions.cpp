@@ -24,6 +24,43 @@ uint64_t boundedCwnd(
       minCwndInMss * packetLength);
 }
 
+uint64_t cachedStateCwnd(
+    const QuicConnectionStateBase& conn,
+    const CachedCongestionState& state,
+    uint64_t initCwnd) noexcept {
+  uint64_t cwnd = state.cwndBytes * kCachedCwndFraction;
+  if (state.bandwidth > 0 && state.minRtt > 0us) {
+    uint64_t bdp = state.bandwidth * state.minRtt.count() / 1000000;
+    cwnd = std::min(cwnd, bdp);
+  }
+  cwnd = std::min(
+      cwnd, conn.transportSettings.maxCwndInMss * conn.udpSendPacketLen);
+  return std::max(cwnd, initCwnd);
+}
+
+double L4sCongestionResponse::onAck(
+    const CongestionController::AckEvent& ack) {
+  markedInRound_ += ack.ecnMarkedPackets;
+  ceInRound_ += ack.ecnCeCount;
+  if (roundStart_ && ack.largestAckedPacketSentTime <= *roundStart_) {
+    return 0.0;
+  }
+  double reduction = 0.0;
+  if (markedInRound_ > 0) {
+    double fraction = std::min(
+        1.0,
+        static_cast<double>(ceInRound_) / static_cast<double>(markedInRound_));
+    alpha_ = (1.0 - kL4sAlphaGain) * alpha_ + kL4sAlphaGain * fraction;
+    if (ceInRound_ > 0) {
+      reduction = alpha_ / 2;
+    }
+  }
+  markedInRound_ = 0;
+  ceInRound_ = 0;
+  roundStart_ = ack.ackTime;
+  return reduction;
+}
+
 PacingRate calculatePacingRate(
     const QuicConnectionStateBase& conn,
     uint64_t cwnd,
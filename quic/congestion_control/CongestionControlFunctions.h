@@ -21,12 +21,48 @@ uint64_t boundedCwnd(
     uint64_t maxCwndInMss,
     uint64_t minCwndInMss) noexcept;
 
+/**
+ * The congestion window to start from with a cached congestion state: a
+ * fraction of the window the cached connection ended with, no larger than
+ * its bandwidth-delay product when it had a bandwidth estimate, and between
+ * initCwnd and the max cwnd.
+ */
+uint64_t cachedStateCwnd(
+    const QuicConnectionStateBase& conn,
+    const CachedCongestionState& state,
+    uint64_t initCwnd) noexcept;
+
 PacingRate calculatePacingRate(
     const QuicConnectionStateBase& conn,
     uint64_t cwnd,
     uint64_t minCwndInMss,
     std::chrono::microseconds rtt);
 
+/**
+ * DCTCP style response to CE marks for L4S ECN. Keeps alpha, the moving
+ * average of the fraction of ECN marked packets that came back CE, updated
+ * once per round trip.
+ */
+class L4sCongestionResponse {
+ public:
+  /**
+   * Returns the fraction the congestion window should be reduced by, which is
+   * zero until a round trip that saw CE marks ends.
+   */
+  double onAck(const CongestionController::AckEvent& ack);
+
+  double alpha() const {
+    return alpha_;
+  }
+
+ private:
+  double alpha_{1.0};
+  uint64_t markedInRound_{0};
+  uint64_t ceInRound_{0};
+  // The round ends with the ack of a packet sent after this.
+  folly::Optional<TimePoint> roundStart_;
+};
+
 template <class T1, class T2>
 void addAndCheckOverflow(T1& value, const T2& toAdd) {
   if (std::numeric_limits<T1>::max() - toAdd < value) {
@@ -99,11 +99,43 @@ void NewReno::onPacketAckOrLoss(
     // on the pacer when there is loss.
   }
   if (ackEvent && ackEvent->largestAckedPacket.has_value()) {
+    if (conn_.transportSettings.enableEcn) {
+      onAckEcn(*ackEvent);
+    }
     onAckEvent(*ackEvent);
   }
   // TODO: Pacing isn't supported with NewReno
 }
 
+void NewReno::onAckEcn(const AckEvent& ack) {
+  double reduction = 0.0;
+  if (conn_.transportSettings.useL4sEcn) {
+    reduction = l4sResponse_.onAck(ack);
+  } else if (
+      ack.ecnCeCount > 0 &&
+      (!endOfRecovery_ || *endOfRecovery_ < ack.largestAckedPacketSentTime)) {
+    // A CE mark is a loss that did not happen.
+    reduction = 0.5;
+  }
+  if (reduction <= 0.0) {
+    return;
+  }
+  endOfRecovery_ = Clock::now();
+  cwndBytes_ = boundedCwnd(
+      cwndBytes_ - static_cast<uint64_t>(cwndBytes_ * reduction),
+      conn_.udpSendPacketLen,
+      conn_.transportSettings.maxCwndInMss,
+      conn_.transportSettings.minCwndInMss);
+  ssthresh_ = cwndBytes_;
+  VLOG(10) << __func__ << " ce=" << ack.ecnCeCount
+           << " reduction=" << reduction << " cwnd=" << cwndBytes_
+           << " inflight=" << conn_.lossState.inflightBytes << " " << conn_;
+  if (conn_.qLogger) {
+    conn_.qLogger->addCongestionMetricUpdate(
+        conn_.lossState.inflightBytes, getCongestionWindow(), kCongestionEcnCe);
+  }
+}
+
 void NewReno::onPacketLoss(const LossEvent& loss) {
   DCHECK(
       loss.largestLostPacketNum.has_value() &&
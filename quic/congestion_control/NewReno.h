@@ -9,6 +9,7 @@
 #pragma once
 
 #include <quic/QuicException.h>
+#include <quic/congestion_control/CongestionControlFunctions.h>
 #include <quic/state/StateData.h>
 
 #include <limits>
@@ -39,6 +40,7 @@ class NewReno : public CongestionController {
  private:
   void onPacketLoss(const LossEvent&);
   void onAckEvent(const AckEvent&);
+  void onAckEcn(const AckEvent&);
   void onPacketAcked(const CongestionController::AckEvent::AckPacket&);
 
  private:
@@ -46,5 +48,6 @@ class NewReno : public CongestionController {
   uint64_t ssthresh_;
   uint64_t cwndBytes_;
   folly::Optional<TimePoint> endOfRecovery_;
+  L4sCongestionResponse l4sResponse_;
 };
 } // namespace quic
@@ -71,6 +71,13 @@ void DefaultPacer::onPacedWriteScheduled(TimePoint currentTime) {
 }
 
 void DefaultPacer::onPacketSent() {
+  if (isKernelPaced()) {
+    if (nextTxTime_ && ++packetsInBurst_ >= batchSize_) {
+      *nextTxTime_ += writeInterval_;
+      packetsInBurst_ = 0;
+    }
+    return;
+  }
   if (tokens_) {
     --tokens_;
   }
@@ -81,6 +88,18 @@ void DefaultPacer::onPacketsLoss() {
 }
 
 std::chrono::microseconds DefaultPacer::getTimeUntilNextWrite() const {
+  if (isKernelPaced()) {
+    // Wake up once the next burst is within the horizon.
+    if (!nextTxTime_) {
+      return 0us;
+    }
+    auto writeTime = *nextTxTime_ - txTimeHorizon();
+    auto now = Clock::now();
+    return writeTime > now
+        ? std::chrono::duration_cast<std::chrono::microseconds>(
+              writeTime - now)
+        : 0us;
+  }
   return tokens_ ? 0us : writeInterval_;
 }
 
@@ -91,6 +110,16 @@ uint64_t DefaultPacer::updateAndGetWriteBatchSize(TimePoint currentTime) {
   if (writeInterval_ == 0us) {
     return batchSize_;
   }
+  if (isKernelPaced()) {
+    // Everything that leaves within the horizon can be written now.
+    catchUpTxTime(currentTime);
+    auto horizonEnd = currentTime + txTimeHorizon();
+    if (*nextTxTime_ > horizonEnd) {
+      return 0;
+    }
+    uint64_t numBursts = (horizonEnd - *nextTxTime_) / writeInterval_ + 1;
+    return numBursts * batchSize_ - packetsInBurst_;
+  }
   if (!scheduledWriteTime_ || *scheduledWriteTime_ >= currentTime) {
     return tokens_;
   }
@@ -107,6 +136,33 @@ uint64_t DefaultPacer::updateAndGetWriteBatchSize(TimePoint currentTime) {
   return tokens_;
 }
 
+folly::Optional<TimePoint> DefaultPacer::getTxTime(TimePoint currentTime) {
+  if (!isKernelPaced()) {
+    return folly::none;
+  }
+  catchUpTxTime(currentTime);
+  return nextTxTime_;
+}
+
+bool DefaultPacer::isKernelPaced() const {
+  return conn_.transportSettings.txTimePacing && writeInterval_ != 0us;
+}
+
+std::chrono::microseconds DefaultPacer::txTimeHorizon() const {
+  // Writing further ahead than an RTT would only delay the reaction to acks.
+  auto horizon = conn_.transportSettings.txTimePacingHorizon;
+  return conn_.lossState.srtt != 0us
+      ? std::min<std::chrono::microseconds>(horizon, conn_.lossState.srtt)
+      : horizon;
+}
+
+void DefaultPacer::catchUpTxTime(TimePoint currentTime) {
+  if (!nextTxTime_ || *nextTxTime_ < currentTime) {
+    nextTxTime_ = currentTime;
+    packetsInBurst_ = 0;
+  }
+}
+
 uint64_t DefaultPacer::getCachedWriteBatchSize() const {
   return cachedBatchSize_;
 }
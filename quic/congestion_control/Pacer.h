@@ -22,6 +22,14 @@ using PacingRateCalculator = folly::Function<PacingRate(
     uint64_t minCwndInMss,
     std::chrono::microseconds rtt)>;
 
+/**
+ * Paces the writes in bursts of batchSize_ packets every writeInterval_.
+ *
+ * By default the bursts are spaced by the pacing timer of the transport. With
+ * TransportSettings::txTimePacing, each burst is stamped with its departure
+ * time instead, and the transport writes all the bursts that leave within the
+ * horizon at once, leaving their spacing to the fq qdisc.
+ */
 class DefaultPacer : public Pacer {
  public:
   explicit DefaultPacer(
@@ -44,10 +52,20 @@ class DefaultPacer : public Pacer {
 
   uint64_t getCachedWriteBatchSize() const override;
 
+  folly::Optional<TimePoint> getTxTime(TimePoint currentTime) override;
+
   void onPacketSent() override;
   void onPacketsLoss() override;
 
  private:
+  bool isKernelPaced() const;
+
+  std::chrono::microseconds txTimeHorizon() const;
+
+  // Moves the departure time of the next burst up to currentTime, the time
+  // the connection spent idle or app limited is not banked.
+  void catchUpTxTime(TimePoint currentTime);
+
   const QuicConnectionStateBase& conn_;
   uint64_t minCwndInMss_;
   uint64_t batchSize_;
@@ -56,5 +74,8 @@ class DefaultPacer : public Pacer {
   PacingRateCalculator pacingRateCalculator_;
   uint64_t cachedBatchSize_;
   uint64_t tokens_;
+  // Departure time of the current burst when the kernel paces the writes.
+  folly::Optional<TimePoint> nextTxTime_;
+  uint64_t packetsInBurst_{0};
 };
 } // namespace quic
@@ -50,6 +50,15 @@ uint64_t Cubic::getCongestionWindow() const noexcept {
   return cwndBytes_;
 }
 
+void Cubic::onCachedCongestionState(
+    const CachedCongestionState& state) noexcept {
+  // Hystart carries on from the larger window, so a path that got worse ends
+  // slow start at the first delay increase or loss as usual.
+  cwndBytes_ = cachedStateCwnd(conn_, state, cwndBytes_);
+  steadyState_.estRenoCwnd = cwndBytes_;
+  QUIC_TRACE(initcwnd, conn_, cwndBytes_);
+}
+
 /**
  * TODO: onPersistentCongestion entirely depends on how long a loss period is,
  * not how much a sender sends during that period. If the connection is app
@@ -109,16 +118,7 @@ void Cubic::onPacketLoss(const LossEvent& loss) {
   // as it was already accounted for in a recovery period.
   if (*loss.largestLostSentTime >=
       recoveryState_.endOfRecovery.value_or(*loss.largestLostSentTime)) {
-    recoveryState_.endOfRecovery = Clock::now();
-    cubicReduction(loss.lossTime);
-    if (state_ == CubicStates::Hystart || state_ == CubicStates::Steady) {
-      state_ = CubicStates::FastRecovery;
-    }
-    ssthresh_ = cwndBytes_;
-    if (conn_.pacer) {
-      conn_.pacer->refreshPacingRate(
-          cwndBytes_ * pacingGain(), conn_.lossState.srtt);
-    }
+    enterRecovery(loss.lossTime, steadyState_.reductionFactor);
     QUIC_TRACE(
         cubic_loss,
         conn_,
@@ -150,6 +150,45 @@ void Cubic::onPacketLoss(const LossEvent& loss) {
   }
 }
 
+void Cubic::enterRecovery(TimePoint reductionTime, float reductionFactor) {
+  recoveryState_.endOfRecovery = Clock::now();
+  cubicReduction(reductionTime, reductionFactor);
+  if (state_ == CubicStates::Hystart || state_ == CubicStates::Steady) {
+    state_ = CubicStates::FastRecovery;
+  }
+  ssthresh_ = cwndBytes_;
+  if (conn_.pacer) {
+    conn_.pacer->refreshPacingRate(
+        cwndBytes_ * pacingGain(), conn_.lossState.srtt);
+  }
+}
+
+void Cubic::onAckEcn(const AckEvent& ack) {
+  float reductionFactor = 1.0;
+  if (conn_.transportSettings.useL4sEcn) {
+    reductionFactor -= l4sResponse_.onAck(ack);
+  } else if (
+      ack.ecnCeCount > 0 &&
+      ack.largestAckedPacketSentTime >=
+          recoveryState_.endOfRecovery.value_or(
+              ack.largestAckedPacketSentTime)) {
+    // A CE mark is a loss that did not happen.
+    reductionFactor = steadyState_.reductionFactor;
+  }
+  if (reductionFactor >= 1.0) {
+    return;
+  }
+  quiescenceStart_ = folly::none;
+  enterRecovery(ack.ackTime, reductionFactor);
+  if (conn_.qLogger) {
+    conn_.qLogger->addCongestionMetricUpdate(
+        conn_.lossState.inflightBytes,
+        getCongestionWindow(),
+        kCongestionEcnCe,
+        cubicStateToString(state_).str());
+  }
+}
+
 void Cubic::onRemoveBytesFromInflight(uint64_t bytes) {
   DCHECK_LE(bytes, conn_.lossState.inflightBytes);
   conn_.lossState.inflightBytes -= bytes;
@@ -323,7 +362,9 @@ uint64_t Cubic::calculateCubicCwnd(int64_t delta) noexcept {
   }
 }
 
-void Cubic::cubicReduction(TimePoint lossTime) noexcept {
+void Cubic::cubicReduction(
+    TimePoint lossTime,
+    float reductionFactor) noexcept {
   if (cwndBytes_ >= steadyState_.lastMaxCwndBytes.value_or(cwndBytes_)) {
     steadyState_.lastMaxCwndBytes = cwndBytes_;
   } else {
@@ -336,7 +377,7 @@ void Cubic::cubicReduction(TimePoint lossTime) noexcept {
   lossCwndBytes_ = cwndBytes_;
   lossSsthresh_ = ssthresh_;
   cwndBytes_ = boundedCwnd(
-      cwndBytes_ * steadyState_.reductionFactor,
+      cwndBytes_ * reductionFactor,
       conn_.udpSendPacketLen,
       conn_.transportSettings.maxCwndInMss,
       conn_.transportSettings.minCwndInMss);
@@ -360,6 +401,9 @@ void Cubic::onPacketAckOrLoss(
   }
   if (ackEvent && ackEvent->largestAckedPacket.has_value()) {
     CHECK(!ackEvent->ackedPackets.empty());
+    if (conn_.transportSettings.enableEcn) {
+      onAckEcn(*ackEvent);
+    }
     onPacketAcked(*ackEvent);
   }
 }
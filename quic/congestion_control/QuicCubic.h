@@ -100,6 +100,9 @@ class Cubic : public CongestionController {
 
   bool isAppLimited() const noexcept override;
 
+  void onCachedCongestionState(
+      const CachedCongestionState& state) noexcept override;
+
   void handoff(uint64_t newCwnd, uint64_t newInflight) noexcept;
 
   CongestionControlType type() const noexcept override;
@@ -116,13 +119,15 @@ class Cubic : public CongestionController {
 
   void onPacketLoss(const LossEvent& loss);
   void onPacketLossInRecovery(const LossEvent& loss);
+  void onAckEcn(const AckEvent& ack);
+  void enterRecovery(TimePoint reductionTime, float reductionFactor);
   void onPersistentCongestion();
 
   float pacingGain() const noexcept;
 
   void startHystartRttRound(TimePoint time) noexcept;
 
-  void cubicReduction(TimePoint lossTime) noexcept;
+  void cubicReduction(TimePoint lossTime, float reductionFactor) noexcept;
   void updateTimeToOrigin() noexcept;
   int64_t calculateCubicCwndDelta(TimePoint timePoint) noexcept;
   uint64_t calculateCubicCwnd(int64_t delta) noexcept;
@@ -190,6 +195,7 @@ class Cubic : public CongestionController {
   HystartState hystartState_;
   SteadyState steadyState_;
   RecoveryState recoveryState_;
+  L4sCongestionResponse l4sResponse_;
 
   // When spreadAcrossRtt_ is set to true, the pacing writes will be distributed
   // evenly across an RTT. Otherwise, we will use the first N number of pacing
@@ -72,5 +72,29 @@ TEST_F(CongestionControlFunctionsTest, RttSmallerThanInterval) {
       conn.transportSettings.writeConnectionDataPacketsLimit, result.burstSize);
 }
 
+TEST_F(CongestionControlFunctionsTest, CachedStateCwnd) {
+  QuicConnectionStateBase conn(QuicNodeType::Server);
+  conn.udpSendPacketLen = 1000;
+  conn.transportSettings.maxCwndInMss = 200;
+  CachedCongestionState state;
+  state.cwndBytes = 100 * 1000;
+  // Half of the cached window.
+  EXPECT_EQ(50 * 1000, cachedStateCwnd(conn, state, 10 * 1000));
+
+  // No more than the bandwidth-delay product, 1MB/s for 20ms.
+  state.bandwidth = 1000 * 1000;
+  state.minRtt = 20ms;
+  EXPECT_EQ(20 * 1000, cachedStateCwnd(conn, state, 10 * 1000));
+
+  // Never below the initial window.
+  state.minRtt = 1ms;
+  EXPECT_EQ(10 * 1000, cachedStateCwnd(conn, state, 10 * 1000));
+
+  // Never above the max window.
+  state.bandwidth = 0;
+  state.cwndBytes = 1000 * 1000;
+  EXPECT_EQ(200 * 1000, cachedStateCwnd(conn, state, 10 * 1000));
+}
+
 } // namespace test
 } // namespace quic
@@ -40,6 +40,24 @@ TEST_F(CubicTest, AckIncreaseWritable) {
   EXPECT_EQ(initCwnd, cubic.getWritableBytes());
 }
 
+TEST_F(CubicTest, CachedCongestionState) {
+  QuicConnectionStateBase conn(QuicNodeType::Server);
+  Cubic cubic(conn);
+  auto initCwnd = cubic.getCongestionWindow();
+  CachedCongestionState state;
+  state.cwndBytes = initCwnd * 8;
+  cubic.onCachedCongestionState(state);
+  EXPECT_EQ(initCwnd * 4, cubic.getCongestionWindow());
+  EXPECT_EQ(initCwnd * 4, cubic.getWritableBytes());
+  EXPECT_EQ(CubicStates::Hystart, cubic.state());
+
+  // A smaller cached window leaves the initial one.
+  Cubic cubic2(conn);
+  state.cwndBytes = initCwnd;
+  cubic2.onCachedCongestionState(state);
+  EXPECT_EQ(initCwnd, cubic2.getCongestionWindow());
+}
+
 TEST_F(CubicTest, PersistentCongestion) {
   QuicConnectionStateBase conn(QuicNodeType::Client);
   auto qLogger = std::make_shared<FileQLogger>(VantagePoint::Client);
@@ -209,6 +209,44 @@ TEST_F(NewRenoTest, PersistentCongestion) {
   EXPECT_TRUE(reno.inSlowStart());
 }
 
+TEST_F(NewRenoTest, EcnCeReducesCwnd) {
+  QuicServerConnectionState conn;
+  conn.transportSettings.enableEcn = true;
+  NewReno reno(conn);
+  auto originalCwnd = reno.getCongestionWindow();
+
+  PacketNum ackPacketNum = 1;
+  uint32_t ackedSize = 10;
+  auto packet = createPacket(ackPacketNum, ackedSize, Clock::now());
+  reno.onPacketSent(packet);
+  auto ack = createAckEvent(ackPacketNum, ackedSize, packet.time);
+  ack.largestAckedPacketSentTime = packet.time;
+  ack.ecnMarkedPackets = 1;
+  ack.ecnCeCount = 1;
+  reno.onPacketAckOrLoss(ack, folly::none);
+  EXPECT_EQ(originalCwnd / 2, reno.getCongestionWindow());
+  EXPECT_FALSE(reno.inSlowStart());
+}
+
+TEST_F(NewRenoTest, L4sEcnWithoutCe) {
+  QuicServerConnectionState conn;
+  conn.transportSettings.enableEcn = true;
+  conn.transportSettings.useL4sEcn = true;
+  NewReno reno(conn);
+  auto originalCwnd = reno.getCongestionWindow();
+
+  PacketNum ackPacketNum = 1;
+  uint32_t ackedSize = 10;
+  auto packet = createPacket(ackPacketNum, ackedSize, Clock::now());
+  reno.onPacketSent(packet);
+  auto ack = createAckEvent(ackPacketNum, ackedSize, packet.time);
+  ack.largestAckedPacketSentTime = packet.time;
+  ack.ecnMarkedPackets = 1;
+  reno.onPacketAckOrLoss(ack, folly::none);
+  EXPECT_EQ(originalCwnd + ackedSize, reno.getCongestionWindow());
+  EXPECT_TRUE(reno.inSlowStart());
+}
+
 TEST_F(NewRenoTest, RemoveBytesWithoutLossOrAck) {
   QuicServerConnectionState conn;
   NewReno reno(conn);
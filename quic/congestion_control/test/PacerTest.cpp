@@ -7,7 +7,15 @@
  */
 
 #include <quic/congestion_control/Pacer.h>
+
 #include <folly/portability/GTest.h>
+#include <quic/common/SocketUtil.h>
+
+#include <cstring>
+
+#if defined(__linux__) && !defined(SCM_TXTIME)
+#define SCM_TXTIME 61
+#endif
 
 using namespace testing;
 
@@ -20,6 +28,20 @@ void consumeTokensHelper(Pacer& pacer, size_t tokensToConsume) {
     pacer.onPacketSent();
   }
 }
+
+PacingRateCalculator fixedRate(
+    std::chrono::microseconds interval,
+    uint64_t burstSize) {
+  return [=](const QuicConnectionStateBase&,
+             uint64_t,
+             uint64_t,
+             std::chrono::microseconds) {
+    return PacingRate::Builder()
+        .setInterval(interval)
+        .setBurstSize(burstSize)
+        .build();
+  };
+}
 } // namespace
 
 class PacerTest : public Test {
@@ -194,5 +216,103 @@ TEST_F(PacerTest, Tokens) {
   EXPECT_EQ(20, pacer.updateAndGetWriteBatchSize(curTime + 20ms));
 }
 
+TEST_F(PacerTest, TxTimeBursts) {
+  conn.transportSettings.txTimePacing = true;
+  pacer.setPacingRateCalculator(fixedRate(1ms, 10));
+  pacer.refreshPacingRate(100, 100ms);
+  auto currentTime = Clock::now();
+  EXPECT_EQ(currentTime, pacer.getTxTime(currentTime));
+  consumeTokensHelper(pacer, 9);
+  EXPECT_EQ(currentTime, pacer.getTxTime(currentTime));
+  consumeTokensHelper(pacer, 1);
+  EXPECT_EQ(currentTime + 1ms, pacer.getTxTime(currentTime));
+  consumeTokensHelper(pacer, 10);
+  EXPECT_EQ(currentTime + 2ms, pacer.getTxTime(currentTime));
+
+  // The time the connection did not write is not banked.
+  EXPECT_EQ(currentTime + 1s, pacer.getTxTime(currentTime + 1s));
+}
+
+TEST_F(PacerTest, TxTimeWriteBatchSize) {
+  conn.transportSettings.txTimePacing = true;
+  conn.transportSettings.txTimePacingHorizon = 5ms;
+  pacer.setPacingRateCalculator(fixedRate(1ms, 10));
+  pacer.refreshPacingRate(100, 100ms);
+  auto currentTime = Clock::now();
+  // The bursts at 0, 1, ..., 5ms are within the horizon.
+  EXPECT_EQ(60, pacer.updateAndGetWriteBatchSize(currentTime));
+  consumeTokensHelper(pacer, 15);
+  EXPECT_EQ(45, pacer.updateAndGetWriteBatchSize(currentTime));
+  consumeTokensHelper(pacer, 45);
+  EXPECT_EQ(0, pacer.updateAndGetWriteBatchSize(currentTime));
+  EXPECT_EQ(10, pacer.updateAndGetWriteBatchSize(currentTime + 1ms));
+  // The next burst enters the horizon in at most 1ms.
+  EXPECT_LE(pacer.getTimeUntilNextWrite(), 1ms);
+
+  // The horizon is capped by the RTT.
+  conn.lossState.srtt = 2ms;
+  EXPECT_EQ(30, pacer.updateAndGetWriteBatchSize(currentTime + 10ms));
+}
+
+TEST_F(PacerTest, TxTimeDisabled) {
+  pacer.setPacingRateCalculator(fixedRate(1ms, 10));
+  pacer.refreshPacingRate(100, 100ms);
+  EXPECT_FALSE(pacer.getTxTime(Clock::now()).has_value());
+
+  // Nothing to pace below the timer tick.
+  conn.transportSettings.txTimePacing = true;
+  conn.transportSettings.pacingTimerTickInterval = 1ms;
+  pacer.refreshPacingRate(100, 100us);
+  EXPECT_FALSE(pacer.getTxTime(Clock::now()).has_value());
+}
+
+#ifdef __linux__
+TEST_F(PacerTest, TxTimeControlMessages) {
+  conn.transportSettings.txTimePacing = true;
+  const auto interval = 250us;
+  const uint64_t burstSize = 4;
+  pacer.setPacingRateCalculator(fixedRate(interval, burstSize));
+  pacer.refreshPacingRate(100, 100ms);
+
+  // Stamp the packets the way the batch writers do, and read the departure
+  // times back from the control messages.
+  auto currentTime = Clock::now();
+  std::vector<uint64_t> txTimes;
+  for (size_t i = 0; i < 5 * burstSize; ++i) {
+    struct msghdr msg {};
+    char control[kUdpControlMessagesSize];
+    UdpWriteOptions options;
+    options.gso = 1200;
+    options.txTime = pacer.getTxTime(currentTime);
+    setUdpControlMessages(
+        msg, control, folly::SocketAddress("::1", 443), options);
+    folly::Optional<uint64_t> txTime;
+    for (auto cm = CMSG_FIRSTHDR(&msg); cm; cm = CMSG_NXTHDR(&msg, cm)) {
+      if (cm->cmsg_level == SOL_SOCKET && cm->cmsg_type == SCM_TXTIME) {
+        ASSERT_EQ(CMSG_LEN(sizeof(uint64_t)), cm->cmsg_len);
+        uint64_t value;
+        memcpy(&value, CMSG_DATA(cm), sizeof(value));
+        txTime = value;
+      }
+    }
+    ASSERT_TRUE(txTime.has_value());
+    txTimes.push_back(*txTime);
+    pacer.onPacketSent();
+  }
+
+  uint64_t start = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                       currentTime.time_since_epoch())
+                       .count();
+  uint64_t intervalNs =
+      std::chrono::duration_cast<std::chrono::nanoseconds>(interval).count();
+  for (size_t i = 0; i < txTimes.size(); ++i) {
+    EXPECT_EQ(start + (i / burstSize) * intervalNs, txTimes[i]);
+  }
+  // The bursts leave at the pacing rate.
+  auto elapsed = std::chrono::nanoseconds(txTimes.back() - txTimes.front());
+  EXPECT_EQ(4 * interval, elapsed);
+}
+#endif
+
 } // namespace test
 } // namespace quic
@@ -61,6 +61,16 @@ class FizzClientExtensions : public fizz::ClientExtensions {
           TransportParameterId::initial_source_connection_id,
           clientParameters_->initialSourceCid_));
     }
+    if (clientParameters_->maxDatagramFrameSize_ > 0) {
+      params.parameters.push_back(encodeIntegerParameter(
+          TransportParameterId::max_datagram_frame_size,
+          clientParameters_->maxDatagramFrameSize_));
+    }
+    if (clientParameters_->minAckDelay_ > 0) {
+      params.parameters.push_back(encodeIntegerParameter(
+          TransportParameterId::min_ack_delay,
+          clientParameters_->minAckDelay_));
+    }
 
     for (const auto& customParameter :
          clientParameters_->customTransportParameters_) {
@@ -27,6 +27,10 @@ class FizzClientHandshake : public ClientHandshake {
 
   void removePsk(const folly::Optional<std::string>& hostname) override;
 
+  void updatePskCongestionState(
+      const folly::Optional<std::string>& hostname,
+      const CachedCongestionState& state) override;
+
   const CryptoFactory& getCryptoFactory() const override;
 
   const folly::Optional<std::string>& getApplicationProtocol() const override;
@@ -3071,6 +3071,25 @@ TEST_F(
   client->setReadCallback(streamId, nullptr);
 }
 
+TEST_F(QuicClientTransportAfterStartTest, RecvNewToken) {
+  auto& conn = client->getNonConstConn();
+  ShortHeader header(ProtectionType::KeyPhaseZero, *conn.clientConnectionId, 1);
+  RegularQuicPacketBuilder builder(
+      conn.udpSendPacketLen, std::move(header), 0 /* largestAcked */);
+  builder.encodePacketHeader();
+  ASSERT_TRUE(builder.canBuildPacket());
+
+  std::string token = "new token";
+  writeSimpleFrame(QuicSimpleFrame(NewTokenFrame(token)), builder);
+
+  auto packet = std::move(builder).buildPacket();
+  auto data = packetToBuf(packet);
+
+  EXPECT_TRUE(client->getNewToken().empty());
+  deliverData(data->coalesce(), false);
+  EXPECT_EQ(client->getNewToken(), token);
+}
+
 TEST_F(QuicClientTransportAfterStartTest, RecvNewConnectionIdValid) {
   auto& conn = client->getNonConstConn();
   conn.transportSettings.selfActiveConnectionIdLimit = 1;
@@ -3932,6 +3951,7 @@ TEST_F(QuicClientTransportAfterStartTest, IdleTimerResetNoOutstandingPackets) {
 TEST_F(QuicClientTransportAfterStartTest, IdleTimeoutExpired) {
   EXPECT_CALL(*sock, close());
   socketWrites.clear();
+  client->idleTimeout().setDeadline(Clock::now());
   client->idleTimeout().timeoutExpired();
 
   EXPECT_FALSE(client->idleTimeout().isScheduled());
@@ -3953,6 +3973,7 @@ TEST_F(QuicClientTransportAfterStartTest, RecvDataAfterIdleTimeout) {
   auto qLogger = std::make_shared<FileQLogger>(VantagePoint::Client);
   client->getNonConstConn().qLogger = qLogger;
   EXPECT_CALL(*sock, close());
+  client->idleTimeout().setDeadline(Clock::now());
   client->idleTimeout().timeoutExpired();
 
   socketWrites.clear();
@@ -4452,6 +4473,57 @@ TEST_F(QuicClientTransportVersionAndRetryTest, RetryPacket) {
   client->close(folly::none);
 }
 
+TEST_F(QuicClientTransportVersionAndRetryTest, RetryPacketFromBuilder) {
+  ConnectionId clientConnId(std::vector<uint8_t>{});
+  ConnectionId initialDstConnId(
+      {0x83, 0x94, 0xc8, 0xf0, 0x3e, 0x51, 0x57, 0x08});
+  client->getNonConstConn().readCodec->setClientConnectionId(clientConnId);
+  client->getNonConstConn().initialDestinationConnectionId = initialDstConnId;
+
+  StreamId streamId = *client->createBidirectionalStream();
+  client->writeChain(
+      streamId, IOBuf::copyBuffer("ice cream"), true, false, nullptr);
+  loopForWrites();
+
+  std::unique_ptr<IOBuf> bytesWrittenToNetwork = nullptr;
+  EXPECT_CALL(*sock, write(_, _))
+      .WillRepeatedly(Invoke(
+          [&](const SocketAddress&, const std::unique_ptr<folly::IOBuf>& buf) {
+            bytesWrittenToNetwork = buf->clone();
+            return buf->computeChainDataLength();
+          }));
+
+  // The Retry of the server carries the integrity tag the client verifies.
+  ConnectionId serverChosenConnId(
+      {0xf0, 0x67, 0xa5, 0x50, 0x2a, 0x42, 0x62, 0xb5});
+  std::string retryToken = "token";
+  auto integrityAead = FizzCryptoFactory().makeRetryIntegrityAead();
+  RetryPacketBuilder builder(
+      serverChosenConnId,
+      clientConnId,
+      QuicVersion::QUIC_DRAFT,
+      retryToken,
+      initialDstConnId,
+      *integrityAead);
+  auto retryPacket = std::move(builder).buildPacket();
+  deliverData(retryPacket->coalesce());
+
+  ASSERT_TRUE(bytesWrittenToNetwork);
+  AckStates ackStates;
+  auto packetQueue = bufToQueue(bytesWrittenToNetwork->clone());
+  auto codecResult =
+      makeEncryptedCodec(true)->parsePacket(packetQueue, ackStates);
+  auto& header = *codecResult.regularPacket()->header.asLong();
+  EXPECT_EQ(header.getHeaderType(), LongHeader::Types::Initial);
+  EXPECT_EQ(header.getToken(), retryToken);
+  EXPECT_EQ(header.getDestinationConnId(), serverChosenConnId);
+  EXPECT_EQ(
+      client->getConn().originalDestinationConnectionId, initialDstConnId);
+
+  eventbase_->loopOnce();
+  client->close(folly::none);
+}
+
 TEST_F(
     QuicClientTransportVersionAndRetryTest,
     VersionNegotiationPacketNotSupported) {
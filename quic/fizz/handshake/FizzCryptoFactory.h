@@ -33,6 +33,12 @@ class FizzCryptoFactory : public CryptoFactory {
   virtual std::unique_ptr<PacketNumberCipher> makePacketNumberCipher(
       fizz::CipherSuite cipher) const;
 
+  /**
+   * The aead of the integrity tag of Retry packets, its key and nonce are
+   * fixed by the QUIC-TLS draft.
+   */
+  std::unique_ptr<Aead> makeRetryIntegrityAead() const;
+
   std::shared_ptr<fizz::Factory> getFizzFactory() {
     return fizzFactory_;
   }
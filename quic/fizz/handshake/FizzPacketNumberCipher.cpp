@@ -8,6 +8,8 @@
 
 #include <quic/fizz/handshake/FizzPacketNumberCipher.h>
 
+#include <openssl/aes.h>
+
 namespace quic {
 
 static void setKeyImpl(
@@ -43,6 +45,33 @@ static HeaderProtectionMask maskImpl(
   return outMask;
 }
 
+static void masksImpl(
+    const folly::ssl::EvpCipherCtxUniquePtr& context,
+    const Sample* samples,
+    HeaderProtectionMask* masksOut,
+    size_t numSamples) {
+  static_assert(
+      sizeof(Sample) == sizeof(HeaderProtectionMask) &&
+          sizeof(Sample) == AES_BLOCK_SIZE,
+      "A sample must be one AES block");
+  if (numSamples == 0) {
+    return;
+  }
+  // The samples and masks are arrays of blocks. ECB encrypts all of them in one
+  // call, which lets AES-NI work on several blocks in parallel.
+  int inLen = static_cast<int>(numSamples * AES_BLOCK_SIZE);
+  int outLen = 0;
+  if (EVP_EncryptUpdate(
+          context.get(),
+          masksOut[0].data(),
+          &outLen,
+          samples[0].data(),
+          inLen) != 1 ||
+      outLen != inLen) {
+    throw std::runtime_error("Encryption error");
+  }
+}
+
 void Aes128PacketNumberCipher::setKey(folly::ByteRange key) {
   return setKeyImpl(encryptCtx_, EVP_aes_128_ecb(), key);
 }
@@ -61,6 +90,20 @@ HeaderProtectionMask Aes256PacketNumberCipher::mask(
   return maskImpl(encryptCtx_, sample);
 }
 
+void Aes128PacketNumberCipher::masks(
+    const Sample* samples,
+    HeaderProtectionMask* masksOut,
+    size_t numSamples) const {
+  masksImpl(encryptCtx_, samples, masksOut, numSamples);
+}
+
+void Aes256PacketNumberCipher::masks(
+    const Sample* samples,
+    HeaderProtectionMask* masksOut,
+    size_t numSamples) const {
+  masksImpl(encryptCtx_, samples, masksOut, numSamples);
+}
+
 constexpr size_t kAES128KeyLength = 16;
 
 size_t Aes128PacketNumberCipher::keyLength() const {
@@ -22,6 +22,11 @@ class Aes128PacketNumberCipher : public PacketNumberCipher {
 
   HeaderProtectionMask mask(folly::ByteRange sample) const override;
 
+  void masks(
+      const Sample* samples,
+      HeaderProtectionMask* masksOut,
+      size_t numSamples) const override;
+
   size_t keyLength() const override;
 
  private:
@@ -36,6 +41,11 @@ class Aes256PacketNumberCipher : public PacketNumberCipher {
 
   HeaderProtectionMask mask(folly::ByteRange sample) const override;
 
+  void masks(
+      const Sample* samples,
+      HeaderProtectionMask* masksOut,
+      size_t numSamples) const override;
+
   size_t keyLength() const override;
 
  private:
@@ -89,6 +89,37 @@ TEST_P(LongPacketNumberCipherTest, TestEncryptDecrypt) {
       GetParam().decryptedPacketNumberBytes);
 }
 
+TEST_P(LongPacketNumberCipherTest, TestBatchMasks) {
+  FizzCryptoFactory cryptoFactory;
+  auto cipher = cryptoFactory.makePacketNumberCipher(GetParam().cipher);
+  auto key = folly::unhexlify(GetParam().key);
+  cipher->setKey(folly::range(key));
+  constexpr size_t kNumSamples = 9;
+  std::array<Sample, kNumSamples> samples;
+  for (size_t i = 0; i < kNumSamples; ++i) {
+    samples[i] = hexToBytes<SampleBytes>(GetParam().sample);
+    samples[i][0] += i;
+  }
+  std::array<HeaderProtectionMask, kNumSamples> masks;
+  cipher->masks(samples.data(), masks.data(), kNumSamples);
+  for (size_t i = 0; i < kNumSamples; ++i) {
+    EXPECT_EQ(masks[i], cipher->mask(folly::range(samples[i])));
+  }
+
+  CipherBytes cipherBytes(
+      GetParam().sample,
+      GetParam().decryptedInitialByte,
+      GetParam().decryptedPacketNumberBytes);
+  cipher->masks(&cipherBytes.sample, masks.data(), 1);
+  cipher->encryptLongHeaderWithMask(
+      masks[0],
+      folly::range(cipherBytes.initial),
+      folly::range(cipherBytes.packetNumber));
+  EXPECT_EQ(folly::hexlify(cipherBytes.initial), GetParam().initialByte);
+  EXPECT_EQ(
+      folly::hexlify(cipherBytes.packetNumber), GetParam().packetNumberBytes);
+}
+
 INSTANTIATE_TEST_CASE_P(
     LongPacketNumberCipherTests,
     LongPacketNumberCipherTest,
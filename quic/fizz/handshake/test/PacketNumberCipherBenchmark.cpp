@@ -0,0 +1,94 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ *
+ */
+
+#include <folly/Benchmark.h>
+#include <folly/String.h>
+#include <folly/init/Init.h>
+
+#include <quic/fizz/handshake/FizzPacketNumberCipher.h>
+
+#include <algorithm>
+#include <vector>
+
+using namespace quic;
+
+namespace {
+
+// Each iteration is the mask of one packet, the packets come in batches of
+// batchSize like the ones of a GSO write or a recvmmsg read.
+
+std::unique_ptr<PacketNumberCipher> makeCipher() {
+  auto cipher = std::make_unique<Aes128PacketNumberCipher>();
+  auto key = folly::unhexlify("0edd982a6ac527f2eddcbb7348dea5d7");
+  cipher->setKey(folly::range(key));
+  return cipher;
+}
+
+std::vector<Sample> makeSamples(size_t numSamples) {
+  std::vector<Sample> samples(numSamples);
+  for (size_t i = 0; i < numSamples; ++i) {
+    for (size_t j = 0; j < samples[i].size(); ++j) {
+      samples[i][j] = static_cast<uint8_t>(i * 31 + j);
+    }
+  }
+  return samples;
+}
+
+void maskOneByOne(uint32_t iters, size_t batchSize) {
+  std::unique_ptr<PacketNumberCipher> cipher;
+  std::vector<Sample> samples;
+  std::vector<HeaderProtectionMask> masks(batchSize);
+  BENCHMARK_SUSPEND {
+    cipher = makeCipher();
+    samples = makeSamples(batchSize);
+  }
+  while (iters > 0) {
+    size_t numPackets = std::min<size_t>(iters, batchSize);
+    for (size_t i = 0; i < numPackets; ++i) {
+      masks[i] = cipher->mask(folly::range(samples[i]));
+    }
+    iters -= numPackets;
+  }
+  folly::doNotOptimizeAway(masks);
+}
+
+void maskBatched(uint32_t iters, size_t batchSize) {
+  std::unique_ptr<PacketNumberCipher> cipher;
+  std::vector<Sample> samples;
+  std::vector<HeaderProtectionMask> masks(batchSize);
+  BENCHMARK_SUSPEND {
+    cipher = makeCipher();
+    samples = makeSamples(batchSize);
+  }
+  while (iters > 0) {
+    size_t numPackets = std::min<size_t>(iters, batchSize);
+    cipher->masks(samples.data(), masks.data(), numPackets);
+    iters -= numPackets;
+  }
+  folly::doNotOptimizeAway(masks);
+}
+
+} // namespace
+
+BENCHMARK_PARAM(maskOneByOne, 1)
+BENCHMARK_RELATIVE_PARAM(maskBatched, 1)
+BENCHMARK_DRAW_LINE();
+BENCHMARK_PARAM(maskOneByOne, 8)
+BENCHMARK_RELATIVE_PARAM(maskBatched, 8)
+BENCHMARK_DRAW_LINE();
+BENCHMARK_PARAM(maskOneByOne, 16)
+BENCHMARK_RELATIVE_PARAM(maskBatched, 16)
+BENCHMARK_DRAW_LINE();
+BENCHMARK_PARAM(maskOneByOne, 64)
+BENCHMARK_RELATIVE_PARAM(maskBatched, 64)
+
+int main(int argc, char** argv) {
+  folly::init(&argc, &argv);
+  folly::runBenchmarks();
+  return 0;
+}
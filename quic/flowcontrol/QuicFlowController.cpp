@@ -53,6 +53,88 @@ inline void incrementWithOverFlowCheck(T& num, T diff) {
   num += diff;
 }
 
+/**
+ * Whether a window the peer used up by updateTime should grow. It should when
+ * the previous update for it went out less than flowControlRttFrequency RTTs
+ * ago: the peer then consumes the window faster than once per RTT, so the
+ * window, not the congestion controller, is what limits the peer.
+ */
+bool shouldAutoTuneWindow(
+    const std::chrono::microseconds& srtt,
+    const TransportSettings& transportSettings,
+    const folly::Optional<TimePoint>& lastSendTime,
+    const TimePoint& updateTime) {
+  if (!transportSettings.autoTuneReceiveWindows || !lastSendTime ||
+      srtt == 0us || updateTime <= *lastSendTime) {
+    return false;
+  }
+  return (updateTime - *lastSendTime) <
+      transportSettings.flowControlRttFrequency * srtt;
+}
+
+void growConnWindow(QuicConnectionStateBase& conn, uint64_t targetSize) {
+  auto& flowControlState = conn.flowControlState;
+  targetSize = std::min(
+      targetSize, conn.transportSettings.maxAutoTunedConnectionWindowSize);
+  if (targetSize <= flowControlState.windowSize) {
+    return;
+  }
+  auto growth = targetSize - flowControlState.windowSize;
+  auto reserved = conn.receiveWindowReservation.reserve(growth);
+  if (reserved < growth) {
+    QUIC_STATS(conn.statsCallback, onConnFlowControlWindowGrowthLimited);
+  }
+  if (reserved == 0) {
+    return;
+  }
+  flowControlState.windowSize += reserved;
+  VLOG(4) << "Auto-tuned conn window=" << flowControlState.windowSize;
+  QUIC_STATS(
+      conn.statsCallback,
+      onConnFlowControlWindowGrowth,
+      flowControlState.windowSize);
+}
+
+void maybeAutoTuneConnWindow(
+    QuicConnectionStateBase& conn,
+    TimePoint updateTime) {
+  if (shouldAutoTuneWindow(
+          conn.lossState.srtt,
+          conn.transportSettings,
+          conn.flowControlState.timeOfLastFlowControlUpdate,
+          updateTime)) {
+    growConnWindow(conn, conn.flowControlState.windowSize * 2);
+  }
+}
+
+void maybeAutoTuneStreamWindow(QuicStreamState& stream, TimePoint updateTime) {
+  auto& flowControlState = stream.flowControlState;
+  const auto& transportSettings = stream.conn.transportSettings;
+  if (!shouldAutoTuneWindow(
+          stream.conn.lossState.srtt,
+          transportSettings,
+          flowControlState.timeOfLastFlowControlUpdate,
+          updateTime)) {
+    return;
+  }
+  auto targetSize = std::min(
+      flowControlState.windowSize * 2,
+      transportSettings.maxAutoTunedStreamWindowSize);
+  if (targetSize <= flowControlState.windowSize) {
+    return;
+  }
+  // The stream windows are bounded by the connection window, only the growth
+  // of the latter is charged to the budget.
+  flowControlState.windowSize = targetSize;
+  VLOG(4) << "Auto-tuned stream=" << stream.id << " window=" << targetSize;
+  QUIC_STATS(
+      stream.conn.statsCallback, onStreamFlowControlWindowGrowth, targetSize);
+  growConnWindow(
+      stream.conn,
+      static_cast<uint64_t>(
+          targetSize * kAutoTunedConnectionToStreamWindowRatio));
+}
+
 inline uint64_t calculateMaximumData(const QuicStreamState& stream) {
   return std::max(
       stream.currentReadOffset + stream.flowControlState.windowSize,
@@ -78,6 +160,7 @@ bool maybeSendConnWindowUpdate(
       flowControlState.timeOfLastFlowControlUpdate,
       updateTime);
   if (newAdvertisedOffset) {
+    maybeAutoTuneConnWindow(conn, updateTime);
     conn.pendingEvents.connWindowUpdate = true;
     QUIC_STATS(conn.statsCallback, onConnFlowControlUpdate);
     if (conn.qLogger) {
@@ -109,6 +192,7 @@ bool maybeSendStreamWindowUpdate(
       flowControlState.timeOfLastFlowControlUpdate,
       updateTime);
   if (newAdvertisedOffset) {
+    maybeAutoTuneStreamWindow(stream, updateTime);
     VLOG(10) << "Queued flow control update for stream=" << stream.id
              << " offset=" << *newAdvertisedOffset;
     stream.conn.streamManager->queueWindowUpdate(stream.id);
@@ -871,5 +871,114 @@ TEST_F(QuicFlowControlTest, OnStreamWindowUpdateSentWithoutPendingEvent) {
   EXPECT_FALSE(conn_.streamManager->pendingWindowUpdate(id));
 }
 
+TEST_F(QuicFlowControlTest, AutoTuneConnWindow) {
+  conn_.transportSettings.autoTuneReceiveWindows = true;
+  conn_.lossState.srtt = 100ms;
+  conn_.flowControlState.windowSize = 500;
+  conn_.flowControlState.advertisedMaxOffset = 500;
+  conn_.flowControlState.sumCurReadOffset = 300;
+  auto lastUpdateTime = Clock::now();
+  conn_.flowControlState.timeOfLastFlowControlUpdate = lastUpdateTime;
+
+  // The peer used up the window within 2 RTTs of the last update.
+  EXPECT_CALL(*transportInfoCb_, onConnFlowControlUpdate());
+  EXPECT_CALL(*transportInfoCb_, onConnFlowControlWindowGrowth(1000));
+  EXPECT_TRUE(maybeSendConnWindowUpdate(conn_, lastUpdateTime + 50ms));
+  EXPECT_EQ(1000, conn_.flowControlState.windowSize);
+  EXPECT_EQ(1300, generateMaxDataFrame(conn_).maximumData);
+  EXPECT_EQ(500, conn_.receiveWindowReservation.bytes());
+}
+
+TEST_F(QuicFlowControlTest, NoAutoTuneConnWindowWhenSlowlyConsumed) {
+  conn_.transportSettings.autoTuneReceiveWindows = true;
+  conn_.lossState.srtt = 100ms;
+  conn_.flowControlState.windowSize = 500;
+  conn_.flowControlState.advertisedMaxOffset = 500;
+  conn_.flowControlState.sumCurReadOffset = 300;
+  auto lastUpdateTime = Clock::now();
+  conn_.flowControlState.timeOfLastFlowControlUpdate = lastUpdateTime;
+
+  EXPECT_CALL(*transportInfoCb_, onConnFlowControlUpdate());
+  EXPECT_CALL(*transportInfoCb_, onConnFlowControlWindowGrowth(_)).Times(0);
+  EXPECT_TRUE(maybeSendConnWindowUpdate(conn_, lastUpdateTime + 300ms));
+  EXPECT_EQ(500, conn_.flowControlState.windowSize);
+}
+
+TEST_F(QuicFlowControlTest, AutoTuneConnWindowMaxSize) {
+  conn_.transportSettings.autoTuneReceiveWindows = true;
+  conn_.transportSettings.maxAutoTunedConnectionWindowSize = 800;
+  conn_.lossState.srtt = 100ms;
+  conn_.flowControlState.windowSize = 500;
+  conn_.flowControlState.advertisedMaxOffset = 500;
+  conn_.flowControlState.sumCurReadOffset = 300;
+  auto lastUpdateTime = Clock::now();
+  conn_.flowControlState.timeOfLastFlowControlUpdate = lastUpdateTime;
+
+  EXPECT_CALL(*transportInfoCb_, onConnFlowControlUpdate());
+  EXPECT_CALL(*transportInfoCb_, onConnFlowControlWindowGrowth(800));
+  EXPECT_TRUE(maybeSendConnWindowUpdate(conn_, lastUpdateTime + 50ms));
+  EXPECT_EQ(800, conn_.flowControlState.windowSize);
+}
+
+TEST_F(QuicFlowControlTest, AutoTuneConnWindowBudget) {
+  auto budget = std::make_shared<ReceiveWindowBudget>(700);
+  {
+    QuicConnectionStateBase otherConn(QuicNodeType::Server);
+    otherConn.receiveWindowReservation.setBudget(budget);
+    EXPECT_EQ(600, otherConn.receiveWindowReservation.reserve(600));
+    conn_.receiveWindowReservation.setBudget(budget);
+
+    conn_.transportSettings.autoTuneReceiveWindows = true;
+    conn_.lossState.srtt = 100ms;
+    conn_.flowControlState.windowSize = 500;
+    conn_.flowControlState.advertisedMaxOffset = 500;
+    conn_.flowControlState.sumCurReadOffset = 300;
+    auto lastUpdateTime = Clock::now();
+    conn_.flowControlState.timeOfLastFlowControlUpdate = lastUpdateTime;
+
+    EXPECT_CALL(*transportInfoCb_, onConnFlowControlUpdate());
+    EXPECT_CALL(*transportInfoCb_, onConnFlowControlWindowGrowthLimited());
+    EXPECT_CALL(*transportInfoCb_, onConnFlowControlWindowGrowth(600));
+    EXPECT_TRUE(maybeSendConnWindowUpdate(conn_, lastUpdateTime + 50ms));
+    EXPECT_EQ(600, conn_.flowControlState.windowSize);
+    EXPECT_EQ(700, budget->used());
+  }
+  // The other connection gave its share back.
+  EXPECT_EQ(100, budget->used());
+}
+
+TEST_F(QuicFlowControlTest, AutoTuneStreamWindow) {
+  conn_.transportSettings.autoTuneReceiveWindows = true;
+  conn_.lossState.srtt = 100ms;
+  conn_.flowControlState.windowSize = 1000;
+  StreamId id = 3;
+  QuicStreamState stream(id, conn_);
+  stream.currentReadOffset = 300;
+  stream.flowControlState.windowSize = 500;
+  stream.flowControlState.advertisedMaxOffset = 500;
+  auto lastUpdateTime = Clock::now();
+  stream.flowControlState.timeOfLastFlowControlUpdate = lastUpdateTime;
+
+  EXPECT_CALL(*transportInfoCb_, onStreamFlowControlUpdate());
+  EXPECT_CALL(*transportInfoCb_, onStreamFlowControlWindowGrowth(1000));
+  // The connection window stays ahead of the stream window.
+  EXPECT_CALL(*transportInfoCb_, onConnFlowControlWindowGrowth(1500));
+  EXPECT_TRUE(maybeSendStreamWindowUpdate(stream, lastUpdateTime + 50ms));
+  EXPECT_EQ(1000, stream.flowControlState.windowSize);
+  EXPECT_EQ(1300, generateMaxStreamDataFrame(stream).maximumData);
+  EXPECT_EQ(1500, conn_.flowControlState.windowSize);
+
+  // Capped by the largest stream window.
+  conn_.transportSettings.maxAutoTunedStreamWindowSize = 1000;
+  stream.currentReadOffset = 1300;
+  stream.flowControlState.advertisedMaxOffset = 1300;
+  stream.flowControlState.timeOfLastFlowControlUpdate = lastUpdateTime;
+  conn_.streamManager->removeWindowUpdate(id);
+  EXPECT_CALL(*transportInfoCb_, onStreamFlowControlUpdate());
+  EXPECT_CALL(*transportInfoCb_, onStreamFlowControlWindowGrowth(_)).Times(0);
+  EXPECT_TRUE(maybeSendStreamWindowUpdate(stream, lastUpdateTime + 50ms));
+  EXPECT_EQ(1000, stream.flowControlState.windowSize);
+}
+
 } // namespace test
 } // namespace quic
@@ -65,12 +65,70 @@ void addQuicSimpleFrameToEvent(
       event->frames.push_back(std::make_unique<quic::HandshakeDoneFrameLog>());
       break;
     }
+    case quic::QuicSimpleFrame::Type::AckFrequencyFrame_E: {
+      const quic::AckFrequencyFrame& frame = *simpleFrame.asAckFrequencyFrame();
+      event->frames.push_back(std::make_unique<quic::AckFrequencyFrameLog>(
+          frame.sequenceNumber,
+          frame.packetTolerance,
+          frame.updateMaxAckDelay,
+          frame.ignoreOrder));
+      break;
+    }
+    case quic::QuicSimpleFrame::Type::ImmediateAckFrame_E: {
+      event->frames.push_back(std::make_unique<quic::ImmediateAckFrameLog>());
+      break;
+    }
+    case quic::QuicSimpleFrame::Type::NewTokenFrame_E: {
+      event->frames.push_back(std::make_unique<quic::ReadNewTokenFrameLog>());
+      break;
+    }
   }
 }
 } // namespace
 
 namespace quic {
 
+folly::dynamic BaseQLogger::toDynamicBase() const {
+  return traceToDynamic(*this);
+}
+
+folly::dynamic BaseQLogger::traceToDynamic(const QLogger& qLogger) {
+  folly::dynamic dynamicObj = folly::dynamic::object;
+  dynamicObj[kQLogVersionField] = kQLogVersion;
+  dynamicObj[kQLogTitleField] = kQLogTitle;
+  dynamicObj[kQLogDescriptionField] = kQLogDescription;
+
+  dynamicObj["traces"] = folly::dynamic::array();
+  folly::dynamic dynamicTrace = folly::dynamic::object;
+
+  dynamicTrace["vantage_point"] =
+      folly::dynamic::object("type", vantagePointString(qLogger.vantagePoint))(
+          "name", vantagePointString(qLogger.vantagePoint));
+  dynamicTrace["title"] = kQLogTraceTitle;
+  dynamicTrace["description"] = kQLogTraceDescription;
+  dynamicTrace["configuration"] =
+      folly::dynamic::object("time_offset", 0)("time_units", kQLogTimeUnits);
+
+  std::string dcidStr =
+      qLogger.dcid.has_value() ? qLogger.dcid.value().hex() : "";
+  std::string scidStr =
+      qLogger.scid.has_value() ? qLogger.scid.value().hex() : "";
+  folly::dynamic commonFieldsObj = folly::dynamic::object;
+  commonFieldsObj["reference_time"] = "0";
+  commonFieldsObj["dcid"] = dcidStr;
+  commonFieldsObj["scid"] = scidStr;
+  commonFieldsObj["protocol_type"] = qLogger.protocolType;
+  dynamicTrace["common_fields"] = std::move(commonFieldsObj);
+
+  dynamicTrace["events"] = folly::dynamic::array();
+  dynamicTrace["event_fields"] =
+      folly::dynamic::array("relative_time", "category", "event", "data");
+
+  dynamicObj["traces"].push_back(dynamicTrace);
+
+  return dynamicObj;
+}
+
 std::unique_ptr<QLogPacketEvent> BaseQLogger::createPacketEvent(
     const RegularQuicPacket& regularPacket,
     uint64_t packetSize) {
@@ -174,6 +232,12 @@ std::unique_ptr<QLogPacketEvent> BaseQLogger::createPacketEvent(
       case QuicFrame::Type::NoopFrame_E: {
         break;
       }
+      case QuicFrame::Type::DatagramFrame_E: {
+        const auto& frame = *quicFrame.asDatagramFrame();
+        event->frames.push_back(
+            std::make_unique<DatagramFrameLog>(frame.length));
+        break;
+      }
     }
   }
   if (numPaddingFrames > 0) {
@@ -273,6 +337,12 @@ std::unique_ptr<QLogPacketEvent> BaseQLogger::createPacketEvent(
         addQuicSimpleFrameToEvent(event.get(), simpleFrame);
         break;
       }
+      case QuicWriteFrame::Type::DatagramFrame_E: {
+        const DatagramFrame& frame = *quicFrame.asDatagramFrame();
+        event->frames.push_back(
+            std::make_unique<DatagramFrameLog>(frame.length));
+        break;
+      }
       default:
         break;
     }
@@ -315,4 +385,241 @@ std::unique_ptr<QLogRetryEvent> BaseQLogger::createPacketEvent(
   return event;
 }
 
+void BaseQLogger::addPacket(
+    const RegularQuicPacket& regularPacket,
+    uint64_t packetSize) {
+  handleEvent(createPacketEvent(regularPacket, packetSize));
+}
+
+void BaseQLogger::addPacket(
+    const RegularQuicWritePacket& writePacket,
+    uint64_t packetSize) {
+  handleEvent(createPacketEvent(writePacket, packetSize));
+}
+
+void BaseQLogger::addPacket(
+    const VersionNegotiationPacket& versionPacket,
+    uint64_t packetSize,
+    bool isPacketRecvd) {
+  handleEvent(createPacketEvent(versionPacket, packetSize, isPacketRecvd));
+}
+
+void BaseQLogger::addPacket(
+    const RetryPacket& retryPacket,
+    uint64_t packetSize,
+    bool isPacketRecvd) {
+  handleEvent(createPacketEvent(retryPacket, packetSize, isPacketRecvd));
+}
+
+void BaseQLogger::addConnectionClose(
+    std::string error,
+    std::string reason,
+    bool drainConnection,
+    bool sendCloseImmediately) {
+  auto refTime = std::chrono::duration_cast<std::chrono::microseconds>(
+      std::chrono::steady_clock::now() - refTimePoint);
+  handleEvent(std::make_unique<quic::QLogConnectionCloseEvent>(
+      std::move(error),
+      std::move(reason),
+      drainConnection,
+      sendCloseImmediately,
+      refTime));
+}
+
+void BaseQLogger::addTransportSummary(
+    uint64_t totalBytesSent,
+    uint64_t totalBytesRecvd,
+    uint64_t sumCurWriteOffset,
+    uint64_t sumMaxObservedOffset,
+    uint64_t sumCurStreamBufferLen,
+    uint64_t totalBytesRetransmitted,
+    uint64_t totalStreamBytesCloned,
+    uint64_t totalBytesCloned,
+    uint64_t totalCryptoDataWritten,
+    uint64_t totalCryptoDataRecvd) {
+  auto refTime = std::chrono::duration_cast<std::chrono::microseconds>(
+      std::chrono::steady_clock::now() - refTimePoint);
+
+  handleEvent(std::make_unique<quic::QLogTransportSummaryEvent>(
+      totalBytesSent,
+      totalBytesRecvd,
+      sumCurWriteOffset,
+      sumMaxObservedOffset,
+      sumCurStreamBufferLen,
+      totalBytesRetransmitted,
+      totalStreamBytesCloned,
+      totalBytesCloned,
+      totalCryptoDataWritten,
+      totalCryptoDataRecvd,
+      refTime));
+}
+
+void BaseQLogger::addCongestionMetricUpdate(
+    uint64_t bytesInFlight,
+    uint64_t currentCwnd,
+    std::string congestionEvent,
+    std::string state,
+    std::string recoveryState) {
+  auto refTime = std::chrono::duration_cast<std::chrono::microseconds>(
+      std::chrono::steady_clock::now() - refTimePoint);
+
+  handleEvent(std::make_unique<quic::QLogCongestionMetricUpdateEvent>(
+      bytesInFlight,
+      currentCwnd,
+      std::move(congestionEvent),
+      std::move(state),
+      std::move(recoveryState),
+      refTime));
+}
+
+void BaseQLogger::addBandwidthEstUpdate(
+    uint64_t bytes,
+    std::chrono::microseconds interval) {
+  handleEvent(std::make_unique<quic::QLogBandwidthEstUpdateEvent>(
+      bytes,
+      interval,
+      std::chrono::duration_cast<std::chrono::microseconds>(
+          std::chrono::steady_clock::now() - refTimePoint)));
+}
+
+void BaseQLogger::addAppLimitedUpdate() {
+  handleEvent(std::make_unique<quic::QLogAppLimitedUpdateEvent>(
+      true,
+      std::chrono::duration_cast<std::chrono::microseconds>(
+          std::chrono::steady_clock::now() - refTimePoint)));
+}
+
+void BaseQLogger::addAppUnlimitedUpdate() {
+  handleEvent(std::make_unique<quic::QLogAppLimitedUpdateEvent>(
+      false,
+      std::chrono::duration_cast<std::chrono::microseconds>(
+          std::chrono::steady_clock::now() - refTimePoint)));
+}
+void BaseQLogger::addPacingMetricUpdate(
+    uint64_t pacingBurstSizeIn,
+    std::chrono::microseconds pacingIntervalIn) {
+  auto refTime = std::chrono::duration_cast<std::chrono::microseconds>(
+      std::chrono::steady_clock::now() - refTimePoint);
+
+  handleEvent(std::make_unique<quic::QLogPacingMetricUpdateEvent>(
+      pacingBurstSizeIn, pacingIntervalIn, refTime));
+}
+
+void BaseQLogger::addPacingObservation(
+    std::string actual,
+    std::string expect,
+    std::string conclusion) {
+  auto refTime = std::chrono::duration_cast<std::chrono::microseconds>(
+      std::chrono::steady_clock::now() - refTimePoint);
+  handleEvent(std::make_unique<quic::QLogPacingObservationEvent>(
+      std::move(actual), std::move(expect), std::move(conclusion), refTime));
+}
+
+void BaseQLogger::addAppIdleUpdate(std::string idleEvent, bool idle) {
+  auto refTime = std::chrono::duration_cast<std::chrono::microseconds>(
+      std::chrono::steady_clock::now() - refTimePoint);
+
+  handleEvent(std::make_unique<quic::QLogAppIdleUpdateEvent>(
+      std::move(idleEvent), idle, refTime));
+}
+
+void BaseQLogger::addPacketDrop(size_t packetSize, std::string dropReason) {
+  auto refTime = std::chrono::duration_cast<std::chrono::microseconds>(
+      std::chrono::steady_clock::now() - refTimePoint);
+
+  handleEvent(std::make_unique<quic::QLogPacketDropEvent>(
+      packetSize, std::move(dropReason), refTime));
+}
+
+void BaseQLogger::addDatagramReceived(uint64_t dataLen) {
+  auto refTime = std::chrono::duration_cast<std::chrono::microseconds>(
+      std::chrono::steady_clock::now() - refTimePoint);
+
+  handleEvent(
+      std::make_unique<quic::QLogDatagramReceivedEvent>(dataLen, refTime));
+}
+
+void BaseQLogger::addLossAlarm(
+    PacketNum largestSent,
+    uint64_t alarmCount,
+    uint64_t outstandingPackets,
+    std::string type) {
+  auto refTime = std::chrono::duration_cast<std::chrono::microseconds>(
+      std::chrono::steady_clock::now() - refTimePoint);
+
+  handleEvent(std::make_unique<quic::QLogLossAlarmEvent>(
+      largestSent, alarmCount, outstandingPackets, std::move(type), refTime));
+}
+
+void BaseQLogger::addPacketsLost(
+    PacketNum largestLostPacketNum,
+    uint64_t lostBytes,
+    uint64_t lostPackets) {
+  auto refTime = std::chrono::duration_cast<std::chrono::microseconds>(
+      std::chrono::steady_clock::now() - refTimePoint);
+
+  handleEvent(std::make_unique<quic::QLogPacketsLostEvent>(
+      largestLostPacketNum, lostBytes, lostPackets, refTime));
+}
+
+void BaseQLogger::addTransportStateUpdate(std::string update) {
+  auto refTime = std::chrono::duration_cast<std::chrono::microseconds>(
+      std::chrono::steady_clock::now() - refTimePoint);
+
+  handleEvent(std::make_unique<quic::QLogTransportStateUpdateEvent>(
+      std::move(update), refTime));
+}
+
+void BaseQLogger::addPacketBuffered(
+    PacketNum packetNum,
+    ProtectionType protectionType,
+    uint64_t packetSize) {
+  auto refTime = std::chrono::duration_cast<std::chrono::microseconds>(
+      std::chrono::steady_clock::now() - refTimePoint);
+
+  handleEvent(std::make_unique<quic::QLogPacketBufferedEvent>(
+      packetNum, protectionType, packetSize, refTime));
+}
+
+void BaseQLogger::addMetricUpdate(
+    std::chrono::microseconds latestRtt,
+    std::chrono::microseconds mrtt,
+    std::chrono::microseconds srtt,
+    std::chrono::microseconds ackDelay) {
+  auto refTime = std::chrono::duration_cast<std::chrono::microseconds>(
+      std::chrono::steady_clock::now() - refTimePoint);
+
+  handleEvent(std::make_unique<quic::QLogMetricUpdateEvent>(
+      latestRtt, mrtt, srtt, ackDelay, refTime));
+}
+
+void BaseQLogger::addStreamStateUpdate(
+    quic::StreamId id,
+    std::string update,
+    folly::Optional<std::chrono::milliseconds> timeSinceStreamCreation) {
+  auto refTime = std::chrono::duration_cast<std::chrono::microseconds>(
+      std::chrono::steady_clock::now() - refTimePoint);
+
+  handleEvent(std::make_unique<quic::QLogStreamStateUpdateEvent>(
+      id,
+      std::move(update),
+      std::move(timeSinceStreamCreation),
+      vantagePoint,
+      refTime));
+}
+
+void BaseQLogger::addConnectionMigrationUpdate(bool intentionalMigration) {
+  auto refTime = std::chrono::duration_cast<std::chrono::microseconds>(
+      std::chrono::steady_clock::now() - refTimePoint);
+  handleEvent(std::make_unique<quic::QLogConnectionMigrationEvent>(
+      intentionalMigration, vantagePoint, refTime));
+}
+
+void BaseQLogger::addPathValidationEvent(bool success) {
+  auto refTime = std::chrono::duration_cast<std::chrono::microseconds>(
+      std::chrono::steady_clock::now() - refTimePoint);
+  handleEvent(std::make_unique<quic::QLogPathValidationEvent>(
+      success, vantagePoint, refTime));
+}
+
 } // namespace quic
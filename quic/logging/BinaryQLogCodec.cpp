@@ -0,0 +1,808 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ *
+ */
+
+#include <quic/logging/BinaryQLogCodec.h>
+
+#include <folly/Bits.h>
+#include <folly/Conv.h>
+#include <folly/Varint.h>
+#include <glog/logging.h>
+#include <quic/QuicException.h>
+#include <quic/logging/QLoggerConstants.h>
+
+#include <cstring>
+#include <stdexcept>
+
+namespace quic {
+
+namespace {
+
+enum class ValueTag : uint8_t {
+  Null = 0,
+  False = 1,
+  True = 2,
+  PositiveInt = 3,
+  // Stores ~value, so that small negative numbers stay small.
+  NegativeInt = 4,
+  Double = 5,
+  String = 6,
+  StringRef = 7,
+  // A string holding a decimal number, like the relative_time of events.
+  DecimalString = 8,
+  Array = 9,
+  Object = 10,
+};
+
+// Deeper values are rejected by the decoder, qlog events nest a few levels.
+constexpr size_t kMaxValueDepth = 64;
+// Longest decimal string that always fits in a uint64_t.
+constexpr size_t kMaxDecimalStringLength = 19;
+
+void appendVarint(uint64_t value, std::string& out) {
+  uint8_t buf[folly::kMaxVarintLength64];
+  auto len = folly::encodeVarint(value, buf);
+  out.append(reinterpret_cast<const char*>(buf), len);
+}
+
+void appendRecord(
+    BinaryQLogRecordType type,
+    folly::StringPiece payload,
+    std::string& out) {
+  out.push_back(static_cast<char>(type));
+  appendVarint(payload.size(), out);
+  out.append(payload.data(), payload.size());
+}
+
+bool isDecimalString(folly::StringPiece str) {
+  if (str.empty() || str.size() > kMaxDecimalStringLength ||
+      (str.size() > 1 && str.front() == '0')) {
+    return false;
+  }
+  for (char c : str) {
+    if (c < '0' || c > '9') {
+      return false;
+    }
+  }
+  return true;
+}
+
+[[noreturn]] void throwMalformed(folly::StringPiece what) {
+  throw std::runtime_error(
+      folly::to<std::string>("Malformed binary qlog: ", what));
+}
+
+class BinaryQLogDecoder {
+ public:
+  folly::dynamic decode(folly::ByteRange data);
+
+ private:
+  uint64_t readVarint(folly::ByteRange& range);
+  folly::ByteRange readBytes(folly::ByteRange& range, uint64_t len);
+  bool readBool(folly::ByteRange& range);
+  std::string readString(folly::ByteRange& range);
+  std::chrono::microseconds readMicros(folly::ByteRange& range);
+  folly::dynamic readValue(folly::ByteRange& range, size_t depth = 0);
+  std::unique_ptr<QLogEvent> readEvent(folly::ByteRange& range);
+  std::unique_ptr<QLogEvent> readPacketEvent(folly::ByteRange& range);
+  std::unique_ptr<QLogFrame> readFrame(folly::ByteRange& range);
+
+  VantagePoint vantagePoint_{VantagePoint::Client};
+  std::vector<std::string> strings_;
+};
+
+uint64_t BinaryQLogDecoder::readVarint(folly::ByteRange& range) {
+  auto value = folly::tryDecodeVarint(range);
+  if (!value) {
+    throwMalformed("bad varint");
+  }
+  return *value;
+}
+
+folly::ByteRange BinaryQLogDecoder::readBytes(
+    folly::ByteRange& range,
+    uint64_t len) {
+  if (range.size() < len) {
+    throwMalformed("value past the end of its record");
+  }
+  folly::ByteRange bytes(range.begin(), len);
+  range.advance(len);
+  return bytes;
+}
+
+bool BinaryQLogDecoder::readBool(folly::ByteRange& range) {
+  auto value = readBytes(range, 1).front();
+  if (value > 1) {
+    throwMalformed("bad bool");
+  }
+  return value == 1;
+}
+
+std::string BinaryQLogDecoder::readString(folly::ByteRange& range) {
+  auto value = readVarint(range);
+  if (value & 1) {
+    auto id = value >> 1;
+    if (id >= strings_.size()) {
+      throwMalformed("reference to an undefined string");
+    }
+    return strings_[id];
+  }
+  return folly::StringPiece(readBytes(range, value >> 1)).str();
+}
+
+std::chrono::microseconds BinaryQLogDecoder::readMicros(
+    folly::ByteRange& range) {
+  return std::chrono::microseconds(static_cast<int64_t>(readVarint(range)));
+}
+
+folly::dynamic BinaryQLogDecoder::readValue(
+    folly::ByteRange& range,
+    size_t depth) {
+  if (depth > kMaxValueDepth) {
+    throwMalformed("values nested too deep");
+  }
+  auto tag = static_cast<ValueTag>(readBytes(range, 1).front());
+  switch (tag) {
+    case ValueTag::Null:
+      return nullptr;
+    case ValueTag::False:
+      return false;
+    case ValueTag::True:
+      return true;
+    case ValueTag::PositiveInt:
+      return static_cast<int64_t>(readVarint(range));
+    case ValueTag::NegativeInt:
+      return static_cast<int64_t>(~readVarint(range));
+    case ValueTag::Double: {
+      uint64_t bits;
+      std::memcpy(&bits, readBytes(range, sizeof(bits)).data(), sizeof(bits));
+      bits = folly::Endian::little(bits);
+      double value;
+      std::memcpy(&value, &bits, sizeof(value));
+      return value;
+    }
+    case ValueTag::String: {
+      auto len = readVarint(range);
+      return folly::StringPiece(readBytes(range, len)).str();
+    }
+    case ValueTag::StringRef: {
+      auto id = readVarint(range);
+      if (id >= strings_.size()) {
+        throwMalformed("reference to an undefined string");
+      }
+      return strings_[id];
+    }
+    case ValueTag::DecimalString:
+      return folly::to<std::string>(readVarint(range));
+    case ValueTag::Array: {
+      auto size = readVarint(range);
+      folly::dynamic array = folly::dynamic::array();
+      for (uint64_t i = 0; i < size; ++i) {
+        array.push_back(readValue(range, depth + 1));
+      }
+      return array;
+    }
+    case ValueTag::Object: {
+      auto size = readVarint(range);
+      folly::dynamic object = folly::dynamic::object();
+      for (uint64_t i = 0; i < size; ++i) {
+        auto key = readValue(range, depth + 1);
+        object[std::move(key)] = readValue(range, depth + 1);
+      }
+      return object;
+    }
+  }
+  throwMalformed("unknown value tag");
+}
+
+std::unique_ptr<QLogEvent> BinaryQLogDecoder::readEvent(
+    folly::ByteRange& range) {
+  // Fields are read into locals first, as the evaluation order of function
+  // arguments is unspecified.
+  auto type = static_cast<QLogEventType>(readVarint(range));
+  auto refTime = readMicros(range);
+  std::unique_ptr<QLogEvent> event;
+  switch (type) {
+    case QLogEventType::PacketReceived:
+    case QLogEventType::PacketSent:
+      event = readPacketEvent(range);
+      break;
+    case QLogEventType::ConnectionClose: {
+      auto error = readString(range);
+      auto reason = readString(range);
+      auto drainConnection = readBool(range);
+      auto sendCloseImmediately = readBool(range);
+      event = std::make_unique<QLogConnectionCloseEvent>(
+          std::move(error),
+          std::move(reason),
+          drainConnection,
+          sendCloseImmediately,
+          refTime);
+      break;
+    }
+    case QLogEventType::TransportSummary: {
+      uint64_t values[10];
+      for (auto& value : values) {
+        value = readVarint(range);
+      }
+      event = std::make_unique<QLogTransportSummaryEvent>(
+          values[0],
+          values[1],
+          values[2],
+          values[3],
+          values[4],
+          values[5],
+          values[6],
+          values[7],
+          values[8],
+          values[9],
+          refTime);
+      break;
+    }
+    case QLogEventType::CongestionMetricUpdate: {
+      auto bytesInFlight = readVarint(range);
+      auto currentCwnd = readVarint(range);
+      auto congestionEvent = readString(range);
+      auto state = readString(range);
+      auto recoveryState = readString(range);
+      event = std::make_unique<QLogCongestionMetricUpdateEvent>(
+          bytesInFlight,
+          currentCwnd,
+          std::move(congestionEvent),
+          std::move(state),
+          std::move(recoveryState),
+          refTime);
+      break;
+    }
+    case QLogEventType::PacingMetricUpdate: {
+      auto pacingBurstSize = readVarint(range);
+      auto pacingInterval = readMicros(range);
+      event = std::make_unique<QLogPacingMetricUpdateEvent>(
+          pacingBurstSize, pacingInterval, refTime);
+      break;
+    }
+    case QLogEventType::AppIdleUpdate: {
+      auto idleEvent = readString(range);
+      auto idle = readBool(range);
+      event = std::make_unique<QLogAppIdleUpdateEvent>(
+          std::move(idleEvent), idle, refTime);
+      break;
+    }
+    case QLogEventType::PacketDrop: {
+      auto packetSize = readVarint(range);
+      auto dropReason = readString(range);
+      event = std::make_unique<QLogPacketDropEvent>(
+          packetSize, std::move(dropReason), refTime);
+      break;
+    }
+    case QLogEventType::DatagramReceived:
+      event = std::make_unique<QLogDatagramReceivedEvent>(
+          readVarint(range), refTime);
+      break;
+    case QLogEventType::LossAlarm: {
+      auto largestSent = readVarint(range);
+      auto alarmCount = readVarint(range);
+      auto outstandingPackets = readVarint(range);
+      auto alarmType = readString(range);
+      event = std::make_unique<QLogLossAlarmEvent>(
+          largestSent,
+          alarmCount,
+          outstandingPackets,
+          std::move(alarmType),
+          refTime);
+      break;
+    }
+    case QLogEventType::PacketsLost: {
+      auto largestLostPacketNum = readVarint(range);
+      auto lostBytes = readVarint(range);
+      auto lostPackets = readVarint(range);
+      event = std::make_unique<QLogPacketsLostEvent>(
+          largestLostPacketNum, lostBytes, lostPackets, refTime);
+      break;
+    }
+    case QLogEventType::TransportStateUpdate:
+      event = std::make_unique<QLogTransportStateUpdateEvent>(
+          readString(range), refTime);
+      break;
+    case QLogEventType::PacketBuffered: {
+      auto packetNum = readVarint(range);
+      auto protectionType = readVarint(range);
+      if (protectionType >
+          static_cast<uint64_t>(ProtectionType::KeyPhaseOne)) {
+        throwMalformed("unknown protection type");
+      }
+      auto packetSize = readVarint(range);
+      event = std::make_unique<QLogPacketBufferedEvent>(
+          packetNum,
+          static_cast<ProtectionType>(protectionType),
+          packetSize,
+          refTime);
+      break;
+    }
+    case QLogEventType::MetricUpdate: {
+      auto latestRtt = readMicros(range);
+      auto mrtt = readMicros(range);
+      auto srtt = readMicros(range);
+      auto ackDelay = readMicros(range);
+      event = std::make_unique<QLogMetricUpdateEvent>(
+          latestRtt, mrtt, srtt, ackDelay, refTime);
+      break;
+    }
+    case QLogEventType::StreamStateUpdate: {
+      auto id = readVarint(range);
+      auto update = readString(range);
+      folly::Optional<std::chrono::milliseconds> timeSinceStreamCreation;
+      if (readBool(range)) {
+        timeSinceStreamCreation =
+            std::chrono::milliseconds(static_cast<int64_t>(readVarint(range)));
+      }
+      event = std::make_unique<QLogStreamStateUpdateEvent>(
+          id,
+          std::move(update),
+          std::move(timeSinceStreamCreation),
+          vantagePoint_,
+          refTime);
+      break;
+    }
+    case QLogEventType::PacingObservation: {
+      auto actual = readString(range);
+      auto expect = readString(range);
+      auto conclusion = readString(range);
+      event = std::make_unique<QLogPacingObservationEvent>(
+          std::move(actual), std::move(expect), std::move(conclusion), refTime);
+      break;
+    }
+    case QLogEventType::AppLimitedUpdate:
+      event = std::make_unique<QLogAppLimitedUpdateEvent>(
+          readBool(range), refTime);
+      break;
+    case QLogEventType::BandwidthEstUpdate: {
+      auto bytes = readVarint(range);
+      auto interval = readMicros(range);
+      event = std::make_unique<QLogBandwidthEstUpdateEvent>(
+          bytes, interval, refTime);
+      break;
+    }
+    case QLogEventType::ConnectionMigration:
+      event = std::make_unique<QLogConnectionMigrationEvent>(
+          readBool(range), vantagePoint_, refTime);
+      break;
+    case QLogEventType::PathValidation:
+      event = std::make_unique<QLogPathValidationEvent>(
+          readBool(range), vantagePoint_, refTime);
+      break;
+    default:
+      throwMalformed("unknown event type");
+  }
+  event->eventType = type;
+  event->refTime = refTime;
+  return event;
+}
+
+std::unique_ptr<QLogEvent> BinaryQLogDecoder::readPacketEvent(
+    folly::ByteRange& range) {
+  auto kind = static_cast<BinaryQLogPacketKind>(readVarint(range));
+  auto packetType = readString(range);
+  switch (kind) {
+    case BinaryQLogPacketKind::Regular: {
+      auto event = std::make_unique<QLogPacketEvent>();
+      event->packetType = std::move(packetType);
+      event->packetNum = readVarint(range);
+      event->packetSize = readVarint(range);
+      while (!range.empty()) {
+        event->frames.push_back(readFrame(range));
+      }
+      return event;
+    }
+    case BinaryQLogPacketKind::VersionNegotiation: {
+      auto event = std::make_unique<QLogVersionNegotiationEvent>();
+      event->packetType = std::move(packetType);
+      event->packetSize = readVarint(range);
+      auto numVersions = readVarint(range);
+      std::vector<QuicVersion> versions;
+      for (uint64_t i = 0; i < numVersions; ++i) {
+        versions.push_back(static_cast<QuicVersion>(readVarint(range)));
+      }
+      event->versionLog = std::make_unique<VersionNegotiationLog>(versions);
+      return event;
+    }
+    case BinaryQLogPacketKind::Retry: {
+      auto event = std::make_unique<QLogRetryEvent>();
+      event->packetType = std::move(packetType);
+      event->packetSize = readVarint(range);
+      event->tokenSize = readVarint(range);
+      return event;
+    }
+  }
+  throwMalformed("unknown packet kind");
+}
+
+std::unique_ptr<QLogFrame> BinaryQLogDecoder::readFrame(
+    folly::ByteRange& range) {
+  auto frameType = static_cast<FrameType>(readVarint(range));
+  switch (frameType) {
+    case FrameType::PADDING:
+      return std::make_unique<PaddingFrameLog>(readVarint(range));
+    case FrameType::RST_STREAM: {
+      auto streamId = readVarint(range);
+      auto errorCode = readVarint(range);
+      auto offset = readVarint(range);
+      return std::make_unique<RstStreamFrameLog>(
+          streamId, static_cast<ApplicationErrorCode>(errorCode), offset);
+    }
+    case FrameType::CONNECTION_CLOSE: {
+      auto kind = readVarint(range);
+      auto value = readVarint(range);
+      folly::Optional<QuicErrorCode> errorCode;
+      switch (static_cast<QuicErrorCode::Type>(kind)) {
+        case QuicErrorCode::Type::ApplicationErrorCode_E:
+          errorCode = QuicErrorCode(static_cast<ApplicationErrorCode>(value));
+          break;
+        case QuicErrorCode::Type::LocalErrorCode_E:
+          errorCode = QuicErrorCode(static_cast<LocalErrorCode>(value));
+          break;
+        case QuicErrorCode::Type::TransportErrorCode_E:
+          errorCode = QuicErrorCode(static_cast<TransportErrorCode>(value));
+          break;
+        default:
+          throwMalformed("unknown error code kind");
+      }
+      auto reasonPhrase = readString(range);
+      auto closingFrameType = static_cast<FrameType>(readVarint(range));
+      return std::make_unique<ConnectionCloseFrameLog>(
+          std::move(*errorCode), std::move(reasonPhrase), closingFrameType);
+    }
+    case FrameType::MAX_DATA:
+      return std::make_unique<MaxDataFrameLog>(readVarint(range));
+    case FrameType::MAX_STREAM_DATA: {
+      auto streamId = readVarint(range);
+      auto maximumData = readVarint(range);
+      return std::make_unique<MaxStreamDataFrameLog>(streamId, maximumData);
+    }
+    case FrameType::MAX_STREAMS_BIDI:
+    case FrameType::MAX_STREAMS_UNI:
+      return std::make_unique<MaxStreamsFrameLog>(
+          readVarint(range), frameType == FrameType::MAX_STREAMS_BIDI);
+    case FrameType::STREAMS_BLOCKED_BIDI:
+    case FrameType::STREAMS_BLOCKED_UNI:
+      return std::make_unique<StreamsBlockedFrameLog>(
+          readVarint(range), frameType == FrameType::STREAMS_BLOCKED_BIDI);
+    case FrameType::PING:
+      return std::make_unique<PingFrameLog>();
+    case FrameType::DATA_BLOCKED:
+      return std::make_unique<DataBlockedFrameLog>(readVarint(range));
+    case FrameType::STREAM_DATA_BLOCKED: {
+      auto streamId = readVarint(range);
+      auto dataLimit = readVarint(range);
+      return std::make_unique<StreamDataBlockedFrameLog>(streamId, dataLimit);
+    }
+    case FrameType::ACK: {
+      auto ackDelay = readMicros(range);
+      auto numBlocks = readVarint(range);
+      ReadAckFrame::Vec ackBlocks;
+      for (uint64_t i = 0; i < numBlocks; ++i) {
+        auto startPacket = readVarint(range);
+        auto endPacket = readVarint(range);
+        ackBlocks.emplace_back(startPacket, endPacket);
+      }
+      return std::make_unique<ReadAckFrameLog>(ackBlocks, ackDelay);
+    }
+    case FrameType::STREAM: {
+      auto streamId = readVarint(range);
+      auto offset = readVarint(range);
+      auto len = readVarint(range);
+      auto fin = readBool(range);
+      return std::make_unique<StreamFrameLog>(streamId, offset, len, fin);
+    }
+    case FrameType::CRYPTO_FRAME: {
+      auto offset = readVarint(range);
+      auto len = readVarint(range);
+      return std::make_unique<CryptoFrameLog>(offset, len);
+    }
+    case FrameType::STOP_SENDING: {
+      auto streamId = readVarint(range);
+      auto errorCode = readVarint(range);
+      return std::make_unique<StopSendingFrameLog>(
+          streamId, static_cast<ApplicationErrorCode>(errorCode));
+    }
+    case FrameType::MIN_STREAM_DATA: {
+      auto streamId = readVarint(range);
+      auto maximumData = readVarint(range);
+      auto minimumStreamOffset = readVarint(range);
+      return std::make_unique<MinStreamDataFrameLog>(
+          streamId, maximumData, minimumStreamOffset);
+    }
+    case FrameType::EXPIRED_STREAM_DATA: {
+      auto streamId = readVarint(range);
+      auto minimumStreamOffset = readVarint(range);
+      return std::make_unique<ExpiredStreamDataFrameLog>(
+          streamId, minimumStreamOffset);
+    }
+    case FrameType::PATH_CHALLENGE:
+      return std::make_unique<PathChallengeFrameLog>(readVarint(range));
+    case FrameType::PATH_RESPONSE:
+      return std::make_unique<PathResponseFrameLog>(readVarint(range));
+    case FrameType::NEW_CONNECTION_ID: {
+      auto sequence = readVarint(range);
+      StatelessResetToken token;
+      std::memcpy(
+          token.data(), readBytes(range, token.size()).data(), token.size());
+      return std::make_unique<NewConnectionIdFrameLog>(
+          static_cast<uint16_t>(sequence), token);
+    }
+    case FrameType::RETIRE_CONNECTION_ID:
+      return std::make_unique<RetireConnectionIdFrameLog>(readVarint(range));
+    case FrameType::NEW_TOKEN:
+      return std::make_unique<ReadNewTokenFrameLog>();
+    case FrameType::DATAGRAM:
+      return std::make_unique<DatagramFrameLog>(readVarint(range));
+    case FrameType::HANDSHAKE_DONE:
+      return std::make_unique<HandshakeDoneFrameLog>();
+    case FrameType::ACK_FREQUENCY: {
+      auto sequenceNumber = readVarint(range);
+      auto packetTolerance = readVarint(range);
+      auto updateMaxAckDelay = readVarint(range);
+      auto ignoreOrder = readBool(range);
+      return std::make_unique<AckFrequencyFrameLog>(
+          sequenceNumber, packetTolerance, updateMaxAckDelay, ignoreOrder);
+    }
+    case FrameType::IMMEDIATE_ACK:
+      return std::make_unique<ImmediateAckFrameLog>();
+    default:
+      break;
+  }
+  throwMalformed("unknown frame type");
+}
+
+folly::dynamic BinaryQLogDecoder::decode(folly::ByteRange data) {
+  auto magic = folly::ByteRange(kBinaryQLogMagic);
+  if (!data.startsWith(magic)) {
+    throwMalformed("bad magic");
+  }
+  data.advance(magic.size());
+  if (data.empty() || data.front() != kBinaryQLogVersion) {
+    throwMalformed("unsupported version");
+  }
+  data.advance(1);
+  if (data.empty() || data.front() > 1) {
+    throwMalformed("bad vantage point");
+  }
+  vantagePoint_ = static_cast<VantagePoint>(data.front());
+  data.advance(1);
+
+  folly::dynamic trace = nullptr;
+  folly::dynamic events = folly::dynamic::array();
+  uint64_t numDropped = 0;
+  while (!data.empty()) {
+    auto type = static_cast<BinaryQLogRecordType>(data.front());
+    auto rest = data.subpiece(1);
+    auto len = folly::tryDecodeVarint(rest);
+    if (!len && len.error() != folly::DecodeVarintError::TooFewBytes) {
+      throwMalformed("bad record length");
+    }
+    if (!len || rest.size() < *len) {
+      LOG(WARNING) << "Ignoring truncated record at the end of the binary qlog";
+      break;
+    }
+    folly::ByteRange payload(rest.begin(), *len);
+    data = rest.subpiece(*len);
+    switch (type) {
+      case BinaryQLogRecordType::Trace:
+        trace = readValue(payload);
+        break;
+      case BinaryQLogRecordType::String:
+        strings_.push_back(folly::StringPiece(payload).str());
+        payload.clear();
+        break;
+      case BinaryQLogRecordType::Event:
+        events.push_back(readEvent(payload)->toDynamic());
+        break;
+      case BinaryQLogRecordType::Dropped:
+        numDropped += readVarint(payload);
+        break;
+      default:
+        // Records added by later versions of the writer are skipped.
+        payload.clear();
+        break;
+    }
+    if (!payload.empty()) {
+      throwMalformed("trailing bytes in record");
+    }
+  }
+  if (!trace.isObject() || !trace["traces"].isArray() ||
+      trace["traces"].empty()) {
+    throwMalformed("no trace record");
+  }
+
+  // Same summary as FileQLogger::generateSummary().
+  auto numEvents = events.size();
+  int64_t maxDuration = 0;
+  if (numEvents > 0) {
+    maxDuration = folly::to<int64_t>(events[numEvents - 1][0].asString()) -
+        folly::to<int64_t>(events[0][0].asString());
+  }
+  trace["summary"] = folly::dynamic::object(kQLogTraceCountField, 1)(
+      "max_duration", maxDuration)("total_event_count", numEvents);
+  if (numDropped > 0) {
+    trace["summary"]["dropped_event_count"] = numDropped;
+  }
+  trace["traces"][0]["events"] = std::move(events);
+  return trace;
+}
+
+} // namespace
+
+BinaryQLogEncoder::BinaryQLogEncoder(size_t maxInternedStrings)
+    : maxInternedStrings_(maxInternedStrings) {}
+
+void BinaryQLogEncoder::encodeHeader(
+    VantagePoint vantagePoint,
+    std::string& out) {
+  out.append(kBinaryQLogMagic.data(), kBinaryQLogMagic.size());
+  out.push_back(static_cast<char>(kBinaryQLogVersion));
+  out.push_back(static_cast<char>(vantagePoint));
+}
+
+void BinaryQLogEncoder::encodeTrace(
+    const folly::dynamic& trace,
+    std::string& out) {
+  beginRecord();
+  encodeValue(trace, payload_);
+  endRecord(BinaryQLogRecordType::Trace, out);
+}
+
+void BinaryQLogEncoder::beginEvent(
+    QLogEventType type,
+    std::chrono::microseconds refTime) {
+  beginRecord();
+  addInt(static_cast<uint64_t>(type));
+  addInt(refTime.count());
+}
+
+void BinaryQLogEncoder::addInt(uint64_t value) {
+  appendVarint(value, payload_);
+}
+
+void BinaryQLogEncoder::addBool(bool value) {
+  payload_.push_back(value ? 1 : 0);
+}
+
+void BinaryQLogEncoder::addString(folly::StringPiece str) {
+  // The low bit tells a reference to a String record from an inline string.
+  auto id = internString(str);
+  if (id) {
+    appendVarint((*id << 1) | 1, payload_);
+    return;
+  }
+  appendVarint(str.size() << 1, payload_);
+  payload_.append(str.data(), str.size());
+}
+
+void BinaryQLogEncoder::addBytes(folly::ByteRange bytes) {
+  payload_.append(reinterpret_cast<const char*>(bytes.data()), bytes.size());
+}
+
+void BinaryQLogEncoder::endEvent(std::string& out) {
+  endRecord(BinaryQLogRecordType::Event, out);
+}
+
+void BinaryQLogEncoder::encodeDropped(uint64_t numDropped, std::string& out) {
+  out.push_back(static_cast<char>(BinaryQLogRecordType::Dropped));
+  appendVarint(folly::encodeVarintSize(numDropped), out);
+  appendVarint(numDropped, out);
+}
+
+void BinaryQLogEncoder::discardLastRecord() {
+  for (const auto& str : lastInterned_) {
+    strings_.erase(str);
+  }
+  lastInterned_.clear();
+}
+
+void BinaryQLogEncoder::beginRecord() {
+  lastInterned_.clear();
+  stringRecords_.clear();
+  payload_.clear();
+}
+
+void BinaryQLogEncoder::endRecord(
+    BinaryQLogRecordType type,
+    std::string& out) {
+  out.append(stringRecords_);
+  appendRecord(type, payload_, out);
+}
+
+folly::Optional<uint64_t> BinaryQLogEncoder::internString(
+    folly::StringPiece str) {
+  auto it = strings_.find(str);
+  if (it != strings_.end()) {
+    return it->second;
+  }
+  if (str.size() > kBinaryQLogMaxInternedStringLength ||
+      strings_.size() >= maxInternedStrings_) {
+    return folly::none;
+  }
+  it = strings_.emplace(str.str(), strings_.size()).first;
+  lastInterned_.push_back(str.str());
+  appendRecord(BinaryQLogRecordType::String, str, stringRecords_);
+  return it->second;
+}
+
+void BinaryQLogEncoder::encodeValue(
+    const folly::dynamic& value,
+    std::string& out) {
+  switch (value.type()) {
+    case folly::dynamic::NULLT:
+      out.push_back(static_cast<char>(ValueTag::Null));
+      break;
+    case folly::dynamic::BOOL:
+      out.push_back(static_cast<char>(
+          value.getBool() ? ValueTag::True : ValueTag::False));
+      break;
+    case folly::dynamic::INT64: {
+      auto intValue = value.getInt();
+      if (intValue >= 0) {
+        out.push_back(static_cast<char>(ValueTag::PositiveInt));
+        appendVarint(intValue, out);
+      } else {
+        out.push_back(static_cast<char>(ValueTag::NegativeInt));
+        appendVarint(~static_cast<uint64_t>(intValue), out);
+      }
+      break;
+    }
+    case folly::dynamic::DOUBLE: {
+      auto doubleValue = value.getDouble();
+      uint64_t bits;
+      std::memcpy(&bits, &doubleValue, sizeof(bits));
+      bits = folly::Endian::little(bits);
+      out.push_back(static_cast<char>(ValueTag::Double));
+      out.append(reinterpret_cast<const char*>(&bits), sizeof(bits));
+      break;
+    }
+    case folly::dynamic::STRING:
+      encodeString(value.stringPiece(), out);
+      break;
+    case folly::dynamic::ARRAY:
+      out.push_back(static_cast<char>(ValueTag::Array));
+      appendVarint(value.size(), out);
+      for (const auto& item : value) {
+        encodeValue(item, out);
+      }
+      break;
+    case folly::dynamic::OBJECT:
+      out.push_back(static_cast<char>(ValueTag::Object));
+      appendVarint(value.size(), out);
+      for (const auto& item : value.items()) {
+        encodeValue(item.first, out);
+        encodeValue(item.second, out);
+      }
+      break;
+  }
+}
+
+void BinaryQLogEncoder::encodeString(folly::StringPiece str, std::string& out) {
+  if (isDecimalString(str)) {
+    out.push_back(static_cast<char>(ValueTag::DecimalString));
+    appendVarint(folly::to<uint64_t>(str), out);
+    return;
+  }
+  auto id = internString(str);
+  if (id) {
+    out.push_back(static_cast<char>(ValueTag::StringRef));
+    appendVarint(*id, out);
+    return;
+  }
+  out.push_back(static_cast<char>(ValueTag::String));
+  appendVarint(str.size(), out);
+  out.append(str.data(), str.size());
+}
+
+folly::dynamic binaryQLogToDynamic(folly::ByteRange data) {
+  return BinaryQLogDecoder().decode(data);
+}
+
+} // namespace quic
@@ -0,0 +1,134 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ *
+ */
+
+#pragma once
+
+#include <folly/Optional.h>
+#include <folly/Range.h>
+#include <folly/container/F14Map.h>
+#include <folly/dynamic.h>
+#include <quic/logging/QLoggerConstants.h>
+#include <quic/logging/QLoggerTypes.h>
+
+#include <string>
+#include <vector>
+
+namespace quic {
+
+/**
+ * A binary qlog file is a header followed by a sequence of records:
+ *
+ *   file   := magic (8 bytes) | version (1 byte) | vantage point (1 byte) |
+ *             record*
+ *   record := type (1 byte) | payload length (varint) | payload
+ *
+ * The trace description is stored as the folly::dynamic that the JSON qlog
+ * would contain, encoded with varints. Events are stored as their typed
+ * fields, so logging one builds neither a QLogEvent nor a folly::dynamic:
+ *
+ *   event  := QLogEventType | relative time | fields of the QLogEvent
+ *   packet := BinaryQLogPacketKind | packet type | fields of the event |
+ *             frame*
+ *   frame  := FrameType | fields of the QLogFrame
+ *
+ * Fields follow the declaration order of the QLogEvent or QLogFrame subclass.
+ * Integers are varints, and the repeated strings (congestion events, packet
+ * types...) are references to String records defined earlier in the file.
+ * The converter rebuilds the QLogEvent of each record and calls toDynamic().
+ */
+enum class BinaryQLogRecordType : uint8_t {
+  // The BaseQLogger::toDynamicBase() object. The last one in the file wins.
+  Trace = 1,
+  // Defines the string with the next id, starting from 0.
+  String = 2,
+  // The typed fields of one event.
+  Event = 3,
+  // Number of events dropped for lack of buffer space since the last record.
+  Dropped = 4,
+};
+
+// First field of PacketReceived and PacketSent events, telling which of the
+// QLogPacketEvent, QLogVersionNegotiationEvent or QLogRetryEvent they are.
+enum class BinaryQLogPacketKind : uint8_t {
+  Regular = 0,
+  VersionNegotiation = 1,
+  Retry = 2,
+};
+
+constexpr folly::StringPiece kBinaryQLogMagic = "MVFSTQLB";
+constexpr uint8_t kBinaryQLogVersion = 2;
+constexpr auto kBinaryQLogFileExtension = ".bqlog";
+
+// Strings longer than this are always written inline.
+constexpr size_t kBinaryQLogMaxInternedStringLength = 64;
+constexpr size_t kDefaultBinaryQLogMaxInternedStrings = 1024;
+
+class BinaryQLogEncoder {
+ public:
+  explicit BinaryQLogEncoder(
+      size_t maxInternedStrings = kDefaultBinaryQLogMaxInternedStrings);
+
+  /**
+   * Appends the file header to out.
+   */
+  static void encodeHeader(VantagePoint vantagePoint, std::string& out);
+
+  /**
+   * Appends a Trace record for trace to out, preceded by the String records
+   * of the strings it interns for the first time.
+   */
+  void encodeTrace(const folly::dynamic& trace, std::string& out);
+
+  /**
+   * Starts the Event record of an event. Its fields are added with the add*
+   * functions below, then endEvent() appends the record to out, preceded by
+   * the String records of the strings it interns for the first time.
+   */
+  void beginEvent(QLogEventType type, std::chrono::microseconds refTime);
+  void addInt(uint64_t value);
+  void addBool(bool value);
+  void addString(folly::StringPiece str);
+  void addBytes(folly::ByteRange bytes);
+  void endEvent(std::string& out);
+
+  /**
+   * Appends a Dropped record to out.
+   */
+  static void encodeDropped(uint64_t numDropped, std::string& out);
+
+  /**
+   * Forgets the strings interned by the last record. Must be called when its
+   * output is not written to the file, so later records do not reference
+   * strings the decoder never sees.
+   */
+  void discardLastRecord();
+
+ private:
+  void beginRecord();
+  void endRecord(BinaryQLogRecordType type, std::string& out);
+  folly::Optional<uint64_t> internString(folly::StringPiece str);
+  void encodeValue(const folly::dynamic& value, std::string& out);
+  void encodeString(folly::StringPiece str, std::string& out);
+
+  folly::F14FastMap<std::string, uint64_t> strings_;
+  std::vector<std::string> lastInterned_;
+  size_t maxInternedStrings_;
+  // String records of the record being encoded.
+  std::string stringRecords_;
+  std::string payload_;
+};
+
+/**
+ * Converts the content of a binary qlog file written by BinaryQLogger to the
+ * JSON object FileQLogger produces for the same connection. A record cut
+ * short at the end of the file, as left by a process that did not exit
+ * cleanly, is ignored. Throws std::runtime_error on malformed input.
+ */
+folly::dynamic binaryQLogToDynamic(folly::ByteRange data);
+
+} // namespace quic
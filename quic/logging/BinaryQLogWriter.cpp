@@ -0,0 +1,86 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ *
+ */
+
+#include <quic/logging/BinaryQLogWriter.h>
+
+#include <folly/FileUtil.h>
+#include <glog/logging.h>
+
+namespace quic {
+
+BinaryQLogSink::BinaryQLogSink(size_t chunkSize, size_t maxChunks)
+    : chunkSize_(chunkSize), maxChunks_(maxChunks) {}
+
+std::unique_ptr<folly::IOBuf> BinaryQLogSink::getChunk() {
+  std::lock_guard<std::mutex> guard(mutex_);
+  if (!freeChunks_.empty()) {
+    auto chunk = std::move(freeChunks_.back());
+    freeChunks_.pop_back();
+    return chunk;
+  }
+  if (numChunks_ < maxChunks_) {
+    ++numChunks_;
+    return folly::IOBuf::create(chunkSize_);
+  }
+  return nullptr;
+}
+
+void BinaryQLogSink::writeChunk(std::unique_ptr<folly::IOBuf> chunk) {
+  if (folly::writeFull(file_.fd(), chunk->data(), chunk->length()) < 0) {
+    PLOG(ERROR) << "Failed to write binary qlog chunk";
+  }
+  chunk->clear();
+  std::lock_guard<std::mutex> guard(mutex_);
+  freeChunks_.push_back(std::move(chunk));
+}
+
+BinaryQLogWriter::BinaryQLogWriter() : thread_([this] { run(); }) {}
+
+BinaryQLogWriter::~BinaryQLogWriter() {
+  {
+    std::lock_guard<std::mutex> guard(mutex_);
+    stopping_ = true;
+  }
+  cv_.notify_one();
+  thread_.join();
+}
+
+void BinaryQLogWriter::write(
+    std::shared_ptr<BinaryQLogSink> sink,
+    std::unique_ptr<folly::IOBuf> chunk) {
+  {
+    std::lock_guard<std::mutex> guard(mutex_);
+    jobs_.push_back(Job{std::move(sink), std::move(chunk)});
+  }
+  cv_.notify_one();
+}
+
+void BinaryQLogWriter::run() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (true) {
+    cv_.wait(lock, [this] { return stopping_ || !jobs_.empty(); });
+    if (jobs_.empty()) {
+      // Only stop once everything queued is written.
+      return;
+    }
+    auto job = std::move(jobs_.front());
+    jobs_.pop_front();
+    lock.unlock();
+    job.sink->writeChunk(std::move(job.chunk));
+    // Closes the file when this was the last chunk of a finished logger.
+    job.sink.reset();
+    lock.lock();
+  }
+}
+
+std::shared_ptr<BinaryQLogWriter> BinaryQLogWriter::getDefault() {
+  static auto writer = std::make_shared<BinaryQLogWriter>();
+  return writer;
+}
+
+} // namespace quic
@@ -0,0 +1,108 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ *
+ */
+
+#pragma once
+
+#include <folly/File.h>
+#include <folly/io/IOBuf.h>
+
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace quic {
+
+/**
+ * The output file of one BinaryQLogger along with the fixed set of chunks
+ * the logger fills. Chunks come back to the sink once they are written, so
+ * a logger never holds more than maxChunks * chunkSize bytes.
+ */
+class BinaryQLogSink {
+ public:
+  BinaryQLogSink(size_t chunkSize, size_t maxChunks);
+
+  /**
+   * Sets the output file. Must be called before the first chunk is handed to
+   * the writer.
+   */
+  void setFile(folly::File file) {
+    file_ = std::move(file);
+  }
+
+  bool hasFile() const {
+    return file_.fd() != -1;
+  }
+
+  /**
+   * Returns an empty chunk, or nullptr when every chunk is either being
+   * filled or waiting to be written.
+   */
+  std::unique_ptr<folly::IOBuf> getChunk();
+
+  /**
+   * Writes the chunk to the file and recycles it. Called on the writer
+   * thread.
+   */
+  void writeChunk(std::unique_ptr<folly::IOBuf> chunk);
+
+  size_t chunkSize() const {
+    return chunkSize_;
+  }
+
+ private:
+  folly::File file_;
+  size_t chunkSize_;
+  size_t maxChunks_;
+
+  std::mutex mutex_;
+  std::vector<std::unique_ptr<folly::IOBuf>> freeChunks_;
+  size_t numChunks_{0};
+};
+
+/**
+ * Writes the chunks of binary qlog files on a background thread, in the
+ * order they are submitted. A single writer is meant to be shared by the
+ * loggers of all the connections in the process.
+ */
+class BinaryQLogWriter {
+ public:
+  BinaryQLogWriter();
+
+  /**
+   * Writes the chunks still queued before returning.
+   */
+  ~BinaryQLogWriter();
+
+  void write(
+      std::shared_ptr<BinaryQLogSink> sink,
+      std::unique_ptr<folly::IOBuf> chunk);
+
+  /**
+   * The writer used by loggers that are not given one, created on first use.
+   */
+  static std::shared_ptr<BinaryQLogWriter> getDefault();
+
+ private:
+  struct Job {
+    std::shared_ptr<BinaryQLogSink> sink;
+    std::unique_ptr<folly::IOBuf> chunk;
+  };
+
+  void run();
+
+  std::mutex mutex_;
+  std::condition_variable cv_;
+  std::deque<Job> jobs_;
+  bool stopping_{false};
+  std::thread thread_;
+};
+
+} // namespace quic
@@ -0,0 +1,770 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ *
+ */
+
+#include <quic/logging/BinaryQLogger.h>
+
+#include <fcntl.h>
+#include <cstring>
+
+#include <folly/Conv.h>
+#include <quic/logging/BaseQLogger.h>
+
+namespace quic {
+
+BinaryQLogger::BinaryQLogger(
+    VantagePoint vantagePointIn,
+    std::string protocolTypeIn,
+    std::string path,
+    size_t chunkSize,
+    size_t maxChunks,
+    std::shared_ptr<BinaryQLogWriter> writer)
+    : QLogger(vantagePointIn, std::move(protocolTypeIn)),
+      path_(std::move(path)),
+      writer_(writer ? std::move(writer) : BinaryQLogWriter::getDefault()),
+      sink_(std::make_shared<BinaryQLogSink>(chunkSize, maxChunks)) {
+  CHECK_GT(maxChunks, 0);
+  BinaryQLogEncoder::encodeHeader(vantagePoint, record_);
+  CHECK(append(record_)) << "Chunk size too small for the binary qlog header";
+}
+
+BinaryQLogger::~BinaryQLogger() {
+  if (!sink_->hasFile()) {
+    LOG_IF(ERROR, !dcid.hasValue()) << "Error: No dcid found";
+    return;
+  }
+  // The trace is written again in case the scid was set after the dcid.
+  record_.clear();
+  if (numDroppedSinceLastRecord_ > 0) {
+    encoder_.encodeDropped(numDroppedSinceLastRecord_, record_);
+  }
+  encoder_.encodeTrace(BaseQLogger::traceToDynamic(*this), record_);
+  if (!append(record_)) {
+    // Out of chunks, the last record gets a buffer of its own rather than
+    // being lost.
+    if (chunk_) {
+      submitChunk(std::move(chunk_));
+    }
+    chunk_ = folly::IOBuf::copyBuffer(record_);
+  }
+  submitChunk(std::move(chunk_));
+}
+
+void BinaryQLogger::setDcid(folly::Optional<ConnectionId> connID) {
+  if (connID.hasValue()) {
+    dcid = connID.value();
+    if (!sink_->hasFile()) {
+      openFile();
+    }
+    writeTrace();
+  }
+}
+
+void BinaryQLogger::setScid(folly::Optional<ConnectionId> connID) {
+  if (connID.hasValue()) {
+    scid = connID.value();
+  }
+}
+
+void BinaryQLogger::flush() {
+  if (chunk_ && !chunk_->empty() && sink_->hasFile()) {
+    submitChunk(std::move(chunk_));
+  }
+}
+
+void BinaryQLogger::addPacket(
+    const RegularQuicPacket& regularPacket,
+    uint64_t packetSize) {
+  if (!beginRegularPacket(
+          QLogEventType::PacketReceived, regularPacket.header, packetSize)) {
+    return;
+  }
+  uint64_t numPaddingFrames = 0;
+  for (const auto& quicFrame : regularPacket.frames) {
+    addFrame(quicFrame, numPaddingFrames);
+  }
+  if (numPaddingFrames > 0) {
+    addFrameType(FrameType::PADDING);
+    encoder_.addInt(numPaddingFrames);
+  }
+  endEvent();
+}
+
+void BinaryQLogger::addPacket(
+    const RegularQuicWritePacket& writePacket,
+    uint64_t packetSize) {
+  if (!beginRegularPacket(
+          QLogEventType::PacketSent, writePacket.header, packetSize)) {
+    return;
+  }
+  uint64_t numPaddingFrames = 0;
+  for (const auto& quicFrame : writePacket.frames) {
+    addFrame(quicFrame, numPaddingFrames);
+  }
+  if (numPaddingFrames > 0) {
+    addFrameType(FrameType::PADDING);
+    encoder_.addInt(numPaddingFrames);
+  }
+  endEvent();
+}
+
+void BinaryQLogger::addPacket(
+    const VersionNegotiationPacket& versionPacket,
+    uint64_t packetSize,
+    bool isPacketRecvd) {
+  if (!beginEvent(
+          isPacketRecvd ? QLogEventType::PacketReceived
+                        : QLogEventType::PacketSent)) {
+    return;
+  }
+  encoder_.addInt(
+      static_cast<uint64_t>(BinaryQLogPacketKind::VersionNegotiation));
+  encoder_.addString(kVersionNegotiationPacketType);
+  encoder_.addInt(packetSize);
+  encoder_.addInt(versionPacket.versions.size());
+  for (auto version : versionPacket.versions) {
+    encoder_.addInt(static_cast<uint64_t>(version));
+  }
+  endEvent();
+}
+
+void BinaryQLogger::addPacket(
+    const RetryPacket& retryPacket,
+    uint64_t packetSize,
+    bool isPacketRecvd) {
+  if (!beginEvent(
+          isPacketRecvd ? QLogEventType::PacketReceived
+                        : QLogEventType::PacketSent)) {
+    return;
+  }
+  encoder_.addInt(static_cast<uint64_t>(BinaryQLogPacketKind::Retry));
+  encoder_.addString(toQlogString(retryPacket.header.getHeaderType()));
+  encoder_.addInt(packetSize);
+  encoder_.addInt(retryPacket.header.getToken().size());
+  endEvent();
+}
+
+void BinaryQLogger::addConnectionClose(
+    std::string error,
+    std::string reason,
+    bool drainConnection,
+    bool sendCloseImmediately) {
+  if (!beginEvent(QLogEventType::ConnectionClose)) {
+    return;
+  }
+  encoder_.addString(error);
+  encoder_.addString(reason);
+  encoder_.addBool(drainConnection);
+  encoder_.addBool(sendCloseImmediately);
+  endEvent();
+}
+
+void BinaryQLogger::addTransportSummary(
+    uint64_t totalBytesSent,
+    uint64_t totalBytesRecvd,
+    uint64_t sumCurWriteOffset,
+    uint64_t sumMaxObservedOffset,
+    uint64_t sumCurStreamBufferLen,
+    uint64_t totalBytesRetransmitted,
+    uint64_t totalStreamBytesCloned,
+    uint64_t totalBytesCloned,
+    uint64_t totalCryptoDataWritten,
+    uint64_t totalCryptoDataRecvd) {
+  if (!beginEvent(QLogEventType::TransportSummary)) {
+    return;
+  }
+  encoder_.addInt(totalBytesSent);
+  encoder_.addInt(totalBytesRecvd);
+  encoder_.addInt(sumCurWriteOffset);
+  encoder_.addInt(sumMaxObservedOffset);
+  encoder_.addInt(sumCurStreamBufferLen);
+  encoder_.addInt(totalBytesRetransmitted);
+  encoder_.addInt(totalStreamBytesCloned);
+  encoder_.addInt(totalBytesCloned);
+  encoder_.addInt(totalCryptoDataWritten);
+  encoder_.addInt(totalCryptoDataRecvd);
+  endEvent();
+}
+
+void BinaryQLogger::addCongestionMetricUpdate(
+    uint64_t bytesInFlight,
+    uint64_t currentCwnd,
+    std::string congestionEvent,
+    std::string state,
+    std::string recoveryState) {
+  if (!beginEvent(QLogEventType::CongestionMetricUpdate)) {
+    return;
+  }
+  encoder_.addInt(bytesInFlight);
+  encoder_.addInt(currentCwnd);
+  encoder_.addString(congestionEvent);
+  encoder_.addString(state);
+  encoder_.addString(recoveryState);
+  endEvent();
+}
+
+void BinaryQLogger::addPacingMetricUpdate(
+    uint64_t pacingBurstSizeIn,
+    std::chrono::microseconds pacingIntervalIn) {
+  if (!beginEvent(QLogEventType::PacingMetricUpdate)) {
+    return;
+  }
+  encoder_.addInt(pacingBurstSizeIn);
+  encoder_.addInt(pacingIntervalIn.count());
+  endEvent();
+}
+
+void BinaryQLogger::addPacingObservation(
+    std::string actual,
+    std::string expected,
+    std::string conclusion) {
+  if (!beginEvent(QLogEventType::PacingObservation)) {
+    return;
+  }
+  encoder_.addString(actual);
+  encoder_.addString(expected);
+  encoder_.addString(conclusion);
+  endEvent();
+}
+
+void BinaryQLogger::addBandwidthEstUpdate(
+    uint64_t bytes,
+    std::chrono::microseconds interval) {
+  if (!beginEvent(QLogEventType::BandwidthEstUpdate)) {
+    return;
+  }
+  encoder_.addInt(bytes);
+  encoder_.addInt(interval.count());
+  endEvent();
+}
+
+void BinaryQLogger::addAppLimitedUpdate() {
+  if (!beginEvent(QLogEventType::AppLimitedUpdate)) {
+    return;
+  }
+  encoder_.addBool(true);
+  endEvent();
+}
+
+void BinaryQLogger::addAppUnlimitedUpdate() {
+  if (!beginEvent(QLogEventType::AppLimitedUpdate)) {
+    return;
+  }
+  encoder_.addBool(false);
+  endEvent();
+}
+
+void BinaryQLogger::addAppIdleUpdate(std::string idleEvent, bool idle) {
+  if (!beginEvent(QLogEventType::AppIdleUpdate)) {
+    return;
+  }
+  encoder_.addString(idleEvent);
+  encoder_.addBool(idle);
+  endEvent();
+}
+
+void BinaryQLogger::addPacketDrop(size_t packetSize, std::string dropReason) {
+  if (!beginEvent(QLogEventType::PacketDrop)) {
+    return;
+  }
+  encoder_.addInt(packetSize);
+  encoder_.addString(dropReason);
+  endEvent();
+}
+
+void BinaryQLogger::addDatagramReceived(uint64_t dataLen) {
+  if (!beginEvent(QLogEventType::DatagramReceived)) {
+    return;
+  }
+  encoder_.addInt(dataLen);
+  endEvent();
+}
+
+void BinaryQLogger::addLossAlarm(
+    PacketNum largestSent,
+    uint64_t alarmCount,
+    uint64_t outstandingPackets,
+    std::string type) {
+  if (!beginEvent(QLogEventType::LossAlarm)) {
+    return;
+  }
+  encoder_.addInt(largestSent);
+  encoder_.addInt(alarmCount);
+  encoder_.addInt(outstandingPackets);
+  encoder_.addString(type);
+  endEvent();
+}
+
+void BinaryQLogger::addPacketsLost(
+    PacketNum largestLostPacketNum,
+    uint64_t lostBytes,
+    uint64_t lostPackets) {
+  if (!beginEvent(QLogEventType::PacketsLost)) {
+    return;
+  }
+  encoder_.addInt(largestLostPacketNum);
+  encoder_.addInt(lostBytes);
+  encoder_.addInt(lostPackets);
+  endEvent();
+}
+
+void BinaryQLogger::addTransportStateUpdate(std::string update) {
+  if (!beginEvent(QLogEventType::TransportStateUpdate)) {
+    return;
+  }
+  encoder_.addString(update);
+  endEvent();
+}
+
+void BinaryQLogger::addPacketBuffered(
+    PacketNum packetNum,
+    ProtectionType protectionType,
+    uint64_t packetSize) {
+  if (!beginEvent(QLogEventType::PacketBuffered)) {
+    return;
+  }
+  encoder_.addInt(packetNum);
+  encoder_.addInt(static_cast<uint64_t>(protectionType));
+  encoder_.addInt(packetSize);
+  endEvent();
+}
+
+void BinaryQLogger::addMetricUpdate(
+    std::chrono::microseconds latestRtt,
+    std::chrono::microseconds mrtt,
+    std::chrono::microseconds srtt,
+    std::chrono::microseconds ackDelay) {
+  if (!beginEvent(QLogEventType::MetricUpdate)) {
+    return;
+  }
+  encoder_.addInt(latestRtt.count());
+  encoder_.addInt(mrtt.count());
+  encoder_.addInt(srtt.count());
+  encoder_.addInt(ackDelay.count());
+  endEvent();
+}
+
+void BinaryQLogger::addStreamStateUpdate(
+    StreamId id,
+    std::string update,
+    folly::Optional<std::chrono::milliseconds> timeSinceStreamCreation) {
+  if (!beginEvent(QLogEventType::StreamStateUpdate)) {
+    return;
+  }
+  encoder_.addInt(id);
+  encoder_.addString(update);
+  encoder_.addBool(timeSinceStreamCreation.hasValue());
+  if (timeSinceStreamCreation) {
+    encoder_.addInt(timeSinceStreamCreation->count());
+  }
+  endEvent();
+}
+
+void BinaryQLogger::addConnectionMigrationUpdate(bool intentionalMigration) {
+  if (!beginEvent(QLogEventType::ConnectionMigration)) {
+    return;
+  }
+  encoder_.addBool(intentionalMigration);
+  endEvent();
+}
+
+void BinaryQLogger::addPathValidationEvent(bool success) {
+  if (!beginEvent(QLogEventType::PathValidation)) {
+    return;
+  }
+  encoder_.addBool(success);
+  endEvent();
+}
+
+bool BinaryQLogger::beginEvent(QLogEventType type) {
+  if (!chunk_) {
+    // Skip encoding the event when there is no room for it anyway.
+    chunk_ = sink_->getChunk();
+  }
+  if (!chunk_) {
+    numDroppedSinceLastRecord_++;
+    numDroppedEvents_++;
+    return false;
+  }
+  encoder_.beginEvent(
+      type,
+      std::chrono::duration_cast<std::chrono::microseconds>(
+          std::chrono::steady_clock::now() - refTimePoint));
+  return true;
+}
+
+void BinaryQLogger::endEvent() {
+  record_.clear();
+  if (numDroppedSinceLastRecord_ > 0) {
+    BinaryQLogEncoder::encodeDropped(numDroppedSinceLastRecord_, record_);
+  }
+  encoder_.endEvent(record_);
+  if (append(record_)) {
+    numDroppedSinceLastRecord_ = 0;
+    numEvents_++;
+    return;
+  }
+  encoder_.discardLastRecord();
+  numDroppedSinceLastRecord_++;
+  numDroppedEvents_++;
+}
+
+bool BinaryQLogger::beginRegularPacket(
+    QLogEventType type,
+    const PacketHeader& header,
+    uint64_t packetSize) {
+  if (!beginEvent(type)) {
+    return false;
+  }
+  encoder_.addInt(static_cast<uint64_t>(BinaryQLogPacketKind::Regular));
+  const LongHeader* longHeader = header.asLong();
+  if (!longHeader) {
+    encoder_.addString(kShortHeaderPacketType);
+    encoder_.addInt(header.getPacketSequenceNum());
+  } else if (longHeader->getHeaderType() != LongHeader::Types::Retry) {
+    encoder_.addString(toQlogString(longHeader->getHeaderType()));
+    encoder_.addInt(header.getPacketSequenceNum());
+  } else {
+    // A Retry packet does not include a packet number.
+    encoder_.addString(toQlogString(longHeader->getHeaderType()));
+    encoder_.addInt(0);
+  }
+  encoder_.addInt(packetSize);
+  return true;
+}
+
+void BinaryQLogger::addFrame(
+    const QuicFrame& quicFrame,
+    uint64_t& numPaddingFrames) {
+  switch (quicFrame.type()) {
+    case QuicFrame::Type::PaddingFrame_E:
+      ++numPaddingFrames;
+      break;
+    case QuicFrame::Type::RstStreamFrame_E: {
+      const auto& frame = *quicFrame.asRstStreamFrame();
+      addFrameType(FrameType::RST_STREAM);
+      encoder_.addInt(frame.streamId);
+      encoder_.addInt(frame.errorCode);
+      encoder_.addInt(frame.offset);
+      break;
+    }
+    case QuicFrame::Type::ConnectionCloseFrame_E:
+      addConnectionCloseFrame(*quicFrame.asConnectionCloseFrame());
+      break;
+    case QuicFrame::Type::MaxDataFrame_E:
+      addFrameType(FrameType::MAX_DATA);
+      encoder_.addInt(quicFrame.asMaxDataFrame()->maximumData);
+      break;
+    case QuicFrame::Type::MaxStreamDataFrame_E: {
+      const auto& frame = *quicFrame.asMaxStreamDataFrame();
+      addFrameType(FrameType::MAX_STREAM_DATA);
+      encoder_.addInt(frame.streamId);
+      encoder_.addInt(frame.maximumData);
+      break;
+    }
+    case QuicFrame::Type::DataBlockedFrame_E:
+      addFrameType(FrameType::DATA_BLOCKED);
+      encoder_.addInt(quicFrame.asDataBlockedFrame()->dataLimit);
+      break;
+    case QuicFrame::Type::StreamDataBlockedFrame_E: {
+      const auto& frame = *quicFrame.asStreamDataBlockedFrame();
+      addFrameType(FrameType::STREAM_DATA_BLOCKED);
+      encoder_.addInt(frame.streamId);
+      encoder_.addInt(frame.dataLimit);
+      break;
+    }
+    case QuicFrame::Type::StreamsBlockedFrame_E: {
+      const auto& frame = *quicFrame.asStreamsBlockedFrame();
+      addFrameType(
+          frame.isForBidirectional ? FrameType::STREAMS_BLOCKED_BIDI
+                                   : FrameType::STREAMS_BLOCKED_UNI);
+      encoder_.addInt(frame.streamLimit);
+      break;
+    }
+    case QuicFrame::Type::ReadAckFrame_E: {
+      const auto& frame = *quicFrame.asReadAckFrame();
+      addFrameType(FrameType::ACK);
+      encoder_.addInt(frame.ackDelay.count());
+      encoder_.addInt(frame.ackBlocks.size());
+      for (const auto& block : frame.ackBlocks) {
+        encoder_.addInt(block.startPacket);
+        encoder_.addInt(block.endPacket);
+      }
+      break;
+    }
+    case QuicFrame::Type::ReadStreamFrame_E: {
+      const auto& frame = *quicFrame.asReadStreamFrame();
+      addFrameType(FrameType::STREAM);
+      encoder_.addInt(frame.streamId);
+      encoder_.addInt(frame.offset);
+      encoder_.addInt(frame.data->length());
+      encoder_.addBool(frame.fin);
+      break;
+    }
+    case QuicFrame::Type::ReadCryptoFrame_E: {
+      const auto& frame = *quicFrame.asReadCryptoFrame();
+      addFrameType(FrameType::CRYPTO_FRAME);
+      encoder_.addInt(frame.offset);
+      encoder_.addInt(frame.data->length());
+      break;
+    }
+    case QuicFrame::Type::ReadNewTokenFrame_E:
+      addFrameType(FrameType::NEW_TOKEN);
+      break;
+    case QuicFrame::Type::PingFrame_E:
+      addFrameType(FrameType::PING);
+      break;
+    case QuicFrame::Type::QuicSimpleFrame_E:
+      addSimpleFrame(*quicFrame.asQuicSimpleFrame());
+      break;
+    case QuicFrame::Type::NoopFrame_E:
+      break;
+    case QuicFrame::Type::DatagramFrame_E:
+      addFrameType(FrameType::DATAGRAM);
+      encoder_.addInt(quicFrame.asDatagramFrame()->length);
+      break;
+  }
+}
+
+void BinaryQLogger::addFrame(
+    const QuicWriteFrame& quicFrame,
+    uint64_t& numPaddingFrames) {
+  switch (quicFrame.type()) {
+    case QuicWriteFrame::Type::PaddingFrame_E:
+      ++numPaddingFrames;
+      break;
+    case QuicWriteFrame::Type::RstStreamFrame_E: {
+      const RstStreamFrame& frame = *quicFrame.asRstStreamFrame();
+      addFrameType(FrameType::RST_STREAM);
+      encoder_.addInt(frame.streamId);
+      encoder_.addInt(frame.errorCode);
+      encoder_.addInt(frame.offset);
+      break;
+    }
+    case QuicWriteFrame::Type::ConnectionCloseFrame_E:
+      addConnectionCloseFrame(*quicFrame.asConnectionCloseFrame());
+      break;
+    case QuicWriteFrame::Type::MaxDataFrame_E:
+      addFrameType(FrameType::MAX_DATA);
+      encoder_.addInt(quicFrame.asMaxDataFrame()->maximumData);
+      break;
+    case QuicWriteFrame::Type::MaxStreamDataFrame_E: {
+      const MaxStreamDataFrame& frame = *quicFrame.asMaxStreamDataFrame();
+      addFrameType(FrameType::MAX_STREAM_DATA);
+      encoder_.addInt(frame.streamId);
+      encoder_.addInt(frame.maximumData);
+      break;
+    }
+    case QuicWriteFrame::Type::StreamsBlockedFrame_E: {
+      const StreamsBlockedFrame& frame = *quicFrame.asStreamsBlockedFrame();
+      addFrameType(
+          frame.isForBidirectional ? FrameType::STREAMS_BLOCKED_BIDI
+                                   : FrameType::STREAMS_BLOCKED_UNI);
+      encoder_.addInt(frame.streamLimit);
+      break;
+    }
+    case QuicWriteFrame::Type::DataBlockedFrame_E:
+      addFrameType(FrameType::DATA_BLOCKED);
+      encoder_.addInt(quicFrame.asDataBlockedFrame()->dataLimit);
+      break;
+    case QuicWriteFrame::Type::StreamDataBlockedFrame_E: {
+      const StreamDataBlockedFrame& frame =
+          *quicFrame.asStreamDataBlockedFrame();
+      addFrameType(FrameType::STREAM_DATA_BLOCKED);
+      encoder_.addInt(frame.streamId);
+      encoder_.addInt(frame.dataLimit);
+      break;
+    }
+    case QuicWriteFrame::Type::WriteAckFrame_E: {
+      const WriteAckFrame& frame = *quicFrame.asWriteAckFrame();
+      addFrameType(FrameType::ACK);
+      encoder_.addInt(frame.ackDelay.count());
+      encoder_.addInt(frame.ackBlocks.size());
+      for (const auto& block : frame.ackBlocks) {
+        encoder_.addInt(block.start);
+        encoder_.addInt(block.end);
+      }
+      break;
+    }
+    case QuicWriteFrame::Type::WriteStreamFrame_E: {
+      const WriteStreamFrame& frame = *quicFrame.asWriteStreamFrame();
+      addFrameType(FrameType::STREAM);
+      encoder_.addInt(frame.streamId);
+      encoder_.addInt(frame.offset);
+      encoder_.addInt(frame.len);
+      encoder_.addBool(frame.fin);
+      break;
+    }
+    case QuicWriteFrame::Type::WriteCryptoFrame_E: {
+      const WriteCryptoFrame& frame = *quicFrame.asWriteCryptoFrame();
+      addFrameType(FrameType::CRYPTO_FRAME);
+      encoder_.addInt(frame.offset);
+      encoder_.addInt(frame.len);
+      break;
+    }
+    case QuicWriteFrame::Type::QuicSimpleFrame_E:
+      addSimpleFrame(*quicFrame.asQuicSimpleFrame());
+      break;
+    case QuicWriteFrame::Type::DatagramFrame_E:
+      addFrameType(FrameType::DATAGRAM);
+      encoder_.addInt(quicFrame.asDatagramFrame()->length);
+      break;
+    default:
+      break;
+  }
+}
+
+void BinaryQLogger::addSimpleFrame(const QuicSimpleFrame& simpleFrame) {
+  switch (simpleFrame.type()) {
+    case QuicSimpleFrame::Type::StopSendingFrame_E: {
+      const StopSendingFrame& frame = *simpleFrame.asStopSendingFrame();
+      addFrameType(FrameType::STOP_SENDING);
+      encoder_.addInt(frame.streamId);
+      encoder_.addInt(frame.errorCode);
+      break;
+    }
+    case QuicSimpleFrame::Type::MinStreamDataFrame_E: {
+      const MinStreamDataFrame& frame = *simpleFrame.asMinStreamDataFrame();
+      addFrameType(FrameType::MIN_STREAM_DATA);
+      encoder_.addInt(frame.streamId);
+      encoder_.addInt(frame.maximumData);
+      encoder_.addInt(frame.minimumStreamOffset);
+      break;
+    }
+    case QuicSimpleFrame::Type::ExpiredStreamDataFrame_E: {
+      const ExpiredStreamDataFrame& frame =
+          *simpleFrame.asExpiredStreamDataFrame();
+      addFrameType(FrameType::EXPIRED_STREAM_DATA);
+      encoder_.addInt(frame.streamId);
+      encoder_.addInt(frame.minimumStreamOffset);
+      break;
+    }
+    case QuicSimpleFrame::Type::PathChallengeFrame_E:
+      addFrameType(FrameType::PATH_CHALLENGE);
+      encoder_.addInt(simpleFrame.asPathChallengeFrame()->pathData);
+      break;
+    case QuicSimpleFrame::Type::PathResponseFrame_E:
+      addFrameType(FrameType::PATH_RESPONSE);
+      encoder_.addInt(simpleFrame.asPathResponseFrame()->pathData);
+      break;
+    case QuicSimpleFrame::Type::NewConnectionIdFrame_E: {
+      const NewConnectionIdFrame& frame = *simpleFrame.asNewConnectionIdFrame();
+      addFrameType(FrameType::NEW_CONNECTION_ID);
+      encoder_.addInt(frame.sequenceNumber);
+      encoder_.addBytes(folly::range(frame.token));
+      break;
+    }
+    case QuicSimpleFrame::Type::MaxStreamsFrame_E: {
+      const MaxStreamsFrame& frame = *simpleFrame.asMaxStreamsFrame();
+      addFrameType(
+          frame.isForBidirectional ? FrameType::MAX_STREAMS_BIDI
+                                   : FrameType::MAX_STREAMS_UNI);
+      encoder_.addInt(frame.maxStreams);
+      break;
+    }
+    case QuicSimpleFrame::Type::RetireConnectionIdFrame_E:
+      addFrameType(FrameType::RETIRE_CONNECTION_ID);
+      encoder_.addInt(simpleFrame.asRetireConnectionIdFrame()->sequenceNumber);
+      break;
+    case QuicSimpleFrame::Type::HandshakeDoneFrame_E:
+      addFrameType(FrameType::HANDSHAKE_DONE);
+      break;
+    case QuicSimpleFrame::Type::AckFrequencyFrame_E: {
+      const AckFrequencyFrame& frame = *simpleFrame.asAckFrequencyFrame();
+      addFrameType(FrameType::ACK_FREQUENCY);
+      encoder_.addInt(frame.sequenceNumber);
+      encoder_.addInt(frame.packetTolerance);
+      encoder_.addInt(frame.updateMaxAckDelay);
+      encoder_.addBool(frame.ignoreOrder);
+      break;
+    }
+    case QuicSimpleFrame::Type::ImmediateAckFrame_E:
+      addFrameType(FrameType::IMMEDIATE_ACK);
+      break;
+    case QuicSimpleFrame::Type::NewTokenFrame_E:
+      addFrameType(FrameType::NEW_TOKEN);
+      break;
+  }
+}
+
+void BinaryQLogger::addConnectionCloseFrame(const ConnectionCloseFrame& frame) {
+  addFrameType(FrameType::CONNECTION_CLOSE);
+  encoder_.addInt(static_cast<uint64_t>(frame.errorCode.type()));
+  switch (frame.errorCode.type()) {
+    case QuicErrorCode::Type::ApplicationErrorCode_E:
+      encoder_.addInt(*frame.errorCode.asApplicationErrorCode());
+      break;
+    case QuicErrorCode::Type::LocalErrorCode_E:
+      encoder_.addInt(
+          static_cast<uint64_t>(*frame.errorCode.asLocalErrorCode()));
+      break;
+    case QuicErrorCode::Type::TransportErrorCode_E:
+      encoder_.addInt(
+          static_cast<uint64_t>(*frame.errorCode.asTransportErrorCode()));
+      break;
+  }
+  encoder_.addString(frame.reasonPhrase);
+  encoder_.addInt(static_cast<uint64_t>(frame.closingFrameType));
+}
+
+void BinaryQLogger::addFrameType(FrameType type) {
+  encoder_.addInt(static_cast<uint64_t>(type));
+}
+
+void BinaryQLogger::openFile() {
+  auto outputPath = folly::to<std::string>(
+      path_, "/", dcid->hex(), kBinaryQLogFileExtension);
+  try {
+    sink_->setFile(folly::File(outputPath, O_WRONLY | O_CREAT | O_TRUNC));
+  } catch (const std::system_error& ex) {
+    LOG(ERROR) << "Error: Can't open binary qlog " << outputPath << ": "
+               << ex.what();
+    return;
+  }
+  for (auto& chunk : pendingChunks_) {
+    writer_->write(sink_, std::move(chunk));
+  }
+  pendingChunks_.clear();
+}
+
+void BinaryQLogger::writeTrace() {
+  record_.clear();
+  encoder_.encodeTrace(BaseQLogger::traceToDynamic(*this), record_);
+  if (!append(record_)) {
+    // The destructor writes the trace again.
+    encoder_.discardLastRecord();
+  }
+}
+
+bool BinaryQLogger::append(folly::StringPiece data) {
+  if (data.size() > sink_->chunkSize()) {
+    // Records are never split, so one larger than a chunk cannot be written.
+    return false;
+  }
+  if (chunk_ && chunk_->tailroom() < data.size()) {
+    submitChunk(std::move(chunk_));
+  }
+  if (!chunk_) {
+    chunk_ = sink_->getChunk();
+  }
+  if (!chunk_) {
+    return false;
+  }
+  memcpy(chunk_->writableTail(), data.data(), data.size());
+  chunk_->append(data.size());
+  return true;
+}
+
+void BinaryQLogger::submitChunk(std::unique_ptr<folly::IOBuf> chunk) {
+  if (sink_->hasFile()) {
+    writer_->write(sink_, std::move(chunk));
+  } else {
+    pendingChunks_.push_back(std::move(chunk));
+  }
+}
+
+} // namespace quic
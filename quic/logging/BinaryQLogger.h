@@ -0,0 +1,173 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ *
+ */
+
+#pragma once
+
+#include <quic/logging/BinaryQLogCodec.h>
+#include <quic/logging/QLogger.h>
+#include <quic/logging/BinaryQLogWriter.h>
+
+namespace quic {
+
+constexpr size_t kDefaultBinaryQLogChunkSize = 64 * 1024;
+constexpr size_t kDefaultBinaryQLogMaxChunks = 16;
+
+/**
+ * QLogger that keeps memory bounded on long-lived connections. Events are
+ * encoded in the binary format of BinaryQLogCodec.h into a fixed number of
+ * chunks, and full chunks are written to <path>/<dcid>.bqlog by a background
+ * BinaryQLogWriter. When every chunk is waiting to be written, events are
+ * dropped and counted in the file instead of buffered.
+ *
+ * The add* functions write the fields of each event straight into the chunk,
+ * without building a QLogEvent, so logging does not allocate once the strings
+ * the events use have been interned.
+ *
+ * binaryQLogToDynamic() turns the file into the JSON that FileQLogger writes.
+ */
+class BinaryQLogger : public QLogger {
+ public:
+  explicit BinaryQLogger(
+      VantagePoint vantagePointIn,
+      std::string protocolTypeIn = kHTTP3ProtocolType,
+      std::string path = "",
+      size_t chunkSize = kDefaultBinaryQLogChunkSize,
+      size_t maxChunks = kDefaultBinaryQLogMaxChunks,
+      std::shared_ptr<BinaryQLogWriter> writer = nullptr);
+
+  ~BinaryQLogger() override;
+
+  void addPacket(const RegularQuicPacket& regularPacket, uint64_t packetSize)
+      override;
+  void addPacket(
+      const VersionNegotiationPacket& versionPacket,
+      uint64_t packetSize,
+      bool isPacketRecvd) override;
+  void addPacket(const RegularQuicWritePacket& writePacket, uint64_t packetSize)
+      override;
+  void addPacket(
+      const RetryPacket& retryPacket,
+      uint64_t packetSize,
+      bool isPacketRecvd) override;
+  void addConnectionClose(
+      std::string error,
+      std::string reason,
+      bool drainConnection,
+      bool sendCloseImmediately) override;
+  void addTransportSummary(
+      uint64_t totalBytesSent,
+      uint64_t totalBytesRecvd,
+      uint64_t sumCurWriteOffset,
+      uint64_t sumMaxObservedOffset,
+      uint64_t sumCurStreamBufferLen,
+      uint64_t totalBytesRetransmitted,
+      uint64_t totalStreamBytesCloned,
+      uint64_t totalBytesCloned,
+      uint64_t totalCryptoDataWritten,
+      uint64_t totalCryptoDataRecvd) override;
+  void addCongestionMetricUpdate(
+      uint64_t bytesInFlight,
+      uint64_t currentCwnd,
+      std::string congestionEvent,
+      std::string state = "",
+      std::string recoveryState = "") override;
+  void addPacingMetricUpdate(
+      uint64_t pacingBurstSizeIn,
+      std::chrono::microseconds pacingIntervalIn) override;
+  void addPacingObservation(
+      std::string actual,
+      std::string expected,
+      std::string conclusion) override;
+  void addBandwidthEstUpdate(uint64_t bytes, std::chrono::microseconds interval)
+      override;
+  void addAppLimitedUpdate() override;
+  void addAppUnlimitedUpdate() override;
+  void addAppIdleUpdate(std::string idleEvent, bool idle) override;
+  void addPacketDrop(size_t packetSize, std::string dropReasonIn) override;
+  void addDatagramReceived(uint64_t dataLen) override;
+  void addLossAlarm(
+      PacketNum largestSent,
+      uint64_t alarmCount,
+      uint64_t outstandingPackets,
+      std::string type) override;
+  void addPacketsLost(
+      PacketNum largestLostPacketNum,
+      uint64_t lostBytes,
+      uint64_t lostPackets) override;
+  void addTransportStateUpdate(std::string update) override;
+  void addPacketBuffered(
+      PacketNum packetNum,
+      ProtectionType protectionType,
+      uint64_t packetSize) override;
+  void addMetricUpdate(
+      std::chrono::microseconds latestRtt,
+      std::chrono::microseconds mrtt,
+      std::chrono::microseconds srtt,
+      std::chrono::microseconds ackDelay) override;
+  void addStreamStateUpdate(
+      StreamId id,
+      std::string update,
+      folly::Optional<std::chrono::milliseconds> timeSinceStreamCreation)
+      override;
+  void addConnectionMigrationUpdate(bool intentionalMigration) override;
+  void addPathValidationEvent(bool success) override;
+
+  void setDcid(folly::Optional<ConnectionId> connID) override;
+  void setScid(folly::Optional<ConnectionId> connID) override;
+
+  /**
+   * Hands the events logged so far to the writer without waiting for the
+   * current chunk to fill up.
+   */
+  void flush();
+
+  uint64_t numEvents() const {
+    return numEvents_;
+  }
+
+  uint64_t numDroppedEvents() const {
+    return numDroppedEvents_;
+  }
+
+ private:
+  /**
+   * Starts encoding an event, unless there is no chunk to write it to, in
+   * which case the event is counted as dropped and false is returned.
+   */
+  bool beginEvent(QLogEventType type);
+  void endEvent();
+  bool beginRegularPacket(
+      QLogEventType type,
+      const PacketHeader& header,
+      uint64_t packetSize);
+  void addFrame(const QuicFrame& quicFrame, uint64_t& numPaddingFrames);
+  void addFrame(const QuicWriteFrame& quicFrame, uint64_t& numPaddingFrames);
+  void addSimpleFrame(const QuicSimpleFrame& simpleFrame);
+  void addConnectionCloseFrame(const ConnectionCloseFrame& frame);
+  void addFrameType(FrameType type);
+  void openFile();
+  void writeTrace();
+  bool append(folly::StringPiece data);
+  void submitChunk(std::unique_ptr<folly::IOBuf> chunk);
+
+  std::string path_;
+  std::shared_ptr<BinaryQLogWriter> writer_;
+  std::shared_ptr<BinaryQLogSink> sink_;
+  BinaryQLogEncoder encoder_;
+  std::unique_ptr<folly::IOBuf> chunk_;
+  // Full chunks waiting for the file to be opened once the dcid is known.
+  std::vector<std::unique_ptr<folly::IOBuf>> pendingChunks_;
+  // Reused to encode every record.
+  std::string record_;
+
+  uint64_t numEvents_{0};
+  uint64_t numDroppedEvents_{0};
+  uint64_t numDroppedSinceLastRecord_{0};
+};
+
+} // namespace quic
@@ -38,84 +38,8 @@ class FileQLogger : public BaseQLogger {
       finishStream();
     }
   }
-  void addPacket(const RegularQuicPacket& regularPacket, uint64_t packetSize)
-      override;
-  void addPacket(
-      const VersionNegotiationPacket& versionPacket,
-      uint64_t packetSize,
-      bool isPacketRecvd) override;
-  void addPacket(const RegularQuicWritePacket& writePacket, uint64_t packetSize)
-      override;
-  void addPacket(
-      const RetryPacket& retryPacket,
-      uint64_t packetSize,
-      bool isPacketRecvd) override;
-  void addConnectionClose(
-      std::string error,
-      std::string reason,
-      bool drainConnection,
-      bool sendCloseImmediately) override;
-  void addTransportSummary(
-      uint64_t totalBytesSent,
-      uint64_t totalBytesRecvd,
-      uint64_t sumCurWriteOffset,
-      uint64_t sumMaxObservedOffset,
-      uint64_t sumCurStreamBufferLen,
-      uint64_t totalBytesRetransmitted,
-      uint64_t totalStreamBytesCloned,
-      uint64_t totalBytesCloned,
-      uint64_t totalCryptoDataWritten,
-      uint64_t totalCryptoDataRecvd) override;
-  void addCongestionMetricUpdate(
-      uint64_t bytesInFlight,
-      uint64_t currentCwnd,
-      std::string congestionEvent,
-      std::string state = "",
-      std::string recoveryState = "") override;
-  void addPacingMetricUpdate(
-      uint64_t pacingBurstSizeIn,
-      std::chrono::microseconds pacingIntervalIn) override;
-  void addPacingObservation(
-      std::string actual,
-      std::string expected,
-      std::string conclusion) override;
-  void addBandwidthEstUpdate(uint64_t bytes, std::chrono::microseconds interval)
-      override;
-  void addAppLimitedUpdate() override;
-  void addAppUnlimitedUpdate() override;
-  void addAppIdleUpdate(std::string idleEvent, bool idle) override;
-  void addPacketDrop(size_t packetSize, std::string dropReasonIn) override;
-  void addDatagramReceived(uint64_t dataLen) override;
-  void addLossAlarm(
-      PacketNum largestSent,
-      uint64_t alarmCount,
-      uint64_t outstandingPackets,
-      std::string type) override;
-  void addPacketsLost(
-      PacketNum largestLostPacketNum,
-      uint64_t lostBytes,
-      uint64_t lostPackets) override;
-  void addTransportStateUpdate(std::string update) override;
-  void addPacketBuffered(
-      PacketNum packetNum,
-      ProtectionType protectionType,
-      uint64_t packetSize) override;
-  void addMetricUpdate(
-      std::chrono::microseconds latestRtt,
-      std::chrono::microseconds mrtt,
-      std::chrono::microseconds srtt,
-      std::chrono::microseconds ackDelay) override;
-  void addStreamStateUpdate(
-      StreamId id,
-      std::string update,
-      folly::Optional<std::chrono::milliseconds> timeSinceStreamCreation)
-      override;
-  virtual void addConnectionMigrationUpdate(bool intentionalMigration) override;
-  virtual void addPathValidationEvent(bool success) override;
-
   void outputLogsToFile(const std::string& path, bool prettyJson);
   folly::dynamic toDynamic() const;
-  folly::dynamic toDynamicBase() const;
   folly::dynamic generateSummary(
       size_t numEvents,
       std::chrono::microseconds startTime,
@@ -127,7 +51,7 @@ class FileQLogger : public BaseQLogger {
  private:
   void setupStream();
   void finishStream();
-  void handleEvent(std::unique_ptr<QLogEvent> event);
+  void handleEvent(std::unique_ptr<QLogEvent> event) override;
 
   std::unique_ptr<folly::AsyncFileWriter> writer_;
 
@@ -77,6 +77,13 @@ folly::StringPiece toQlogString(FrameType frame) {
       return "expired_stream_data";
     case FrameType::HANDSHAKE_DONE:
       return "handshake_done";
+    case FrameType::DATAGRAM:
+    case FrameType::DATAGRAM_LEN:
+      return "datagram";
+    case FrameType::IMMEDIATE_ACK:
+      return "immediate_ack";
+    case FrameType::ACK_FREQUENCY:
+      return "ack_frequency";
   }
   folly::assume_unreachable();
 }
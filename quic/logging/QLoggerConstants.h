@@ -62,6 +62,9 @@ constexpr auto kDerivedOneRttWriteCipher = "derived 1-rtt write cipher";
 constexpr auto kZeroRttRejected = "zerortt rejected";
 constexpr auto kZeroRttAccepted = "zerortt accepted";
 constexpr auto kZeroRttAttempted = "zerortt attempted";
+constexpr auto kEcnCapable = "ecn capable";
+constexpr auto kEcnValidationFailed = "ecn validation failed";
+constexpr auto kCongestionEcnCe = "congestion ecn ce";
 constexpr auto kRecalculateTimeToOrigin = "recalculate time to origin";
 constexpr auto kAbort = "abort";
 constexpr auto kQLogVersion = "draft-00";
@@ -219,12 +219,35 @@ folly::dynamic ReadNewTokenFrameLog::toDynamic() const {
   return d;
 }
 
+folly::dynamic DatagramFrameLog::toDynamic() const {
+  folly::dynamic d = folly::dynamic::object();
+  d["frame_type"] = toQlogString(FrameType::DATAGRAM);
+  d["length"] = len;
+  return d;
+}
+
 folly::dynamic HandshakeDoneFrameLog::toDynamic() const {
   folly::dynamic d = folly::dynamic::object();
   d["frame_type"] = toQlogString(FrameType::HANDSHAKE_DONE);
   return d;
 }
 
+folly::dynamic AckFrequencyFrameLog::toDynamic() const {
+  folly::dynamic d = folly::dynamic::object();
+  d["frame_type"] = toQlogString(FrameType::ACK_FREQUENCY);
+  d["sequence_number"] = sequenceNumber;
+  d["packet_tolerance"] = packetTolerance;
+  d["update_max_ack_delay"] = updateMaxAckDelay;
+  d["ignore_order"] = ignoreOrder;
+  return d;
+}
+
+folly::dynamic ImmediateAckFrameLog::toDynamic() const {
+  folly::dynamic d = folly::dynamic::object();
+  d["frame_type"] = toQlogString(FrameType::IMMEDIATE_ACK);
+  return d;
+}
+
 folly::dynamic VersionNegotiationLog::toDynamic() const {
   folly::dynamic d = folly::dynamic::object();
   d = folly::dynamic::array();
@@ -280,6 +280,15 @@ class ReadNewTokenFrameLog : public QLogFrame {
   folly::dynamic toDynamic() const override;
 };
 
+class DatagramFrameLog : public QLogFrame {
+ public:
+  uint64_t len;
+
+  explicit DatagramFrameLog(uint64_t lenIn) : len{lenIn} {}
+  ~DatagramFrameLog() override = default;
+  folly::dynamic toDynamic() const override;
+};
+
 class HandshakeDoneFrameLog : public QLogFrame {
  public:
   HandshakeDoneFrameLog() = default;
@@ -287,6 +296,33 @@ class HandshakeDoneFrameLog : public QLogFrame {
   folly::dynamic toDynamic() const override;
 };
 
+class AckFrequencyFrameLog : public QLogFrame {
+ public:
+  uint64_t sequenceNumber;
+  uint64_t packetTolerance;
+  uint64_t updateMaxAckDelay;
+  bool ignoreOrder;
+
+  AckFrequencyFrameLog(
+      uint64_t sequenceNumberIn,
+      uint64_t packetToleranceIn,
+      uint64_t updateMaxAckDelayIn,
+      bool ignoreOrderIn)
+      : sequenceNumber(sequenceNumberIn),
+        packetTolerance(packetToleranceIn),
+        updateMaxAckDelay(updateMaxAckDelayIn),
+        ignoreOrder(ignoreOrderIn) {}
+  ~AckFrequencyFrameLog() override = default;
+  folly::dynamic toDynamic() const override;
+};
+
+class ImmediateAckFrameLog : public QLogFrame {
+ public:
+  ImmediateAckFrameLog() = default;
+  ~ImmediateAckFrameLog() override = default;
+  folly::dynamic toDynamic() const override;
+};
+
 class VersionNegotiationLog {
  public:
   std::vector<QuicVersion> versions;
@@ -0,0 +1,301 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ *
+ */
+
+#include <quic/logging/BinaryQLogger.h>
+
+#include <boost/filesystem.hpp>
+#include <folly/FileUtil.h>
+#include <folly/Random.h>
+#include <gtest/gtest.h>
+#include <quic/common/test/TestUtils.h>
+#include <quic/logging/FileQLogger.h>
+#include <quic/logging/QLoggerTypes.h>
+
+#include <cstdlib>
+#include <new>
+
+using namespace testing;
+
+namespace {
+// Allocations made by the current thread while countAllocations is set.
+thread_local bool countAllocations = false;
+thread_local size_t numAllocations = 0;
+} // namespace
+
+void* operator new(size_t size) {
+  if (countAllocations) {
+    numAllocations++;
+  }
+  if (void* ptr = std::malloc(size ? size : 1)) {
+    return ptr;
+  }
+  throw std::bad_alloc();
+}
+
+void operator delete(void* ptr) noexcept {
+  std::free(ptr);
+}
+
+void operator delete(void* ptr, size_t /* size */) noexcept {
+  std::free(ptr);
+}
+
+namespace quic {
+namespace test {
+
+class BinaryQLoggerTest : public Test {
+ public:
+  void SetUp() override {
+    dir_ = boost::filesystem::temp_directory_path().string();
+    dcid_ = ConnectionId(std::vector<uint8_t>{
+        static_cast<uint8_t>(folly::Random::rand32()),
+        static_cast<uint8_t>(folly::Random::rand32()),
+        static_cast<uint8_t>(folly::Random::rand32()),
+        static_cast<uint8_t>(folly::Random::rand32())});
+    writer_ = std::make_shared<BinaryQLogWriter>();
+  }
+
+  void logEvents(QLogger& q) {
+    q.addPacket(createRegularQuicWritePacket(10, 0, 100, true), 150);
+    auto writePacket = createPacketWithAckFrames();
+    writePacket.frames.emplace_back(PaddingFrame());
+    writePacket.frames.emplace_back(ConnectionCloseFrame(
+        QuicErrorCode(TransportErrorCode::PROTOCOL_VIOLATION),
+        "bad frame",
+        FrameType::STREAM));
+    writePacket.frames.emplace_back(QuicSimpleFrame(MaxStreamsFrame(20, true)));
+    writePacket.frames.emplace_back(PaddingFrame());
+    q.addPacket(writePacket, 1200);
+    RegularQuicPacket readPacket(
+        ShortHeader(ProtectionType::KeyPhaseZero, getTestConnectionId(1), 7));
+    ReadAckFrame ackFrame;
+    ackFrame.ackBlocks.emplace_back(1, 5);
+    ackFrame.ackDelay = std::chrono::microseconds(25);
+    readPacket.frames.emplace_back(std::move(ackFrame));
+    readPacket.frames.emplace_back(PingFrame());
+    q.addPacket(readPacket, 40);
+    q.addPacket(createVersionNegotiationPacket(), 30, true);
+    q.addCongestionMetricUpdate(20, 30, kPersistentCongestion, "steady");
+    q.addTransportStateUpdate(kDerivedOneRttWriteCipher);
+    q.addMetricUpdate(
+        std::chrono::microseconds(100),
+        std::chrono::microseconds(80),
+        std::chrono::microseconds(90),
+        std::chrono::microseconds(5));
+    q.addStreamStateUpdate(10, kOnHeaders, std::chrono::milliseconds(20));
+    q.addPacketDrop(1500, kMaxBuffered);
+    q.addConnectionClose("idle timeout", kNoData, true, false);
+  }
+
+  // Waits for the writer and converts the file of the connection.
+  folly::dynamic readBinaryQLog() {
+    writer_.reset();
+    std::string binaryQLog;
+    auto path = folly::to<std::string>(
+        dir_, "/", dcid_.hex(), kBinaryQLogFileExtension);
+    EXPECT_TRUE(folly::readFile(path.c_str(), binaryQLog));
+    return binaryQLogToDynamic(
+        folly::ByteRange(folly::StringPiece(binaryQLog)));
+  }
+
+  // Event times differ between two loggers.
+  static void clearTimes(folly::dynamic& qLog) {
+    for (auto& event : qLog["traces"][0]["events"]) {
+      event[0] = "0";
+    }
+    qLog["summary"]["max_duration"] = 0;
+  }
+
+ protected:
+  std::string dir_;
+  ConnectionId dcid_{std::vector<uint8_t>()};
+  std::shared_ptr<BinaryQLogWriter> writer_;
+};
+
+TEST_F(BinaryQLoggerTest, ConvertsToFileQLoggerJson) {
+  FileQLogger fileQLogger(VantagePoint::Server);
+  fileQLogger.setDcid(dcid_);
+  fileQLogger.setScid(getTestConnectionId(1));
+  logEvents(fileQLogger);
+  auto expected = fileQLogger.toDynamic();
+
+  auto q = std::make_unique<BinaryQLogger>(
+      VantagePoint::Server,
+      kHTTP3ProtocolType,
+      dir_,
+      kDefaultBinaryQLogChunkSize,
+      kDefaultBinaryQLogMaxChunks,
+      writer_);
+  q->setDcid(dcid_);
+  logEvents(*q);
+  // The scid set after the dcid makes it to the file.
+  q->setScid(getTestConnectionId(1));
+  EXPECT_EQ(10, q->numEvents());
+  EXPECT_EQ(0, q->numDroppedEvents());
+  q.reset();
+
+  auto converted = readBinaryQLog();
+  EXPECT_EQ(10, converted["summary"]["total_event_count"].asInt());
+  clearTimes(expected);
+  clearTimes(converted);
+  EXPECT_EQ(expected, converted);
+}
+
+TEST_F(BinaryQLoggerTest, EventsBeforeDcid) {
+  auto q = std::make_unique<BinaryQLogger>(
+      VantagePoint::Client,
+      kHTTP3ProtocolType,
+      dir_,
+      kDefaultBinaryQLogChunkSize,
+      kDefaultBinaryQLogMaxChunks,
+      writer_);
+  q->addTransportStateUpdate(kZeroRttAttempted);
+  q->setDcid(dcid_);
+  q->addTransportStateUpdate(kZeroRttAccepted);
+  q.reset();
+
+  auto converted = readBinaryQLog();
+  auto& events = converted["traces"][0]["events"];
+  ASSERT_EQ(2, events.size());
+  EXPECT_EQ(kZeroRttAttempted, events[0][3]["update"].asString());
+  EXPECT_EQ(kZeroRttAccepted, events[1][3]["update"].asString());
+  EXPECT_EQ(
+      dcid_.hex(), converted["traces"][0]["common_fields"]["dcid"].asString());
+}
+
+TEST_F(BinaryQLoggerTest, DropsEventsWhenOutOfChunks) {
+  // Without a dcid no chunk can be written, so the two chunks fill up.
+  auto q = std::make_unique<BinaryQLogger>(
+      VantagePoint::Server, kHTTP3ProtocolType, dir_, 512, 2, writer_);
+  for (size_t i = 0; i < 100; i++) {
+    q->addPacketsLost(i, 1000, 1);
+  }
+  EXPECT_GT(q->numEvents(), 0);
+  EXPECT_LT(q->numEvents(), 100);
+  EXPECT_EQ(100, q->numEvents() + q->numDroppedEvents());
+  auto numEvents = q->numEvents();
+  auto numDroppedEvents = q->numDroppedEvents();
+  q->setDcid(dcid_);
+  q.reset();
+
+  auto converted = readBinaryQLog();
+  EXPECT_EQ(numEvents, converted["summary"]["total_event_count"].asInt());
+  EXPECT_EQ(
+      numDroppedEvents, converted["summary"]["dropped_event_count"].asInt());
+  auto& events = converted["traces"][0]["events"];
+  for (size_t i = 0; i < events.size(); i++) {
+    EXPECT_EQ(
+        static_cast<int64_t>(i),
+        events[i][3]["largest_lost_packet_num"].asInt());
+  }
+}
+
+TEST_F(BinaryQLoggerTest, NoAllocationPerEvent) {
+  auto q = std::make_unique<BinaryQLogger>(
+      VantagePoint::Server,
+      kHTTP3ProtocolType,
+      dir_,
+      kDefaultBinaryQLogChunkSize,
+      kDefaultBinaryQLogMaxChunks,
+      writer_);
+  q->setDcid(dcid_);
+  auto packet = createRegularQuicWritePacket(10, 0, 100, true);
+  constexpr size_t kNumEvents = 100;
+  // The strings handed to the logger are built beforehand, and the first
+  // round interns them.
+  std::vector<std::string> updates(kNumEvents + 1, kRemoveInflight);
+  for (size_t i = 0; i <= kNumEvents; i++) {
+    if (i == 1) {
+      countAllocations = true;
+    }
+    q->addPacket(packet, 150);
+    q->addPacketsLost(i, 1000, 1);
+    q->addTransportStateUpdate(std::move(updates[i]));
+    q->addMetricUpdate(
+        std::chrono::microseconds(100),
+        std::chrono::microseconds(80),
+        std::chrono::microseconds(90),
+        std::chrono::microseconds(5));
+  }
+  countAllocations = false;
+  EXPECT_EQ(0, numAllocations);
+  EXPECT_EQ(4 * (kNumEvents + 1), q->numEvents());
+  EXPECT_EQ(0, q->numDroppedEvents());
+}
+
+TEST_F(BinaryQLoggerTest, EncodeDecodeValues) {
+  folly::dynamic trace = folly::dynamic::object(
+      "traces", folly::dynamic::array(folly::dynamic::object("events", 0)))(
+      "values",
+      folly::dynamic::array(
+          "12345",
+          "0123",
+          "",
+          std::string(kBinaryQLogMaxInternedStringLength + 1, 'a'),
+          folly::dynamic::object("int", -5)("max", INT64_MAX)(
+              "min", INT64_MIN)("double", 0.25)("null", nullptr)(
+              "bools", folly::dynamic::array(true, false))));
+  auto longUpdate = std::string(kBinaryQLogMaxInternedStringLength + 1, 'a');
+
+  std::string binaryQLog;
+  BinaryQLogEncoder encoder;
+  BinaryQLogEncoder::encodeHeader(VantagePoint::Client, binaryQLog);
+  encoder.encodeTrace(trace, binaryQLog);
+  encoder.beginEvent(
+      QLogEventType::TransportStateUpdate, std::chrono::microseconds(10));
+  encoder.addString(longUpdate);
+  encoder.endEvent(binaryQLog);
+  // A record that was never written must not leave strings behind.
+  std::string discarded;
+  encoder.beginEvent(
+      QLogEventType::TransportStateUpdate, std::chrono::microseconds(11));
+  encoder.addString("discarded");
+  encoder.endEvent(discarded);
+  encoder.discardLastRecord();
+  BinaryQLogEncoder::encodeDropped(1, binaryQLog);
+  encoder.beginEvent(
+      QLogEventType::ConnectionMigration, std::chrono::microseconds(12));
+  encoder.addBool(true);
+  encoder.endEvent(binaryQLog);
+  encoder.beginEvent(
+      QLogEventType::TransportStateUpdate, std::chrono::microseconds(13));
+  encoder.addString("discarded");
+  encoder.endEvent(binaryQLog);
+
+  auto converted =
+      binaryQLogToDynamic(folly::ByteRange(folly::StringPiece(binaryQLog)));
+  EXPECT_EQ(trace["values"], converted["values"]);
+  auto& events = converted["traces"][0]["events"];
+  ASSERT_EQ(3, events.size());
+  EXPECT_EQ(
+      QLogTransportStateUpdateEvent(longUpdate, std::chrono::microseconds(10))
+          .toDynamic(),
+      events[0]);
+  // The vantage point comes from the file header.
+  EXPECT_EQ(
+      QLogConnectionMigrationEvent(
+          true, VantagePoint::Client, std::chrono::microseconds(12))
+          .toDynamic(),
+      events[1]);
+  EXPECT_EQ("discarded", events[2][3]["update"].asString());
+  EXPECT_EQ(3, converted["summary"]["max_duration"].asInt());
+  EXPECT_EQ(1, converted["summary"]["dropped_event_count"].asInt());
+
+  // A record cut short by a crash is ignored.
+  auto truncated = binaryQLogToDynamic(folly::ByteRange(
+      folly::StringPiece(binaryQLog).subpiece(0, binaryQLog.size() - 1)));
+  EXPECT_EQ(2, truncated["traces"][0]["events"].size());
+
+  binaryQLog[0] = 'X';
+  EXPECT_THROW(
+      binaryQLogToDynamic(folly::ByteRange(folly::StringPiece(binaryQLog))),
+      std::runtime_error);
+}
+
+} // namespace test
+} // namespace quic
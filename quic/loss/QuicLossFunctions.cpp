@@ -104,8 +104,8 @@ void markPacketLoss(
         if (!stream) {
           break;
         }
-        auto bufferItr = stream->retransmissionBuffer.find(frame.offset);
-        if (bufferItr == stream->retransmissionBuffer.end()) {
+        auto buffer = stream->retransmissionBuffer.find(frame.offset);
+        if (!buffer) {
           // It's possible that the stream was reset or data on the stream was
           // skipped while we discovered that its packet was lost so we might
           // not have the offset.
@@ -113,12 +113,11 @@ void markPacketLoss(
         }
         // The original rxmt offset might have been bumped up after it was
         // shrunk due to egress partially reliable skip.
-        if (!streamFrameMatchesRetransmitBuffer(
-                *stream, frame, *bufferItr->second)) {
+        if (!streamFrameMatchesRetransmitBuffer(*stream, frame, *buffer)) {
           break;
         }
-        stream->insertIntoLossBuffer(std::move(bufferItr->second));
-        stream->retransmissionBuffer.erase(bufferItr);
+        stream->insertIntoLossBuffer(std::move(*buffer));
+        stream->retransmissionBuffer.erase(frame.offset);
         conn.streamManager->updateLossStreams(*stream);
         break;
       }
@@ -131,15 +130,15 @@ void markPacketLoss(
         auto encryptionLevel = protectionTypeToEncryptionLevel(protectionType);
         auto cryptoStream = getCryptoStream(*conn.cryptoState, encryptionLevel);
 
-        auto bufferItr = cryptoStream->retransmissionBuffer.find(frame.offset);
-        if (bufferItr == cryptoStream->retransmissionBuffer.end()) {
+        auto buffer = cryptoStream->retransmissionBuffer.find(frame.offset);
+        if (!buffer) {
           // It's possible that the stream was reset while we discovered that
           // it's packet was lost so we might not have the offset.
           break;
         }
-        DCHECK_EQ(bufferItr->second->offset, frame.offset);
-        cryptoStream->insertIntoLossBuffer(std::move(bufferItr->second));
-        cryptoStream->retransmissionBuffer.erase(bufferItr);
+        DCHECK_EQ(buffer->offset, frame.offset);
+        cryptoStream->insertIntoLossBuffer(std::move(*buffer));
+        cryptoStream->retransmissionBuffer.erase(frame.offset);
         break;
       }
       case QuicWriteFrame::Type::RstStreamFrame_E: {
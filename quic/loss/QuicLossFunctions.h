@@ -167,7 +167,8 @@ void setLossDetectionAlarm(QuicConnectionStateBase& conn, Timeout& timeout) {
         << " " << nodeToString(conn.nodeType) << " " << conn;
     return;
   }
-  timeout.cancelLossTimeout();
+  // Rescheduling replaces the timer, the transport can skip it when the
+  // alarm barely moved.
   auto alarmDuration = calculateAlarmDuration<ClockType>(conn);
   conn.lossState.currentAlarmMethod = alarmDuration.second;
   VLOG(10) << __func__ << " setting transmission"
@@ -206,19 +207,19 @@ folly::Optional<CongestionController::LossEvent> detectLossPackets(
            << " " << conn;
   CongestionController::LossEvent lossEvent(lossTime);
   // Note that time based loss detection is also within the same PNSpace.
-  auto iter = getFirstOutstandingPacket(conn, pnSpace);
+  auto& packets = conn.outstandings.packets.packetsIn(pnSpace);
   bool shouldSetTimer = false;
-  while (iter != conn.outstandings.packets.end()) {
-    auto& pkt = *iter;
-    auto currentPacketNum = pkt.packet.header.getPacketSequenceNum();
+  for (auto currentPacketNum = packets.firstPacketNum();
+       currentPacketNum < packets.endPacketNum();
+       ++currentPacketNum) {
+    auto pktPtr = packets.find(currentPacketNum);
+    if (!pktPtr) {
+      continue;
+    }
+    auto& pkt = *pktPtr;
     if (!largestAcked.has_value() || currentPacketNum >= *largestAcked) {
       break;
     }
-    auto currentPacketNumberSpace = pkt.packet.header.getPacketNumberSpace();
-    if (currentPacketNumberSpace != pnSpace) {
-      iter++;
-      continue;
-    }
     bool lost = (lossTime - pkt.time) > delayUntilLost;
     lost = lost ||
         (*largestAcked - currentPacketNum) > conn.lossState.reorderingThreshold;
@@ -229,6 +230,9 @@ folly::Optional<CongestionController::LossEvent> detectLossPackets(
       break;
     }
     lossEvent.addLostPacket(pkt);
+    if (pkt.isEcnMarked) {
+      onEcnMarkedPacketLost(conn);
+    }
     if (pkt.associatedEvent) {
       DCHECK_GT(conn.outstandings.clonedPacketsCount, 0);
       --conn.outstandings.clonedPacketsCount;
@@ -243,29 +247,33 @@ folly::Optional<CongestionController::LossEvent> detectLossPackets(
       conn.outstandings.packetEvents.erase(*pkt.associatedEvent);
     }
     if (pkt.isHandshake && !processed) {
-      if (currentPacketNumberSpace == PacketNumberSpace::Initial) {
+      if (pnSpace == PacketNumberSpace::Initial) {
         CHECK(conn.outstandings.initialPacketsCount);
         --conn.outstandings.initialPacketsCount;
       } else {
-        CHECK_EQ(PacketNumberSpace::Handshake, currentPacketNumberSpace);
+        CHECK_EQ(PacketNumberSpace::Handshake, pnSpace);
         CHECK(conn.outstandings.handshakePacketsCount);
         --conn.outstandings.handshakePacketsCount;
       }
     }
     VLOG(10) << __func__ << " lost packetNum=" << currentPacketNum
              << " handshake=" << pkt.isHandshake << " " << conn;
-    iter = conn.outstandings.packets.erase(iter);
+    packets.erase(currentPacketNum);
   }
 
-  auto earliest = getFirstOutstandingPacket(conn, pnSpace);
-  for (; earliest != conn.outstandings.packets.end();
-       earliest = getNextOutstandingPacket(conn, pnSpace, earliest + 1)) {
-    if (!earliest->associatedEvent ||
-        conn.outstandings.packetEvents.count(*earliest->associatedEvent)) {
+  const OutstandingPacket* earliest = nullptr;
+  for (auto packetNum = packets.firstPacketNum();
+       packetNum < packets.endPacketNum();
+       ++packetNum) {
+    auto pkt = packets.find(packetNum);
+    if (pkt &&
+        (!pkt->associatedEvent ||
+         conn.outstandings.packetEvents.count(*pkt->associatedEvent))) {
+      earliest = pkt;
       break;
     }
   }
-  if (shouldSetTimer && earliest != conn.outstandings.packets.end()) {
+  if (shouldSetTimer && earliest) {
     // We are eligible to set a loss timer and there are a few packets which
     // are unacked, so we can set the early retransmit timer for them.
     VLOG(10) << __func__ << " early retransmit timer outstanding="
@@ -394,16 +402,22 @@ void markZeroRttPacketsLost(
     QuicConnectionStateBase& conn,
     const LossVisitor& lossVisitor) {
   CongestionController::LossEvent lossEvent(ClockType::now());
-  auto iter = getFirstOutstandingPacket(conn, PacketNumberSpace::AppData);
-  while (iter != conn.outstandings.packets.end()) {
+  auto& packets =
+      conn.outstandings.packets.packetsIn(PacketNumberSpace::AppData);
+  for (auto currentPacketNum = packets.firstPacketNum();
+       currentPacketNum < packets.endPacketNum();
+       ++currentPacketNum) {
+    auto pktPtr = packets.find(currentPacketNum);
+    if (!pktPtr) {
+      continue;
+    }
+    auto& pkt = *pktPtr;
     DCHECK_EQ(
-        iter->packet.header.getPacketNumberSpace(), PacketNumberSpace::AppData);
+        pkt.packet.header.getPacketNumberSpace(), PacketNumberSpace::AppData);
     auto isZeroRttPacket =
-        iter->packet.header.getProtectionType() == ProtectionType::ZeroRtt;
+        pkt.packet.header.getProtectionType() == ProtectionType::ZeroRtt;
     if (isZeroRttPacket) {
-      auto& pkt = *iter;
       DCHECK(!pkt.isHandshake);
-      auto currentPacketNum = pkt.packet.header.getPacketSequenceNum();
       bool processed = pkt.associatedEvent &&
           !conn.outstandings.packetEvents.count(*pkt.associatedEvent);
       lossVisitor(conn, pkt.packet, processed, currentPacketNum);
@@ -414,11 +428,7 @@ void markZeroRttPacketsLost(
         --conn.outstandings.clonedPacketsCount;
       }
       lossEvent.addLostPacket(pkt);
-      iter = conn.outstandings.packets.erase(iter);
-      iter = getNextOutstandingPacket(conn, PacketNumberSpace::AppData, iter);
-    } else {
-      iter =
-          getNextOutstandingPacket(conn, PacketNumberSpace::AppData, iter + 1);
+      packets.erase(currentPacketNum);
     }
   }
   conn.lossState.rtxCount += lossEvent.lostPackets;
@@ -23,6 +23,8 @@
 #include <quic/state/test/MockQuicStats.h>
 #include <quic/state/test/Mocks.h>
 
+#include <set>
+
 using namespace folly::test;
 using namespace testing;
 using namespace folly;
@@ -258,7 +260,7 @@ TEST_F(QuicLossFunctionsTest, HasDataToWrite) {
   sendPacket(*conn, Clock::now(), folly::none, PacketType::OneRtt);
   conn->streamManager->addLoss(1);
   conn->pendingEvents.setLossDetectionAlarm = true;
-  EXPECT_CALL(timeout, cancelLossTimeout()).Times(2);
+  EXPECT_CALL(timeout, cancelLossTimeout()).Times(1);
   EXPECT_CALL(timeout, scheduleLossTimeout(_)).Times(1);
   setLossDetectionAlarm(*conn, timeout);
   EXPECT_FALSE(conn->pendingEvents.setLossDetectionAlarm);
@@ -290,7 +292,7 @@ TEST_F(QuicLossFunctionsTest, ClearEarlyRetranTimer) {
 
   // Schedule a loss timer
   EXPECT_CALL(timeout, isLossTimeoutScheduled()).WillRepeatedly(Return(false));
-  EXPECT_CALL(timeout, cancelLossTimeout()).Times(1);
+  EXPECT_CALL(timeout, cancelLossTimeout()).Times(0);
   EXPECT_CALL(timeout, scheduleLossTimeout(_)).Times(1);
   setLossDetectionAlarm(*conn, timeout);
   EXPECT_EQ(
@@ -60,6 +60,34 @@ class LogQuicStats : public quic::QuicTransportStatsCallback {
     VLOG(2) << prefix_ << "onForwardedPacketProcessed";
   }
 
+  void onPacketMisrouted() override {
+    VLOG(2) << prefix_ << "onPacketMisrouted";
+  }
+
+  void onWorkerHandoff(size_t queueDepth) override {
+    VLOG(2) << prefix_ << "onWorkerHandoff queueDepth=" << queueDepth;
+  }
+
+  void onWorkerHandoffBatch(size_t batchSize) override {
+    VLOG(2) << prefix_ << "onWorkerHandoffBatch batchSize=" << batchSize;
+  }
+
+  void onWorkerHandoffQueueFull() override {
+    VLOG(2) << prefix_ << "onWorkerHandoffQueueFull";
+  }
+
+  void onReceiveBufferPoolHit() override {
+    VLOG(2) << prefix_ << "onReceiveBufferPoolHit";
+  }
+
+  void onReceiveBufferPoolMiss() override {
+    VLOG(2) << prefix_ << "onReceiveBufferPoolMiss";
+  }
+
+  void onRecvBatch(size_t numDatagrams) override {
+    VLOG(2) << prefix_ << "onRecvBatch numDatagrams=" << numDatagrams;
+  }
+
   void onClientInitialReceived(QuicVersion version) override {
     VLOG(2) << prefix_
             << "onClientInitialReceived, version: " << quic::toString(version);
@@ -69,6 +97,10 @@ class LogQuicStats : public quic::QuicTransportStatsCallback {
     VLOG(2) << prefix_ << "onConnectionRateLimited";
   }
 
+  void onRetrySent() override {
+    VLOG(2) << prefix_ << "onRetrySent";
+  }
+
   // connection level metrics:
   void onNewConnection() override {
     VLOG(2) << prefix_ << "onNewConnection";
@@ -114,6 +146,20 @@ class LogQuicStats : public quic::QuicTransportStatsCallback {
     VLOG(2) << prefix_ << "onStreamFlowControlBlocked";
   }
 
+  void onConnFlowControlWindowGrowth(uint64_t newWindowSize) override {
+    VLOG(2) << prefix_ << "onConnFlowControlWindowGrowth newWindowSize="
+            << newWindowSize;
+  }
+
+  void onStreamFlowControlWindowGrowth(uint64_t newWindowSize) override {
+    VLOG(2) << prefix_ << "onStreamFlowControlWindowGrowth newWindowSize="
+            << newWindowSize;
+  }
+
+  void onConnFlowControlWindowGrowthLimited() override {
+    VLOG(2) << prefix_ << "onConnFlowControlWindowGrowthLimited";
+  }
+
   void onCwndBlocked() override {
     VLOG(2) << prefix_ << "onCwndBlocked";
   }
@@ -137,6 +183,42 @@ class LogQuicStats : public quic::QuicTransportStatsCallback {
             << "onUDPSocketWriteError errorType=" << toString(errorType);
   }
 
+  void onZeroCopyCompletion(size_t numWrites) override {
+    VLOG(2) << prefix_ << "onZeroCopyCompletion numWrites=" << numWrites;
+  }
+
+  void onZeroCopyFallback(size_t numWrites) override {
+    VLOG(2) << prefix_ << "onZeroCopyFallback numWrites=" << numWrites;
+  }
+
+  void onDatagramRead(size_t datagramSize) override {
+    VLOG(2) << prefix_ << "onDatagramRead size=" << datagramSize;
+  }
+
+  void onDatagramWrite(size_t datagramSize) override {
+    VLOG(2) << prefix_ << "onDatagramWrite size=" << datagramSize;
+  }
+
+  void onDatagramDroppedOnRead() override {
+    VLOG(2) << prefix_ << "onDatagramDroppedOnRead";
+  }
+
+  void onDatagramDroppedOnWrite() override {
+    VLOG(2) << prefix_ << "onDatagramDroppedOnWrite";
+  }
+
+  void onTimerRescheduled() override {
+    VLOG(2) << prefix_ << "onTimerRescheduled";
+  }
+
+  void onCongestionStateCacheHit() override {
+    VLOG(2) << prefix_ << "onCongestionStateCacheHit";
+  }
+
+  void onCongestionStateCacheMiss() override {
+    VLOG(2) << prefix_ << "onCongestionStateCacheMiss";
+  }
+
  private:
   std::string prefix_;
 };
@@ -0,0 +1,175 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ *
+ */
+
+#include <quic/server/QuicReusePortUDPSocketFactory.h>
+
+#include <folly/net/NetOps.h>
+#include <glog/logging.h>
+#include <quic/QuicConstants.h>
+#include <quic/codec/QuicConnectionId.h>
+#include <quic/codec/Types.h>
+
+#include <cerrno>
+
+#if defined(__linux__) && !FOLLY_MOBILE && defined(SO_ATTACH_REUSEPORT_EBPF)
+#define QUIC_REUSEPORT_EBPF_SUPPORTED 1
+#else
+#define QUIC_REUSEPORT_EBPF_SUPPORTED 0
+#endif
+
+#if QUIC_REUSEPORT_EBPF_SUPPORTED
+#include <linux/bpf.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <cstddef>
+#include <cstring>
+#include <vector>
+#endif
+
+namespace quic {
+
+#if QUIC_REUSEPORT_EBPF_SUPPORTED
+namespace {
+
+// Offsets in the UDP payload, the kernel runs the program past the UDP header.
+constexpr int32_t kFlagsOffset = 0;
+constexpr int32_t kConnIdOffset = 1;
+// The short header flags and the bytes of the connection id up to the worker
+// id.
+constexpr int32_t kMinSteeredPacketSize = kConnIdOffset + 4;
+static_assert(
+    kMinSelfConnectionIdSize >= 4,
+    "The worker id has to be in the first 4 bytes of the connection id");
+
+bpf_insn makeInsn(
+    uint8_t code,
+    uint8_t dst,
+    uint8_t src,
+    int16_t off,
+    int32_t imm) {
+  bpf_insn insn;
+  std::memset(&insn, 0, sizeof(insn));
+  insn.code = code;
+  insn.dst_reg = dst;
+  insn.src_reg = src;
+  insn.off = off;
+  insn.imm = imm;
+  return insn;
+}
+
+bpf_insn loadPayloadByte(int32_t offset) {
+  // r0 = payload[offset], the context has to be in r6.
+  return makeInsn(BPF_LD | BPF_ABS | BPF_B, 0, 0, 0, offset);
+}
+
+/**
+ * The socket index is the worker id that getWorkerIdFromConnId() decodes,
+ * modulo numWorkers like QuicServer routes packets. An index past the sockets
+ * of the group makes the kernel fall back to its hash.
+ */
+std::vector<bpf_insn> makeWorkerIdSteeringProgram(size_t numWorkers) {
+  std::vector<bpf_insn> insns;
+  // Jumps to the fallback, patched once its index is known.
+  std::vector<size_t> fallbackJumps;
+
+  insns.push_back(makeInsn(BPF_ALU64 | BPF_MOV | BPF_X, 6, 1, 0, 0));
+  insns.push_back(makeInsn(
+      BPF_LDX | BPF_MEM | BPF_W, 2, 6, offsetof(__sk_buff, len), 0));
+  insns.push_back(makeInsn(
+      BPF_JMP | BPF_JGT | BPF_K, 2, 0, 1, kMinSteeredPacketSize - 1));
+  fallbackJumps.push_back(insns.size());
+  insns.push_back(makeInsn(BPF_JMP | BPF_JA, 0, 0, 0, 0));
+
+  insns.push_back(loadPayloadByte(kFlagsOffset));
+  fallbackJumps.push_back(insns.size());
+  insns.push_back(
+      makeInsn(BPF_JMP | BPF_JSET | BPF_K, 0, 0, 0, kHeaderFormMask));
+
+  insns.push_back(loadPayloadByte(kConnIdOffset));
+  insns.push_back(makeInsn(BPF_ALU64 | BPF_RSH | BPF_K, 0, 0, 0, 6));
+  fallbackJumps.push_back(insns.size());
+  insns.push_back(
+      makeInsn(BPF_JMP | BPF_JNE | BPF_K, 0, 0, 0, kShortVersionId));
+
+  // Bits 18 - 25 of the connection id.
+  insns.push_back(loadPayloadByte(kConnIdOffset + 2));
+  insns.push_back(makeInsn(BPF_ALU64 | BPF_MOV | BPF_X, 7, 0, 0, 0));
+  insns.push_back(makeInsn(BPF_ALU64 | BPF_LSH | BPF_K, 7, 0, 0, 2));
+  insns.push_back(loadPayloadByte(kConnIdOffset + 3));
+  insns.push_back(makeInsn(BPF_ALU64 | BPF_RSH | BPF_K, 0, 0, 0, 6));
+  insns.push_back(makeInsn(BPF_ALU64 | BPF_OR | BPF_X, 7, 0, 0, 0));
+  insns.push_back(makeInsn(BPF_ALU64 | BPF_AND | BPF_K, 7, 0, 0, 0xff));
+  insns.push_back(makeInsn(
+      BPF_ALU64 | BPF_MOD | BPF_K, 7, 0, 0, static_cast<int32_t>(numWorkers)));
+  insns.push_back(makeInsn(BPF_ALU64 | BPF_MOV | BPF_X, 0, 7, 0, 0));
+  insns.push_back(makeInsn(BPF_JMP | BPF_EXIT, 0, 0, 0, 0));
+
+  size_t fallback = insns.size();
+  insns.push_back(makeInsn(BPF_ALU | BPF_MOV | BPF_K, 0, 0, 0, -1));
+  insns.push_back(makeInsn(BPF_JMP | BPF_EXIT, 0, 0, 0, 0));
+  for (auto jump : fallbackJumps) {
+    insns[jump].off = static_cast<int16_t>(fallback - jump - 1);
+  }
+  return insns;
+}
+
+} // namespace
+#endif
+
+int QuicReusePortUDPSocketFactory::loadWorkerIdSteeringProgram(
+    FOLLY_MAYBE_UNUSED size_t numWorkers) {
+#if QUIC_REUSEPORT_EBPF_SUPPORTED
+  CHECK_GT(numWorkers, 0);
+  auto insns = makeWorkerIdSteeringProgram(numWorkers);
+  static const char kLicense[] = "GPL";
+  bpf_attr attr;
+  std::memset(&attr, 0, sizeof(attr));
+  attr.prog_type = BPF_PROG_TYPE_SOCKET_FILTER;
+  attr.insns = reinterpret_cast<uint64_t>(insns.data());
+  attr.insn_cnt = insns.size();
+  attr.license = reinterpret_cast<uint64_t>(kLicense);
+  return ::syscall(__NR_bpf, BPF_PROG_LOAD, &attr, sizeof(attr));
+#else
+  errno = ENOTSUP;
+  return -1;
+#endif
+}
+
+bool QuicReusePortUDPSocketFactory::attachWorkerIdSteering(
+    FOLLY_MAYBE_UNUSED folly::AsyncUDPSocket& sock,
+    FOLLY_MAYBE_UNUSED size_t numWorkers) {
+#if QUIC_REUSEPORT_EBPF_SUPPORTED
+  int progFd = loadWorkerIdSteeringProgram(numWorkers);
+  if (progFd < 0) {
+    LOG(WARNING) << "Failed to load the reuseport steering program, errno="
+                 << errno;
+    return false;
+  }
+  // The socket holds on to the program, its fd is no longer needed.
+  auto ret = folly::netops::setsockopt(
+      sock.getNetworkSocket(),
+      SOL_SOCKET,
+      SO_ATTACH_REUSEPORT_EBPF,
+      &progFd,
+      sizeof(progFd));
+  auto attachErrno = errno;
+  ::close(progFd);
+  if (ret != 0) {
+    LOG(WARNING) << "Failed to attach the reuseport steering program, errno="
+                 << attachErrno;
+    return false;
+  }
+  return true;
+#else
+  LOG(WARNING) << "Reuseport steering is not supported on this platform";
+  return false;
+#endif
+}
+
+} // namespace quic
@@ -24,5 +24,28 @@ class QuicReusePortUDPSocketFactory : public QuicUDPSocketFactory {
     sock->setReuseAddr(false);
     return sock;
   }
+
+  /**
+   * Attaches an SO_ATTACH_REUSEPORT_EBPF program to the reuseport group of the
+   * bound socket sock. The program sends a short header packet to the socket
+   * at the index of the worker id of its destination connection id, modulo
+   * numWorkers, as DefaultConnectionIdAlgo encodes it. Long header packets and
+   * connection ids of other formats are left to the kernel hash.
+   *
+   * The index of a socket is the order in which it joined the group, so the
+   * workers have to bind in the order of their ids. Returns false if the
+   * kernel does not support it or the process lacks the privileges, in which
+   * case the kernel keeps hashing all the packets.
+   */
+  static bool attachWorkerIdSteering(
+      folly::AsyncUDPSocket& sock,
+      size_t numWorkers);
+
+  /**
+   * Loads the program attachWorkerIdSteering() attaches, as a
+   * BPF_PROG_TYPE_SOCKET_FILTER. Returns its fd, which the caller has to
+   * close, or -1 with errno set.
+   */
+  static int loadWorkerIdSteeringProgram(size_t numWorkers);
 };
 } // namespace quic
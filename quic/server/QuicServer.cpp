@@ -26,7 +26,8 @@ DEFINE_bool(
 namespace quic {
 namespace {
 // Determine which worker to route to
-// This **MUST** be kept in sync with the BPF program (if supplied)
+// This **MUST** be kept in sync with the BPF program (if supplied), see
+// QuicReusePortUDPSocketFactory::attachWorkerIdSteering()
 size_t getWorkerToRouteTo(
     const RoutingData& routingData,
     size_t numWorkers,
@@ -57,6 +58,19 @@ void QuicServer::setListenerSocketFactory(
   listenerSocketFactory_ = std::move(factory);
 }
 
+void QuicServer::setReusePortSteering(bool enabled) {
+  CHECK(!initialized_)
+      << "Reuseport steering must be set before the server is initialized.";
+  reusePortSteering_ = enabled;
+}
+
+void QuicServer::setWorkerHandoffQueueSize(size_t queueSize) {
+  CHECK(!initialized_)
+      << "Handoff queue size must be set before the server is initialized.";
+  CHECK_GT(queueSize, 0);
+  workerHandoffQueueSize_ = queueSize;
+}
+
 void QuicServer::setCongestionControllerFactory(
     std::shared_ptr<CongestionControllerFactory> ccFactory) {
   CHECK(!initialized_)
@@ -70,6 +84,12 @@ void QuicServer::setRateLimit(uint64_t count, std::chrono::seconds window) {
   rateLimit_ = folly::make_optional<RateLimit>(count, window);
 }
 
+void QuicServer::setRetryRateLimit(
+    uint64_t count,
+    std::chrono::seconds window) {
+  retryRateLimit_ = folly::make_optional<RateLimit>(count, window);
+}
+
 void QuicServer::setSupportedVersion(const std::vector<QuicVersion>& versions) {
   supportedVersions_ = versions;
 }
@@ -128,6 +148,14 @@ void QuicServer::initialize(
     folly::Random::secureRandom(secret.data(), secret.size());
     transportSettings_.statelessResetTokenSecret = secret;
   }
+  // Servers sharing a listening address should share the secret, so that one
+  // validates the tokens of the others.
+  if (!transportSettings_.addressTokenSecret &&
+      (retryRateLimit_ || transportSettings_.issueNewTokens)) {
+    std::array<uint8_t, kAddressTokenSecretLength> secret;
+    folly::Random::secureRandom(secret.data(), secret.size());
+    transportSettings_.addressTokenSecret = secret;
+  }
 
   // it the connid algo factory is not set, use default impl
   if (!connIdAlgoFactory_) {
@@ -136,6 +164,12 @@ void QuicServer::initialize(
   } else {
     connIdAlgo_ = connIdAlgoFactory_->make();
   }
+  if (reusePortSteering_ &&
+      !dynamic_cast<DefaultConnectionIdAlgo*>(connIdAlgo_.get())) {
+    LOG(WARNING) << "Reuseport steering only supports the default connection "
+                 << "id algo, the kernel keeps hashing the packets";
+    reusePortSteering_ = false;
+  }
   if (!ccFactory_) {
     ccFactory_ = std::make_shared<DefaultCongestionControllerFactory>();
   }
@@ -179,11 +213,19 @@ void QuicServer::initializeWorkers(
       worker->setRateLimiter(std::make_unique<SlidingWindowRateLimiter>(
           rateLimit_->count, rateLimit_->window));
     }
+    if (retryRateLimit_) {
+      worker->setRetryRateLimiter(std::make_unique<SlidingWindowRateLimiter>(
+          retryRateLimit_->count, retryRateLimit_->window));
+    }
     worker->setWorkerId(i);
     worker->setTransportSettingsOverrideFn(transportSettingsOverrideFn_);
     workers_.push_back(std::move(worker));
     evbToWorkers_.emplace(workerEvb, workers_.back().get());
   }
+  for (size_t i = 0; i < workers_.size(); ++i) {
+    workerInboxes_.push_back(std::make_unique<WorkerPacketInbox>(
+        workers_.size(), workerHandoffQueueSize_));
+  }
 }
 
 std::unique_ptr<QuicServerWorker> QuicServer::newWorkerWithoutSocket() {
@@ -213,6 +255,8 @@ void QuicServer::bindWorkersToSocket(
                                             numWorkers,
                                             usingCCP,
                                             &ccpInitFailed,
+                                            reusePortSteering =
+                                                reusePortSteering_,
                                             processId = processId_,
                                             idx = i] {
       std::lock_guard<std::mutex> guard(self->startMutex_);
@@ -220,6 +264,7 @@ void QuicServer::bindWorkersToSocket(
         return;
       }
       auto workerSocket = self->listenerSocketFactory_->make(workerEvb, -1);
+      auto rawWorkerSocket = workerSocket.get();
       auto it = self->evbToWorkers_.find(workerEvb);
       CHECK(it != self->evbToWorkers_.end());
       auto worker = it->second;
@@ -253,6 +298,12 @@ void QuicServer::bindWorkersToSocket(
           self->boundAddress_ = worker->getAddress();
         }
       }
+      // The program applies to the whole reuseport group, and the workers
+      // join it in the order of their ids.
+      if (reusePortSteering && idx == 0) {
+        QuicReusePortUDPSocketFactory::attachWorkerIdSteering(
+            *rawWorkerSocket, numWorkers);
+      }
       if (usingCCP) {
         try {
           worker->getCcpReader()->try_initialize(
@@ -424,6 +475,53 @@ void QuicServer::routeDataToWorker(
         isForwardedData);
     return;
   }
+  if (workerPtr_) {
+    QUIC_STATS(workerPtr_->getTransportStatsCallback(), onPacketMisrouted);
+    auto& inbox = *workerInboxes_[workerToRunOn];
+    auto result = inbox.push(
+        workerPtr_->getWorkerId(),
+        client,
+        std::move(routingData),
+        std::move(networkData),
+        isForwardedData);
+    if (result.queued) {
+      QUIC_STATS(
+          workerPtr_->getTransportStatsCallback(),
+          onWorkerHandoff,
+          result.queueDepth);
+      if (result.needsDrain) {
+        workerEvb->runInEventBaseThread(
+            [server = this->shared_from_this(), w = worker.get(), &inbox] {
+              if (server->shutdown_) {
+                return;
+              }
+              drainWorkerInbox(*w, inbox);
+            });
+      }
+      return;
+    }
+    // The receiving worker is falling behind. Rather than losing the packet,
+    // post it on its own like before the inbox. The task drains the ring
+    // first so that the packets read before this one still go ahead of it.
+    QUIC_STATS(
+        workerPtr_->getTransportStatsCallback(), onWorkerHandoffQueueFull);
+    workerEvb->runInEventBaseThread(
+        [server = this->shared_from_this(),
+         cl = client,
+         routingData = std::move(routingData),
+         w = worker.get(),
+         buf = std::move(networkData),
+         isForwarded = isForwardedData,
+         &inbox]() mutable {
+          if (server->shutdown_) {
+            return;
+          }
+          drainWorkerInbox(*w, inbox);
+          w->dispatchPacketData(
+              cl, std::move(routingData), std::move(buf), isForwarded);
+        });
+    return;
+  }
   worker->getEventBase()->runInEventBaseThread(
       [server = this->shared_from_this(),
        cl = client,
@@ -439,6 +537,22 @@ void QuicServer::routeDataToWorker(
       });
 }
 
+void QuicServer::drainWorkerInbox(
+    QuicServerWorker& worker,
+    WorkerPacketInbox& inbox) {
+  auto batchSize = inbox.drain([&worker](HandoffPacket&& packet) {
+    worker.dispatchPacketData(
+        packet.client,
+        std::move(packet.routingData),
+        std::move(packet.networkData),
+        packet.isForwardedData);
+  });
+  if (batchSize > 0) {
+    QUIC_STATS(
+        worker.getTransportStatsCallback(), onWorkerHandoffBatch, batchSize);
+  }
+}
+
 void QuicServer::handleWorkerError(LocalErrorCode error) {
   shutdown(error);
 }
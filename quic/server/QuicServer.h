@@ -23,6 +23,7 @@
 #include <quic/server/QuicServerTransportFactory.h>
 #include <quic/server/QuicServerWorker.h>
 #include <quic/server/QuicUDPSocketFactory.h>
+#include <quic/server/WorkerPacketInbox.h>
 #include <quic/state/QuicTransportStatsCallback.h>
 
 namespace quic {
@@ -91,6 +92,24 @@ class QuicServer : public QuicServerWorker::WorkerCallback,
    */
   void setListenerSocketFactory(std::unique_ptr<QuicUDPSocketFactory> factory);
 
+  /**
+   * Have the kernel deliver short header packets straight to the worker that
+   * owns their connection, with an eBPF program on the reuseport group of the
+   * listening sockets, instead of hashing them to any worker. Only works with
+   * the default listener socket factory and connection id algo, and falls back
+   * to the hash if the program cannot be attached.
+   * This must be set before the server is initialized.
+   */
+  void setReusePortSteering(bool enabled);
+
+  /**
+   * Number of packets a worker can hand off to each other worker before that
+   * worker drains them. Packets that find the queue full are posted to the
+   * receiving worker one by one instead.
+   * This must be set before the server is initialized.
+   */
+  void setWorkerHandoffQueueSize(size_t queueSize);
+
   /**
    * Set factory to create specific congestion controller instances
    * for a given connection
@@ -101,6 +120,15 @@ class QuicServer : public QuicServerWorker::WorkerCallback,
 
   void setRateLimit(uint64_t count, std::chrono::seconds window);
 
+  /**
+   * Answer the client Initials without a valid address validation token with
+   * a Retry once a worker sees more than count of them per window. No
+   * transport is created for the client until it echoes the Retry token, a
+   * count of zero always sends a Retry.
+   * This must be set before the server is started.
+   */
+  void setRetryRateLimit(uint64_t count, std::chrono::seconds window);
+
   /**
    * Set list of supported QUICVersion for this server. These versions will be
    * used during the 'Version-Negotiation' phase with the client.
@@ -371,6 +399,12 @@ class QuicServer : public QuicServerWorker::WorkerCallback,
       const folly::SocketAddress& address,
       const std::vector<folly::EventBase*>& evbs);
 
+  // Dispatches the packets handed off to the worker. Must be called on the
+  // thread of the worker.
+  static void drainWorkerInbox(
+      QuicServerWorker& worker,
+      WorkerPacketInbox& inbox);
+
   std::vector<QuicVersion> supportedVersions_{{QuicVersion::MVFST,
                                                QuicVersion::MVFST_D24,
                                                QuicVersion::QUIC_DRAFT,
@@ -394,6 +428,8 @@ class QuicServer : public QuicServerWorker::WorkerCallback,
   // NOTE: QuicServer still maintains ownership of all the workers and manages
   // their destruction
   folly::ThreadLocalPtr<QuicServerWorker> workerPtr_;
+  // Packets handed off to each worker by the others, indexed like workers_.
+  std::vector<std::unique_ptr<WorkerPacketInbox>> workerInboxes_;
   folly::F14FastMap<folly::EventBase*, QuicServerWorker*> evbToWorkers_;
   std::unique_ptr<QuicServerTransportFactory> transportFactory_;
   folly::F14FastMap<folly::EventBase*, QuicServerTransportFactory*>
@@ -412,6 +448,8 @@ class QuicServer : public QuicServerWorker::WorkerCallback,
   ProcessId processId_{ProcessId::ZERO};
   uint16_t hostId_{0};
   bool rejectNewConnections_{false};
+  bool reusePortSteering_{false};
+  size_t workerHandoffQueueSize_{kDefaultWorkerInboxQueueSize};
   // factory to create per worker QuicTransportStatsCallback
   std::unique_ptr<QuicTransportStatsCallbackFactory> transportStatsFactory_;
   // factory to create per worker ConnectionIdAlgo
@@ -430,6 +468,7 @@ class QuicServer : public QuicServerWorker::WorkerCallback,
     std::chrono::seconds window;
   };
   folly::Optional<RateLimit> rateLimit_;
+  folly::Optional<RateLimit> retryRateLimit_;
 };
 
 } // namespace quic
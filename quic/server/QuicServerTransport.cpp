@@ -136,6 +136,15 @@ void QuicServerTransport::accept() {
   setIdleTimer();
   updateFlowControlStateWithSettings(
       conn_->flowControlState, conn_->transportSettings);
+  if (congestionStateCache_) {
+    auto cachedState = congestionStateCache_->get(
+        conn_->originalPeerAddress.getIPAddress(), Clock::now());
+    if (cachedState && applyCachedCongestionState(*conn_, *cachedState)) {
+      QUIC_STATS(conn_->statsCallback, onCongestionStateCacheHit);
+    } else {
+      QUIC_STATS(conn_->statsCallback, onCongestionStateCacheMiss);
+    }
+  }
   serverConn_->serverHandshakeLayer->initialize(
       evb_,
       ctx_,
@@ -280,6 +289,15 @@ void QuicServerTransport::closeTransport() {
   // Clear out pending data.
   serverConn_->pendingZeroRttData.reset();
   serverConn_->pendingOneRttData.reset();
+  if (congestionStateCache_) {
+    auto state = getCachedCongestionState(*conn_);
+    if (state) {
+      // Keyed like the lookup in accept(), a migrated connection is found by
+      // the next connection from the address it started on.
+      congestionStateCache_->put(
+          conn_->originalPeerAddress.getIPAddress(), *state);
+    }
+  }
   onServerClose(*serverConn_);
 }
 
@@ -302,6 +320,10 @@ bool QuicServerTransport::hasWriteCipher() const {
   return conn_->oneRttWriteCipher != nullptr;
 }
 
+size_t QuicServerTransport::getStateSize() const {
+  return sizeof(QuicServerTransport) + sizeof(QuicServerConnectionState);
+}
+
 std::shared_ptr<QuicTransportBase> QuicServerTransport::sharedGuard() {
   return shared_from_this();
 }
@@ -318,6 +340,17 @@ void QuicServerTransport::setClientChosenDestConnectionId(
   conn_->clientChosenDestConnectionId.assign(clientChosenDestConnectionId);
 }
 
+void QuicServerTransport::setOriginalDestinationConnectionId(
+    const ConnectionId& originalDestinationConnectionId) {
+  serverConn_->originalDestinationConnectionId =
+      originalDestinationConnectionId;
+}
+
+void QuicServerTransport::setTokenGenerator(
+    std::shared_ptr<TokenGenerator> tokenGenerator) {
+  serverConn_->tokenGenerator = std::move(tokenGenerator);
+}
+
 void QuicServerTransport::onCryptoEventAvailable() noexcept {
   try {
     VLOG(10) << "onCryptoEventAvailable " << *this;
@@ -373,11 +406,11 @@ void QuicServerTransport::processPendingData(bool async) {
     auto func = [pendingData = std::move(pendingData)](auto self) {
       auto serverPtr = static_cast<QuicServerTransport*>(self.get());
       for (auto& pendingPacket : *pendingData) {
-        serverPtr->onNetworkData(
-            pendingPacket.peer,
-            NetworkData(
-                std::move(pendingPacket.networkData.data),
-                pendingPacket.networkData.receiveTimePoint));
+        NetworkData networkData(
+            std::move(pendingPacket.networkData.data),
+            pendingPacket.networkData.receiveTimePoint);
+        networkData.setEcnCodepoint(0, pendingPacket.networkData.ecnCodepoint);
+        serverPtr->onNetworkData(pendingPacket.peer, std::move(networkData));
         if (serverPtr->closeState_ == CloseState::CLOSED) {
           // The pending data could potentially contain a connection close, or
           // the app could have triggered a connection close with an error. It
@@ -493,6 +526,22 @@ void QuicServerTransport::setBufAccessor(BufAccessor* bufAccessor) {
   conn_->bufAccessor = bufAccessor;
 }
 
+void QuicServerTransport::setZeroCopyTracker(
+    ZeroCopyTracker* zeroCopyTracker) {
+  CHECK(zeroCopyTracker);
+  conn_->zeroCopyTracker = zeroCopyTracker;
+}
+
+void QuicServerTransport::setReceiveWindowBudget(
+    std::shared_ptr<ReceiveWindowBudget> receiveWindowBudget) {
+  conn_->receiveWindowReservation.setBudget(std::move(receiveWindowBudget));
+}
+
+void QuicServerTransport::setCongestionStateCache(
+    std::shared_ptr<CongestionStateCache> congestionStateCache) {
+  congestionStateCache_ = std::move(congestionStateCache);
+}
+
 #ifdef CCP_ENABLED
 void QuicServerTransport::setCcpDatapath(struct ccp_datapath* datapath) {
   serverConn_->ccpDatapath = datapath;
@@ -96,6 +96,19 @@ class QuicServerTransport
 
   void setClientChosenDestConnectionId(const ConnectionId& serverCid);
 
+  /**
+   * Set when the client Initial carries a valid Retry token, the destination
+   * connection id of the Initial before the Retry.
+   */
+  void setOriginalDestinationConnectionId(
+      const ConnectionId& originalDestinationConnectionId);
+
+  /**
+   * The generator of the token of the NEW_TOKEN frame, shared by the
+   * connections of the worker.
+   */
+  void setTokenGenerator(std::shared_ptr<TokenGenerator> tokenGenerator);
+
   // From QuicTransportBase
   void onReadData(
       const folly::SocketAddress& peer,
@@ -105,6 +118,7 @@ class QuicServerTransport
   void unbindConnection() override;
   bool hasWriteCipher() const override;
   std::shared_ptr<QuicTransportBase> sharedGuard() override;
+  size_t getStateSize() const override;
 
   const fizz::server::FizzServerContext& getCtx() {
     return *ctx_;
@@ -114,6 +128,18 @@ class QuicServerTransport
 
   virtual void setBufAccessor(BufAccessor* bufAccessor);
 
+  virtual void setZeroCopyTracker(ZeroCopyTracker* zeroCopyTracker);
+
+  virtual void setReceiveWindowBudget(
+      std::shared_ptr<ReceiveWindowBudget> receiveWindowBudget);
+
+  /**
+   * The cache accept() starts the connection from and closing the connection
+   * records its congestion state in.
+   */
+  virtual void setCongestionStateCache(
+      std::shared_ptr<CongestionStateCache> congestionStateCache);
+
 #ifdef CCP_ENABLED
   /*
    * This function must be called with an initialized ccp_datapath (via
@@ -137,6 +163,7 @@ class QuicServerTransport
  private:
   RoutingCallback* routingCb_{nullptr};
   std::shared_ptr<const fizz::server::FizzServerContext> ctx_;
+  std::shared_ptr<CongestionStateCache> congestionStateCache_;
   bool notifiedRouting_{false};
   bool notifiedConnIdBound_{false};
   bool newSessionTicketWritten_{false};
@@ -6,13 +6,17 @@
  *
  */
 
+#include <array>
+
 #include <folly/Format.h>
 #include <folly/io/Cursor.h>
 #include <folly/io/SocketOptionMap.h>
 #include <folly/system/ThreadId.h>
 #include <quic/QuicConstants.h>
+#include <quic/api/QuicBatchWriter.h>
 #include <quic/common/SocketUtil.h>
 #include <quic/common/Timers.h>
+#include <quic/fizz/handshake/FizzCryptoFactory.h>
 
 #include <quic/server/AcceptObserver.h>
 #include <quic/server/CCPReader.h>
@@ -21,6 +25,35 @@
 
 namespace quic {
 
+namespace {
+
+// The header of the first packet of a client Initial, with its token.
+folly::Optional<LongHeader> parseInitialHeader(const NetworkData& networkData) {
+  if (networkData.packets.empty()) {
+    return folly::none;
+  }
+  folly::io::Cursor cursor(networkData.packets.front().get());
+  if (!cursor.canAdvance(sizeof(uint8_t))) {
+    return folly::none;
+  }
+  auto initialByte = cursor.readBE<uint8_t>();
+  auto parsedLongHeaderInvariant =
+      parseLongHeaderInvariant(initialByte, cursor);
+  if (!parsedLongHeaderInvariant) {
+    return folly::none;
+  }
+  auto parsedLongHeader = parseLongHeaderVariants(
+      LongHeader::Types::Initial,
+      std::move(*parsedLongHeaderInvariant),
+      cursor);
+  if (!parsedLongHeader) {
+    return folly::none;
+  }
+  return std::move(parsedLongHeader->header);
+}
+
+} // namespace
+
 QuicServerWorker::QuicServerWorker(
     std::shared_ptr<QuicServerWorker::WorkerCallback> callback,
     bool setEventCallback)
@@ -123,12 +156,58 @@ void QuicServerWorker::setRateLimiter(
   newConnRateLimiter_ = std::move(rateLimiter);
 }
 
+void QuicServerWorker::setRetryRateLimiter(
+    std::unique_ptr<RateLimiter> retryRateLimiter) {
+  retryRateLimiter_ = std::move(retryRateLimiter);
+}
+
 void QuicServerWorker::start() {
   CHECK(socket_);
   if (!pacingTimer_) {
     pacingTimer_ = TimerHighRes::newTimer(
         evb_, transportSettings_.pacingTimerTickInterval);
   }
+  if (transportSettings_.enableZeroCopyWrites &&
+      transportSettings_.batchingMode == QuicBatchingMode::BATCHING_MODE_GSO &&
+      !zeroCopyTracker_) {
+    zeroCopyTracker_ = std::make_unique<ZeroCopyTracker>(
+        *socket_,
+        transportSettings_.zeroCopyWriteThreshold,
+        statsCallback_.get());
+    if (zeroCopyTracker_->enabled()) {
+      socket_->setErrMessageCallback(this);
+    } else {
+      zeroCopyTracker_.reset();
+    }
+  }
+  if (transportSettings_.txTimePacing && !enableTxTime(*socket_)) {
+    // The transports fall back to the pacing timer.
+    transportSettings_.txTimePacing = false;
+  }
+  if (transportSettings_.enableEcn &&
+      (!BatchWriterFactory::canMarkEcn(transportSettings_.batchingMode) ||
+       !enableRecvTos(*socket_))) {
+    // The transports neither mark nor echo ECN.
+    transportSettings_.enableEcn = false;
+  }
+  if (transportSettings_.autoTuneReceiveWindows && !receiveWindowBudget_) {
+    receiveWindowBudget_ = std::make_shared<ReceiveWindowBudget>(
+        transportSettings_.autoTunedWindowBudgetPerWorker);
+  }
+  const auto& cacheConfig = transportSettings_.congestionStateCacheConfig;
+  if (cacheConfig.enabled && !congestionStateCache_) {
+    congestionStateCache_ = std::make_shared<CongestionStateCache>(
+        cacheConfig.maxEntries, cacheConfig.maxAge);
+  }
+  // Without a Retry rate or NEW_TOKEN frames there are no tokens to validate.
+  if (transportSettings_.addressTokenSecret && !tokenGenerator_ &&
+      (retryRateLimiter_ || transportSettings_.issueNewTokens)) {
+    tokenGenerator_ = std::make_shared<TokenGenerator>(
+        *transportSettings_.addressTokenSecret);
+  }
+  if (tokenGenerator_ && retryRateLimiter_ && !retryIntegrityAead_) {
+    retryIntegrityAead_ = FizzCryptoFactory().makeRetryIntegrityAead();
+  }
   socket_->resumeRead(this);
   VLOG(10) << folly::format(
       "Registered read on worker={}, thread={}, processId={}",
@@ -137,6 +216,12 @@ void QuicServerWorker::start() {
       (int)processId_);
 }
 
+void QuicServerWorker::errMessage(const cmsghdr& cmsg) noexcept {
+  if (zeroCopyTracker_) {
+    zeroCopyTracker_->onErrMessage(cmsg);
+  }
+}
+
 void QuicServerWorker::pauseRead() {
   CHECK(socket_);
   socket_->pauseRead();
@@ -153,10 +238,27 @@ const folly::SocketAddress& QuicServerWorker::getAddress() const {
 }
 
 void QuicServerWorker::getReadBuffer(void** buf, size_t* len) noexcept {
-  readBuffer_ = folly::IOBuf::create(
-      transportSettings_.maxRecvPacketSize * numGROBuffers_);
+  auto bufSize = transportSettings_.maxRecvPacketSize * numGROBuffers_;
+  readBuffer_ = allocateReadBuffer(bufSize);
   *buf = readBuffer_->writableData();
-  *len = transportSettings_.maxRecvPacketSize * numGROBuffers_;
+  *len = bufSize;
+}
+
+Buf QuicServerWorker::allocateReadBuffer(size_t bufSize) {
+  // The pool serves every read up to its buffer size, it is only replaced if
+  // the transport settings call for larger reads. Buffers of the previous
+  // size are freed once they are released.
+  if (!readBufferPool_ || readBufferPool_->bufferSize() < bufSize) {
+    readBufferPool_ = std::make_unique<ReceiveBufferPool>(
+        bufSize, kDefaultReceiveBufferPoolSize);
+  }
+  auto buf = readBufferPool_->tryGet();
+  if (buf) {
+    QUIC_STATS(statsCallback_, onReceiveBufferPoolHit);
+    return buf;
+  }
+  QUIC_STATS(statsCallback_, onReceiveBufferPoolMiss);
+  return folly::IOBuf::create(bufSize);
 }
 
 // Returns true if we either drop the packet or send a version
@@ -224,60 +326,210 @@ void QuicServerWorker::onDataAvailable(
   // we've flushed it.
   Buf data = std::move(readBuffer_);
 
-  if (params.gro_ <= 0) {
-    if (truncated) {
-      // This is an error, drop the packet.
-      return;
+  if (params.gro_ <= 0 && truncated) {
+    // This is an error, drop the packet.
+    readBufferPool_->recycle(std::move(data));
+    return;
+  }
+  // if we receive a truncated packet
+  // we still need to consider the prev valid ones
+  // AsyncUDPSocket::handleRead() sets the len to be the
+  // buffer size in case the data is truncated
+  if (truncated) {
+    len -= len % params.gro_;
+  }
+  handleReadData(client, std::move(data), len, params.gro_, packetReceiveTime);
+}
+
+void QuicServerWorker::handleReadData(
+    const folly::SocketAddress& client,
+    Buf data,
+    size_t len,
+    int gro,
+    const TimePoint& packetReceiveTime,
+    EcnCodepoint ecn) {
+  data->append(len);
+  QUIC_STATS(statsCallback_, onPacketReceived);
+  QUIC_STATS(statsCallback_, onRead, len);
+  if (gro <= 0) {
+    handleNetworkData(client, std::move(data), packetReceiveTime, false, ecn);
+    return;
+  }
+
+  size_t remaining = len;
+  size_t offset = 0;
+  while (remaining) {
+    if (static_cast<int>(remaining) > gro) {
+      auto tmp = data->cloneOne();
+      // start at offset
+      tmp->trimStart(offset);
+      // the actual len is len - offset now
+      // leave gro bytes
+      tmp->trimEnd(len - offset - gro);
+      DCHECK_EQ(tmp->length(), gro);
+
+      offset += gro;
+      remaining -= gro;
+      handleNetworkData(client, std::move(tmp), packetReceiveTime, false, ecn);
+    } else {
+      // do not clone the last packet
+      // start at offset, use all the remaining data
+      data->trimStart(offset);
+      DCHECK_EQ(data->length(), remaining);
+      remaining = 0;
+      handleNetworkData(
+          client, std::move(data), packetReceiveTime, false, ecn);
     }
-    data->append(len);
-    QUIC_STATS(statsCallback_, onPacketReceived);
-    QUIC_STATS(statsCallback_, onRead, len);
-    handleNetworkData(client, std::move(data), packetReceiveTime);
-  } else {
-    // if we receive a truncated packet
-    // we still need to consider the prev valid ones
-    // AsyncUDPSocket::handleRead() sets the len to be the
-    // buffer size in case the data is truncated
-    if (truncated) {
-      len -= len % params.gro_;
+  }
+}
+
+bool QuicServerWorker::shouldOnlyNotify() {
+  return transportSettings_.shouldRecvBatch;
+}
+
+void QuicServerWorker::onNotifyDataAvailable(
+    folly::AsyncUDPSocket& sock) noexcept {
+  const size_t bufSize = transportSettings_.maxRecvPacketSize * numGROBuffers_;
+  const size_t numPackets =
+      std::max<size_t>(transportSettings_.maxRecvBatchSize, 1);
+  const socklen_t addrLen = sizeof(struct sockaddr_storage);
+  recvmmsgStorage_.resize(numPackets);
+  auto& msgs = recvmmsgStorage_.msgs;
+  auto& addrs = recvmmsgStorage_.addrs;
+  auto& readBuffers = recvmmsgStorage_.readBuffers;
+  auto& iovecs = recvmmsgStorage_.iovecs;
+
+  int flags = 0;
+#ifdef FOLLY_HAVE_MSG_ERRQUEUE
+  bool useGRO = sock.getGRO() > 0;
+  bool readTos = transportSettings_.enableEcn;
+  bool useControl = useGRO || readTos;
+  if (useControl && recvmmsgControls_.size() != numPackets) {
+    recvmmsgControls_.resize(numPackets);
+  }
+  // we need to consider MSG_TRUNC too
+  if (useGRO) {
+    flags |= MSG_TRUNC;
+  }
+#endif
+
+  for (size_t i = 0; i < numPackets; ++i) {
+    // Buffers left over by the previous batch were recycled into the pool.
+    auto readBuffer = allocateReadBuffer(bufSize);
+    iovecs[i].iov_base = readBuffer->writableData();
+    iovecs[i].iov_len = bufSize;
+    readBuffers[i] = std::move(readBuffer);
+
+    auto* rawAddr = reinterpret_cast<sockaddr*>(&addrs[i]);
+    rawAddr->sa_family = sock.address().getFamily();
+
+    struct msghdr* msg = &msgs[i].msg_hdr;
+    msg->msg_name = rawAddr;
+    msg->msg_namelen = addrLen;
+    msg->msg_iov = &iovecs[i];
+    msg->msg_iovlen = 1;
+    msg->msg_control = nullptr;
+    msg->msg_controllen = 0;
+    msg->msg_flags = 0;
+#ifdef FOLLY_HAVE_MSG_ERRQUEUE
+    if (useControl) {
+      msg->msg_control = recvmmsgControls_[i].data();
+      msg->msg_controllen = recvmmsgControls_[i].size();
+    }
+#endif
+  }
+
+  int numMsgsRecvd = sock.recvmmsg(msgs.data(), numPackets, flags, nullptr);
+  if (numMsgsRecvd < 0) {
+    for (size_t i = 0; i < numPackets; ++i) {
+      readBufferPool_->recycle(std::move(readBuffers[i]));
+    }
+    if (errno == EAGAIN || errno == EWOULDBLOCK) {
+      // The socket notifies us again when it is readable.
+      return;
     }
+    return onReadError(folly::AsyncSocketException(
+        folly::AsyncSocketException::INTERNAL_ERROR,
+        "::recvmmsg() failed",
+        errno));
+  }
+  CHECK_LE(static_cast<size_t>(numMsgsRecvd), numPackets);
+  QUIC_STATS(statsCallback_, onRecvBatch, numMsgsRecvd);
 
-    data->append(len);
-    QUIC_STATS(statsCallback_, onPacketReceived);
-    QUIC_STATS(statsCallback_, onRead, len);
-
-    size_t remaining = len;
-    size_t offset = 0;
-    while (remaining) {
-      if (static_cast<int>(remaining) > params.gro_) {
-        auto tmp = data->cloneOne();
-        // start at offset
-        tmp->trimStart(offset);
-        // the actual len is len - offset now
-        // leave params.gro_ bytes
-        tmp->trimEnd(len - offset - params.gro_);
-        DCHECK_EQ(tmp->length(), params.gro_);
-
-        offset += params.gro_;
-        remaining -= params.gro_;
-        handleNetworkData(client, std::move(tmp), packetReceiveTime);
-      } else {
-        // do not clone the last packet
-        // start at offset, use all the remaining data
-        data->trimStart(offset);
-        DCHECK_EQ(data->length(), remaining);
-        remaining = 0;
-        handleNetworkData(client, std::move(data), packetReceiveTime);
+  // TODO: we can get better receive time accuracy than this, with
+  // SO_TIMESTAMP or SIOCGSTAMP.
+  auto packetReceiveTime = Clock::now();
+  readingBatch_ = true;
+  size_t i = 0;
+  for (; i < static_cast<size_t>(numMsgsRecvd); ++i) {
+    size_t bytesRead = msgs[i].msg_len;
+    if (bytesRead == 0) {
+      readBufferPool_->recycle(std::move(readBuffers[i]));
+      continue;
+    }
+    int gro = -1;
+    auto ecn = EcnCodepoint::NotEct;
+#ifdef FOLLY_HAVE_MSG_ERRQUEUE
+    if (useControl) {
+      for (struct cmsghdr* cmsg = CMSG_FIRSTHDR(&msgs[i].msg_hdr);
+           cmsg != nullptr;
+           cmsg = CMSG_NXTHDR(&msgs[i].msg_hdr, cmsg)) {
+        if (cmsg->cmsg_level == SOL_UDP && cmsg->cmsg_type == UDP_GRO) {
+          gro = *((uint16_t*)CMSG_DATA(cmsg));
+        } else if (auto tos = getRecvTos(*cmsg)) {
+          ecn = static_cast<EcnCodepoint>(*tos & kEcnCodepointMask);
+        }
+      }
+    }
+#endif
+    // msg_len only exceeds the buffer when MSG_TRUNC was requested, the
+    // kernel flags the datagrams it cut short either way.
+    if (bytesRead > bufSize || (msgs[i].msg_hdr.msg_flags & MSG_TRUNC)) {
+      // Truncated, keep the complete GRO segments only.
+      if (gro <= 0) {
+        QUIC_STATS(
+            statsCallback_, onPacketDropped, PacketDropReason::UDP_TRUNCATED);
+        readBufferPool_->recycle(std::move(readBuffers[i]));
+        continue;
       }
+      bytesRead = bufSize - bufSize % gro;
     }
+    folly::SocketAddress client;
+    client.setFromSockaddr(
+        reinterpret_cast<sockaddr*>(&addrs[i]), msgs[i].msg_hdr.msg_namelen);
+    handleReadData(
+        client,
+        std::move(readBuffers[i]),
+        bytesRead,
+        gro,
+        packetReceiveTime,
+        ecn);
   }
+  for (; i < numPackets; ++i) {
+    readBufferPool_->recycle(std::move(readBuffers[i]));
+  }
+  readingBatch_ = false;
+  flushReadBatch();
+}
+
+void QuicServerWorker::flushReadBatch() {
+  for (auto& entry : readBatch_) {
+    callback_->routeDataToWorker(
+        entry.client,
+        std::move(entry.routingData),
+        std::move(entry.networkData),
+        false /* isForwardedData */);
+  }
+  readBatch_.clear();
+  readBatchIndex_.clear();
 }
 
 void QuicServerWorker::handleNetworkData(
     const folly::SocketAddress& client,
     Buf data,
     const TimePoint& packetReceiveTime,
-    bool isForwardedData) noexcept {
+    bool isForwardedData,
+    EcnCodepoint ecn) noexcept {
   try {
     if (shutdown_) {
       VLOG(4) << "Packet received after shutdown, dropping";
@@ -321,10 +573,12 @@ void QuicServerWorker::handleNetworkData(
           false,
           std::move(parsedShortHeader->destinationConnId),
           folly::none);
+      NetworkData networkData(std::move(data), packetReceiveTime);
+      networkData.setEcnCodepoint(0, ecn);
       return forwardNetworkData(
           client,
           std::move(routingData),
-          NetworkData(std::move(data), packetReceiveTime),
+          std::move(networkData),
           isForwardedData);
     }
 
@@ -373,10 +627,12 @@ void QuicServerWorker::handleNetworkData(
         isUsingClientConnId,
         std::move(parsedLongHeader->invariant.dstConnId),
         std::move(parsedLongHeader->invariant.srcConnId));
+    NetworkData networkData(std::move(data), packetReceiveTime);
+    networkData.setEcnCodepoint(0, ecn);
     return forwardNetworkData(
         client,
         std::move(routingData),
-        NetworkData(std::move(data), packetReceiveTime),
+        std::move(networkData),
         isForwardedData);
   } catch (const std::exception& ex) {
     // Drop the packet.
@@ -476,6 +732,25 @@ void QuicServerWorker::forwardNetworkData(
     }
     return;
   }
+  if (readingBatch_ && !isForwardedData &&
+      routingData.headerForm == HeaderForm::Short) {
+    auto key = std::make_pair(client, routingData.destinationConnId);
+    auto it = readBatchIndex_.find(key);
+    if (it == readBatchIndex_.end()) {
+      readBatchIndex_.emplace(std::move(key), readBatch_.size());
+      readBatch_.emplace_back(
+          client, std::move(routingData), std::move(networkData));
+      return;
+    }
+    auto& batched = readBatch_[it->second].networkData;
+    batched.totalData += networkData.totalData;
+    for (size_t i = 0; i < networkData.packets.size(); ++i) {
+      batched.packets.emplace_back(std::move(networkData.packets[i]));
+      batched.setEcnCodepoint(
+          batched.packets.size() - 1, networkData.getEcnCodepoint(i));
+    }
+    return;
+  }
   callback_->routeDataToWorker(
       client, std::move(routingData), std::move(networkData), isForwardedData);
 }
@@ -546,9 +821,36 @@ void QuicServerWorker::dispatchPacketData(
               PacketDropReason::INVALID_PACKET);
           return;
         }
+        folly::Optional<ConnectionId> originalDstConnId;
+        if (retryRateLimiter_ && tokenGenerator_) {
+          auto initialHeader = parseInitialHeader(networkData);
+          bool addressValidated = false;
+          if (initialHeader && initialHeader->hasToken()) {
+            auto tokenValidation = tokenGenerator_->validateInitialToken(
+                initialHeader->getToken(), client);
+            if (tokenValidation.invalidRetryToken) {
+              // The client does not accept another Retry.
+              VLOG(3) << "Dropping initial with invalid retry token from "
+                      << "client=" << client;
+              QUIC_STATS(
+                  statsCallback_,
+                  onPacketDropped,
+                  PacketDropReason::INVALID_TOKEN);
+              return;
+            }
+            addressValidated = tokenValidation.addressValidated;
+            originalDstConnId = std::move(tokenValidation.originalDstConnId);
+          }
+          if (!addressValidated && initialHeader &&
+              retryRateLimiter_->check(networkData.receiveTimePoint)) {
+            // Nothing is allocated for the client until it echoes the token
+            // from its address.
+            sendRetryPacket(client, routingData, initialHeader->getVersion());
+            return;
+          }
+        }
         if (newConnRateLimiter_ &&
             newConnRateLimiter_->check(networkData.receiveTimePoint)) {
-          // TODO RETRY
           VersionNegotiationPacketBuilder builder(
               routingData.destinationConnId,
               routingData.sourceConnId.value_or(
@@ -573,6 +875,15 @@ void QuicServerWorker::dispatchPacketData(
               bufAccessor_) {
             trans->setBufAccessor(bufAccessor_.get());
           }
+          if (zeroCopyTracker_) {
+            trans->setZeroCopyTracker(zeroCopyTracker_.get());
+          }
+          if (receiveWindowBudget_) {
+            trans->setReceiveWindowBudget(receiveWindowBudget_);
+          }
+          if (congestionStateCache_) {
+            trans->setCongestionStateCache(congestionStateCache_);
+          }
           trans->setPacingTimer(pacingTimer_);
           trans->setRoutingCallback(this);
           trans->setSupportedVersions(supportedVersions_);
@@ -609,6 +920,12 @@ void QuicServerWorker::dispatchPacketData(
             trans->setClientConnectionId(*routingData.sourceConnId);
           }
           trans->setClientChosenDestConnectionId(routingData.destinationConnId);
+          if (originalDstConnId) {
+            trans->setOriginalDestinationConnectionId(*originalDstConnId);
+          }
+          if (tokenGenerator_) {
+            trans->setTokenGenerator(tokenGenerator_);
+          }
           // parameters to create server chosen connection id
           ServerConnectionIdParams serverConnIdParams(
               hostId_, static_cast<uint8_t>(processId_), workerId_);
@@ -720,9 +1037,12 @@ void QuicServerWorker::dispatchPacketData(
       client.describe(),
       logRoutingInfo(routingData.destinationConnId));
   auto recvTime = networkData.receiveTimePoint;
-  takeoverPktHandler_.forwardPacketToAnotherServer(
-      client, std::move(networkData).moveAllData(), recvTime);
-  QUIC_STATS(statsCallback_, onPacketForwarded);
+  // Packets of a read batch are forwarded one datagram at a time.
+  for (auto& packet : networkData.packets) {
+    takeoverPktHandler_.forwardPacketToAnotherServer(
+        client, std::move(packet), recvTime);
+    QUIC_STATS(statsCallback_, onPacketForwarded);
+  }
 }
 
 void QuicServerWorker::sendResetPacket(
@@ -757,6 +1077,30 @@ void QuicServerWorker::sendResetPacket(
   QUIC_STATS(statsCallback_, onStatelessReset);
 }
 
+void QuicServerWorker::sendRetryPacket(
+    const folly::SocketAddress& client,
+    const RoutingData& routingData,
+    QuicVersion version) {
+  CHECK(tokenGenerator_ && retryIntegrityAead_);
+  // The next Initial of the client is sent to the connection id of the Retry,
+  // the token carries the original one.
+  auto retrySourceConnId =
+      ConnectionId::createRandom(kMinInitialDestinationConnIdLength);
+  RetryPacketBuilder builder(
+      retrySourceConnId,
+      routingData.sourceConnId.value_or(ConnectionId(std::vector<uint8_t>())),
+      version,
+      tokenGenerator_->makeRetryToken(routingData.destinationConnId, client),
+      routingData.destinationConnId,
+      *retryIntegrityAead_);
+  auto retryData = std::move(builder).buildPacket();
+  auto retryDataLen = retryData->computeChainDataLength();
+  socket_->write(client, std::move(retryData));
+  QUIC_STATS(statsCallback_, onWrite, retryDataLen);
+  QUIC_STATS(statsCallback_, onPacketSent);
+  QUIC_STATS(statsCallback_, onRetrySent);
+}
+
 void QuicServerWorker::allowBeingTakenOver(
     std::unique_ptr<folly::AsyncUDPSocket> socket,
     const folly::SocketAddress& address) {
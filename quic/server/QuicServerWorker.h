@@ -22,7 +22,10 @@
 #include <quic/server/QuicServerPacketRouter.h>
 #include <quic/server/QuicServerTransportFactory.h>
 #include <quic/server/QuicUDPSocketFactory.h>
+#include <quic/api/ZeroCopyTracker.h>
 #include <quic/server/RateLimiter.h>
+#include <quic/server/ReceiveBufferPool.h>
+#include <quic/server/handshake/TokenGenerator.h>
 #include <quic/server/state/ServerConnectionIdRejector.h>
 #include <quic/state/QuicTransportStatsCallback.h>
 
@@ -31,6 +34,7 @@ namespace quic {
 class AcceptObserver;
 
 class QuicServerWorker : public folly::AsyncUDPSocket::ReadCallback,
+                         public folly::AsyncUDPSocket::ErrMessageCallback,
                          public QuicServerTransport::RoutingCallback,
                          public ServerConnectionIdRejector,
                          public folly::EventRecvmsgCallback {
@@ -305,6 +309,14 @@ class QuicServerWorker : public folly::AsyncUDPSocket::ReadCallback,
    */
   void setRateLimiter(std::unique_ptr<RateLimiter> rateLimiter);
 
+  /**
+   * Set the rate limiter of the Initials without a valid address validation
+   * token. Above its rate the worker answers them with a Retry, without
+   * creating a transport. Needs TransportSettings::addressTokenSecret, and
+   * must be set before start().
+   */
+  void setRetryRateLimiter(std::unique_ptr<RateLimiter> retryRateLimiter);
+
   /*
    * Get a reference to this worker's corresponding CCPReader.
    * Each worker has a CCPReader that handles recieving messages from CCP
@@ -321,6 +333,19 @@ class QuicServerWorker : public folly::AsyncUDPSocket::ReadCallback,
       bool truncated,
       OnDataAvailableParams params) noexcept override;
 
+  /**
+   * With transportSettings.shouldRecvBatch the socket only notifies the worker
+   * and the worker reads up to maxRecvBatchSize datagrams with one recvmmsg
+   * call in onNotifyDataAvailable().
+   */
+  bool shouldOnlyNotify() override;
+
+  void onNotifyDataAvailable(folly::AsyncUDPSocket& sock) noexcept override;
+
+  // folly::AsyncUDPSocket::ErrMessageCallback
+  void errMessage(const cmsghdr& cmsg) noexcept override;
+  void errMessageError(const folly::AsyncSocketException&) noexcept override {}
+
   // Routing callback
   /**
    * Called when a connecton id is available for a new connection (i.e flow)
@@ -391,7 +416,8 @@ class QuicServerWorker : public folly::AsyncUDPSocket::ReadCallback,
       const folly::SocketAddress& client,
       Buf data,
       const TimePoint& receiveTime,
-      bool isForwardedData = false) noexcept;
+      bool isForwardedData = false,
+      EcnCodepoint ecn = EcnCodepoint::NotEct) noexcept;
 
   /**
    * Try handling the data as a health check.
@@ -477,6 +503,11 @@ class QuicServerWorker : public folly::AsyncUDPSocket::ReadCallback,
       const NetworkData& networkData,
       const ConnectionId& connId);
 
+  void sendRetryPacket(
+      const folly::SocketAddress& client,
+      const RoutingData& routingData,
+      QuicVersion version);
+
   bool maybeSendVersionNegotiationPacketOrDrop(
       const folly::SocketAddress& client,
       bool isInitial,
@@ -489,6 +520,32 @@ class QuicServerWorker : public folly::AsyncUDPSocket::ReadCallback,
 
   void eventRecvmsgCallback(MsgHdr* msgHdr, int res);
 
+  /**
+   * Returns an empty buffer of at least bufSize bytes, taken from
+   * readBufferPool_ when it has one. Buffers that end up unused go back with
+   * readBufferPool_->recycle().
+   */
+  Buf allocateReadBuffer(size_t bufSize);
+
+  /**
+   * Splits a datagram of len bytes read into data into its GRO segments, if
+   * gro is positive, and handles each of them. They share the ECN codepoint
+   * of the datagram.
+   */
+  void handleReadData(
+      const folly::SocketAddress& client,
+      Buf data,
+      size_t len,
+      int gro,
+      const TimePoint& packetReceiveTime,
+      EcnCodepoint ecn = EcnCodepoint::NotEct);
+
+  /**
+   * Routes the short header packets collected while reading a batch, one
+   * NetworkData per client and destination connection id.
+   */
+  void flushReadBatch();
+
   std::unique_ptr<folly::AsyncUDPSocket> socket_;
   folly::SocketOptionMap* socketOptions_{nullptr};
   std::shared_ptr<WorkerCallback> callback_;
@@ -509,6 +566,42 @@ class QuicServerWorker : public folly::AsyncUDPSocket::ReadCallback,
       boundServerTransports_;
 
   Buf readBuffer_;
+  // Recycles the buffers handed to the socket in getReadBuffer().
+  std::unique_ptr<ReceiveBufferPool> readBufferPool_;
+  RecvmmsgStorage recvmmsgStorage_;
+#ifdef FOLLY_HAVE_MSG_ERRQUEUE
+  // Control buffers of the recvmmsg batch, with room for UDP_GRO and for
+  // IP_TOS or IPV6_TCLASS. Resized only when the batch size changes.
+  std::vector<std::array<
+      char,
+      CMSG_SPACE(sizeof(uint16_t)) + CMSG_SPACE(sizeof(int))>>
+      recvmmsgControls_;
+#endif
+
+  struct ReadBatchEntry {
+    folly::SocketAddress client;
+    RoutingData routingData;
+    NetworkData networkData;
+
+    ReadBatchEntry(
+        const folly::SocketAddress& clientIn,
+        RoutingData&& routingDataIn,
+        NetworkData&& networkDataIn)
+        : client(clientIn),
+          routingData(std::move(routingDataIn)),
+          networkData(std::move(networkDataIn)) {}
+  };
+  // Set while onNotifyDataAvailable() handles a batch. The short header
+  // packets of the batch are grouped in readBatch_, in the order in which the
+  // first packet of each connection arrived, so that every transport processes
+  // all its packets before it writes.
+  bool readingBatch_{false};
+  std::vector<ReadBatchEntry> readBatch_;
+  folly::F14FastMap<
+      QuicServerTransport::SourceIdentity,
+      size_t,
+      SourceIdentityHash>
+      readBatchIndex_;
   bool shutdown_{false};
   std::vector<QuicVersion> supportedVersions_;
   std::shared_ptr<const fizz::server::FizzServerContext> ctx_;
@@ -538,9 +631,26 @@ class QuicServerWorker : public folly::AsyncUDPSocket::ReadCallback,
   // Output buffer to be used for continuous memory GSO write
   std::unique_ptr<BufAccessor> bufAccessor_;
 
+  // Buffers of the zero copy writes of all the transports on socket_.
+  std::unique_ptr<ZeroCopyTracker> zeroCopyTracker_;
+
+  // Bounds the receive window auto-tuning of all the transports.
+  std::shared_ptr<ReceiveWindowBudget> receiveWindowBudget_;
+
+  // Congestion states of the connections of this worker that closed.
+  std::shared_ptr<CongestionStateCache> congestionStateCache_;
+
   // Rate limits the creation of new connections for this worker.
   std::unique_ptr<RateLimiter> newConnRateLimiter_;
 
+  // Rate of the Initials without a valid token above which they get a Retry.
+  std::unique_ptr<RateLimiter> retryRateLimiter_;
+
+  // Set on start when the transport settings have an address token secret
+  // and the worker sends a Retry or NEW_TOKEN frames.
+  std::shared_ptr<TokenGenerator> tokenGenerator_;
+  std::unique_ptr<Aead> retryIntegrityAead_;
+
   // EventRecvmsgCallback data
   std::unique_ptr<MsgHdr> msgHdr_;
 
@@ -0,0 +1,162 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ *
+ */
+
+#include <quic/server/ReceiveBufferPool.h>
+
+#include <folly/Memory.h>
+#include <glog/logging.h>
+
+namespace quic {
+
+namespace {
+constexpr size_t kCacheLineSize = 64;
+constexpr size_t kBuffersPerSlab = 16;
+} // namespace
+
+class ReceiveBufferPool::State {
+ public:
+  State(size_t bufferSize, size_t maxBuffers)
+      : bufferSize_((bufferSize + kCacheLineSize - 1) & ~(kCacheLineSize - 1)),
+        maxBuffers_(maxBuffers),
+        owner_(std::this_thread::get_id()) {
+    // Releasing a buffer must not allocate.
+    freeBuffers_.reserve(maxBuffers_);
+    remoteFreeBuffers_.reserve(maxBuffers_);
+  }
+
+  ~State() {
+    for (auto slab : slabs_) {
+      folly::aligned_free(slab);
+    }
+  }
+
+  size_t bufferSize() const {
+    return bufferSize_;
+  }
+
+  void* tryGet() {
+    DCHECK(std::this_thread::get_id() == owner_);
+    if (freeBuffers_.empty()) {
+      std::lock_guard<std::mutex> guard(remoteMutex_);
+      freeBuffers_.swap(remoteFreeBuffers_);
+    }
+    if (freeBuffers_.empty() && numBuffers_ < maxBuffers_) {
+      allocateSlab();
+    }
+    if (freeBuffers_.empty()) {
+      return nullptr;
+    }
+    auto buf = freeBuffers_.back();
+    freeBuffers_.pop_back();
+    refs_.fetch_add(1, std::memory_order_relaxed);
+    return buf;
+  }
+
+  void close() {
+    closed_.store(true, std::memory_order_release);
+    unref();
+  }
+
+  // IOBuf free function of the buffers.
+  static void release(void* buf, void* userData) {
+    auto state = static_cast<State*>(userData);
+    // Once the pool is gone the buffers only wait for the slabs to be freed.
+    if (!state->closed_.load(std::memory_order_acquire)) {
+      if (std::this_thread::get_id() == state->owner_) {
+        state->freeBuffers_.push_back(buf);
+      } else {
+        std::lock_guard<std::mutex> guard(state->remoteMutex_);
+        state->remoteFreeBuffers_.push_back(buf);
+      }
+    }
+    state->unref();
+  }
+
+ private:
+  void allocateSlab() {
+    auto numBuffers = std::min(kBuffersPerSlab, maxBuffers_ - numBuffers_);
+    auto slab = static_cast<uint8_t*>(
+        folly::aligned_malloc(numBuffers * bufferSize_, kCacheLineSize));
+    CHECK(slab) << "Failed to allocate receive buffers";
+    slabs_.push_back(slab);
+    for (size_t i = 0; i < numBuffers; ++i) {
+      freeBuffers_.push_back(slab + i * bufferSize_);
+    }
+    numBuffers_ += numBuffers;
+  }
+
+  void unref() {
+    if (refs_.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+      delete this;
+    }
+  }
+
+  const size_t bufferSize_;
+  const size_t maxBuffers_;
+  const std::thread::id owner_;
+  size_t numBuffers_{0};
+  std::vector<void*> slabs_;
+  // Only touched on the owner thread.
+  std::vector<void*> freeBuffers_;
+  std::mutex remoteMutex_;
+  std::vector<void*> remoteFreeBuffers_;
+  // One reference for the pool and one per buffer in use.
+  std::atomic<size_t> refs_{1};
+  std::atomic<bool> closed_{false};
+};
+
+ReceiveBufferPool::ReceiveBufferPool(size_t bufferSize, size_t maxBuffers)
+    : bufferSize_(bufferSize),
+      maxBuffers_(maxBuffers),
+      state_(new State(bufferSize, maxBuffers)) {
+  readyBufs_.reserve(kBuffersPerSlab);
+}
+
+ReceiveBufferPool::~ReceiveBufferPool() {
+  // Puts their buffers back in the free list, which close() then forgets.
+  readyBufs_.clear();
+  state_->close();
+}
+
+std::unique_ptr<folly::IOBuf> ReceiveBufferPool::tryGet() {
+  if (readyBufs_.empty()) {
+    refill();
+    if (readyBufs_.empty()) {
+      return nullptr;
+    }
+  }
+  auto ioBuf = std::move(readyBufs_.back());
+  readyBufs_.pop_back();
+  ioBuf->clear();
+  return ioBuf;
+}
+
+void ReceiveBufferPool::recycle(std::unique_ptr<folly::IOBuf> buf) {
+  // A chained or shared buffer may still be read by someone else.
+  if (buf && readyBufs_.size() < maxBuffers_ && !buf->isChained() &&
+      !buf->isSharedOne() && buf->capacity() >= bufferSize_) {
+    readyBufs_.push_back(std::move(buf));
+  }
+}
+
+void ReceiveBufferPool::refill() {
+  while (readyBufs_.size() < kBuffersPerSlab) {
+    auto buf = state_->tryGet();
+    if (!buf) {
+      break;
+    }
+    readyBufs_.push_back(folly::IOBuf::takeOwnership(
+        buf,
+        state_->bufferSize(),
+        0 /* length */,
+        &State::release,
+        state_));
+  }
+}
+
+} // namespace quic
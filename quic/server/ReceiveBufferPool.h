@@ -0,0 +1,78 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ *
+ */
+
+#pragma once
+
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <folly/io/IOBuf.h>
+
+namespace quic {
+
+// Number of receive buffers a worker keeps for reuse.
+constexpr size_t kDefaultReceiveBufferPoolSize = 256;
+
+/**
+ * Fixed-size, cache line aligned receive buffers carved out of slabs. A
+ * buffer goes back to the pool when the last IOBuf sharing it is freed, which
+ * can happen on any thread once the packet is handed off to another worker.
+ * Buffers freed on the thread that created the pool are recycled without
+ * locking, the others go through a mutex protected list that the owner takes
+ * back in bulk.
+ *
+ * The IOBufs over the free buffers are built in batches ahead of tryGet(), so
+ * taking a buffer does not allocate. An IOBuf the caller did not hand on,
+ * like the buffer of an empty read, is given back with recycle() and reused
+ * as is. folly frees the IOBufs handed on with the last reference to their
+ * buffer, so one is built again when such a buffer comes back. The IOBufs are
+ * not shared, which lets the packet be decrypted in place.
+ *
+ * The slabs outlive the pool until every buffer is freed.
+ */
+class ReceiveBufferPool {
+ public:
+  ReceiveBufferPool(size_t bufferSize, size_t maxBuffers);
+  ~ReceiveBufferPool();
+
+  ReceiveBufferPool(const ReceiveBufferPool&) = delete;
+  ReceiveBufferPool& operator=(const ReceiveBufferPool&) = delete;
+
+  /**
+   * Returns an empty IOBuf with at least bufferSize() bytes of tailroom, or
+   * nullptr when all maxBuffers buffers are in use. Must be called on the
+   * thread that created the pool.
+   */
+  std::unique_ptr<folly::IOBuf> tryGet();
+
+  /**
+   * Keeps an IOBuf for a later tryGet(), which returns it cleared. Like
+   * ZeroCopyTracker, chained or shared IOBufs and ones with less than
+   * bufferSize() bytes of capacity are freed instead. Must be called on the
+   * thread that created the pool.
+   */
+  void recycle(std::unique_ptr<folly::IOBuf> buf);
+
+  size_t bufferSize() const {
+    return bufferSize_;
+  }
+
+ private:
+  class State;
+
+  void refill();
+
+  size_t bufferSize_;
+  size_t maxBuffers_;
+  State* state_;
+  std::vector<std::unique_ptr<folly::IOBuf>> readyBufs_;
+};
+
+} // namespace quic
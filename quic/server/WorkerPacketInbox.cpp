@@ -0,0 +1,44 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ *
+ */
+
+#include <quic/server/WorkerPacketInbox.h>
+
+namespace quic {
+
+WorkerPacketInbox::WorkerPacketInbox(size_t numProducers, size_t queueSize) {
+  rings_.reserve(numProducers);
+  for (size_t i = 0; i < numProducers; ++i) {
+    // A ProducerConsumerQueue of size n holds n - 1 elements.
+    rings_.push_back(
+        std::make_unique<folly::ProducerConsumerQueue<HandoffPacket>>(
+            queueSize + 1));
+  }
+}
+
+WorkerPacketInbox::PushResult WorkerPacketInbox::push(
+    size_t producer,
+    const folly::SocketAddress& client,
+    RoutingData&& routingData,
+    NetworkData&& networkData,
+    bool isForwardedData) {
+  DCHECK_LT(producer, rings_.size());
+  auto& ring = *rings_[producer];
+  PushResult result;
+  // write() only moves from its arguments when there is room.
+  result.queued = ring.write(
+      client, std::move(routingData), std::move(networkData), isForwardedData);
+  if (!result.queued) {
+    return result;
+  }
+  result.queueDepth = ring.sizeGuess();
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  result.needsDrain = !drainPending_.exchange(true);
+  return result;
+}
+
+} // namespace quic
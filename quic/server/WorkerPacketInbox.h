@@ -0,0 +1,114 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ *
+ */
+
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <vector>
+
+#include <folly/ProducerConsumerQueue.h>
+#include <folly/SocketAddress.h>
+
+#include <quic/server/QuicServerPacketRouter.h>
+#include <quic/state/StateData.h>
+
+namespace quic {
+
+// Number of packets a worker can hand off to another one before the receiving
+// worker drains them.
+constexpr size_t kDefaultWorkerInboxQueueSize = 256;
+
+/**
+ * A packet read by a worker for a connection owned by another worker.
+ */
+struct HandoffPacket {
+  folly::SocketAddress client;
+  RoutingData routingData;
+  NetworkData networkData;
+  bool isForwardedData;
+
+  HandoffPacket(
+      const folly::SocketAddress& clientIn,
+      RoutingData&& routingDataIn,
+      NetworkData&& networkDataIn,
+      bool isForwardedDataIn)
+      : client(clientIn),
+        routingData(std::move(routingDataIn)),
+        networkData(std::move(networkDataIn)),
+        isForwardedData(isForwardedDataIn) {}
+};
+
+/**
+ * Packets handed off to one worker by the other workers. Every sending worker
+ * has its own single-producer single-consumer ring of pre-allocated slots, so
+ * a handoff takes neither a lock nor an allocation. The receiving worker is
+ * woken up at most once per batch and drains all the rings at once.
+ */
+class WorkerPacketInbox {
+ public:
+  struct PushResult {
+    // False when the ring of the producer is full. The arguments to push()
+    // are left untouched then, so the caller can deliver the packet another
+    // way.
+    bool queued{false};
+    // No drain is pending, the caller must schedule one on the receiving
+    // worker.
+    bool needsDrain{false};
+    // Packets in the ring of the producer, including the new one.
+    size_t queueDepth{0};
+  };
+
+  WorkerPacketInbox(size_t numProducers, size_t queueSize);
+
+  /**
+   * Queues a packet from the given producer. Must only be called from the
+   * thread of that producer.
+   */
+  PushResult push(
+      size_t producer,
+      const folly::SocketAddress& client,
+      RoutingData&& routingData,
+      NetworkData&& networkData,
+      bool isForwardedData);
+
+  /**
+   * Calls fn with every packet queued when the drain starts, and returns the
+   * number of packets. Must only be called from the thread of the receiving
+   * worker.
+   */
+  template <typename Fn>
+  size_t drain(Fn&& fn) {
+    // Producers that push after this see no drain pending and schedule a new
+    // one, so no packet waits for a wakeup that does not come.
+    drainPending_.store(false);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    size_t numPackets = 0;
+    for (auto& ring : rings_) {
+      // Bounded by what is queued now, a busy producer cannot keep the
+      // receiving worker here.
+      for (auto n = ring->sizeGuess(); n > 0; --n) {
+        auto packet = ring->frontPtr();
+        if (!packet) {
+          break;
+        }
+        fn(std::move(*packet));
+        ring->popFront();
+        ++numPackets;
+      }
+    }
+    return numPackets;
+  }
+
+ private:
+  std::vector<std::unique_ptr<folly::ProducerConsumerQueue<HandoffPacket>>>
+      rings_;
+  std::atomic<bool> drainPending_{false};
+};
+
+} // namespace quic
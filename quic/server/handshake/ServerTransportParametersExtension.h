@@ -30,7 +30,10 @@ class ServerTransportParametersExtension : public fizz::ServerExtensions {
       TransportPartialReliabilitySetting partialReliability,
       const StatelessResetToken& token,
       ConnectionId initialSourceCid,
-      ConnectionId originalDestinationCid)
+      ConnectionId originalDestinationCid,
+      uint64_t maxDatagramFrameSize = 0,
+      uint64_t minAckDelay = 0,
+      folly::Optional<ConnectionId> retrySourceCid = folly::none)
       : encodingVersion_(encodingVersion),
         initialMaxData_(initialMaxData),
         initialMaxStreamDataBidiLocal_(initialMaxStreamDataBidiLocal),
@@ -44,7 +47,10 @@ class ServerTransportParametersExtension : public fizz::ServerExtensions {
         partialReliability_(partialReliability),
         token_(token),
         initialSourceCid_(initialSourceCid),
-        originalDestinationCid_(originalDestinationCid) {}
+        originalDestinationCid_(originalDestinationCid),
+        maxDatagramFrameSize_(maxDatagramFrameSize),
+        minAckDelay_(minAckDelay),
+        retrySourceCid_(std::move(retrySourceCid)) {}
 
   ~ServerTransportParametersExtension() override = default;
 
@@ -107,6 +113,22 @@ class ServerTransportParametersExtension : public fizz::ServerExtensions {
       params.parameters.push_back(encodeConnIdParameter(
           TransportParameterId::initial_source_connection_id,
           initialSourceCid_));
+      if (retrySourceCid_) {
+        params.parameters.push_back(encodeConnIdParameter(
+            TransportParameterId::retry_source_connection_id,
+            *retrySourceCid_));
+      }
+    }
+
+    if (maxDatagramFrameSize_ > 0) {
+      params.parameters.push_back(encodeIntegerParameter(
+          TransportParameterId::max_datagram_frame_size,
+          maxDatagramFrameSize_));
+    }
+
+    if (minAckDelay_ > 0) {
+      params.parameters.push_back(encodeIntegerParameter(
+          TransportParameterId::min_ack_delay, minAckDelay_));
     }
 
     exts.push_back(encodeExtension(params, encodingVersion_));
@@ -133,5 +155,11 @@ class ServerTransportParametersExtension : public fizz::ServerExtensions {
   StatelessResetToken token_;
   ConnectionId initialSourceCid_;
   ConnectionId originalDestinationCid_;
+  // Zero if datagrams are not supported.
+  uint64_t maxDatagramFrameSize_;
+  // In microseconds, zero if ACK_FREQUENCY is not supported.
+  uint64_t minAckDelay_;
+  // The source connection id of the Retry the client responded to.
+  folly::Optional<ConnectionId> retrySourceCid_;
 };
 } // namespace quic
@@ -0,0 +1,217 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ *
+ */
+
+#include <quic/server/handshake/TokenGenerator.h>
+
+#include <fizz/crypto/Sha256.h>
+#include <fizz/crypto/aead/AESGCM128.h>
+#include <fizz/crypto/aead/OpenSSLEVPCipher.h>
+#include <folly/Random.h>
+#include <folly/io/Cursor.h>
+#include <quic/codec/Decode.h>
+
+namespace {
+constexpr folly::StringPiece kSalt{"Address validation token"};
+constexpr folly::StringPiece kKeyInfo{"key"};
+constexpr folly::StringPiece kIvInfo{"iv"};
+// The type and the timestamp ahead of the payload.
+constexpr size_t kTokenPrefixLen = sizeof(uint8_t) + sizeof(uint64_t);
+
+std::unique_ptr<folly::IOBuf> makeKeyInfo(
+    folly::ByteRange salt,
+    folly::StringPiece label) {
+  auto info = folly::IOBuf::create(salt.size() + label.size());
+  folly::io::Appender appender(info.get(), 0);
+  appender.push(salt);
+  appender.push(folly::ByteRange(label));
+  return info;
+}
+
+bool isFresh(
+    quic::TokenGenerator::Clock::time_point issued,
+    quic::TokenGenerator::Clock::time_point now,
+    std::chrono::seconds lifetime) {
+  // Other servers sharing the secret may have a slightly different clock.
+  return issued <= now + lifetime && now <= issued + lifetime;
+}
+} // namespace
+
+namespace quic {
+
+TokenGenerator::TokenGenerator(const AddressTokenSecret& secret)
+    : hkdf_(fizz::HkdfImpl::create<fizz::Sha256>()),
+      pseudoRandomKey_(hkdf_.extract(kSalt, folly::range(secret))),
+      aead_(fizz::OpenSSLEVPCipher::makeCipher<fizz::AESGCM128>()) {}
+
+std::string TokenGenerator::makeRetryToken(
+    const ConnectionId& originalDstConnId,
+    const folly::SocketAddress& clientAddress,
+    Clock::time_point now) {
+  RetryToken retryToken(
+      originalDstConnId, clientAddress.getIPAddress(), clientAddress.getPort());
+  return sealToken(TokenType::Retry, now, retryToken.getPlaintextToken());
+}
+
+std::string TokenGenerator::makeNewToken(
+    const folly::IPAddress& clientIp,
+    Clock::time_point now) {
+  auto clientIpStr = clientIp.str();
+  auto payload = folly::IOBuf::create(sizeof(uint8_t) + clientIpStr.size());
+  folly::io::Appender appender(payload.get(), 0);
+  appender.writeBE<uint8_t>(clientIpStr.size());
+  appender.push((const uint8_t*)clientIpStr.data(), clientIpStr.size());
+  return sealToken(TokenType::NewToken, now, std::move(payload));
+}
+
+folly::Optional<ConnectionId> TokenGenerator::validateRetryToken(
+    const std::string& token,
+    const folly::SocketAddress& clientAddress,
+    Clock::time_point now) {
+  auto openedToken = openToken(token);
+  if (!openedToken || openedToken->type != TokenType::Retry) {
+    return folly::none;
+  }
+  return checkRetryToken(*openedToken, clientAddress, now);
+}
+
+bool TokenGenerator::validateNewToken(
+    const std::string& token,
+    const folly::IPAddress& clientIp,
+    Clock::time_point now) {
+  auto openedToken = openToken(token);
+  return openedToken && openedToken->type == TokenType::NewToken &&
+      checkNewToken(*openedToken, clientIp, now);
+}
+
+TokenGenerator::InitialTokenValidation TokenGenerator::validateInitialToken(
+    const std::string& token,
+    const folly::SocketAddress& clientAddress,
+    Clock::time_point now) {
+  InitialTokenValidation validation;
+  auto openedToken = openToken(token);
+  if (!openedToken) {
+    return validation;
+  }
+  if (openedToken->type == TokenType::Retry) {
+    validation.originalDstConnId =
+        checkRetryToken(*openedToken, clientAddress, now);
+    validation.addressValidated = validation.originalDstConnId.has_value();
+    validation.invalidRetryToken = !validation.addressValidated;
+  } else {
+    validation.addressValidated =
+        checkNewToken(*openedToken, clientAddress.getIPAddress(), now);
+  }
+  return validation;
+}
+
+std::string TokenGenerator::sealToken(
+    TokenType type,
+    Clock::time_point now,
+    std::unique_ptr<folly::IOBuf> payload) {
+  std::array<uint8_t, kAddressTokenSaltLength> salt;
+  folly::Random::secureRandom(salt.data(), salt.size());
+  setTokenKey(folly::range(salt));
+
+  auto plaintext = folly::IOBuf::create(kTokenPrefixLen);
+  folly::io::Appender appender(plaintext.get(), 0);
+  appender.writeBE<uint8_t>(static_cast<uint8_t>(type));
+  appender.writeBE<uint64_t>(
+      std::chrono::duration_cast<std::chrono::seconds>(now.time_since_epoch())
+          .count());
+  plaintext->prependChain(std::move(payload));
+  // The key seals this token only, so the nonce is the iv of the key.
+  auto ciphertext = aead_->encrypt(std::move(plaintext), nullptr, 0);
+
+  std::string token;
+  token.reserve(salt.size() + ciphertext->computeChainDataLength());
+  token.append(reinterpret_cast<const char*>(salt.data()), salt.size());
+  for (auto range : *ciphertext) {
+    token.append(reinterpret_cast<const char*>(range.data()), range.size());
+  }
+  return token;
+}
+
+folly::Optional<TokenGenerator::OpenedToken> TokenGenerator::openToken(
+    const std::string& token) {
+  if (token.size() <
+      kAddressTokenSaltLength + kTokenPrefixLen + aead_->getCipherOverhead()) {
+    return folly::none;
+  }
+  auto data = reinterpret_cast<const uint8_t*>(token.data());
+  setTokenKey(folly::ByteRange(data, kAddressTokenSaltLength));
+  auto plaintext = aead_->tryDecrypt(
+      folly::IOBuf::copyBuffer(
+          data + kAddressTokenSaltLength,
+          token.size() - kAddressTokenSaltLength),
+      nullptr,
+      0);
+  if (!plaintext) {
+    return folly::none;
+  }
+  folly::io::Cursor cursor(plaintext->get());
+  auto type = cursor.readBE<uint8_t>();
+  if (type != static_cast<uint8_t>(TokenType::Retry) &&
+      type != static_cast<uint8_t>(TokenType::NewToken)) {
+    return folly::none;
+  }
+  OpenedToken openedToken;
+  openedToken.type = static_cast<TokenType>(type);
+  openedToken.issued =
+      Clock::time_point(std::chrono::seconds(cursor.readBE<uint64_t>()));
+  cursor.clone(openedToken.payload, cursor.totalLength());
+  return openedToken;
+}
+
+void TokenGenerator::setTokenKey(folly::ByteRange salt) {
+  fizz::TrafficKey trafficKey;
+  trafficKey.key = hkdf_.expand(
+      folly::range(pseudoRandomKey_),
+      *makeKeyInfo(salt, kKeyInfo),
+      aead_->keyLength());
+  trafficKey.iv = hkdf_.expand(
+      folly::range(pseudoRandomKey_),
+      *makeKeyInfo(salt, kIvInfo),
+      aead_->ivLength());
+  aead_->setKey(std::move(trafficKey));
+}
+
+folly::Optional<ConnectionId> TokenGenerator::checkRetryToken(
+    const OpenedToken& openedToken,
+    const folly::SocketAddress& clientAddress,
+    Clock::time_point now) const {
+  if (!isFresh(openedToken.issued, now, kRetryTokenLifetime)) {
+    return folly::none;
+  }
+  folly::io::Cursor cursor(openedToken.payload.get());
+  auto retryToken = parsePlaintextRetryToken(cursor);
+  if (!retryToken || retryToken->clientIp != clientAddress.getIPAddress() ||
+      retryToken->clientPort != clientAddress.getPort()) {
+    return folly::none;
+  }
+  return retryToken->originalDstConnId;
+}
+
+bool TokenGenerator::checkNewToken(
+    const OpenedToken& openedToken,
+    const folly::IPAddress& clientIp,
+    Clock::time_point now) const {
+  if (!isFresh(openedToken.issued, now, kNewTokenLifetime)) {
+    return false;
+  }
+  folly::io::Cursor cursor(openedToken.payload.get());
+  if (!cursor.canAdvance(sizeof(uint8_t))) {
+    return false;
+  }
+  auto clientIpLen = cursor.readBE<uint8_t>();
+  if (!cursor.canAdvance(clientIpLen)) {
+    return false;
+  }
+  return cursor.readFixedString(clientIpLen) == clientIp.str();
+}
+
+} // namespace quic
@@ -0,0 +1,121 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ *
+ */
+
+#pragma once
+
+#include <fizz/crypto/Hkdf.h>
+#include <fizz/crypto/aead/Aead.h>
+#include <folly/IPAddress.h>
+#include <folly/SocketAddress.h>
+#include <quic/codec/Types.h>
+
+#include <chrono>
+
+namespace quic {
+
+using AddressTokenSecret = std::array<uint8_t, kAddressTokenSecretLength>;
+
+/**
+ * Generates and validates the address validation tokens of the server, the
+ * tokens of Retry packets and of NEW_TOKEN frames. The tokens are stateless,
+ * any worker with the same secret validates them.
+ *
+ * PRK = HKDF-Extract(Salt, secret)
+ * key = HKDF-Expand(PRK, salt || "key", keyLength), iv likewise
+ * Token = salt || AEAD(type || timestamp || payload)
+ *
+ * The salt is random, so every token is sealed under a key and nonce of its
+ * own and no amount of tokens wears out the secret. The payload of a Retry
+ * token is the plaintext RetryToken, the one of a NEW_TOKEN token is the
+ * client ip.
+ *
+ * Not thread safe, the key of the cipher changes with every token.
+ */
+class TokenGenerator {
+ public:
+  using Clock = std::chrono::system_clock;
+
+  /**
+   * What the token of a client Initial proves. A token that does not open
+   * may come from another issuer and is as good as no token.
+   */
+  struct InitialTokenValidation {
+    // Whether the client owns its address.
+    bool addressValidated{false};
+    // Set for a Retry token of this server that does not match the client,
+    // which must not be served.
+    bool invalidRetryToken{false};
+    // The original destination connection id of a valid Retry token.
+    folly::Optional<ConnectionId> originalDstConnId;
+  };
+
+  explicit TokenGenerator(const AddressTokenSecret& secret);
+
+  std::string makeRetryToken(
+      const ConnectionId& originalDstConnId,
+      const folly::SocketAddress& clientAddress,
+      Clock::time_point now = Clock::now());
+
+  std::string makeNewToken(
+      const folly::IPAddress& clientIp,
+      Clock::time_point now = Clock::now());
+
+  /**
+   * Returns the original destination connection id of a Retry token that was
+   * issued to the client address less than kRetryTokenLifetime ago.
+   */
+  folly::Optional<ConnectionId> validateRetryToken(
+      const std::string& token,
+      const folly::SocketAddress& clientAddress,
+      Clock::time_point now = Clock::now());
+
+  bool validateNewToken(
+      const std::string& token,
+      const folly::IPAddress& clientIp,
+      Clock::time_point now = Clock::now());
+
+  InitialTokenValidation validateInitialToken(
+      const std::string& token,
+      const folly::SocketAddress& clientAddress,
+      Clock::time_point now = Clock::now());
+
+ private:
+  enum class TokenType : uint8_t { Retry = 1, NewToken = 2 };
+
+  struct OpenedToken {
+    TokenType type;
+    Clock::time_point issued;
+    std::unique_ptr<folly::IOBuf> payload;
+  };
+
+  std::string sealToken(
+      TokenType type,
+      Clock::time_point now,
+      std::unique_ptr<folly::IOBuf> payload);
+
+  folly::Optional<OpenedToken> openToken(const std::string& token);
+
+  // Keys the cipher for the token with the given salt.
+  void setTokenKey(folly::ByteRange salt);
+
+  folly::Optional<ConnectionId> checkRetryToken(
+      const OpenedToken& openedToken,
+      const folly::SocketAddress& clientAddress,
+      Clock::time_point now) const;
+
+  bool checkNewToken(
+      const OpenedToken& openedToken,
+      const folly::IPAddress& clientIp,
+      Clock::time_point now) const;
+
+  fizz::HkdfImpl hkdf_;
+  std::vector<uint8_t> pseudoRandomKey_;
+  std::unique_ptr<fizz::Aead> aead_;
+};
+
+} // namespace quic
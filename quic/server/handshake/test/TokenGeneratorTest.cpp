@@ -0,0 +1,155 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ *
+ */
+
+#include <quic/server/handshake/TokenGenerator.h>
+#include <folly/Random.h>
+#include <folly/portability/GTest.h>
+
+#include <set>
+
+using namespace testing;
+
+namespace quic {
+namespace test {
+
+class TokenGeneratorTest : public Test {
+ public:
+  void SetUp() override {
+    folly::Random::secureRandom(secret_.data(), secret_.size());
+  }
+
+ protected:
+  AddressTokenSecret secret_;
+  ConnectionId odcid_{{0x14, 0x35, 0x22, 0x11, 0x41, 0x08, 0x19, 0x77}};
+  folly::SocketAddress client_{"1.2.3.4", 8080};
+};
+
+TEST_F(TokenGeneratorTest, RetryToken) {
+  TokenGenerator generator(secret_);
+  auto token = generator.makeRetryToken(odcid_, client_);
+  auto validated = generator.validateRetryToken(token, client_);
+  ASSERT_TRUE(validated.has_value());
+  EXPECT_EQ(*validated, odcid_);
+  // Stateless, another generator with the same secret validates it too.
+  TokenGenerator otherGenerator(secret_);
+  EXPECT_EQ(otherGenerator.validateRetryToken(token, client_), odcid_);
+  EXPECT_FALSE(generator.validateNewToken(token, client_.getIPAddress()));
+}
+
+TEST_F(TokenGeneratorTest, RetryTokenDifferentAddress) {
+  TokenGenerator generator(secret_);
+  auto token = generator.makeRetryToken(odcid_, client_);
+  folly::SocketAddress otherPort("1.2.3.4", 8081);
+  folly::SocketAddress otherIp("1.2.3.5", 8080);
+  EXPECT_FALSE(generator.validateRetryToken(token, otherPort).has_value());
+  EXPECT_FALSE(generator.validateRetryToken(token, otherIp).has_value());
+}
+
+TEST_F(TokenGeneratorTest, RetryTokenExpired) {
+  TokenGenerator generator(secret_);
+  auto now = TokenGenerator::Clock::now();
+  auto token = generator.makeRetryToken(odcid_, client_, now);
+  // The timestamp of the token is in seconds.
+  EXPECT_TRUE(generator
+                  .validateRetryToken(
+                      token, client_, now + kRetryTokenLifetime - 1s)
+                  .has_value());
+  EXPECT_FALSE(generator
+                   .validateRetryToken(
+                       token, client_, now + kRetryTokenLifetime + 1s)
+                   .has_value());
+}
+
+TEST_F(TokenGeneratorTest, TamperedToken) {
+  TokenGenerator generator(secret_);
+  auto token = generator.makeRetryToken(odcid_, client_);
+  for (size_t i = 0; i < token.size(); ++i) {
+    auto tampered = token;
+    tampered[i] ^= 0x01;
+    EXPECT_FALSE(generator.validateRetryToken(tampered, client_).has_value());
+  }
+  EXPECT_FALSE(generator.validateRetryToken(token.substr(0, 20), client_)
+                   .has_value());
+  EXPECT_FALSE(generator.validateRetryToken("", client_).has_value());
+}
+
+TEST_F(TokenGeneratorTest, DifferentSecret) {
+  TokenGenerator generator(secret_);
+  auto token = generator.makeRetryToken(odcid_, client_);
+  AddressTokenSecret otherSecret;
+  folly::Random::secureRandom(otherSecret.data(), otherSecret.size());
+  TokenGenerator otherGenerator(otherSecret);
+  EXPECT_FALSE(otherGenerator.validateRetryToken(token, client_).has_value());
+}
+
+TEST_F(TokenGeneratorTest, NewToken) {
+  TokenGenerator generator(secret_);
+  auto now = TokenGenerator::Clock::now();
+  auto token = generator.makeNewToken(client_.getIPAddress(), now);
+  // The port of the next connection differs.
+  EXPECT_TRUE(generator.validateNewToken(token, client_.getIPAddress(), now));
+  EXPECT_FALSE(generator.validateNewToken(
+      token, folly::IPAddress("1.2.3.5"), now));
+  EXPECT_FALSE(generator.validateNewToken(
+      token, client_.getIPAddress(), now + kNewTokenLifetime + 1s));
+  EXPECT_FALSE(generator.validateRetryToken(token, client_, now).has_value());
+}
+
+TEST_F(TokenGeneratorTest, UniqueSalts) {
+  // The salt keys the token, two tokens never share a key or a nonce.
+  TokenGenerator generator(secret_);
+  std::set<std::string> salts;
+  constexpr size_t kNumTokens = 1000;
+  for (size_t i = 0; i < kNumTokens; ++i) {
+    auto token = i % 2 ? generator.makeRetryToken(odcid_, client_)
+                       : generator.makeNewToken(client_.getIPAddress());
+    salts.insert(token.substr(0, kAddressTokenSaltLength));
+  }
+  EXPECT_EQ(salts.size(), kNumTokens);
+}
+
+TEST_F(TokenGeneratorTest, InitialToken) {
+  TokenGenerator generator(secret_);
+  auto retryValidation = generator.validateInitialToken(
+      generator.makeRetryToken(odcid_, client_), client_);
+  EXPECT_TRUE(retryValidation.addressValidated);
+  EXPECT_FALSE(retryValidation.invalidRetryToken);
+  EXPECT_EQ(retryValidation.originalDstConnId, odcid_);
+
+  folly::SocketAddress otherPort("1.2.3.4", 8081);
+  auto otherPortValidation = generator.validateInitialToken(
+      generator.makeRetryToken(odcid_, client_), otherPort);
+  EXPECT_FALSE(otherPortValidation.addressValidated);
+  EXPECT_TRUE(otherPortValidation.invalidRetryToken);
+
+  // The next connection of the client comes from another port.
+  auto newTokenValidation = generator.validateInitialToken(
+      generator.makeNewToken(client_.getIPAddress()), otherPort);
+  EXPECT_TRUE(newTokenValidation.addressValidated);
+  EXPECT_FALSE(newTokenValidation.invalidRetryToken);
+  EXPECT_FALSE(newTokenValidation.originalDstConnId.has_value());
+}
+
+TEST_F(TokenGeneratorTest, ForeignToken) {
+  // A token of another issuer is no token, whatever its first byte.
+  TokenGenerator generator(secret_);
+  std::string token(64, '\x01');
+  auto validation = generator.validateInitialToken(token, client_);
+  EXPECT_FALSE(validation.addressValidated);
+  EXPECT_FALSE(validation.invalidRetryToken);
+  AddressTokenSecret otherSecret;
+  folly::Random::secureRandom(otherSecret.data(), otherSecret.size());
+  TokenGenerator otherGenerator(otherSecret);
+  validation = generator.validateInitialToken(
+      otherGenerator.makeRetryToken(odcid_, client_), client_);
+  EXPECT_FALSE(validation.addressValidated);
+  EXPECT_FALSE(validation.invalidRetryToken);
+}
+
+} // namespace test
+} // namespace quic
@@ -122,6 +122,10 @@ void processClientInitialParams(
   auto activeConnectionIdLimit = getIntegerParameter(
       TransportParameterId::active_connection_id_limit,
       clientParams.parameters);
+  auto maxDatagramFrameSize = getIntegerParameter(
+      TransportParameterId::max_datagram_frame_size, clientParams.parameters);
+  auto minAckDelay = getIntegerParameter(
+      TransportParameterId::min_ack_delay, clientParams.parameters);
   if (conn.version == QuicVersion::QUIC_DRAFT) {
     auto initialSourceConnId = getConnIdParameter(
         TransportParameterId::initial_source_connection_id,
@@ -193,6 +197,14 @@ void processClientInitialParams(
   }
   VLOG(10) << "conn.partialReliabilityEnabled="
            << conn.partialReliabilityEnabled;
+
+  if (conn.transportSettings.datagramConfig.enabled) {
+    conn.datagramState.maxWriteFrameSize = maxDatagramFrameSize.value_or(0);
+  }
+  if (conn.transportSettings.ackFrequencyConfig.enabled && minAckDelay) {
+    conn.ackFrequencyState.peerMinAckDelay =
+        std::chrono::microseconds(*minAckDelay);
+  }
 }
 
 void updateHandshakeState(QuicServerConnectionState& conn) {
@@ -279,6 +291,12 @@ void updateHandshakeState(QuicServerConnectionState& conn) {
     if (conn.version != QuicVersion::MVFST_D24 && !conn.sentHandshakeDone) {
       sendSimpleFrame(conn, HandshakeDoneFrame());
       conn.sentHandshakeDone = true;
+      if (conn.transportSettings.issueNewTokens && conn.tokenGenerator) {
+        sendSimpleFrame(
+            conn,
+            NewTokenFrame(conn.tokenGenerator->makeNewToken(
+                conn.peerAddress.getIPAddress())));
+      }
     }
   }
 }
@@ -503,7 +521,9 @@ void handleCipherUnavailable(
     ServerEvents::ReadData pendingReadData;
     pendingReadData.peer = readData.peer;
     pendingReadData.networkData = NetworkDataSingle(
-        std::move(originalData->packet), readData.networkData.receiveTimePoint);
+        std::move(originalData->packet),
+        readData.networkData.receiveTimePoint,
+        readData.networkData.ecnCodepoint);
     pendingData->emplace_back(std::move(pendingReadData));
     VLOG(10) << "Adding pending data to "
              << toString(originalData->protectionType)
@@ -604,7 +624,17 @@ void onServerReadDataFromOpen(
             conn.transportSettings.partialReliabilityEnabled,
             *newServerConnIdData->token,
             conn.serverConnectionId.value(),
-            initialDestinationConnectionId));
+            conn.originalDestinationConnectionId.value_or(
+                initialDestinationConnectionId),
+            conn.transportSettings.datagramConfig.enabled
+                ? kDefaultMaxDatagramFrameSize
+                : 0,
+            conn.transportSettings.ackFrequencyConfig.enabled
+                ? conn.transportSettings.ackFrequencyConfig.minAckDelay.count()
+                : 0,
+            conn.originalDestinationConnectionId
+                ? folly::make_optional(initialDestinationConnectionId)
+                : folly::none));
     conn.transportParametersEncoded = true;
     CryptoFactory& cryptoFactory = *conn.serverHandshakeLayer->cryptoFactory_;
     conn.readCodec = std::make_unique<QuicReadCodec>(QuicNodeType::Server);
@@ -668,6 +698,10 @@ void onServerReadDataFromOpen(
         QUIC_TRACE(packet_drop, conn, "cipher_unavailable");
         break;
       }
+      case CodecResult::Type::CODEC_ERROR: {
+        // Closes the connection like the other protocol violations below.
+        throwFrameDecodeError(parsedPacket.codecError()->error);
+      }
       case CodecResult::Type::REGULAR_PACKET:
         break;
     }
@@ -1005,6 +1039,13 @@ void onServerReadDataFromOpen(
               conn, simpleFrame, packetNum, readData.peer != conn.peerAddress);
           break;
         }
+        case QuicFrame::Type::DatagramFrame_E: {
+          // Datagrams are not retransmittable, but they are acked like data.
+          isNonProbingPacket = true;
+          pktHasRetransmittableData = true;
+          handleDatagram(conn, *quicFrame.asDatagramFrame());
+          break;
+        }
         default: {
           break;
         }
@@ -1078,7 +1119,8 @@ void onServerReadDataFromOpen(
         ackState,
         outOfOrder,
         pktHasRetransmittableData,
-        pktHasCryptoData);
+        pktHasCryptoData,
+        readData.networkData.ecnCodepoint);
     QUIC_STATS(conn.statsCallback, onPacketProcessed);
   }
   VLOG_IF(4, !udpData.empty())
@@ -1160,6 +1202,12 @@ void onServerReadDataFromClosed(
       QUIC_TRACE(packet_drop, conn, "cipher_unavailable");
       break;
     }
+    case CodecResult::Type::CODEC_ERROR: {
+      // The connection is already closed, so the packet is only dropped.
+      VLOG(10) << "drop undecodable packet "
+               << parsedPacket.codecError()->error.reason << " " << conn;
+      break;
+    }
     case CodecResult::Type::REGULAR_PACKET:
       break;
   }
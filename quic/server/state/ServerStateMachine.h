@@ -20,6 +20,7 @@
 #include <quic/logging/QuicLogger.h>
 #include <quic/loss/QuicLossFunctions.h>
 #include <quic/server/handshake/ServerHandshake.h>
+#include <quic/server/handshake/TokenGenerator.h>
 #include <quic/server/state/ServerConnectionIdRejector.h>
 #include <quic/state/AckHandlers.h>
 #include <quic/state/QPRFunctions.h>
@@ -101,6 +102,14 @@ struct QuicServerConnectionState : public QuicConnectionStateBase {
   // Parameters to generate server chosen connection id
   folly::Optional<ServerConnectionIdParams> serverConnIdParams;
 
+  // The destination connection id of the first Initial of the client, set
+  // when the client echoed the token of a Retry.
+  folly::Optional<ConnectionId> originalDestinationConnectionId;
+
+  // Seals the token of the NEW_TOKEN frame, shared by the connections of the
+  // worker.
+  std::shared_ptr<TokenGenerator> tokenGenerator;
+
   // ConnectionIdAlgo implementation to encode and decode ConnectionId with
   // various info, such as routing related info.
   ConnectionIdAlgo* connIdAlgo{nullptr};
@@ -7,6 +7,8 @@
  */
 
 #include <quic/server/QuicServer.h>
+#include <folly/Random.h>
+#include <folly/ScopeGuard.h>
 #include <folly/futures/Promise.h>
 #include <folly/io/IOBuf.h>
 #include <folly/io/async/test/MockAsyncUDPSocket.h>
@@ -20,6 +22,7 @@
 #include <quic/common/test/TestUtils.h>
 #include <quic/congestion_control/ServerCongestionControllerFactory.h>
 #include <quic/server/AcceptObserver.h>
+#include <quic/server/QuicReusePortUDPSocketFactory.h>
 #include <quic/server/SlidingWindowRateLimiter.h>
 #include <quic/server/handshake/StatelessResetGenerator.h>
 #include <quic/server/test/Mocks.h>
@@ -31,6 +34,13 @@ using namespace folly;
 using OnDataAvailableParams =
     folly::AsyncUDPSocket::ReadCallback::OnDataAvailableParams;
 
+#if defined(__linux__) && defined(SO_ATTACH_REUSEPORT_EBPF)
+#include <linux/bpf.h>
+#include <linux/if_ether.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
 const folly::SocketAddress kClientAddr("1.2.3.4", 1234);
 const folly::SocketAddress kClientAddr2("1.2.3.5", 1235);
 const folly::SocketAddress kClientAddr3("1.2.3.6", 1236);
@@ -135,6 +145,17 @@ std::unique_ptr<folly::IOBuf> createData(size_t size) {
   return folly::IOBuf::copyBuffer(data);
 }
 
+std::unique_ptr<folly::IOBuf> createShortHeaderData(
+    const ConnectionId& connId,
+    folly::StringPiece payload) {
+  auto data = folly::IOBuf::create(1 + connId.size() + payload.size());
+  folly::io::Appender appender(data.get(), 0);
+  appender.writeBE<uint8_t>(ShortHeader::kFixedBitMask);
+  appender.push(connId.data(), connId.size());
+  appender.push(folly::ByteRange(payload));
+  return data;
+}
+
 class QuicServerWorkerTest : public Test {
  public:
   void SetUp() override {
@@ -464,6 +485,168 @@ TEST_F(QuicServerWorkerTest, RateLimit) {
   eventbase_.loop();
 }
 
+TEST_F(QuicServerWorkerTest, RetryAboveRateLimit) {
+  AddressTokenSecret secret;
+  folly::Random::secureRandom(secret.data(), secret.size());
+  TransportSettings settings;
+  settings.statelessResetTokenSecret = getRandSecret();
+  settings.addressTokenSecret = secret;
+  worker_->setTransportSettings(settings);
+  // Every Initial without a token is answered with a Retry.
+  worker_->setRetryRateLimiter(
+      std::make_unique<SlidingWindowRateLimiter>(0, 60s));
+  worker_->start();
+
+  auto srcConnId = getTestConnectionId(0);
+  auto dstConnId = getTestConnectionId(1);
+  auto makeInitial = [&](const ConnectionId& dst, const std::string& token) {
+    LongHeader header(
+        LongHeader::Types::Initial,
+        srcConnId,
+        dst,
+        1,
+        QuicVersion::MVFST,
+        token);
+    RegularQuicPacketBuilder builder(
+        kDefaultUDPSendPacketLen, std::move(header), 0 /* largestAcked */);
+    builder.encodePacketHeader();
+    while (builder.remainingSpaceInPkt() > 0) {
+      writeFrame(PaddingFrame(), builder);
+    }
+    return packetToBuf(std::move(builder).buildPacket());
+  };
+
+  folly::Optional<LongHeader> retryHeader;
+  EXPECT_CALL(*factory_, _make(_, _, _, _)).Times(0);
+  EXPECT_CALL(*transportInfoCb_, onRetrySent()).Times(1);
+  EXPECT_CALL(*socketPtr_, write(kClientAddr, _))
+      .WillOnce(Invoke([&](const folly::SocketAddress&,
+                           const std::unique_ptr<folly::IOBuf>& buf) {
+        QuicReadCodec codec(QuicNodeType::Client);
+        AckStates ackStates;
+        auto packetQueue = bufToQueue(buf->clone());
+        auto res = codec.parsePacket(packetQueue, ackStates);
+        auto retryPacket = res.retryPacket();
+        EXPECT_NE(retryPacket, nullptr);
+        if (retryPacket) {
+          retryHeader = retryPacket->header;
+        }
+        return buf->computeChainDataLength();
+      }));
+  worker_->dispatchPacketData(
+      kClientAddr,
+      RoutingData(HeaderForm::Long, true, true, dstConnId, srcConnId),
+      NetworkData(makeInitial(dstConnId, ""), Clock::now()));
+  eventbase_.loop();
+  ASSERT_TRUE(retryHeader.has_value());
+  EXPECT_EQ(retryHeader->getDestinationConnId(), srcConnId);
+  EXPECT_EQ(
+      TokenGenerator(secret).validateRetryToken(
+          retryHeader->getToken(), kClientAddr),
+      dstConnId);
+  EXPECT_EQ(worker_->getSrcToTransportMap().size(), 0);
+
+  // The client echoes the token to the connection id of the Retry.
+  auto retryConnId = retryHeader->getSourceConnId();
+  auto initial = makeInitial(retryConnId, retryHeader->getToken());
+  expectConnectionCreation(kClientAddr, retryConnId);
+  EXPECT_CALL(*transport_, onNetworkData(kClientAddr, _));
+  worker_->dispatchPacketData(
+      kClientAddr,
+      RoutingData(HeaderForm::Long, true, true, retryConnId, srcConnId),
+      NetworkData(std::move(initial), Clock::now()));
+  EXPECT_EQ(
+      worker_->getSrcToTransportMap().count(
+          std::make_pair(kClientAddr, retryConnId)),
+      1);
+  eventbase_.loop();
+}
+
+TEST_F(QuicServerWorkerTest, RetryTokenFromOtherAddress) {
+  AddressTokenSecret secret;
+  folly::Random::secureRandom(secret.data(), secret.size());
+  TransportSettings settings;
+  settings.statelessResetTokenSecret = getRandSecret();
+  settings.addressTokenSecret = secret;
+  worker_->setTransportSettings(settings);
+  worker_->setRetryRateLimiter(
+      std::make_unique<SlidingWindowRateLimiter>(0, 60s));
+  worker_->start();
+
+  auto srcConnId = getTestConnectionId(0);
+  auto dstConnId = getTestConnectionId(1);
+  LongHeader header(
+      LongHeader::Types::Initial,
+      srcConnId,
+      dstConnId,
+      1,
+      QuicVersion::MVFST,
+      TokenGenerator(secret).makeRetryToken(dstConnId, kClientAddr2));
+  RegularQuicPacketBuilder builder(
+      kDefaultUDPSendPacketLen, std::move(header), 0 /* largestAcked */);
+  builder.encodePacketHeader();
+  while (builder.remainingSpaceInPkt() > 0) {
+    writeFrame(PaddingFrame(), builder);
+  }
+  auto packet = packetToBuf(std::move(builder).buildPacket());
+
+  EXPECT_CALL(*factory_, _make(_, _, _, _)).Times(0);
+  EXPECT_CALL(*transportInfoCb_, onRetrySent()).Times(0);
+  EXPECT_CALL(
+      *transportInfoCb_, onPacketDropped(PacketDropReason::INVALID_TOKEN));
+  worker_->dispatchPacketData(
+      kClientAddr,
+      RoutingData(HeaderForm::Long, true, true, dstConnId, srcConnId),
+      NetworkData(std::move(packet), Clock::now()));
+  EXPECT_EQ(worker_->getSrcToTransportMap().size(), 0);
+  eventbase_.loop();
+}
+
+TEST_F(QuicServerWorkerTest, ForeignTokenGetsRetry) {
+  AddressTokenSecret secret;
+  folly::Random::secureRandom(secret.data(), secret.size());
+  TransportSettings settings;
+  settings.statelessResetTokenSecret = getRandSecret();
+  settings.addressTokenSecret = secret;
+  worker_->setTransportSettings(settings);
+  worker_->setRetryRateLimiter(
+      std::make_unique<SlidingWindowRateLimiter>(0, 60s));
+  worker_->start();
+
+  // A token of another issuer that looks like a Retry token is no token.
+  auto srcConnId = getTestConnectionId(0);
+  auto dstConnId = getTestConnectionId(1);
+  LongHeader header(
+      LongHeader::Types::Initial,
+      srcConnId,
+      dstConnId,
+      1,
+      QuicVersion::MVFST,
+      std::string(64, '\x01'));
+  RegularQuicPacketBuilder builder(
+      kDefaultUDPSendPacketLen, std::move(header), 0 /* largestAcked */);
+  builder.encodePacketHeader();
+  while (builder.remainingSpaceInPkt() > 0) {
+    writeFrame(PaddingFrame(), builder);
+  }
+  auto packet = packetToBuf(std::move(builder).buildPacket());
+
+  EXPECT_CALL(*factory_, _make(_, _, _, _)).Times(0);
+  EXPECT_CALL(*transportInfoCb_, onPacketDropped(_)).Times(0);
+  EXPECT_CALL(*transportInfoCb_, onRetrySent()).Times(1);
+  EXPECT_CALL(*socketPtr_, write(kClientAddr, _))
+      .WillOnce(Invoke([](const folly::SocketAddress&,
+                          const std::unique_ptr<folly::IOBuf>& buf) {
+        return buf->computeChainDataLength();
+      }));
+  worker_->dispatchPacketData(
+      kClientAddr,
+      RoutingData(HeaderForm::Long, true, true, dstConnId, srcConnId),
+      NetworkData(std::move(packet), Clock::now()));
+  EXPECT_EQ(worker_->getSrcToTransportMap().size(), 0);
+  eventbase_.loop();
+}
+
 TEST_F(QuicServerWorkerTest, QuicServerWorkerUnbindBeforeCidAvailable) {
   NiceMock<MockConnectionCallback> connCb;
   auto mockSock =
@@ -574,6 +757,138 @@ TEST_F(QuicServerWorkerTest, QuicServerMultipleConnIdsRouting) {
   transport_->QuicServerTransport::setRoutingCallback(nullptr);
 }
 
+TEST_F(QuicServerWorkerTest, RecvmmsgBatchGroupedByConnectionId) {
+  EXPECT_CALL(*socketPtr_, address()).WillRepeatedly(ReturnRef(fakeAddress_));
+  auto connId = getTestConnectionId(hostId_);
+  createQuicConnection(kClientAddr, connId);
+
+  EXPECT_CALL(*transportInfoCb_, onNewConnection());
+  transport_->QuicServerTransport::setRoutingCallback(worker_.get());
+  worker_->onConnectionIdAvailable(transport_, connId);
+  auto connId2 = connId;
+  connId2.data()[7] ^= 0x1;
+  worker_->onConnectionIdAvailable(transport_, connId2);
+
+  std::vector<Buf> datagrams;
+  datagrams.push_back(createShortHeaderData(connId, "one"));
+  datagrams.push_back(createShortHeaderData(connId2, "two"));
+  datagrams.push_back(createShortHeaderData(connId, "three"));
+  EXPECT_CALL(*socketPtr_, recvmmsg(_, _, _, nullptr))
+      .WillOnce(Invoke([&](struct mmsghdr* msgs,
+                           unsigned int vlen,
+                           unsigned int,
+                           struct timespec*) {
+        EXPECT_GE(vlen, datagrams.size());
+        for (size_t i = 0; i < datagrams.size(); ++i) {
+          auto& msg = msgs[i].msg_hdr;
+          memcpy(
+              msg.msg_iov->iov_base,
+              datagrams[i]->data(),
+              datagrams[i]->length());
+          msgs[i].msg_len = datagrams[i]->length();
+          msg.msg_namelen = kClientAddr.getAddress(
+              reinterpret_cast<sockaddr_storage*>(msg.msg_name));
+        }
+        return static_cast<int>(datagrams.size());
+      }));
+  EXPECT_CALL(*transportInfoCb_, onRecvBatch(3));
+  EXPECT_CALL(*transportInfoCb_, onPacketReceived()).Times(3);
+
+  // One NetworkData per connection id, the packets of connId in order.
+  std::vector<std::vector<std::string>> received;
+  EXPECT_CALL(*transport_, onNetworkData(kClientAddr, _))
+      .Times(2)
+      .WillRepeatedly(Invoke(
+          [&](const folly::SocketAddress&, const NetworkData& networkData) {
+            std::vector<std::string> payloads;
+            for (const auto& packet : networkData.packets) {
+              auto str = packet->clone()->moveToFbString().toStdString();
+              payloads.push_back(str.substr(1 + connId.size()));
+            }
+            received.push_back(std::move(payloads));
+          }));
+  worker_->onNotifyDataAvailable(*socketPtr_);
+  eventbase_.loop();
+
+  std::vector<std::vector<std::string>> expected = {{"one", "three"},
+                                                     {"two"}};
+  EXPECT_EQ(received, expected);
+
+  EXPECT_CALL(*transportInfoCb_, onConnectionClose(_)).Times(1);
+  EXPECT_CALL(*transport_, setRoutingCallback(nullptr));
+  worker_->onConnectionUnbound(
+      transport_.get(),
+      std::make_pair(kClientAddr, connId),
+      std::vector<ConnectionIdData>{ConnectionIdData{connId, 0},
+                                    ConnectionIdData{connId2, 1}});
+  transport_->QuicServerTransport::setRoutingCallback(nullptr);
+}
+
+TEST_F(QuicServerWorkerTest, RecvmmsgDropsTruncatedDatagram) {
+  EXPECT_CALL(*socketPtr_, address()).WillRepeatedly(ReturnRef(fakeAddress_));
+  auto connId = getTestConnectionId(hostId_);
+  createQuicConnection(kClientAddr, connId);
+
+  EXPECT_CALL(*transportInfoCb_, onNewConnection());
+  transport_->QuicServerTransport::setRoutingCallback(worker_.get());
+  worker_->onConnectionIdAvailable(transport_, connId);
+
+  EXPECT_CALL(*socketPtr_, recvmmsg(_, _, _, nullptr))
+      .WillOnce(Invoke([&](struct mmsghdr* msgs,
+                           unsigned int vlen,
+                           unsigned int,
+                           struct timespec*) {
+        EXPECT_GE(vlen, 2u);
+        // Without MSG_TRUNC in the flags the kernel fills the buffer and
+        // reports the datagram as truncated.
+        auto& oversized = msgs[0].msg_hdr;
+        auto oversizedData = createShortHeaderData(
+            connId, std::string(oversized.msg_iov->iov_len, 'a'));
+        memcpy(
+            oversized.msg_iov->iov_base,
+            oversizedData->data(),
+            oversized.msg_iov->iov_len);
+        msgs[0].msg_len = oversized.msg_iov->iov_len;
+        oversized.msg_flags = MSG_TRUNC;
+        oversized.msg_namelen = kClientAddr.getAddress(
+            reinterpret_cast<sockaddr_storage*>(oversized.msg_name));
+
+        auto& msg = msgs[1].msg_hdr;
+        auto data = createShortHeaderData(connId, "two");
+        memcpy(msg.msg_iov->iov_base, data->data(), data->length());
+        msgs[1].msg_len = data->length();
+        msg.msg_namelen = kClientAddr.getAddress(
+            reinterpret_cast<sockaddr_storage*>(msg.msg_name));
+        return 2;
+      }));
+  EXPECT_CALL(*transportInfoCb_, onRecvBatch(2));
+  EXPECT_CALL(
+      *transportInfoCb_,
+      onPacketDropped(
+          QuicTransportStatsCallback::PacketDropReason::UDP_TRUNCATED));
+  EXPECT_CALL(*transportInfoCb_, onPacketReceived()).Times(1);
+  std::vector<std::string> received;
+  EXPECT_CALL(*transport_, onNetworkData(kClientAddr, _))
+      .WillOnce(Invoke(
+          [&](const folly::SocketAddress&, const NetworkData& networkData) {
+            for (const auto& packet : networkData.packets) {
+              auto str = packet->clone()->moveToFbString().toStdString();
+              received.push_back(str.substr(1 + connId.size()));
+            }
+          }));
+  worker_->onNotifyDataAvailable(*socketPtr_);
+  eventbase_.loop();
+  EXPECT_EQ(received, std::vector<std::string>{"two"});
+
+  EXPECT_CALL(*transportInfoCb_, onConnectionClose(_)).Times(1);
+  EXPECT_CALL(*transport_, setRoutingCallback(nullptr));
+  worker_->onConnectionUnbound(
+      transport_.get(),
+      std::make_pair(kClientAddr, connId),
+      std::vector<ConnectionIdData>{ConnectionIdData{connId, 0}});
+  transport_->QuicServerTransport::setRoutingCallback(nullptr);
+}
+
 TEST_F(QuicServerWorkerTest, QuicServerNewConnection) {
   EXPECT_CALL(*socketPtr_, address()).WillRepeatedly(ReturnRef(fakeAddress_));
   auto connId = getTestConnectionId(hostId_);
@@ -1737,6 +2052,197 @@ TEST_F(QuicServerTest, NetworkTest) {
   runTest(std::vector<folly::EventBase*>());
 }
 
+TEST_F(QuicServerTest, NetworkTestReusePortSteering) {
+  // Without the privileges to load the program the kernel keeps hashing, the
+  // server works either way.
+  server_->setReusePortSteering(true);
+  runTest(std::vector<folly::EventBase*>());
+}
+
+#if defined(__linux__) && defined(SO_ATTACH_REUSEPORT_EBPF)
+namespace {
+
+std::vector<uint8_t> makeSteeringTestPayload(
+    uint8_t initialByte,
+    const ConnectionId& connId) {
+  std::vector<uint8_t> payload;
+  payload.push_back(initialByte);
+  payload.insert(payload.end(), connId.data(), connId.data() + connId.size());
+  // Packet number and a few bytes of protected payload.
+  payload.resize(payload.size() + 20, 0xab);
+  return payload;
+}
+
+/**
+ * Runs the steering program with BPF_PROG_TEST_RUN and returns the socket
+ * index it picks for a packet with the UDP payload payload. The kernel starts
+ * a socket filter at the network header of the test packet, so an Ethernet
+ * header in front of the payload is all it takes for the program to see the
+ * payload where it sees it on a reuseport group. Its EtherType is left at 0,
+ * or the kernel would expect an IP header after it.
+ */
+folly::Optional<uint32_t> runSteeringProgram(
+    int progFd,
+    const std::vector<uint8_t>& payload) {
+  std::vector<uint8_t> packet(ETH_HLEN, 0);
+  packet.insert(packet.end(), payload.begin(), payload.end());
+  bpf_attr attr;
+  memset(&attr, 0, sizeof(attr));
+  attr.test.prog_fd = progFd;
+  attr.test.data_in = reinterpret_cast<uint64_t>(packet.data());
+  attr.test.data_size_in = packet.size();
+  attr.test.repeat = 1;
+  if (::syscall(__NR_bpf, BPF_PROG_TEST_RUN, &attr, sizeof(attr)) != 0) {
+    return folly::none;
+  }
+  return attr.test.retval;
+}
+
+} // namespace
+
+TEST(QuicReusePortSteeringTest, ProgramPicksSocketOfWorkerId) {
+  constexpr size_t kNumWorkers = 3;
+  int progFd =
+      QuicReusePortUDPSocketFactory::loadWorkerIdSteeringProgram(kNumWorkers);
+  if (progFd < 0) {
+    // Loading a program needs privileges the test may not have.
+    LOG(WARNING) << "Cannot load the steering program, errno=" << errno;
+    return;
+  }
+  SCOPE_EXIT {
+    ::close(progFd);
+  };
+  DefaultConnectionIdAlgo connIdAlgo;
+  for (uint16_t workerId = 0; workerId <= 255; workerId += 17) {
+    auto connId = connIdAlgo.encodeConnectionId(
+        ServerConnectionIdParams(1, 0, static_cast<uint8_t>(workerId)));
+    ASSERT_TRUE(connId.hasValue());
+    auto socketIndex = runSteeringProgram(
+        progFd, makeSteeringTestPayload(ShortHeader::kFixedBitMask, *connId));
+    ASSERT_TRUE(socketIndex.hasValue());
+    EXPECT_EQ(*socketIndex, workerId % kNumWorkers);
+  }
+
+  // Everything else is left to the kernel hash.
+  auto connId =
+      connIdAlgo.encodeConnectionId(ServerConnectionIdParams(1, 0, 1));
+  ASSERT_TRUE(connId.hasValue());
+  auto longHeaderIndex = runSteeringProgram(
+      progFd,
+      makeSteeringTestPayload(
+          kHeaderFormMask | LongHeader::kFixedBitMask, *connId));
+  ASSERT_TRUE(longHeaderIndex.hasValue());
+  EXPECT_EQ(*longHeaderIndex, std::numeric_limits<uint32_t>::max());
+
+  ConnectionId otherVersionConnId(std::vector<uint8_t>(8, 0xff));
+  auto otherVersionIndex = runSteeringProgram(
+      progFd,
+      makeSteeringTestPayload(ShortHeader::kFixedBitMask, otherVersionConnId));
+  ASSERT_TRUE(otherVersionIndex.hasValue());
+  EXPECT_EQ(*otherVersionIndex, std::numeric_limits<uint32_t>::max());
+
+  auto tooShortIndex =
+      runSteeringProgram(progFd, {ShortHeader::kFixedBitMask, 0x40});
+  ASSERT_TRUE(tooShortIndex.hasValue());
+  EXPECT_EQ(*tooShortIndex, std::numeric_limits<uint32_t>::max());
+}
+
+TEST(QuicReusePortSteeringTest, AttachToReusePortSocket) {
+  int progFd = QuicReusePortUDPSocketFactory::loadWorkerIdSteeringProgram(2);
+  if (progFd < 0) {
+    LOG(WARNING) << "Cannot load the steering program, errno=" << errno;
+    return;
+  }
+  ::close(progFd);
+  folly::EventBase evb;
+  QuicReusePortUDPSocketFactory factory;
+  auto sock = factory.make(&evb, -1);
+  sock->bind(folly::SocketAddress("::1", 0));
+  EXPECT_TRUE(QuicReusePortUDPSocketFactory::attachWorkerIdSteering(*sock, 2));
+}
+#endif
+
+TEST_F(QuicServerTest, MisroutedPacketIsCounted) {
+  std::atomic<size_t> misrouted{0};
+  auto transportStatsFactory = std::make_unique<MockQuicStatsFactory>();
+  EXPECT_CALL(*transportStatsFactory, make()).WillRepeatedly(Invoke([&]() {
+    auto stats = std::make_unique<NiceMock<MockQuicStats>>();
+    EXPECT_CALL(*stats, onPacketMisrouted()).WillRepeatedly(Invoke([&]() {
+      ++misrouted;
+    }));
+    return stats;
+  }));
+  server_->setTransportStatsCallbackFactory(std::move(transportStatsFactory));
+  server_->start(folly::SocketAddress("::1", 0), 2);
+  server_->waitUntilInitialized();
+  auto evbs = server_->getWorkerEvbs();
+  ASSERT_EQ(evbs.size(), 2);
+
+  auto routeFromFirstWorker = [&](uint8_t workerId) {
+    auto connId = DefaultConnectionIdAlgo().encodeConnectionId(
+        ServerConnectionIdParams(serverHostId_, 0, workerId));
+    ASSERT_TRUE(connId.hasValue());
+    evbs[0]->runInEventBaseThreadAndWait([&] {
+      RoutingData routingData(
+          HeaderForm::Short, false, false, *connId, folly::none);
+      NetworkData networkData(folly::IOBuf::copyBuffer("wat"), Clock::now());
+      server_->routeDataToWorker(
+          kClientAddr, std::move(routingData), std::move(networkData));
+    });
+    // Let the other worker process its handoff.
+    evbs[1]->runInEventBaseThreadAndWait([] {});
+  };
+
+  routeFromFirstWorker(0);
+  EXPECT_EQ(misrouted.load(), 0);
+  routeFromFirstWorker(1);
+  EXPECT_EQ(misrouted.load(), 1);
+}
+
+TEST_F(QuicServerTest, HandoffQueueOverflowIsDispatched) {
+  std::atomic<size_t> queueFull{0};
+  std::atomic<size_t> dispatched{0};
+  auto transportStatsFactory = std::make_unique<MockQuicStatsFactory>();
+  EXPECT_CALL(*transportStatsFactory, make()).WillRepeatedly(Invoke([&]() {
+    auto stats = std::make_unique<NiceMock<MockQuicStats>>();
+    EXPECT_CALL(*stats, onWorkerHandoffQueueFull())
+        .WillRepeatedly(Invoke([&]() { ++queueFull; }));
+    EXPECT_CALL(
+        *stats,
+        onPacketDropped(
+            QuicTransportStatsCallback::PacketDropReason::CONNECTION_NOT_FOUND))
+        .WillRepeatedly(Invoke([&](auto) { ++dispatched; }));
+    return stats;
+  }));
+  server_->setTransportStatsCallbackFactory(std::move(transportStatsFactory));
+  server_->setWorkerHandoffQueueSize(1);
+  server_->start(folly::SocketAddress("::1", 0), 2);
+  server_->waitUntilInitialized();
+  auto evbs = server_->getWorkerEvbs();
+  ASSERT_EQ(evbs.size(), 2);
+  auto connId = DefaultConnectionIdAlgo().encodeConnectionId(
+      ServerConnectionIdParams(serverHostId_, 0, 1));
+  ASSERT_TRUE(connId.hasValue());
+
+  // Keep the second worker busy so that its handoff queue fills up.
+  folly::Baton<> busy;
+  evbs[1]->runInEventBaseThread([&] { busy.wait(); });
+  constexpr size_t kNumPackets = 3;
+  evbs[0]->runInEventBaseThreadAndWait([&] {
+    for (size_t i = 0; i < kNumPackets; ++i) {
+      RoutingData routingData(
+          HeaderForm::Short, false, false, *connId, folly::none);
+      NetworkData networkData(folly::IOBuf::copyBuffer("wat"), Clock::now());
+      server_->routeDataToWorker(
+          kClientAddr, std::move(routingData), std::move(networkData));
+    }
+  });
+  busy.post();
+  evbs[1]->runInEventBaseThreadAndWait([] {});
+  EXPECT_EQ(queueFull.load(), kNumPackets - 1);
+  EXPECT_EQ(dispatched.load(), kNumPackets);
+}
+
 TEST_F(QuicServerTest, OtherEvbs) {
   folly::ScopedEventBaseThread evbThread;
   auto evb = evbThread.getEventBase();
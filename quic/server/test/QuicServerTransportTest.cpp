@@ -814,6 +814,30 @@ TEST_F(QuicServerTransportTest, IdleTimerNotResetOnDuplicatePacket) {
   EXPECT_CALL(*transportInfoCb_, onQuicStreamClosed());
 }
 
+TEST_F(QuicServerTransportTest, IdleTimerDeadlineMovesWithoutReschedule) {
+  EXPECT_CALL(*transportInfoCb_, onNewQuicStream()).Times(1);
+  StreamId streamId = server->createBidirectionalStream().value();
+  ASSERT_TRUE(server->idleTimeout().isScheduled());
+  auto deadline = server->idleTimeout().getDeadline();
+  auto remaining = server->idleTimeout().getTimeRemaining();
+
+  recvEncryptedStream(streamId, *IOBuf::copyBuffer("hello"));
+  EXPECT_GT(server->idleTimeout().getDeadline(), deadline);
+  EXPECT_LE(server->idleTimeout().getTimeRemaining(), remaining);
+  EXPECT_CALL(*transportInfoCb_, onQuicStreamClosed());
+}
+
+TEST_F(QuicServerTransportTest, IdleTimerRearmsBeforeDeadline) {
+  ASSERT_TRUE(server->idleTimeout().isScheduled());
+  server->idleTimeout().setDeadline(Clock::now() + 1s);
+  EXPECT_CALL(*transportInfoCb_, onTimerRescheduled());
+  server->idleTimeout().timeoutExpired();
+
+  EXPECT_FALSE(server->isClosed());
+  EXPECT_TRUE(server->idleTimeout().isScheduled());
+  EXPECT_NEAR(server->idleTimeout().getTimeRemaining().count(), 1000, 50);
+}
+
 TEST_F(QuicServerTransportTest, IdleTimerNotResetWhenDataOutstanding) {
   // Clear the receivedNewPacketBeforeWrite flag, since we may reveice from
   // client during the SetUp of the test case.
@@ -896,6 +920,7 @@ TEST_F(QuicServerTransportTest, InvalidMigrationNoDrain) {
 }
 
 TEST_F(QuicServerTransportTest, IdleTimeoutExpired) {
+  server->idleTimeout().setDeadline(Clock::now());
   server->idleTimeout().timeoutExpired();
 
   EXPECT_FALSE(server->idleTimeout().isScheduled());
@@ -909,6 +934,7 @@ TEST_F(QuicServerTransportTest, IdleTimeoutExpired) {
 }
 
 TEST_F(QuicServerTransportTest, RecvDataAfterIdleTimeout) {
+  server->idleTimeout().setDeadline(Clock::now());
   server->idleTimeout().timeoutExpired();
 
   EXPECT_FALSE(server->idleTimeout().isScheduled());
@@ -1219,8 +1245,7 @@ TEST_F(QuicServerTransportTest, TestOpenAckStreamFrame) {
       if (!frame) {
         continue;
       }
-      auto it = stream->retransmissionBuffer.find(frame->offset);
-      ASSERT_TRUE(it != stream->retransmissionBuffer.end());
+      ASSERT_TRUE(stream->retransmissionBuffer.find(frame->offset));
       if (currentPacket == packetNum1 && frame->streamId == streamId) {
         buffersInPacket1++;
       }
@@ -1397,10 +1422,7 @@ TEST_F(QuicServerTransportTest, RecvRstStreamFrame) {
   stream->readBuffer.emplace_back(
       IOBuf::copyBuffer(words.at(1)), words.at(0).length(), false);
   stream->retransmissionBuffer.emplace(
-      std::piecewise_construct,
-      std::forward_as_tuple(0),
-      std::forward_as_tuple(std::make_unique<StreamBuffer>(
-          IOBuf::copyBuffer(words.at(2)), 0, false)));
+      0, StreamBuffer(IOBuf::copyBuffer(words.at(2)), 0, false));
   writeDataToQuicStream(*stream, IOBuf::copyBuffer(words.at(3)), false);
   stream->currentWriteOffset = words.at(2).length() + words.at(3).length();
   stream->currentReadOffset = words.at(0).length() + words.at(1).length();
@@ -1455,10 +1477,7 @@ TEST_F(QuicServerTransportTest, RecvStopSendingFrame) {
   stream->readBuffer.emplace_back(
       IOBuf::copyBuffer(words.at(1)), words.at(0).length(), false);
   stream->retransmissionBuffer.emplace(
-      std::piecewise_construct,
-      std::forward_as_tuple(0),
-      std::forward_as_tuple(std::make_unique<StreamBuffer>(
-          IOBuf::copyBuffer(words.at(2)), 0, false)));
+      0, StreamBuffer(IOBuf::copyBuffer(words.at(2)), 0, false));
   stream->writeBuffer.append(IOBuf::copyBuffer(words.at(3)));
   stream->currentWriteOffset = words.at(2).length() + words.at(3).length();
   stream->currentReadOffset = words.at(0).length() + words.at(1).length();
@@ -1499,10 +1518,7 @@ TEST_F(QuicServerTransportTest, RecvStopSendingFrameAfterCloseStream) {
   stream->readBuffer.emplace_back(
       IOBuf::copyBuffer(words.at(1)), words.at(0).length(), false);
   stream->retransmissionBuffer.emplace(
-      std::piecewise_construct,
-      std::forward_as_tuple(0),
-      std::forward_as_tuple(std::make_unique<StreamBuffer>(
-          IOBuf::copyBuffer(words.at(2)), 0, false)));
+      0, StreamBuffer(IOBuf::copyBuffer(words.at(2)), 0, false));
   stream->writeBuffer.append(IOBuf::copyBuffer(words.at(3)));
   stream->currentWriteOffset = words.at(2).length() + words.at(3).length();
   stream->currentReadOffset = words.at(0).length() + words.at(1).length();
@@ -1544,10 +1560,7 @@ TEST_F(QuicServerTransportTest, RecvInvalidMaxStreamData) {
   stream->readBuffer.emplace_back(
       IOBuf::copyBuffer(words.at(1)), words.at(0).length(), false);
   stream->retransmissionBuffer.emplace(
-      std::piecewise_construct,
-      std::forward_as_tuple(0),
-      std::forward_as_tuple(std::make_unique<StreamBuffer>(
-          IOBuf::copyBuffer(words.at(2)), 0, false)));
+      0, StreamBuffer(IOBuf::copyBuffer(words.at(2)), 0, false));
   stream->writeBuffer.append(IOBuf::copyBuffer(words.at(3)));
   stream->currentWriteOffset = words.at(2).length() + words.at(3).length();
   stream->currentReadOffset = words.at(0).length() + words.at(1).length();
@@ -1586,10 +1599,7 @@ TEST_F(QuicServerTransportTest, RecvStopSendingFrameAfterHalfCloseRemote) {
   stream->readBuffer.emplace_back(
       IOBuf::copyBuffer(words.at(1)), words.at(0).length(), false);
   stream->retransmissionBuffer.emplace(
-      std::piecewise_construct,
-      std::forward_as_tuple(0),
-      std::forward_as_tuple(std::make_unique<StreamBuffer>(
-          IOBuf::copyBuffer(words.at(2)), 0, false)));
+      0, StreamBuffer(IOBuf::copyBuffer(words.at(2)), 0, false));
   stream->writeBuffer.append(IOBuf::copyBuffer(words.at(3)));
   stream->currentWriteOffset = words.at(2).length() + words.at(3).length();
   stream->currentReadOffset = words.at(0).length() + words.at(1).length();
@@ -1667,10 +1677,7 @@ TEST_F(QuicServerTransportTest, RecvStopSendingFrameAfterReset) {
   stream1->readBuffer.emplace_back(
       IOBuf::copyBuffer(words.at(1)), words.at(0).length(), false);
   stream1->retransmissionBuffer.emplace(
-      std::piecewise_construct,
-      std::forward_as_tuple(0),
-      std::forward_as_tuple(std::make_unique<StreamBuffer>(
-          IOBuf::copyBuffer(words.at(2)), 0, false)));
+      0, StreamBuffer(IOBuf::copyBuffer(words.at(2)), 0, false));
   stream1->writeBuffer.append(IOBuf::copyBuffer(words.at(3)));
   stream1->currentWriteOffset = words.at(2).length() + words.at(3).length();
   stream1->currentReadOffset = words.at(0).length() + words.at(1).length();
@@ -1679,10 +1686,7 @@ TEST_F(QuicServerTransportTest, RecvStopSendingFrameAfterReset) {
   stream2->readBuffer.emplace_back(
       IOBuf::copyBuffer(words.at(1)), words.at(0).length(), false);
   stream2->retransmissionBuffer.emplace(
-      std::piecewise_construct,
-      std::forward_as_tuple(0),
-      std::forward_as_tuple(std::make_unique<StreamBuffer>(
-          IOBuf::copyBuffer(words.at(2)), 0, false)));
+      0, StreamBuffer(IOBuf::copyBuffer(words.at(2)), 0, false));
   stream2->writeBuffer.append(IOBuf::copyBuffer(words.at(3)));
   stream2->currentWriteOffset = words.at(2).length() + words.at(3).length();
   stream2->currentReadOffset = words.at(0).length() + words.at(1).length();
@@ -2302,6 +2306,34 @@ TEST_P(
   EXPECT_EQ(server->getConn().peerAddress, peerAddress);
 }
 
+TEST_P(
+    QuicServerTransportAllowMigrationTest,
+    CongestionStateCachedUnderOriginalPeerAddress) {
+  auto cache =
+      std::make_shared<CongestionStateCache>(10, std::chrono::seconds(60));
+  server->setCongestionStateCache(cache);
+  auto data = IOBuf::copyBuffer("bad data");
+  auto packetData = packetToBuf(createStreamPacket(
+      *clientConnectionId,
+      *server->getConn().serverConnectionId,
+      clientNextAppDataPacketNum++,
+      2,
+      *data,
+      0 /* cipherOverhead */,
+      0 /* largestAcked */));
+  folly::SocketAddress newPeer("100.101.102.103", 23456);
+  deliverData(std::move(packetData), false, &newPeer);
+  ASSERT_EQ(server->getConn().peerAddress, newPeer);
+  // Migrating resets the RTT, give the new path a sample.
+  server->getNonConstConn().lossState.srtt = 50ms;
+
+  server->closeNow(folly::none);
+  auto cached = cache->get(clientAddr.getIPAddress(), Clock::now());
+  ASSERT_TRUE(cached.has_value());
+  EXPECT_EQ(cached->srtt, 50ms);
+  EXPECT_FALSE(cache->get(newPeer.getIPAddress(), Clock::now()).has_value());
+}
+
 TEST_P(QuicServerTransportAllowMigrationTest, MigrateToUnvalidatedPeer) {
   auto data = IOBuf::copyBuffer("bad data");
   auto packetData = packetToBuf(createStreamPacket(
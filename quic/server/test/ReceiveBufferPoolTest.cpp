@@ -0,0 +1,119 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ *
+ */
+
+#include <gtest/gtest.h>
+
+#include <quic/server/ReceiveBufferPool.h>
+
+#include <thread>
+
+using namespace quic;
+
+TEST(ReceiveBufferPoolTest, RecyclesBuffers) {
+  ReceiveBufferPool pool(1500, 1);
+  auto buf = pool.tryGet();
+  ASSERT_NE(nullptr, buf);
+  EXPECT_EQ(0, buf->length());
+  EXPECT_GE(buf->tailroom(), 1500);
+  EXPECT_EQ(0, reinterpret_cast<uintptr_t>(buf->writableData()) % 64);
+  auto data = buf->writableData();
+  buf->append(1500);
+  buf.reset();
+  buf = pool.tryGet();
+  EXPECT_EQ(data, buf->writableData());
+  EXPECT_EQ(0, buf->length());
+}
+
+TEST(ReceiveBufferPoolTest, BuffersAreNotShared) {
+  ReceiveBufferPool pool(1500, 4);
+  std::vector<std::unique_ptr<folly::IOBuf>> bufs;
+  for (size_t i = 0; i < 4; i++) {
+    bufs.push_back(pool.tryGet());
+    ASSERT_NE(nullptr, bufs.back());
+    EXPECT_FALSE(bufs.back()->isShared());
+  }
+  bufs.clear();
+  auto buf = pool.tryGet();
+  ASSERT_NE(nullptr, buf);
+  EXPECT_FALSE(buf->isShared());
+}
+
+TEST(ReceiveBufferPoolTest, RecycleReusesTheIOBuf) {
+  ReceiveBufferPool pool(1500, 4);
+  auto buf = pool.tryGet();
+  auto ioBuf = buf.get();
+  buf->append(1000);
+  pool.recycle(std::move(buf));
+  buf = pool.tryGet();
+  EXPECT_EQ(ioBuf, buf.get());
+  EXPECT_EQ(0, buf->length());
+  EXPECT_EQ(0, buf->headroom());
+
+  // Buffers of other allocators are kept too when they are large enough.
+  auto heapBuf = folly::IOBuf::create(1500);
+  auto heapIOBuf = heapBuf.get();
+  pool.recycle(std::move(heapBuf));
+  EXPECT_EQ(heapIOBuf, pool.tryGet().get());
+}
+
+TEST(ReceiveBufferPoolTest, RecycleFreesUnusableBuffers) {
+  ReceiveBufferPool pool(1500, 1);
+  auto buf = pool.tryGet();
+  // Too small.
+  pool.recycle(folly::IOBuf::create(100));
+  EXPECT_EQ(nullptr, pool.tryGet());
+  auto clone = buf->cloneOne();
+  pool.recycle(std::move(buf));
+  EXPECT_EQ(nullptr, pool.tryGet());
+  clone.reset();
+  EXPECT_NE(nullptr, pool.tryGet());
+}
+
+TEST(ReceiveBufferPoolTest, ClonesHoldTheBuffer) {
+  ReceiveBufferPool pool(1500, 1);
+  auto buf = pool.tryGet();
+  buf->append(1000);
+  auto clone = buf->cloneOne();
+  buf.reset();
+  EXPECT_EQ(nullptr, pool.tryGet());
+  clone.reset();
+  EXPECT_NE(nullptr, pool.tryGet());
+}
+
+TEST(ReceiveBufferPoolTest, Exhausted) {
+  ReceiveBufferPool pool(1500, 20);
+  std::vector<std::unique_ptr<folly::IOBuf>> bufs;
+  for (size_t i = 0; i < 20; i++) {
+    bufs.push_back(pool.tryGet());
+    ASSERT_NE(nullptr, bufs.back());
+  }
+  EXPECT_EQ(nullptr, pool.tryGet());
+  bufs.pop_back();
+  EXPECT_NE(nullptr, pool.tryGet());
+}
+
+TEST(ReceiveBufferPoolTest, FreedOnOtherThread) {
+  ReceiveBufferPool pool(1500, 1);
+  auto buf = pool.tryGet();
+  auto data = buf->writableData();
+  std::thread([buf = std::move(buf)]() mutable { buf.reset(); }).join();
+  buf = pool.tryGet();
+  ASSERT_NE(nullptr, buf);
+  EXPECT_EQ(data, buf->writableData());
+}
+
+TEST(ReceiveBufferPoolTest, BuffersOutlivePool) {
+  auto pool = std::make_unique<ReceiveBufferPool>(1500, 2);
+  auto buf = pool->tryGet();
+  auto otherBuf = pool->tryGet();
+  pool.reset();
+  buf->append(1500);
+  memset(buf->writableData(), 'a', buf->length());
+  buf.reset();
+  std::thread([buf = std::move(otherBuf)]() mutable { buf.reset(); }).join();
+}
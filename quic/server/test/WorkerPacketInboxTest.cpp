@@ -0,0 +1,145 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ *
+ */
+
+#include <gtest/gtest.h>
+
+#include <quic/common/test/TestUtils.h>
+#include <quic/server/WorkerPacketInbox.h>
+
+#include <thread>
+
+using namespace quic;
+using namespace quic::test;
+
+namespace {
+
+RoutingData makeRoutingData(uint8_t id) {
+  return RoutingData(
+      HeaderForm::Short, false, false, getTestConnectionId(id), folly::none);
+}
+
+NetworkData makeNetworkData(size_t len) {
+  return NetworkData(
+      folly::IOBuf::copyBuffer(std::string(len, 'a')), Clock::now());
+}
+
+} // namespace
+
+TEST(WorkerPacketInboxTest, DrainInProducerOrder) {
+  WorkerPacketInbox inbox(2, 4);
+  folly::SocketAddress client("127.0.0.1", 1234);
+  auto result =
+      inbox.push(0, client, makeRoutingData(0), makeNetworkData(1), false);
+  EXPECT_TRUE(result.queued);
+  EXPECT_TRUE(result.needsDrain);
+  EXPECT_EQ(1, result.queueDepth);
+  result = inbox.push(1, client, makeRoutingData(1), makeNetworkData(2), true);
+  EXPECT_TRUE(result.queued);
+  // A drain is already pending.
+  EXPECT_FALSE(result.needsDrain);
+  EXPECT_EQ(1, result.queueDepth);
+  result = inbox.push(0, client, makeRoutingData(2), makeNetworkData(3), false);
+  EXPECT_FALSE(result.needsDrain);
+  EXPECT_EQ(2, result.queueDepth);
+
+  std::vector<size_t> sizes;
+  auto numPackets = inbox.drain([&](HandoffPacket&& packet) {
+    EXPECT_EQ(client, packet.client);
+    EXPECT_EQ(packet.networkData.totalData == 2, packet.isForwardedData);
+    sizes.push_back(packet.networkData.totalData);
+  });
+  EXPECT_EQ(3, numPackets);
+  EXPECT_EQ(std::vector<size_t>({1, 3, 2}), sizes);
+
+  // The next push must wake up the receiver again.
+  result = inbox.push(1, client, makeRoutingData(3), makeNetworkData(4), false);
+  EXPECT_TRUE(result.needsDrain);
+}
+
+TEST(WorkerPacketInboxTest, FullRingLeavesPacketUntouched) {
+  WorkerPacketInbox inbox(1, 2);
+  folly::SocketAddress client("127.0.0.1", 1234);
+  EXPECT_TRUE(
+      inbox.push(0, client, makeRoutingData(0), makeNetworkData(1), false)
+          .queued);
+  EXPECT_TRUE(
+      inbox.push(0, client, makeRoutingData(1), makeNetworkData(1), false)
+          .queued);
+  auto routingData = makeRoutingData(2);
+  auto networkData = makeNetworkData(10);
+  auto result = inbox.push(
+      0, client, std::move(routingData), std::move(networkData), false);
+  EXPECT_FALSE(result.queued);
+  EXPECT_EQ(getTestConnectionId(2), routingData.destinationConnId);
+  EXPECT_EQ(10, networkData.totalData);
+  EXPECT_EQ(1, networkData.packets.size());
+}
+
+TEST(WorkerPacketInboxTest, FullRingFallbackKeepsReadOrder) {
+  constexpr size_t kQueueSize = 4;
+  WorkerPacketInbox inbox(1, kQueueSize);
+  folly::SocketAddress client("127.0.0.1", 1234);
+  // Like QuicServer, a packet that finds the ring full is dispatched after
+  // draining the ring, so no packet is lost and they stay in read order.
+  std::vector<size_t> dispatched;
+  size_t numFallbacks = 0;
+  auto drain = [&] {
+    inbox.drain([&](HandoffPacket&& packet) {
+      dispatched.push_back(packet.networkData.totalData);
+    });
+  };
+  for (size_t len = 1; len <= 3 * kQueueSize; ++len) {
+    auto networkData = makeNetworkData(len);
+    auto result = inbox.push(
+        0, client, makeRoutingData(0), std::move(networkData), false);
+    if (!result.queued) {
+      ++numFallbacks;
+      drain();
+      dispatched.push_back(networkData.totalData);
+    }
+  }
+  drain();
+  EXPECT_EQ(2, numFallbacks);
+  std::vector<size_t> expected;
+  for (size_t len = 1; len <= 3 * kQueueSize; ++len) {
+    expected.push_back(len);
+  }
+  EXPECT_EQ(expected, dispatched);
+}
+
+TEST(WorkerPacketInboxTest, ConcurrentProducers) {
+  constexpr size_t kNumProducers = 4;
+  constexpr size_t kPacketsPerProducer = 10000;
+  WorkerPacketInbox inbox(kNumProducers, 64);
+  folly::SocketAddress client("127.0.0.1", 1234);
+  std::atomic<size_t> numDrainsNeeded{0};
+  std::vector<std::thread> producers;
+  for (size_t producer = 0; producer < kNumProducers; ++producer) {
+    producers.emplace_back([&, producer] {
+      for (size_t i = 0; i < kPacketsPerProducer;) {
+        auto result = inbox.push(
+            producer, client, makeRoutingData(0), makeNetworkData(1), false);
+        if (result.queued) {
+          numDrainsNeeded += result.needsDrain ? 1 : 0;
+          ++i;
+        } else {
+          std::this_thread::yield();
+        }
+      }
+    });
+  }
+  size_t numPackets = 0;
+  while (numPackets < kNumProducers * kPacketsPerProducer) {
+    numPackets += inbox.drain([](HandoffPacket&&) {});
+  }
+  for (auto& producer : producers) {
+    producer.join();
+  }
+  EXPECT_EQ(kNumProducers * kPacketsPerProducer, numPackets);
+  EXPECT_GE(numDrainsNeeded, 1);
+}
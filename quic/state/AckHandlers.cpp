@@ -20,15 +20,13 @@ namespace quic {
  * Process ack frame and acked outstanding packets.
  *
  * This function process incoming ack blocks which is sorted in the descending
- * order of packet number. For each ack block, we try to find a continuous range
- * of outstanding packets in the connection's outstanding packets list that is
- * acked by the current ack block. The search is in the reverse order of the
- * outstandings.packets given that the list is sorted in the ascending order of
- * packet number. For each outstanding packet that is acked by current ack
- * frame, ack and loss visitors are invoked on the sent frames. The outstanding
- * packets may contain packets from all three packet number spaces. But ack is
- * always restrained to a single space. So we also need to skip packets that are
- * not in the current packet number space.
+ * order of packet number. The outstanding packets of the packet number space
+ * the ack belongs to are indexed by packet number, so for each ack block we
+ * look up every packet number in the part of the block that overlaps with the
+ * outstanding window, largest first. Packet numbers that aren't outstanding
+ * are tombstones and are skipped. For each outstanding packet that is acked by
+ * current ack frame, ack and loss visitors are invoked on the sent frames and
+ * the packet is erased.
  *
  */
 
@@ -40,6 +38,7 @@ void processAckFrame(
     const LossVisitor& lossVisitor,
     const TimePoint& ackReceiveTime) {
   // TODO: send error if we get an ack for a packet we've not sent t18721184
+  ++conn.lossState.totalAcksRecvd;
   CongestionController::AckEvent ack;
   ack.ackTime = ackReceiveTime;
   // Using kDefaultRxPacketsBeforeAckAfterInit to reseve for ackedPackets
@@ -47,140 +46,108 @@ void processAckFrame(
   // different acking policy. It's also possibly that all acked packets are pure
   // acks which leads to different number of packets being acked usually.
   ack.ackedPackets.reserve(kDefaultRxPacketsBeforeAckAfterInit);
-  auto currentPacketIt = getLastOutstandingPacket(conn, pnSpace);
+  auto& packets = conn.outstandings.packets.packetsIn(pnSpace);
+  auto& ackState = getAckState(conn, pnSpace);
+  auto prevLargestAcked = ackState.largestAckedByPeer;
   uint64_t initialPacketAcked = 0;
   uint64_t handshakePacketAcked = 0;
   uint64_t clonedPacketsAcked = 0;
   folly::Optional<decltype(conn.lossState.lastAckedPacketSentTime)>
       lastAckedPacketSentTime;
-  auto ackBlockIt = frame.ackBlocks.cbegin();
-  while (ackBlockIt != frame.ackBlocks.cend() &&
-         currentPacketIt != conn.outstandings.packets.rend()) {
-    // In reverse order, find the first outstanding packet that has a packet
-    // number LE the endPacket of the current ack range.
-    auto rPacketIt = std::lower_bound(
-        currentPacketIt,
-        conn.outstandings.packets.rend(),
-        ackBlockIt->endPacket,
-        [&](const auto& packetWithTime, const auto& val) {
-          return packetWithTime.packet.header.getPacketSequenceNum() > val;
-        });
-    if (rPacketIt == conn.outstandings.packets.rend()) {
+  for (const auto& ackBlock : frame.ackBlocks) {
+    if (packets.empty()) {
+      break;
+    }
+    if (ackBlock.endPacket < packets.firstPacketNum()) {
       // This means that all the packets are greater than the end packet.
       // Since we iterate the ACK blocks in reverse order of end packets, our
       // work here is done.
       VLOG(10) << __func__ << " less than all outstanding packets outstanding="
-               << conn.outstandings.packets.size() << " range=["
-               << ackBlockIt->startPacket << ", " << ackBlockIt->endPacket
-               << "]"
+               << packets.size() << " range=[" << ackBlock.startPacket << ", "
+               << ackBlock.endPacket << "]"
                << " " << conn;
-      ackBlockIt++;
       break;
     }
 
     // TODO: only process ACKs from packets which are sent from a greater than
     // or equal to crypto protection level.
-    auto eraseEnd = rPacketIt;
-    while (rPacketIt != conn.outstandings.packets.rend()) {
-      auto currentPacketNum = rPacketIt->packet.header.getPacketSequenceNum();
-      auto currentPacketNumberSpace =
-          rPacketIt->packet.header.getPacketNumberSpace();
-      if (pnSpace != currentPacketNumberSpace) {
-        // When the next packet is not in the same packet number space, we need
-        // to skip it in current ack processing. If the iterator has moved, that
-        // means we have found packets in the current space that are acked by
-        // this ack block. So the code erases the current iterator range and
-        // move the iterator to be the next search point.
-        if (rPacketIt != eraseEnd) {
-          auto nextElem = conn.outstandings.packets.erase(
-              rPacketIt.base(), eraseEnd.base());
-          rPacketIt = std::reverse_iterator<decltype(nextElem)>(nextElem) + 1;
-          eraseEnd = rPacketIt;
-        } else {
-          rPacketIt++;
-          eraseEnd = rPacketIt;
-        }
+    auto lowestPacketNum =
+        std::max(ackBlock.startPacket, packets.firstPacketNum());
+    for (auto packetNum =
+             std::min(ackBlock.endPacket, packets.endPacketNum() - 1) + 1;
+         packetNum-- > lowestPacketNum;) {
+      auto ackedPacket = packets.find(packetNum);
+      if (!ackedPacket) {
+        // Tombstone of a packet that is already acked, lost or was never
+        // retransmittable.
         continue;
       }
-      if (currentPacketNum < ackBlockIt->startPacket) {
-        break;
-      }
-      VLOG(10) << __func__ << " acked packetNum=" << currentPacketNum
-               << " space=" << currentPacketNumberSpace
-               << " handshake=" << (int)rPacketIt->isHandshake << " " << conn;
-      bool needsProcess = !rPacketIt->associatedEvent ||
-          conn.outstandings.packetEvents.count(*rPacketIt->associatedEvent);
-      if (rPacketIt->isHandshake && needsProcess) {
-        if (currentPacketNumberSpace == PacketNumberSpace::Initial) {
+      VLOG(10) << __func__ << " acked packetNum=" << packetNum
+               << " space=" << pnSpace
+               << " handshake=" << (int)ackedPacket->isHandshake << " " << conn;
+      bool needsProcess = !ackedPacket->associatedEvent ||
+          conn.outstandings.packetEvents.count(*ackedPacket->associatedEvent);
+      if (ackedPacket->isHandshake && needsProcess) {
+        if (pnSpace == PacketNumberSpace::Initial) {
           ++initialPacketAcked;
         } else {
-          CHECK_EQ(PacketNumberSpace::Handshake, currentPacketNumberSpace);
+          CHECK_EQ(PacketNumberSpace::Handshake, pnSpace);
           ++handshakePacketAcked;
         }
       }
-      ack.ackedBytes += rPacketIt->encodedSize;
-      if (rPacketIt->associatedEvent) {
+      ack.ackedBytes += ackedPacket->encodedSize;
+      if (ackedPacket->isEcnMarked) {
+        ++ack.ecnMarkedPackets;
+      }
+      if (ackedPacket->associatedEvent) {
         ++clonedPacketsAcked;
       }
       // Update RTT if current packet is the largestAcked in the frame:
       auto ackReceiveTimeOrNow =
-          ackReceiveTime > rPacketIt->time ? ackReceiveTime : Clock::now();
+          ackReceiveTime > ackedPacket->time ? ackReceiveTime : Clock::now();
       auto rttSample = std::chrono::duration_cast<std::chrono::microseconds>(
-          ackReceiveTimeOrNow - rPacketIt->time);
-      if (currentPacketNum == frame.largestAcked) {
+          ackReceiveTimeOrNow - ackedPacket->time);
+      if (packetNum == frame.largestAcked) {
         updateRtt(conn, rttSample, frame.ackDelay);
       }
       // Only invoke AckVisitor if the packet doesn't have an associated
       // PacketEvent; or the PacketEvent is in conn.outstandings.packetEvents
-      if (needsProcess /*!rPacketIt->associatedEvent ||
-          conn.outstandings.packetEvents.count(*rPacketIt->associatedEvent)*/) {
-        for (auto& packetFrame : rPacketIt->packet.frames) {
-          ackVisitor(*rPacketIt, packetFrame, frame);
+      if (needsProcess) {
+        for (auto& packetFrame : ackedPacket->packet.frames) {
+          ackVisitor(*ackedPacket, packetFrame, frame);
         }
         // Remove this PacketEvent from the outstandings.packetEvents set
-        if (rPacketIt->associatedEvent) {
-          conn.outstandings.packetEvents.erase(*rPacketIt->associatedEvent);
+        if (ackedPacket->associatedEvent) {
+          conn.outstandings.packetEvents.erase(*ackedPacket->associatedEvent);
         }
       }
-      if (!ack.largestAckedPacket ||
-          *ack.largestAckedPacket < currentPacketNum) {
-        ack.largestAckedPacket = currentPacketNum;
-        ack.largestAckedPacketSentTime = rPacketIt->time;
-        ack.largestAckedPacketAppLimited = rPacketIt->isAppLimited;
+      if (!ack.largestAckedPacket || *ack.largestAckedPacket < packetNum) {
+        ack.largestAckedPacket = packetNum;
+        ack.largestAckedPacketSentTime = ackedPacket->time;
+        ack.largestAckedPacketAppLimited = ackedPacket->isAppLimited;
       }
-      if (ackReceiveTime > rPacketIt->time) {
+      if (ackReceiveTime > ackedPacket->time) {
         ack.mrttSample =
             std::min(ack.mrttSample.value_or(rttSample), rttSample);
       }
-      conn.lossState.totalBytesAcked += rPacketIt->encodedSize;
+      conn.lossState.totalBytesAcked += ackedPacket->encodedSize;
       conn.lossState.totalBytesSentAtLastAck = conn.lossState.totalBytesSent;
       conn.lossState.totalBytesAckedAtLastAck = conn.lossState.totalBytesAcked;
       if (!lastAckedPacketSentTime) {
-        lastAckedPacketSentTime = rPacketIt->time;
+        lastAckedPacketSentTime = ackedPacket->time;
       }
       conn.lossState.lastAckedTime = ackReceiveTime;
       ack.ackedPackets.push_back(
           CongestionController::AckEvent::AckPacket::Builder()
-              .setSentTime(rPacketIt->time)
-              .setEncodedSize(rPacketIt->encodedSize)
-              .setLastAckedPacketInfo(std::move(rPacketIt->lastAckedPacketInfo))
-              .setTotalBytesSentThen(rPacketIt->totalBytesSent)
-              .setAppLimited(rPacketIt->isAppLimited)
+              .setSentTime(ackedPacket->time)
+              .setEncodedSize(ackedPacket->encodedSize)
+              .setLastAckedPacketInfo(
+                  std::move(ackedPacket->lastAckedPacketInfo))
+              .setTotalBytesSentThen(ackedPacket->totalBytesSent)
+              .setAppLimited(ackedPacket->isAppLimited)
               .build());
-      rPacketIt++;
+      packets.erase(packetNum);
     }
-    // Done searching for acked outstanding packets in current ack block. Erase
-    // the current iterator range which is the last batch of continuous
-    // outstanding packets that are in this ack block. Move the iterator to be
-    // the next search point.
-    if (rPacketIt != eraseEnd) {
-      auto nextElem =
-          conn.outstandings.packets.erase(rPacketIt.base(), eraseEnd.base());
-      currentPacketIt = std::reverse_iterator<decltype(nextElem)>(nextElem);
-    } else {
-      currentPacketIt = rPacketIt;
-    }
-    ackBlockIt++;
   }
   if (lastAckedPacketSentTime) {
     conn.lossState.lastAckedPacketSentTime = *lastAckedPacketSentTime;
@@ -197,6 +164,12 @@ void processAckFrame(
       conn.outstandings.handshakePacketsCount +
           conn.outstandings.initialPacketsCount);
   CHECK_GE(updatedOustandingPacketsCount, conn.outstandings.clonedPacketsCount);
+  // The ECN counts of an ack that does not increase the largest acked can be
+  // stale.
+  if (!prevLargestAcked || frame.largestAcked > *prevLargestAcked) {
+    ack.ecnCeCount =
+        processAckEcnCounts(conn, ackState, frame, ack.ecnMarkedPackets);
+  }
   auto lossEvent = handleAckForLoss(conn, lossVisitor, ack, pnSpace);
   if (conn.congestionController &&
       (ack.largestAckedPacket.has_value() || lossEvent)) {
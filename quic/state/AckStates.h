@@ -8,6 +8,7 @@
 
 #pragma once
 
+#include <quic/codec/EncodedAckBlocks.h>
 #include <quic/codec/Types.h>
 #include <quic/common/IntervalSet.h>
 
@@ -16,6 +17,8 @@ namespace quic {
 // Ack and PacketNumber states. This is per-packet number space.
 struct AckState {
   AckBlocks acks;
+  // The acks encoded for an ACK frame, reused until they change.
+  mutable EncodedAckBlocks encodedAcks;
   // Largest ack that has been written to a packet
   folly::Optional<PacketNum> largestAckScheduled;
   // Flag indicating that if we need to send ack immediately. This will be set
@@ -27,7 +30,7 @@ struct AckState {
   // Count of outstanding packets received with only non-retransmittable data.
   uint64_t numNonRxPacketsRecvd{0};
   // Count of oustanding packets received with retransmittable data.
-  uint8_t numRxPacketsRecvd{0};
+  uint64_t numRxPacketsRecvd{0};
   // The receive time of the largest ack packet
   folly::Optional<TimePoint> largestRecvdPacketTime;
   // Latest packet number acked by peer
@@ -38,6 +41,10 @@ struct AckState {
   folly::Optional<PacketNum> largestReceivedAtLastCloseSent;
   // Next PacketNum we will send for packet in this packet number space
   PacketNum nextPacketNum{0};
+  // ECN codepoints of the packets received in this space, echoed in ACK_ECN.
+  EcnCounts ecnCounts;
+  // Largest ECN counts the peer has echoed for this space.
+  EcnCounts peerEcnCounts;
 };
 
 struct AckStates {
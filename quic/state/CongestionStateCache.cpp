@@ -0,0 +1,80 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ *
+ */
+
+#include <quic/state/CongestionStateCache.h>
+
+#include <quic/state/StateData.h>
+
+namespace quic {
+
+CongestionStateCache::CongestionStateCache(
+    size_t maxEntries,
+    std::chrono::seconds maxAge)
+    : entries_(maxEntries), maxAge_(maxAge) {}
+
+folly::Optional<CachedCongestionState> CongestionStateCache::get(
+    const folly::IPAddress& peer,
+    TimePoint now) {
+  auto prefix = prefixOf(peer);
+  auto itr = entries_.find(prefix);
+  if (itr == entries_.end()) {
+    return folly::none;
+  }
+  if (now - itr->second.recordTime > maxAge_) {
+    entries_.erase(prefix);
+    return folly::none;
+  }
+  return itr->second;
+}
+
+void CongestionStateCache::put(
+    const folly::IPAddress& peer,
+    const CachedCongestionState& state) {
+  entries_.set(prefixOf(peer), state);
+}
+
+folly::IPAddress CongestionStateCache::prefixOf(const folly::IPAddress& peer) {
+  if (peer.isIPv4Mapped()) {
+    return folly::IPAddress(folly::IPAddress::createIPv4(peer))
+        .mask(kCongestionStateCacheV4PrefixLen);
+  }
+  return peer.mask(
+      peer.isV4() ? kCongestionStateCacheV4PrefixLen
+                  : kCongestionStateCacheV6PrefixLen);
+}
+
+folly::Optional<CachedCongestionState> getCachedCongestionState(
+    const QuicConnectionStateBase& conn) {
+  if (conn.lossState.srtt == 0us || !conn.congestionController) {
+    return folly::none;
+  }
+  CachedCongestionState state;
+  state.srtt = conn.lossState.srtt;
+  state.minRtt = conn.lossState.mrtt;
+  state.bandwidth = conn.congestionController->getBandwidthEstimate();
+  state.cwndBytes = conn.congestionController->getCongestionWindow();
+  state.recordTime = Clock::now();
+  return state;
+}
+
+bool applyCachedCongestionState(
+    QuicConnectionStateBase& conn,
+    const CachedCongestionState& state) {
+  if (Clock::now() - state.recordTime >
+      conn.transportSettings.congestionStateCacheConfig.maxAge) {
+    return false;
+  }
+  // Only the PTO before the first sample uses it, the sample replaces it.
+  conn.transportSettings.initialRtt = state.srtt;
+  if (conn.congestionController) {
+    conn.congestionController->onCachedCongestionState(state);
+  }
+  return true;
+}
+
+} // namespace quic
@@ -0,0 +1,87 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ *
+ */
+
+#pragma once
+
+#include <folly/IPAddress.h>
+#include <folly/Optional.h>
+#include <folly/container/EvictingCacheMap.h>
+#include <quic/QuicConstants.h>
+
+#include <chrono>
+#include <cstdint>
+
+namespace quic {
+
+struct QuicConnectionStateBase;
+
+/**
+ * What a connection measured of the path to its peer, for the next connection
+ * to the same peer to start from.
+ */
+struct CachedCongestionState {
+  std::chrono::microseconds srtt{0us};
+  // Zero when the connection had no RTT sample.
+  std::chrono::microseconds minRtt{0us};
+  // Bytes per second, zero when the congestion controller had no estimate.
+  uint64_t bandwidth{0};
+  uint64_t cwndBytes{0};
+  // When the connection ended. It is a steady clock time, so a cache that
+  // outlives the process has to drop it.
+  TimePoint recordTime;
+};
+
+/**
+ * LRU cache of the congestion states of the closed connections of a server
+ * worker. Peers in the same IPv4 /24 or IPv6 /56 share an entry, as they most
+ * likely share the path.
+ *
+ * Not thread safe, it is only used from the thread of the worker.
+ */
+class CongestionStateCache {
+ public:
+  CongestionStateCache(size_t maxEntries, std::chrono::seconds maxAge);
+
+  /**
+   * The state last cached for the prefix of peer, unless it is older than the
+   * max age.
+   */
+  folly::Optional<CachedCongestionState> get(
+      const folly::IPAddress& peer,
+      TimePoint now);
+
+  void put(const folly::IPAddress& peer, const CachedCongestionState& state);
+
+  size_t size() const {
+    return entries_.size();
+  }
+
+ private:
+  static folly::IPAddress prefixOf(const folly::IPAddress& peer);
+
+  folly::EvictingCacheMap<folly::IPAddress, CachedCongestionState> entries_;
+  std::chrono::seconds maxAge_;
+};
+
+/**
+ * The state the connection measured, or none before its first RTT sample.
+ */
+folly::Optional<CachedCongestionState> getCachedCongestionState(
+    const QuicConnectionStateBase& conn);
+
+/**
+ * Starts a new connection from a cached state: its PTO from the cached
+ * smoothed RTT until the first RTT sample, and its congestion controller from
+ * the cached window and bandwidth. Does nothing if the state is older than the
+ * configured max age. Returns whether the state was used.
+ */
+bool applyCachedCongestionState(
+    QuicConnectionStateBase& conn,
+    const CachedCongestionState& state);
+
+} // namespace quic
@@ -0,0 +1,82 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ *
+ */
+
+#pragma once
+
+#include <quic/QuicConstants.h>
+#include <quic/codec/Types.h>
+#include <quic/state/PacketEvent.h>
+
+#include <folly/Optional.h>
+
+namespace quic {
+
+// Data structure to represent outstanding retransmittable packets
+struct OutstandingPacket {
+  // Structure representing the frames that are outstanding including the header
+  // that was sent.
+  RegularQuicWritePacket packet;
+  // Time that the packet was sent.
+  TimePoint time;
+  // Size of the packet sent on the wire.
+  uint32_t encodedSize;
+  // Whether this packet has any data from stream 0
+  bool isHandshake;
+  // Total sent bytes on this connection including this packet itself when this
+  // packet is sent.
+  uint64_t totalBytesSent;
+  // Information regarding the last acked packet on this connection when this
+  // packet is sent.
+  struct LastAckedPacketInfo {
+    TimePoint sentTime;
+    TimePoint ackTime;
+    // Total sent bytes on this connection when the last acked packet is acked.
+    uint64_t totalBytesSent;
+    // Total acked bytes on this connection when last acked packet is acked,
+    // including the last acked packet.
+    uint64_t totalBytesAcked;
+
+    LastAckedPacketInfo(
+        TimePoint sentTimeIn,
+        TimePoint ackTimeIn,
+        uint64_t totalBytesSentIn,
+        uint64_t totalBytesAckedIn)
+        : sentTime(sentTimeIn),
+          ackTime(ackTimeIn),
+          totalBytesSent(totalBytesSentIn),
+          totalBytesAcked(totalBytesAckedIn) {}
+  };
+  folly::Optional<LastAckedPacketInfo> lastAckedPacketInfo;
+
+  // PacketEvent associated with this OutstandingPacket. This will be a
+  // folly::none if the packet isn't a clone and hasn't been cloned.
+  folly::Optional<PacketEvent> associatedEvent;
+
+  /**
+   * Whether the packet is sent when congestion controller is in app-limited
+   * state.
+   */
+  bool isAppLimited{false};
+
+  // Whether the packet was sent with an ECT codepoint.
+  bool isEcnMarked{false};
+
+  OutstandingPacket(
+      RegularQuicWritePacket packetIn,
+      TimePoint timeIn,
+      uint32_t encodedSizeIn,
+      bool isHandshakeIn,
+      uint64_t totalBytesSentIn)
+      : packet(std::move(packetIn)),
+        time(std::move(timeIn)),
+        encodedSize(encodedSizeIn),
+        isHandshake(isHandshakeIn),
+        totalBytesSent(totalBytesSentIn) {}
+};
+
+} // namespace quic
@@ -0,0 +1,172 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ *
+ */
+
+#include <quic/state/OutstandingPacketStore.h>
+
+#include <folly/Bits.h>
+
+namespace quic {
+
+constexpr size_t OutstandingPacketBuffer::kMinSlots;
+constexpr size_t OutstandingPacketStore::kNumSpaces;
+
+OutstandingPacket& OutstandingPacketBuffer::insert(OutstandingPacket&& packet) {
+  auto packetNum = packet.packet.header.getPacketSequenceNum();
+  if (numPackets_ == 0) {
+    // Start a fresh window rather than covering the gap since the last packet.
+    DCHECK_EQ(numSlots_, 0);
+    head_ = 0;
+    firstPacketNum_ = packetNum;
+  }
+  if (packetNum < firstPacketNum_) {
+    // Only a test or a retransmission with an old packet number lands here.
+    size_t extraSlots = firstPacketNum_ - packetNum;
+    reserve(numSlots_ + extraSlots);
+    head_ = (head_ - extraSlots) & (slots_.size() - 1);
+    numSlots_ += extraSlots;
+    firstPacketNum_ = packetNum;
+  } else if (packetNum >= endPacketNum()) {
+    size_t numSlots = packetNum - firstPacketNum_ + 1;
+    reserve(numSlots);
+    numSlots_ = numSlots;
+  }
+  auto& slot = slotAt(packetNum - firstPacketNum_);
+  DCHECK(!slot) << "Duplicate outstanding packet num=" << packetNum;
+  if (!slot) {
+    ++numPackets_;
+  }
+  slot = std::move(packet);
+  return *slot;
+}
+
+void OutstandingPacketBuffer::erase(PacketNum packetNum) {
+  auto slot = slotFor(packetNum);
+  if (!slot) {
+    return;
+  }
+  slot->reset();
+  --numPackets_;
+  // Lazily compact by trimming the tombstones at both ends of the window.
+  // Tombstones in the middle stay until the window moves past them.
+  while (numSlots_ > 0 && !slotAt(0)) {
+    head_ = (head_ + 1) & (slots_.size() - 1);
+    ++firstPacketNum_;
+    --numSlots_;
+  }
+  while (numSlots_ > 0 && !slotAt(numSlots_ - 1)) {
+    --numSlots_;
+  }
+}
+
+void OutstandingPacketBuffer::clear() {
+  for (size_t i = 0; i < numSlots_; ++i) {
+    slotAt(i).reset();
+  }
+  head_ = 0;
+  numSlots_ = 0;
+  numPackets_ = 0;
+}
+
+void OutstandingPacketBuffer::reserve(size_t numSlots) {
+  if (numSlots <= slots_.size()) {
+    return;
+  }
+  std::vector<Slot> slots(
+      folly::nextPowTwo(std::max<size_t>(numSlots, kMinSlots)));
+  for (size_t i = 0; i < numSlots_; ++i) {
+    auto& slot = slotAt(i);
+    if (slot) {
+      slots[i] = std::move(slot);
+    }
+  }
+  slots_ = std::move(slots);
+  head_ = 0;
+}
+
+OutstandingPacketStore::iterator OutstandingPacketStore::find(
+    PacketNumberSpace pnSpace,
+    PacketNum packetNum) {
+  auto space = static_cast<size_t>(pnSpace);
+  if (!spaces_[space].find(packetNum)) {
+    return end();
+  }
+  std::array<PacketNum, kNumSpaces> positions;
+  for (size_t i = 0; i < kNumSpaces; ++i) {
+    // A packet with the same number in a lower space comes first.
+    positions[i] = i < space ? packetNum + 1 : packetNum;
+  }
+  return iterator(this, positions);
+}
+
+OutstandingPacketStore::iterator OutstandingPacketStore::nextIn(
+    PacketNumberSpace pnSpace,
+    const_iterator pos) {
+  DCHECK(pos.store_ == this);
+  // The packets of the space at or after pos are the ones starting from its
+  // position in that space.
+  auto& packets = packetsIn(pnSpace);
+  auto packetNum =
+      packets.nextPacketNum(pos.positions_[static_cast<size_t>(pnSpace)]);
+  if (packetNum == packets.endPacketNum()) {
+    return end();
+  }
+  return find(pnSpace, packetNum);
+}
+
+OutstandingPacketStore::iterator OutstandingPacketStore::insert(
+    OutstandingPacket&& packet) {
+  auto pnSpace = packet.packet.header.getPacketNumberSpace();
+  auto packetNum = packet.packet.header.getPacketSequenceNum();
+  insertPacket(std::move(packet));
+  return find(pnSpace, packetNum);
+}
+
+OutstandingPacket& OutstandingPacketStore::insertPacket(
+    OutstandingPacket&& packet) {
+  return packetsIn(packet.packet.header.getPacketNumberSpace())
+      .insert(std::move(packet));
+}
+
+OutstandingPacketStore::iterator OutstandingPacketStore::erase(
+    const_iterator pos) {
+  DCHECK(pos.store_ == this);
+  DCHECK_LT(pos.current_, kNumSpaces);
+  auto positions = pos.positions_;
+  spaces_[pos.current_].erase(positions[pos.current_]);
+  positions[pos.current_]++;
+  return iterator(this, positions);
+}
+
+OutstandingPacketStore::iterator OutstandingPacketStore::erase(
+    const_iterator first,
+    const_iterator last) {
+  while (first != last) {
+    first = erase(first);
+  }
+  return iterator(this, last.positions_);
+}
+
+std::array<PacketNum, OutstandingPacketStore::kNumSpaces>
+OutstandingPacketStore::beginPositions() const {
+  std::array<PacketNum, kNumSpaces> positions;
+  for (size_t i = 0; i < kNumSpaces; ++i) {
+    positions[i] = spaces_[i].firstPacketNum();
+  }
+  return positions;
+}
+
+std::array<PacketNum, OutstandingPacketStore::kNumSpaces>
+OutstandingPacketStore::endPositions() const {
+  std::array<PacketNum, kNumSpaces> positions;
+  for (size_t i = 0; i < kNumSpaces; ++i) {
+    positions[i] = spaces_[i].endPacketNum();
+  }
+  return positions;
+}
+
+} // namespace quic
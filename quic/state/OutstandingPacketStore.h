@@ -0,0 +1,478 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ *
+ */
+
+#pragma once
+
+#include <quic/state/OutstandingPacket.h>
+
+#include <folly/Optional.h>
+#include <glog/logging.h>
+
+#include <array>
+#include <iterator>
+#include <type_traits>
+#include <vector>
+
+namespace quic {
+
+/**
+ * The outstanding packets of a single packet number space, indexed by packet
+ * number.
+ *
+ * Packets live in a ring buffer of slots which covers the packet numbers
+ * [firstPacketNum(), endPacketNum()). Looking up, inserting and erasing a
+ * packet is O(1). The slot of a packet that was acked or lost, or of a packet
+ * number that was never outstanding (e.g. a pure ack), is an empty tombstone.
+ * Tombstones at either end of the window are trimmed as soon as they appear, so
+ * the first and last slots always hold a packet. The buffer only grows when
+ * the window doesn't fit, which re-linearizes it.
+ */
+class OutstandingPacketBuffer {
+ public:
+  size_t size() const {
+    return numPackets_;
+  }
+
+  bool empty() const {
+    return numPackets_ == 0;
+  }
+
+  // Heap bytes of the ring, not counting what the packets themselves own.
+  size_t getAllocatedMemorySize() const {
+    return slots_.capacity() * sizeof(Slot);
+  }
+
+  // Smallest outstanding packet number. Only meaningful if not empty.
+  PacketNum firstPacketNum() const {
+    return firstPacketNum_;
+  }
+
+  // One past the largest outstanding packet number.
+  PacketNum endPacketNum() const {
+    return firstPacketNum_ + numSlots_;
+  }
+
+  OutstandingPacket* find(PacketNum packetNum) {
+    auto slot = slotFor(packetNum);
+    return slot ? slot->get_pointer() : nullptr;
+  }
+
+  const OutstandingPacket* find(PacketNum packetNum) const {
+    auto slot = slotFor(packetNum);
+    return slot ? slot->get_pointer() : nullptr;
+  }
+
+  /*
+   * The first outstanding packet number that is not smaller than packetNum, or
+   * endPacketNum() if there is none.
+   */
+  PacketNum nextPacketNum(PacketNum packetNum) const {
+    packetNum = std::max(packetNum, firstPacketNum_);
+    while (packetNum < endPacketNum() && !slotAt(packetNum - firstPacketNum_)) {
+      ++packetNum;
+    }
+    return std::min(packetNum, endPacketNum());
+  }
+
+  /*
+   * The last outstanding packet number that is smaller than packetNum.
+   */
+  folly::Optional<PacketNum> prevPacketNum(PacketNum packetNum) const {
+    packetNum = std::min(packetNum, endPacketNum());
+    while (packetNum > firstPacketNum_) {
+      --packetNum;
+      if (slotAt(packetNum - firstPacketNum_)) {
+        return packetNum;
+      }
+    }
+    return folly::none;
+  }
+
+  /*
+   * Store a packet in the slot of its packet number. Packet numbers are unique
+   * within a space, so the slot must be empty.
+   */
+  OutstandingPacket& insert(OutstandingPacket&& packet);
+
+  /*
+   * Erase the packet with the given packet number if it is outstanding.
+   */
+  void erase(PacketNum packetNum);
+
+  void clear();
+
+ private:
+  using Slot = folly::Optional<OutstandingPacket>;
+
+  static constexpr size_t kMinSlots = 16;
+
+  Slot& slotAt(size_t index) {
+    return slots_[(head_ + index) & (slots_.size() - 1)];
+  }
+
+  const Slot& slotAt(size_t index) const {
+    return slots_[(head_ + index) & (slots_.size() - 1)];
+  }
+
+  const Slot* slotFor(PacketNum packetNum) const {
+    if (packetNum < firstPacketNum_ || packetNum >= endPacketNum()) {
+      return nullptr;
+    }
+    auto& slot = slotAt(packetNum - firstPacketNum_);
+    return slot ? &slot : nullptr;
+  }
+
+  Slot* slotFor(PacketNum packetNum) {
+    return const_cast<Slot*>(
+        static_cast<const OutstandingPacketBuffer*>(this)->slotFor(packetNum));
+  }
+
+  // Make sure the ring can hold numSlots slots.
+  void reserve(size_t numSlots);
+
+  // Capacity is always 0 or a power of 2 so that indexes can be masked.
+  std::vector<Slot> slots_;
+  size_t head_{0};
+  size_t numSlots_{0};
+  size_t numPackets_{0};
+  PacketNum firstPacketNum_{0};
+};
+
+/**
+ * Container of all the outstanding packets of a connection.
+ *
+ * Each packet number space has its own OutstandingPacketBuffer. Code that
+ * works on a single space, which is the case for ack processing and loss
+ * detection, should use packetsIn() to get O(1) lookup by packet number.
+ *
+ * Iterating the store itself visits the packets of all spaces merged in
+ * ascending packet number order, with the packets of the lower space first for
+ * equal packet numbers. Iterators stay valid when other packets are erased,
+ * but not across an insert.
+ */
+class OutstandingPacketStore {
+  static constexpr size_t kNumSpaces = size_t(PacketNumberSpace::MAX) + 1;
+
+  template <bool Const>
+  class IteratorImpl {
+    using Store = typename std::conditional<
+        Const,
+        const OutstandingPacketStore,
+        OutstandingPacketStore>::type;
+
+   public:
+    using iterator_category = std::bidirectional_iterator_tag;
+    using value_type = OutstandingPacket;
+    using difference_type = std::ptrdiff_t;
+    using pointer = typename std::
+        conditional<Const, const OutstandingPacket*, OutstandingPacket*>::type;
+    using reference = typename std::
+        conditional<Const, const OutstandingPacket&, OutstandingPacket&>::type;
+
+    IteratorImpl() = default;
+
+    // iterator converts to const_iterator.
+    template <
+        bool OtherConst,
+        typename = std::enable_if_t<Const || !OtherConst>>
+    /* implicit */ IteratorImpl(const IteratorImpl<OtherConst>& other)
+        : store_(other.store_),
+          positions_(other.positions_),
+          current_(other.current_) {}
+
+    reference operator*() const {
+      return *operator->();
+    }
+
+    pointer operator->() const {
+      DCHECK_LT(current_, kNumSpaces);
+      auto packet = store_->spaces_[current_].find(positions_[current_]);
+      DCHECK(packet);
+      return packet;
+    }
+
+    IteratorImpl& operator++() {
+      DCHECK_LT(current_, kNumSpaces);
+      ++positions_[current_];
+      settle();
+      return *this;
+    }
+
+    IteratorImpl operator++(int) {
+      auto ret = *this;
+      ++*this;
+      return ret;
+    }
+
+    /*
+     * Moves back to the largest outstanding packet which is before the current
+     * position in any of the spaces.
+     */
+    IteratorImpl& operator--() {
+      folly::Optional<PacketNum> prevPacketNum;
+      size_t prevSpace = kNumSpaces;
+      for (size_t space = 0; space < kNumSpaces; ++space) {
+        auto prev = store_->spaces_[space].prevPacketNum(positions_[space]);
+        // On equal packet numbers the higher space is the later one.
+        if (prev && (!prevPacketNum || *prev >= *prevPacketNum)) {
+          prevPacketNum = prev;
+          prevSpace = space;
+        }
+      }
+      DCHECK_LT(prevSpace, kNumSpaces) << "Decrementing begin()";
+      positions_[prevSpace] = *prevPacketNum;
+      current_ = prevSpace;
+      return *this;
+    }
+
+    IteratorImpl operator--(int) {
+      auto ret = *this;
+      --*this;
+      return ret;
+    }
+
+    IteratorImpl operator+(size_t n) const {
+      auto ret = *this;
+      while (n--) {
+        ++ret;
+      }
+      return ret;
+    }
+
+    IteratorImpl operator-(size_t n) const {
+      auto ret = *this;
+      while (n--) {
+        --ret;
+      }
+      return ret;
+    }
+
+    bool operator==(const IteratorImpl& other) const {
+      if (store_ != other.store_) {
+        return false;
+      }
+      if (!store_) {
+        return true;
+      }
+      for (size_t space = 0; space < kNumSpaces; ++space) {
+        auto& packets = store_->spaces_[space];
+        if (packets.nextPacketNum(positions_[space]) !=
+            packets.nextPacketNum(other.positions_[space])) {
+          return false;
+        }
+      }
+      return true;
+    }
+
+    bool operator!=(const IteratorImpl& other) const {
+      return !operator==(other);
+    }
+
+   private:
+    friend class OutstandingPacketStore;
+    template <bool>
+    friend class IteratorImpl;
+
+    IteratorImpl(Store* store, std::array<PacketNum, kNumSpaces> positions)
+        : store_(store), positions_(positions) {
+      settle();
+    }
+
+    // Skip tombstones in every space and point at the smallest packet.
+    void settle() {
+      current_ = kNumSpaces;
+      for (size_t space = 0; space < kNumSpaces; ++space) {
+        auto& packets = store_->spaces_[space];
+        positions_[space] = packets.nextPacketNum(positions_[space]);
+        if (positions_[space] != packets.endPacketNum() &&
+            (current_ == kNumSpaces ||
+             positions_[space] < positions_[current_])) {
+          current_ = space;
+        }
+      }
+    }
+
+    Store* store_{nullptr};
+    // Position of the iterator in each space. The packets before the position
+    // in every space are the ones before the iterator in the merged order.
+    std::array<PacketNum, kNumSpaces> positions_{};
+    // The space of the packet the iterator points to, kNumSpaces for end().
+    size_t current_{kNumSpaces};
+  };
+
+ public:
+  using value_type = OutstandingPacket;
+  using reference = OutstandingPacket&;
+  using const_reference = const OutstandingPacket&;
+  using size_type = size_t;
+  using iterator = IteratorImpl<false>;
+  using const_iterator = IteratorImpl<true>;
+  using reverse_iterator = std::reverse_iterator<iterator>;
+  using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+
+  OutstandingPacketBuffer& packetsIn(PacketNumberSpace pnSpace) {
+    return spaces_[static_cast<size_t>(pnSpace)];
+  }
+
+  const OutstandingPacketBuffer& packetsIn(PacketNumberSpace pnSpace) const {
+    return spaces_[static_cast<size_t>(pnSpace)];
+  }
+
+  size_t size() const {
+    size_t total = 0;
+    for (const auto& packets : spaces_) {
+      total += packets.size();
+    }
+    return total;
+  }
+
+  size_t getAllocatedMemorySize() const {
+    size_t total = 0;
+    for (const auto& packets : spaces_) {
+      total += packets.getAllocatedMemorySize();
+    }
+    return total;
+  }
+
+  bool empty() const {
+    for (const auto& packets : spaces_) {
+      if (!packets.empty()) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  void clear() {
+    for (auto& packets : spaces_) {
+      packets.clear();
+    }
+  }
+
+  iterator begin() {
+    return iterator(this, beginPositions());
+  }
+
+  const_iterator begin() const {
+    return const_iterator(this, beginPositions());
+  }
+
+  const_iterator cbegin() const {
+    return begin();
+  }
+
+  iterator end() {
+    return iterator(this, endPositions());
+  }
+
+  const_iterator end() const {
+    return const_iterator(this, endPositions());
+  }
+
+  const_iterator cend() const {
+    return end();
+  }
+
+  reverse_iterator rbegin() {
+    return reverse_iterator(end());
+  }
+
+  const_reverse_iterator rbegin() const {
+    return const_reverse_iterator(end());
+  }
+
+  reverse_iterator rend() {
+    return reverse_iterator(begin());
+  }
+
+  const_reverse_iterator rend() const {
+    return const_reverse_iterator(begin());
+  }
+
+  OutstandingPacket& front() {
+    return *begin();
+  }
+
+  const OutstandingPacket& front() const {
+    return *begin();
+  }
+
+  OutstandingPacket& back() {
+    return *rbegin();
+  }
+
+  const OutstandingPacket& back() const {
+    return *rbegin();
+  }
+
+  /*
+   * Iterator to the packet with the given packet number in the given space, or
+   * end() if it isn't outstanding.
+   */
+  iterator find(PacketNumberSpace pnSpace, PacketNum packetNum);
+
+  /*
+   * Iterator to the first packet of the given space which is at or after pos,
+   * or end() if there is none.
+   */
+  iterator nextIn(PacketNumberSpace pnSpace, const_iterator pos);
+
+  /*
+   * Add a packet. The packet is placed by its packet number space and packet
+   * number, so there is no position to give unlike for a sequence container.
+   */
+  iterator insert(OutstandingPacket&& packet);
+
+  template <typename... Args>
+  OutstandingPacket& emplace_back(Args&&... args) {
+    return insertPacket(OutstandingPacket(std::forward<Args>(args)...));
+  }
+
+  void push_back(const OutstandingPacket& packet) {
+    insertPacket(OutstandingPacket(packet));
+  }
+
+  void push_back(OutstandingPacket&& packet) {
+    insertPacket(std::move(packet));
+  }
+
+  iterator erase(const_iterator pos);
+
+  iterator erase(const_iterator first, const_iterator last);
+
+  void pop_front() {
+    erase(begin());
+  }
+
+  void pop_back() {
+    erase(std::prev(end()));
+  }
+
+  /*
+   * Positional access in the merged order. This is O(n) and is only meant for
+   * tests.
+   */
+  OutstandingPacket& operator[](size_t index) {
+    return *(begin() + index);
+  }
+
+  const OutstandingPacket& operator[](size_t index) const {
+    return *(begin() + index);
+  }
+
+ private:
+  OutstandingPacket& insertPacket(OutstandingPacket&& packet);
+
+  std::array<PacketNum, kNumSpaces> beginPositions() const;
+
+  std::array<PacketNum, kNumSpaces> endPositions() const;
+
+  std::array<OutstandingPacketBuffer, kNumSpaces> spaces_;
+};
+
+} // namespace quic
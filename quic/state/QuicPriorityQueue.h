@@ -0,0 +1,263 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ *
+ */
+
+#pragma once
+
+#include <folly/container/F14Map.h>
+#include <quic/codec/Types.h>
+
+#include <array>
+#include <limits>
+
+namespace quic {
+
+using PriorityLevel = uint8_t;
+
+// Number of urgency levels. Level 0 is the most urgent.
+constexpr PriorityLevel kDefaultPriorityLevels = 8;
+constexpr PriorityLevel kDefaultMaxPriority = kDefaultPriorityLevels - 1;
+
+struct Priority {
+  PriorityLevel level : 3;
+  bool incremental : 1;
+
+  Priority(PriorityLevel levelIn, bool incrementalIn)
+      : level(levelIn), incremental(incrementalIn) {}
+
+  bool operator==(Priority other) const noexcept {
+    return level == other.level && incremental == other.incremental;
+  }
+
+  bool operator!=(Priority other) const noexcept {
+    return !operator==(other);
+  }
+};
+
+namespace detail {
+// Marks the absence of a stream in the links of PriorityQueue.
+constexpr StreamId kNoStream = std::numeric_limits<StreamId>::max();
+} // namespace detail
+
+// The default urgency is 3. Streams are incremental by default so that streams
+// which never had their priority set keep sharing the connection round robin.
+const Priority kDefaultPriority(3, true);
+
+/**
+ * Scheduling queue for writable streams.
+ *
+ * Streams are placed in one bucket per (urgency level, incremental) pair and
+ * buckets are drained from the most urgent level first. Within a level the
+ * non-incremental streams are served before the incremental ones. Incremental
+ * streams share their bucket round robin, non-incremental streams are served
+ * sequentially in stream id order.
+ *
+ * Every bucket is a doubly linked list threaded through a single F14 map keyed
+ * by stream id, so erase and rotation are O(1) and don't need a node
+ * allocation per stream the way a std::set does. Inserting is O(1) unless a
+ * non-incremental stream has a lower id than the last one of its bucket, in
+ * which case it walks back from the tail to its place.
+ */
+class PriorityQueue {
+ public:
+  PriorityQueue() {
+    heads_.fill(detail::kNoStream);
+    tails_.fill(detail::kNoStream);
+  }
+
+  bool empty() const {
+    return nodes_.empty();
+  }
+
+  size_t size() const {
+    return nodes_.size();
+  }
+
+  size_t count(StreamId id) const {
+    return nodes_.count(id);
+  }
+
+  void clear() {
+    nodes_.clear();
+    heads_.fill(detail::kNoStream);
+    tails_.fill(detail::kNoStream);
+  }
+
+  /*
+   * Insert a stream into the queue with the given priority. If the stream is
+   * already queued with a different priority it is moved to the new bucket.
+   */
+  void insertOrUpdate(StreamId id, Priority priority) {
+    auto bucket = bucketIndex(priority);
+    auto it = nodes_.find(id);
+    if (it != nodes_.end()) {
+      if (it->second.bucket == bucket) {
+        return;
+      }
+      unlink(id, it->second);
+      nodes_.erase(it);
+    }
+    link(id, bucket);
+  }
+
+  /*
+   * Move the stream to the bucket for the given priority, if it is queued.
+   */
+  void updateIfExist(StreamId id, Priority priority) {
+    if (nodes_.count(id)) {
+      insertOrUpdate(id, priority);
+    }
+  }
+
+  void erase(StreamId id) {
+    auto it = nodes_.find(id);
+    if (it == nodes_.end()) {
+      return;
+    }
+    unlink(id, it->second);
+    nodes_.erase(it);
+  }
+
+  /*
+   * Returns the stream that the next call to schedule() would visit first.
+   */
+  folly::Optional<StreamId> getNextScheduledStream() const {
+    for (auto head : heads_) {
+      if (head != detail::kNoStream) {
+        return head;
+      }
+    }
+    return folly::none;
+  }
+
+  /*
+   * Visit the queued streams in scheduling order, visiting each stream at most
+   * once. The visitor returns true if the stream was served, in which case the
+   * next stream is visited, or false to stop scheduling. An incremental stream
+   * which was served is moved to the back of its bucket so that the following
+   * call starts with the stream after it. The visitor must not modify the
+   * queue.
+   */
+  template <typename Visitor>
+  void schedule(Visitor&& visitor) {
+    for (size_t bucket = 0; bucket < kNumBuckets; ++bucket) {
+      if (heads_[bucket] == detail::kNoStream) {
+        continue;
+      }
+      if (isIncrementalBucket(bucket)) {
+        // Rotating the head to the tail walks the whole bucket once we have
+        // rotated as many times as there are streams in it.
+        auto id = heads_[bucket];
+        auto stop = detail::kNoStream;
+        while (id != stop) {
+          if (!visitor(id)) {
+            return;
+          }
+          if (stop == detail::kNoStream) {
+            stop = id;
+          }
+          rotate(bucket);
+          id = heads_[bucket];
+        }
+      } else {
+        for (auto id = heads_[bucket]; id != detail::kNoStream;
+             id = nodes_.at(id).next) {
+          if (!visitor(id)) {
+            return;
+          }
+        }
+      }
+    }
+  }
+
+ private:
+  static constexpr size_t kNumBuckets = kDefaultPriorityLevels * 2;
+
+  struct Node {
+    StreamId prev{detail::kNoStream};
+    StreamId next{detail::kNoStream};
+    uint8_t bucket{0};
+  };
+
+  static uint8_t bucketIndex(Priority priority) {
+    return priority.level * 2 + (priority.incremental ? 1 : 0);
+  }
+
+  static bool isIncrementalBucket(size_t bucket) {
+    return bucket % 2 == 1;
+  }
+
+  void link(StreamId id, uint8_t bucket) {
+    Node node;
+    node.bucket = bucket;
+    auto& tail = tails_[bucket];
+    // New incremental streams go to the back of the round robin. Streams
+    // usually become writable in id order, so most non-incremental streams
+    // belong at the back of their bucket too.
+    if (isIncrementalBucket(bucket) || tail == detail::kNoStream || tail < id) {
+      node.prev = tail;
+      if (tail == detail::kNoStream) {
+        heads_[bucket] = id;
+      } else {
+        nodes_.at(tail).next = id;
+      }
+      tail = id;
+      nodes_.emplace(id, node);
+      return;
+    }
+    // Keep non-incremental buckets sorted by stream id, so that a stream which
+    // becomes writable again is still served before the streams after it.
+    node.next = tail;
+    node.prev = nodes_.at(tail).prev;
+    while (node.prev != detail::kNoStream && node.prev > id) {
+      node.next = node.prev;
+      node.prev = nodes_.at(node.prev).prev;
+    }
+    if (node.prev == detail::kNoStream) {
+      heads_[bucket] = id;
+    } else {
+      nodes_.at(node.prev).next = id;
+    }
+    nodes_.at(node.next).prev = id;
+    nodes_.emplace(id, node);
+  }
+
+  void unlink(StreamId id, const Node& node) {
+    if (node.prev == detail::kNoStream) {
+      heads_[node.bucket] = node.next;
+    } else {
+      nodes_.at(node.prev).next = node.next;
+    }
+    if (node.next == detail::kNoStream) {
+      tails_[node.bucket] = node.prev;
+    } else {
+      nodes_.at(node.next).prev = node.prev;
+    }
+    DCHECK(heads_[node.bucket] != id && tails_[node.bucket] != id);
+  }
+
+  // Move the head of the bucket to its tail.
+  void rotate(size_t bucket) {
+    auto id = heads_[bucket];
+    if (id == tails_[bucket]) {
+      return;
+    }
+    auto& node = nodes_.at(id);
+    heads_[bucket] = node.next;
+    nodes_.at(node.next).prev = detail::kNoStream;
+    nodes_.at(tails_[bucket]).next = id;
+    node.prev = tails_[bucket];
+    node.next = detail::kNoStream;
+    tails_[bucket] = id;
+  }
+
+  folly::F14FastMap<StreamId, Node> nodes_;
+  std::array<StreamId, kNumBuckets> heads_;
+  std::array<StreamId, kNumBuckets> tails_;
+};
+
+} // namespace quic
@@ -9,22 +9,11 @@
 #include <quic/state/QuicStateFunctions.h>
 #include <quic/state/QuicStreamFunctions.h>
 
+#include <folly/lang/Bits.h>
 #include <quic/common/TimeUtil.h>
+#include <quic/logging/QLoggerConstants.h>
 #include <quic/logging/QuicLogger.h>
 
-namespace {
-std::deque<quic::OutstandingPacket>::reverse_iterator
-getPreviousOutstandingPacket(
-    quic::QuicConnectionStateBase& conn,
-    quic::PacketNumberSpace packetNumberSpace,
-    std::deque<quic::OutstandingPacket>::reverse_iterator from) {
-  return std::find_if(
-      from, conn.outstandings.packets.rend(), [=](const auto& op) {
-        return packetNumberSpace == op.packet.header.getPacketNumberSpace();
-      });
-}
-} // namespace
-
 namespace quic {
 
 void updateRtt(
@@ -74,22 +63,53 @@ void updateAckSendStateOnRecvPacket(
     AckState& ackState,
     bool pktOutOfOrder,
     bool pktHasRetransmittableData,
-    bool pktHasCryptoData) {
+    bool pktHasCryptoData,
+    EcnCodepoint ecn) {
   DCHECK(!pktHasCryptoData || pktHasRetransmittableData);
-  auto thresh = kNonRtxRxPacketsPendingBeforeAck;
+  switch (ecn) {
+    case EcnCodepoint::Ect0:
+      ++ackState.ecnCounts.ect0;
+      break;
+    case EcnCodepoint::Ect1:
+      ++ackState.ecnCounts.ect1;
+      break;
+    case EcnCodepoint::Ce:
+      ++ackState.ecnCounts.ce;
+      break;
+    case EcnCodepoint::NotEct:
+      break;
+  }
+  bool pktCeMarked = ecn == EcnCodepoint::Ce;
+  bool immediateAckRequested = false;
+  const AckFrequencyFrame* peerRequest = nullptr;
+  if (&ackState == &conn.ackStates.appDataAckState) {
+    immediateAckRequested = conn.ackFrequencyState.immediateAckRequested;
+    conn.ackFrequencyState.immediateAckRequested = false;
+    peerRequest = conn.ackFrequencyState.peerRequest.get_pointer();
+  }
+  if (peerRequest && peerRequest->ignoreOrder) {
+    pktOutOfOrder = false;
+  }
+  uint64_t thresh = kNonRtxRxPacketsPendingBeforeAck;
   if (pktHasRetransmittableData || ackState.numRxPacketsRecvd) {
-    thresh = ackState.largestReceivedPacketNum.value_or(0) >
-            conn.transportSettings.rxPacketsBeforeAckInitThreshold
-        ? conn.transportSettings.rxPacketsBeforeAckAfterInit
-        : conn.transportSettings.rxPacketsBeforeAckBeforeInit;
+    if (peerRequest) {
+      thresh = peerRequest->packetTolerance;
+    } else {
+      thresh = ackState.largestReceivedPacketNum.value_or(0) >
+              conn.transportSettings.rxPacketsBeforeAckInitThreshold
+          ? conn.transportSettings.rxPacketsBeforeAckAfterInit
+          : conn.transportSettings.rxPacketsBeforeAckBeforeInit;
+    }
   }
   if (pktHasRetransmittableData) {
-    if (pktHasCryptoData || pktOutOfOrder ||
+    if (pktHasCryptoData || pktOutOfOrder || pktCeMarked ||
+        immediateAckRequested ||
         ++ackState.numRxPacketsRecvd + ackState.numNonRxPacketsRecvd >=
             thresh) {
       VLOG(10) << conn
                << " ack immediately because packet threshold pktHasCryptoData="
-               << pktHasCryptoData << " pktHasRetransmittableData="
+               << pktHasCryptoData << " pktCeMarked=" << pktCeMarked
+               << " pktHasRetransmittableData="
                << static_cast<int>(pktHasRetransmittableData)
                << " numRxPacketsRecvd="
                << static_cast<int>(ackState.numRxPacketsRecvd)
@@ -157,6 +177,161 @@ bool isConnectionPaced(const QuicConnectionStateBase& conn) noexcept {
       conn.transportSettings.pacingEnabled && conn.canBePaced && conn.pacer);
 }
 
+EcnCodepoint getEcnCodepointToSend(
+    const QuicConnectionStateBase& conn) noexcept {
+  if (!conn.transportSettings.enableEcn) {
+    return EcnCodepoint::NotEct;
+  }
+  switch (conn.ecnState.validation) {
+    case EcnState::Validation::Testing:
+    case EcnState::Validation::Capable:
+      return conn.transportSettings.useL4sEcn ? EcnCodepoint::Ect1
+                                              : EcnCodepoint::Ect0;
+    case EcnState::Validation::Unknown:
+    case EcnState::Validation::Failed:
+      return EcnCodepoint::NotEct;
+  }
+  folly::assume_unreachable();
+}
+
+static void failEcnValidation(
+    QuicConnectionStateBase& conn,
+    folly::StringPiece reason) noexcept {
+  VLOG(4) << "ECN validation failed: " << reason << " " << conn;
+  conn.ecnState.validation = EcnState::Validation::Failed;
+  if (conn.qLogger) {
+    conn.qLogger->addTransportStateUpdate(kEcnValidationFailed);
+  }
+}
+
+void onEcnMarkedPacketSent(QuicConnectionStateBase& conn) noexcept {
+  auto& ecnState = conn.ecnState;
+  if (ecnState.validation == EcnState::Validation::Testing &&
+      ++ecnState.testingPacketsSent >= kEcnTestingPackets) {
+    // Stop marking until the testing packets are acked or lost.
+    ecnState.validation = EcnState::Validation::Unknown;
+  }
+}
+
+void onEcnMarkedPacketLost(QuicConnectionStateBase& conn) noexcept {
+  auto& ecnState = conn.ecnState;
+  if ((ecnState.validation == EcnState::Validation::Testing ||
+       ecnState.validation == EcnState::Validation::Unknown) &&
+      ++ecnState.testingPacketsLost >= kEcnTestingPackets) {
+    // The path may drop the ECN marked packets.
+    failEcnValidation(conn, "testing packets lost");
+  }
+}
+
+uint64_t processAckEcnCounts(
+    QuicConnectionStateBase& conn,
+    AckState& ackState,
+    const ReadAckFrame& frame,
+    uint64_t numEcnMarkedAcked) noexcept {
+  auto& ecnState = conn.ecnState;
+  if (ecnState.validation == EcnState::Validation::Failed) {
+    return 0;
+  }
+  if (!frame.ecnCounts) {
+    if (numEcnMarkedAcked > 0) {
+      failEcnValidation(conn, "no ECN counts");
+    }
+    return 0;
+  }
+  const auto& counts = *frame.ecnCounts;
+  auto& peerCounts = ackState.peerEcnCounts;
+  if (counts.ect0 < peerCounts.ect0 || counts.ect1 < peerCounts.ect1 ||
+      counts.ce < peerCounts.ce) {
+    failEcnValidation(conn, "ECN counts decreased");
+    return 0;
+  }
+  // The marked packets newly acked must show up as ECT or as CE, in the
+  // codepoint they were sent with.
+  uint64_t ectIncrease = conn.transportSettings.useL4sEcn
+      ? counts.ect1 - peerCounts.ect1
+      : counts.ect0 - peerCounts.ect0;
+  uint64_t ceIncrease = counts.ce - peerCounts.ce;
+  if (ectIncrease + ceIncrease < numEcnMarkedAcked) {
+    failEcnValidation(conn, "ECN marks missing");
+    return 0;
+  }
+  peerCounts = counts;
+  if (numEcnMarkedAcked > 0 &&
+      ecnState.validation != EcnState::Validation::Capable) {
+    VLOG(4) << "ECN validated " << conn;
+    ecnState.validation = EcnState::Validation::Capable;
+    if (conn.qLogger) {
+      conn.qLogger->addTransportStateUpdate(kEcnCapable);
+    }
+  }
+  return ceIncrease;
+}
+
+void handleDatagram(QuicConnectionStateBase& conn, DatagramFrame& frame) {
+  const auto& datagramConfig = conn.transportSettings.datagramConfig;
+  if (!datagramConfig.enabled || frame.length > kDefaultMaxDatagramFrameSize) {
+    throw QuicTransportException(
+        "Unexpected datagram",
+        TransportErrorCode::PROTOCOL_VIOLATION,
+        FrameType::DATAGRAM);
+  }
+  QUIC_STATS(conn.statsCallback, onDatagramRead, frame.length);
+  auto& readBuffer = conn.datagramState.readBuffer;
+  if (readBuffer.size() >= datagramConfig.readBufSize) {
+    QUIC_STATS(conn.statsCallback, onDatagramDroppedOnRead);
+    if (readBuffer.empty()) {
+      return;
+    }
+    readBuffer.pop_front();
+  }
+  readBuffer.push_back(
+      frame.data ? std::move(frame.data) : folly::IOBuf::create(0));
+}
+
+bool requestPeerAckFrequency(
+    QuicConnectionStateBase& conn,
+    uint64_t packetTolerance,
+    std::chrono::microseconds maxAckDelay) {
+  auto& ackFrequencyState = conn.ackFrequencyState;
+  if (!conn.transportSettings.ackFrequencyConfig.enabled ||
+      !ackFrequencyState.peerMinAckDelay) {
+    return false;
+  }
+  // Powers of two and whole milliseconds, so that the frame is only sent again
+  // when the congestion window or the rtt changes a lot.
+  packetTolerance = folly::prevPowTwo(std::min(
+      std::max(packetTolerance, kMinAckFrequencyPacketTolerance),
+      kMaxAckFrequencyPacketTolerance));
+  maxAckDelay = timeMax(
+      *ackFrequencyState.peerMinAckDelay,
+      std::chrono::duration_cast<std::chrono::milliseconds>(
+          timeMin(maxAckDelay, kMaxAckTimeout)));
+  auto& lastRequested = ackFrequencyState.lastRequested;
+  if (lastRequested && lastRequested->packetTolerance == packetTolerance &&
+      lastRequested->updateMaxAckDelay == uint64_t(maxAckDelay.count())) {
+    return false;
+  }
+  // A request that has not been sent yet is obsolete.
+  auto& frames = conn.pendingEvents.frames;
+  frames.erase(
+      std::remove_if(
+          frames.begin(),
+          frames.end(),
+          [](const QuicSimpleFrame& frame) {
+            return frame.asAckFrequencyFrame() != nullptr;
+          }),
+      frames.end());
+  lastRequested = AckFrequencyFrame(
+      ackFrequencyState.nextSequenceNumber++,
+      packetTolerance,
+      maxAckDelay.count(),
+      false);
+  VLOG(10) << "Request ack frequency packetTolerance=" << packetTolerance
+           << " maxAckDelay=" << maxAckDelay.count() << "us " << conn;
+  frames.emplace_back(*lastRequested);
+  return true;
+}
+
 AckState& getAckState(
     QuicConnectionStateBase& conn,
     PacketNumberSpace pnSpace) noexcept {
@@ -208,28 +383,34 @@ void increaseNextPacketNum(
   }
 }
 
-std::deque<OutstandingPacket>::iterator getFirstOutstandingPacket(
+OutstandingPacketStore::iterator getFirstOutstandingPacket(
     QuicConnectionStateBase& conn,
     PacketNumberSpace packetNumberSpace) {
-  return getNextOutstandingPacket(
-      conn, packetNumberSpace, conn.outstandings.packets.begin());
+  auto& packets = conn.outstandings.packets.packetsIn(packetNumberSpace);
+  if (packets.empty()) {
+    return conn.outstandings.packets.end();
+  }
+  return conn.outstandings.packets.find(
+      packetNumberSpace, packets.firstPacketNum());
 }
 
-std::deque<OutstandingPacket>::reverse_iterator getLastOutstandingPacket(
+OutstandingPacketStore::reverse_iterator getLastOutstandingPacket(
     QuicConnectionStateBase& conn,
     PacketNumberSpace packetNumberSpace) {
-  return getPreviousOutstandingPacket(
-      conn, packetNumberSpace, conn.outstandings.packets.rbegin());
+  auto& packets = conn.outstandings.packets.packetsIn(packetNumberSpace);
+  if (packets.empty()) {
+    return conn.outstandings.packets.rend();
+  }
+  return OutstandingPacketStore::reverse_iterator(std::next(
+      conn.outstandings.packets.find(
+          packetNumberSpace, packets.endPacketNum() - 1)));
 }
 
-std::deque<OutstandingPacket>::iterator getNextOutstandingPacket(
+OutstandingPacketStore::iterator getNextOutstandingPacket(
     QuicConnectionStateBase& conn,
     PacketNumberSpace packetNumberSpace,
-    std::deque<OutstandingPacket>::iterator from) {
-  return std::find_if(
-      from, conn.outstandings.packets.end(), [=](const auto& op) {
-        return packetNumberSpace == op.packet.header.getPacketNumberSpace();
-      });
+    OutstandingPacketStore::iterator from) {
+  return conn.outstandings.packets.nextIn(packetNumberSpace, from);
 }
 
 bool hasReceivedPacketsAtLastCloseSent(
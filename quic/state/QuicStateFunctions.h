@@ -15,12 +15,20 @@
 
 namespace quic {
 
+/**
+ * Updates ackState for a received packet, and counts its ECN codepoint for
+ * ACK_ECN. Like an out of order one, a CE marked packet with retransmittable
+ * data is acked immediately so the peer can react to the congestion quickly.
+ * In the AppData space the peer can change the ack threshold and whether out
+ * of order packets are acked immediately with ACK_FREQUENCY.
+ */
 void updateAckSendStateOnRecvPacket(
     QuicConnectionStateBase& conn,
     AckState& ackState,
     bool pktOutOfOrder,
     bool pktHasRetransmittableData,
-    bool pktHasCryptoData);
+    bool pktHasCryptoData,
+    EcnCodepoint ecn = EcnCodepoint::NotEct);
 
 void updateAckStateOnAckTimeout(QuicConnectionStateBase& conn);
 
@@ -36,6 +44,54 @@ void updateRtt(
 
 bool isConnectionPaced(const QuicConnectionStateBase& conn) noexcept;
 
+/**
+ * The ECN codepoint to mark the next packet with. NotEct unless ECN is enabled
+ * and the path is being tested or was validated.
+ */
+EcnCodepoint getEcnCodepointToSend(
+    const QuicConnectionStateBase& conn) noexcept;
+
+/**
+ * Updates the ECN validation for a sent packet that was marked with an ECT
+ * codepoint.
+ */
+void onEcnMarkedPacketSent(QuicConnectionStateBase& conn) noexcept;
+
+/**
+ * Updates the ECN validation for a lost packet that was marked with an ECT
+ * codepoint.
+ */
+void onEcnMarkedPacketLost(QuicConnectionStateBase& conn) noexcept;
+
+/**
+ * Validates the ECN counts of frame, an ACK frame for ackState that increased
+ * the largest acked packet and newly acked numEcnMarkedAcked packets that were
+ * marked with an ECT codepoint. Returns how many more packets the peer
+ * reports as CE marked, zero if the counts fail validation.
+ */
+uint64_t processAckEcnCounts(
+    QuicConnectionStateBase& conn,
+    AckState& ackState,
+    const ReadAckFrame& frame,
+    uint64_t numEcnMarkedAcked) noexcept;
+
+/**
+ * Buffers a received datagram for the app. When the read buffer is full the
+ * oldest datagram in it is dropped. Throws if datagrams were not negotiated.
+ */
+void handleDatagram(QuicConnectionStateBase& conn, DatagramFrame& frame);
+
+/**
+ * Asks the peer to ack every packetTolerance ack-eliciting packets and to
+ * delay its acks by at most maxAckDelay. The values are bounded and rounded so
+ * that small changes don't send a new ACK_FREQUENCY frame. Does nothing if the
+ * peer does not support ACK_FREQUENCY. Returns whether a frame was queued.
+ */
+bool requestPeerAckFrequency(
+    QuicConnectionStateBase& conn,
+    uint64_t packetTolerance,
+    std::chrono::microseconds maxAckDelay);
+
 AckState& getAckState(
     QuicConnectionStateBase& conn,
     PacketNumberSpace pnSpace) noexcept;
@@ -70,7 +126,10 @@ bool updateLargestReceivedPacketNum(
   }
   ackState.largestReceivedPacketNum = std::max<PacketNum>(
       ackState.largestReceivedPacketNum.value_or(packetNum), packetNum);
-  ackState.acks.insert(packetNum);
+  ackState.encodedAcks.insert(ackState.acks, packetNum);
+  if (ackState.acks.size() > kMaxAckBlocks) {
+    ackState.encodedAcks.withdrawSmallest(ackState.acks);
+  }
   if (ackState.largestReceivedPacketNum == packetNum) {
     ackState.largestRecvdPacketTime = receivedTime;
   }
@@ -78,15 +137,15 @@ bool updateLargestReceivedPacketNum(
   return expectedNextPacket != packetNum;
 }
 
-std::deque<OutstandingPacket>::iterator getNextOutstandingPacket(
+OutstandingPacketStore::iterator getNextOutstandingPacket(
     QuicConnectionStateBase& conn,
     PacketNumberSpace packetNumberSpace,
-    std::deque<OutstandingPacket>::iterator from);
-std::deque<OutstandingPacket>::iterator getFirstOutstandingPacket(
+    OutstandingPacketStore::iterator from);
+OutstandingPacketStore::iterator getFirstOutstandingPacket(
     QuicConnectionStateBase& conn,
     PacketNumberSpace packetNumberSpace);
 
-std::deque<OutstandingPacket>::reverse_iterator getLastOutstandingPacket(
+OutstandingPacketStore::reverse_iterator getLastOutstandingPacket(
     QuicConnectionStateBase& conn,
     PacketNumberSpace packetNumberSpace);
 
@@ -116,8 +116,8 @@ void appendDataToReadBufferCommon(
   // Start overlap will point to the first buffer that overlaps with the
   // current buffer and End overlap will point to the last buffer that overlaps.
   // They must always be set together.
-  folly::Optional<std::deque<StreamBuffer>::iterator> startOverlap;
-  folly::Optional<std::deque<StreamBuffer>::iterator> endOverlap;
+  folly::Optional<CircularDeque<StreamBuffer>::iterator> startOverlap;
+  folly::Optional<CircularDeque<StreamBuffer>::iterator> endOverlap;
 
   StreamBuffer* current = &buffer;
   bool currentAlreadyInserted = false;
@@ -437,13 +437,12 @@ void processCryptoStreamAck(
     uint64_t offset,
     uint64_t len) {
   auto ackedBuffer = cryptoStream.retransmissionBuffer.find(offset);
-  if (ackedBuffer == cryptoStream.retransmissionBuffer.end() ||
-      ackedBuffer->second->offset != offset ||
-      ackedBuffer->second->data.chainLength() != len) {
+  if (!ackedBuffer || ackedBuffer->offset != offset ||
+      ackedBuffer->data.chainLength() != len) {
     // It's possible retransmissions of crypto data were canceled.
     return;
   }
-  cryptoStream.retransmissionBuffer.erase(ackedBuffer);
+  cryptoStream.retransmissionBuffer.erase(offset);
 }
 
 bool streamFrameMatchesRetransmitBuffer(
@@ -135,12 +135,7 @@ bool QuicStreamManager::streamExists(StreamId streamId) {
 }
 
 QuicStreamState* QuicStreamManager::findStream(StreamId streamId) {
-  auto lookup = streams_.find(streamId);
-  if (lookup == streams_.end()) {
-    return nullptr;
-  } else {
-    return &lookup->second;
-  }
+  return streams_.find(streamId);
 }
 
 void QuicStreamManager::setMaxLocalBidirectionalStreams(
@@ -244,16 +239,13 @@ QuicStreamManager::getOrCreateOpenedLocalStream(StreamId streamId) {
       : openBidirectionalLocalStreams_;
   if (openLocalStreams.count(streamId)) {
     // Open a lazily created stream.
-    auto it = streams_.emplace(
-        std::piecewise_construct,
-        std::forward_as_tuple(streamId),
-        std::forward_as_tuple(streamId, conn_));
+    auto it = streams_.emplace(streamId, conn_);
     QUIC_STATS(conn_.statsCallback, onNewQuicStream);
     if (!it.second) {
       throw QuicTransportException(
           "Creating an active stream", TransportErrorCode::STREAM_STATE_ERROR);
     }
-    return &it.first->second;
+    return it.first;
   }
   return nullptr;
 }
@@ -264,11 +256,11 @@ QuicStreamState* QuicStreamManager::getStream(StreamId streamId) {
     updateAppIdleState();
     return stream;
   }
-  auto it = streams_.find(streamId);
-  if (it != streams_.end()) {
-    return &it->second;
+  auto stream = streams_.find(streamId);
+  if (stream) {
+    return stream;
   }
-  auto stream = getOrCreateOpenedLocalStream(streamId);
+  stream = getOrCreateOpenedLocalStream(streamId);
   auto nextAcceptableStreamId = isUnidirectionalStream(streamId)
       ? nextAcceptableLocalUnidirectionalStreamId_
       : nextAcceptableLocalBidirectionalStreamId_;
@@ -324,22 +316,18 @@ QuicStreamManager::getOrCreatePeerStream(StreamId streamId) {
         "Invalid stream", TransportErrorCode::STREAM_STATE_ERROR);
   }
 
-  // TODO when we can rely on C++17, this is a good candidate for try_emplace.
   auto peerStream = streams_.find(streamId);
-  if (peerStream != streams_.end()) {
-    return &peerStream->second;
+  if (peerStream) {
+    return peerStream;
   }
   auto& openPeerStreams = isUnidirectionalStream(streamId)
       ? openUnidirectionalPeerStreams_
       : openBidirectionalPeerStreams_;
   if (openPeerStreams.count(streamId)) {
     // Stream was already open, create the state for it lazily.
-    auto it = streams_.emplace(
-        std::piecewise_construct,
-        std::forward_as_tuple(streamId),
-        std::forward_as_tuple(streamId, conn_));
+    auto it = streams_.emplace(streamId, conn_);
     QUIC_STATS(conn_.statsCallback, onNewQuicStream);
-    return &it.first->second;
+    return it.first;
   }
 
   auto& nextAcceptableStreamId = isUnidirectionalStream(streamId)
@@ -362,12 +350,9 @@ QuicStreamManager::getOrCreatePeerStream(StreamId streamId) {
         "Exceeded stream limit.", TransportErrorCode::STREAM_LIMIT_ERROR);
   }
 
-  auto it = streams_.emplace(
-      std::piecewise_construct,
-      std::forward_as_tuple(streamId),
-      std::forward_as_tuple(streamId, conn_));
+  auto it = streams_.emplace(streamId, conn_);
   QUIC_STATS(conn_.statsCallback, onNewQuicStream);
-  return &it.first->second;
+  return it.first;
 }
 
 folly::Expected<QuicStreamState*, LocalErrorCode>
@@ -399,23 +384,20 @@ QuicStreamManager::createStream(StreamId streamId) {
   if (openedResult != LocalErrorCode::NO_ERROR) {
     return folly::makeUnexpected(openedResult);
   }
-  auto it = streams_.emplace(
-      std::piecewise_construct,
-      std::forward_as_tuple(streamId),
-      std::forward_as_tuple(streamId, conn_));
+  auto it = streams_.emplace(streamId, conn_);
   QUIC_STATS(conn_.statsCallback, onNewQuicStream);
   updateAppIdleState();
-  return &it.first->second;
+  return it.first;
 }
 
 void QuicStreamManager::removeClosedStream(StreamId streamId) {
-  auto it = streams_.find(streamId);
-  if (it == streams_.end()) {
+  auto stream = streams_.find(streamId);
+  if (!stream) {
     VLOG(10) << "Trying to remove already closed stream=" << streamId;
     return;
   }
   VLOG(10) << "Removing closed stream=" << streamId;
-  DCHECK(it->second.inTerminalStates());
+  DCHECK(stream->inTerminalStates());
   readableStreams_.erase(streamId);
   peekableStreams_.erase(streamId);
   writableStreams_.erase(streamId);
@@ -429,11 +411,11 @@ void QuicStreamManager::removeClosedStream(StreamId streamId) {
   flowControlUpdated_.erase(streamId);
   dataRejectedStreams_.erase(streamId);
   dataExpiredStreams_.erase(streamId);
-  if (it->second.isControl) {
+  if (stream->isControl) {
     DCHECK_GT(numControlStreams_, 0);
     numControlStreams_--;
   }
-  streams_.erase(it);
+  streams_.erase(streamId);
   QUIC_STATS(conn_.statsCallback, onQuicStreamClosed);
   if (isRemoteStream(nodeType_, streamId)) {
     auto& openPeerStreams = isUnidirectionalStream(streamId)
@@ -528,14 +510,61 @@ void QuicStreamManager::updateAppIdleState() {
 
 void QuicStreamManager::setStreamAsControl(QuicStreamState& stream) {
   if (!stream.isControl) {
+    // Move the stream to the control queue if it is already writable.
+    bool writable = writableStreams_.count(stream.id) > 0;
+    removeWritable(stream);
     stream.isControl = true;
     numControlStreams_++;
+    if (writable) {
+      addWritable(stream);
+    }
   }
   updateAppIdleState();
 }
 
+void QuicStreamManager::setStreamPriority(
+    StreamId id,
+    PriorityLevel level,
+    bool incremental) {
+  auto stream = getStream(id);
+  if (!stream) {
+    return;
+  }
+  stream->priority = Priority(level, incremental);
+  if (stream->isControl) {
+    writableControlStreams_.updateIfExist(id, stream->priority);
+  } else {
+    writableStreams_.updateIfExist(id, stream->priority);
+  }
+}
+
 bool QuicStreamManager::isAppIdle() const {
   return isAppIdle_;
 }
 
+size_t QuicStreamManager::getAllocatedMemorySize() const {
+  size_t total = streams_.getAllocatedMemorySize() +
+      blockedStreams_.getAllocatedMemorySize() +
+      stopSendingStreams_.getAllocatedMemorySize() +
+      newPeerStreams_.capacity() * sizeof(StreamId);
+  for (const auto* streamIds :
+       {&openBidirectionalPeerStreams_,
+        &openUnidirectionalPeerStreams_,
+        &openBidirectionalLocalStreams_,
+        &openUnidirectionalLocalStreams_,
+        &dataExpiredStreams_,
+        &dataRejectedStreams_,
+        &windowUpdates_,
+        &flowControlUpdated_,
+        &lossStreams_,
+        &readableStreams_,
+        &peekableStreams_,
+        &txStreams_,
+        &deliverableStreams_,
+        &closedStreams_}) {
+    total += streamIds->getAllocatedMemorySize();
+  }
+  return total;
+}
+
 } // namespace quic
@@ -12,10 +12,11 @@
 #include <folly/container/F14Set.h>
 #include <quic/QuicConstants.h>
 #include <quic/codec/Types.h>
+#include <quic/state/QuicPriorityQueue.h>
+#include <quic/state/QuicStreamTable.h>
 #include <quic/state/StreamData.h>
 #include <quic/state/TransportSettings.h>
 #include <numeric>
-#include <set>
 
 namespace quic {
 namespace detail {
@@ -182,7 +183,7 @@ class QuicStreamManager {
    * Return a const reference to the underlying container holding the stream
    * state. Only really useful for iterating.
    */
-  const auto& streams() const {
+  const QuicStreamTable& streams() const {
     return streams_;
   }
 
@@ -190,9 +191,7 @@ class QuicStreamManager {
    * Call the given function on every currently open stream's state.
    */
   void streamStateForEach(const std::function<void(QuicStreamState&)>& f) {
-    for (auto& s : streams_) {
-      f(s.second);
-    }
+    streams_.forEach(f);
   }
 
   const auto& lossStreams() const {
@@ -207,21 +206,17 @@ class QuicStreamManager {
     return !lossStreams_.empty();
   }
 
-  // TODO figure out a better interface here.
   /*
-   * Returns a mutable reference to the container holding the writable stream
-   * IDs.
+   * Returns a mutable reference to the queue of writable non-control streams.
    */
-  auto& writableStreams() {
+  PriorityQueue& writableStreams() {
     return writableStreams_;
   }
 
-  // TODO figure out a better interface here.
   /*
-   * Returns a mutable reference to the container holding the writable stream
-   * IDs.
+   * Returns a mutable reference to the queue of writable control streams.
    */
-  auto& writableControlStreams() {
+  PriorityQueue& writableControlStreams() {
     return writableControlStreams_;
   }
 
@@ -245,9 +240,9 @@ class QuicStreamManager {
    */
   void addWritable(const QuicStreamState& stream) {
     if (stream.isControl) {
-      writableControlStreams_.insert(stream.id);
+      writableControlStreams_.insertOrUpdate(stream.id, stream.priority);
     } else {
-      writableStreams_.insert(stream.id);
+      writableStreams_.insertOrUpdate(stream.id, stream.priority);
     }
   }
 
@@ -270,6 +265,12 @@ class QuicStreamManager {
     writableControlStreams_.clear();
   }
 
+  /*
+   * Set the scheduling priority of the given stream, moving it within the
+   * writable queues if it currently has data to write.
+   */
+  void setStreamPriority(StreamId id, PriorityLevel level, bool incremental);
+
   /*
    * Returns a const reference to the underlying blocked streams container.
    */
@@ -706,6 +707,13 @@ class QuicStreamManager {
     return streams_.size();
   }
 
+  /*
+   * Returns the heap bytes of the stream map, which holds the stream states,
+   * and of the stream id sets. What the streams allocate themselves is not
+   * included.
+   */
+  size_t getAllocatedMemorySize() const;
+
   /*
    * Returns a const reference to the container of streams with pending
    * StopSending events.
@@ -854,8 +862,8 @@ class QuicStreamManager {
   // Unidirectional streams that are opened locally on the connection.
   folly::F14FastSet<StreamId> openUnidirectionalLocalStreams_;
 
-  // A map of streams that are active.
-  folly::F14FastMap<StreamId, QuicStreamState> streams_;
+  // The streams that are active.
+  QuicStreamTable streams_;
 
   // Recently opened peer streams.
   std::vector<StreamId> newPeerStreams_;
@@ -888,11 +896,11 @@ class QuicStreamManager {
   // Set of streams that have pending peeks
   folly::F14FastSet<StreamId> peekableStreams_;
 
-  // Set of !control streams that have writable data
-  std::set<StreamId> writableStreams_;
+  // Queue of !control streams that have writable data
+  PriorityQueue writableStreams_;
 
-  // Set of control streams that have writable data
-  std::set<StreamId> writableControlStreams_;
+  // Queue of control streams that have writable data
+  PriorityQueue writableControlStreams_;
 
   // Streams that may be able to call TxCallback
   folly::F14FastSet<StreamId> txStreams_;
@@ -0,0 +1,127 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ *
+ */
+
+#include <quic/state/QuicStreamTable.h>
+
+namespace quic {
+
+constexpr uint8_t QuicStreamTable::kStreamTypeBits;
+constexpr StreamId QuicStreamTable::kStreamTypeMask;
+constexpr uint64_t QuicStreamTable::kMaxSlotGap;
+
+std::pair<QuicStreamState*, bool> QuicStreamTable::emplace(
+    StreamId id,
+    QuicConnectionStateBase& conn) {
+  auto existing = find(id);
+  if (existing) {
+    return std::make_pair(existing, false);
+  }
+  auto stream = std::make_unique<QuicStreamState>(id, conn);
+  auto streamPtr = stream.get();
+  auto& window = windows_[id & kStreamTypeMask];
+  auto slot = slotFor(window, id >> kStreamTypeBits);
+  if (slot) {
+    *slot = std::move(stream);
+    ++window.numStreams;
+    evictStragglers(window);
+  } else {
+    sparse_.emplace(id, std::move(stream));
+  }
+  ++size_;
+  return std::make_pair(streamPtr, true);
+}
+
+bool QuicStreamTable::erase(StreamId id) {
+  auto& window = windows_[id & kStreamTypeMask];
+  uint64_t index = (id >> kStreamTypeBits) - window.base;
+  if (index < window.slots.size() && window.slots[index]) {
+    window.slots[index].reset();
+    --window.numStreams;
+    trimEmptySlots(window);
+  } else if (sparse_.erase(id) == 0) {
+    return false;
+  }
+  --size_;
+  return true;
+}
+
+void QuicStreamTable::clear() {
+  for (auto& window : windows_) {
+    window.slots.clear();
+    window.numStreams = 0;
+    window.base = 0;
+  }
+  sparse_.clear();
+  size_ = 0;
+}
+
+size_t QuicStreamTable::getAllocatedMemorySize() const {
+  size_t total = size_ * sizeof(QuicStreamState) +
+      sparse_.getAllocatedMemorySize();
+  for (const auto& window : windows_) {
+    total += window.slots.capacity() * sizeof(window.slots[0]);
+  }
+  return total;
+}
+
+std::unique_ptr<QuicStreamState>* FOLLY_NULLABLE
+QuicStreamTable::slotFor(Window& window, uint64_t streamNum) {
+  if (window.slots.empty()) {
+    window.base = streamNum;
+    window.slots.emplace_back();
+    return &window.slots.back();
+  }
+  if (streamNum >= window.base) {
+    uint64_t index = streamNum - window.base;
+    if (index >= window.slots.size()) {
+      if (index - window.slots.size() >= kMaxSlotGap) {
+        return nullptr;
+      }
+      while (window.slots.size() <= index) {
+        window.slots.emplace_back();
+      }
+    }
+    return &window.slots[index];
+  }
+  // A lazily created stream below the others.
+  if (window.base - streamNum > kMaxSlotGap) {
+    return nullptr;
+  }
+  while (window.base > streamNum) {
+    window.slots.emplace_front();
+    --window.base;
+  }
+  return &window.slots.front();
+}
+
+void QuicStreamTable::evictStragglers(Window& window) {
+  // A long lived stream at the front would keep the window from sliding, so
+  // it moves to the map once the window is mostly empty slots.
+  while (window.slots.size() > 2 * window.numStreams + kMaxSlotGap) {
+    auto& stream = window.slots.front();
+    DCHECK(stream);
+    auto id = stream->id;
+    sparse_.emplace(id, std::move(stream));
+    window.slots.pop_front();
+    ++window.base;
+    --window.numStreams;
+    trimEmptySlots(window);
+  }
+}
+
+void QuicStreamTable::trimEmptySlots(Window& window) {
+  while (!window.slots.empty() && !window.slots.front()) {
+    window.slots.pop_front();
+    ++window.base;
+  }
+  while (!window.slots.empty() && !window.slots.back()) {
+    window.slots.pop_back();
+  }
+}
+
+} // namespace quic
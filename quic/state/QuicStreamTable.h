@@ -0,0 +1,132 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ *
+ */
+
+#pragma once
+
+#include <folly/container/F14Map.h>
+#include <quic/codec/Types.h>
+#include <quic/common/CircularDeque.h>
+#include <quic/state/StreamData.h>
+
+#include <array>
+#include <memory>
+
+namespace quic {
+
+/**
+ * The stream states of a connection, keyed by stream id.
+ *
+ * Stream ids of each of the four stream types are handed out in sequence, so
+ * each type gets a window of slots indexed by the stream number, id >> 2,
+ * minus the number of the first slot. Finding a stream is an index into its
+ * window. A closed stream leaves an empty slot until the empty slots around
+ * it are trimmed from either end, so the window slides along with the ids in
+ * use. Streams that are far away from the others of their type, including a
+ * long lived stream the window slid past, are kept in a map instead.
+ *
+ * The states are allocated one by one, so pointers to them stay valid until
+ * the stream is erased.
+ */
+class QuicStreamTable {
+ public:
+  QuicStreamState* find(StreamId id) {
+    return const_cast<QuicStreamState*>(
+        static_cast<const QuicStreamTable*>(this)->find(id));
+  }
+
+  const QuicStreamState* find(StreamId id) const {
+    const auto& window = windows_[id & kStreamTypeMask];
+    uint64_t index = (id >> kStreamTypeBits) - window.base;
+    // Stream numbers below the base wrap around to a large index.
+    if (index < window.slots.size() && window.slots[index]) {
+      return window.slots[index].get();
+    }
+    if (sparse_.empty()) {
+      return nullptr;
+    }
+    auto itr = sparse_.find(id);
+    return itr == sparse_.end() ? nullptr : itr->second.get();
+  }
+
+  /**
+   * Creates the state of the stream unless it exists. Returns the state and
+   * whether it was created, like emplace() of a map.
+   */
+  std::pair<QuicStreamState*, bool> emplace(
+      StreamId id,
+      QuicConnectionStateBase& conn);
+
+  /**
+   * Destroys the state of the stream. Returns whether there was one.
+   */
+  bool erase(StreamId id);
+
+  void clear();
+
+  size_t size() const {
+    return size_;
+  }
+
+  bool empty() const {
+    return size_ == 0;
+  }
+
+  /**
+   * Calls f on every stream state. f must not create or erase streams.
+   */
+  template <typename F>
+  void forEach(F&& f) {
+    static_cast<const QuicStreamTable*>(this)->forEach(
+        [&](const QuicStreamState& stream) {
+          f(const_cast<QuicStreamState&>(stream));
+        });
+  }
+
+  template <typename F>
+  void forEach(F&& f) const {
+    for (const auto& window : windows_) {
+      for (const auto& slot : window.slots) {
+        if (slot) {
+          f(*slot);
+        }
+      }
+    }
+    for (const auto& idAndStream : sparse_) {
+      f(*idAndStream.second);
+    }
+  }
+
+  size_t getAllocatedMemorySize() const;
+
+ private:
+  static constexpr uint8_t kStreamTypeBits = 2;
+  static constexpr StreamId kStreamTypeMask = (1 << kStreamTypeBits) - 1;
+  // A stream this many slots or more away from a window goes to the map.
+  static constexpr uint64_t kMaxSlotGap = 1024;
+
+  struct Window {
+    // Stream number of the first slot.
+    uint64_t base{0};
+    // Number of slots with a stream.
+    size_t numStreams{0};
+    CircularDeque<std::unique_ptr<QuicStreamState>> slots;
+  };
+
+  std::unique_ptr<QuicStreamState>* FOLLY_NULLABLE
+  slotFor(Window& window, uint64_t streamNum);
+
+  void evictStragglers(Window& window);
+
+  static void trimEmptySlots(Window& window);
+
+  std::array<Window, kStreamTypeMask + 1> windows_;
+  folly::F14FastMap<StreamId, std::unique_ptr<QuicStreamState>> sparse_;
+  size_t size_{0};
+};
+
+} // namespace quic
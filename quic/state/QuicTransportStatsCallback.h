@@ -45,6 +45,7 @@ class QuicTransportStatsCallback {
     UDP_TRUNCATED,
     CLIENT_STATE_CLOSED,
     CLIENT_SHUTDOWN,
+    INVALID_TOKEN,
     // NOTE: MAX should always be at the end
     MAX
   };
@@ -90,10 +91,36 @@ class QuicTransportStatsCallback {
 
   virtual void onForwardedPacketProcessed() = 0;
 
+  // short header packets that the kernel delivered to a worker other than the
+  // one owning their connection, so they have to be handed off. Divided by the
+  // received packets it is the misroute rate of the reuseport steering.
+  virtual void onPacketMisrouted() = 0;
+
+  // packets handed off to the worker owning their connection. queueDepth is
+  // the number of packets in the handoff queue after this one was added.
+  virtual void onWorkerHandoff(size_t queueDepth) = 0;
+
+  // number of handed off packets a worker processed in one batch
+  virtual void onWorkerHandoffBatch(size_t batchSize) = 0;
+
+  // packets posted one by one because the handoff queue of their worker was
+  // full
+  virtual void onWorkerHandoffQueueFull() = 0;
+
+  // whether a read used a buffer from the receive buffer pool of the worker
+  virtual void onReceiveBufferPoolHit() = 0;
+
+  virtual void onReceiveBufferPoolMiss() = 0;
+
+  // number of datagrams a worker read with one recvmmsg call
+  virtual void onRecvBatch(size_t numDatagrams) = 0;
+
   virtual void onClientInitialReceived(QuicVersion version) = 0;
 
   virtual void onConnectionRateLimited() = 0;
 
+  virtual void onRetrySent() = 0;
+
   // connection level metrics:
   virtual void onNewConnection() = 0;
 
@@ -118,6 +145,14 @@ class QuicTransportStatsCallback {
 
   virtual void onStreamFlowControlBlocked() = 0;
 
+  virtual void onConnFlowControlWindowGrowth(uint64_t newWindowSize) = 0;
+
+  virtual void onStreamFlowControlWindowGrowth(uint64_t newWindowSize) = 0;
+
+  // The connection window could not grow as much as it should have, because
+  // the budget of the worker was used up.
+  virtual void onConnFlowControlWindowGrowthLimited() = 0;
+
   virtual void onCwndBlocked() = 0;
 
   // retransmission timeout counter
@@ -130,6 +165,33 @@ class QuicTransportStatsCallback {
 
   virtual void onUDPSocketWriteError(SocketErrorType errorType) = 0;
 
+  // zero copy writes the kernel sent from our buffers
+  virtual void onZeroCopyCompletion(size_t numWrites) = 0;
+
+  // zero copy writes that were copied after all, by the kernel or because it
+  // had no memory left for zero copy
+  virtual void onZeroCopyFallback(size_t numWrites) = 0;
+
+  // unreliable datagrams received from / written to the peer
+  virtual void onDatagramRead(size_t datagramSize) = 0;
+
+  virtual void onDatagramWrite(size_t datagramSize) = 0;
+
+  // datagrams dropped because the read or write buffer was full
+  virtual void onDatagramDroppedOnRead() = 0;
+
+  virtual void onDatagramDroppedOnWrite() = 0;
+
+  // idle or loss timer of a connection armed again on the worker's timer
+  // wheel, compare with the packets received
+  virtual void onTimerRescheduled() = 0;
+
+  // new connection started, or not, from the cached congestion state of an
+  // earlier connection to the same peer
+  virtual void onCongestionStateCacheHit() = 0;
+
+  virtual void onCongestionStateCacheMiss() = 0;
+
   static const char* toString(ConnectionCloseReason reason) {
     switch (reason) {
       case ConnectionCloseReason::NONE:
@@ -181,6 +243,8 @@ class QuicTransportStatsCallback {
         return "CLIENT_STATE_CLOSED";
       case PacketDropReason::CLIENT_SHUTDOWN:
         return "CLIENT_SHUTDOWN";
+      case PacketDropReason::INVALID_TOKEN:
+        return "INVALID_TOKEN";
       case PacketDropReason::MAX:
         return "MAX";
       default:
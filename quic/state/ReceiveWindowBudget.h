@@ -0,0 +1,100 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ *
+ */
+
+#pragma once
+
+#include <glog/logging.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+
+namespace quic {
+
+/**
+ * Bounds the memory that receive window auto-tuning can commit to across the
+ * connections of a server worker. A connection reserves the bytes its
+ * connection window grows by, and gives them back when it goes away.
+ *
+ * Not thread safe, it is only used from the thread of the worker.
+ */
+class ReceiveWindowBudget {
+ public:
+  explicit ReceiveWindowBudget(uint64_t limit) : limit_(limit) {}
+
+  /**
+   * Reserves up to bytes, returns how many were reserved.
+   */
+  uint64_t reserve(uint64_t bytes) {
+    auto reserved = std::min(bytes, limit_ - used_);
+    used_ += reserved;
+    return reserved;
+  }
+
+  void release(uint64_t bytes) {
+    DCHECK_GE(used_, bytes);
+    used_ -= bytes;
+  }
+
+  uint64_t used() const {
+    return used_;
+  }
+
+  uint64_t limit() const {
+    return limit_;
+  }
+
+ private:
+  const uint64_t limit_;
+  uint64_t used_{0};
+};
+
+/**
+ * What one connection holds of a ReceiveWindowBudget. Without a budget every
+ * reservation succeeds.
+ */
+class ReceiveWindowReservation {
+ public:
+  ReceiveWindowReservation() = default;
+
+  ~ReceiveWindowReservation() {
+    if (budget_) {
+      budget_->release(bytes_);
+    }
+  }
+
+  ReceiveWindowReservation(const ReceiveWindowReservation&) = delete;
+  ReceiveWindowReservation& operator=(const ReceiveWindowReservation&) = delete;
+
+  /**
+   * Must be called before anything is reserved.
+   */
+  void setBudget(std::shared_ptr<ReceiveWindowBudget> budget) {
+    DCHECK_EQ(bytes_, 0);
+    budget_ = std::move(budget);
+  }
+
+  /**
+   * Reserves up to bytes, returns how many were reserved.
+   */
+  uint64_t reserve(uint64_t bytes) {
+    auto reserved = budget_ ? budget_->reserve(bytes) : bytes;
+    bytes_ += reserved;
+    return reserved;
+  }
+
+  uint64_t bytes() const {
+    return bytes_;
+  }
+
+ private:
+  std::shared_ptr<ReceiveWindowBudget> budget_;
+  uint64_t bytes_{0};
+};
+
+} // namespace quic
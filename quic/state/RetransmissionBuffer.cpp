@@ -0,0 +1,148 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ *
+ */
+
+#include <quic/state/RetransmissionBuffer.h>
+
+#include <algorithm>
+
+namespace quic {
+
+namespace {
+
+// Drops the data of buffer before offset, returns true if nothing is left.
+bool trimBufferBefore(StreamBuffer& buffer, uint64_t offset) {
+  if (buffer.offset >= offset) {
+    return false;
+  }
+  if (buffer.offset + buffer.data.chainLength() <= offset) {
+    return true;
+  }
+  uint64_t amount = offset - buffer.offset;
+  buffer.data.trimStartAtMost(amount);
+  buffer.offset += amount;
+  return false;
+}
+
+} // namespace
+
+RetransmissionBuffer::Entries::iterator RetransmissionBuffer::lowerBound(
+    uint64_t offset) {
+  return std::lower_bound(
+      entries_.begin(),
+      entries_.end(),
+      offset,
+      [](const Entry& entry, uint64_t off) { return entry.offset < off; });
+}
+
+RetransmissionBuffer::Entry* RetransmissionBuffer::findEntry(uint64_t offset) {
+  if (entries_.empty() || offset < entries_.front().offset ||
+      offset > entries_.back().offset) {
+    return nullptr;
+  }
+  // Acks of in order data hit the front.
+  if (entries_.front().offset == offset) {
+    return &entries_.front();
+  }
+  auto itr = lowerBound(offset);
+  return itr->offset == offset ? &*itr : nullptr;
+}
+
+StreamBuffer* RetransmissionBuffer::find(uint64_t offset) {
+  auto entry = findEntry(offset);
+  if (entry && entry->buffer) {
+    return entry->buffer.get_pointer();
+  }
+  if (outOfOrder_.empty()) {
+    return nullptr;
+  }
+  auto itr = outOfOrder_.find(offset);
+  return itr != outOfOrder_.end() ? &itr->second : nullptr;
+}
+
+bool RetransmissionBuffer::emplace(uint64_t offset, StreamBuffer&& buffer) {
+  if (entries_.empty() || offset > entries_.back().offset) {
+    if (hasOutOfOrder(offset)) {
+      return false;
+    }
+    entries_.emplace_back(offset, std::move(buffer));
+    ++numBuffers_;
+    return true;
+  }
+  if (offset < entries_.front().offset) {
+    if (hasOutOfOrder(offset)) {
+      return false;
+    }
+    entries_.emplace_front(offset, std::move(buffer));
+    ++numBuffers_;
+    return true;
+  }
+  auto itr = lowerBound(offset);
+  if (itr->offset == offset) {
+    if (itr->buffer) {
+      return false;
+    }
+    itr->buffer.emplace(std::move(buffer));
+    ++numBuffers_;
+    return true;
+  }
+  auto outOfOrderItr = outOfOrder_.lower_bound(offset);
+  if (outOfOrderItr != outOfOrder_.end() && outOfOrderItr->first == offset) {
+    return false;
+  }
+  outOfOrder_.emplace_hint(outOfOrderItr, offset, std::move(buffer));
+  ++numBuffers_;
+  return true;
+}
+
+void RetransmissionBuffer::erase(uint64_t offset) {
+  auto entry = findEntry(offset);
+  if (entry && entry->buffer) {
+    entry->buffer.clear();
+    --numBuffers_;
+    trimTombstones();
+    return;
+  }
+  if (!outOfOrder_.empty() && outOfOrder_.erase(offset)) {
+    --numBuffers_;
+  }
+}
+
+void RetransmissionBuffer::trimBefore(uint64_t offset) {
+  // Buffers don't overlap, so they are sorted by their own offsets as well.
+  for (auto& entry : entries_) {
+    if (entry.offset >= offset) {
+      break;
+    }
+    if (!entry.buffer || !trimBufferBefore(*entry.buffer, offset)) {
+      continue;
+    }
+    entry.buffer.clear();
+    --numBuffers_;
+  }
+  trimTombstones();
+  auto itr = outOfOrder_.begin();
+  while (itr != outOfOrder_.end() && itr->first < offset) {
+    if (trimBufferBefore(itr->second, offset)) {
+      itr = outOfOrder_.erase(itr);
+      --numBuffers_;
+    } else {
+      ++itr;
+    }
+  }
+}
+
+void RetransmissionBuffer::trimTombstones() {
+  while (!entries_.empty() && !entries_.front().buffer) {
+    entries_.pop_front();
+  }
+  while (!entries_.empty() && !entries_.back().buffer) {
+    entries_.pop_back();
+  }
+}
+
+} // namespace quic
@@ -0,0 +1,226 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ *
+ */
+
+#pragma once
+
+#include <quic/codec/Types.h>
+#include <quic/common/CircularDeque.h>
+
+#include <folly/Optional.h>
+#include <glog/logging.h>
+
+#include <iterator>
+#include <map>
+
+namespace quic {
+
+struct StreamBuffer {
+  BufQueue data;
+  uint64_t offset;
+  bool eof{false};
+
+  StreamBuffer(Buf dataIn, uint64_t offsetIn, bool eofIn = false) noexcept
+      : data(std::move(dataIn)), offset(offsetIn), eof(eofIn) {}
+
+  StreamBuffer(StreamBuffer&& other) = default;
+  StreamBuffer& operator=(StreamBuffer&& other) = default;
+};
+
+/**
+ * The un-acked stream frames of a stream, keyed by the offset they were
+ * written at.
+ *
+ * The buffers are stored inline in a deque ordered by offset. New data is
+ * always written past the end, so it is appended in O(1), and acks mostly
+ * arrive in order, so they erase from the front in O(1). Other lookups are a
+ * binary search. An erased buffer leaves an empty tombstone behind until the
+ * tombstones around it are trimmed from either end, which keeps the position
+ * of the other buffers stable. A retransmission of lost data is keyed on the
+ * offset of its original frame, so it usually revives its own tombstone.
+ *
+ * A buffer that lands between two entries of the deque, like the rest of a
+ * partially retransmitted buffer, goes to an ordered map instead, so inserting
+ * it is O(log n) rather than a shift of the deque. An offset is only ever in
+ * one of the two.
+ *
+ * The offset of a buffer can move past its key with partial reliability, see
+ * trimBefore().
+ */
+class RetransmissionBuffer {
+ private:
+  struct Entry {
+    Entry(uint64_t offsetIn, StreamBuffer&& bufferIn)
+        : offset(offsetIn), buffer(std::move(bufferIn)) {}
+
+    uint64_t offset;
+    folly::Optional<StreamBuffer> buffer;
+  };
+
+  using Entries = CircularDeque<Entry>;
+  using OutOfOrderBuffers = std::map<uint64_t, StreamBuffer>;
+
+ public:
+  /**
+   * Iterates over the buffers in offset order, merging the deque and the map.
+   */
+  class const_iterator {
+   public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = StreamBuffer;
+    using difference_type = std::ptrdiff_t;
+    using pointer = const StreamBuffer*;
+    using reference = const StreamBuffer&;
+
+    const_iterator(
+        Entries::const_iterator entryItr,
+        Entries::const_iterator entryEnd,
+        OutOfOrderBuffers::const_iterator outOfOrderItr,
+        OutOfOrderBuffers::const_iterator outOfOrderEnd)
+        : entryItr_(entryItr),
+          entryEnd_(entryEnd),
+          outOfOrderItr_(outOfOrderItr),
+          outOfOrderEnd_(outOfOrderEnd) {
+      skipTombstones();
+    }
+
+    reference operator*() const {
+      return inEntries() ? *entryItr_->buffer : outOfOrderItr_->second;
+    }
+
+    pointer operator->() const {
+      return &**this;
+    }
+
+    // The offset the buffer is keyed on.
+    uint64_t key() const {
+      return inEntries() ? entryItr_->offset : outOfOrderItr_->first;
+    }
+
+    const_iterator& operator++() {
+      if (inEntries()) {
+        ++entryItr_;
+        skipTombstones();
+      } else {
+        ++outOfOrderItr_;
+      }
+      return *this;
+    }
+
+    bool operator==(const const_iterator& other) const {
+      return entryItr_ == other.entryItr_ &&
+          outOfOrderItr_ == other.outOfOrderItr_;
+    }
+
+    bool operator!=(const const_iterator& other) const {
+      return !(*this == other);
+    }
+
+   private:
+    // Whether the current buffer is the one of the deque.
+    bool inEntries() const {
+      return entryItr_ != entryEnd_ &&
+          (outOfOrderItr_ == outOfOrderEnd_ ||
+           entryItr_->offset < outOfOrderItr_->first);
+    }
+
+    void skipTombstones() {
+      while (entryItr_ != entryEnd_ && !entryItr_->buffer) {
+        ++entryItr_;
+      }
+    }
+
+    Entries::const_iterator entryItr_;
+    Entries::const_iterator entryEnd_;
+    OutOfOrderBuffers::const_iterator outOfOrderItr_;
+    OutOfOrderBuffers::const_iterator outOfOrderEnd_;
+  };
+
+  size_t size() const {
+    return numBuffers_;
+  }
+
+  bool empty() const {
+    return numBuffers_ == 0;
+  }
+
+  // Heap bytes of the entries, not counting the data they hold nor the nodes
+  // of the map.
+  size_t getAllocatedMemorySize() const {
+    return entries_.capacity() * sizeof(Entry) +
+        outOfOrder_.size() * sizeof(OutOfOrderBuffers::value_type);
+  }
+
+  const_iterator begin() const {
+    return const_iterator(
+        entries_.cbegin(),
+        entries_.cend(),
+        outOfOrder_.cbegin(),
+        outOfOrder_.cend());
+  }
+
+  const_iterator end() const {
+    return const_iterator(
+        entries_.cend(),
+        entries_.cend(),
+        outOfOrder_.cend(),
+        outOfOrder_.cend());
+  }
+
+  StreamBuffer* find(uint64_t offset);
+
+  const StreamBuffer* find(uint64_t offset) const {
+    return const_cast<RetransmissionBuffer*>(this)->find(offset);
+  }
+
+  StreamBuffer& at(uint64_t offset) {
+    auto buffer = find(offset);
+    CHECK(buffer) << "No retransmission buffer at offset=" << offset;
+    return *buffer;
+  }
+
+  const StreamBuffer& at(uint64_t offset) const {
+    return const_cast<RetransmissionBuffer*>(this)->at(offset);
+  }
+
+  /*
+   * Store buffer under offset. Returns false, leaving buffer alone, if there
+   * already is a buffer at offset.
+   */
+  bool emplace(uint64_t offset, StreamBuffer&& buffer);
+
+  void erase(uint64_t offset);
+
+  /*
+   * Drop the data before offset. Buffers that end before offset are erased, a
+   * buffer that straddles it is trimmed and keeps its key.
+   */
+  void trimBefore(uint64_t offset);
+
+  void clear() {
+    entries_.clear();
+    outOfOrder_.clear();
+    numBuffers_ = 0;
+  }
+
+ private:
+  Entry* findEntry(uint64_t offset);
+
+  bool hasOutOfOrder(uint64_t offset) const {
+    return !outOfOrder_.empty() && outOfOrder_.count(offset);
+  }
+
+  Entries::iterator lowerBound(uint64_t offset);
+
+  void trimTombstones();
+
+  Entries entries_;
+  OutOfOrderBuffers outOfOrder_;
+  size_t numBuffers_{0};
+};
+
+} // namespace quic
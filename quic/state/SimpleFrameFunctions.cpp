@@ -58,6 +58,19 @@ folly::Optional<QuicSimpleFrame> updateSimpleFrameOnPacketClone(
       return QuicSimpleFrame(frame);
     case QuicSimpleFrame::Type::HandshakeDoneFrame_E:
       return QuicSimpleFrame(frame);
+    case QuicSimpleFrame::Type::AckFrequencyFrame_E:
+      // Only the latest request is worth cloning.
+      if (!conn.ackFrequencyState.lastRequested ||
+          !(*frame.asAckFrequencyFrame() ==
+            *conn.ackFrequencyState.lastRequested)) {
+        return folly::none;
+      }
+      return QuicSimpleFrame(frame);
+    case QuicSimpleFrame::Type::ImmediateAckFrame_E:
+      // The ack of the original packet is just as good.
+      return folly::none;
+    case QuicSimpleFrame::Type::NewTokenFrame_E:
+      return QuicSimpleFrame(frame);
   }
   folly::assume_unreachable();
 }
@@ -124,6 +137,18 @@ void updateSimpleFrameOnPacketLoss(
       // Do not retransmit PATH_RESPONSE to avoid buffering
       break;
     }
+    case QuicSimpleFrame::Type::AckFrequencyFrame_E: {
+      const AckFrequencyFrame& ackFrequency = *frame.asAckFrequencyFrame();
+      // A newer request supersedes a lost one.
+      if (conn.ackFrequencyState.lastRequested &&
+          ackFrequency == *conn.ackFrequencyState.lastRequested) {
+        conn.pendingEvents.frames.push_back(ackFrequency);
+      }
+      break;
+    }
+    case QuicSimpleFrame::Type::ImmediateAckFrame_E: {
+      break;
+    }
     case QuicSimpleFrame::Type::HandshakeDoneFrame_E: {
       const auto& handshakeDoneFrame = *frame.asHandshakeDoneFrame();
       conn.pendingEvents.frames.push_back(handshakeDoneFrame);
@@ -131,6 +156,7 @@ void updateSimpleFrameOnPacketLoss(
     case QuicSimpleFrame::Type::NewConnectionIdFrame_E:
     case QuicSimpleFrame::Type::MaxStreamsFrame_E:
     case QuicSimpleFrame::Type::RetireConnectionIdFrame_E:
+    case QuicSimpleFrame::Type::NewTokenFrame_E:
       conn.pendingEvents.frames.push_back(frame);
       break;
   }
@@ -285,6 +311,40 @@ bool updateSimpleFrameOnPacketReceived(
       conn.handshakeLayer->handshakeConfirmed();
       return true;
     }
+    case QuicSimpleFrame::Type::AckFrequencyFrame_E: {
+      const AckFrequencyFrame& ackFrequency = *frame.asAckFrequencyFrame();
+      const auto& ackFrequencyConfig =
+          conn.transportSettings.ackFrequencyConfig;
+      if (!ackFrequencyConfig.enabled || ackFrequency.packetTolerance == 0 ||
+          ackFrequency.updateMaxAckDelay <
+              uint64_t(ackFrequencyConfig.minAckDelay.count())) {
+        throw QuicTransportException(
+            "Invalid ACK_FREQUENCY frame",
+            TransportErrorCode::PROTOCOL_VIOLATION,
+            FrameType::ACK_FREQUENCY);
+      }
+      auto& peerRequest = conn.ackFrequencyState.peerRequest;
+      // Frames can arrive out of order, the newest request wins.
+      if (!peerRequest ||
+          ackFrequency.sequenceNumber > peerRequest->sequenceNumber) {
+        peerRequest = ackFrequency;
+      }
+      return true;
+    }
+    case QuicSimpleFrame::Type::ImmediateAckFrame_E: {
+      if (!conn.transportSettings.ackFrequencyConfig.enabled) {
+        throw QuicTransportException(
+            "Received IMMEDIATE_ACK without min_ack_delay",
+            TransportErrorCode::PROTOCOL_VIOLATION,
+            FrameType::IMMEDIATE_ACK);
+      }
+      conn.ackFrequencyState.immediateAckRequested = true;
+      return true;
+    }
+    case QuicSimpleFrame::Type::NewTokenFrame_E: {
+      // Only written, the received frames are ReadNewTokenFrame.
+      return true;
+    }
   }
   folly::assume_unreachable();
 }
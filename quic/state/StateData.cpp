@@ -55,6 +55,60 @@ std::ostream& operator<<(std::ostream& os, const QuicConnectionStateBase& st) {
   return os;
 }
 
+namespace {
+
+void addStreamMemoryUsage(
+    const QuicStreamLike& stream,
+    ConnectionMemoryUsage& usage) {
+  usage.stateBytes += stream.readBuffer.capacity() * sizeof(StreamBuffer);
+  usage.stateBytes += stream.lossBuffer.capacity() * sizeof(StreamBuffer);
+  usage.stateBytes += stream.retransmissionBuffer.getAllocatedMemorySize();
+  usage.bufferedBytes += stream.writeBuffer.chainLength();
+  for (const auto& buffer : stream.readBuffer) {
+    usage.bufferedBytes += buffer.data.chainLength();
+  }
+  for (const auto& buffer : stream.retransmissionBuffer) {
+    usage.bufferedBytes += buffer.data.chainLength();
+  }
+  for (const auto& buffer : stream.lossBuffer) {
+    usage.bufferedBytes += buffer.data.chainLength();
+  }
+}
+
+} // namespace
+
+ConnectionMemoryUsage getConnectionMemoryUsage(
+    const QuicConnectionStateBase& conn,
+    size_t stateSize) {
+  ConnectionMemoryUsage usage;
+  usage.stateBytes = stateSize;
+  usage.stateBytes += conn.outstandings.packets.getAllocatedMemorySize();
+  usage.stateBytes += conn.datagramState.writeBuffer.capacity() * sizeof(Buf);
+  usage.stateBytes += conn.datagramState.readBuffer.capacity() * sizeof(Buf);
+  if (conn.cryptoState) {
+    usage.stateBytes += sizeof(QuicCryptoState);
+    addStreamMemoryUsage(conn.cryptoState->initialStream, usage);
+    addStreamMemoryUsage(conn.cryptoState->handshakeStream, usage);
+    addStreamMemoryUsage(conn.cryptoState->oneRttStream, usage);
+  }
+  for (const auto& buf : conn.datagramState.writeBuffer) {
+    usage.bufferedBytes += buf ? buf->computeChainDataLength() : 0;
+  }
+  for (const auto& buf : conn.datagramState.readBuffer) {
+    usage.bufferedBytes += buf->computeChainDataLength();
+  }
+  if (conn.streamManager) {
+    usage.stateBytes += sizeof(QuicStreamManager) +
+        conn.streamManager->getAllocatedMemorySize();
+    conn.streamManager->streams().forEach(
+        [&](const QuicStreamState& stream) {
+          addStreamMemoryUsage(stream, usage);
+        });
+    usage.numStreams = conn.streamManager->streams().size();
+  }
+  return usage;
+}
+
 AckStateVersion::AckStateVersion(
     uint64_t initialVersion,
     uint64_t handshakeVersion,
@@ -15,13 +15,17 @@
 #include <quic/codec/Types.h>
 #include <quic/common/BufAccessor.h>
 #include <quic/common/EnumArray.h>
+#include <quic/common/SmallVec.h>
 #include <quic/handshake/HandshakeLayer.h>
 #include <quic/logging/QLogger.h>
 #include <quic/state/AckStates.h>
+#include <quic/state/CongestionStateCache.h>
+#include <quic/state/OutstandingPacketStore.h>
 #include <quic/state/PacketEvent.h>
 #include <quic/state/PendingPathRateLimiter.h>
 #include <quic/state/QuicStreamManager.h>
 #include <quic/state/QuicTransportStatsCallback.h>
+#include <quic/state/ReceiveWindowBudget.h>
 #include <quic/state/StreamData.h>
 #include <quic/state/TransportSettings.h>
 
@@ -31,13 +35,17 @@
 #include <folly/io/async/DelayedDestruction.h>
 #include <folly/io/async/HHWheelTimer.h>
 
+#include <algorithm>
 #include <chrono>
+#include <deque>
 #include <list>
 #include <numeric>
 #include <queue>
 
 namespace quic {
 
+class ZeroCopyTracker;
+
 struct RecvmmsgStorage {
   // Storage for the recvmmsg system call.
   std::vector<struct mmsghdr> msgs;
@@ -63,6 +71,16 @@ struct NetworkData {
   TimePoint receiveTimePoint;
   std::vector<Buf> packets;
   size_t totalData{0};
+  // ECN marked packets, as runs of consecutive packets sharing a codepoint.
+  // The packets outside of the runs were not ECN marked. The GRO segments of a
+  // datagram share its codepoint, and a peer marks all its packets the same,
+  // so this is usually a single run, stored without an allocation.
+  struct EcnRun {
+    uint32_t begin;
+    uint32_t end;
+    EcnCodepoint ecn;
+  };
+  SmallVec<EcnRun, 2> ecnRuns;
 
   NetworkData() = default;
   NetworkData(Buf&& buf, const TimePoint& receiveTime)
@@ -84,88 +102,65 @@ struct NetworkData {
     }
     return buf;
   }
+
+  /**
+   * Sets the ECN codepoint of the packets from index firstPacket on.
+   */
+  void setEcnCodepoint(size_t firstPacket, EcnCodepoint ecn) {
+    while (!ecnRuns.empty() && ecnRuns.back().begin >= firstPacket) {
+      ecnRuns.pop_back();
+    }
+    if (!ecnRuns.empty() && ecnRuns.back().end > firstPacket) {
+      ecnRuns.back().end = firstPacket;
+    }
+    if (ecn == EcnCodepoint::NotEct || firstPacket >= packets.size()) {
+      return;
+    }
+    if (!ecnRuns.empty() && ecnRuns.back().end == firstPacket &&
+        ecnRuns.back().ecn == ecn) {
+      ecnRuns.back().end = packets.size();
+      return;
+    }
+    ecnRuns.push_back(
+        {static_cast<uint32_t>(firstPacket),
+         static_cast<uint32_t>(packets.size()),
+         ecn});
+  }
+
+  EcnCodepoint getEcnCodepoint(size_t packet) const {
+    for (auto it = ecnRuns.rbegin(); it != ecnRuns.rend(); ++it) {
+      if (it->begin <= packet) {
+        return packet < it->end ? it->ecn : EcnCodepoint::NotEct;
+      }
+    }
+    return EcnCodepoint::NotEct;
+  }
 };
 
 struct NetworkDataSingle {
   Buf data;
   TimePoint receiveTimePoint;
   size_t totalData{0};
+  EcnCodepoint ecnCodepoint{EcnCodepoint::NotEct};
 
   NetworkDataSingle() = default;
 
   NetworkDataSingle(
       std::unique_ptr<folly::IOBuf> buf,
-      const TimePoint& receiveTime)
-      : data(std::move(buf)), receiveTimePoint(receiveTime) {
+      const TimePoint& receiveTime,
+      EcnCodepoint ecn = EcnCodepoint::NotEct)
+      : data(std::move(buf)), receiveTimePoint(receiveTime), ecnCodepoint(ecn) {
     if (data) {
       totalData += data->computeChainDataLength();
     }
   }
 };
 
-// Data structure to represent outstanding retransmittable packets
-struct OutstandingPacket {
-  // Structure representing the frames that are outstanding including the header
-  // that was sent.
-  RegularQuicWritePacket packet;
-  // Time that the packet was sent.
-  TimePoint time;
-  // Size of the packet sent on the wire.
-  uint32_t encodedSize;
-  // Whether this packet has any data from stream 0
-  bool isHandshake;
-  // Total sent bytes on this connection including this packet itself when this
-  // packet is sent.
-  uint64_t totalBytesSent;
-  // Information regarding the last acked packet on this connection when this
-  // packet is sent.
-  struct LastAckedPacketInfo {
-    TimePoint sentTime;
-    TimePoint ackTime;
-    // Total sent bytes on this connection when the last acked packet is acked.
-    uint64_t totalBytesSent;
-    // Total acked bytes on this connection when last acked packet is acked,
-    // including the last acked packet.
-    uint64_t totalBytesAcked;
-
-    LastAckedPacketInfo(
-        TimePoint sentTimeIn,
-        TimePoint ackTimeIn,
-        uint64_t totalBytesSentIn,
-        uint64_t totalBytesAckedIn)
-        : sentTime(sentTimeIn),
-          ackTime(ackTimeIn),
-          totalBytesSent(totalBytesSentIn),
-          totalBytesAcked(totalBytesAckedIn) {}
-  };
-  folly::Optional<LastAckedPacketInfo> lastAckedPacketInfo;
-
-  // PacketEvent associated with this OutstandingPacket. This will be a
-  // folly::none if the packet isn't a clone and hasn't been cloned.
-  folly::Optional<PacketEvent> associatedEvent;
-
-  /**
-   * Whether the packet is sent when congestion controller is in app-limited
-   * state.
-   */
-  bool isAppLimited{false};
-
-  OutstandingPacket(
-      RegularQuicWritePacket packetIn,
-      TimePoint timeIn,
-      uint32_t encodedSizeIn,
-      bool isHandshakeIn,
-      uint64_t totalBytesSentIn)
-      : packet(std::move(packetIn)),
-        time(std::move(timeIn)),
-        encodedSize(encodedSizeIn),
-        isHandshake(isHandshakeIn),
-        totalBytesSent(totalBytesSentIn) {}
-};
-
 struct OutstandingsInfo {
-  // Sent packets which have not been acked. These are sorted by PacketNum.
-  std::deque<OutstandingPacket> packets;
+  // Sent packets which have not been acked or declared lost. Iteration visits
+  // them sorted by PacketNum, OutstandingPacketStore::packetsIn() gives access
+  // to the packets of a single packet number space.
+  OutstandingPacketStore packets;
 
   // All PacketEvents of this connection. If a OutstandingPacket doesn't have an
   // associatedEvent or if it's not in this set, there is no need to process its
@@ -228,6 +223,15 @@ struct Pacer {
    */
   virtual uint64_t getCachedWriteBatchSize() const = 0;
 
+  /**
+   * The departure time to stamp on the next packet with SCM_TXTIME, or none if
+   * it should leave right away. Only a pacer that leaves the spacing of the
+   * packets to the kernel returns a time.
+   */
+  virtual folly::Optional<TimePoint> getTxTime(TimePoint /* currentTime */) {
+    return folly::none;
+  }
+
   virtual void onPacketSent() = 0;
   virtual void onPacketsLoss() = 0;
 };
@@ -305,6 +309,10 @@ struct CongestionController {
     // The minimal RTT sample among packets acked by this AckEvent. This RTT
     // includes ack delay.
     folly::Optional<std::chrono::microseconds> mrttSample;
+    // Number of the acked packets that were marked with an ECT codepoint, and
+    // how many more packets the peer reported as CE marked with this ack.
+    uint64_t ecnMarkedPackets{0};
+    uint64_t ecnCeCount{0};
 
     struct AckPacket {
       // Packet sent time when this acked pakcet was first sent.
@@ -404,6 +412,21 @@ struct CongestionController {
    * state.
    */
   virtual bool isAppLimited() const = 0;
+
+  /**
+   * Starts from what a recent connection to the same peer measured instead of
+   * the initial window, see applyCachedCongestionState(). Controllers that
+   * cannot make use of it ignore it.
+   */
+  virtual void onCachedCongestionState(const CachedCongestionState&) {}
+
+  /**
+   * The bandwidth estimate in bytes per second, or zero for controllers that
+   * do not estimate it.
+   */
+  virtual uint64_t getBandwidthEstimate() const {
+    return 0;
+  }
 };
 
 struct QuicCryptoStream : public QuicStreamLike {
@@ -482,6 +505,9 @@ struct LossState {
   // Total number of bytes acked on this connection. If a packet is acked twice,
   // it won't be count twice. Pure acks packets are NOT included.
   uint64_t totalBytesAcked{0};
+  // Total number of ACK frames sent and received on this connection.
+  uint64_t totalAcksSent{0};
+  uint64_t totalAcksRecvd{0};
   // The total number of bytes sent on this connection when the last time a
   // packet is acked.
   uint64_t totalBytesSentAtLastAck{0};
@@ -508,6 +534,56 @@ class CongestionControllerFactory;
 class LoopDetectorCallback;
 class PendingPathRateLimiter;
 
+/**
+ * ECN validation of the path, RFC 9000 section 13.4.2. The first
+ * kEcnTestingPackets packets are marked to test the path. The marking goes on
+ * once an ACK_ECN frame validates them, and stops for good if they are all
+ * lost or the counts of the peer are wrong.
+ */
+struct EcnState {
+  enum class Validation : uint8_t {
+    // Marking the testing packets.
+    Testing,
+    // Waiting for the testing packets to be acked, not marking.
+    Unknown,
+    Capable,
+    Failed,
+  };
+  Validation validation{Validation::Testing};
+  // Number of testing packets sent, and how many of them were lost.
+  uint64_t testingPacketsSent{0};
+  uint64_t testingPacketsLost{0};
+};
+
+/**
+ * Unreliable datagrams (RFC 9221) waiting to be written to the peer or to be
+ * read by the app.
+ */
+struct DatagramState {
+  // The largest DATAGRAM frame the peer accepts, zero if the peer does not
+  // support datagrams.
+  uint64_t maxWriteFrameSize{0};
+  CircularDeque<Buf> writeBuffer;
+  CircularDeque<Buf> readBuffer;
+};
+
+/**
+ * The ack frequency extension, both what we asked the peer for and what the
+ * peer asked us for.
+ */
+struct AckFrequencyState {
+  // The min_ack_delay of the peer, none if it does not support ACK_FREQUENCY.
+  folly::Optional<std::chrono::microseconds> peerMinAckDelay;
+  // Sequence number of the next ACK_FREQUENCY frame we send.
+  uint64_t nextSequenceNumber{0};
+  // The last ACK_FREQUENCY frame we sent.
+  folly::Optional<AckFrequencyFrame> lastRequested;
+  // The ACK_FREQUENCY frame of the peer with the largest sequence number.
+  folly::Optional<AckFrequencyFrame> peerRequest;
+  // Set by an IMMEDIATE_ACK frame, the packet carrying it is acked right away.
+  bool immediateAckRequested{false};
+};
+
 struct QuicConnectionStateBase : public folly::DelayedDestruction {
   virtual ~QuicConnectionStateBase() = default;
 
@@ -519,6 +595,13 @@ struct QuicConnectionStateBase : public folly::DelayedDestruction {
   // Accessor to output buffer for continuous memory GSO writes
   BufAccessor* bufAccessor{nullptr};
 
+  // Buffers of the zero copy writes to the socket, when they are enabled.
+  ZeroCopyTracker* zeroCopyTracker{nullptr};
+
+  // Growth of the connection window by auto-tuning, against the budget of the
+  // server worker if there is one.
+  ReceiveWindowReservation receiveWindowReservation;
+
   std::unique_ptr<Handshake> handshakeLayer;
 
   // Crypto stream
@@ -673,6 +756,9 @@ struct QuicConnectionStateBase : public folly::DelayedDestruction {
 
   LossState lossState;
 
+  // ECN validation of the path.
+  EcnState ecnState;
+
   // This contains the ack and packet number related states for all three
   // packet number space.
   AckStates ackStates;
@@ -732,13 +818,6 @@ struct QuicConnectionStateBase : public folly::DelayedDestruction {
   // max_packet_size in Transport Parameters and PMTU
   uint64_t udpSendPacketLen{kDefaultUDPSendPacketLen};
 
-  struct PacketSchedulingState {
-    StreamId nextScheduledStream{0};
-    StreamId nextScheduledControlStream{0};
-  };
-
-  PacketSchedulingState schedulingState;
-
   // The packet number of the latest packet that contains a MaxDataFrame sent
   // out by us.
   folly::Optional<PacketNum> latestMaxDataPacket;
@@ -789,6 +868,10 @@ struct QuicConnectionStateBase : public folly::DelayedDestruction {
   // Whether or not both ends agree to use partial reliability
   bool partialReliabilityEnabled{false};
 
+  DatagramState datagramState;
+
+  AckFrequencyState ackFrequencyState;
+
   // Debug information. Currently only used to debug busy loop of Transport
   // WriteLooper.
   struct WriteDebugState {
@@ -830,6 +913,29 @@ struct QuicConnectionStateBase : public folly::DelayedDestruction {
 
 std::ostream& operator<<(std::ostream& os, const QuicConnectionStateBase& st);
 
+/**
+ * Memory held by a connection, see getConnectionMemoryUsage().
+ */
+struct ConnectionMemoryUsage {
+  // The connection state, the stream states and the containers they own,
+  // not counting the data buffered in them.
+  uint64_t stateBytes{0};
+  // Stream, crypto and datagram data buffered by the transport, whether it
+  // is waiting to be read, sent or acked.
+  uint64_t bufferedBytes{0};
+  uint64_t numStreams{0};
+};
+
+/**
+ * Walks the streams of the connection to account for its memory, so it is
+ * meant for audits rather than for every packet. stateSize is the size of
+ * the concrete connection state and of the object holding it, which the
+ * base class can't know.
+ */
+ConnectionMemoryUsage getConnectionMemoryUsage(
+    const QuicConnectionStateBase& conn,
+    size_t stateSize = sizeof(QuicConnectionStateBase));
+
 struct AckStateVersion {
   uint64_t initialAckStateVersion{kDefaultIntervalSetVersion};
   uint64_t handshakeAckStateVersion{kDefaultIntervalSetVersion};
@@ -12,21 +12,11 @@
 #include <quic/QuicConstants.h>
 #include <quic/codec/Types.h>
 #include <quic/common/SmallVec.h>
+#include <quic/state/QuicPriorityQueue.h>
+#include <quic/state/RetransmissionBuffer.h>
 
 namespace quic {
 
-struct StreamBuffer {
-  BufQueue data;
-  uint64_t offset;
-  bool eof{false};
-
-  StreamBuffer(Buf dataIn, uint64_t offsetIn, bool eofIn = false) noexcept
-      : data(std::move(dataIn)), offset(offsetIn), eof(eofIn) {}
-
-  StreamBuffer(StreamBuffer&& other) = default;
-  StreamBuffer& operator=(StreamBuffer&& other) = default;
-};
-
 struct QuicStreamLike {
   QuicStreamLike() = default;
 
@@ -36,34 +26,39 @@ struct QuicStreamLike {
 
   // List of bytes that have been read and buffered. We need to buffer
   // bytes in case we get bytes out of order.
-  std::deque<StreamBuffer> readBuffer;
+  CircularDeque<StreamBuffer> readBuffer;
 
   // List of bytes that have been written to the QUIC layer.
   BufQueue writeBuffer{};
 
-  // Stores a map of offset:buffers which have been written to the socket and
-  // are currently un-acked. Each one represents one StreamFrame that was
-  // written. We need to buffer these because these might be retransmitted in
-  // the future. These are associated with the starting offset of the buffer.
+  // Stores the buffers which have been written to the socket and are
+  // currently un-acked, keyed by offset. Each one represents one StreamFrame
+  // that was written. We need to buffer these because these might be
+  // retransmitted in the future. These are associated with the starting offset
+  // of the buffer.
   // Note: the offset in the StreamBuffer itself can be >= the offset on which
   // it is keyed due to partial reliability - when data is skipped the offset
   // in the StreamBuffer may be incremented, but the keyed offset must remain
   // the same so it can be removed from the buffer on ACK.
-  folly::F14FastMap<uint64_t, std::unique_ptr<StreamBuffer>>
-      retransmissionBuffer;
+  RetransmissionBuffer retransmissionBuffer;
 
   // Tracks intervals which we have received ACKs for. E.g. in the case of all
   // data being acked this would contain one internval from 0 -> the largest
   // offseet ACKed. This allows us to track which delivery callbacks can be
-  // called.
+  // called. Acks mostly arrive in order, so this is usually one interval.
   template <class T>
-  using IntervalSetVec = SmallVec<T, 32, uint16_t>;
+  using IntervalSetVec = SmallVec<T, 2, uint16_t>;
   using AckedIntervals = IntervalSet<uint64_t, 1, IntervalSetVec>;
   AckedIntervals ackedIntervals;
 
   // Stores a list of buffers which have been marked as loss by loss detector.
-  // Each one represents one StreamFrame that was written.
-  std::deque<StreamBuffer> lossBuffer;
+  // Each one represents one StreamFrame that was written. It is kept apart
+  // from the retransmissionBuffer: the schedulers walk it as the queue of data
+  // to resend, adjacent losses are coalesced into one buffer, and a partial
+  // retransmission moves the offset of what is left. Its buffers are moved out
+  // of the retransmissionBuffer, so the data is never held twice, and an empty
+  // CircularDeque allocates nothing.
+  CircularDeque<StreamBuffer> lossBuffer;
 
   // Current offset of the start bytes in the write buffer.
   // This changes when we pop stuff off the writeBuffer.
@@ -96,21 +91,27 @@ struct QuicStreamLike {
    * Either insert a new entry into the loss buffer, or merge the buffer with
    * an existing entry.
    */
-  void insertIntoLossBuffer(std::unique_ptr<StreamBuffer> buf) {
+  void insertIntoLossBuffer(StreamBuffer&& buf) {
     // We assume here that we won't try to insert an overlapping buffer, as
-    // that should never happen in the loss buffer.
-    auto lossItr = std::upper_bound(
-        lossBuffer.begin(),
-        lossBuffer.end(),
-        buf->offset,
-        [](auto offset, const auto& buffer) { return offset < buffer.offset; });
+    // that should never happen in the loss buffer. Losses are usually detected
+    // in offset order, so check the back before searching.
+    auto lossItr = lossBuffer.end();
+    if (!lossBuffer.empty() && buf.offset < lossBuffer.back().offset) {
+      lossItr = std::upper_bound(
+          lossBuffer.begin(),
+          lossBuffer.end(),
+          buf.offset,
+          [](auto offset, const auto& buffer) {
+            return offset < buffer.offset;
+          });
+    }
     if (!lossBuffer.empty() && lossItr != lossBuffer.begin() &&
         std::prev(lossItr)->offset + std::prev(lossItr)->data.chainLength() ==
-            buf->offset) {
-      std::prev(lossItr)->data.append(buf->data.move());
-      std::prev(lossItr)->eof = buf->eof;
+            buf.offset) {
+      std::prev(lossItr)->data.append(buf.data.move());
+      std::prev(lossItr)->eof = buf.eof;
     } else {
-      lossBuffer.insert(lossItr, std::move(*buf));
+      lossBuffer.insert(lossItr, std::move(buf));
     }
   }
 };
@@ -183,32 +184,37 @@ struct QuicStreamState : public QuicStreamLike {
   // Stream level write error occured.
   folly::Optional<QuicErrorCode> streamWriteError;
 
-  // State machine data
-  StreamSendState sendState{StreamSendState::Open_E};
-
-  // State machine data
-  StreamRecvState recvState{StreamRecvState::Open_E};
-
   // The packet number of the latest packet that contains a MaxStreamDataFrame
   // sent out by us.
   folly::Optional<PacketNum> latestMaxStreamDataPacket;
 
-  // Tells whether this stream is a control stream.
-  // It is set by the app via setControlStream and the transport can use this
-  // knowledge for optimizations e.g. for setting the app limited state on
-  // congestion control with control streams still active.
-  bool isControl{false};
-
   // The last time we detected we were head of line blocked on the stream.
   folly::Optional<Clock::time_point> lastHolbTime;
 
   // The total amount of time we are head line blocked on the stream.
   std::chrono::microseconds totalHolbTime{0us};
 
+  // The small fields are kept together to avoid padding between them.
+
   // Number of times the stream has entered the HOLB state
   // lastHolbTime indicates whether the stream is HOL blocked at the moment.
   uint32_t holbCount{0};
 
+  // State machine data
+  StreamSendState sendState{StreamSendState::Open_E};
+
+  // State machine data
+  StreamRecvState recvState{StreamRecvState::Open_E};
+
+  // Tells whether this stream is a control stream.
+  // It is set by the app via setControlStream and the transport can use this
+  // knowledge for optimizations e.g. for setting the app limited state on
+  // congestion control with control streams still active.
+  bool isControl{false};
+
+  // Scheduling priority of the stream, set by the app via setStreamPriority.
+  Priority priority{kDefaultPriority};
+
   // Returns true if both send and receive state machines are in a terminal
   // state
   bool inTerminalStates() const {
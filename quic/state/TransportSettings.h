@@ -39,6 +39,33 @@ struct BbrConfig {
   bool drainToTarget{false};
 };
 
+struct DatagramConfig {
+  // Whether to advertise max_datagram_frame_size and accept DATAGRAM frames.
+  bool enabled{false};
+  // Datagrams buffered until they are read or written. Once a buffer is full
+  // the oldest datagram in it is dropped to make room.
+  uint32_t readBufSize{kDefaultMaxDatagramsBuffered};
+  uint32_t writeBufSize{kDefaultMaxDatagramsBuffered};
+};
+
+struct AckFrequencyConfig {
+  // Whether to advertise min_ack_delay and accept ACK_FREQUENCY frames. The
+  // congestion controller asks a peer that advertised it for fewer acks.
+  bool enabled{false};
+  // The smallest ack delay the peer may ask for.
+  std::chrono::microseconds minAckDelay{kDefaultMinAckDelay};
+};
+
+struct CongestionStateCacheConfig {
+  // Whether to start connections from the RTT and congestion window that a
+  // recent connection to the same peer measured. A server worker keeps them
+  // for the peer address prefixes of its last maxEntries closed connections,
+  // a client along with the PSK of the server.
+  bool enabled{false};
+  size_t maxEntries{kDefaultCongestionStateCacheSize};
+  std::chrono::seconds maxAge{kDefaultCongestionStateMaxAge};
+};
+
 struct TransportSettings {
   // The initial connection window advertised to the peer.
   uint64_t advertisedInitialConnectionWindowSize{kDefaultConnectionWindowSize};
@@ -47,6 +74,16 @@ struct TransportSettings {
   uint64_t advertisedInitialBidiRemoteStreamWindowSize{
       kDefaultStreamWindowSize};
   uint64_t advertisedInitialUniStreamWindowSize{kDefaultStreamWindowSize};
+  // Double a receive window when the peer used it up in less than
+  // flowControlRttFrequency RTTs, so that the window keeps up with the BDP.
+  bool autoTuneReceiveWindows{false};
+  // Limits of the auto-tuned stream and connection receive windows.
+  uint64_t maxAutoTunedStreamWindowSize{kDefaultMaxAutoTunedStreamWindowSize};
+  uint64_t maxAutoTunedConnectionWindowSize{
+      kDefaultMaxAutoTunedConnectionWindowSize};
+  // Server only, the total growth of the connection windows of a worker.
+  uint64_t autoTunedWindowBudgetPerWorker{
+      kDefaultAutoTunedWindowBudgetPerWorker};
   uint64_t advertisedInitialMaxStreamsBidi{kDefaultMaxStreamsBidirectional};
   uint64_t advertisedInitialMaxStreamsUni{kDefaultMaxStreamsUnidirectional};
   // Maximum number of packets to buffer while cipher is unavailable.
@@ -85,6 +122,19 @@ struct TransportSettings {
   // Pacing timer tick interval
   std::chrono::microseconds pacingTimerTickInterval{
       kDefaultPacingTimerTickInterval};
+  // Stamp the paced packets with an SCM_TXTIME departure time and leave their
+  // spacing to the fq qdisc, writing up to txTimePacingHorizon worth of bursts
+  // at once instead of one burst per pacing timer tick. Turned off when the
+  // socket does not support SO_TXTIME.
+  bool txTimePacing{false};
+  std::chrono::microseconds txTimePacingHorizon{kDefaultTxTimePacingHorizon};
+  // Mark the packets ECN capable, echo the ECN codepoints of the packets of
+  // the peer, and let the congestion controller react to CE marks. The
+  // marking stops if the path fails ECN validation.
+  bool enableEcn{false};
+  // Mark the packets ECT(1) instead of ECT(0), and respond to CE marks in
+  // proportion to their fraction like L4S (RFC 9331) instead of like a loss.
+  bool useL4sEcn{false};
   ZeroRttSourceTokenMatchingPolicy zeroRttSourceTokenMatchingPolicy{
       ZeroRttSourceTokenMatchingPolicy::REJECT_IF_NO_EXACT_MATCH};
   bool attemptEarlyData{false};
@@ -105,11 +155,18 @@ struct TransportSettings {
   // use thread local batcher - currently it works only with
   // BATCHING_MODE_SENDMMSG_GSO it will not be enabled if the mode is different
   bool useThreadLocalBatching{false};
-  // thread local delay interval
+  // thread local delay interval. With a delay of zero, the packets written by
+  // all the connections of the thread during one event loop iteration are
+  // flushed together at the end of that iteration.
   std::chrono::microseconds threadLocalDelay{kDefaultThreadLocalDelay};
   // maximum number of packets we can batch. This does not apply to
   // BATCHING_MODE_NONE
   uint32_t maxBatchSize{kDefaultQuicMaxBatchSize};
+  // Write GSO batches of at least zeroCopyWriteThreshold bytes with
+  // MSG_ZEROCOPY. Only applies to BATCHING_MODE_GSO, and needs the socket
+  // error messages to learn when the kernel is done with the buffers.
+  bool enableZeroCopyWrites{false};
+  uint32_t zeroCopyWriteThreshold{kDefaultZeroCopyWriteThreshold};
   // Initial congestion window in MSS
   uint64_t initCwndInMss{kInitCwndInMss};
   // Minimum congestion window in MSS
@@ -140,6 +197,13 @@ struct TransportSettings {
   // default stateless reset secret for stateless reset token
   folly::Optional<std::array<uint8_t, kStatelessResetTokenSecretLength>>
       statelessResetTokenSecret;
+  // secret of the tokens of Retry packets and NEW_TOKEN frames, the server
+  // validates the address of a client that echoes one of them.
+  folly::Optional<std::array<uint8_t, kAddressTokenSecretLength>>
+      addressTokenSecret;
+  // Whether the server sends a NEW_TOKEN frame once the handshake is done, so
+  // the next connection from the client skips the Retry.
+  bool issueNewTokens{false};
   // Default initial RTT
   std::chrono::microseconds initialRtt{kDefaultInitialRtt};
   // The active_connection_id_limit that is sent to the peer.
@@ -166,6 +230,12 @@ struct TransportSettings {
   bool streamFramePerPacket{false};
   // Ensure read callbacks are ordered by Stream ID.
   bool orderedReadCallbacks{false};
+  // Config struct for unreliable datagrams
+  DatagramConfig datagramConfig;
+  // Config struct for the ack frequency extension
+  AckFrequencyConfig ackFrequencyConfig;
+  // Config struct for sharing congestion state across connections
+  CongestionStateCacheConfig congestionStateCacheConfig;
 };
 
 } // namespace quic
@@ -92,24 +92,23 @@ void sendAckSMHandler(
     case StreamSendState::Open_E: {
       // Clean up the acked buffers from the retransmissionBuffer.
       auto ackedBuffer = stream.retransmissionBuffer.find(ackedFrame.offset);
-      if (ackedBuffer != stream.retransmissionBuffer.end()) {
+      if (ackedBuffer) {
         if (streamFrameMatchesRetransmitBuffer(
-                stream, ackedFrame, *ackedBuffer->second)) {
+                stream, ackedFrame, *ackedBuffer)) {
           VLOG(10) << "Open: acked stream data stream=" << stream.id
-                   << " offset=" << ackedBuffer->second->offset
-                   << " len=" << ackedBuffer->second->data.chainLength()
-                   << " eof=" << ackedBuffer->second->eof << " " << stream.conn;
+                   << " offset=" << ackedBuffer->offset
+                   << " len=" << ackedBuffer->data.chainLength()
+                   << " eof=" << ackedBuffer->eof << " " << stream.conn;
           stream.ackedIntervals.insert(
-              ackedBuffer->second->offset,
-              ackedBuffer->second->offset +
-                  ackedBuffer->second->data.chainLength());
-          stream.retransmissionBuffer.erase(ackedBuffer);
+              ackedBuffer->offset,
+              ackedBuffer->offset + ackedBuffer->data.chainLength());
+          stream.retransmissionBuffer.erase(ackedFrame.offset);
         } else {
           VLOG(10)
               << "Open: received an ack for already discarded buffer; stream="
-              << stream.id << " offset=" << ackedBuffer->second->offset
-              << " len=" << ackedBuffer->second->data.chainLength()
-              << " eof=" << ackedBuffer->second->eof << " " << stream.conn;
+              << stream.id << " offset=" << ackedBuffer->offset
+              << " len=" << ackedBuffer->data.chainLength()
+              << " eof=" << ackedBuffer->eof << " " << stream.conn;
         }
       }
 
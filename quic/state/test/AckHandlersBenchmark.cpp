@@ -0,0 +1,91 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ *
+ */
+
+#include <folly/Benchmark.h>
+#include <folly/init/Init.h>
+
+#include <quic/common/test/TestUtils.h>
+#include <quic/state/AckHandlers.h>
+
+using namespace quic;
+
+namespace {
+
+// Packets covered by each ACK. Every other packet in the range is acked, so
+// every ACK carries kAckRangeSize / 2 blocks and the packets in the gaps are
+// declared lost by reordering.
+constexpr PacketNum kAckRangeSize = 64;
+
+void sendPackets(
+    QuicConnectionStateBase& conn,
+    PacketNum& nextPacketNum,
+    size_t numPackets) {
+  auto connId = test::getTestConnectionId();
+  for (size_t i = 0; i < numPackets; ++i) {
+    ShortHeader shortHeader(
+        ProtectionType::KeyPhaseZero, connId, nextPacketNum++);
+    RegularQuicWritePacket packet(std::move(shortHeader));
+    packet.frames.emplace_back(WriteStreamFrame(0, 0, 1000, false));
+    conn.outstandings.packets.emplace_back(
+        std::move(packet), Clock::now(), 1200, false, 0);
+  }
+}
+
+ReadAckFrame makeAckFrame(PacketNum firstPacketNum) {
+  ReadAckFrame ackFrame;
+  // Ack blocks are in descending order.
+  for (PacketNum offset = kAckRangeSize; offset > 0; offset -= 2) {
+    auto packetNum = firstPacketNum + offset - 1;
+    ackFrame.ackBlocks.emplace_back(packetNum, packetNum);
+  }
+  ackFrame.largestAcked = ackFrame.ackBlocks.front().endPacket;
+  return ackFrame;
+}
+
+/*
+ * Keeps numOutstanding packets in flight. Every iteration sends another
+ * kAckRangeSize packets and processes an ACK for the oldest kAckRangeSize
+ * outstanding ones.
+ */
+void processAcks(size_t iters, size_t numOutstanding) {
+  folly::BenchmarkSuspender suspender;
+  QuicConnectionStateBase conn(QuicNodeType::Server);
+  conn.congestionController = nullptr;
+  PacketNum nextPacketNum = 0;
+  PacketNum nextAckedPacketNum = 0;
+  sendPackets(conn, nextPacketNum, numOutstanding);
+  auto noopAckVisitor = [](auto&, auto&, auto&) {};
+  auto noopLossVisitor = [](auto&, auto&, bool, PacketNum) {};
+  for (size_t i = 0; i < iters; ++i) {
+    sendPackets(conn, nextPacketNum, kAckRangeSize);
+    auto ackFrame = makeAckFrame(nextAckedPacketNum);
+    nextAckedPacketNum += kAckRangeSize;
+    suspender.dismiss();
+    processAckFrame(
+        conn,
+        PacketNumberSpace::AppData,
+        ackFrame,
+        noopAckVisitor,
+        noopLossVisitor,
+        Clock::now());
+    suspender.rehire();
+  }
+  folly::doNotOptimizeAway(conn.outstandings.packets.size());
+}
+
+} // namespace
+
+BENCHMARK_PARAM(processAcks, 1000)
+BENCHMARK_PARAM(processAcks, 10000)
+BENCHMARK_PARAM(processAcks, 100000)
+
+int main(int argc, char** argv) {
+  folly::init(&argc, &argv);
+  folly::runBenchmarks();
+  return 0;
+}
@@ -914,6 +914,64 @@ TEST_P(AckHandlersTest, AckEventCreation) {
       ackTime);
 }
 
+TEST_P(AckHandlersTest, AckEcnCounts) {
+  QuicServerConnectionState conn;
+  conn.transportSettings.enableEcn = true;
+  auto mockCongestionController = std::make_unique<MockCongestionController>();
+  auto rawCongestionController = mockCongestionController.get();
+  conn.congestionController = std::move(mockCongestionController);
+
+  for (PacketNum packetNum = 0; packetNum < 10; packetNum++) {
+    auto regularPacket = createNewPacket(packetNum, GetParam());
+    WriteStreamFrame frame(packetNum, 0, 0, true);
+    regularPacket.frames.emplace_back(std::move(frame));
+    OutstandingPacket sentPacket(
+        std::move(regularPacket), Clock::now(), 1, false, packetNum);
+    sentPacket.isEcnMarked = true;
+    conn.outstandings.packets.emplace_back(std::move(sentPacket));
+  }
+
+  ReadAckFrame ackFrame;
+  ackFrame.largestAcked = 4;
+  ackFrame.ackBlocks.emplace_back(0, 4);
+  EcnCounts counts;
+  counts.ect0 = 3;
+  counts.ce = 2;
+  ackFrame.ecnCounts = counts;
+  EXPECT_CALL(*rawCongestionController, onPacketAckOrLoss(_, _))
+      .WillOnce(Invoke([&](auto ack, auto) {
+        EXPECT_EQ(5, ack->ecnMarkedPackets);
+        EXPECT_EQ(2, ack->ecnCeCount);
+      }));
+  processAckFrame(
+      conn,
+      GetParam(),
+      ackFrame,
+      [](const auto&, const auto&, const auto&) {},
+      [](auto&, auto&, bool, PacketNum) {},
+      Clock::now());
+  EXPECT_EQ(EcnState::Validation::Capable, conn.ecnState.validation);
+
+  // The next ack lost the ECT(0) marks of the newly acked packets.
+  ackFrame.largestAcked = 9;
+  ackFrame.ackBlocks.clear();
+  ackFrame.ackBlocks.emplace_back(0, 9);
+  EXPECT_CALL(*rawCongestionController, onPacketAckOrLoss(_, _))
+      .WillOnce(Invoke([&](auto ack, auto) {
+        EXPECT_EQ(5, ack->ecnMarkedPackets);
+        EXPECT_EQ(0, ack->ecnCeCount);
+      }));
+  processAckFrame(
+      conn,
+      GetParam(),
+      ackFrame,
+      [](const auto&, const auto&, const auto&) {},
+      [](auto&, auto&, bool, PacketNum) {},
+      Clock::now());
+  EXPECT_EQ(EcnState::Validation::Failed, conn.ecnState.validation);
+  EXPECT_EQ(EcnCodepoint::NotEct, getEcnCodepointToSend(conn));
+}
+
 INSTANTIATE_TEST_CASE_P(
     AckHandlersTests,
     AckHandlersTest,
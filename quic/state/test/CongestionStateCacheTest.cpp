@@ -0,0 +1,119 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ *
+ */
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <quic/state/CongestionStateCache.h>
+#include <quic/state/StateData.h>
+#include <quic/state/test/Mocks.h>
+
+using namespace quic;
+using namespace testing;
+
+namespace quic {
+namespace test {
+
+class CongestionStateCacheTest : public Test {
+ protected:
+  CachedCongestionState makeState(uint64_t cwndBytes, TimePoint recordTime) {
+    CachedCongestionState state;
+    state.srtt = 40ms;
+    state.minRtt = 30ms;
+    state.cwndBytes = cwndBytes;
+    state.recordTime = recordTime;
+    return state;
+  }
+
+  TimePoint now{Clock::now()};
+};
+
+TEST_F(CongestionStateCacheTest, PeersShareTheirPrefix) {
+  CongestionStateCache cache(10, 60s);
+  cache.put(folly::IPAddress("10.1.2.3"), makeState(1000, now));
+  cache.put(folly::IPAddress("2401:db00:1:2::1"), makeState(2000, now));
+
+  EXPECT_EQ(cache.get(folly::IPAddress("10.1.2.200"), now)->cwndBytes, 1000);
+  EXPECT_EQ(
+      cache.get(folly::IPAddress("::ffff:10.1.2.4"), now)->cwndBytes, 1000);
+  EXPECT_FALSE(cache.get(folly::IPAddress("10.1.3.3"), now));
+  EXPECT_EQ(
+      cache.get(folly::IPAddress("2401:db00:1:2a::5"), now)->cwndBytes, 2000);
+  EXPECT_FALSE(cache.get(folly::IPAddress("2401:db00:1:102::1"), now));
+
+  // The last connection to close wins.
+  cache.put(folly::IPAddress("10.1.2.9"), makeState(3000, now));
+  EXPECT_EQ(cache.get(folly::IPAddress("10.1.2.3"), now)->cwndBytes, 3000);
+  EXPECT_EQ(cache.size(), 2);
+}
+
+TEST_F(CongestionStateCacheTest, EvictsLeastRecentlyUsed) {
+  CongestionStateCache cache(2, 60s);
+  cache.put(folly::IPAddress("10.0.1.1"), makeState(1000, now));
+  cache.put(folly::IPAddress("10.0.2.1"), makeState(2000, now));
+  EXPECT_TRUE(cache.get(folly::IPAddress("10.0.1.1"), now));
+  cache.put(folly::IPAddress("10.0.3.1"), makeState(3000, now));
+  EXPECT_EQ(cache.size(), 2);
+  EXPECT_TRUE(cache.get(folly::IPAddress("10.0.1.1"), now));
+  EXPECT_FALSE(cache.get(folly::IPAddress("10.0.2.1"), now));
+  EXPECT_TRUE(cache.get(folly::IPAddress("10.0.3.1"), now));
+}
+
+TEST_F(CongestionStateCacheTest, DropsStaleStates) {
+  CongestionStateCache cache(10, 60s);
+  cache.put(folly::IPAddress("10.0.1.1"), makeState(1000, now));
+  EXPECT_TRUE(cache.get(folly::IPAddress("10.0.1.1"), now + 60s));
+  EXPECT_FALSE(cache.get(folly::IPAddress("10.0.1.1"), now + 61s));
+  EXPECT_EQ(cache.size(), 0);
+}
+
+TEST_F(CongestionStateCacheTest, GetAndApplyConnectionState) {
+  QuicConnectionStateBase conn(QuicNodeType::Server);
+  auto mockCongestionController =
+      std::make_unique<NiceMock<MockCongestionController>>();
+  auto rawCongestionController = mockCongestionController.get();
+  conn.congestionController = std::move(mockCongestionController);
+  EXPECT_FALSE(getCachedCongestionState(conn));
+
+  conn.lossState.srtt = 40ms;
+  conn.lossState.mrtt = 30ms;
+  EXPECT_CALL(*rawCongestionController, getCongestionWindow())
+      .WillRepeatedly(Return(50000));
+  EXPECT_CALL(*rawCongestionController, getBandwidthEstimate())
+      .WillRepeatedly(Return(1000000));
+  auto state = getCachedCongestionState(conn);
+  ASSERT_TRUE(state);
+  EXPECT_EQ(state->srtt, 40ms);
+  EXPECT_EQ(state->minRtt, 30ms);
+  EXPECT_EQ(state->cwndBytes, 50000);
+  EXPECT_EQ(state->bandwidth, 1000000);
+
+  QuicConnectionStateBase newConn(QuicNodeType::Server);
+  auto newCongestionController =
+      std::make_unique<NiceMock<MockCongestionController>>();
+  EXPECT_CALL(*newCongestionController, onCachedCongestionState(_))
+      .WillOnce(Invoke([&](const CachedCongestionState& cachedState) {
+        EXPECT_EQ(cachedState.cwndBytes, 50000);
+      }));
+  newConn.congestionController = std::move(newCongestionController);
+  EXPECT_TRUE(applyCachedCongestionState(newConn, *state));
+  EXPECT_EQ(newConn.transportSettings.initialRtt, 40ms);
+  // The first RTT sample is still taken as is.
+  EXPECT_EQ(newConn.lossState.srtt, 0us);
+}
+
+TEST_F(CongestionStateCacheTest, ApplyIgnoresStaleState) {
+  QuicConnectionStateBase conn(QuicNodeType::Client);
+  conn.transportSettings.congestionStateCacheConfig.maxAge = 60s;
+  auto state = makeState(50000, Clock::now() - 61s);
+  EXPECT_FALSE(applyCachedCongestionState(conn, state));
+  EXPECT_EQ(conn.transportSettings.initialRtt, kDefaultInitialRtt);
+}
+
+} // namespace test
+} // namespace quic
@@ -27,8 +27,16 @@ class MockQuicStats : public QuicTransportStatsCallback {
   MOCK_METHOD0(onPacketForwarded, void());
   MOCK_METHOD0(onForwardedPacketReceived, void());
   MOCK_METHOD0(onForwardedPacketProcessed, void());
+  MOCK_METHOD0(onPacketMisrouted, void());
+  MOCK_METHOD1(onWorkerHandoff, void(size_t));
+  MOCK_METHOD1(onWorkerHandoffBatch, void(size_t));
+  MOCK_METHOD0(onWorkerHandoffQueueFull, void());
+  MOCK_METHOD0(onReceiveBufferPoolHit, void());
+  MOCK_METHOD0(onReceiveBufferPoolMiss, void());
+  MOCK_METHOD1(onRecvBatch, void(size_t));
   MOCK_METHOD1(onClientInitialReceived, void(QuicVersion));
   MOCK_METHOD0(onConnectionRateLimited, void());
+  MOCK_METHOD0(onRetrySent, void());
   MOCK_METHOD0(onNewConnection, void());
   MOCK_METHOD1(onConnectionClose, void(folly::Optional<ConnectionCloseReason>));
   MOCK_METHOD0(onNewQuicStream, void());
@@ -39,11 +47,23 @@ class MockQuicStats : public QuicTransportStatsCallback {
   MOCK_METHOD0(onStatelessReset, void());
   MOCK_METHOD0(onStreamFlowControlUpdate, void());
   MOCK_METHOD0(onStreamFlowControlBlocked, void());
+  MOCK_METHOD1(onConnFlowControlWindowGrowth, void(uint64_t));
+  MOCK_METHOD1(onStreamFlowControlWindowGrowth, void(uint64_t));
+  MOCK_METHOD0(onConnFlowControlWindowGrowthLimited, void());
   MOCK_METHOD0(onCwndBlocked, void());
   MOCK_METHOD0(onPTO, void());
   MOCK_METHOD1(onRead, void(size_t));
   MOCK_METHOD1(onWrite, void(size_t));
   MOCK_METHOD1(onUDPSocketWriteError, void(SocketErrorType));
+  MOCK_METHOD1(onZeroCopyCompletion, void(size_t));
+  MOCK_METHOD1(onZeroCopyFallback, void(size_t));
+  MOCK_METHOD1(onDatagramRead, void(size_t));
+  MOCK_METHOD1(onDatagramWrite, void(size_t));
+  MOCK_METHOD0(onDatagramDroppedOnRead, void());
+  MOCK_METHOD0(onDatagramDroppedOnWrite, void());
+  MOCK_METHOD0(onTimerRescheduled, void());
+  MOCK_METHOD0(onCongestionStateCacheHit, void());
+  MOCK_METHOD0(onCongestionStateCacheMiss, void());
 };
 
 class MockQuicStatsFactory : public QuicTransportStatsCallbackFactory {
@@ -29,6 +29,8 @@ class MockCongestionController : public CongestionController {
   GMOCK_METHOD2_(, , , setAppIdle, void(bool, TimePoint));
   MOCK_METHOD0(setAppLimited, void());
   MOCK_CONST_METHOD0(isAppLimited, bool());
+  MOCK_METHOD1(onCachedCongestionState, void(const CachedCongestionState&));
+  MOCK_CONST_METHOD0(getBandwidthEstimate, uint64_t());
 };
 
 class MockPacer : public Pacer {
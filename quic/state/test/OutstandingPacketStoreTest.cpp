@@ -0,0 +1,215 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ *
+ */
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <quic/common/test/TestUtils.h>
+#include <quic/state/OutstandingPacketStore.h>
+
+using namespace quic;
+using namespace testing;
+
+namespace quic {
+namespace test {
+
+namespace {
+
+OutstandingPacket makeOutstandingPacket(
+    PacketNumberSpace pnSpace,
+    PacketNum packetNum) {
+  folly::Optional<PacketHeader> header;
+  switch (pnSpace) {
+    case PacketNumberSpace::Initial:
+      header = LongHeader(
+          LongHeader::Types::Initial,
+          getTestConnectionId(1),
+          getTestConnectionId(),
+          packetNum,
+          QuicVersion::QUIC_DRAFT);
+      break;
+    case PacketNumberSpace::Handshake:
+      header = LongHeader(
+          LongHeader::Types::Handshake,
+          getTestConnectionId(1),
+          getTestConnectionId(),
+          packetNum,
+          QuicVersion::QUIC_DRAFT);
+      break;
+    case PacketNumberSpace::AppData:
+      header = ShortHeader(
+          ProtectionType::KeyPhaseZero, getTestConnectionId(), packetNum);
+      break;
+  }
+  RegularQuicWritePacket packet(std::move(*header));
+  return OutstandingPacket(
+      std::move(packet), Clock::now(), packetNum, false, packetNum);
+}
+
+using SpaceAndPacketNum = std::pair<PacketNumberSpace, PacketNum>;
+
+std::vector<SpaceAndPacketNum> packetsInOrder(
+    const OutstandingPacketStore& store) {
+  std::vector<SpaceAndPacketNum> packets;
+  for (const auto& packet : store) {
+    packets.emplace_back(
+        packet.packet.header.getPacketNumberSpace(),
+        packet.packet.header.getPacketSequenceNum());
+  }
+  return packets;
+}
+
+} // namespace
+
+class OutstandingPacketStoreTest : public Test {};
+
+TEST_F(OutstandingPacketStoreTest, FindAndErase) {
+  OutstandingPacketBuffer packets;
+  EXPECT_TRUE(packets.empty());
+  for (PacketNum packetNum = 10; packetNum < 20; packetNum += 2) {
+    packets.insert(
+        makeOutstandingPacket(PacketNumberSpace::AppData, packetNum));
+  }
+  EXPECT_EQ(5, packets.size());
+  EXPECT_EQ(10, packets.firstPacketNum());
+  EXPECT_EQ(19, packets.endPacketNum());
+  ASSERT_NE(nullptr, packets.find(14));
+  EXPECT_EQ(14, packets.find(14)->encodedSize);
+  EXPECT_EQ(nullptr, packets.find(15));
+  EXPECT_EQ(nullptr, packets.find(9));
+  EXPECT_EQ(nullptr, packets.find(100));
+  EXPECT_EQ(14, packets.nextPacketNum(13));
+  EXPECT_EQ(12, *packets.prevPacketNum(14));
+
+  packets.erase(14);
+  EXPECT_EQ(nullptr, packets.find(14));
+  EXPECT_EQ(4, packets.size());
+  // Erasing the first packet trims the tombstones after it.
+  packets.erase(10);
+  EXPECT_EQ(12, packets.firstPacketNum());
+  packets.erase(12);
+  EXPECT_EQ(16, packets.firstPacketNum());
+  // Erasing the last packet trims the tombstones before it.
+  packets.erase(18);
+  EXPECT_EQ(17, packets.endPacketNum());
+  packets.erase(16);
+  EXPECT_TRUE(packets.empty());
+  EXPECT_EQ(packets.firstPacketNum(), packets.endPacketNum());
+}
+
+TEST_F(OutstandingPacketStoreTest, WrapAround) {
+  OutstandingPacketBuffer packets;
+  PacketNum nextPacketNum = 0;
+  // Keep a sliding window of 10 packets so the ring wraps many times without
+  // growing.
+  for (; nextPacketNum < 10; ++nextPacketNum) {
+    packets.insert(
+        makeOutstandingPacket(PacketNumberSpace::AppData, nextPacketNum));
+  }
+  for (; nextPacketNum < 1000; ++nextPacketNum) {
+    packets.insert(
+        makeOutstandingPacket(PacketNumberSpace::AppData, nextPacketNum));
+    packets.erase(nextPacketNum - 10);
+    EXPECT_EQ(10, packets.size());
+    EXPECT_EQ(nextPacketNum - 9, packets.firstPacketNum());
+  }
+  for (PacketNum packetNum = 990; packetNum < 1000; ++packetNum) {
+    ASSERT_NE(nullptr, packets.find(packetNum));
+    EXPECT_EQ(packetNum, packets.find(packetNum)->encodedSize);
+  }
+}
+
+TEST_F(OutstandingPacketStoreTest, InsertBeforeFirst) {
+  OutstandingPacketBuffer packets;
+  packets.insert(makeOutstandingPacket(PacketNumberSpace::AppData, 100));
+  packets.insert(makeOutstandingPacket(PacketNumberSpace::AppData, 50));
+  EXPECT_EQ(2, packets.size());
+  EXPECT_EQ(50, packets.firstPacketNum());
+  EXPECT_EQ(101, packets.endPacketNum());
+  EXPECT_NE(nullptr, packets.find(50));
+  EXPECT_NE(nullptr, packets.find(100));
+}
+
+TEST_F(OutstandingPacketStoreTest, MergedIteration) {
+  OutstandingPacketStore store;
+  store.emplace_back(makeOutstandingPacket(PacketNumberSpace::AppData, 0));
+  store.emplace_back(makeOutstandingPacket(PacketNumberSpace::Initial, 1));
+  store.emplace_back(makeOutstandingPacket(PacketNumberSpace::Handshake, 0));
+  store.emplace_back(makeOutstandingPacket(PacketNumberSpace::AppData, 2));
+  store.emplace_back(makeOutstandingPacket(PacketNumberSpace::Initial, 0));
+  EXPECT_EQ(5, store.size());
+  std::vector<SpaceAndPacketNum> expected = {
+      {PacketNumberSpace::Initial, 0},
+      {PacketNumberSpace::Handshake, 0},
+      {PacketNumberSpace::AppData, 0},
+      {PacketNumberSpace::Initial, 1},
+      {PacketNumberSpace::AppData, 2}};
+  EXPECT_EQ(expected, packetsInOrder(store));
+  EXPECT_EQ(
+      PacketNumberSpace::Initial,
+      store.front().packet.header.getPacketNumberSpace());
+  EXPECT_EQ(2, store.back().packet.header.getPacketSequenceNum());
+
+  std::vector<PacketNum> reversed;
+  for (auto it = store.rbegin(); it != store.rend(); ++it) {
+    reversed.push_back(it->packet.header.getPacketSequenceNum());
+  }
+  EXPECT_THAT(reversed, ElementsAre(2, 1, 0, 0, 0));
+}
+
+TEST_F(OutstandingPacketStoreTest, EraseDuringIteration) {
+  OutstandingPacketStore store;
+  for (PacketNum packetNum = 0; packetNum < 5; ++packetNum) {
+    store.emplace_back(
+        makeOutstandingPacket(PacketNumberSpace::Handshake, packetNum));
+    store.emplace_back(
+        makeOutstandingPacket(PacketNumberSpace::AppData, packetNum));
+  }
+  auto it = store.begin();
+  while (it != store.end()) {
+    if (it->packet.header.getPacketNumberSpace() ==
+        PacketNumberSpace::Handshake) {
+      it = store.erase(it);
+    } else {
+      ++it;
+    }
+  }
+  EXPECT_TRUE(store.packetsIn(PacketNumberSpace::Handshake).empty());
+  EXPECT_EQ(5, store.size());
+
+  store.erase(
+      store.find(PacketNumberSpace::AppData, 1),
+      store.find(PacketNumberSpace::AppData, 4));
+  std::vector<SpaceAndPacketNum> expected = {
+      {PacketNumberSpace::AppData, 0}, {PacketNumberSpace::AppData, 4}};
+  EXPECT_EQ(expected, packetsInOrder(store));
+  store.pop_front();
+  store.pop_back();
+  EXPECT_TRUE(store.empty());
+  EXPECT_EQ(store.begin(), store.end());
+}
+
+TEST_F(OutstandingPacketStoreTest, NextInSpace) {
+  OutstandingPacketStore store;
+  store.emplace_back(makeOutstandingPacket(PacketNumberSpace::AppData, 0));
+  store.emplace_back(makeOutstandingPacket(PacketNumberSpace::Handshake, 1));
+  store.emplace_back(makeOutstandingPacket(PacketNumberSpace::AppData, 2));
+  auto it = store.nextIn(PacketNumberSpace::AppData, store.begin());
+  ASSERT_NE(store.end(), it);
+  EXPECT_EQ(0, it->packet.header.getPacketSequenceNum());
+  it = store.nextIn(PacketNumberSpace::AppData, std::next(it));
+  ASSERT_NE(store.end(), it);
+  EXPECT_EQ(2, it->packet.header.getPacketSequenceNum());
+  EXPECT_EQ(
+      store.end(), store.nextIn(PacketNumberSpace::AppData, std::next(it)));
+  EXPECT_EQ(
+      store.end(), store.nextIn(PacketNumberSpace::Initial, store.begin()));
+}
+
+} // namespace test
+} // namespace quic
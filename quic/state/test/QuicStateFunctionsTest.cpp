@@ -33,19 +33,21 @@ bool verifyToScheduleAckTimeout(const QuicConnectionStateBase& conn) {
   return conn.pendingEvents.scheduleAckTimeout;
 }
 
-RegularQuicWritePacket makeTestShortPacket() {
+RegularQuicWritePacket makeTestShortPacket(PacketNum packetNum = 2) {
   ShortHeader header(
-      ProtectionType::KeyPhaseZero, getTestConnectionId(), 2 /* packetNum */);
+      ProtectionType::KeyPhaseZero, getTestConnectionId(), packetNum);
   RegularQuicWritePacket packet(std::move(header));
   return packet;
 }
 
-RegularQuicWritePacket makeTestLongPacket(LongHeader::Types type) {
+RegularQuicWritePacket makeTestLongPacket(
+    LongHeader::Types type,
+    PacketNum packetNum = 2) {
   LongHeader header(
       type,
       getTestConnectionId(0),
       getTestConnectionId(1),
-      2 /* packetNum */,
+      packetNum,
       QuicVersion::QUIC_DRAFT);
   RegularQuicWritePacket packet(std::move(header));
   return packet;
@@ -80,6 +82,21 @@ TEST_P(UpdateLargestReceivedPacketNumTest, ReceiveOld) {
       currentLargestReceived);
 }
 
+TEST_P(UpdateLargestReceivedPacketNumTest, ForgetSmallestAckBlocks) {
+  QuicServerConnectionState conn;
+  auto& ackState = getAckState(conn, GetParam());
+  // Every other packet, so each one is a block of its own.
+  for (PacketNum packetNum = 0; packetNum < 2 * kMaxAckBlocks + 20;
+       packetNum += 2) {
+    updateLargestReceivedPacketNum(ackState, packetNum, Clock::now());
+  }
+  EXPECT_EQ(ackState.acks.size(), kMaxAckBlocks);
+  EXPECT_EQ(ackState.acks.front().start, 20);
+  EXPECT_EQ(ackState.acks.back().start, 2 * kMaxAckBlocks + 18);
+  // The encoding kept up with the packets and the evictions.
+  EXPECT_TRUE(ackState.encodedAcks.isSyncedWith(ackState.acks));
+}
+
 INSTANTIATE_TEST_CASE_P(
     UpdateLargestReceivedPacketNumTests,
     UpdateLargestReceivedPacketNumTest,
@@ -273,6 +290,51 @@ TEST_P(UpdateAckStateTest, UpdateAckSendStateOnRecvPacketsRxLimit) {
   EXPECT_TRUE(verifyToScheduleAckTimeout(conn));
 }
 
+TEST_F(QuicStateFunctionsTest, AckFrequencyPacketTolerance) {
+  QuicConnectionStateBase conn(QuicNodeType::Client);
+  auto& ackState = conn.ackStates.appDataAckState;
+  conn.ackFrequencyState.peerRequest = AckFrequencyFrame(0, 30, 25000, true);
+  // Out of order packets don't trigger an ack with ignoreOrder.
+  for (size_t i = 0; i < 29; i++) {
+    updateAckSendStateOnRecvPacket(conn, ackState, true, true, false);
+    EXPECT_FALSE(verifyToAckImmediately(conn, ackState));
+  }
+  updateAckSendStateOnRecvPacket(conn, ackState, false, true, false);
+  EXPECT_TRUE(verifyToAckImmediately(conn, ackState));
+
+  conn.ackFrequencyState.immediateAckRequested = true;
+  updateAckSendStateOnRecvPacket(conn, ackState, false, true, false);
+  EXPECT_TRUE(verifyToAckImmediately(conn, ackState));
+  EXPECT_FALSE(conn.ackFrequencyState.immediateAckRequested);
+}
+
+TEST_F(QuicStateFunctionsTest, RequestPeerAckFrequency) {
+  QuicConnectionStateBase conn(QuicNodeType::Server);
+  conn.transportSettings.ackFrequencyConfig.enabled = true;
+  // The peer did not advertise min_ack_delay.
+  EXPECT_FALSE(requestPeerAckFrequency(conn, 100, 10ms));
+  EXPECT_TRUE(conn.pendingEvents.frames.empty());
+
+  conn.ackFrequencyState.peerMinAckDelay = 2ms;
+  EXPECT_TRUE(requestPeerAckFrequency(conn, 100, 10500us));
+  ASSERT_EQ(conn.pendingEvents.frames.size(), 1);
+  auto frame = *conn.pendingEvents.frames[0].asAckFrequencyFrame();
+  EXPECT_EQ(frame.sequenceNumber, 0);
+  EXPECT_EQ(frame.packetTolerance, 64);
+  EXPECT_EQ(frame.updateMaxAckDelay, 10000);
+
+  // Small changes don't send a new frame.
+  EXPECT_FALSE(requestPeerAckFrequency(conn, 120, 10900us));
+
+  // A new request replaces the one that was not sent yet.
+  EXPECT_TRUE(requestPeerAckFrequency(conn, 1, 1ms));
+  ASSERT_EQ(conn.pendingEvents.frames.size(), 1);
+  frame = *conn.pendingEvents.frames[0].asAckFrequencyFrame();
+  EXPECT_EQ(frame.sequenceNumber, 1);
+  EXPECT_EQ(frame.packetTolerance, kMinAckFrequencyPacketTolerance);
+  EXPECT_EQ(frame.updateMaxAckDelay, 2000);
+}
+
 TEST_P(UpdateAckStateTest, UpdateAckSendStateOnRecvPacketsNonRxLimit) {
   // Non-rx packets reach thresh
   QuicConnectionStateBase conn(QuicNodeType::Client);
@@ -548,13 +610,13 @@ TEST_F(QuicStateFunctionsTest, GetOutstandingPackets) {
   conn.outstandings.packets.emplace_back(
       makeTestShortPacket(), Clock::now(), 5556, false, 0);
   conn.outstandings.packets.emplace_back(
-      makeTestLongPacket(LongHeader::Types::Initial),
+      makeTestLongPacket(LongHeader::Types::Initial, 3),
       Clock::now(),
       56,
       false,
       0);
   conn.outstandings.packets.emplace_back(
-      makeTestShortPacket(), Clock::now(), 6665, false, 0);
+      makeTestShortPacket(3), Clock::now(), 6665, false, 0);
   EXPECT_EQ(
       135,
       getFirstOutstandingPacket(conn, PacketNumberSpace::Initial)->encodedSize);
@@ -651,6 +713,23 @@ TEST_P(QuicStateFunctionsTest, CloseTranportStateChange) {
   EXPECT_TRUE(conn.pendingEvents.closeTransport);
 }
 
+TEST_F(QuicStateFunctionsTest, HandleDatagramDropsOldest) {
+  QuicConnectionStateBase conn(QuicNodeType::Server);
+  DatagramFrame frame(1, folly::IOBuf::copyBuffer("a"));
+  EXPECT_THROW(handleDatagram(conn, frame), QuicTransportException);
+
+  conn.transportSettings.datagramConfig.enabled = true;
+  conn.transportSettings.datagramConfig.readBufSize = 2;
+  for (auto data : {"a", "b", "c"}) {
+    DatagramFrame datagram(1, folly::IOBuf::copyBuffer(data));
+    handleDatagram(conn, datagram);
+  }
+  auto& readBuffer = conn.datagramState.readBuffer;
+  ASSERT_EQ(readBuffer.size(), 2);
+  EXPECT_EQ(readBuffer[0]->moveToFbString(), "b");
+  EXPECT_EQ(readBuffer[1]->moveToFbString(), "c");
+}
+
 INSTANTIATE_TEST_CASE_P(
     QuicStateFunctionsTests,
     QuicStateFunctionsTest,
@@ -25,7 +25,7 @@ namespace test {
 
 constexpr uint8_t kStreamIncrement = 0x04;
 
-using PeekIterator = std::deque<StreamBuffer>::const_iterator;
+using PeekIterator = CircularDeque<StreamBuffer>::const_iterator;
 
 class QuicStreamFunctionsTest : public Test {
  public:
@@ -97,6 +97,27 @@ TEST_F(QuicStreamFunctionsTest, TestCreateBoth) {
   }
 }
 
+TEST_F(QuicStreamFunctionsTest, MemoryUsage) {
+  auto idleUsage = getConnectionMemoryUsage(conn);
+  EXPECT_EQ(idleUsage.numStreams, 0);
+  EXPECT_EQ(idleUsage.bufferedBytes, 0);
+  EXPECT_GE(idleUsage.stateBytes, sizeof(QuicConnectionStateBase));
+
+  auto stream = conn.streamManager->createNextBidirectionalStream().value();
+  // An idle stream allocates nothing for its buffers.
+  EXPECT_EQ(stream->readBuffer.capacity(), 0);
+  EXPECT_EQ(stream->lossBuffer.capacity(), 0);
+  EXPECT_EQ(stream->retransmissionBuffer.getAllocatedMemorySize(), 0);
+
+  writeDataToQuicStream(*stream, IOBuf::copyBuffer("I just met you"), false);
+  appendDataToReadBuffer(
+      *stream, StreamBuffer(IOBuf::copyBuffer("and this is crazy"), 5));
+  auto usage = getConnectionMemoryUsage(conn);
+  EXPECT_EQ(usage.numStreams, 1);
+  EXPECT_EQ(usage.bufferedBytes, 14 + 17);
+  EXPECT_GT(usage.stateBytes, idleUsage.stateBytes);
+}
+
 TEST_F(QuicStreamFunctionsTest, TestWriteStream) {
   auto stream = conn.streamManager->createNextBidirectionalStream().value();
   auto buf1 = IOBuf::copyBuffer("I just met you");
@@ -1817,7 +1838,7 @@ TEST_F(QuicStreamFunctionsTest, AllBytesTillFinAckedStillRetransmitting) {
   QuicStreamState stream(id, conn);
   stream.finalWriteOffset = 12;
   stream.retransmissionBuffer.emplace(
-      0, std::make_unique<StreamBuffer>(IOBuf::create(10), 10, false));
+      0, StreamBuffer(IOBuf::create(10), 10, false));
   EXPECT_FALSE(allBytesTillFinAcked(stream));
 }
 
@@ -1994,7 +2015,7 @@ TEST_F(QuicStreamFunctionsTest, WritableList) {
 TEST_F(QuicStreamFunctionsTest, AckCryptoStream) {
   auto chlo = IOBuf::copyBuffer("CHLO");
   conn.cryptoState->handshakeStream.retransmissionBuffer.emplace(
-      0, std::make_unique<StreamBuffer>(chlo->clone(), 0));
+      0, StreamBuffer(chlo->clone(), 0));
   processCryptoStreamAck(conn.cryptoState->handshakeStream, 0, chlo->length());
   EXPECT_EQ(conn.cryptoState->handshakeStream.retransmissionBuffer.size(), 0);
 }
@@ -2002,8 +2023,7 @@ TEST_F(QuicStreamFunctionsTest, AckCryptoStream) {
 TEST_F(QuicStreamFunctionsTest, AckCryptoStreamOffsetLengthMismatch) {
   auto chlo = IOBuf::copyBuffer("CHLO");
   auto& cryptoStream = conn.cryptoState->handshakeStream;
-  cryptoStream.retransmissionBuffer.emplace(
-      0, std::make_unique<StreamBuffer>(chlo->clone(), 0));
+  cryptoStream.retransmissionBuffer.emplace(0, StreamBuffer(chlo->clone(), 0));
   processCryptoStreamAck(cryptoStream, 1, chlo->length());
   EXPECT_EQ(cryptoStream.retransmissionBuffer.size(), 1);
 
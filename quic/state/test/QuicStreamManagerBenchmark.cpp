@@ -0,0 +1,149 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ *
+ */
+
+#include <folly/Benchmark.h>
+#include <folly/container/F14Map.h>
+#include <folly/init/Init.h>
+
+#include <quic/server/state/ServerStateMachine.h>
+#include <quic/state/QuicStreamManager.h>
+
+#include <deque>
+
+using namespace quic;
+
+namespace {
+
+constexpr size_t kNumConcurrentStreams = 10000;
+
+// What QuicStreamManager kept its streams in before QuicStreamTable.
+using StreamMap = folly::F14FastMap<StreamId, QuicStreamState>;
+
+void emplace(StreamMap& streams, StreamId id, QuicConnectionStateBase& conn) {
+  streams.emplace(
+      std::piecewise_construct,
+      std::forward_as_tuple(id),
+      std::forward_as_tuple(id, conn));
+}
+
+QuicStreamState* find(StreamMap& streams, StreamId id) {
+  auto itr = streams.find(id);
+  return itr == streams.end() ? nullptr : &itr->second;
+}
+
+void emplace(
+    QuicStreamTable& streams,
+    StreamId id,
+    QuicConnectionStateBase& conn) {
+  streams.emplace(id, conn);
+}
+
+QuicStreamState* find(QuicStreamTable& streams, StreamId id) {
+  return streams.find(id);
+}
+
+/*
+ * Looks up each of kNumConcurrentStreams open streams in turn, like the read
+ * path does for every stream frame.
+ */
+template <typename Streams>
+void lookup(size_t iters) {
+  folly::BenchmarkSuspender suspender;
+  QuicServerConnectionState conn;
+  Streams streams;
+  for (size_t i = 0; i < kNumConcurrentStreams; ++i) {
+    emplace(streams, i * detail::kStreamIncrement, conn);
+  }
+  suspender.dismiss();
+  for (size_t i = 0; i < iters; ++i) {
+    StreamId id = (i % kNumConcurrentStreams) * detail::kStreamIncrement;
+    folly::doNotOptimizeAway(find(streams, id));
+  }
+}
+
+/*
+ * Keeps kNumConcurrentStreams streams open. Every iteration opens another
+ * one, finds it and closes the oldest.
+ */
+template <typename Streams>
+void churn(size_t iters) {
+  folly::BenchmarkSuspender suspender;
+  QuicServerConnectionState conn;
+  Streams streams;
+  StreamId nextId = 0;
+  for (size_t i = 0; i < kNumConcurrentStreams; ++i) {
+    emplace(streams, nextId, conn);
+    nextId += detail::kStreamIncrement;
+  }
+  StreamId oldestId = 0;
+  suspender.dismiss();
+  for (size_t i = 0; i < iters; ++i) {
+    emplace(streams, nextId, conn);
+    folly::doNotOptimizeAway(find(streams, nextId));
+    streams.erase(oldestId);
+    nextId += detail::kStreamIncrement;
+    oldestId += detail::kStreamIncrement;
+  }
+}
+
+/*
+ * Opens and closes streams through QuicStreamManager with
+ * kNumConcurrentStreams of them open.
+ */
+void managerChurn(size_t iters) {
+  folly::BenchmarkSuspender suspender;
+  QuicServerConnectionState conn;
+  auto& manager = *conn.streamManager;
+  manager.setMaxLocalBidirectionalStreams(kMaxMaxStreams);
+  std::deque<StreamId> openIds;
+  for (size_t i = 0; i < kNumConcurrentStreams; ++i) {
+    openIds.push_back(manager.createNextBidirectionalStream().value()->id);
+  }
+  suspender.dismiss();
+  for (size_t i = 0; i < iters; ++i) {
+    openIds.push_back(manager.createNextBidirectionalStream().value()->id);
+    folly::doNotOptimizeAway(manager.getStream(openIds.back()));
+    auto stream = manager.getStream(openIds.front());
+    stream->sendState = StreamSendState::Closed_E;
+    stream->recvState = StreamRecvState::Closed_E;
+    manager.removeClosedStream(openIds.front());
+    openIds.pop_front();
+  }
+}
+
+} // namespace
+
+BENCHMARK(lookupF14Map, iters) {
+  lookup<StreamMap>(iters);
+}
+
+BENCHMARK_RELATIVE(lookupStreamTable, iters) {
+  lookup<QuicStreamTable>(iters);
+}
+
+BENCHMARK_DRAW_LINE();
+
+BENCHMARK(churnF14Map, iters) {
+  churn<StreamMap>(iters);
+}
+
+BENCHMARK_RELATIVE(churnStreamTable, iters) {
+  churn<QuicStreamTable>(iters);
+}
+
+BENCHMARK_DRAW_LINE();
+
+BENCHMARK(streamManagerChurn, iters) {
+  managerChurn(iters);
+}
+
+int main(int argc, char** argv) {
+  folly::init(&argc, &argv);
+  folly::runBenchmarks();
+  return 0;
+}
@@ -306,5 +306,78 @@ TEST_F(QuicStreamManagerTest, TestClearActionable) {
   EXPECT_TRUE(manager.peekableStreams().empty());
 }
 
+TEST_F(QuicStreamManagerTest, WritableStreamPriority) {
+  auto& manager = *conn.streamManager;
+  auto stream1 = manager.createNextBidirectionalStream().value();
+  auto stream2 = manager.createNextBidirectionalStream().value();
+  EXPECT_EQ(stream1->priority, kDefaultPriority);
+
+  manager.addWritable(*stream1);
+  manager.addWritable(*stream2);
+  EXPECT_EQ(
+      manager.writableStreams().getNextScheduledStream().value(), stream1->id);
+
+  // Raising the priority of a writable stream moves it ahead in the queue.
+  manager.setStreamPriority(stream2->id, 0, false);
+  EXPECT_EQ(stream2->priority, Priority(0, false));
+  EXPECT_EQ(
+      manager.writableStreams().getNextScheduledStream().value(), stream2->id);
+  EXPECT_EQ(manager.writableStreams().size(), 2);
+
+  manager.removeWritable(*stream2);
+  EXPECT_FALSE(manager.writableContains(stream2->id));
+  EXPECT_EQ(
+      manager.writableStreams().getNextScheduledStream().value(), stream1->id);
+}
+
+TEST_F(QuicStreamManagerTest, SequentialStreamKeepsItsPlace) {
+  auto& manager = *conn.streamManager;
+  auto stream1 = manager.createNextBidirectionalStream().value();
+  auto stream2 = manager.createNextBidirectionalStream().value();
+  auto stream3 = manager.createNextBidirectionalStream().value();
+  manager.setStreamPriority(stream1->id, 3, false);
+  manager.setStreamPriority(stream2->id, 3, false);
+  manager.setStreamPriority(stream3->id, 3, false);
+  manager.addWritable(*stream1);
+  manager.addWritable(*stream2);
+  manager.addWritable(*stream3);
+
+  // stream1 runs out of data, then becomes writable again after the others.
+  manager.removeWritable(*stream1);
+  manager.addWritable(*stream1);
+  std::vector<StreamId> order;
+  manager.writableStreams().schedule([&](StreamId id) {
+    order.push_back(id);
+    return true;
+  });
+  EXPECT_EQ(
+      order,
+      std::vector<StreamId>({stream1->id, stream2->id, stream3->id}));
+
+  // Same for a stream in the middle of the bucket.
+  manager.removeWritable(*stream2);
+  manager.addWritable(*stream2);
+  order.clear();
+  manager.writableStreams().schedule([&](StreamId id) {
+    order.push_back(id);
+    return true;
+  });
+  EXPECT_EQ(
+      order,
+      std::vector<StreamId>({stream1->id, stream2->id, stream3->id}));
+}
+
+TEST_F(QuicStreamManagerTest, SetControlStreamMovesWritable) {
+  auto& manager = *conn.streamManager;
+  auto stream = manager.createNextBidirectionalStream().value();
+  manager.addWritable(*stream);
+  EXPECT_EQ(manager.writableStreams().count(stream->id), 1);
+
+  manager.setStreamAsControl(*stream);
+  EXPECT_EQ(manager.writableStreams().count(stream->id), 0);
+  EXPECT_EQ(manager.writableControlStreams().count(stream->id), 1);
+  EXPECT_TRUE(manager.writableContains(stream->id));
+}
+
 } // namespace test
 } // namespace quic
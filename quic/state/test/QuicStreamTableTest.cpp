@@ -0,0 +1,126 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ *
+ */
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <quic/state/QuicStreamTable.h>
+#include <quic/state/StateData.h>
+
+#include <algorithm>
+
+using namespace quic;
+using namespace testing;
+
+namespace quic {
+namespace test {
+
+class QuicStreamTableTest : public Test {
+ protected:
+  std::vector<StreamId> streamIds() const {
+    std::vector<StreamId> ids;
+    table.forEach(
+        [&](const QuicStreamState& stream) { ids.push_back(stream.id); });
+    std::sort(ids.begin(), ids.end());
+    return ids;
+  }
+
+  QuicConnectionStateBase conn{QuicNodeType::Server};
+  QuicStreamTable table;
+};
+
+TEST_F(QuicStreamTableTest, EmplaceAndFind) {
+  EXPECT_TRUE(table.empty());
+  EXPECT_EQ(nullptr, table.find(0));
+  for (StreamId id : {0, 4, 8, 1, 2, 3}) {
+    auto result = table.emplace(id, conn);
+    EXPECT_TRUE(result.second);
+    EXPECT_EQ(result.first->id, id);
+  }
+  EXPECT_EQ(table.size(), 6);
+  for (StreamId id : {0, 4, 8, 1, 2, 3}) {
+    ASSERT_NE(nullptr, table.find(id));
+    EXPECT_EQ(table.find(id)->id, id);
+  }
+  EXPECT_EQ(nullptr, table.find(12));
+  EXPECT_EQ(nullptr, table.find(5));
+
+  auto existing = table.find(4);
+  auto result = table.emplace(4, conn);
+  EXPECT_FALSE(result.second);
+  EXPECT_EQ(result.first, existing);
+  EXPECT_EQ(table.size(), 6);
+}
+
+TEST_F(QuicStreamTableTest, Erase) {
+  for (StreamId id = 0; id < 40; id += 4) {
+    table.emplace(id, conn);
+  }
+  EXPECT_TRUE(table.erase(0));
+  EXPECT_TRUE(table.erase(20));
+  EXPECT_TRUE(table.erase(36));
+  EXPECT_FALSE(table.erase(36));
+  EXPECT_FALSE(table.erase(40));
+  EXPECT_EQ(nullptr, table.find(20));
+  EXPECT_EQ(table.size(), 7);
+  EXPECT_THAT(streamIds(), ElementsAre(4, 8, 12, 16, 24, 28, 32));
+
+  // Streams can come back below and above the remaining ones.
+  table.emplace(0, conn);
+  table.emplace(36, conn);
+  EXPECT_THAT(streamIds(), ElementsAre(0, 4, 8, 12, 16, 24, 28, 32, 36));
+
+  table.clear();
+  EXPECT_TRUE(table.empty());
+  EXPECT_EQ(nullptr, table.find(4));
+}
+
+TEST_F(QuicStreamTableTest, PointersStayValid) {
+  auto first = table.emplace(0, conn).first;
+  for (StreamId id = 4; id < 4 * 10000; id += 4) {
+    table.emplace(id, conn);
+  }
+  EXPECT_EQ(table.find(0), first);
+  EXPECT_EQ(first->id, 0);
+}
+
+TEST_F(QuicStreamTableTest, SparseIds) {
+  table.emplace(0, conn);
+  table.emplace(4 * 100000, conn);
+  table.emplace(4 * 50000, conn);
+  EXPECT_EQ(table.size(), 3);
+  EXPECT_EQ(table.find(4 * 100000)->id, 4 * 100000);
+  EXPECT_EQ(table.find(4 * 50000)->id, 4 * 50000);
+  EXPECT_EQ(nullptr, table.find(4 * 99999));
+  EXPECT_THAT(streamIds(), ElementsAre(0, 4 * 50000, 4 * 100000));
+  // The window does not reach out to the sparse streams.
+  EXPECT_LT(
+      table.getAllocatedMemorySize(), 3 * sizeof(QuicStreamState) + 4096);
+
+  EXPECT_TRUE(table.erase(4 * 100000));
+  EXPECT_TRUE(table.erase(0));
+  EXPECT_TRUE(table.erase(4 * 50000));
+  EXPECT_TRUE(table.empty());
+}
+
+TEST_F(QuicStreamTableTest, LongLivedStreamDoesNotPinWindow) {
+  auto control = table.emplace(0, conn).first;
+  for (StreamId id = 4; id < 4 * 100000; id += 4) {
+    table.emplace(id, conn);
+    if (id > 4 * 10) {
+      table.erase(id - 4 * 10);
+    }
+  }
+  EXPECT_EQ(table.find(0), control);
+  EXPECT_EQ(table.size(), 11);
+  // A window over every id since the control stream would take 800KB.
+  EXPECT_LT(table.getAllocatedMemorySize(), 100000);
+}
+
+} // namespace test
+} // namespace quic
@@ -0,0 +1,157 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ *
+ */
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <quic/state/RetransmissionBuffer.h>
+
+using namespace quic;
+using namespace testing;
+
+namespace quic {
+namespace test {
+
+namespace {
+
+StreamBuffer makeBuffer(uint64_t offset, size_t len, bool eof = false) {
+  return StreamBuffer(
+      folly::IOBuf::copyBuffer(std::string(len, 'a')), offset, eof);
+}
+
+std::vector<uint64_t> bufferOffsets(const RetransmissionBuffer& buffers) {
+  std::vector<uint64_t> offsets;
+  for (const auto& buffer : buffers) {
+    offsets.push_back(buffer.offset);
+  }
+  return offsets;
+}
+
+} // namespace
+
+TEST(RetransmissionBufferTest, EmplaceAndFind) {
+  RetransmissionBuffer buffers;
+  EXPECT_TRUE(buffers.empty());
+  EXPECT_EQ(nullptr, buffers.find(0));
+  EXPECT_TRUE(buffers.emplace(0, makeBuffer(0, 10)));
+  EXPECT_TRUE(buffers.emplace(10, makeBuffer(10, 10)));
+  EXPECT_TRUE(buffers.emplace(20, makeBuffer(20, 0, true)));
+  EXPECT_FALSE(buffers.emplace(10, makeBuffer(10, 5)));
+  EXPECT_EQ(3, buffers.size());
+
+  ASSERT_NE(nullptr, buffers.find(10));
+  EXPECT_EQ(10, buffers.find(10)->data.chainLength());
+  EXPECT_TRUE(buffers.at(20).eof);
+  EXPECT_EQ(nullptr, buffers.find(5));
+  EXPECT_EQ(nullptr, buffers.find(30));
+  EXPECT_THAT(bufferOffsets(buffers), ElementsAre(0, 10, 20));
+}
+
+TEST(RetransmissionBufferTest, EraseOutOfOrder) {
+  RetransmissionBuffer buffers;
+  for (uint64_t offset = 0; offset < 50; offset += 10) {
+    buffers.emplace(offset, makeBuffer(offset, 10));
+  }
+  buffers.erase(20);
+  EXPECT_EQ(4, buffers.size());
+  EXPECT_EQ(nullptr, buffers.find(20));
+  EXPECT_THAT(bufferOffsets(buffers), ElementsAre(0, 10, 30, 40));
+
+  // Erasing twice is harmless.
+  buffers.erase(20);
+  EXPECT_EQ(4, buffers.size());
+
+  buffers.erase(0);
+  buffers.erase(10);
+  buffers.erase(40);
+  EXPECT_THAT(bufferOffsets(buffers), ElementsAre(30));
+  buffers.erase(30);
+  EXPECT_TRUE(buffers.empty());
+  EXPECT_TRUE(buffers.begin() == buffers.end());
+}
+
+TEST(RetransmissionBufferTest, ReinsertLostData) {
+  RetransmissionBuffer buffers;
+  for (uint64_t offset = 0; offset < 40; offset += 10) {
+    buffers.emplace(offset, makeBuffer(offset, 10));
+  }
+  // The data at 10 is lost and retransmitted in two frames.
+  buffers.erase(10);
+  EXPECT_TRUE(buffers.emplace(10, makeBuffer(10, 5)));
+  EXPECT_TRUE(buffers.emplace(15, makeBuffer(15, 5)));
+  EXPECT_THAT(bufferOffsets(buffers), ElementsAre(0, 10, 15, 20, 30));
+
+  // So is the data at 0, after it was trimmed from the front.
+  buffers.erase(0);
+  EXPECT_TRUE(buffers.emplace(0, makeBuffer(0, 10)));
+  EXPECT_THAT(bufferOffsets(buffers), ElementsAre(0, 10, 15, 20, 30));
+  EXPECT_EQ(5, buffers.size());
+}
+
+TEST(RetransmissionBufferTest, InsertBetweenEntries) {
+  RetransmissionBuffer buffers;
+  for (uint64_t offset = 0; offset < 40; offset += 10) {
+    buffers.emplace(offset, makeBuffer(offset, 10));
+  }
+  // The data at 10 is lost, its first half is retransmitted on its tombstone
+  // and the rest goes between the entries.
+  buffers.erase(10);
+  EXPECT_TRUE(buffers.emplace(10, makeBuffer(10, 5)));
+  EXPECT_TRUE(buffers.emplace(15, makeBuffer(15, 5)));
+  // The data at 30 is lost and its tombstone trimmed before more data is
+  // written.
+  buffers.erase(30);
+  EXPECT_TRUE(buffers.emplace(40, makeBuffer(40, 10)));
+  EXPECT_TRUE(buffers.emplace(30, makeBuffer(30, 10)));
+  EXPECT_FALSE(buffers.emplace(15, makeBuffer(15, 5)));
+  EXPECT_FALSE(buffers.emplace(30, makeBuffer(30, 10)));
+  EXPECT_EQ(6, buffers.size());
+  EXPECT_THAT(bufferOffsets(buffers), ElementsAre(0, 10, 15, 20, 30, 40));
+  std::vector<uint64_t> keys;
+  for (auto itr = buffers.begin(); itr != buffers.end(); ++itr) {
+    keys.push_back(itr.key());
+  }
+  EXPECT_THAT(keys, ElementsAre(0, 10, 15, 20, 30, 40));
+  ASSERT_NE(nullptr, buffers.find(15));
+  EXPECT_EQ(5, buffers.find(15)->data.chainLength());
+  ASSERT_NE(nullptr, buffers.find(30));
+  EXPECT_EQ(30, buffers.at(30).offset);
+
+  buffers.erase(15);
+  EXPECT_EQ(nullptr, buffers.find(15));
+  EXPECT_EQ(5, buffers.size());
+  buffers.trimBefore(35);
+  EXPECT_THAT(bufferOffsets(buffers), ElementsAre(35, 40));
+  EXPECT_EQ(35, buffers.at(30).offset);
+  buffers.erase(30);
+  buffers.erase(40);
+  EXPECT_TRUE(buffers.empty());
+  EXPECT_TRUE(buffers.begin() == buffers.end());
+}
+
+TEST(RetransmissionBufferTest, TrimBefore) {
+  RetransmissionBuffer buffers;
+  for (uint64_t offset = 0; offset < 40; offset += 10) {
+    buffers.emplace(offset, makeBuffer(offset, 10));
+  }
+  buffers.trimBefore(25);
+  EXPECT_EQ(2, buffers.size());
+  EXPECT_EQ(nullptr, buffers.find(10));
+  // The trimmed buffer keeps its key.
+  ASSERT_NE(nullptr, buffers.find(20));
+  EXPECT_EQ(25, buffers.find(20)->offset);
+  EXPECT_EQ(5, buffers.find(20)->data.chainLength());
+  EXPECT_THAT(bufferOffsets(buffers), ElementsAre(25, 30));
+
+  buffers.erase(20);
+  buffers.erase(30);
+  EXPECT_TRUE(buffers.empty());
+}
+
+} // namespace test
+} // namespace quic
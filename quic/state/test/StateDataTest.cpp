@@ -83,6 +83,45 @@ class PendingPathRateLimiterTest : public Test {
   TimePoint now;
 };
 
+TEST_F(StateDataTest, NetworkDataEcnCodepoints) {
+  NetworkData networkData;
+  auto addDatagram = [&](size_t numPackets, EcnCodepoint ecn) {
+    auto firstPacket = networkData.packets.size();
+    for (size_t i = 0; i < numPackets; ++i) {
+      networkData.packets.push_back(folly::IOBuf::copyBuffer("packet"));
+    }
+    networkData.setEcnCodepoint(firstPacket, ecn);
+  };
+  addDatagram(3, EcnCodepoint::Ect1);
+  addDatagram(2, EcnCodepoint::Ect1);
+  // Datagrams with the same codepoint share one run.
+  EXPECT_EQ(1, networkData.ecnRuns.size());
+  addDatagram(1, EcnCodepoint::NotEct);
+  addDatagram(2, EcnCodepoint::Ce);
+  EXPECT_EQ(2, networkData.ecnRuns.size());
+  std::vector<EcnCodepoint> expected = {
+      EcnCodepoint::Ect1,
+      EcnCodepoint::Ect1,
+      EcnCodepoint::Ect1,
+      EcnCodepoint::Ect1,
+      EcnCodepoint::Ect1,
+      EcnCodepoint::NotEct,
+      EcnCodepoint::Ce,
+      EcnCodepoint::Ce};
+  for (size_t i = 0; i < expected.size(); ++i) {
+    EXPECT_EQ(expected[i], networkData.getEcnCodepoint(i)) << i;
+  }
+  EXPECT_EQ(EcnCodepoint::NotEct, networkData.getEcnCodepoint(8));
+
+  // Setting the codepoint again from a packet on overrides the later runs.
+  networkData.setEcnCodepoint(4, EcnCodepoint::Ect0);
+  EXPECT_EQ(EcnCodepoint::Ect1, networkData.getEcnCodepoint(3));
+  for (size_t i = 4; i < expected.size(); ++i) {
+    EXPECT_EQ(EcnCodepoint::Ect0, networkData.getEcnCodepoint(i)) << i;
+  }
+  EXPECT_EQ(2, networkData.ecnRuns.size());
+}
+
 TEST_F(PendingPathRateLimiterTest, TestSetInitialCredit) {
   EXPECT_EQ(
       limiter_.currentCredit(now, std::chrono::microseconds{kRtt}),
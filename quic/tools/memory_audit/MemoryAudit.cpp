@@ -0,0 +1,91 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ *
+ */
+
+#include <glog/logging.h>
+
+#include <folly/init/Init.h>
+#include <folly/portability/GFlags.h>
+
+#include <quic/client/QuicClientTransport.h>
+#include <quic/server/QuicServerTransport.h>
+#include <quic/server/state/ServerStateMachine.h>
+
+#include <iomanip>
+#include <iostream>
+
+DEFINE_uint64(streams, 1000, "Number of idle streams to open");
+
+using namespace quic;
+
+namespace {
+
+void printSize(const char* name, size_t size) {
+  std::cout << std::left << std::setw(32) << name << size << std::endl;
+}
+
+void printUsage(const char* name, const ConnectionMemoryUsage& usage) {
+  std::cout << name << ": " << usage.stateBytes << " state bytes, "
+            << usage.bufferedBytes << " buffered bytes, " << usage.numStreams
+            << " streams" << std::endl;
+}
+
+} // namespace
+
+/*
+ * Reports the size of the per connection and per stream state, and what an
+ * idle server connection costs with and without idle streams.
+ */
+int main(int argc, char* argv[]) {
+#if FOLLY_HAVE_LIBGFLAGS
+  // Enable glog logging to stderr by default.
+  gflags::SetCommandLineOptionWithMode(
+      "logtostderr", "1", gflags::SET_FLAGS_DEFAULT);
+#endif
+  gflags::ParseCommandLineFlags(&argc, &argv, false);
+  folly::Init init(&argc, &argv);
+
+  printSize("QuicServerTransport", sizeof(QuicServerTransport));
+  printSize("QuicClientTransport", sizeof(QuicClientTransport));
+  printSize("QuicServerConnectionState", sizeof(QuicServerConnectionState));
+  printSize("QuicClientConnectionState", sizeof(QuicClientConnectionState));
+  printSize("QuicConnectionStateBase", sizeof(QuicConnectionStateBase));
+  printSize("QuicStreamManager", sizeof(QuicStreamManager));
+  printSize("QuicCryptoState", sizeof(QuicCryptoState));
+  printSize("AckStates", sizeof(AckStates));
+  printSize("OutstandingsInfo", sizeof(OutstandingsInfo));
+  printSize("LossState", sizeof(LossState));
+  printSize("PendingEvents", sizeof(QuicConnectionStateBase::PendingEvents));
+  printSize("TransportSettings", sizeof(TransportSettings));
+  printSize("QuicStreamState", sizeof(QuicStreamState));
+  printSize("RetransmissionBuffer", sizeof(RetransmissionBuffer));
+  printSize("StreamBuffer", sizeof(StreamBuffer));
+  printSize("OutstandingPacket", sizeof(OutstandingPacket));
+  std::cout << std::endl;
+
+  QuicServerConnectionState conn;
+  auto idleUsage = getConnectionMemoryUsage(
+      conn, sizeof(QuicServerTransport) + sizeof(QuicServerConnectionState));
+  printUsage("Idle connection", idleUsage);
+
+  conn.streamManager->setMaxLocalBidirectionalStreams(FLAGS_streams);
+  for (uint64_t i = 0; i < FLAGS_streams; ++i) {
+    if (conn.streamManager->createNextBidirectionalStream().hasError()) {
+      LOG(ERROR) << "Can't open stream " << i;
+      return 1;
+    }
+  }
+  auto usage = getConnectionMemoryUsage(
+      conn, sizeof(QuicServerTransport) + sizeof(QuicServerConnectionState));
+  printUsage("With idle streams", usage);
+  if (FLAGS_streams > 0) {
+    std::cout << "Per idle stream: "
+              << (usage.stateBytes - idleUsage.stateBytes) / FLAGS_streams
+              << " bytes" << std::endl;
+  }
+  return 0;
+}
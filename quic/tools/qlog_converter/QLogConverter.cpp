@@ -0,0 +1,66 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ *
+ */
+
+#include <glog/logging.h>
+
+#include <folly/Conv.h>
+#include <folly/FileUtil.h>
+#include <folly/init/Init.h>
+#include <folly/json.h>
+#include <folly/portability/GFlags.h>
+
+#include <quic/logging/BinaryQLogCodec.h>
+
+DEFINE_string(input, "", "Binary qlog written by BinaryQLogger");
+DEFINE_string(
+    output,
+    "",
+    "Path of the JSON qlog, defaults to the input path with a .qlog extension");
+DEFINE_bool(pretty, true, "Pretty print the JSON");
+
+int main(int argc, char* argv[]) {
+#if FOLLY_HAVE_LIBGFLAGS
+  // Enable glog logging to stderr by default.
+  gflags::SetCommandLineOptionWithMode(
+      "logtostderr", "1", gflags::SET_FLAGS_DEFAULT);
+#endif
+  gflags::ParseCommandLineFlags(&argc, &argv, false);
+  folly::Init init(&argc, &argv);
+
+  if (FLAGS_input.empty()) {
+    LOG(ERROR) << "--input is required";
+    return 1;
+  }
+  auto output = FLAGS_output;
+  if (output.empty()) {
+    folly::StringPiece input(FLAGS_input);
+    input.removeSuffix(quic::kBinaryQLogFileExtension);
+    output = folly::to<std::string>(input, ".qlog");
+  }
+
+  std::string binaryQLog;
+  if (!folly::readFile(FLAGS_input.c_str(), binaryQLog)) {
+    PLOG(ERROR) << "Can't read " << FLAGS_input;
+    return 1;
+  }
+  folly::dynamic qLog;
+  try {
+    qLog = quic::binaryQLogToDynamic(folly::ByteRange(
+        folly::StringPiece(binaryQLog)));
+  } catch (const std::exception& ex) {
+    LOG(ERROR) << FLAGS_input << ": " << ex.what();
+    return 1;
+  }
+  auto json = FLAGS_pretty ? folly::toPrettyJson(qLog) : folly::toJson(qLog);
+  if (!folly::writeFile(json, output.c_str())) {
+    PLOG(ERROR) << "Can't write " << output;
+    return 1;
+  }
+  LOG(INFO) << "Wrote " << output;
+  return 0;
+}
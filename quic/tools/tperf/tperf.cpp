@@ -8,6 +8,9 @@
 
 #include <glog/logging.h>
 
+#include <atomic>
+#include <thread>
+
 #include <fizz/crypto/Utils.h>
 #include <folly/init/Init.h>
 #include <folly/io/async/HHWheelTimer.h>
@@ -18,6 +21,7 @@
 #include <quic/common/test/TestUtils.h>
 #include <quic/congestion_control/ServerCongestionControllerFactory.h>
 #include <quic/fizz/client/handshake/FizzClientQuicHandshakeContext.h>
+#include <quic/samples/echo/LogQuicStats.h>
 #include <quic/server/QuicServer.h>
 #include <quic/server/QuicServerTransport.h>
 #include <quic/server/QuicSharedUDPSocketFactory.h>
@@ -67,10 +71,103 @@ DEFINE_uint32(
         quic::kDefaultV6UDPSendPacketLen),
     "Maximum packet size to advertise to the peer.");
 DEFINE_bool(use_inplace_write, false, "Data path type");
+DEFINE_uint32(
+    num_conns,
+    1,
+    "Number of concurrent connections the client opens, each on its own "
+    "thread");
+DEFINE_uint32(
+    num_server_workers,
+    0,
+    "Number of server workers. 0 (the default) means one per CPU");
+DEFINE_bool(
+    thread_local_batching,
+    false,
+    "Coalesce the packets all the connections of a server worker write in one "
+    "event loop iteration into a single sendmmsg with GSO");
+DEFINE_bool(
+    zerocopy,
+    false,
+    "Write large GSO batches with MSG_ZEROCOPY on the server, implies --gso");
+DEFINE_uint32(
+    zerocopy_threshold,
+    quic::kDefaultZeroCopyWriteThreshold,
+    "Smallest GSO batch in bytes that is written with MSG_ZEROCOPY");
+DEFINE_bool(
+    txtime_pacing,
+    false,
+    "Leave the spacing of the paced server writes to the fq qdisc with "
+    "SO_TXTIME, implies --pacing");
+DEFINE_bool(
+    ack_frequency,
+    false,
+    "Let the congestion controller of the sender ask for fewer acks with "
+    "ACK_FREQUENCY frames");
 
 namespace quic {
 namespace tperf {
 
+/**
+ * Counts the packets and the zero copy writes of all the transports of the
+ * process.
+ */
+class TPerfStats : public quic::samples::LogQuicStats {
+ public:
+  explicit TPerfStats(const std::string& prefix) : LogQuicStats(prefix) {}
+
+  void onPacketReceived() override {
+    packetsReceived_.fetch_add(1, std::memory_order_relaxed);
+  }
+
+  void onPacketSent() override {
+    packetsSent_.fetch_add(1, std::memory_order_relaxed);
+  }
+
+  void onZeroCopyCompletion(size_t numWrites) override {
+    zeroCopyCompletions_ += numWrites;
+  }
+
+  void onZeroCopyFallback(size_t numWrites) override {
+    zeroCopyFallbacks_ += numWrites;
+  }
+
+  static void logZeroCopyWrites() {
+    LOG(INFO) << "Zero copy writes completed=" << zeroCopyCompletions_.load()
+              << " copied=" << zeroCopyFallbacks_.load();
+  }
+
+  /**
+   * Logs the packets sent and the datagrams received by the process. To get
+   * the socket system calls per packet, run tperf under
+   *   perf stat -e 'syscalls:sys_enter_send*msg,syscalls:sys_enter_recv*msg'
+   * and divide the counts perf reports by these.
+   */
+  static void logPacketCounts() {
+    LOG(INFO) << "Sent " << packetsSent_.load(std::memory_order_relaxed)
+              << " packets, received "
+              << packetsReceived_.load(std::memory_order_relaxed)
+              << " datagrams";
+  }
+
+ private:
+  static std::atomic<uint64_t> packetsSent_;
+  static std::atomic<uint64_t> packetsReceived_;
+  static std::atomic<uint64_t> zeroCopyCompletions_;
+  static std::atomic<uint64_t> zeroCopyFallbacks_;
+};
+
+std::atomic<uint64_t> TPerfStats::packetsSent_{0};
+std::atomic<uint64_t> TPerfStats::packetsReceived_{0};
+std::atomic<uint64_t> TPerfStats::zeroCopyCompletions_{0};
+std::atomic<uint64_t> TPerfStats::zeroCopyFallbacks_{0};
+
+class TPerfStatsFactory : public QuicTransportStatsCallbackFactory {
+ public:
+  std::unique_ptr<QuicTransportStatsCallback> make() override {
+    return std::make_unique<TPerfStats>("server");
+  }
+};
+
 class ServerStreamHandler : public quic::QuicSocket::ConnectionCallback,
                             public quic::QuicSocket::ReadCallback,
                             public quic::QuicSocket::WriteCallback {
@@ -107,6 +204,10 @@ class ServerStreamHandler : public quic::QuicSocket::ConnectionCallback,
 
   void onConnectionEnd() noexcept override {
     LOG(INFO) << "Socket closed";
+    if (FLAGS_zerocopy) {
+      TPerfStats::logZeroCopyWrites();
+    }
+    TPerfStats::logPacketCounts();
     sock_.reset();
   }
 
@@ -285,8 +386,17 @@ class TPerfServer {
       uint32_t numStreams,
       uint64_t maxBytesPerStream,
       uint32_t maxReceivePacketSize,
-      bool useInplaceWrite)
-      : host_(host), port_(port), server_(QuicServer::createQuicServer()) {
+      bool useInplaceWrite,
+      uint32_t numWorkers,
+      bool threadLocalBatching,
+      bool zeroCopy,
+      uint32_t zeroCopyThreshold,
+      bool txTimePacing,
+      bool ackFrequency)
+      : host_(host),
+        port_(port),
+        numWorkers_(numWorkers),
+        server_(QuicServer::createQuicServer()) {
     eventBase_.setName("tperf_server");
     server_->setQuicServerTransportFactory(
         std::make_unique<TPerfServerTransportFactory>(
@@ -303,18 +413,34 @@ class TPerfServer {
     settings.maxCwndInMss = maxCwndInMss;
     settings.writeConnectionDataPacketsLimit = writesPerLoop;
     settings.defaultCongestionController = congestionControlType;
-    settings.pacingEnabled = pacing;
-    if (pacing) {
+    settings.pacingEnabled = pacing || txTimePacing;
+    if (settings.pacingEnabled) {
       settings.pacingTimerTickInterval = 200us;
     }
+    settings.txTimePacing = txTimePacing;
     if (gso) {
       settings.batchingMode = QuicBatchingMode::BATCHING_MODE_GSO;
       settings.maxBatchSize = 16;
     }
+    if (threadLocalBatching) {
+      settings.batchingMode = QuicBatchingMode::BATCHING_MODE_SENDMMSG_GSO;
+      settings.maxBatchSize = 64;
+      settings.useThreadLocalBatching = true;
+      settings.threadLocalDelay = 0us;
+    }
+    if (zeroCopy) {
+      settings.batchingMode = QuicBatchingMode::BATCHING_MODE_GSO;
+      settings.maxBatchSize = 16;
+      settings.enableZeroCopyWrites = true;
+      settings.zeroCopyWriteThreshold = zeroCopyThreshold;
+    }
     settings.maxRecvPacketSize = maxReceivePacketSize;
     settings.canIgnorePathMTU = true;
+    settings.ackFrequencyConfig.enabled = ackFrequency;
     server_->setCongestionControllerFactory(
         std::make_shared<ServerCongestionControllerFactory>());
+    server_->setTransportStatsCallbackFactory(
+        std::make_unique<TPerfStatsFactory>());
     server_->setTransportSettings(settings);
   }
 
@@ -322,7 +448,7 @@ class TPerfServer {
     // Create a SocketAddress and the default or passed in host.
     folly::SocketAddress addr1(host_.c_str(), port_);
     addr1.setFromHostPort(host_, port_);
-    server_->start(addr1, 0);
+    server_->start(addr1, numWorkers_);
     LOG(INFO) << "tperf server started at: " << addr1.describe();
     eventBase_.loopForever();
   }
@@ -330,6 +456,7 @@ class TPerfServer {
  private:
   std::string host_;
   uint16_t port_;
+  uint32_t numWorkers_;
   folly::EventBase eventBase_;
   std::shared_ptr<quic::QuicServer> server_;
 };
@@ -347,7 +474,8 @@ class TPerfClient : public quic::QuicSocket::ConnectionCallback,
       uint64_t window,
       bool gso,
       quic::CongestionControlType congestionControlType,
-      uint32_t maxReceivePacketSize)
+      uint32_t maxReceivePacketSize,
+      bool ackFrequency)
       : host_(host),
         port_(port),
         eventBase_(transportTimerResolution),
@@ -355,15 +483,21 @@ class TPerfClient : public quic::QuicSocket::ConnectionCallback,
         window_(window),
         gso_(gso),
         congestionControlType_(congestionControlType),
-        maxReceivePacketSize_(maxReceivePacketSize) {
+        maxReceivePacketSize_(maxReceivePacketSize),
+        ackFrequency_(ackFrequency) {
     eventBase_.setName("tperf_client");
   }
 
   void timeoutExpired() noexcept override {
+    auto acksSent = quicClient_->getTransportInfo().acksSent;
     quicClient_->closeNow(folly::none);
     constexpr double bytesPerMegabit = 131072;
+    constexpr double bytesPerMegabyte = 1024 * 1024;
     LOG(INFO) << "Received " << receivedBytes_ << " bytes in "
               << duration_.count() << " seconds.";
+    LOG(INFO) << "Sent " << acksSent << " acks, "
+              << acksSent / std::max(receivedBytes_ / bytesPerMegabyte, 1.0)
+              << " per MB received";
     LOG(INFO) << "Overall throughput: "
               << (receivedBytes_ / bytesPerMegabit) / duration_.count()
               << "Mb/s";
@@ -481,6 +615,8 @@ class TPerfClient : public quic::QuicSocket::ConnectionCallback,
     quicClient_->addNewPeerAddress(addr);
     quicClient_->setCongestionControllerFactory(
         std::make_shared<DefaultCongestionControllerFactory>());
+    quicClient_->setTransportStatsCallback(
+        std::make_shared<TPerfStats>("client"));
     auto settings = quicClient_->getTransportSettings();
     settings.advertisedInitialUniStreamWindowSize = window_;
     // TODO figure out what actually to do with conn flow control and not sent
@@ -500,6 +636,7 @@ class TPerfClient : public quic::QuicSocket::ConnectionCallback,
     }
     settings.maxRecvPacketSize = maxReceivePacketSize_;
     settings.canIgnorePathMTU = true;
+    settings.ackFrequencyConfig.enabled = ackFrequency_;
     quicClient_->setTransportSettings(settings);
 
     LOG(INFO) << "TPerfClient connecting to " << addr.describe();
@@ -509,6 +646,10 @@ class TPerfClient : public quic::QuicSocket::ConnectionCallback,
 
   ~TPerfClient() override = default;
 
+  uint64_t receivedBytes() const {
+    return receivedBytes_;
+  }
+
  private:
   bool timerScheduled_{false};
   std::string host_;
@@ -526,6 +667,7 @@ class TPerfClient : public quic::QuicSocket::ConnectionCallback,
   bool gso_;
   quic::CongestionControlType congestionControlType_;
   uint32_t maxReceivePacketSize_;
+  bool ackFrequency_;
 };
 
 } // namespace tperf
@@ -575,7 +717,13 @@ int main(int argc, char* argv[]) {
         FLAGS_num_streams,
         FLAGS_bytes_per_stream,
         FLAGS_max_receive_packet_size,
-        FLAGS_use_inplace_write);
+        FLAGS_use_inplace_write,
+        FLAGS_num_server_workers,
+        FLAGS_thread_local_batching,
+        FLAGS_zerocopy,
+        FLAGS_zerocopy_threshold,
+        FLAGS_txtime_pacing,
+        FLAGS_ack_frequency);
     server.start();
   } else if (FLAGS_mode == "client") {
     if (FLAGS_num_streams != 1) {
@@ -586,16 +734,43 @@ int main(int argc, char* argv[]) {
       LOG(ERROR) << "bytes_per_stream option is server only";
       return 1;
     }
-    TPerfClient client(
-        FLAGS_host,
-        FLAGS_port,
-        std::chrono::milliseconds(FLAGS_client_transport_timer_resolution_ms),
-        FLAGS_duration,
-        FLAGS_window,
-        FLAGS_gso,
-        flagsToCongestionControlType(FLAGS_congestion),
-        FLAGS_max_receive_packet_size);
-    client.start();
+    if (FLAGS_num_conns == 0) {
+      LOG(ERROR) << "num_conns must be at least 1";
+      return 1;
+    }
+    std::vector<std::unique_ptr<TPerfClient>> clients;
+    for (uint32_t i = 0; i < FLAGS_num_conns; ++i) {
+      clients.push_back(std::make_unique<TPerfClient>(
+          FLAGS_host,
+          FLAGS_port,
+          std::chrono::milliseconds(
+              FLAGS_client_transport_timer_resolution_ms),
+          FLAGS_duration,
+          FLAGS_window,
+          FLAGS_gso,
+          flagsToCongestionControlType(FLAGS_congestion),
+          FLAGS_max_receive_packet_size,
+          FLAGS_ack_frequency));
+    }
+    if (clients.size() == 1) {
+      clients.front()->start();
+      TPerfStats::logPacketCounts();
+      return 0;
+    }
+    std::vector<std::thread> threads;
+    for (auto& client : clients) {
+      threads.emplace_back([&client]() { client->start(); });
+    }
+    uint64_t totalBytes = 0;
+    for (size_t i = 0; i < threads.size(); ++i) {
+      threads[i].join();
+      totalBytes += clients[i]->receivedBytes();
+    }
+    constexpr double bytesPerMegabit = 131072;
+    LOG(INFO) << "Aggregate throughput over " << clients.size()
+              << " connections: "
+              << (totalBytes / bytesPerMegabit) / FLAGS_duration << "Mb/s";
+    TPerfStats::logPacketCounts();
   }
   return 0;
 }